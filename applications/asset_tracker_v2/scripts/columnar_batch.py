@@ -0,0 +1,154 @@
+#!/usr/bin/env python3
+#
+# Copyright (c) 2022 Nordic Semiconductor ASA
+#
+# SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+
+"""Decoder for Asset Tracker v2 columnar batch messages.
+
+Columnar batch messages are sent instead of JSON batch messages when the
+application is built with CONFIG_CLOUD_CODEC_BATCH_COLUMNAR. The decoder
+converts a message to the structure of the corresponding JSON batch message,
+so that it can be handled by the same cloud side code.
+
+The module can be imported, or run as a script on a file containing one
+message:
+
+    columnar_batch.py message.cbor
+    columnar_batch.py --hex message.txt
+"""
+
+import argparse
+import json
+import sys
+
+import cbor2
+
+VERSION = 1
+
+VERSION_KEY = "v"
+TIMESTAMP_KEY = "ts"
+VALUE_KEY = "v"
+
+# NMEA samples are encoded separately, but belong to the GNSS array in JSON.
+NMEA_KEY = "nmea"
+GNSS_KEY = "gnss"
+
+
+class DecodeError(Exception):
+    pass
+
+
+def _column_decode(column):
+    """Decode one column into a list of values, with None for missing values."""
+    if not isinstance(column, list):
+        raise DecodeError(f"Column is not an array: {column!r}")
+
+    # Numeric columns start with the decimal exponent, text columns do not.
+    if not column or not isinstance(column[0], int):
+        return list(column)
+
+    exp = column[0]
+    total = 0
+    values = []
+
+    for delta in column[1:]:
+        if delta is None:
+            values.append(None)
+            continue
+
+        total += delta
+        if exp >= 0:
+            values.append(total * 10 ** exp)
+        else:
+            values.append(round(total * 10.0 ** exp, -exp))
+
+    return values
+
+
+def _table_decode(table):
+    """Decode the columns of a data type into a list of JSON batch entries."""
+    if not isinstance(table, dict) or TIMESTAMP_KEY not in table:
+        raise DecodeError(f"Invalid data type map: {table!r}")
+
+    columns = {key: _column_decode(column) for key, column in table.items()}
+    timestamps = columns.pop(TIMESTAMP_KEY)
+
+    for key, values in columns.items():
+        if len(values) != len(timestamps):
+            raise DecodeError(f"Column {key} has {len(values)} values, "
+                              f"expected {len(timestamps)}")
+
+    entries = []
+
+    for i, ts in enumerate(timestamps):
+        if list(columns) == [VALUE_KEY]:
+            value = columns[VALUE_KEY][i]
+        else:
+            value = {key: values[i] for key, values in columns.items()
+                     if values[i] is not None}
+
+        entries.append({VALUE_KEY: value, TIMESTAMP_KEY: ts})
+
+    return entries
+
+
+def decode(payload):
+    """Decode a columnar batch message into the structure of a JSON batch message."""
+    message = cbor2.loads(payload)
+
+    if not isinstance(message, dict):
+        raise DecodeError("Message is not a map")
+
+    version = message.pop(VERSION_KEY, None)
+    if version != VERSION:
+        raise DecodeError(f"Unsupported format version: {version}")
+
+    batch = {}
+
+    for key, table in message.items():
+        entries = _table_decode(table)
+
+        if key == NMEA_KEY:
+            key = GNSS_KEY
+
+        batch.setdefault(key, []).extend(entries)
+
+    return batch
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Decode an Asset Tracker v2 columnar batch message to JSON.")
+    parser.add_argument("file", help="File containing the message")
+    parser.add_argument("--hex", action="store_true",
+                        help="The file contains the message as a hexadecimal string")
+    parser.add_argument("--stats", action="store_true",
+                        help="Compare the size of the message with the size of the JSON message")
+    args = parser.parse_args()
+
+    if args.hex:
+        with open(args.file, "r") as f:
+            payload = bytes.fromhex("".join(f.read().split()))
+    else:
+        with open(args.file, "rb") as f:
+            payload = f.read()
+
+    try:
+        batch = decode(payload)
+    except (DecodeError, cbor2.CBORDecodeError) as e:
+        sys.exit(f"Failed to decode message: {e}")
+
+    encoded = json.dumps(batch, separators=(",", ":"))
+
+    if args.stats:
+        samples = sum(len(entries) for entries in batch.values())
+        print(f"{samples} samples, {len(payload)} bytes, "
+              f"{len(encoded)} bytes as JSON ({100 * len(payload) / len(encoded):.1f} %)",
+              file=sys.stderr)
+
+    print(encoded)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,686 @@
+/*
+ * Copyright (c) 2022 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include <zephyr/kernel.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <errno.h>
+#include <date_time.h>
+#include <zcbor_common.h>
+#include <zcbor_encode.h>
+
+#include "cloud_codec.h"
+#include "columnar_batch.h"
+#include "json_protocol_names.h"
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_REGISTER(columnar_batch, CONFIG_CLOUD_CODEC_LOG_LEVEL);
+
+/* Root map, data type map and column array. */
+#define CBOR_MAX_DEPTH 4
+
+/* Upper bound of the encoded size of a CBOR integer, including the header. */
+#define CBOR_INT_SIZE_MAX 9
+
+/* Upper bound of the encoded size of a CBOR header for a string, array or map. */
+#define CBOR_HEADER_SIZE_MAX 5
+
+/* Upper bound of the encoded size of the root map, excluding the data type maps. */
+#define ROOT_SIZE_MAX 16
+
+/* A column is either numeric or text. Numeric values are scaled by 10^-exp and rounded to the
+ * nearest integer before being delta-encoded. Getters return false if the value is missing.
+ */
+struct column {
+	const char *key;
+	int8_t exp;
+	bool (*num_get)(const void *entry, double *value);
+	const char *(*str_get)(const void *entry);
+	size_t str_len_max;
+};
+
+struct table {
+	const char *key;
+	const struct column *columns;
+	size_t column_count;
+	size_t entry_size;
+	/* Returns true if the entry is queued and can be encoded. */
+	bool (*valid)(const void *entry);
+	bool (*queued)(const void *entry);
+	void (*unqueue)(void *entry);
+	int64_t *(*ts)(void *entry);
+};
+
+struct table_buf {
+	const struct table *table;
+	void *buf;
+	size_t count;
+	size_t valid_count;
+};
+
+static const double pow10_table[] = { 1, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9 };
+
+#define NUM_COLUMN(_key, _exp, _get) { .key = _key, .exp = _exp, .num_get = _get }
+#define STR_COLUMN(_key, _get, _len_max) { .key = _key, .str_get = _get, .str_len_max = _len_max }
+
+#define TABLE(_name, _key, _type, _valid, _ts_field)			\
+	static bool _name##_queued(const void *entry)			\
+	{								\
+		return ((const _type *)entry)->queued;			\
+	}								\
+									\
+	static void _name##_unqueue(void *entry)			\
+	{								\
+		((_type *)entry)->queued = false;			\
+	}								\
+									\
+	static int64_t *_name##_ts_get(void *entry)			\
+	{								\
+		return &((_type *)entry)->_ts_field;			\
+	}								\
+									\
+	static const struct table _name##_table = {			\
+		.key = _key,						\
+		.columns = _name##_columns,				\
+		.column_count = ARRAY_SIZE(_name##_columns),		\
+		.entry_size = sizeof(_type),				\
+		.valid = _valid,					\
+		.queued = _name##_queued,				\
+		.unqueue = _name##_unqueue,				\
+		.ts = _name##_ts_get,					\
+	}
+
+/* Static modem data */
+
+static const char *modem_stat_iccid_get(const void *entry)
+{
+	return ((const struct cloud_data_modem_static *)entry)->iccid;
+}
+
+static const char *modem_stat_fw_get(const void *entry)
+{
+	return ((const struct cloud_data_modem_static *)entry)->fw;
+}
+
+static const char *modem_stat_brdv_get(const void *entry)
+{
+	return ((const struct cloud_data_modem_static *)entry)->brdv;
+}
+
+static const char *modem_stat_appv_get(const void *entry)
+{
+	return ((const struct cloud_data_modem_static *)entry)->appv;
+}
+
+static const char *modem_stat_imei_get(const void *entry)
+{
+	return ((const struct cloud_data_modem_static *)entry)->imei;
+}
+
+static bool modem_stat_valid(const void *entry)
+{
+	return ((const struct cloud_data_modem_static *)entry)->queued;
+}
+
+static const struct column modem_stat_columns[] = {
+	STR_COLUMN(MODEM_IMEI, modem_stat_imei_get,
+		   SIZEOF_FIELD(struct cloud_data_modem_static, imei)),
+	STR_COLUMN(MODEM_ICCID, modem_stat_iccid_get,
+		   SIZEOF_FIELD(struct cloud_data_modem_static, iccid)),
+	STR_COLUMN(MODEM_FIRMWARE_VERSION, modem_stat_fw_get,
+		   SIZEOF_FIELD(struct cloud_data_modem_static, fw)),
+	STR_COLUMN(MODEM_BOARD, modem_stat_brdv_get,
+		   SIZEOF_FIELD(struct cloud_data_modem_static, brdv)),
+	STR_COLUMN(MODEM_APP_VERSION, modem_stat_appv_get,
+		   SIZEOF_FIELD(struct cloud_data_modem_static, appv)),
+};
+
+TABLE(modem_stat, DATA_MODEM_STATIC, struct cloud_data_modem_static, modem_stat_valid, ts);
+
+/* Dynamic modem data */
+
+static bool modem_dyn_band_get(const void *entry, double *value)
+{
+	const struct cloud_data_modem_dynamic *data = entry;
+
+	*value = data->band;
+	return data->band_fresh;
+}
+
+static const char *modem_dyn_nw_get(const void *entry)
+{
+	const struct cloud_data_modem_dynamic *data = entry;
+
+	if (!data->nw_mode_fresh) {
+		return NULL;
+	}
+
+	return (data->nw_mode == LTE_LC_LTE_MODE_LTEM) ? "LTE-M" :
+	       (data->nw_mode == LTE_LC_LTE_MODE_NBIOT) ? "NB-IoT" : "Unknown";
+}
+
+static bool modem_dyn_rsrp_get(const void *entry, double *value)
+{
+	const struct cloud_data_modem_dynamic *data = entry;
+
+	*value = data->rsrp;
+	return data->rsrp_fresh;
+}
+
+static bool modem_dyn_area_get(const void *entry, double *value)
+{
+	const struct cloud_data_modem_dynamic *data = entry;
+
+	*value = data->area;
+	return data->area_code_fresh;
+}
+
+static bool modem_dyn_mccmnc_get(const void *entry, double *value)
+{
+	const struct cloud_data_modem_dynamic *data = entry;
+	unsigned long mccmnc;
+	char *end_ptr;
+
+	if (!data->mccmnc_fresh) {
+		return false;
+	}
+
+	errno = 0;
+	mccmnc = strtoul(data->mccmnc, &end_ptr, 10);
+
+	if ((errno == ERANGE) || (*end_ptr != '\0')) {
+		LOG_WRN("MCCMNC string could not be converted");
+		return false;
+	}
+
+	*value = mccmnc;
+	return true;
+}
+
+static bool modem_dyn_cell_get(const void *entry, double *value)
+{
+	const struct cloud_data_modem_dynamic *data = entry;
+
+	*value = data->cell;
+	return data->cell_id_fresh;
+}
+
+static const char *modem_dyn_ip_get(const void *entry)
+{
+	const struct cloud_data_modem_dynamic *data = entry;
+
+	return data->ip_address_fresh ? data->ip : NULL;
+}
+
+static bool modem_dyn_valid(const void *entry)
+{
+	const struct cloud_data_modem_dynamic *data = entry;
+
+	return data->queued &&
+	       (data->band_fresh || data->nw_mode_fresh || data->rsrp_fresh ||
+		data->area_code_fresh || data->mccmnc_fresh || data->cell_id_fresh ||
+		data->ip_address_fresh);
+}
+
+static const struct column modem_dyn_columns[] = {
+	NUM_COLUMN(MODEM_CURRENT_BAND, 0, modem_dyn_band_get),
+	STR_COLUMN(MODEM_NETWORK_MODE, modem_dyn_nw_get, sizeof("Unknown")),
+	NUM_COLUMN(MODEM_RSRP, 0, modem_dyn_rsrp_get),
+	NUM_COLUMN(MODEM_AREA_CODE, 0, modem_dyn_area_get),
+	NUM_COLUMN(MODEM_MCCMNC, 0, modem_dyn_mccmnc_get),
+	NUM_COLUMN(MODEM_CELL_ID, 0, modem_dyn_cell_get),
+	STR_COLUMN(MODEM_IP_ADDRESS, modem_dyn_ip_get, INET6_ADDRSTRLEN),
+};
+
+TABLE(modem_dyn, DATA_MODEM_DYNAMIC, struct cloud_data_modem_dynamic, modem_dyn_valid, ts);
+
+/* GNSS data in PVT format */
+
+static bool gnss_lng_get(const void *entry, double *value)
+{
+	*value = ((const struct cloud_data_gnss *)entry)->pvt.longi;
+	return true;
+}
+
+static bool gnss_lat_get(const void *entry, double *value)
+{
+	*value = ((const struct cloud_data_gnss *)entry)->pvt.lat;
+	return true;
+}
+
+static bool gnss_acc_get(const void *entry, double *value)
+{
+	*value = ((const struct cloud_data_gnss *)entry)->pvt.acc;
+	return true;
+}
+
+static bool gnss_alt_get(const void *entry, double *value)
+{
+	*value = ((const struct cloud_data_gnss *)entry)->pvt.alt;
+	return true;
+}
+
+static bool gnss_spd_get(const void *entry, double *value)
+{
+	*value = ((const struct cloud_data_gnss *)entry)->pvt.spd;
+	return true;
+}
+
+static bool gnss_hdg_get(const void *entry, double *value)
+{
+	*value = ((const struct cloud_data_gnss *)entry)->pvt.hdg;
+	return true;
+}
+
+static bool gnss_valid(const void *entry)
+{
+	const struct cloud_data_gnss *data = entry;
+
+	return data->queued && (data->format == CLOUD_CODEC_GNSS_FORMAT_PVT);
+}
+
+/* Coordinates are encoded with a resolution of 1e-7 degrees, about 1 cm. */
+static const struct column gnss_columns[] = {
+	NUM_COLUMN(DATA_GNSS_LONGITUDE, -7, gnss_lng_get),
+	NUM_COLUMN(DATA_GNSS_LATITUDE, -7, gnss_lat_get),
+	NUM_COLUMN(DATA_GNSS_ACCURACY, -1, gnss_acc_get),
+	NUM_COLUMN(DATA_GNSS_ALTITUDE, -1, gnss_alt_get),
+	NUM_COLUMN(DATA_GNSS_SPEED, -2, gnss_spd_get),
+	NUM_COLUMN(DATA_GNSS_HEADING, -1, gnss_hdg_get),
+};
+
+TABLE(gnss, DATA_GNSS, struct cloud_data_gnss, gnss_valid, gnss_ts);
+
+/* GNSS data in NMEA format */
+
+static const char *nmea_get(const void *entry)
+{
+	return ((const struct cloud_data_gnss *)entry)->nmea;
+}
+
+static bool nmea_valid(const void *entry)
+{
+	const struct cloud_data_gnss *data = entry;
+
+	return data->queued && (data->format == CLOUD_CODEC_GNSS_FORMAT_NMEA);
+}
+
+static const struct column nmea_columns[] = {
+	STR_COLUMN(DATA_VALUE, nmea_get, SIZEOF_FIELD(struct cloud_data_gnss, nmea)),
+};
+
+TABLE(nmea, DATA_GNSS_NMEA, struct cloud_data_gnss, nmea_valid, gnss_ts);
+
+/* Environmental sensor data */
+
+static bool sensor_temp_get(const void *entry, double *value)
+{
+	*value = ((const struct cloud_data_sensors *)entry)->temperature;
+	return true;
+}
+
+static bool sensor_hum_get(const void *entry, double *value)
+{
+	*value = ((const struct cloud_data_sensors *)entry)->humidity;
+	return true;
+}
+
+static bool sensor_atmp_get(const void *entry, double *value)
+{
+	*value = ((const struct cloud_data_sensors *)entry)->pressure;
+	return true;
+}
+
+static bool sensor_iaq_get(const void *entry, double *value)
+{
+	const struct cloud_data_sensors *data = entry;
+
+	/* If air quality is negative, the value is not provided. */
+	*value = data->bsec_air_quality;
+	return data->bsec_air_quality >= 0;
+}
+
+static bool sensor_valid(const void *entry)
+{
+	return ((const struct cloud_data_sensors *)entry)->queued;
+}
+
+static const struct column sensor_columns[] = {
+	NUM_COLUMN(DATA_TEMPERATURE, -2, sensor_temp_get),
+	NUM_COLUMN(DATA_HUMIDITY, -2, sensor_hum_get),
+	NUM_COLUMN(DATA_PRESSURE, -3, sensor_atmp_get),
+	NUM_COLUMN(DATA_BSEC_IAQ, 0, sensor_iaq_get),
+};
+
+TABLE(sensor, DATA_ENVIRONMENTALS, struct cloud_data_sensors, sensor_valid, env_ts);
+
+/* Button data */
+
+static bool ui_btn_get(const void *entry, double *value)
+{
+	*value = ((const struct cloud_data_ui *)entry)->btn;
+	return true;
+}
+
+static bool ui_valid(const void *entry)
+{
+	return ((const struct cloud_data_ui *)entry)->queued;
+}
+
+static const struct column ui_columns[] = {
+	NUM_COLUMN(DATA_VALUE, 0, ui_btn_get),
+};
+
+TABLE(ui, DATA_BUTTON, struct cloud_data_ui, ui_valid, btn_ts);
+
+/* Impact data */
+
+static bool impact_magnitude_get(const void *entry, double *value)
+{
+	*value = ((const struct cloud_data_impact *)entry)->magnitude;
+	return true;
+}
+
+static bool impact_valid(const void *entry)
+{
+	return ((const struct cloud_data_impact *)entry)->queued;
+}
+
+static const struct column impact_columns[] = {
+	NUM_COLUMN(DATA_VALUE, -2, impact_magnitude_get),
+};
+
+TABLE(impact, DATA_IMPACT, struct cloud_data_impact, impact_valid, ts);
+
+/* Battery data */
+
+static bool bat_voltage_get(const void *entry, double *value)
+{
+	*value = ((const struct cloud_data_battery *)entry)->bat;
+	return true;
+}
+
+static bool bat_valid(const void *entry)
+{
+	return ((const struct cloud_data_battery *)entry)->queued;
+}
+
+static const struct column bat_columns[] = {
+	NUM_COLUMN(DATA_VALUE, 0, bat_voltage_get),
+};
+
+TABLE(bat, DATA_BATTERY, struct cloud_data_battery, bat_valid, bat_ts);
+
+static void *entry_get(const struct table_buf *tb, size_t idx)
+{
+	return (uint8_t *)tb->buf + (idx * tb->table->entry_size);
+}
+
+static int64_t quantize(double value, int8_t exp)
+{
+	__ASSERT_NO_MSG((exp <= 0) && (-exp < ARRAY_SIZE(pow10_table)));
+
+	return llround(value * pow10_table[-exp]);
+}
+
+static bool tstr_put(zcbor_state_t *zse, const char *str)
+{
+	struct zcbor_string zstr = {
+		.value = (const uint8_t *)str,
+		.len = strlen(str)
+	};
+
+	return zcbor_tstr_encode(zse, &zstr);
+}
+
+static size_t table_size_max(const struct table_buf *tb)
+{
+	const struct table *table = tb->table;
+	size_t size = CBOR_HEADER_SIZE_MAX + strlen(table->key) + CBOR_HEADER_SIZE_MAX;
+
+	/* Timestamp column. */
+	size += CBOR_HEADER_SIZE_MAX + strlen(DATA_TIMESTAMP) + CBOR_HEADER_SIZE_MAX +
+		CBOR_INT_SIZE_MAX + (tb->valid_count * CBOR_INT_SIZE_MAX);
+
+	for (size_t i = 0; i < table->column_count; i++) {
+		const struct column *column = &table->columns[i];
+		size_t entry_size = column->num_get ? CBOR_INT_SIZE_MAX :
+						      CBOR_HEADER_SIZE_MAX + column->str_len_max;
+
+		size += CBOR_HEADER_SIZE_MAX + strlen(column->key) + CBOR_HEADER_SIZE_MAX +
+			CBOR_INT_SIZE_MAX + (tb->valid_count * entry_size);
+	}
+
+	return size;
+}
+
+static bool ts_column_encode(zcbor_state_t *zse, const struct table_buf *tb)
+{
+	int64_t prev = 0;
+	bool ok = tstr_put(zse, DATA_TIMESTAMP) &&
+		  zcbor_list_start_encode(zse, tb->valid_count + 1) &&
+		  zcbor_int32_put(zse, 0);
+
+	for (size_t i = 0; ok && (i < tb->count); i++) {
+		void *entry = entry_get(tb, i);
+		int64_t ts;
+
+		if (!tb->table->valid(entry)) {
+			continue;
+		}
+
+		ts = *tb->table->ts(entry);
+		ok = zcbor_int64_put(zse, ts - prev);
+		prev = ts;
+	}
+
+	return ok && zcbor_list_end_encode(zse, tb->valid_count + 1);
+}
+
+static bool num_column_encode(zcbor_state_t *zse, const struct table_buf *tb,
+			      const struct column *column)
+{
+	int64_t prev = 0;
+	bool ok = tstr_put(zse, column->key) &&
+		  zcbor_list_start_encode(zse, tb->valid_count + 1) &&
+		  zcbor_int32_put(zse, column->exp);
+
+	for (size_t i = 0; ok && (i < tb->count); i++) {
+		const void *entry = entry_get(tb, i);
+		double value;
+
+		if (!tb->table->valid(entry)) {
+			continue;
+		}
+
+		if (column->num_get(entry, &value)) {
+			int64_t current = quantize(value, column->exp);
+
+			ok = zcbor_int64_put(zse, current - prev);
+			prev = current;
+		} else {
+			ok = zcbor_nil_put(zse, NULL);
+		}
+	}
+
+	return ok && zcbor_list_end_encode(zse, tb->valid_count + 1);
+}
+
+static bool str_column_encode(zcbor_state_t *zse, const struct table_buf *tb,
+			      const struct column *column)
+{
+	bool ok = tstr_put(zse, column->key) &&
+		  zcbor_list_start_encode(zse, tb->valid_count);
+
+	for (size_t i = 0; ok && (i < tb->count); i++) {
+		const void *entry = entry_get(tb, i);
+		const char *str;
+
+		if (!tb->table->valid(entry)) {
+			continue;
+		}
+
+		str = column->str_get(entry);
+		ok = str ? tstr_put(zse, str) : zcbor_nil_put(zse, NULL);
+	}
+
+	return ok && zcbor_list_end_encode(zse, tb->valid_count);
+}
+
+static bool table_encode(zcbor_state_t *zse, const struct table_buf *tb)
+{
+	const struct table *table = tb->table;
+	bool ok = tstr_put(zse, table->key) &&
+		  zcbor_map_start_encode(zse, table->column_count + 1) &&
+		  ts_column_encode(zse, tb);
+
+	for (size_t i = 0; ok && (i < table->column_count); i++) {
+		const struct column *column = &table->columns[i];
+
+		ok = column->num_get ? num_column_encode(zse, tb, column) :
+				       str_column_encode(zse, tb, column);
+	}
+
+	return ok && zcbor_map_end_encode(zse, table->column_count + 1);
+}
+
+/* Count the entries that can be encoded and convert their timestamps to UNIX time. */
+static int table_prepare(struct table_buf *tb)
+{
+	int err;
+
+	tb->valid_count = 0;
+
+	if (tb->buf == NULL) {
+		return 0;
+	}
+
+	for (size_t i = 0; i < tb->count; i++) {
+		void *entry = entry_get(tb, i);
+
+		if (!tb->table->valid(entry)) {
+			continue;
+		}
+
+		err = date_time_uptime_to_unix_time_ms(tb->table->ts(entry));
+		if (err) {
+			LOG_ERR("date_time_uptime_to_unix_time_ms, error: %d", err);
+			return err;
+		}
+
+		tb->valid_count++;
+	}
+
+	return 0;
+}
+
+/* Unqueue all entries, including entries that are queued but cannot be encoded. */
+static void table_unqueue(struct table_buf *tb)
+{
+	if (tb->buf == NULL) {
+		return;
+	}
+
+	for (size_t i = 0; i < tb->count; i++) {
+		void *entry = entry_get(tb, i);
+
+		if (tb->table->queued(entry)) {
+			tb->table->unqueue(entry);
+		}
+	}
+}
+
+int columnar_batch_encode(struct cloud_codec_data *output,
+			  struct cloud_data_gnss *gnss_buf,
+			  struct cloud_data_sensors *sensor_buf,
+			  struct cloud_data_modem_static *modem_stat_buf,
+			  struct cloud_data_modem_dynamic *modem_dyn_buf,
+			  struct cloud_data_ui *ui_buf,
+			  struct cloud_data_impact *impact_buf,
+			  struct cloud_data_battery *bat_buf,
+			  size_t gnss_buf_count,
+			  size_t sensor_buf_count,
+			  size_t modem_stat_buf_count,
+			  size_t modem_dyn_buf_count,
+			  size_t ui_buf_count,
+			  size_t impact_buf_count,
+			  size_t bat_buf_count)
+{
+	int err;
+	bool ok;
+	uint8_t *buffer;
+	size_t size = ROOT_SIZE_MAX;
+	size_t table_count = 0;
+	struct table_buf tables[] = {
+		{ &modem_stat_table, modem_stat_buf, modem_stat_buf_count },
+		{ &modem_dyn_table, modem_dyn_buf, modem_dyn_buf_count },
+		{ &gnss_table, gnss_buf, gnss_buf_count },
+		{ &nmea_table, gnss_buf, gnss_buf_count },
+		{ &sensor_table, sensor_buf, sensor_buf_count },
+		{ &ui_table, ui_buf, ui_buf_count },
+		{ &impact_table, impact_buf, impact_buf_count },
+		{ &bat_table, bat_buf, bat_buf_count },
+	};
+
+	for (size_t i = 0; i < ARRAY_SIZE(tables); i++) {
+		err = table_prepare(&tables[i]);
+		if (err) {
+			return err;
+		}
+
+		if (tables[i].valid_count > 0) {
+			size += table_size_max(&tables[i]);
+			table_count++;
+		}
+	}
+
+	if (table_count == 0) {
+		for (size_t i = 0; i < ARRAY_SIZE(tables); i++) {
+			table_unqueue(&tables[i]);
+		}
+
+		LOG_DBG("No data to encode");
+		return -ENODATA;
+	}
+
+	buffer = k_malloc(size);
+	if (buffer == NULL) {
+		LOG_ERR("Failed to allocate %zu bytes for batch message", size);
+		return -ENOMEM;
+	}
+
+	ZCBOR_STATE_E(zse, CBOR_MAX_DEPTH, buffer, size, 1);
+
+	ok = zcbor_map_start_encode(zse, table_count + 1) &&
+	     tstr_put(zse, DATA_VALUE) &&
+	     zcbor_int32_put(zse, COLUMNAR_BATCH_VERSION);
+
+	for (size_t i = 0; ok && (i < ARRAY_SIZE(tables)); i++) {
+		if (tables[i].valid_count > 0) {
+			ok = table_encode(zse, &tables[i]);
+		}
+	}
+
+	ok = ok && zcbor_map_end_encode(zse, table_count + 1);
+	if (!ok) {
+		LOG_ERR("CBOR encoding failed: %d", zcbor_pop_error(zse));
+		k_free(buffer);
+		return -EINVAL;
+	}
+
+	for (size_t i = 0; i < ARRAY_SIZE(tables); i++) {
+		table_unqueue(&tables[i]);
+	}
+
+	output->buf = (char *)buffer;
+	output->len = zse->payload - buffer;
+
+	LOG_DBG("Encoded batch message, %zu bytes", output->len);
+	LOG_HEXDUMP_DBG(buffer, output->len, "Encoded batch message:");
+
+	return 0;
+}
@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2022 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+/**@file
+ * @brief Columnar batch encoding library header.
+ */
+
+#ifndef COLUMNAR_BATCH_H__
+#define COLUMNAR_BATCH_H__
+
+/**@file
+ *
+ * @defgroup columnar_batch Columnar batch encoding
+ * @brief    Module that encodes batch messages as columns of delta-encoded CBOR integers.
+ *
+ * @details The encoded message is a CBOR map with the format version under the key "v" and one
+ *	    map per data type present in the batch, using the same keys as the JSON batch
+ *	    message. Each data type map holds one array per value, with one element per sample.
+ *	    NMEA GNSS samples are placed in a separate "nmea" map.
+ *
+ *	    Numeric arrays start with the decimal exponent of the values, followed by the
+ *	    first value as an integer and the difference to the previous value for the
+ *	    following samples. A value is obtained by summing the integers up to its position
+ *	    and multiplying by 10 to the power of the exponent. Text arrays hold the strings
+ *	    as is. Missing values are encoded as null and are skipped when summing.
+ * @{
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <zephyr/kernel.h>
+
+#include "cloud_codec.h"
+
+/** Version of the encoded format. */
+#define COLUMNAR_BATCH_VERSION 1
+
+/**
+ * @brief Encode buffered data into a columnar batch message.
+ *
+ * @details Entries that are encoded have their timestamps converted to UNIX time and are
+ *	    unqueued, in the same way as for JSON batch messages.
+ *
+ * @param[out] output Encoded message. The buffer is allocated with k_malloc() and must be
+ *		      freed by the caller.
+ * @param[in] gnss_buf Pointer to GNSS data.
+ * @param[in] sensor_buf Pointer to sensor data.
+ * @param[in] modem_stat_buf Pointer to static modem data.
+ * @param[in] modem_dyn_buf Pointer to dynamic modem data.
+ * @param[in] ui_buf Pointer to button data.
+ * @param[in] impact_buf Pointer to impact data.
+ * @param[in] bat_buf Pointer to battery data.
+ * @param[in] gnss_buf_count Number of entries in the GNSS buffer.
+ * @param[in] sensor_buf_count Number of entries in the sensor buffer.
+ * @param[in] modem_stat_buf_count Number of entries in the static modem buffer.
+ * @param[in] modem_dyn_buf_count Number of entries in the dynamic modem buffer.
+ * @param[in] ui_buf_count Number of entries in the button buffer.
+ * @param[in] impact_buf_count Number of entries in the impact buffer.
+ * @param[in] bat_buf_count Number of entries in the battery buffer.
+ *
+ * @retval 0 on success.
+ * @retval -ENODATA if none of the entries are queued.
+ * @retval -ENOMEM if the output buffer could not be allocated.
+ * @return Otherwise a negative error code is returned.
+ */
+int columnar_batch_encode(struct cloud_codec_data *output,
+			  struct cloud_data_gnss *gnss_buf,
+			  struct cloud_data_sensors *sensor_buf,
+			  struct cloud_data_modem_static *modem_stat_buf,
+			  struct cloud_data_modem_dynamic *modem_dyn_buf,
+			  struct cloud_data_ui *ui_buf,
+			  struct cloud_data_impact *impact_buf,
+			  struct cloud_data_battery *bat_buf,
+			  size_t gnss_buf_count,
+			  size_t sensor_buf_count,
+			  size_t modem_stat_buf_count,
+			  size_t modem_dyn_buf_count,
+			  size_t ui_buf_count,
+			  size_t impact_buf_count,
+			  size_t bat_buf_count);
+
+#ifdef __cplusplus
+}
+#endif
+
+/**
+ * @}
+ */
+
+#endif /* COLUMNAR_BATCH_H__ */
@@ -0,0 +1,447 @@
+/*
+ * Copyright (c) 2022 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/fs/fcb.h>
+#include <zephyr/storage/flash_map.h>
+#include <string.h>
+
+#include "data_log.h"
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_REGISTER(data_log, CONFIG_DATA_LOG_LOG_LEVEL);
+
+#define DATA_LOG_AREA_ID	FLASH_AREA_ID(data_log)
+#define DATA_LOG_MAGIC		0x4154444c
+/* Increment when the record format changes. The log is erased if the stored version differs. */
+#define DATA_LOG_VERSION	1
+
+/* Records of this type store the sequence number of the last acknowledged record. */
+#define RECORD_TYPE_ACK		0
+
+/* Records are padded to the flash write block size, which is assumed to be at most 8 bytes. */
+#define RECORD_BUF_SIZE \
+	ROUND_UP(sizeof(struct record_header) + DATA_LOG_DATA_SIZE_MAX, 8)
+
+struct record_header {
+	/* Sequence number of the record. Only data records are numbered, ACK records use 0. */
+	uint32_t seq;
+	uint8_t type;
+	uint8_t reserved;
+	/* Length of the data that follows, without padding. */
+	uint16_t len;
+} __packed;
+
+static struct fcb fcb;
+static struct flash_sector sectors[CONFIG_DATA_LOG_SECTOR_COUNT_MAX];
+static uint8_t record_buf[RECORD_BUF_SIZE] __aligned(4);
+
+/* Sequence number of the newest data record. */
+static uint32_t last_seq;
+
+/* Sequence number of the newest data record that has been acknowledged or dropped. */
+static uint32_t ack_seq;
+
+/* Location of the record with sequence number ack_seq, used as a starting point when reading.
+ * The sector is NULL if the location is not known, then reading starts from the oldest record.
+ */
+static struct fcb_entry ack_loc;
+
+static struct data_log_stats log_stats;
+
+static K_MUTEX_DEFINE(log_lock);
+
+static int header_read(const struct fcb_entry *loc, struct record_header *hdr)
+{
+	if (loc->fe_data_len < sizeof(*hdr)) {
+		return -EBADMSG;
+	}
+
+	return flash_area_read(fcb.fap, FCB_ENTRY_FA_DATA_OFF((*loc)), hdr, sizeof(*hdr));
+}
+
+/* Count the records in a sector that have not been acknowledged. */
+static int sector_pending_count(struct flash_sector *sector, uint32_t *max_seq)
+{
+	int err;
+	int count = 0;
+	struct fcb_entry loc = { 0 };
+	struct record_header hdr;
+
+	*max_seq = 0;
+
+	while (fcb_getnext(&fcb, &loc) == 0) {
+		if (loc.fe_sector != sector) {
+			break;
+		}
+
+		err = header_read(&loc, &hdr);
+		if (err) {
+			return err;
+		}
+
+		if ((hdr.type != RECORD_TYPE_ACK) && (hdr.seq > ack_seq)) {
+			*max_seq = MAX(*max_seq, hdr.seq);
+			count++;
+		}
+	}
+
+	return count;
+}
+
+/* Erase the oldest sector. Records in it that have not been acknowledged are dropped. */
+static int sector_erase_oldest(void)
+{
+	int err;
+	int count;
+	uint32_t max_seq;
+	struct flash_sector *sector = fcb.f_oldest;
+
+	count = sector_pending_count(sector, &max_seq);
+	if (count < 0) {
+		return count;
+	}
+
+	err = fcb_rotate(&fcb);
+	if (err) {
+		LOG_ERR("fcb_rotate, error: %d", err);
+		return err;
+	}
+
+	log_stats.erases++;
+
+	if (count > 0) {
+		LOG_WRN("Log is full, %d records have been dropped", count);
+		log_stats.dropped += count;
+		ack_seq = max_seq;
+	}
+
+	if (ack_loc.fe_sector == sector) {
+		ack_loc.fe_sector = NULL;
+	}
+
+	return 0;
+}
+
+/* Erase sectors that only contain acknowledged records, except for the active sector. */
+static int sectors_reclaim(void)
+{
+	int err;
+	int count;
+	uint32_t max_seq;
+
+	while (fcb.f_oldest != fcb.f_active.fe_sector) {
+		count = sector_pending_count(fcb.f_oldest, &max_seq);
+		if (count < 0) {
+			return count;
+		} else if (count > 0) {
+			break;
+		}
+
+		err = sector_erase_oldest();
+		if (err) {
+			return err;
+		}
+	}
+
+	return 0;
+}
+
+static int record_write(uint8_t type, uint32_t seq, const void *data, size_t len)
+{
+	int err;
+	struct fcb_entry loc;
+	struct record_header *hdr = (struct record_header *)record_buf;
+	size_t size = ROUND_UP(sizeof(*hdr) + len, flash_area_align(fcb.fap));
+
+	if (size > sizeof(record_buf)) {
+		return -EMSGSIZE;
+	}
+
+	memset(record_buf, 0, size);
+	hdr->seq = seq;
+	hdr->type = type;
+	hdr->len = len;
+	memcpy(&record_buf[sizeof(*hdr)], data, len);
+
+	err = fcb_append(&fcb, size, &loc);
+	if (err == -ENOSPC) {
+		err = sector_erase_oldest();
+		if (err) {
+			return err;
+		}
+
+		err = fcb_append(&fcb, size, &loc);
+	}
+
+	if (err) {
+		LOG_ERR("fcb_append, error: %d", err);
+		return err;
+	}
+
+	err = flash_area_write(fcb.fap, FCB_ENTRY_FA_DATA_OFF(loc), record_buf, size);
+	if (err) {
+		LOG_ERR("flash_area_write, error: %d", err);
+		return err;
+	}
+
+	return fcb_append_finish(&fcb, &loc);
+}
+
+/* Restore the sequence numbers from the records in flash. */
+static int log_scan(void)
+{
+	int err;
+	uint32_t first_seq = 0;
+	uint32_t acked = 0;
+	struct fcb_entry loc = { 0 };
+	struct record_header hdr;
+
+	last_seq = 0;
+
+	while (fcb_getnext(&fcb, &loc) == 0) {
+		err = header_read(&loc, &hdr);
+		if (err) {
+			LOG_ERR("Failed reading record header, error: %d", err);
+			return err;
+		}
+
+		if (hdr.type == RECORD_TYPE_ACK) {
+			uint32_t seq;
+
+			err = flash_area_read(fcb.fap, FCB_ENTRY_FA_DATA_OFF(loc) + sizeof(hdr),
+					      &seq, sizeof(seq));
+			if (err) {
+				return err;
+			}
+
+			acked = MAX(acked, seq);
+			continue;
+		}
+
+		if (first_seq == 0) {
+			first_seq = hdr.seq;
+		}
+
+		last_seq = MAX(last_seq, hdr.seq);
+	}
+
+	/* If the last ACK record was erased together with the oldest sector, all remaining
+	 * records are newer than the acknowledged ones.
+	 */
+	if (first_seq == 0) {
+		last_seq = acked;
+		ack_seq = acked;
+	} else {
+		ack_seq = MIN(MAX(acked, first_seq - 1), last_seq);
+	}
+
+	ack_loc.fe_sector = NULL;
+
+	LOG_DBG("%u records pending, next sequence number: %u", last_seq - ack_seq, last_seq + 1);
+
+	return 0;
+}
+
+static int log_erase(void)
+{
+	int err;
+	const struct flash_area *fa;
+
+	err = flash_area_open(DATA_LOG_AREA_ID, &fa);
+	if (err) {
+		return err;
+	}
+
+	err = flash_area_erase(fa, 0, fa->fa_size);
+	flash_area_close(fa);
+
+	return err;
+}
+
+int data_log_init(void)
+{
+	int err;
+	uint32_t sector_cnt = ARRAY_SIZE(sectors);
+
+	k_mutex_lock(&log_lock, K_FOREVER);
+
+	err = flash_area_get_sectors(DATA_LOG_AREA_ID, &sector_cnt, sectors);
+	if (err) {
+		LOG_ERR("flash_area_get_sectors, error: %d", err);
+		goto exit;
+	}
+
+	memset(&fcb, 0, sizeof(fcb));
+	memset(&log_stats, 0, sizeof(log_stats));
+	fcb.f_magic = DATA_LOG_MAGIC;
+	fcb.f_version = DATA_LOG_VERSION;
+	fcb.f_sector_cnt = sector_cnt;
+	fcb.f_sectors = sectors;
+
+	err = fcb_init(DATA_LOG_AREA_ID, &fcb);
+	if (err == -ENOMSG) {
+		LOG_WRN("Log format has changed, erasing stored records");
+
+		err = log_erase();
+		if (err) {
+			LOG_ERR("Failed erasing the log, error: %d", err);
+			goto exit;
+		}
+
+		err = fcb_init(DATA_LOG_AREA_ID, &fcb);
+	}
+
+	if (err) {
+		LOG_ERR("fcb_init, error: %d", err);
+		goto exit;
+	}
+
+	err = log_scan();
+
+exit:
+	k_mutex_unlock(&log_lock);
+	return err;
+}
+
+int data_log_append(enum data_log_type type, const void *data, size_t len)
+{
+	int err;
+
+	if (len > DATA_LOG_DATA_SIZE_MAX) {
+		return -EMSGSIZE;
+	}
+
+	k_mutex_lock(&log_lock, K_FOREVER);
+
+	err = record_write(type, last_seq + 1, data, len);
+	if (!err) {
+		last_seq++;
+	}
+
+	k_mutex_unlock(&log_lock);
+	return err;
+}
+
+void data_log_cursor_init(struct data_log_cursor *cursor)
+{
+	k_mutex_lock(&log_lock, K_FOREVER);
+
+	cursor->loc = ack_loc;
+	cursor->seq = ack_seq;
+
+	k_mutex_unlock(&log_lock);
+}
+
+int data_log_read(struct data_log_cursor *cursor, enum data_log_type *type,
+		  void *buf, size_t buf_len)
+{
+	int err;
+	struct fcb_entry loc = cursor->loc;
+	struct record_header hdr;
+
+	k_mutex_lock(&log_lock, K_FOREVER);
+
+	while (true) {
+		if (fcb_getnext(&fcb, &loc)) {
+			err = -ENOENT;
+			break;
+		}
+
+		err = header_read(&loc, &hdr);
+		if (err) {
+			break;
+		}
+
+		if ((hdr.type == RECORD_TYPE_ACK) || (hdr.seq <= ack_seq)) {
+			continue;
+		}
+
+		cursor->loc = loc;
+		cursor->seq = hdr.seq;
+
+		if (hdr.len > buf_len) {
+			err = -EMSGSIZE;
+			break;
+		}
+
+		err = flash_area_read(fcb.fap, FCB_ENTRY_FA_DATA_OFF(cursor->loc) + sizeof(hdr),
+				      buf, hdr.len);
+		if (err) {
+			break;
+		}
+
+		*type = hdr.type;
+		err = hdr.len;
+		break;
+	}
+
+	k_mutex_unlock(&log_lock);
+	return err;
+}
+
+int data_log_ack(const struct data_log_cursor *cursor)
+{
+	int err = 0;
+
+	k_mutex_lock(&log_lock, K_FOREVER);
+
+	/* Records up to the cursor might already have been acknowledged, or dropped while
+	 * waiting for the acknowledgment.
+	 */
+	if (cursor->seq <= ack_seq) {
+		goto exit;
+	}
+
+	if (cursor->seq > last_seq) {
+		err = -EINVAL;
+		goto exit;
+	}
+
+	ack_seq = cursor->seq;
+	ack_loc = cursor->loc;
+
+	err = record_write(RECORD_TYPE_ACK, 0, &ack_seq, sizeof(ack_seq));
+	if (err) {
+		LOG_ERR("Failed storing acknowledgment, error: %d", err);
+		goto exit;
+	}
+
+	err = sectors_reclaim();
+
+exit:
+	k_mutex_unlock(&log_lock);
+	return err;
+}
+
+int data_log_clear(void)
+{
+	int err;
+
+	k_mutex_lock(&log_lock, K_FOREVER);
+
+	err = fcb_clear(&fcb);
+	if (err) {
+		LOG_ERR("fcb_clear, error: %d", err);
+	} else {
+		last_seq = 0;
+		ack_seq = 0;
+		ack_loc.fe_sector = NULL;
+	}
+
+	k_mutex_unlock(&log_lock);
+	return err;
+}
+
+void data_log_stats_get(struct data_log_stats *stats)
+{
+	k_mutex_lock(&log_lock, K_FOREVER);
+
+	*stats = log_stats;
+	stats->pending = last_seq - ack_seq;
+
+	k_mutex_unlock(&log_lock);
+}
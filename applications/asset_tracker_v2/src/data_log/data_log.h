@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) 2022 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+/**@file
+ *
+ * @brief   Flash-backed data log for Asset Tracker v2
+ */
+
+#ifndef DATA_LOG_H__
+#define DATA_LOG_H__
+
+#include <zephyr/kernel.h>
+#include <zephyr/fs/fcb.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Maximum length of the data stored in a record. */
+#define DATA_LOG_DATA_SIZE_MAX 240
+
+/** @brief Type of the data stored in a record. */
+enum data_log_type {
+	DATA_LOG_TYPE_GNSS = 1,
+	DATA_LOG_TYPE_SENSORS,
+	DATA_LOG_TYPE_MODEM_DYNAMIC,
+	DATA_LOG_TYPE_UI,
+	DATA_LOG_TYPE_IMPACT,
+	DATA_LOG_TYPE_BATTERY,
+};
+
+/** @brief Position in the log. Cursors can be copied to save and restore a position. */
+struct data_log_cursor {
+	/** Location of the last record read. */
+	struct fcb_entry loc;
+	/** Sequence number of the last record read. */
+	uint32_t seq;
+};
+
+/** @brief Data log statistics. */
+struct data_log_stats {
+	/** Number of records that have not been acknowledged. */
+	uint32_t pending;
+	/** Number of records that were erased before being acknowledged. */
+	uint32_t dropped;
+	/** Number of sectors erased since the log was initialized. */
+	uint32_t erases;
+};
+
+/** @brief Initialize the data log.
+ *
+ *  @details Scans the data_log flash partition to restore the records that have not been
+ *	     acknowledged and the position of the last acknowledgment.
+ *
+ *  @return Zero on success, otherwise a negative error code is returned.
+ */
+int data_log_init(void);
+
+/** @brief Append a record to the log.
+ *
+ *  @details If the log is full, the oldest sector is erased to make room for the record.
+ *
+ *  @param[in] type Type of the data.
+ *  @param[in] data Pointer to the data.
+ *  @param[in] len Length of the data.
+ *
+ *  @retval 0 on success.
+ *  @retval -EMSGSIZE if the record does not fit in the record buffer.
+ *  @return Otherwise a negative error code is returned.
+ */
+int data_log_append(enum data_log_type type, const void *data, size_t len);
+
+/** @brief Set a cursor to the position of the last acknowledged record.
+ *
+ *  @param[out] cursor Cursor.
+ */
+void data_log_cursor_init(struct data_log_cursor *cursor);
+
+/** @brief Read the next record that has not been acknowledged and advance the cursor.
+ *
+ *  @param[in,out] cursor Cursor set with data_log_cursor_init().
+ *  @param[out] type Type of the data.
+ *  @param[out] buf Buffer for the data.
+ *  @param[in] buf_len Size of the buffer.
+ *
+ *  @return Length of the data on success.
+ *  @retval -ENOENT if there are no more records.
+ *  @retval -EMSGSIZE if the data does not fit in the buffer. The cursor is advanced past the
+ *		      record.
+ *  @return Otherwise a negative error code is returned.
+ */
+int data_log_read(struct data_log_cursor *cursor, enum data_log_type *type,
+		  void *buf, size_t buf_len);
+
+/** @brief Acknowledge all records up to and including the position of a cursor.
+ *
+ *  @details The acknowledgment is stored in the log, and sectors that only contain
+ *	     acknowledged records are erased.
+ *
+ *  @param[in] cursor Cursor pointing to the last record that was acknowledged.
+ *
+ *  @return Zero on success, otherwise a negative error code is returned.
+ */
+int data_log_ack(const struct data_log_cursor *cursor);
+
+/** @brief Erase all records.
+ *
+ *  @return Zero on success, otherwise a negative error code is returned.
+ */
+int data_log_clear(void);
+
+/** @brief Get data log statistics.
+ *
+ *  @param[out] stats Statistics.
+ */
+void data_log_stats_get(struct data_log_stats *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DATA_LOG_H__ */
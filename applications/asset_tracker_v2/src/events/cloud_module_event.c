@@ -36,6 +36,8 @@ static char *get_evt_type_str(enum cloud_module_event_type type)
 		return "CLOUD_EVT_CONFIG_EMPTY";
 	case CLOUD_EVT_DATA_SEND_QOS:
 		return "CLOUD_EVT_DATA_SEND_QOS";
+	case CLOUD_EVT_BATCH_DATA_ACK:
+		return "CLOUD_EVT_BATCH_DATA_ACK";
 	case CLOUD_EVT_SHUTDOWN_READY:
 		return "CLOUD_EVT_SHUTDOWN_READY";
 	case CLOUD_EVT_FOTA_START:
@@ -88,6 +88,11 @@ enum cloud_module_event_type {
 	 */
 	CLOUD_EVT_DATA_SEND_QOS,
 
+	/** The last batch message sent with @ref DATA_EVT_DATA_SEND_BATCH has been acknowledged
+	 *  by the cloud.
+	 */
+	CLOUD_EVT_BATCH_DATA_ACK,
+
 	/** The cloud module has performed all procedures to prepare for
 	 *  a shutdown of the system. The event carries the ID (id) of the module.
 	 */
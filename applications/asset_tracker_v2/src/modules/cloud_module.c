@@ -104,6 +104,9 @@ const k_tid_t cloud_module_thread;
 QOS_MESSAGE_TYPES_REGISTER(GENERIC, BATCH, UI, NEIGHBOR_CELLS, AGPS_REQUEST,
 			   PGPS_REQUEST, CONFIG, MEMFAULT);
 
+/* Message ID of the last batch message, used to notify when the batch has been acknowledged. */
+static uint16_t batch_message_id;
+
 #if defined(CONFIG_NRF_CLOUD_PGPS)
 /* Local copy of the last A-GPS request from the modem, used to inject correct P-GPS data. */
 static struct nrf_modem_gnss_agps_data_frame agps_request = {
@@ -133,8 +136,8 @@ static struct module_data self = {
 /* Forward declarations. */
 static void connect_check_work_fn(struct k_work *work);
 static void send_config_received(void);
-static void add_qos_message(uint8_t *ptr, size_t len, uint8_t type,
-			    uint32_t flags, bool heap_allocated);
+static uint16_t add_qos_message(uint8_t *ptr, size_t len, uint8_t type,
+				uint32_t flags, bool heap_allocated);
 
 /* Convenience functions used in internal state handling. */
 static char *state2str(enum state_type state)
@@ -448,6 +451,8 @@ static void cloud_wrap_event_handler(const struct cloud_wrap_event *const evt)
 		} else if (err) {
 			LOG_ERR("qos_message_remove, error: %d", err);
 			SEND_ERROR(cloud, CLOUD_EVT_ERROR, err);
+		} else if (evt->message_id == batch_message_id) {
+			SEND_EVENT(cloud, CLOUD_EVT_BATCH_DATA_ACK);
 		}
 
 		break;
@@ -604,9 +609,9 @@ void pgps_handler(struct nrf_cloud_pgps_event *event)
 }
 #endif
 
-/* Convenience function used to add messages to the QoS library. */
-static void add_qos_message(uint8_t *ptr, size_t len, uint8_t type,
-			    uint32_t flags, bool heap_allocated)
+/* Convenience function used to add messages to the QoS library. Returns the message ID. */
+static uint16_t add_qos_message(uint8_t *ptr, size_t len, uint8_t type,
+				uint32_t flags, bool heap_allocated)
 {
 	int err;
 	struct qos_data message = {
@@ -625,6 +630,8 @@ static void add_qos_message(uint8_t *ptr, size_t len, uint8_t type,
 		LOG_ERR("qos_message_add, error: %d", err);
 		SEND_ERROR(cloud, CLOUD_EVT_ERROR, err);
 	}
+
+	return message.id;
 }
 
 static void qos_event_handler(const struct qos_evt *evt)
@@ -869,11 +876,11 @@ static void on_sub_state_cloud_connected(struct cloud_msg_data *msg)
 	}
 
 	if (IS_EVENT(msg, data, DATA_EVT_DATA_SEND_BATCH)) {
-		add_qos_message(msg->module.data.data.buffer.buf,
-				msg->module.data.data.buffer.len,
-				BATCH,
-				QOS_FLAG_RELIABILITY_ACK_REQUIRED,
-				true);
+		batch_message_id = add_qos_message(msg->module.data.data.buffer.buf,
+						   msg->module.data.data.buffer.len,
+						   BATCH,
+						   QOS_FLAG_RELIABILITY_ACK_REQUIRED,
+						   true);
 	}
 
 	if ((IS_EVENT(msg, data, DATA_EVT_UI_DATA_SEND)) ||
@@ -21,6 +21,7 @@
 #endif
 
 #include "cloud/cloud_codec/cloud_codec.h"
+#include "data_log/data_log.h"
 
 #define MODULE data_module
 
@@ -63,6 +64,10 @@ static enum state_type {
 /* Ringbuffers. All data received by the Data module are stored in ringbuffers.
  * Upon a LTE connection loss the device will keep sampling/storing data in
  * the buffers, and empty the buffers in batches upon a reconnect.
+ *
+ * If CONFIG_DATA_LOG is enabled, sampled data is also stored in the flash data log. The
+ * ringbuffers then only provide the latest samples to regular data messages, and batch
+ * messages are encoded from the log.
  */
 static struct cloud_data_gnss gnss_buf[CONFIG_DATA_GNSS_BUFFER_COUNT];
 static struct cloud_data_sensors sensors_buf[CONFIG_DATA_SENSOR_BUFFER_COUNT];
@@ -89,6 +94,34 @@ static int head_ui_buf;
 static int head_impact_buf;
 static int head_bat_buf;
 
+#if defined(CONFIG_DATA_LOG)
+BUILD_ASSERT(sizeof(struct cloud_data_gnss) <= DATA_LOG_DATA_SIZE_MAX);
+BUILD_ASSERT(sizeof(struct cloud_data_sensors) <= DATA_LOG_DATA_SIZE_MAX);
+BUILD_ASSERT(sizeof(struct cloud_data_modem_dynamic) <= DATA_LOG_DATA_SIZE_MAX);
+BUILD_ASSERT(sizeof(struct cloud_data_ui) <= DATA_LOG_DATA_SIZE_MAX);
+BUILD_ASSERT(sizeof(struct cloud_data_impact) <= DATA_LOG_DATA_SIZE_MAX);
+BUILD_ASSERT(sizeof(struct cloud_data_battery) <= DATA_LOG_DATA_SIZE_MAX);
+
+/* Records loaded from the data log and encoded in a single batch message. Separate from the
+ * ringbuffers, which keep the latest samples for regular data messages.
+ */
+static struct cloud_data_gnss log_gnss_buf[CONFIG_DATA_GNSS_BUFFER_COUNT];
+static struct cloud_data_sensors log_sensors_buf[CONFIG_DATA_SENSOR_BUFFER_COUNT];
+static struct cloud_data_ui log_ui_buf[CONFIG_DATA_UI_BUFFER_COUNT];
+static struct cloud_data_impact log_impact_buf[CONFIG_DATA_IMPACT_BUFFER_COUNT];
+static struct cloud_data_battery log_bat_buf[CONFIG_DATA_BATTERY_BUFFER_COUNT];
+static struct cloud_data_modem_dynamic log_modem_dyn_buf[CONFIG_DATA_MODEM_DYNAMIC_BUFFER_COUNT];
+
+/* Position of the last record in the batch message that waits for an acknowledgment. */
+static struct data_log_cursor batch_cursor;
+
+/* Flag set when a batch message with logged data waits for an acknowledgment, and the uptime
+ * when the message was sent.
+ */
+static bool batch_pending;
+static int64_t batch_pending_ts;
+#endif /* CONFIG_DATA_LOG */
+
 static K_SEM_DEFINE(config_load_sem, 0, 1);
 
 /* Default device configuration. */
@@ -452,6 +485,14 @@ static int setup(void)
 		return err;
 	}
 
+#if defined(CONFIG_DATA_LOG)
+	err = data_log_init();
+	if (err) {
+		LOG_ERR("data_log_init, error: %d", err);
+		return err;
+	}
+#endif
+
 	date_time_register_handler(date_time_event_handler);
 	return 0;
 }
@@ -523,6 +564,187 @@ static void data_send(enum data_module_event_type event,
 	memset(data, 0, sizeof(struct cloud_codec_data));
 }
 
+#if defined(CONFIG_DATA_LOG)
+/* Store a sample in the data log. Returns false if the sample could not be stored. */
+static bool data_log_store(enum data_log_type type, const void *data, size_t len)
+{
+	int err = data_log_append(type, data, len);
+
+	if (err) {
+		LOG_ERR("data_log_append, error: %d", err);
+		return false;
+	}
+
+	return true;
+}
+
+/* Load the oldest records that have not been acknowledged into the batch buffers. Loading stops
+ * when the buffer of a record type is full, so that one batch message carries at most as many
+ * entries as the ringbuffers can hold. The cursor is left at the last record loaded.
+ */
+static size_t data_log_batch_load(struct data_log_cursor *cursor)
+{
+	int len;
+	size_t count = 0;
+	enum data_log_type type;
+	struct data_log_cursor prev;
+	static uint8_t record[DATA_LOG_DATA_SIZE_MAX] __aligned(8);
+	struct {
+		void *buf;
+		size_t size;
+		size_t capacity;
+		size_t count;
+	} window[] = {
+		[DATA_LOG_TYPE_GNSS] = { log_gnss_buf, sizeof(log_gnss_buf[0]),
+					 ARRAY_SIZE(log_gnss_buf) },
+		[DATA_LOG_TYPE_SENSORS] = { log_sensors_buf, sizeof(log_sensors_buf[0]),
+					    ARRAY_SIZE(log_sensors_buf) },
+		[DATA_LOG_TYPE_MODEM_DYNAMIC] = { log_modem_dyn_buf, sizeof(log_modem_dyn_buf[0]),
+						  ARRAY_SIZE(log_modem_dyn_buf) },
+		[DATA_LOG_TYPE_UI] = { log_ui_buf, sizeof(log_ui_buf[0]), ARRAY_SIZE(log_ui_buf) },
+		[DATA_LOG_TYPE_IMPACT] = { log_impact_buf, sizeof(log_impact_buf[0]),
+					   ARRAY_SIZE(log_impact_buf) },
+		[DATA_LOG_TYPE_BATTERY] = { log_bat_buf, sizeof(log_bat_buf[0]),
+					    ARRAY_SIZE(log_bat_buf) },
+	};
+
+	for (size_t i = 0; i < ARRAY_SIZE(window); i++) {
+		if (window[i].buf != NULL) {
+			memset(window[i].buf, 0, window[i].size * window[i].capacity);
+		}
+	}
+
+	while (true) {
+		prev = *cursor;
+
+		len = data_log_read(cursor, &type, record, sizeof(record));
+		if (len == -ENOENT) {
+			break;
+		} else if (len < 0) {
+			LOG_ERR("data_log_read, error: %d", len);
+			*cursor = prev;
+			break;
+		}
+
+		if ((type >= ARRAY_SIZE(window)) || (window[type].buf == NULL) ||
+		    (len != window[type].size)) {
+			/* Records that can not be encoded are acknowledged with the batch. */
+			LOG_WRN("Skipping record of type %d, length %d", type, len);
+			continue;
+		}
+
+		if (window[type].count == window[type].capacity) {
+			*cursor = prev;
+			break;
+		}
+
+		memcpy((uint8_t *)window[type].buf + (window[type].count * window[type].size),
+		       record, len);
+		window[type].count++;
+		count++;
+	}
+
+	return count;
+}
+
+/* Encode and send the oldest logged data that has not been acknowledged in a batch message.
+ * Only one batch message waits for an acknowledgment at a time. The next one is sent when the
+ * acknowledgment is received, or if it is not received in time.
+ */
+static void data_log_batch_send(void)
+{
+	int err;
+	size_t count;
+	struct data_log_cursor cursor;
+	struct cloud_codec_data codec = { 0 };
+
+	if (batch_pending &&
+	    ((k_uptime_get() - batch_pending_ts) <
+	     (CONFIG_DATA_LOG_ACK_TIMEOUT_SECONDS * MSEC_PER_SEC))) {
+		LOG_DBG("Previous batch has not been acknowledged yet");
+		return;
+	}
+
+	batch_pending = false;
+
+	data_log_cursor_init(&cursor);
+
+	count = data_log_batch_load(&cursor);
+	if (count == 0) {
+		LOG_DBG("No logged data to encode");
+
+		/* Acknowledge any records that were skipped. */
+		(void)data_log_ack(&cursor);
+		return;
+	}
+
+	err = cloud_codec_encode_batch_data(&codec,
+					    log_gnss_buf,
+					    log_sensors_buf,
+					    &modem_stat,
+					    log_modem_dyn_buf,
+					    log_ui_buf,
+					    log_impact_buf,
+					    log_bat_buf,
+					    ARRAY_SIZE(log_gnss_buf),
+					    ARRAY_SIZE(log_sensors_buf),
+					    MODEM_STATIC_ARRAY_SIZE,
+					    ARRAY_SIZE(log_modem_dyn_buf),
+					    ARRAY_SIZE(log_ui_buf),
+					    ARRAY_SIZE(log_impact_buf),
+					    ARRAY_SIZE(log_bat_buf));
+	switch (err) {
+	case 0:
+		LOG_DBG("%zu logged entries encoded successfully", count);
+		batch_cursor = cursor;
+		batch_pending = true;
+		batch_pending_ts = k_uptime_get();
+		data_send(DATA_EVT_DATA_SEND_BATCH, &codec);
+		break;
+	case -ENODATA:
+		LOG_DBG("No batch data to encode");
+		break;
+	case -ENOTSUP:
+		LOG_DBG("Encoding of batch data not supported");
+		break;
+	default:
+		LOG_ERR("Error batch-enconding logged data: %d", err);
+		SEND_ERROR(data, DATA_EVT_ERROR, err);
+		break;
+	}
+}
+
+/* Acknowledge the logged data sent in the pending batch message and continue with the next
+ * batch message, if any.
+ */
+static void data_log_batch_ack(void)
+{
+	int err;
+
+	if (!batch_pending) {
+		return;
+	}
+
+	batch_pending = false;
+
+	err = data_log_ack(&batch_cursor);
+	if (err) {
+		LOG_ERR("data_log_ack, error: %d", err);
+		SEND_ERROR(data, DATA_EVT_ERROR, err);
+		return;
+	}
+
+	if ((state == STATE_CLOUD_CONNECTED) && date_time_is_valid()) {
+		data_log_batch_send();
+	}
+}
+#else
+static bool data_log_store(enum data_log_type type, const void *data, size_t len)
+{
+	return false;
+}
+#endif /* CONFIG_DATA_LOG */
+
 /* This function allocates buffer on the heap, which needs to be freed after use. */
 static void data_encode(void)
 {
@@ -614,6 +836,9 @@ static void data_encode(void)
 	}
 
 	if (grant_send(BATCH, &coneval, override)) {
+#if defined(CONFIG_DATA_LOG)
+		data_log_batch_send();
+#else
 		err = cloud_codec_encode_batch_data(&codec,
 						    gnss_buf,
 						    sensors_buf,
@@ -645,6 +870,7 @@ static void data_encode(void)
 			SEND_ERROR(data, DATA_EVT_ERROR, err);
 			return;
 		}
+#endif /* CONFIG_DATA_LOG */
 	}
 }
 
@@ -1139,6 +1365,13 @@ static void on_cloud_state_connected(struct data_msg_data *msg)
 		return;
 	}
 
+#if defined(CONFIG_DATA_LOG)
+	if (IS_EVENT(msg, cloud, CLOUD_EVT_BATCH_DATA_ACK)) {
+		data_log_batch_ack();
+		return;
+	}
+#endif
+
 	if (IS_EVENT(msg, cloud, CLOUD_EVT_CONFIG_EMPTY)) {
 		config_send();
 		return;
@@ -1223,9 +1456,13 @@ static void on_all_states(struct data_msg_data *msg)
 			.queued = true
 		};
 
-		cloud_codec_populate_ui_buffer(ui_buf, &new_ui_data,
-					       &head_ui_buf,
-					       ARRAY_SIZE(ui_buf));
+		/* UI data is sent right away if the cloud is connected. */
+		if ((state == STATE_CLOUD_CONNECTED) ||
+		    !data_log_store(DATA_LOG_TYPE_UI, &new_ui_data, sizeof(new_ui_data))) {
+			cloud_codec_populate_ui_buffer(ui_buf, &new_ui_data,
+						       &head_ui_buf,
+						       ARRAY_SIZE(ui_buf));
+		}
 
 		SEND_EVENT(data, DATA_EVT_UI_DATA_READY);
 		return;
@@ -1301,11 +1538,13 @@ static void on_all_states(struct data_msg_data *msg)
 		strcpy(new_modem_data.apn, msg->module.modem.data.modem_dynamic.apn);
 		strcpy(new_modem_data.mccmnc, msg->module.modem.data.modem_dynamic.mccmnc);
 
-		cloud_codec_populate_modem_dynamic_buffer(
-						modem_dyn_buf,
-						&new_modem_data,
-						&head_modem_dyn_buf,
-						ARRAY_SIZE(modem_dyn_buf));
+		(void)data_log_store(DATA_LOG_TYPE_MODEM_DYNAMIC, &new_modem_data,
+				     sizeof(new_modem_data));
+
+		cloud_codec_populate_modem_dynamic_buffer(modem_dyn_buf,
+							  &new_modem_data,
+							  &head_modem_dyn_buf,
+							  ARRAY_SIZE(modem_dyn_buf));
 
 		requested_data_status_set(APP_DATA_MODEM_DYNAMIC);
 	}
@@ -1321,6 +1560,9 @@ static void on_all_states(struct data_msg_data *msg)
 			.queued = true
 		};
 
+		(void)data_log_store(DATA_LOG_TYPE_BATTERY, &new_battery_data,
+				     sizeof(new_battery_data));
+
 		cloud_codec_populate_bat_buffer(bat_buf, &new_battery_data,
 						&head_bat_buf,
 						ARRAY_SIZE(bat_buf));
@@ -1338,6 +1580,9 @@ static void on_all_states(struct data_msg_data *msg)
 			.queued = true
 		};
 
+		(void)data_log_store(DATA_LOG_TYPE_SENSORS, &new_sensor_data,
+				     sizeof(new_sensor_data));
+
 		cloud_codec_populate_sensor_buffer(sensors_buf,
 						   &new_sensor_data,
 						   &head_sensor_buf,
@@ -1357,9 +1602,15 @@ static void on_all_states(struct data_msg_data *msg)
 			.queued = true
 		};
 
-		cloud_codec_populate_impact_buffer(impact_buf, &new_impact_data,
-						   &head_impact_buf,
-						   ARRAY_SIZE(impact_buf));
+		/* Impact data is sent right away if the cloud is connected. */
+		if ((state == STATE_CLOUD_CONNECTED) ||
+		    !data_log_store(DATA_LOG_TYPE_IMPACT, &new_impact_data,
+				    sizeof(new_impact_data))) {
+			cloud_codec_populate_impact_buffer(impact_buf, &new_impact_data,
+							   &head_impact_buf,
+							   ARRAY_SIZE(impact_buf));
+		}
+
 		SEND_EVENT(data, DATA_EVT_IMPACT_DATA_READY);
 		return;
 	}
@@ -1398,6 +1649,8 @@ static void on_all_states(struct data_msg_data *msg)
 			return;
 		}
 
+		(void)data_log_store(DATA_LOG_TYPE_GNSS, &new_gnss_data, sizeof(new_gnss_data));
+
 		cloud_codec_populate_gnss_buffer(gnss_buf, &new_gnss_data,
 						&head_gnss_buf,
 						ARRAY_SIZE(gnss_buf));
@@ -0,0 +1,442 @@
+/*
+ * Copyright (c) 2022 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include <ztest.h>
+#include <zephyr/kernel.h>
+#include <stdlib.h>
+#include <string.h>
+#include <cJSON.h>
+#include <cJSON_os.h>
+#include <zcbor_common.h>
+#include <zcbor_decode.h>
+
+#include "cloud_codec.h"
+#include "columnar_batch.h"
+#include "json_common.h"
+#include "json_protocol_names.h"
+#include "trace.h"
+
+/* Must match the offset added by the date_time mock. */
+#define BOOT_TIME_MS 1563968747123
+
+#define CBOR_MAX_DEPTH 4
+#define CBOR_BREAK 0xFF
+#define COLUMN_VALUES_MAX 64
+
+/* Working copies of the trace, encoding modifies the buffers. */
+static struct cloud_data_gnss gnss[TRACE_GNSS_COUNT];
+static struct cloud_data_sensors sensors[TRACE_SENSOR_COUNT];
+static struct cloud_data_battery battery[TRACE_BATTERY_COUNT];
+static struct cloud_data_modem_dynamic modem_dynamic[TRACE_MODEM_DYNAMIC_COUNT];
+
+static struct cloud_codec_data output;
+
+/* Values of one column, with the deltas summed up. */
+static struct column_values {
+	bool numeric;
+	int32_t exp;
+	size_t count;
+	int64_t values[COLUMN_VALUES_MAX];
+	bool present[COLUMN_VALUES_MAX];
+	struct zcbor_string strings[COLUMN_VALUES_MAX];
+} column;
+
+static bool key_is(const struct zcbor_string *key, const char *str)
+{
+	return (key->len == strlen(str)) && (memcmp(key->value, str, key->len) == 0);
+}
+
+/* Works for both definite and indefinite length maps and arrays. */
+static bool has_entry(const zcbor_state_t *zsd)
+{
+	return (zsd->elem_count > 0) && (zsd->payload < zsd->payload_end) &&
+	       (*zsd->payload != CBOR_BREAK);
+}
+
+static bool values_decode(zcbor_state_t *zsd, struct column_values *col)
+{
+	int64_t sum = 0;
+	int64_t delta;
+
+	if (!zcbor_list_start_decode(zsd)) {
+		return false;
+	}
+
+	col->numeric = zcbor_int32_decode(zsd, &col->exp);
+
+	while (has_entry(zsd)) {
+		zassert_true(col->count < COLUMN_VALUES_MAX, "Too many values");
+
+		if (zcbor_nil_expect(zsd, NULL)) {
+			col->present[col->count] = false;
+		} else if (col->numeric) {
+			if (!zcbor_int64_decode(zsd, &delta)) {
+				return false;
+			}
+
+			sum += delta;
+			col->values[col->count] = sum;
+			col->present[col->count] = true;
+		} else {
+			if (!zcbor_tstr_decode(zsd, &col->strings[col->count])) {
+				return false;
+			}
+
+			col->present[col->count] = true;
+		}
+
+		col->count++;
+	}
+
+	return zcbor_list_end_decode(zsd);
+}
+
+/* Decode one column of an encoded batch message. */
+static int column_decode(const char *table_key, const char *column_key)
+{
+	int32_t version = 0;
+	struct zcbor_string key;
+
+	ZCBOR_STATE_D(zsd, CBOR_MAX_DEPTH, (const uint8_t *)output.buf, output.len, 1);
+
+	memset(&column, 0, sizeof(column));
+
+	if (!zcbor_map_start_decode(zsd)) {
+		return -EBADMSG;
+	}
+
+	while (has_entry(zsd)) {
+		if (!zcbor_tstr_decode(zsd, &key)) {
+			return -EBADMSG;
+		}
+
+		if (key_is(&key, DATA_VALUE)) {
+			if (!zcbor_int32_decode(zsd, &version)) {
+				return -EBADMSG;
+			}
+
+			zassert_equal(version, COLUMNAR_BATCH_VERSION, "Wrong version: %d",
+				      version);
+			continue;
+		}
+
+		if (!key_is(&key, table_key)) {
+			if (!zcbor_any_skip(zsd, NULL)) {
+				return -EBADMSG;
+			}
+
+			continue;
+		}
+
+		if (!zcbor_map_start_decode(zsd)) {
+			return -EBADMSG;
+		}
+
+		while (has_entry(zsd)) {
+			if (!zcbor_tstr_decode(zsd, &key)) {
+				return -EBADMSG;
+			}
+
+			if (key_is(&key, column_key)) {
+				return values_decode(zsd, &column) ? 0 : -EBADMSG;
+			}
+
+			if (!zcbor_any_skip(zsd, NULL)) {
+				return -EBADMSG;
+			}
+		}
+	}
+
+	return -ENOENT;
+}
+
+static double column_value(size_t idx)
+{
+	double value = column.values[idx];
+
+	for (int i = column.exp; i < 0; i++) {
+		value /= 10;
+	}
+
+	return value;
+}
+
+static void column_check(const char *table_key, const char *column_key, size_t count,
+			 int32_t exp)
+{
+	int err = column_decode(table_key, column_key);
+
+	zassert_equal(err, 0, "Failed decoding %s.%s, error: %d", table_key, column_key, err);
+	zassert_equal(column.count, count, "Wrong number of values in %s.%s: %zu",
+		      table_key, column_key, column.count);
+	zassert_true(column.numeric, "%s.%s is not numeric", table_key, column_key);
+	zassert_equal(column.exp, exp, "Wrong exponent for %s.%s: %d",
+		      table_key, column_key, column.exp);
+}
+
+static void value_check(size_t idx, double expected)
+{
+	double resolution = 1.0;
+
+	for (int i = column.exp; i < 0; i++) {
+		resolution /= 10;
+	}
+
+	zassert_true(column.present[idx], "Value %zu missing", idx);
+	zassert_within(column_value(idx), expected, resolution,
+		       "Value %zu is %f, expected %f", idx, column_value(idx), expected);
+}
+
+static int batch_encode(void)
+{
+	return columnar_batch_encode(&output, gnss, sensors, NULL, modem_dynamic, NULL, NULL,
+				     battery, ARRAY_SIZE(gnss), ARRAY_SIZE(sensors), 0,
+				     ARRAY_SIZE(modem_dynamic), 0, 0, ARRAY_SIZE(battery));
+}
+
+/* Encode the buffers into a JSON batch message, in the same way as the AWS IoT codec. */
+static int json_batch_encode(void)
+{
+	int err = 0;
+	cJSON *root_obj = cJSON_CreateObject();
+
+	zassert_not_null(root_obj, "Failed to allocate root object");
+
+	err = json_common_batch_data_add(root_obj, JSON_COMMON_MODEM_DYNAMIC, modem_dynamic,
+					 ARRAY_SIZE(modem_dynamic), DATA_MODEM_DYNAMIC);
+	err = err ? err : json_common_batch_data_add(root_obj, JSON_COMMON_GNSS, gnss,
+						     ARRAY_SIZE(gnss), DATA_GNSS);
+	err = err ? err : json_common_batch_data_add(root_obj, JSON_COMMON_SENSOR, sensors,
+						     ARRAY_SIZE(sensors), DATA_ENVIRONMENTALS);
+	err = err ? err : json_common_batch_data_add(root_obj, JSON_COMMON_BATTERY, battery,
+						     ARRAY_SIZE(battery), DATA_BATTERY);
+	if (err) {
+		cJSON_Delete(root_obj);
+		return err;
+	}
+
+	output.buf = cJSON_PrintUnformatted(root_obj);
+	cJSON_Delete(root_obj);
+
+	if (output.buf == NULL) {
+		return -ENOMEM;
+	}
+
+	output.len = strlen(output.buf);
+	return 0;
+}
+
+static void setup(void)
+{
+	memcpy(gnss, trace_gnss, sizeof(gnss));
+	memcpy(sensors, trace_sensors, sizeof(sensors));
+	memcpy(battery, trace_battery, sizeof(battery));
+	memcpy(modem_dynamic, trace_modem_dynamic, sizeof(modem_dynamic));
+	memset(&output, 0, sizeof(output));
+}
+
+static void teardown(void)
+{
+	k_free(output.buf);
+}
+
+static void test_encode_trace(void)
+{
+	int err = batch_encode();
+
+	zassert_equal(err, 0, "columnar_batch_encode, error: %d", err);
+
+	column_check(DATA_GNSS, DATA_TIMESTAMP, TRACE_GNSS_COUNT, 0);
+	for (size_t i = 0; i < TRACE_GNSS_COUNT; i++) {
+		zassert_equal(column.values[i], trace_gnss[i].gnss_ts + BOOT_TIME_MS,
+			      "Wrong timestamp %zu", i);
+	}
+
+	column_check(DATA_GNSS, DATA_GNSS_LATITUDE, TRACE_GNSS_COUNT, -7);
+	for (size_t i = 0; i < TRACE_GNSS_COUNT; i++) {
+		value_check(i, trace_gnss[i].pvt.lat);
+	}
+
+	column_check(DATA_GNSS, DATA_GNSS_LONGITUDE, TRACE_GNSS_COUNT, -7);
+	for (size_t i = 0; i < TRACE_GNSS_COUNT; i++) {
+		value_check(i, trace_gnss[i].pvt.longi);
+	}
+
+	column_check(DATA_GNSS, DATA_GNSS_ALTITUDE, TRACE_GNSS_COUNT, -1);
+	for (size_t i = 0; i < TRACE_GNSS_COUNT; i++) {
+		value_check(i, trace_gnss[i].pvt.alt);
+	}
+
+	column_check(DATA_GNSS, DATA_GNSS_SPEED, TRACE_GNSS_COUNT, -2);
+	for (size_t i = 0; i < TRACE_GNSS_COUNT; i++) {
+		value_check(i, trace_gnss[i].pvt.spd);
+	}
+
+	column_check(DATA_ENVIRONMENTALS, DATA_PRESSURE, TRACE_SENSOR_COUNT, -3);
+	for (size_t i = 0; i < TRACE_SENSOR_COUNT; i++) {
+		value_check(i, trace_sensors[i].pressure);
+	}
+
+	column_check(DATA_BATTERY, DATA_VALUE, TRACE_BATTERY_COUNT, 0);
+	for (size_t i = 0; i < TRACE_BATTERY_COUNT; i++) {
+		value_check(i, trace_battery[i].bat);
+	}
+
+	column_check(DATA_MODEM_DYNAMIC, MODEM_CELL_ID, TRACE_MODEM_DYNAMIC_COUNT, 0);
+	for (size_t i = 0; i < TRACE_MODEM_DYNAMIC_COUNT; i++) {
+		value_check(i, trace_modem_dynamic[i].cell);
+	}
+
+	column_check(DATA_MODEM_DYNAMIC, MODEM_MCCMNC, TRACE_MODEM_DYNAMIC_COUNT, 0);
+	for (size_t i = 0; i < TRACE_MODEM_DYNAMIC_COUNT; i++) {
+		value_check(i, 24202);
+	}
+
+	/* The IP address is only fresh in the first entry. */
+	err = column_decode(DATA_MODEM_DYNAMIC, MODEM_IP_ADDRESS);
+	zassert_equal(err, 0, "Failed decoding IP address column, error: %d", err);
+	zassert_false(column.numeric, "IP address column is numeric");
+	zassert_true(key_is(&column.strings[0], "10.160.33.51"), "Wrong IP address");
+	for (size_t i = 1; i < TRACE_MODEM_DYNAMIC_COUNT; i++) {
+		zassert_false(column.present[i], "IP address %zu not null", i);
+	}
+
+	/* Encoded entries are unqueued. */
+	for (size_t i = 0; i < TRACE_GNSS_COUNT; i++) {
+		zassert_false(gnss[i].queued, "GNSS entry %zu still queued", i);
+	}
+
+	for (size_t i = 0; i < TRACE_MODEM_DYNAMIC_COUNT; i++) {
+		zassert_false(modem_dynamic[i].queued, "Modem entry %zu still queued", i);
+	}
+}
+
+static void test_size_and_cycles_compared_to_json(void)
+{
+	int err;
+	size_t json_len, columnar_len;
+	uint32_t json_cycles, columnar_cycles;
+	uint32_t start;
+
+	start = k_cycle_get_32();
+	err = json_batch_encode();
+	json_cycles = k_cycle_get_32() - start;
+
+	zassert_equal(err, 0, "JSON encoding failed, error: %d", err);
+
+	json_len = output.len;
+	cJSON_FreeString(output.buf);
+
+	setup();
+
+	start = k_cycle_get_32();
+	err = batch_encode();
+	columnar_cycles = k_cycle_get_32() - start;
+
+	zassert_equal(err, 0, "columnar_batch_encode, error: %d", err);
+
+	columnar_len = output.len;
+
+	printk("Trace of %d samples:\n", TRACE_GNSS_COUNT + TRACE_SENSOR_COUNT +
+	       TRACE_BATTERY_COUNT + TRACE_MODEM_DYNAMIC_COUNT);
+	printk("  JSON:     %6zu bytes, %8u cycles\n", json_len, json_cycles);
+	printk("  Columnar: %6zu bytes, %8u cycles (%d %% of JSON)\n",
+	       columnar_len, columnar_cycles, (int)(100 * columnar_len / json_len));
+
+	/* The cycle counter does not advance while code runs on native_posix, so only the
+	 * size is checked.
+	 */
+	zassert_true(columnar_len * 4 < json_len,
+		     "Columnar message is %zu bytes, JSON message is %zu bytes",
+		     columnar_len, json_len);
+}
+
+static void test_missing_values(void)
+{
+	int err;
+
+	/* NMEA fixes are placed in a separate column. */
+	gnss[1].format = CLOUD_CODEC_GNSS_FORMAT_NMEA;
+	strcpy(gnss[1].nmea, "$GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*47");
+
+	sensors[2].bsec_air_quality = -1;
+	modem_dynamic[0].rsrp_fresh = false;
+
+	/* Entries without any fresh values are not encoded. */
+	modem_dynamic[1].area_code_fresh = false;
+	modem_dynamic[1].cell_id_fresh = false;
+	modem_dynamic[1].rsrp_fresh = false;
+	modem_dynamic[1].mccmnc_fresh = false;
+	modem_dynamic[1].band_fresh = false;
+	modem_dynamic[1].nw_mode_fresh = false;
+
+	err = batch_encode();
+	zassert_equal(err, 0, "columnar_batch_encode, error: %d", err);
+
+	column_check(DATA_GNSS, DATA_GNSS_LATITUDE, TRACE_GNSS_COUNT - 1, -7);
+	value_check(0, trace_gnss[0].pvt.lat);
+	value_check(1, trace_gnss[2].pvt.lat);
+
+	err = column_decode(DATA_GNSS_NMEA, DATA_VALUE);
+	zassert_equal(err, 0, "Failed decoding NMEA column, error: %d", err);
+	zassert_equal(column.count, 1, "Wrong number of NMEA values: %zu", column.count);
+	zassert_true(key_is(&column.strings[0], gnss[1].nmea), "Wrong NMEA string");
+
+	column_check(DATA_ENVIRONMENTALS, DATA_BSEC_IAQ, TRACE_SENSOR_COUNT, 0);
+	zassert_false(column.present[2], "Missing air quality not null");
+	value_check(3, trace_sensors[3].bsec_air_quality);
+
+	column_check(DATA_MODEM_DYNAMIC, MODEM_RSRP, TRACE_MODEM_DYNAMIC_COUNT - 1, 0);
+	zassert_false(column.present[0], "Missing RSRP not null");
+	value_check(1, trace_modem_dynamic[2].rsrp);
+
+	zassert_false(modem_dynamic[1].queued, "Modem entry without values still queued");
+}
+
+static void test_no_data(void)
+{
+	int err;
+
+	for (size_t i = 0; i < TRACE_GNSS_COUNT; i++) {
+		gnss[i].queued = false;
+	}
+
+	for (size_t i = 0; i < TRACE_SENSOR_COUNT; i++) {
+		sensors[i].queued = false;
+	}
+
+	for (size_t i = 0; i < TRACE_BATTERY_COUNT; i++) {
+		battery[i].queued = false;
+	}
+
+	for (size_t i = 0; i < TRACE_MODEM_DYNAMIC_COUNT; i++) {
+		modem_dynamic[i].queued = false;
+	}
+
+	/* A queued GNSS entry in an invalid format is unqueued but not encoded. */
+	gnss[0].queued = true;
+	gnss[0].format = CLOUD_CODEC_GNSS_FORMAT_INVALID;
+
+	err = batch_encode();
+	zassert_equal(err, -ENODATA, "Wrong return value: %d", err);
+	zassert_false(gnss[0].queued, "Invalid GNSS entry still queued");
+	zassert_is_null(output.buf, "Output allocated");
+}
+
+void test_main(void)
+{
+	cJSON_Init();
+
+	ztest_test_suite(columnar_batch,
+		ztest_unit_test_setup_teardown(test_encode_trace, setup, teardown),
+		ztest_unit_test_setup_teardown(test_size_and_cycles_compared_to_json, setup,
+					       teardown),
+		ztest_unit_test_setup_teardown(test_missing_values, setup, teardown),
+		ztest_unit_test_setup_teardown(test_no_data, setup, teardown)
+	);
+
+	ztest_run_test_suite(columnar_batch);
+}
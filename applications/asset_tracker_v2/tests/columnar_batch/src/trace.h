@@ -0,0 +1,381 @@
+/*
+ * Copyright (c) 2022 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+/* Trace of a 48 minute drive, with GNSS, sensor and battery samples every minute and dynamic modem
+ * data every 4 minutes, as buffered by the data module. Timestamps are uptime in milliseconds.
+ */
+
+#ifndef TRACE_H__
+#define TRACE_H__
+
+#include "cloud_codec.h"
+
+#define TRACE_GNSS_COUNT 48
+#define TRACE_SENSOR_COUNT 48
+#define TRACE_BATTERY_COUNT 48
+#define TRACE_MODEM_DYNAMIC_COUNT 12
+
+static const struct cloud_data_gnss trace_gnss[TRACE_GNSS_COUNT] = {
+	{ .gnss_ts = 62018, .format = CLOUD_CODEC_GNSS_FORMAT_PVT, .queued = true,
+	  .pvt = { .lat = 63.4331909, .longi = 10.4106231, .alt = 9.2f, .acc = 2.5f,
+		   .spd = 13.79f, .hdg = 68.9f } },
+	{ .gnss_ts = 121398, .format = CLOUD_CODEC_GNSS_FORMAT_PVT, .queued = true,
+	  .pvt = { .lat = 63.4367545, .longi = 10.4270843, .alt = 8.2f, .acc = 8.2f,
+		   .spd = 15.17f, .hdg = 64.2f } },
+	{ .gnss_ts = 182013, .format = CLOUD_CODEC_GNSS_FORMAT_PVT, .queued = true,
+	  .pvt = { .lat = 63.4416883, .longi = 10.4392566, .alt = 10.3f, .acc = 6.4f,
+		   .spd = 13.63f, .hdg = 47.8f } },
+	{ .gnss_ts = 241756, .format = CLOUD_CODEC_GNSS_FORMAT_PVT, .queued = true,
+	  .pvt = { .lat = 63.4445606, .longi = 10.4523342, .alt = 10.0f, .acc = 9.3f,
+		   .spd = 12.09f, .hdg = 63.8f } },
+	{ .gnss_ts = 301534, .format = CLOUD_CODEC_GNSS_FORMAT_PVT, .queued = true,
+	  .pvt = { .lat = 63.4487214, .longi = 10.4658552, .alt = 9.3f, .acc = 4.7f,
+		   .spd = 13.61f, .hdg = 55.5f } },
+	{ .gnss_ts = 361444, .format = CLOUD_CODEC_GNSS_FORMAT_PVT, .queued = true,
+	  .pvt = { .lat = 63.4515041, .longi = 10.4830929, .alt = 7.9f, .acc = 9.1f,
+		   .spd = 15.20f, .hdg = 70.1f } },
+	{ .gnss_ts = 421879, .format = CLOUD_CODEC_GNSS_FORMAT_PVT, .queued = true,
+	  .pvt = { .lat = 63.4509154, .longi = 10.5021754, .alt = 10.7f, .acc = 4.3f,
+		   .spd = 15.86f, .hdg = 93.9f } },
+	{ .gnss_ts = 481387, .format = CLOUD_CODEC_GNSS_FORMAT_PVT, .queued = true,
+	  .pvt = { .lat = 63.4518886, .longi = 10.5131925, .alt = 9.8f, .acc = 6.1f,
+		   .spd = 9.31f, .hdg = 78.8f } },
+	{ .gnss_ts = 541364, .format = CLOUD_CODEC_GNSS_FORMAT_PVT, .queued = true,
+	  .pvt = { .lat = 63.4528038, .longi = 10.5273637, .alt = 11.0f, .acc = 8.7f,
+		   .spd = 11.87f, .hdg = 81.8f } },
+	{ .gnss_ts = 601911, .format = CLOUD_CODEC_GNSS_FORMAT_PVT, .queued = true,
+	  .pvt = { .lat = 63.4545523, .longi = 10.5393358, .alt = 13.8f, .acc = 4.6f,
+		   .spd = 10.44f, .hdg = 71.9f } },
+	{ .gnss_ts = 661674, .format = CLOUD_CODEC_GNSS_FORMAT_PVT, .queued = true,
+	  .pvt = { .lat = 63.4586584, .longi = 10.5566121, .alt = 11.1f, .acc = 3.0f,
+		   .spd = 16.22f, .hdg = 62.0f } },
+	{ .gnss_ts = 721401, .format = CLOUD_CODEC_GNSS_FORMAT_PVT, .queued = true,
+	  .pvt = { .lat = 63.4609946, .longi = 10.5719538, .alt = 9.0f, .acc = 7.4f,
+		   .spd = 13.44f, .hdg = 71.2f } },
+	{ .gnss_ts = 781943, .format = CLOUD_CODEC_GNSS_FORMAT_PVT, .queued = true,
+	  .pvt = { .lat = 63.4634257, .longi = 10.5833016, .alt = 6.9f, .acc = 6.5f,
+		   .spd = 10.43f, .hdg = 64.4f } },
+	{ .gnss_ts = 841320, .format = CLOUD_CODEC_GNSS_FORMAT_PVT, .queued = true,
+	  .pvt = { .lat = 63.4667270, .longi = 10.5930244, .alt = 5.8f, .acc = 2.5f,
+		   .spd = 10.12f, .hdg = 52.8f } },
+	{ .gnss_ts = 901979, .format = CLOUD_CODEC_GNSS_FORMAT_PVT, .queued = true,
+	  .pvt = { .lat = 63.4707123, .longi = 10.6088499, .alt = 3.1f, .acc = 5.7f,
+		   .spd = 15.06f, .hdg = 60.6f } },
+	{ .gnss_ts = 961414, .format = CLOUD_CODEC_GNSS_FORMAT_PVT, .queued = true,
+	  .pvt = { .lat = 63.4777546, .longi = 10.6203337, .alt = 5.8f, .acc = 3.0f,
+		   .spd = 16.16f, .hdg = 36.1f } },
+	{ .gnss_ts = 1021683, .format = CLOUD_CODEC_GNSS_FORMAT_PVT, .queued = true,
+	  .pvt = { .lat = 63.4862234, .longi = 10.6275339, .alt = 4.4f, .acc = 5.7f,
+		   .spd = 16.81f, .hdg = 20.8f } },
+	{ .gnss_ts = 1081749, .format = CLOUD_CODEC_GNSS_FORMAT_PVT, .queued = true,
+	  .pvt = { .lat = 63.4907882, .longi = 10.6330805, .alt = 6.6f, .acc = 7.7f,
+		   .spd = 9.63f, .hdg = 28.5f } },
+	{ .gnss_ts = 1141353, .format = CLOUD_CODEC_GNSS_FORMAT_PVT, .queued = true,
+	  .pvt = { .lat = 63.4954550, .longi = 10.6383390, .alt = 4.0f, .acc = 9.0f,
+		   .spd = 9.69f, .hdg = 26.7f } },
+	{ .gnss_ts = 1202113, .format = CLOUD_CODEC_GNSS_FORMAT_PVT, .queued = true,
+	  .pvt = { .lat = 63.5009829, .longi = 10.6412383, .alt = 6.5f, .acc = 3.0f,
+		   .spd = 10.53f, .hdg = 13.2f } },
+	{ .gnss_ts = 1261402, .format = CLOUD_CODEC_GNSS_FORMAT_PVT, .queued = true,
+	  .pvt = { .lat = 63.5060755, .longi = 10.6466778, .alt = 6.3f, .acc = 2.6f,
+		   .spd = 10.47f, .hdg = 25.5f } },
+	{ .gnss_ts = 1321708, .format = CLOUD_CODEC_GNSS_FORMAT_PVT, .queued = true,
+	  .pvt = { .lat = 63.5116134, .longi = 10.6529141, .alt = 8.3f, .acc = 9.2f,
+		   .spd = 11.50f, .hdg = 26.7f } },
+	{ .gnss_ts = 1382134, .format = CLOUD_CODEC_GNSS_FORMAT_PVT, .queued = true,
+	  .pvt = { .lat = 63.5171976, .longi = 10.6589760, .alt = 8.4f, .acc = 9.0f,
+		   .spd = 11.51f, .hdg = 25.8f } },
+	{ .gnss_ts = 1441855, .format = CLOUD_CODEC_GNSS_FORMAT_PVT, .queued = true,
+	  .pvt = { .lat = 63.5225388, .longi = 10.6713536, .alt = 10.6f, .acc = 7.4f,
+		   .spd = 14.25f, .hdg = 45.9f } },
+	{ .gnss_ts = 1502009, .format = CLOUD_CODEC_GNSS_FORMAT_PVT, .queued = true,
+	  .pvt = { .lat = 63.5289146, .longi = 10.6784579, .alt = 12.7f, .acc = 7.3f,
+		   .spd = 13.21f, .hdg = 26.4f } },
+	{ .gnss_ts = 1562012, .format = CLOUD_CODEC_GNSS_FORMAT_PVT, .queued = true,
+	  .pvt = { .lat = 63.5323170, .longi = 10.6865382, .alt = 9.9f, .acc = 7.1f,
+		   .spd = 9.19f, .hdg = 46.6f } },
+	{ .gnss_ts = 1621614, .format = CLOUD_CODEC_GNSS_FORMAT_PVT, .queued = true,
+	  .pvt = { .lat = 63.5368123, .longi = 10.6991529, .alt = 8.5f, .acc = 4.5f,
+		   .spd = 13.35f, .hdg = 51.4f } },
+	{ .gnss_ts = 1681710, .format = CLOUD_CODEC_GNSS_FORMAT_PVT, .queued = true,
+	  .pvt = { .lat = 63.5426649, .longi = 10.7097859, .alt = 7.4f, .acc = 8.3f,
+		   .spd = 13.97f, .hdg = 39.0f } },
+	{ .gnss_ts = 1742107, .format = CLOUD_CODEC_GNSS_FORMAT_PVT, .queued = true,
+	  .pvt = { .lat = 63.5457992, .longi = 10.7218806, .alt = 8.5f, .acc = 5.7f,
+		   .spd = 11.56f, .hdg = 59.8f } },
+	{ .gnss_ts = 1801610, .format = CLOUD_CODEC_GNSS_FORMAT_PVT, .queued = true,
+	  .pvt = { .lat = 63.5478050, .longi = 10.7395544, .alt = 7.0f, .acc = 3.7f,
+		   .spd = 15.07f, .hdg = 75.7f } },
+	{ .gnss_ts = 1861444, .format = CLOUD_CODEC_GNSS_FORMAT_PVT, .queued = true,
+	  .pvt = { .lat = 63.5468398, .longi = 10.7566017, .alt = 4.3f, .acc = 4.1f,
+		   .spd = 14.20f, .hdg = 97.2f } },
+	{ .gnss_ts = 1921546, .format = CLOUD_CODEC_GNSS_FORMAT_PVT, .queued = true,
+	  .pvt = { .lat = 63.5462100, .longi = 10.7722817, .alt = 6.8f, .acc = 7.0f,
+		   .spd = 13.01f, .hdg = 95.2f } },
+	{ .gnss_ts = 1981852, .format = CLOUD_CODEC_GNSS_FORMAT_PVT, .queued = true,
+	  .pvt = { .lat = 63.5441822, .longi = 10.7875878, .alt = 8.9f, .acc = 7.9f,
+		   .spd = 13.20f, .hdg = 106.6f } },
+	{ .gnss_ts = 2041948, .format = CLOUD_CODEC_GNSS_FORMAT_PVT, .queued = true,
+	  .pvt = { .lat = 63.5393361, .longi = 10.8021700, .alt = 7.5f, .acc = 3.4f,
+		   .spd = 15.04f, .hdg = 126.7f } },
+	{ .gnss_ts = 2101974, .format = CLOUD_CODEC_GNSS_FORMAT_PVT, .queued = true,
+	  .pvt = { .lat = 63.5358514, .longi = 10.8132344, .alt = 8.4f, .acc = 8.5f,
+		   .spd = 11.20f, .hdg = 125.2f } },
+	{ .gnss_ts = 2161994, .format = CLOUD_CODEC_GNSS_FORMAT_PVT, .queued = true,
+	  .pvt = { .lat = 63.5344370, .longi = 10.8307656, .alt = 8.9f, .acc = 9.1f,
+		   .spd = 14.73f, .hdg = 100.3f } },
+	{ .gnss_ts = 2222010, .format = CLOUD_CODEC_GNSS_FORMAT_PVT, .queued = true,
+	  .pvt = { .lat = 63.5349415, .longi = 10.8494563, .alt = 11.3f, .acc = 7.8f,
+		   .spd = 15.48f, .hdg = 86.5f } },
+	{ .gnss_ts = 2282098, .format = CLOUD_CODEC_GNSS_FORMAT_PVT, .queued = true,
+	  .pvt = { .lat = 63.5379432, .longi = 10.8677593, .alt = 13.0f, .acc = 3.4f,
+		   .spd = 16.12f, .hdg = 69.8f } },
+	{ .gnss_ts = 2341736, .format = CLOUD_CODEC_GNSS_FORMAT_PVT, .queued = true,
+	  .pvt = { .lat = 63.5399092, .longi = 10.8803776, .alt = 13.9f, .acc = 7.6f,
+		   .spd = 11.05f, .hdg = 70.7f } },
+	{ .gnss_ts = 2401579, .format = CLOUD_CODEC_GNSS_FORMAT_PVT, .queued = true,
+	  .pvt = { .lat = 63.5392255, .longi = 10.8986344, .alt = 11.8f, .acc = 5.2f,
+		   .spd = 15.15f, .hdg = 94.8f } },
+	{ .gnss_ts = 2462071, .format = CLOUD_CODEC_GNSS_FORMAT_PVT, .queued = true,
+	  .pvt = { .lat = 63.5359454, .longi = 10.9144428, .alt = 12.3f, .acc = 8.6f,
+		   .spd = 14.42f, .hdg = 115.0f } },
+	{ .gnss_ts = 2522110, .format = CLOUD_CODEC_GNSS_FORMAT_PVT, .queued = true,
+	  .pvt = { .lat = 63.5327668, .longi = 10.9264471, .alt = 15.1f, .acc = 2.7f,
+		   .spd = 11.55f, .hdg = 120.7f } },
+	{ .gnss_ts = 2581978, .format = CLOUD_CODEC_GNSS_FORMAT_PVT, .queued = true,
+	  .pvt = { .lat = 63.5279043, .longi = 10.9357862, .alt = 13.4f, .acc = 4.6f,
+		   .spd = 11.88f, .hdg = 139.4f } },
+	{ .gnss_ts = 2641961, .format = CLOUD_CODEC_GNSS_FORMAT_PVT, .queued = true,
+	  .pvt = { .lat = 63.5208956, .longi = 10.9470862, .alt = 12.5f, .acc = 4.6f,
+		   .spd = 16.01f, .hdg = 144.3f } },
+	{ .gnss_ts = 2701424, .format = CLOUD_CODEC_GNSS_FORMAT_PVT, .queued = true,
+	  .pvt = { .lat = 63.5139032, .longi = 10.9561156, .alt = 12.3f, .acc = 7.9f,
+		   .spd = 14.97f, .hdg = 150.1f } },
+	{ .gnss_ts = 2761305, .format = CLOUD_CODEC_GNSS_FORMAT_PVT, .queued = true,
+	  .pvt = { .lat = 63.5067492, .longi = 10.9588825, .alt = 9.9f, .acc = 7.6f,
+		   .spd = 13.47f, .hdg = 170.2f } },
+	{ .gnss_ts = 2821292, .format = CLOUD_CODEC_GNSS_FORMAT_PVT, .queued = true,
+	  .pvt = { .lat = 63.5005980, .longi = 10.9600360, .alt = 10.2f, .acc = 7.4f,
+		   .spd = 11.45f, .hdg = 175.2f } },
+	{ .gnss_ts = 2881584, .format = CLOUD_CODEC_GNSS_FORMAT_PVT, .queued = true,
+	  .pvt = { .lat = 63.4942704, .longi = 10.9583947, .alt = 12.4f, .acc = 8.9f,
+		   .spd = 11.82f, .hdg = 186.6f } },
+};
+
+static const struct cloud_data_sensors trace_sensors[TRACE_SENSOR_COUNT] = {
+	{ .env_ts = 60512, .temperature = 21.47, .humidity = 38.37, .pressure = 101.327,
+	  .bsec_air_quality = 54, .queued = true },
+	{ .env_ts = 120512, .temperature = 21.52, .humidity = 38.28, .pressure = 101.328,
+	  .bsec_air_quality = 53, .queued = true },
+	{ .env_ts = 180512, .temperature = 21.52, .humidity = 38.40, .pressure = 101.330,
+	  .bsec_air_quality = 32, .queued = true },
+	{ .env_ts = 240512, .temperature = 21.52, .humidity = 38.36, .pressure = 101.329,
+	  .bsec_air_quality = 55, .queued = true },
+	{ .env_ts = 300512, .temperature = 21.57, .humidity = 38.50, .pressure = 101.329,
+	  .bsec_air_quality = 38, .queued = true },
+	{ .env_ts = 360512, .temperature = 21.52, .humidity = 38.34, .pressure = 101.332,
+	  .bsec_air_quality = 40, .queued = true },
+	{ .env_ts = 420512, .temperature = 21.62, .humidity = 38.06, .pressure = 101.331,
+	  .bsec_air_quality = 46, .queued = true },
+	{ .env_ts = 480512, .temperature = 21.71, .humidity = 37.99, .pressure = 101.333,
+	  .bsec_air_quality = 53, .queued = true },
+	{ .env_ts = 540512, .temperature = 21.67, .humidity = 37.71, .pressure = 101.329,
+	  .bsec_air_quality = 45, .queued = true },
+	{ .env_ts = 600512, .temperature = 21.75, .humidity = 37.64, .pressure = 101.332,
+	  .bsec_air_quality = 39, .queued = true },
+	{ .env_ts = 660512, .temperature = 21.76, .humidity = 37.55, .pressure = 101.335,
+	  .bsec_air_quality = 48, .queued = true },
+	{ .env_ts = 720512, .temperature = 21.75, .humidity = 37.49, .pressure = 101.332,
+	  .bsec_air_quality = 47, .queued = true },
+	{ .env_ts = 780512, .temperature = 21.76, .humidity = 37.50, .pressure = 101.332,
+	  .bsec_air_quality = 45, .queued = true },
+	{ .env_ts = 840512, .temperature = 21.80, .humidity = 37.75, .pressure = 101.333,
+	  .bsec_air_quality = 40, .queued = true },
+	{ .env_ts = 900512, .temperature = 21.89, .humidity = 37.47, .pressure = 101.330,
+	  .bsec_air_quality = 43, .queued = true },
+	{ .env_ts = 960512, .temperature = 21.83, .humidity = 37.72, .pressure = 101.331,
+	  .bsec_air_quality = 47, .queued = true },
+	{ .env_ts = 1020512, .temperature = 21.88, .humidity = 37.58, .pressure = 101.335,
+	  .bsec_air_quality = 44, .queued = true },
+	{ .env_ts = 1080512, .temperature = 21.86, .humidity = 37.57, .pressure = 101.334,
+	  .bsec_air_quality = 38, .queued = true },
+	{ .env_ts = 1140512, .temperature = 21.84, .humidity = 37.75, .pressure = 101.336,
+	  .bsec_air_quality = 37, .queued = true },
+	{ .env_ts = 1200512, .temperature = 21.77, .humidity = 38.04, .pressure = 101.335,
+	  .bsec_air_quality = 38, .queued = true },
+	{ .env_ts = 1260512, .temperature = 21.74, .humidity = 38.33, .pressure = 101.335,
+	  .bsec_air_quality = 34, .queued = true },
+	{ .env_ts = 1320512, .temperature = 21.69, .humidity = 38.23, .pressure = 101.332,
+	  .bsec_air_quality = 54, .queued = true },
+	{ .env_ts = 1380512, .temperature = 21.75, .humidity = 38.21, .pressure = 101.330,
+	  .bsec_air_quality = 32, .queued = true },
+	{ .env_ts = 1440512, .temperature = 21.82, .humidity = 38.36, .pressure = 101.327,
+	  .bsec_air_quality = 32, .queued = true },
+	{ .env_ts = 1500512, .temperature = 21.81, .humidity = 38.31, .pressure = 101.329,
+	  .bsec_air_quality = 59, .queued = true },
+	{ .env_ts = 1560512, .temperature = 21.89, .humidity = 38.07, .pressure = 101.328,
+	  .bsec_air_quality = 56, .queued = true },
+	{ .env_ts = 1620512, .temperature = 21.88, .humidity = 37.88, .pressure = 101.325,
+	  .bsec_air_quality = 58, .queued = true },
+	{ .env_ts = 1680512, .temperature = 21.96, .humidity = 37.98, .pressure = 101.322,
+	  .bsec_air_quality = 60, .queued = true },
+	{ .env_ts = 1740512, .temperature = 21.96, .humidity = 38.23, .pressure = 101.325,
+	  .bsec_air_quality = 35, .queued = true },
+	{ .env_ts = 1800512, .temperature = 21.94, .humidity = 38.31, .pressure = 101.327,
+	  .bsec_air_quality = 46, .queued = true },
+	{ .env_ts = 1860512, .temperature = 22.02, .humidity = 38.32, .pressure = 101.325,
+	  .bsec_air_quality = 60, .queued = true },
+	{ .env_ts = 1920512, .temperature = 22.09, .humidity = 38.20, .pressure = 101.325,
+	  .bsec_air_quality = 30, .queued = true },
+	{ .env_ts = 1980512, .temperature = 22.11, .humidity = 38.16, .pressure = 101.325,
+	  .bsec_air_quality = 51, .queued = true },
+	{ .env_ts = 2040512, .temperature = 22.21, .humidity = 38.24, .pressure = 101.325,
+	  .bsec_air_quality = 48, .queued = true },
+	{ .env_ts = 2100512, .temperature = 22.24, .humidity = 38.34, .pressure = 101.325,
+	  .bsec_air_quality = 57, .queued = true },
+	{ .env_ts = 2160512, .temperature = 22.31, .humidity = 38.17, .pressure = 101.329,
+	  .bsec_air_quality = 46, .queued = true },
+	{ .env_ts = 2220512, .temperature = 22.23, .humidity = 38.41, .pressure = 101.325,
+	  .bsec_air_quality = 52, .queued = true },
+	{ .env_ts = 2280512, .temperature = 22.28, .humidity = 38.35, .pressure = 101.322,
+	  .bsec_air_quality = 38, .queued = true },
+	{ .env_ts = 2340512, .temperature = 22.22, .humidity = 38.41, .pressure = 101.324,
+	  .bsec_air_quality = 43, .queued = true },
+	{ .env_ts = 2400512, .temperature = 22.30, .humidity = 38.46, .pressure = 101.321,
+	  .bsec_air_quality = 58, .queued = true },
+	{ .env_ts = 2460512, .temperature = 22.22, .humidity = 38.36, .pressure = 101.324,
+	  .bsec_air_quality = 38, .queued = true },
+	{ .env_ts = 2520512, .temperature = 22.20, .humidity = 38.35, .pressure = 101.324,
+	  .bsec_air_quality = 42, .queued = true },
+	{ .env_ts = 2580512, .temperature = 22.17, .humidity = 38.07, .pressure = 101.320,
+	  .bsec_air_quality = 30, .queued = true },
+	{ .env_ts = 2640512, .temperature = 22.13, .humidity = 38.20, .pressure = 101.317,
+	  .bsec_air_quality = 43, .queued = true },
+	{ .env_ts = 2700512, .temperature = 22.11, .humidity = 37.96, .pressure = 101.317,
+	  .bsec_air_quality = 35, .queued = true },
+	{ .env_ts = 2760512, .temperature = 22.21, .humidity = 37.95, .pressure = 101.320,
+	  .bsec_air_quality = 57, .queued = true },
+	{ .env_ts = 2820512, .temperature = 22.17, .humidity = 37.94, .pressure = 101.324,
+	  .bsec_air_quality = 41, .queued = true },
+	{ .env_ts = 2880512, .temperature = 22.10, .humidity = 38.14, .pressure = 101.325,
+	  .bsec_air_quality = 49, .queued = true },
+};
+
+static const struct cloud_data_battery trace_battery[TRACE_BATTERY_COUNT] = {
+	{ .bat = 4110, .bat_ts = 60020, .queued = true },
+	{ .bat = 4102, .bat_ts = 120020, .queued = true },
+	{ .bat = 4094, .bat_ts = 180020, .queued = true },
+	{ .bat = 4094, .bat_ts = 240020, .queued = true },
+	{ .bat = 4094, .bat_ts = 300020, .queued = true },
+	{ .bat = 4090, .bat_ts = 360020, .queued = true },
+	{ .bat = 4094, .bat_ts = 420020, .queued = true },
+	{ .bat = 4090, .bat_ts = 480020, .queued = true },
+	{ .bat = 4090, .bat_ts = 540020, .queued = true },
+	{ .bat = 4094, .bat_ts = 600020, .queued = true },
+	{ .bat = 4090, .bat_ts = 660020, .queued = true },
+	{ .bat = 4082, .bat_ts = 720020, .queued = true },
+	{ .bat = 4078, .bat_ts = 780020, .queued = true },
+	{ .bat = 4082, .bat_ts = 840020, .queued = true },
+	{ .bat = 4086, .bat_ts = 900020, .queued = true },
+	{ .bat = 4082, .bat_ts = 960020, .queued = true },
+	{ .bat = 4078, .bat_ts = 1020020, .queued = true },
+	{ .bat = 4078, .bat_ts = 1080020, .queued = true },
+	{ .bat = 4074, .bat_ts = 1140020, .queued = true },
+	{ .bat = 4066, .bat_ts = 1200020, .queued = true },
+	{ .bat = 4070, .bat_ts = 1260020, .queued = true },
+	{ .bat = 4070, .bat_ts = 1320020, .queued = true },
+	{ .bat = 4066, .bat_ts = 1380020, .queued = true },
+	{ .bat = 4058, .bat_ts = 1440020, .queued = true },
+	{ .bat = 4062, .bat_ts = 1500020, .queued = true },
+	{ .bat = 4058, .bat_ts = 1560020, .queued = true },
+	{ .bat = 4062, .bat_ts = 1620020, .queued = true },
+	{ .bat = 4062, .bat_ts = 1680020, .queued = true },
+	{ .bat = 4058, .bat_ts = 1740020, .queued = true },
+	{ .bat = 4050, .bat_ts = 1800020, .queued = true },
+	{ .bat = 4046, .bat_ts = 1860020, .queued = true },
+	{ .bat = 4038, .bat_ts = 1920020, .queued = true },
+	{ .bat = 4034, .bat_ts = 1980020, .queued = true },
+	{ .bat = 4034, .bat_ts = 2040020, .queued = true },
+	{ .bat = 4034, .bat_ts = 2100020, .queued = true },
+	{ .bat = 4034, .bat_ts = 2160020, .queued = true },
+	{ .bat = 4034, .bat_ts = 2220020, .queued = true },
+	{ .bat = 4038, .bat_ts = 2280020, .queued = true },
+	{ .bat = 4034, .bat_ts = 2340020, .queued = true },
+	{ .bat = 4034, .bat_ts = 2400020, .queued = true },
+	{ .bat = 4030, .bat_ts = 2460020, .queued = true },
+	{ .bat = 4034, .bat_ts = 2520020, .queued = true },
+	{ .bat = 4038, .bat_ts = 2580020, .queued = true },
+	{ .bat = 4042, .bat_ts = 2640020, .queued = true },
+	{ .bat = 4034, .bat_ts = 2700020, .queued = true },
+	{ .bat = 4038, .bat_ts = 2760020, .queued = true },
+	{ .bat = 4042, .bat_ts = 2820020, .queued = true },
+	{ .bat = 4046, .bat_ts = 2880020, .queued = true },
+};
+
+static const struct cloud_data_modem_dynamic trace_modem_dynamic[TRACE_MODEM_DYNAMIC_COUNT] = {
+	{ .ts = 60080, .band = 20, .nw_mode = LTE_LC_LTE_MODE_LTEM, .mcc = 242, .mnc = 2,
+	  .area = 2305, .cell = 20032519, .rsrp = -107, .ip = "10.160.33.51", .mccmnc = "24202",
+	  .queued = true, .area_code_fresh = true, .cell_id_fresh = true, .rsrp_fresh = true,
+	  .ip_address_fresh = true, .mccmnc_fresh = true, .band_fresh = true,
+	  .nw_mode_fresh = true },
+	{ .ts = 300080, .band = 20, .nw_mode = LTE_LC_LTE_MODE_LTEM, .mcc = 242, .mnc = 2,
+	  .area = 2305, .cell = 20032519, .rsrp = -102, .ip = "10.160.33.51", .mccmnc = "24202",
+	  .queued = true, .area_code_fresh = true, .cell_id_fresh = true, .rsrp_fresh = true,
+	  .ip_address_fresh = false, .mccmnc_fresh = true, .band_fresh = true,
+	  .nw_mode_fresh = true },
+	{ .ts = 540080, .band = 20, .nw_mode = LTE_LC_LTE_MODE_LTEM, .mcc = 242, .mnc = 2,
+	  .area = 2305, .cell = 20032521, .rsrp = -102, .ip = "10.160.33.51", .mccmnc = "24202",
+	  .queued = true, .area_code_fresh = true, .cell_id_fresh = true, .rsrp_fresh = true,
+	  .ip_address_fresh = false, .mccmnc_fresh = true, .band_fresh = true,
+	  .nw_mode_fresh = true },
+	{ .ts = 780080, .band = 20, .nw_mode = LTE_LC_LTE_MODE_LTEM, .mcc = 242, .mnc = 2,
+	  .area = 2305, .cell = 20032521, .rsrp = -106, .ip = "10.160.33.51", .mccmnc = "24202",
+	  .queued = true, .area_code_fresh = true, .cell_id_fresh = true, .rsrp_fresh = true,
+	  .ip_address_fresh = false, .mccmnc_fresh = true, .band_fresh = true,
+	  .nw_mode_fresh = true },
+	{ .ts = 1020080, .band = 20, .nw_mode = LTE_LC_LTE_MODE_LTEM, .mcc = 242, .mnc = 2,
+	  .area = 2305, .cell = 20032521, .rsrp = -103, .ip = "10.160.33.51", .mccmnc = "24202",
+	  .queued = true, .area_code_fresh = true, .cell_id_fresh = true, .rsrp_fresh = true,
+	  .ip_address_fresh = false, .mccmnc_fresh = true, .band_fresh = true,
+	  .nw_mode_fresh = true },
+	{ .ts = 1260080, .band = 20, .nw_mode = LTE_LC_LTE_MODE_LTEM, .mcc = 242, .mnc = 2,
+	  .area = 2305, .cell = 20032521, .rsrp = -102, .ip = "10.160.33.51", .mccmnc = "24202",
+	  .queued = true, .area_code_fresh = true, .cell_id_fresh = true, .rsrp_fresh = true,
+	  .ip_address_fresh = false, .mccmnc_fresh = true, .band_fresh = true,
+	  .nw_mode_fresh = true },
+	{ .ts = 1500080, .band = 20, .nw_mode = LTE_LC_LTE_MODE_LTEM, .mcc = 242, .mnc = 2,
+	  .area = 2305, .cell = 20032522, .rsrp = -85, .ip = "10.160.33.51", .mccmnc = "24202",
+	  .queued = true, .area_code_fresh = true, .cell_id_fresh = true, .rsrp_fresh = true,
+	  .ip_address_fresh = false, .mccmnc_fresh = true, .band_fresh = true,
+	  .nw_mode_fresh = true },
+	{ .ts = 1740080, .band = 20, .nw_mode = LTE_LC_LTE_MODE_LTEM, .mcc = 242, .mnc = 2,
+	  .area = 2305, .cell = 20032522, .rsrp = -105, .ip = "10.160.33.51", .mccmnc = "24202",
+	  .queued = true, .area_code_fresh = true, .cell_id_fresh = true, .rsrp_fresh = true,
+	  .ip_address_fresh = false, .mccmnc_fresh = true, .band_fresh = true,
+	  .nw_mode_fresh = true },
+	{ .ts = 1980080, .band = 20, .nw_mode = LTE_LC_LTE_MODE_LTEM, .mcc = 242, .mnc = 2,
+	  .area = 2305, .cell = 20032522, .rsrp = -91, .ip = "10.160.33.51", .mccmnc = "24202",
+	  .queued = true, .area_code_fresh = true, .cell_id_fresh = true, .rsrp_fresh = true,
+	  .ip_address_fresh = false, .mccmnc_fresh = true, .band_fresh = true,
+	  .nw_mode_fresh = true },
+	{ .ts = 2220080, .band = 20, .nw_mode = LTE_LC_LTE_MODE_LTEM, .mcc = 242, .mnc = 2,
+	  .area = 2305, .cell = 20032522, .rsrp = -93, .ip = "10.160.33.51", .mccmnc = "24202",
+	  .queued = true, .area_code_fresh = true, .cell_id_fresh = true, .rsrp_fresh = true,
+	  .ip_address_fresh = false, .mccmnc_fresh = true, .band_fresh = true,
+	  .nw_mode_fresh = true },
+	{ .ts = 2460080, .band = 20, .nw_mode = LTE_LC_LTE_MODE_LTEM, .mcc = 242, .mnc = 2,
+	  .area = 2305, .cell = 20032519, .rsrp = -102, .ip = "10.160.33.51", .mccmnc = "24202",
+	  .queued = true, .area_code_fresh = true, .cell_id_fresh = true, .rsrp_fresh = true,
+	  .ip_address_fresh = false, .mccmnc_fresh = true, .band_fresh = true,
+	  .nw_mode_fresh = true },
+	{ .ts = 2700080, .band = 20, .nw_mode = LTE_LC_LTE_MODE_LTEM, .mcc = 242, .mnc = 2,
+	  .area = 2305, .cell = 20032519, .rsrp = -88, .ip = "10.160.33.51", .mccmnc = "24202",
+	  .queued = true, .area_code_fresh = true, .cell_id_fresh = true, .rsrp_fresh = true,
+	  .ip_address_fresh = false, .mccmnc_fresh = true, .band_fresh = true,
+	  .nw_mode_fresh = true },
+};
+
+#endif /* TRACE_H__ */
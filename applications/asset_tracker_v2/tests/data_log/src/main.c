@@ -0,0 +1,410 @@
+/*
+ * Copyright (c) 2022 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include <ztest.h>
+#include <zephyr/kernel.h>
+#include <string.h>
+
+#include "data_log.h"
+
+/* Samples are taken every 5 minutes during a 24 hour outage. */
+#define TEST_OUTAGE_HOURS		24
+#define TEST_SAMPLE_INTERVAL_MIN	5
+#define TEST_SAMPLE_CYCLES		(TEST_OUTAGE_HOURS * 60 / TEST_SAMPLE_INTERVAL_MIN)
+
+/* The device reboots every 6 hours during the outage. */
+#define TEST_REBOOT_INTERVAL_CYCLES	(6 * 60 / TEST_SAMPLE_INTERVAL_MIN)
+
+/* Maximum number of records sent in one batch message. */
+#define TEST_CHUNK_RECORDS		20
+
+/* Every fourth acknowledgment from the broker is lost. */
+#define TEST_ACK_LOSS_INTERVAL		4
+
+/* Size of the data in GNSS and battery samples, similar to the data module structures. */
+#define TEST_GNSS_DATA_SIZE		88
+#define TEST_BATTERY_DATA_SIZE		8
+
+#define TEST_SAMPLE_COUNT_MAX		4096
+
+struct test_sample {
+	/* Sample number, incremented for each sample regardless of type. */
+	uint32_t id;
+	/* Sample timestamp. UNIX milliseconds. */
+	int64_t ts;
+	uint8_t data[TEST_GNSS_DATA_SIZE];
+};
+
+#define TEST_SAMPLE_LEN(_data_size) (offsetof(struct test_sample, data) + (_data_size))
+
+/* Local stand-in for the MQTT broker. Keeps the samples received, in order. */
+static struct {
+	uint32_t last_id;
+	uint32_t samples;
+	uint32_t duplicates;
+	uint32_t messages;
+	bool ack_loss;
+} broker;
+
+static uint32_t next_id;
+static int64_t now_ms;
+
+static void sample_append(enum data_log_type type, size_t data_size)
+{
+	struct test_sample sample = {
+		.id = ++next_id,
+		.ts = now_ms,
+	};
+
+	memset(sample.data, (uint8_t)sample.id, data_size);
+
+	zassert_ok(data_log_append(type, &sample, TEST_SAMPLE_LEN(data_size)),
+		   "Failed appending sample %d", sample.id);
+}
+
+static void sample_cycle(void)
+{
+	sample_append(DATA_LOG_TYPE_GNSS, TEST_GNSS_DATA_SIZE);
+	sample_append(DATA_LOG_TYPE_BATTERY, TEST_BATTERY_DATA_SIZE);
+
+	now_ms += TEST_SAMPLE_INTERVAL_MIN * 60 * MSEC_PER_SEC;
+}
+
+static void sample_check(const struct test_sample *sample, enum data_log_type type, int len)
+{
+	size_t data_size = (type == DATA_LOG_TYPE_GNSS) ? TEST_GNSS_DATA_SIZE :
+							 TEST_BATTERY_DATA_SIZE;
+
+	zassert_equal(len, TEST_SAMPLE_LEN(data_size), "Wrong length %d for sample %d",
+		      len, sample->id);
+
+	for (size_t i = 0; i < data_size; i++) {
+		zassert_equal(sample->data[i], (uint8_t)sample->id, "Corrupt sample %d",
+			      sample->id);
+	}
+}
+
+/* Read the records for one batch message, like the data module does. */
+static size_t chunk_read(struct data_log_cursor *cursor, uint32_t *ids)
+{
+	int len;
+	size_t count = 0;
+	enum data_log_type type;
+	struct test_sample sample;
+
+	while (count < TEST_CHUNK_RECORDS) {
+		len = data_log_read(cursor, &type, &sample, sizeof(sample));
+		if (len == -ENOENT) {
+			break;
+		}
+
+		zassert_true(len > 0, "data_log_read, error: %d", len);
+		sample_check(&sample, type, len);
+
+		ids[count++] = sample.id;
+	}
+
+	return count;
+}
+
+/* Publish a batch message. Returns true if the acknowledgment reaches the device. */
+static bool broker_publish(const uint32_t *ids, size_t count)
+{
+	broker.messages++;
+
+	for (size_t i = 0; i < count; i++) {
+		if (ids[i] <= broker.last_id) {
+			broker.duplicates++;
+			continue;
+		}
+
+		zassert_equal(ids[i], broker.last_id + 1, "Sample %d missing", broker.last_id + 1);
+
+		broker.last_id = ids[i];
+		broker.samples++;
+	}
+
+	return !(broker.ack_loss && ((broker.messages % TEST_ACK_LOSS_INTERVAL) == 0));
+}
+
+/* Send all logged data, one batch message at a time. The device reboots after sending the
+ * message given by reboot_at, before the acknowledgment is received.
+ */
+static void drain(uint32_t reboot_at)
+{
+	size_t count;
+	uint32_t ids[TEST_CHUNK_RECORDS];
+	struct data_log_cursor cursor;
+
+	while (true) {
+		data_log_cursor_init(&cursor);
+
+		count = chunk_read(&cursor, ids);
+		if (count == 0) {
+			break;
+		}
+
+		bool acked = broker_publish(ids, count);
+
+		if (broker.messages == reboot_at) {
+			zassert_ok(data_log_init(), "Reboot failed");
+			continue;
+		}
+
+		if (acked) {
+			zassert_ok(data_log_ack(&cursor), "Failed acknowledging batch");
+		}
+	}
+}
+
+static void setup(void)
+{
+	zassert_ok(data_log_init(), "data_log_init failed");
+	zassert_ok(data_log_clear(), "data_log_clear failed");
+
+	memset(&broker, 0, sizeof(broker));
+	next_id = 0;
+	now_ms = 1563968747123;
+}
+
+static void teardown(void)
+{
+}
+
+static void test_append_read_ack(void)
+{
+	int len;
+	enum data_log_type type;
+	struct test_sample sample;
+	struct data_log_cursor cursor;
+	struct data_log_stats stats;
+
+	sample_append(DATA_LOG_TYPE_GNSS, TEST_GNSS_DATA_SIZE);
+	sample_append(DATA_LOG_TYPE_BATTERY, TEST_BATTERY_DATA_SIZE);
+	sample_append(DATA_LOG_TYPE_GNSS, TEST_GNSS_DATA_SIZE);
+
+	data_log_stats_get(&stats);
+	zassert_equal(stats.pending, 3, "Wrong number of pending records: %d", stats.pending);
+
+	data_log_cursor_init(&cursor);
+
+	len = data_log_read(&cursor, &type, &sample, sizeof(sample));
+	zassert_equal(type, DATA_LOG_TYPE_GNSS, "Wrong type: %d", type);
+	zassert_equal(sample.id, 1, "Wrong sample: %d", sample.id);
+	sample_check(&sample, type, len);
+
+	len = data_log_read(&cursor, &type, &sample, sizeof(sample));
+	zassert_equal(type, DATA_LOG_TYPE_BATTERY, "Wrong type: %d", type);
+	zassert_equal(sample.id, 2, "Wrong sample: %d", sample.id);
+	sample_check(&sample, type, len);
+
+	/* Reading does not remove records. */
+	data_log_stats_get(&stats);
+	zassert_equal(stats.pending, 3, "Wrong number of pending records: %d", stats.pending);
+
+	zassert_ok(data_log_ack(&cursor), "data_log_ack failed");
+
+	data_log_stats_get(&stats);
+	zassert_equal(stats.pending, 1, "Wrong number of pending records: %d", stats.pending);
+
+	data_log_cursor_init(&cursor);
+
+	len = data_log_read(&cursor, &type, &sample, sizeof(sample));
+	zassert_equal(sample.id, 3, "Wrong sample: %d", sample.id);
+	sample_check(&sample, type, len);
+
+	len = data_log_read(&cursor, &type, &sample, sizeof(sample));
+	zassert_equal(len, -ENOENT, "Wrong return value: %d", len);
+
+	/* Acknowledging the same position twice has no effect. */
+	zassert_ok(data_log_ack(&cursor), "data_log_ack failed");
+	zassert_ok(data_log_ack(&cursor), "data_log_ack failed");
+
+	data_log_stats_get(&stats);
+	zassert_equal(stats.pending, 0, "Wrong number of pending records: %d", stats.pending);
+}
+
+static void test_read_buffer_too_small(void)
+{
+	int len;
+	enum data_log_type type;
+	uint8_t buf[TEST_SAMPLE_LEN(TEST_BATTERY_DATA_SIZE)];
+	struct data_log_cursor cursor;
+
+	sample_append(DATA_LOG_TYPE_GNSS, TEST_GNSS_DATA_SIZE);
+	sample_append(DATA_LOG_TYPE_BATTERY, TEST_BATTERY_DATA_SIZE);
+
+	data_log_cursor_init(&cursor);
+
+	len = data_log_read(&cursor, &type, buf, sizeof(buf));
+	zassert_equal(len, -EMSGSIZE, "Wrong return value: %d", len);
+
+	/* The cursor has moved past the record that did not fit. */
+	len = data_log_read(&cursor, &type, buf, sizeof(buf));
+	zassert_equal(len, sizeof(buf), "Wrong return value: %d", len);
+	zassert_equal(type, DATA_LOG_TYPE_BATTERY, "Wrong type: %d", type);
+}
+
+static void test_persistence(void)
+{
+	int len;
+	enum data_log_type type;
+	struct test_sample sample;
+	struct data_log_cursor cursor;
+	struct data_log_stats stats;
+
+	for (int i = 0; i < 5; i++) {
+		sample_append(DATA_LOG_TYPE_GNSS, TEST_GNSS_DATA_SIZE);
+	}
+
+	data_log_cursor_init(&cursor);
+	(void)data_log_read(&cursor, &type, &sample, sizeof(sample));
+	(void)data_log_read(&cursor, &type, &sample, sizeof(sample));
+	zassert_ok(data_log_ack(&cursor), "data_log_ack failed");
+
+	/* Reboot. */
+	zassert_ok(data_log_init(), "data_log_init failed");
+
+	data_log_stats_get(&stats);
+	zassert_equal(stats.pending, 3, "Wrong number of pending records: %d", stats.pending);
+
+	data_log_cursor_init(&cursor);
+
+	len = data_log_read(&cursor, &type, &sample, sizeof(sample));
+	zassert_equal(sample.id, 3, "Wrong sample: %d", sample.id);
+	sample_check(&sample, type, len);
+
+	/* New records continue the sequence after a reboot. */
+	sample_append(DATA_LOG_TYPE_BATTERY, TEST_BATTERY_DATA_SIZE);
+
+	data_log_stats_get(&stats);
+	zassert_equal(stats.pending, 4, "Wrong number of pending records: %d", stats.pending);
+}
+
+static void test_outage_24h(void)
+{
+	struct data_log_stats stats;
+
+	for (int i = 0; i < TEST_SAMPLE_CYCLES; i++) {
+		sample_cycle();
+
+		if ((i % TEST_REBOOT_INTERVAL_CYCLES) == (TEST_REBOOT_INTERVAL_CYCLES - 1)) {
+			zassert_ok(data_log_init(), "Reboot failed");
+		}
+	}
+
+	data_log_stats_get(&stats);
+	zassert_equal(stats.pending, next_id, "Wrong number of pending records: %d",
+		      stats.pending);
+	zassert_equal(stats.dropped, 0, "Records dropped: %d", stats.dropped);
+
+	/* Connection is back. Acknowledgments are lost now and then, and the device reboots while
+	 * waiting for the acknowledgment of the third message.
+	 */
+	broker.ack_loss = true;
+	drain(3);
+
+	zassert_equal(broker.samples, next_id, "Samples lost: %d", next_id - broker.samples);
+	zassert_true(broker.duplicates > 0, "Unacknowledged samples not sent again");
+
+	printk("%d samples delivered in %d messages, %d duplicates\n",
+	       broker.samples, broker.messages, broker.duplicates);
+
+	data_log_stats_get(&stats);
+	zassert_equal(stats.pending, 0, "Wrong number of pending records: %d", stats.pending);
+
+	/* Nothing is sent again after a reboot. */
+	zassert_ok(data_log_init(), "Reboot failed");
+	data_log_stats_get(&stats);
+	zassert_equal(stats.pending, 0, "Wrong number of pending records: %d", stats.pending);
+}
+
+static void test_log_full(void)
+{
+	int len;
+	uint32_t first_id;
+	enum data_log_type type;
+	struct test_sample sample;
+	struct data_log_cursor cursor;
+	uint32_t pending;
+	struct data_log_stats stats;
+
+	/* Outage longer than the log can hold. */
+	do {
+		sample_append(DATA_LOG_TYPE_GNSS, TEST_GNSS_DATA_SIZE);
+		data_log_stats_get(&stats);
+	} while ((stats.dropped == 0) && (next_id < TEST_SAMPLE_COUNT_MAX));
+
+	zassert_true(stats.dropped > 0, "No records dropped");
+
+	for (int i = 0; i < TEST_SAMPLE_CYCLES; i++) {
+		sample_append(DATA_LOG_TYPE_GNSS, TEST_GNSS_DATA_SIZE);
+	}
+
+	data_log_stats_get(&stats);
+	zassert_equal(stats.pending + stats.dropped, next_id, "Records unaccounted for");
+
+	/* The oldest records have been dropped, the remaining records are in order. */
+	data_log_cursor_init(&cursor);
+
+	len = data_log_read(&cursor, &type, &sample, sizeof(sample));
+	sample_check(&sample, type, len);
+	zassert_equal(sample.id, stats.dropped + 1, "Wrong oldest sample: %d", sample.id);
+
+	first_id = sample.id;
+
+	while ((len = data_log_read(&cursor, &type, &sample, sizeof(sample))) > 0) {
+		zassert_equal(sample.id, ++first_id, "Samples out of order");
+	}
+
+	zassert_equal(first_id, next_id, "Newest sample missing");
+
+	/* The same records are pending after a reboot. */
+	pending = stats.pending;
+	zassert_ok(data_log_init(), "Reboot failed");
+
+	data_log_stats_get(&stats);
+	zassert_equal(stats.pending, pending, "Wrong number of pending records: %d",
+		      stats.pending);
+}
+
+static void test_reclaim(void)
+{
+	struct data_log_stats stats;
+
+	/* Write several times the size of the partition. Acknowledged sectors are erased in
+	 * order, so the log never has to drop records.
+	 */
+	for (int i = 0; i < 10; i++) {
+		for (int j = 0; j < TEST_SAMPLE_CYCLES; j++) {
+			sample_cycle();
+		}
+
+		drain(0);
+	}
+
+	data_log_stats_get(&stats);
+	zassert_equal(stats.dropped, 0, "Records dropped: %d", stats.dropped);
+	zassert_equal(stats.pending, 0, "Wrong number of pending records: %d", stats.pending);
+	zassert_equal(broker.samples, next_id, "Samples lost: %d", next_id - broker.samples);
+	zassert_equal(broker.duplicates, 0, "Duplicate samples: %d", broker.duplicates);
+	zassert_true(stats.erases > CONFIG_DATA_LOG_SECTOR_COUNT_MAX / 2,
+		     "Too few erases: %d", stats.erases);
+}
+
+void test_main(void)
+{
+	ztest_test_suite(data_log,
+		ztest_unit_test_setup_teardown(test_append_read_ack, setup, teardown),
+		ztest_unit_test_setup_teardown(test_read_buffer_too_small, setup, teardown),
+		ztest_unit_test_setup_teardown(test_persistence, setup, teardown),
+		ztest_unit_test_setup_teardown(test_outage_24h, setup, teardown),
+		ztest_unit_test_setup_teardown(test_log_full, setup, teardown),
+		ztest_unit_test_setup_teardown(test_reclaim, setup, teardown)
+	);
+
+	ztest_run_test_suite(data_log);
+}
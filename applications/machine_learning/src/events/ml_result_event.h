@@ -37,6 +37,8 @@ struct ml_result_event {
 	float value;
 	/** Anomaly value. */
 	float anomaly;
+	/** Uptime at which the input window of the result was complete [ms]. */
+	int64_t timestamp;
 };
 
 /** @brief Sign in event
@@ -24,6 +24,9 @@ LOG_MODULE_REGISTER(MODULE, CONFIG_ML_APP_ML_RUNNER_LOG_LEVEL);
 
 /* Make sure that event handlers will not be preempted by the EI wrapper's callback. */
 BUILD_ASSERT(CONFIG_SYSTEM_WORKQUEUE_PRIORITY < CONFIG_EI_WRAPPER_THREAD_PRIORITY);
+#ifdef CONFIG_EI_WRAPPER_PIPELINE
+BUILD_ASSERT(CONFIG_SYSTEM_WORKQUEUE_PRIORITY < CONFIG_EI_WRAPPER_CLASSIFIER_THREAD_PRIORITY);
+#endif /* CONFIG_EI_WRAPPER_PIPELINE */
 
 /**
  * @brief Enumeration of possible current module states
@@ -49,13 +52,14 @@ enum {
 	ML_DROP_RESULT			= BIT(0),
 	ML_CLEANUP_REQUIRED		= BIT(1),
 	ML_FIRST_PREDICTION		= BIT(2),
-	ML_RUNNING			= BIT(3),
 };
 
 BUILD_ASSERT(ARRAY_SIZE(CONFIG_ML_APP_ML_RUNNER_SENSOR_EVENT_DESCR) > 1);
 static const char *handled_sensor_event_descr = CONFIG_ML_APP_ML_RUNNER_SENSOR_EVENT_DESCR;
 
 static uint8_t ml_control;
+/* Number of started predictions whose results were not yet received. */
+static size_t pending_cnt;
 static enum state state;
 static struct module_flags active_listeners;
 
@@ -71,12 +75,37 @@ static enum state current_active_state(void)
 	return module_flags_check_zero(&active_listeners) ? STATE_READY : STATE_ACTIVE;
 }
 
+static void log_result_timing(int64_t timestamp)
+{
+	static int64_t prev_timestamp;
+	int dsp_time;
+	int classification_time;
+	int anomaly_time;
+
+	int err = ei_wrapper_get_timing(&dsp_time, &classification_time, &anomaly_time);
+
+	__ASSERT_NO_MSG(!err);
+	ARG_UNUSED(err);
+
+	int64_t latency = k_uptime_get() - timestamp;
+	int64_t interval = (prev_timestamp > 0) ? (timestamp - prev_timestamp) : (0);
+
+	prev_timestamp = timestamp;
+
+	LOG_INF("Result latency: %dms interval: %dms dsp: %dms classification: %dms",
+		(int32_t)latency, (int32_t)interval, dsp_time, classification_time);
+}
+
 static void submit_result(void)
 {
 	struct ml_result_event *evt = new_ml_result_event();
 
 	int err = ei_wrapper_get_next_classification_result(&evt->label, &evt->value, NULL);
 
+	if (!err) {
+		err = ei_wrapper_get_window_timestamp(&evt->timestamp);
+	}
+
 	if (!err) {
 		err = ei_wrapper_get_anomaly(&evt->anomaly);
 	}
@@ -84,6 +113,10 @@ static void submit_result(void)
 	__ASSERT_NO_MSG(!err);
 	ARG_UNUSED(err);
 
+	if (IS_ENABLED(CONFIG_EI_WRAPPER_PROFILING)) {
+		log_result_timing(evt->timestamp);
+	}
+
 	APP_EVENT_SUBMIT(evt);
 }
 
@@ -94,17 +127,20 @@ static int buf_cleanup(void)
 
 	if (!err) {
 		if (cancelled) {
-			ml_control &= ~ML_RUNNING;
+			pending_cnt = 0;
 		}
 
-		if (ml_control & ML_RUNNING) {
+		/* Result of the prediction that was not cancelled is still received. */
+		if (pending_cnt > 0) {
 			ml_control |= ML_DROP_RESULT;
+		} else {
+			ml_control &= ~ML_DROP_RESULT;
 		}
 
 		ml_control &= ~ML_CLEANUP_REQUIRED;
 		ml_control |= ML_FIRST_PREDICTION;
 	} else if (err == -EBUSY) {
-		__ASSERT_NO_MSG(ml_control & ML_RUNNING);
+		__ASSERT_NO_MSG(pending_cnt > 0);
 		ml_control |= ML_DROP_RESULT;
 		ml_control |= ML_CLEANUP_REQUIRED;
 	} else {
@@ -121,7 +157,7 @@ static void start_prediction(void)
 	size_t window_shift;
 	size_t frame_shift;
 
-	if (ml_control & ML_RUNNING) {
+	if (pending_cnt >= ei_wrapper_get_pipeline_depth()) {
 		return;
 	}
 
@@ -132,22 +168,28 @@ static void start_prediction(void)
 		}
 	}
 
-	if (ml_control & ML_FIRST_PREDICTION) {
-		window_shift = 0;
-		frame_shift = 0;
-	} else {
-		window_shift = SHIFT_WINDOWS;
-		frame_shift = SHIFT_FRAMES;
-	}
+	/* In pipeline mode, the next windows are processed while the results of
+	 * the previous ones are calculated.
+	 */
+	while (pending_cnt < ei_wrapper_get_pipeline_depth()) {
+		if (ml_control & ML_FIRST_PREDICTION) {
+			window_shift = 0;
+			frame_shift = 0;
+		} else {
+			window_shift = SHIFT_WINDOWS;
+			frame_shift = SHIFT_FRAMES;
+		}
 
-	err = ei_wrapper_start_prediction(window_shift, frame_shift);
+		err = ei_wrapper_start_prediction(window_shift, frame_shift);
 
-	if (!err) {
-		ml_control |= ML_RUNNING;
+		if (err) {
+			LOG_ERR("Cannot start prediction (err: %d)", err);
+			report_error();
+			break;
+		}
+
+		pending_cnt++;
 		ml_control &= ~ML_FIRST_PREDICTION;
-	} else {
-		LOG_ERR("Cannot start prediction (err: %d)", err);
-		report_error();
 	}
 }
 
@@ -161,8 +203,13 @@ static void result_ready_cb(int err)
 		LOG_ERR("Result ready callback returned error (err: %d)", err);
 		report_error();
 	} else {
-		ml_control &= ~ML_DROP_RESULT;
-		ml_control &= ~ML_RUNNING;
+		__ASSERT_NO_MSG(pending_cnt > 0);
+		pending_cnt--;
+
+		/* Results are dropped until the buffered data is cleared. */
+		if (!(ml_control & ML_CLEANUP_REQUIRED)) {
+			ml_control &= ~ML_DROP_RESULT;
+		}
 
 		if (state == STATE_ACTIVE) {
 			start_prediction();
@@ -204,11 +251,9 @@ static bool handle_sensor_event(const struct sensor_event *event)
 
 	size_t data_cnt = sensor_event_get_data_cnt(event);
 	float float_data[data_cnt];
-	const struct sensor_value *data_ptr = sensor_event_get_data_ptr(event);
 
-	for (size_t i = 0; i < data_cnt; i++) {
-		float_data[i] = sensor_value_to_double(&data_ptr[i]);
-	}
+	sensor_sample_to_float(&event->format, sensor_event_get_raw_data_ptr(event),
+			       float_data, data_cnt);
 
 	int err = ei_wrapper_add_data(float_data, data_cnt);
 
@@ -62,6 +62,7 @@
 #include "contin_array.h"
 #include "pcm_mix.h"
 #include "streamctrl.h"
+#include "asrc.h"
 
 #include <zephyr/logging/log.h>
 LOG_MODULE_REGISTER(audio_datapath, CONFIG_LOG_AUDIO_DATAPATH_LEVEL);
@@ -123,6 +124,14 @@ LOG_MODULE_REGISTER(audio_datapath, CONFIG_LOG_AUDIO_DATAPATH_LEVEL);
 /* How often to print underrun warning */
 #define UNDERRUN_LOG_INTERVAL_BLKS 5000
 
+#if (CONFIG_AUDIO_DATAPATH_ASRC)
+#define FRAME_MONO_NUM_SAMPS (BLK_MONO_NUM_SAMPS * NUM_BLKS_IN_FRAME)
+/* Converted samples waiting for a complete block, and the next frame */
+#define ASRC_BUF_NUM_SAMPS ((ASRC_OUT_FRAMES_MAX(FRAME_MONO_NUM_SAMPS) + BLK_MONO_NUM_SAMPS) * 2)
+
+BUILD_ASSERT(FRAME_MONO_NUM_SAMPS <= ASRC_FRAMES_MAX, "Audio frame too long for the ASRC");
+#endif /* (CONFIG_AUDIO_DATAPATH_ASRC) */
+
 enum drift_comp_state {
 	DRIFT_STATE_INIT, /* Waiting for data to be received */
 	DRIFT_STATE_CALIB, /* Calibrate and zero out local delay */
@@ -167,6 +176,12 @@ static struct {
 		uint32_t prod_blk_ts[FIFO_NUM_BLKS];
 		/* Statistics */
 		uint32_t total_blk_underruns;
+#if (CONFIG_AUDIO_DATAPATH_ASRC)
+		struct asrc_ctx asrc;
+		struct asrc_ctrl asrc_ctrl;
+		int16_t __aligned(sizeof(uint32_t)) asrc_buf[ASRC_BUF_NUM_SAMPS];
+		uint16_t asrc_buf_num_frames; /* Converted frames not yet in the FIFO */
+#endif /* (CONFIG_AUDIO_DATAPATH_ASRC) */
 	} out;
 
 	uint32_t previous_sdu_ref_us;
@@ -229,6 +244,16 @@ static void drift_comp_state_set(enum drift_comp_state new_state)
  */
 static void audio_datapath_drift_compensation(uint32_t frame_start_ts)
 {
+	if (IS_ENABLED(CONFIG_AUDIO_DATAPATH_ASRC)) {
+		/* The ASRC follows the drift, so the audio clock is not tuned */
+		if ((ctrl_blk.drift_comp.state == DRIFT_STATE_INIT) &&
+		    ctrl_blk.previous_sdu_ref_us) {
+			drift_comp_state_set(DRIFT_STATE_LOCKED);
+		}
+
+		return;
+	}
+
 	switch (ctrl_blk.drift_comp.state) {
 	case DRIFT_STATE_INIT: {
 		/* Check if audio data has been received */
@@ -410,6 +435,24 @@ static void audio_datapath_presentation_compensation(uint32_t recv_frame_ts_us,
 		 * and previous sdu_ref_us origins from non-consecutive frames, or into
 		 * PRES_STATE_INIT if drift compensation unlocks.
 		 */
+#if (CONFIG_AUDIO_DATAPATH_ASRC)
+		/* The ASRC keeps the remaining error small. The drift is held
+		 * while the presentation delay is not locked.
+		 */
+		int32_t err_us = ctrl_blk.current_pres_dly_us - wanted_pres_dly_us;
+		int32_t drift_ppb;
+		int ret;
+
+		if ((err_us >= BLK_PERIOD_US) || (err_us <= -BLK_PERIOD_US)) {
+			LOG_WRN("Presentation delay lost: err_us=%d", err_us);
+			pres_comp_state_set(PRES_STATE_INIT);
+			break;
+		}
+
+		drift_ppb = asrc_ctrl_update(&ctrl_blk.out.asrc_ctrl, err_us);
+		ret = asrc_drift_set(&ctrl_blk.out.asrc, drift_ppb);
+		ERR_CHK(ret);
+#endif /* (CONFIG_AUDIO_DATAPATH_ASRC) */
 
 		break;
 	}
@@ -867,31 +910,72 @@ void audio_datapath_stream_out(const uint8_t *buf, size_t size, uint32_t sdu_ref
 		return;
 	}
 
+	int16_t *pcm = (int16_t *)ctrl_blk.decoded_data;
+	uint32_t num_blks = NUM_BLKS_IN_FRAME;
+
+#if (CONFIG_AUDIO_DATAPATH_ASRC)
+	/*** Sample rate conversion ***/
+
+	/* Time of the first converted frame, relative to the decoded frame */
+	int32_t asrc_offset = asrc_offset_get(&ctrl_blk.out.asrc);
+	uint32_t buf_num_frames = ctrl_blk.out.asrc_buf_num_frames;
+	size_t asrc_num_frames;
+
+	ret = asrc_process(&ctrl_blk.out.asrc, pcm, FRAME_MONO_NUM_SAMPS,
+			   &ctrl_blk.out.asrc_buf[buf_num_frames * 2],
+			   (ASRC_BUF_NUM_SAMPS / 2) - buf_num_frames, &asrc_num_frames);
+	ERR_CHK(ret);
+
+	pcm = ctrl_blk.out.asrc_buf;
+	num_blks = (buf_num_frames + asrc_num_frames) / BLK_MONO_NUM_SAMPS;
+#endif /* (CONFIG_AUDIO_DATAPATH_ASRC) */
+
 	/*** Add audio data to FIFO buffer ***/
 
 	int32_t num_blks_in_fifo = ctrl_blk.out.prod_blk_idx - ctrl_blk.out.cons_blk_idx;
 
-	if ((num_blks_in_fifo + NUM_BLKS_IN_FRAME) > FIFO_NUM_BLKS) {
+	if ((num_blks_in_fifo + (int32_t)num_blks) > FIFO_NUM_BLKS) {
 		LOG_WRN("Output audio stream overrun - Discarding audio frame");
 
+#if (CONFIG_AUDIO_DATAPATH_ASRC)
+		ctrl_blk.out.asrc_buf_num_frames = 0;
+#endif /* (CONFIG_AUDIO_DATAPATH_ASRC) */
+
 		/* Discard frame to allow consumer to catch up */
 		return;
 	}
 
 	uint32_t out_blk_idx = ctrl_blk.out.prod_blk_idx;
 
-	for (uint32_t i = 0; i < NUM_BLKS_IN_FRAME; i++) {
+	for (uint32_t i = 0; i < num_blks; i++) {
 		memcpy(&ctrl_blk.out.fifo[out_blk_idx * BLK_STEREO_NUM_SAMPS],
-		       &((int16_t *)ctrl_blk.decoded_data)[i * BLK_STEREO_NUM_SAMPS],
-		       BLK_STEREO_SIZE_OCTETS);
+		       &pcm[i * BLK_STEREO_NUM_SAMPS], BLK_STEREO_SIZE_OCTETS);
 
 		/* Record producer block start reference */
+#if (CONFIG_AUDIO_DATAPATH_ASRC)
+		/* Position of the block in the decoded frame, in 1/65536 frames */
+		int64_t blk_pos = asrc_offset +
+				  ((int64_t)i * BLK_MONO_NUM_SAMPS - buf_num_frames) * 65536;
+
+		ctrl_blk.out.prod_blk_ts[out_blk_idx] =
+			recv_frame_ts_us +
+			(int32_t)((blk_pos * 1000000) / (CONFIG_AUDIO_SAMPLE_RATE_HZ * 65536LL));
+#else
 		ctrl_blk.out.prod_blk_ts[out_blk_idx] = recv_frame_ts_us + (i * BLK_PERIOD_US);
+#endif /* (CONFIG_AUDIO_DATAPATH_ASRC) */
 
 		out_blk_idx = NEXT_IDX(out_blk_idx);
 	}
 
 	ctrl_blk.out.prod_blk_idx = out_blk_idx;
+
+#if (CONFIG_AUDIO_DATAPATH_ASRC)
+	/* Keep the frames of the last incomplete block for the next frame */
+	buf_num_frames = buf_num_frames + asrc_num_frames - (num_blks * BLK_MONO_NUM_SAMPS);
+	memmove(ctrl_blk.out.asrc_buf, &ctrl_blk.out.asrc_buf[num_blks * BLK_STEREO_NUM_SAMPS],
+		buf_num_frames * 2 * sizeof(int16_t));
+	ctrl_blk.out.asrc_buf_num_frames = buf_num_frames;
+#endif /* (CONFIG_AUDIO_DATAPATH_ASRC) */
 }
 
 int audio_datapath_start(struct data_fifo *fifo_rx)
@@ -909,6 +993,14 @@ int audio_datapath_start(struct data_fifo *fifo_rx)
 		/* Clear counters and mute initial audio */
 		memset(&ctrl_blk.out, 0, sizeof(ctrl_blk.out));
 
+#if (CONFIG_AUDIO_DATAPATH_ASRC)
+		int ret;
+
+		ret = asrc_init(&ctrl_blk.out.asrc, 2);
+		ERR_CHK(ret);
+		asrc_ctrl_reset(&ctrl_blk.out.asrc_ctrl);
+#endif /* (CONFIG_AUDIO_DATAPATH_ASRC) */
+
 		audio_datapath_i2s_start();
 		ctrl_blk.stream_started = true;
 
@@ -12,6 +12,10 @@
 
 #include "macros_common.h"
 #include "data_fifo.h"
+#if (CONFIG_AUDIO_DATAPATH_ASRC)
+#include "asrc.h"
+#include "audio_sync_timer.h"
+#endif /* (CONFIG_AUDIO_DATAPATH_ASRC) */
 
 #include <zephyr/logging/log.h>
 LOG_MODULE_REGISTER(audio_usb, CONFIG_LOG_AUDIO_USB_LEVEL);
@@ -19,6 +23,39 @@ LOG_MODULE_REGISTER(audio_usb, CONFIG_LOG_AUDIO_USB_LEVEL);
 #define USB_FRAME_SIZE_STEREO                                                                      \
 	(((CONFIG_AUDIO_SAMPLE_RATE_HZ * CONFIG_AUDIO_BIT_DEPTH_OCTETS) / 1000) * 2)
 
+#if (CONFIG_AUDIO_DATAPATH_ASRC)
+#define USB_FRAME_NUM_FRAMES (USB_FRAME_SIZE_STEREO / (2 * sizeof(int16_t)))
+/* Converted frames waiting for a complete block, and the next USB frame */
+#define ASRC_BUF_NUM_SAMPS ((ASRC_OUT_FRAMES_MAX(USB_FRAME_NUM_FRAMES) + USB_FRAME_NUM_FRAMES) * 2)
+/* The drift controller is updated once per audio frame */
+#define ASRC_CTRL_NUM_USB_FRAMES (CONFIG_AUDIO_FRAME_DURATION_US / 1000)
+/* Longer gaps between USB frames mean that the stream was interrupted */
+#define ASRC_USB_FRAME_GAP_MAX_US 5000
+/* Larger errors of the fill level restart the measurement */
+#define ASRC_FILL_ERR_MAX_US 1000
+
+/* Sample rate conversion from the USB host clock to the Bluetooth clock.
+ *
+ * The encoder thread takes a frame out of the RX FIFO as soon as it is
+ * complete, so the number of blocks in the FIFO does not show the drift.
+ * The fill level is instead measured as if the FIFO was drained at the
+ * nominal sample rate on the Bluetooth clock, given by the audio sync timer,
+ * and kept at its level at the start of the stream.
+ */
+static struct {
+	struct asrc_ctx ctx;
+	struct asrc_ctrl ctrl;
+	int16_t __aligned(sizeof(uint32_t)) buf[ASRC_BUF_NUM_SAMPS];
+	uint16_t buf_num_frames; /* Converted frames not yet in the FIFO */
+	bool fill_valid;
+	uint32_t prev_ts_us;
+	/* Fill level relative to the start, in 1/CONFIG_AUDIO_SAMPLE_RATE_HZ us */
+	int64_t fill;
+	int64_t fill_sum;
+	uint8_t fill_cnt;
+} usb_asrc;
+#endif /* (CONFIG_AUDIO_DATAPATH_ASRC) */
+
 static struct data_fifo *fifo_tx;
 static struct data_fifo *fifo_rx;
 
@@ -63,29 +100,11 @@ static void data_write(const struct device *dev)
 }
 #endif /* (CONFIG_STREAM_BIDIRECTIONAL) */
 
-static void data_received(const struct device *dev, struct net_buf *buffer, size_t size)
+static void rx_block_put(void const *const data)
 {
 	int ret;
 	void *data_in;
 
-	if (fifo_rx == NULL) {
-		/* Throwing away data */
-		net_buf_unref(buffer);
-		return;
-	}
-
-	if (!buffer || !size) {
-		/* This should never happen */
-		ERR_CHK(-EINVAL);
-	}
-
-	/* Receive data from USB */
-	if (size != USB_FRAME_SIZE_STEREO) {
-		LOG_WRN("Wrong length: %d", size);
-		net_buf_unref(buffer);
-		return;
-	}
-
 	ret = data_fifo_pointer_first_vacant_get(fifo_rx, &data_in, K_NO_WAIT);
 
 	/* RX FIFO can fill up due to retransmissions or disconnect */
@@ -106,10 +125,134 @@ static void data_received(const struct device *dev, struct net_buf *buffer, size
 
 	ERR_CHK_MSG(ret, "RX failed to get block");
 
-	memcpy(data_in, buffer->data, size);
+	memcpy(data_in, data, USB_FRAME_SIZE_STEREO);
 
-	ret = data_fifo_block_lock(fifo_rx, &data_in, size);
+	ret = data_fifo_block_lock(fifo_rx, &data_in, USB_FRAME_SIZE_STEREO);
 	ERR_CHK_MSG(ret, "Failed to lock block");
+}
+
+#if (CONFIG_AUDIO_DATAPATH_ASRC)
+static void usb_asrc_fill_reset(void)
+{
+	usb_asrc.fill = 0;
+	usb_asrc.fill_sum = 0;
+	usb_asrc.fill_cnt = 0;
+}
+
+static void usb_asrc_reset(void)
+{
+	int ret;
+
+	ret = asrc_init(&usb_asrc.ctx, 2);
+	ERR_CHK(ret);
+	asrc_ctrl_reset(&usb_asrc.ctrl);
+
+	usb_asrc.buf_num_frames = 0;
+	usb_asrc.fill_valid = false;
+	usb_asrc_fill_reset();
+}
+
+/**
+ * @brief Update the fill level with the frames converted from a USB frame,
+ *	  and the drift of the converter once per audio frame.
+ *
+ * @param num_frames	Number of converted frames
+ */
+static void usb_asrc_fill_update(size_t num_frames)
+{
+	int ret;
+	uint32_t ts_us = audio_sync_timer_curr_time_get();
+	uint32_t elapsed_us = ts_us - usb_asrc.prev_ts_us;
+	int32_t err_us;
+	int32_t drift_ppb;
+
+	usb_asrc.prev_ts_us = ts_us;
+
+	if (!usb_asrc.fill_valid || (elapsed_us > ASRC_USB_FRAME_GAP_MAX_US)) {
+		/* The drift is kept, the fill level is measured from here */
+		usb_asrc.fill_valid = true;
+		usb_asrc_fill_reset();
+		return;
+	}
+
+	usb_asrc.fill += (int64_t)num_frames * USEC_PER_SEC -
+			 (int64_t)elapsed_us * CONFIG_AUDIO_SAMPLE_RATE_HZ;
+	usb_asrc.fill_sum += usb_asrc.fill;
+
+	if (++usb_asrc.fill_cnt < ASRC_CTRL_NUM_USB_FRAMES) {
+		return;
+	}
+
+	/* The mean over an audio frame filters the jitter of the USB frames */
+	err_us = usb_asrc.fill_sum / ((int64_t)usb_asrc.fill_cnt * CONFIG_AUDIO_SAMPLE_RATE_HZ);
+	usb_asrc.fill_sum = 0;
+	usb_asrc.fill_cnt = 0;
+
+	if ((err_us > ASRC_FILL_ERR_MAX_US) || (err_us < -ASRC_FILL_ERR_MAX_US)) {
+		LOG_WRN("USB RX fill level lost: err_us=%d", err_us);
+		usb_asrc_fill_reset();
+		return;
+	}
+
+	drift_ppb = asrc_ctrl_update(&usb_asrc.ctrl, err_us);
+	ret = asrc_drift_set(&usb_asrc.ctx, drift_ppb);
+	ERR_CHK(ret);
+}
+
+static void usb_asrc_process(void const *const data)
+{
+	int ret;
+	uint16_t buf_num_frames = usb_asrc.buf_num_frames;
+	size_t asrc_num_frames;
+	uint32_t num_blks;
+
+	ret = asrc_process(&usb_asrc.ctx, data, USB_FRAME_NUM_FRAMES,
+			   &usb_asrc.buf[buf_num_frames * 2], (ASRC_BUF_NUM_SAMPS / 2) - buf_num_frames,
+			   &asrc_num_frames);
+	ERR_CHK(ret);
+
+	usb_asrc_fill_update(asrc_num_frames);
+
+	buf_num_frames += asrc_num_frames;
+	num_blks = buf_num_frames / USB_FRAME_NUM_FRAMES;
+
+	for (uint32_t i = 0; i < num_blks; i++) {
+		rx_block_put(&usb_asrc.buf[i * USB_FRAME_NUM_FRAMES * 2]);
+	}
+
+	/* Keep the frames of the last incomplete block for the next USB frame */
+	buf_num_frames -= num_blks * USB_FRAME_NUM_FRAMES;
+	memmove(usb_asrc.buf, &usb_asrc.buf[num_blks * USB_FRAME_NUM_FRAMES * 2],
+		buf_num_frames * 2 * sizeof(int16_t));
+	usb_asrc.buf_num_frames = buf_num_frames;
+}
+#endif /* (CONFIG_AUDIO_DATAPATH_ASRC) */
+
+static void data_received(const struct device *dev, struct net_buf *buffer, size_t size)
+{
+	if (fifo_rx == NULL) {
+		/* Throwing away data */
+		net_buf_unref(buffer);
+		return;
+	}
+
+	if (!buffer || !size) {
+		/* This should never happen */
+		ERR_CHK(-EINVAL);
+	}
+
+	/* Receive data from USB */
+	if (size != USB_FRAME_SIZE_STEREO) {
+		LOG_WRN("Wrong length: %d", size);
+		net_buf_unref(buffer);
+		return;
+	}
+
+#if (CONFIG_AUDIO_DATAPATH_ASRC)
+	usb_asrc_process(buffer->data);
+#else
+	rx_block_put(buffer->data);
+#endif /* (CONFIG_AUDIO_DATAPATH_ASRC) */
 
 	net_buf_unref(buffer);
 }
@@ -139,6 +282,10 @@ int audio_usb_start(struct data_fifo *fifo_tx_in, struct data_fifo *fifo_rx_in)
 		return -EINVAL;
 	}
 
+#if (CONFIG_AUDIO_DATAPATH_ASRC)
+	usb_asrc_reset();
+#endif /* (CONFIG_AUDIO_DATAPATH_ASRC) */
+
 	fifo_tx = fifo_tx_in;
 	fifo_rx = fifo_rx_in;
 
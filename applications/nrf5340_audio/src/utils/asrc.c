@@ -0,0 +1,299 @@
+/*
+ * Copyright (c) 2022 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include "asrc.h"
+
+#include <zephyr/kernel.h>
+#include <errno.h>
+#include <string.h>
+
+#if defined(__ARM_FEATURE_SIMD32)
+#include <arm_acle.h>
+#endif
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_REGISTER(asrc, LOG_LEVEL_WRN);
+
+#define HISTORY_FRAMES (ASRC_TAPS - 1)
+#define PHASE_FRAC_BITS (32 - ASRC_PHASES_LOG2)
+
+/* Controller gains, for a critically damped loop with a time constant of
+ * about half a second with frames of 10 ms.
+ */
+#define CTRL_KP_PPB_PER_US 4000
+#define CTRL_KI_PPB_PER_US 40
+#define CTRL_DRIFT_PPB_MAX (ASRC_DRIFT_PPM_MAX * 1000)
+
+/* Kaiser windowed sinc (beta 8, cutoff 0.45 fs) over ASRC_TAPS input frames,
+ * sampled at (1 << ASRC_PHASES_LOG2) + 1 phases. The taps of every phase are
+ * stored last to first, and scaled to a sum of exactly 1 in Q15, so that the
+ * gain does not depend on the phase.
+ */
+static const int16_t coeffs[(1 << ASRC_PHASES_LOG2) + 1][ASRC_TAPS] __aligned(4) = {
+	{ 29, -137, 410, -915, 1632, -2418, 3039, 29488,
+	  3039, -2418, 1632, -915, 410, -137, 29, 0 },
+	{ 29, -136, 404, -890, 1560, -2242, 2578, 29479,
+	  3511, -2592, 1701, -939, 416, -137, 28, -2 },
+	{ 29, -135, 397, -864, 1487, -2066, 2127, 29448,
+	  3992, -2765, 1769, -961, 421, -137, 28, -2 },
+	{ 29, -134, 389, -836, 1413, -1890, 1687, 29399,
+	  4482, -2937, 1834, -982, 425, -137, 28, -2 },
+	{ 29, -132, 381, -808, 1337, -1714, 1259, 29329,
+	  4981, -3106, 1897, -1001, 428, -137, 27, -2 },
+	{ 28, -130, 372, -778, 1260, -1539, 842, 29240,
+	  5488, -3273, 1957, -1018, 430, -136, 27, -2 },
+	{ 28, -128, 363, -748, 1183, -1364, 436, 29130,
+	  6003, -3438, 2015, -1034, 432, -134, 26, -2 },
+	{ 28, -126, 353, -716, 1104, -1191, 43, 29000,
+	  6526, -3598, 2069, -1047, 432, -133, 25, -1 },
+	{ 27, -124, 342, -684, 1025, -1019, -338, 28853,
+	  7056, -3756, 2121, -1059, 432, -131, 24, -1 },
+	{ 27, -121, 331, -652, 946, -848, -706, 28684,
+	  7591, -3909, 2169, -1069, 431, -128, 23, -1 },
+	{ 26, -118, 320, -618, 866, -680, -1061, 28497,
+	  8133, -4058, 2214, -1077, 428, -125, 22, -1 },
+	{ 26, -115, 308, -585, 787, -515, -1404, 28293,
+	  8680, -4202, 2255, -1083, 425, -122, 21, -1 },
+	{ 25, -112, 296, -551, 707, -352, -1733, 28073,
+	  9231, -4341, 2292, -1086, 420, -119, 19, -1 },
+	{ 25, -108, 284, -516, 628, -191, -2048, 27826,
+	  9787, -4474, 2325, -1088, 415, -115, 18, 0 },
+	{ 24, -105, 271, -481, 549, -34, -2350, 27568,
+	  10346, -4601, 2354, -1087, 408, -110, 16, 0 },
+	{ 23, -101, 259, -447, 471, 119, -2638, 27289,
+	  10909, -4722, 2379, -1083, 401, -105, 14, 0 },
+	{ 22, -98, 246, -412, 394, 269, -2913, 26997,
+	  11473, -4836, 2399, -1078, 392, -100, 12, 1 },
+	{ 22, -94, 232, -377, 317, 415, -3173, 26685,
+	  12039, -4942, 2415, -1070, 382, -94, 10, 1 },
+	{ 21, -90, 219, -342, 242, 557, -3420, 26356,
+	  12607, -5041, 2426, -1059, 371, -88, 8, 1 },
+	{ 20, -86, 206, -307, 168, 695, -3653, 26012,
+	  13174, -5132, 2432, -1046, 359, -82, 6, 2 },
+	{ 19, -82, 193, -273, 95, 828, -3872, 25655,
+	  13742, -5215, 2433, -1030, 345, -75, 3, 2 },
+	{ 18, -78, 179, -239, 23, 956, -4076, 25279,
+	  14309, -5289, 2430, -1012, 331, -67, 1, 3 },
+	{ 18, -74, 166, -205, -46, 1080, -4267, 24889,
+	  14874, -5353, 2421, -991, 315, -60, -2, 3 },
+	{ 17, -70, 153, -172, -115, 1199, -4444, 24486,
+	  15437, -5409, 2406, -967, 299, -51, -5, 4 },
+	{ 16, -66, 139, -139, -181, 1313, -4607, 24068,
+	  15998, -5454, 2387, -941, 281, -43, -7, 4 },
+	{ 15, -62, 126, -106, -246, 1422, -4756, 23637,
+	  16555, -5490, 2362, -912, 262, -34, -10, 5 },
+	{ 14, -58, 113, -75, -308, 1525, -4892, 23196,
+	  17108, -5514, 2331, -881, 242, -24, -14, 5 },
+	{ 13, -54, 100, -44, -369, 1623, -5014, 22742,
+	  17656, -5528, 2295, -847, 221, -15, -17, 6 },
+	{ 13, -50, 88, -13, -427, 1715, -5122, 22272,
+	  18199, -5531, 2253, -810, 199, -5, -20, 7 },
+	{ 12, -46, 75, 16, -484, 1802, -5218, 21798,
+	  18736, -5523, 2206, -771, 176, 6, -24, 7 },
+	{ 11, -42, 63, 45, -538, 1884, -5300, 21309,
+	  19266, -5503, 2153, -729, 151, 17, -27, 8 },
+	{ 10, -38, 51, 73, -589, 1960, -5369, 20811,
+	  19789, -5471, 2094, -685, 126, 28, -31, 9 },
+	{ 9, -34, 39, 100, -638, 2030, -5426, 20303,
+	  20305, -5426, 2030, -638, 100, 39, -34, 9 },
+	{ 9, -31, 28, 126, -685, 2094, -5471, 19789,
+	  20811, -5369, 1960, -589, 73, 51, -38, 10 },
+	{ 8, -27, 17, 151, -729, 2153, -5503, 19266,
+	  21309, -5300, 1884, -538, 45, 63, -42, 11 },
+	{ 7, -24, 6, 176, -771, 2206, -5523, 18736,
+	  21798, -5218, 1802, -484, 16, 75, -46, 12 },
+	{ 7, -20, -5, 199, -810, 2253, -5531, 18199,
+	  22272, -5122, 1715, -427, -13, 88, -50, 13 },
+	{ 6, -17, -15, 221, -847, 2295, -5528, 17656,
+	  22742, -5014, 1623, -369, -44, 100, -54, 13 },
+	{ 5, -14, -24, 242, -881, 2331, -5514, 17108,
+	  23196, -4892, 1525, -308, -75, 113, -58, 14 },
+	{ 5, -10, -34, 262, -912, 2362, -5490, 16555,
+	  23637, -4756, 1422, -246, -106, 126, -62, 15 },
+	{ 4, -7, -43, 281, -941, 2387, -5454, 15998,
+	  24068, -4607, 1313, -181, -139, 139, -66, 16 },
+	{ 4, -5, -51, 299, -967, 2406, -5409, 15437,
+	  24486, -4444, 1199, -115, -172, 153, -70, 17 },
+	{ 3, -2, -60, 315, -991, 2421, -5353, 14874,
+	  24889, -4267, 1080, -46, -205, 166, -74, 18 },
+	{ 3, 1, -67, 331, -1012, 2430, -5289, 14309,
+	  25279, -4076, 956, 23, -239, 179, -78, 18 },
+	{ 2, 3, -75, 345, -1030, 2433, -5215, 13742,
+	  25655, -3872, 828, 95, -273, 193, -82, 19 },
+	{ 2, 6, -82, 359, -1046, 2432, -5132, 13174,
+	  26012, -3653, 695, 168, -307, 206, -86, 20 },
+	{ 1, 8, -88, 371, -1059, 2426, -5041, 12607,
+	  26356, -3420, 557, 242, -342, 219, -90, 21 },
+	{ 1, 10, -94, 382, -1070, 2415, -4942, 12039,
+	  26685, -3173, 415, 317, -377, 232, -94, 22 },
+	{ 1, 12, -100, 392, -1078, 2399, -4836, 11473,
+	  26997, -2913, 269, 394, -412, 246, -98, 22 },
+	{ 0, 14, -105, 401, -1083, 2379, -4722, 10909,
+	  27289, -2638, 119, 471, -447, 259, -101, 23 },
+	{ 0, 16, -110, 408, -1087, 2354, -4601, 10346,
+	  27568, -2350, -34, 549, -481, 271, -105, 24 },
+	{ 0, 18, -115, 415, -1088, 2325, -4474, 9787,
+	  27826, -2048, -191, 628, -516, 284, -108, 25 },
+	{ -1, 19, -119, 420, -1086, 2292, -4341, 9231,
+	  28073, -1733, -352, 707, -551, 296, -112, 25 },
+	{ -1, 21, -122, 425, -1083, 2255, -4202, 8680,
+	  28293, -1404, -515, 787, -585, 308, -115, 26 },
+	{ -1, 22, -125, 428, -1077, 2214, -4058, 8133,
+	  28497, -1061, -680, 866, -618, 320, -118, 26 },
+	{ -1, 23, -128, 431, -1069, 2169, -3909, 7591,
+	  28684, -706, -848, 946, -652, 331, -121, 27 },
+	{ -1, 24, -131, 432, -1059, 2121, -3756, 7056,
+	  28853, -338, -1019, 1025, -684, 342, -124, 27 },
+	{ -1, 25, -133, 432, -1047, 2069, -3598, 6526,
+	  29000, 43, -1191, 1104, -716, 353, -126, 28 },
+	{ -2, 26, -134, 432, -1034, 2015, -3438, 6003,
+	  29130, 436, -1364, 1183, -748, 363, -128, 28 },
+	{ -2, 27, -136, 430, -1018, 1957, -3273, 5488,
+	  29240, 842, -1539, 1260, -778, 372, -130, 28 },
+	{ -2, 27, -137, 428, -1001, 1897, -3106, 4981,
+	  29329, 1259, -1714, 1337, -808, 381, -132, 29 },
+	{ -2, 28, -137, 425, -982, 1834, -2937, 4482,
+	  29399, 1687, -1890, 1413, -836, 389, -134, 29 },
+	{ -2, 28, -137, 421, -961, 1769, -2765, 3992,
+	  29448, 2127, -2066, 1487, -864, 397, -135, 29 },
+	{ -2, 28, -137, 416, -939, 1701, -2592, 3511,
+	  29479, 2578, -2242, 1560, -890, 404, -136, 29 },
+	{ 0, 29, -137, 410, -915, 1632, -2418, 3039,
+	  29488, 3039, -2418, 1632, -915, 410, -137, 29 },
+};
+
+/* Sum of products of ASRC_TAPS samples and one phase of the filter, in Q30 */
+static inline int32_t fir(int16_t const *x, int16_t const *c)
+{
+	int32_t acc = 0;
+
+#if defined(__ARM_FEATURE_SIMD32)
+	/* Two taps at a time with dual 16-bit multiply-accumulate */
+	for (size_t k = 0; k < ASRC_TAPS; k += 2) {
+		acc = __smlad(UNALIGNED_GET((int16x2_t const *)&x[k]),
+			      UNALIGNED_GET((int16x2_t const *)&c[k]), acc);
+	}
+#else
+	for (size_t k = 0; k < ASRC_TAPS; k++) {
+		acc += x[k] * c[k];
+	}
+#endif
+
+	return acc;
+}
+
+static inline int16_t sat16(int32_t pcm)
+{
+	if (pcm < INT16_MIN) {
+		return INT16_MIN;
+	} else if (pcm > INT16_MAX) {
+		return INT16_MAX;
+	}
+
+	return pcm;
+}
+
+int asrc_init(struct asrc_ctx *ctx, uint8_t num_ch)
+{
+	if (num_ch == 0 || num_ch > ASRC_CHANNELS_MAX) {
+		return -EINVAL;
+	}
+
+	memset(ctx, 0, sizeof(*ctx));
+	ctx->num_ch = num_ch;
+	ctx->pos = HISTORY_FRAMES;
+
+	return 0;
+}
+
+int asrc_drift_set(struct asrc_ctx *ctx, int32_t drift_ppb)
+{
+	if (drift_ppb > CTRL_DRIFT_PPB_MAX || drift_ppb < -CTRL_DRIFT_PPB_MAX) {
+		return -EINVAL;
+	}
+
+	/* 2^32 / 10^9 = 4.294967296 */
+	ctx->step = ((int64_t)drift_ppb * 4294967296LL) / 1000000000LL;
+
+	return 0;
+}
+
+int asrc_process(struct asrc_ctx *ctx, int16_t const *input, size_t in_frames, int16_t *output,
+		 size_t out_size, size_t *out_frames)
+{
+	size_t end = HISTORY_FRAMES + in_frames;
+	size_t frames = 0;
+
+	if (in_frames > ASRC_FRAMES_MAX) {
+		return -EINVAL;
+	}
+
+	if (out_size < ASRC_OUT_FRAMES_MAX(in_frames)) {
+		return -ENOMEM;
+	}
+
+	for (uint8_t ch = 0; ch < ctx->num_ch; ch++) {
+		for (size_t i = 0; i < in_frames; i++) {
+			ctx->buf[ch][HISTORY_FRAMES + i] = input[i * ctx->num_ch + ch];
+		}
+	}
+
+	while (ctx->pos < end) {
+		uint32_t idx = ctx->phase >> PHASE_FRAC_BITS;
+		/* Weight of the next phase, in Q15 */
+		int32_t weight = (ctx->phase >> (PHASE_FRAC_BITS - 15)) & 0x7FFF;
+
+		for (uint8_t ch = 0; ch < ctx->num_ch; ch++) {
+			int16_t const *x = &ctx->buf[ch][ctx->pos - HISTORY_FRAMES];
+			int32_t y0 = fir(x, coeffs[idx]);
+			int32_t y1 = fir(x, coeffs[idx + 1]);
+			int32_t y = y0 + (int32_t)((((int64_t)y1 - y0) * weight) >> 15);
+
+			*output++ = sat16((y + (1 << 14)) >> 15);
+		}
+
+		frames++;
+
+		int64_t next = (int64_t)ctx->phase + ((int64_t)1 << 32) + ctx->step;
+
+		ctx->pos += next >> 32;
+		ctx->phase = (uint32_t)next;
+	}
+
+	/* Keep the last input frames as history for the next call */
+	for (uint8_t ch = 0; ch < ctx->num_ch; ch++) {
+		memmove(ctx->buf[ch], &ctx->buf[ch][in_frames], HISTORY_FRAMES * sizeof(int16_t));
+	}
+
+	ctx->pos -= in_frames;
+	*out_frames = frames;
+
+	return 0;
+}
+
+int32_t asrc_offset_get(struct asrc_ctx const *ctx)
+{
+	int32_t pos = ctx->pos - HISTORY_FRAMES - ASRC_DELAY_FRAMES;
+
+	return (pos * 65536) + (int32_t)(ctx->phase >> 16);
+}
+
+void asrc_ctrl_reset(struct asrc_ctrl *ctrl)
+{
+	ctrl->integral = 0;
+}
+
+int32_t asrc_ctrl_update(struct asrc_ctrl *ctrl, int32_t err_us)
+{
+	int64_t drift;
+
+	ctrl->integral = CLAMP((int64_t)ctrl->integral + (int64_t)err_us * CTRL_KI_PPB_PER_US,
+			       -CTRL_DRIFT_PPB_MAX, CTRL_DRIFT_PPB_MAX);
+
+	drift = (int64_t)ctrl->integral + (int64_t)err_us * CTRL_KP_PPB_PER_US;
+
+	return CLAMP(drift, -CTRL_DRIFT_PPB_MAX, CTRL_DRIFT_PPB_MAX);
+}
@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) 2022 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#ifndef _ASRC_H_
+#define _ASRC_H_
+
+#include <zephyr/kernel.h>
+
+/* Number of filter taps per output sample */
+#define ASRC_TAPS 16
+/* Number of filter phases between two input samples, as a power of two */
+#define ASRC_PHASES_LOG2 6
+#define ASRC_CHANNELS_MAX 2
+/* Largest number of input frames per call, 10 ms at 48 kHz */
+#define ASRC_FRAMES_MAX 480
+/* Delay of the filter, in input frames */
+#define ASRC_DELAY_FRAMES (ASRC_TAPS / 2)
+/* Largest supported drift between the input and the output clocks */
+#define ASRC_DRIFT_PPM_MAX 2000
+/* Size of the output buffer needed for in_frames input frames */
+#define ASRC_OUT_FRAMES_MAX(in_frames) ((in_frames) + ((in_frames) / 256) + 1)
+
+/* Asynchronous sample rate converter for a small drift between two clocks
+ * of the same nominal sample rate. The output samples are interpolated with a
+ * polyphase filter, with linear interpolation between the phases.
+ */
+struct asrc_ctx {
+	uint8_t num_ch;
+	/* Position of the next output sample in buf, integer and fraction */
+	uint16_t pos;
+	uint32_t phase;
+	/* Input frames consumed per output frame minus one, as a Q0.32 value */
+	int32_t step;
+	/* De-interleaved input, after the last ASRC_TAPS - 1 input frames */
+	int16_t buf[ASRC_CHANNELS_MAX][ASRC_TAPS - 1 + ASRC_FRAMES_MAX];
+};
+
+/* Controller of the drift of the converter, from the error of the buffered
+ * audio. The controller is a PI controller, where the integral settles at the
+ * drift between the two clocks.
+ */
+struct asrc_ctrl {
+	int32_t integral;
+};
+
+/**
+ * @brief Initialize a sample rate converter, with no drift.
+ *
+ * @param ctx		[out]	Sample rate converter context
+ * @param num_ch	[in]	Number of interleaved channels, 1 or 2
+ *
+ * @return 0		Success
+ * @return -EINVAL	Unsupported number of channels
+ */
+int asrc_init(struct asrc_ctx *ctx, uint8_t num_ch);
+
+/**
+ * @brief Set the drift between the input and the output clocks.
+ *
+ * @param ctx		[in/out]	Sample rate converter context
+ * @param drift_ppb	[in]		Drift in parts per billion, positive when the
+ *					input clock is faster than the output clock
+ *
+ * @return 0		Success
+ * @return -EINVAL	Drift larger than ASRC_DRIFT_PPM_MAX
+ */
+int asrc_drift_set(struct asrc_ctx *ctx, int32_t drift_ppb);
+
+/**
+ * @brief Convert a block of signed 16-bit interleaved PCM data.
+ *
+ * @note The number of output frames varies by one frame from call to call,
+ * depending on the drift.
+ *
+ * @param ctx		[in/out]	Sample rate converter context
+ * @param input		[in]		Input PCM data
+ * @param in_frames	[in]		Number of input frames
+ * @param output	[out]		Output PCM data
+ * @param out_size	[in]		Size of output, in frames. Must be at least
+ *					ASRC_OUT_FRAMES_MAX(in_frames)
+ * @param out_frames	[out]		Number of frames written to output
+ *
+ * @return 0		Success
+ * @return -EINVAL	in_frames is larger than ASRC_FRAMES_MAX
+ * @return -ENOMEM	out_size is too small
+ */
+int asrc_process(struct asrc_ctx *ctx, int16_t const *input, size_t in_frames, int16_t *output,
+		 size_t out_size, size_t *out_frames);
+
+/**
+ * @brief Get the time of the first output frame of the next call to asrc_process().
+ *
+ * @note The time includes the delay of the filter, and is used to time stamp
+ * the output with the time stamp of the input.
+ *
+ * @param ctx		[in]	Sample rate converter context
+ *
+ * @return Time relative to the first input frame of the next call, in
+ *	   1/65536 input frames. Negative, as the output is delayed.
+ */
+int32_t asrc_offset_get(struct asrc_ctx const *ctx);
+
+/**
+ * @brief Reset the drift controller.
+ *
+ * @param ctrl		[out]	Drift controller
+ */
+void asrc_ctrl_reset(struct asrc_ctrl *ctrl);
+
+/**
+ * @brief Update the drift controller with a new measurement.
+ *
+ * @note Must be called once per audio frame. The gains are tuned for frames
+ * of 7.5 or 10 ms.
+ *
+ * @param ctrl		[in/out]	Drift controller
+ * @param err_us	[in]		Buffered audio minus the target, in microseconds
+ *
+ * @return Drift to set with asrc_drift_set(), in parts per billion
+ */
+int32_t asrc_ctrl_update(struct asrc_ctrl *ctrl, int32_t err_us);
+
+#endif /* _ASRC_H_ */
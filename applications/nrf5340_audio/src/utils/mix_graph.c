@@ -0,0 +1,240 @@
+/*
+ * Copyright (c) 2022 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include "mix_graph.h"
+
+#include <zephyr/kernel.h>
+#include <errno.h>
+#include <string.h>
+
+#if defined(__ARM_FEATURE_SAT)
+#include <arm_acle.h>
+#endif
+
+/* The mix of all sources at the largest gain must fit in the accumulator */
+BUILD_ASSERT((int64_t)MIX_GRAPH_SRC_MAX * MIX_GRAPH_GAIN_MAX * 32768 <= ((int64_t)1 << 31),
+	     "Accumulator overflow");
+
+static inline int16_t acc_to_pcm(int32_t acc)
+{
+	int32_t pcm = (acc + (1 << (MIX_GRAPH_GAIN_BITS - 1))) >> MIX_GRAPH_GAIN_BITS;
+
+#if defined(__ARM_FEATURE_SAT)
+	return __ssat(pcm, 16);
+#else
+	if (pcm > INT16_MAX) {
+		return INT16_MAX;
+	} else if (pcm < INT16_MIN) {
+		return INT16_MIN;
+	}
+
+	return pcm;
+#endif
+}
+
+/* Same number of channels in the source and the bus */
+static void acc_same(int32_t *acc, int16_t const *pcm, size_t num_samples, int32_t gain,
+		     bool first)
+{
+	if (first) {
+		for (size_t i = 0; i < num_samples; i++) {
+			acc[i] = pcm[i] * gain;
+		}
+	} else {
+		for (size_t i = 0; i < num_samples; i++) {
+			acc[i] += pcm[i] * gain;
+		}
+	}
+}
+
+static void acc_mono_into_stereo(int32_t *acc, int16_t const *pcm, size_t num_frames,
+				 int32_t gain, bool first)
+{
+	for (size_t i = 0; i < num_frames; i++) {
+		int32_t val = pcm[i] * gain;
+
+		if (first) {
+			acc[2 * i] = val;
+			acc[2 * i + 1] = val;
+		} else {
+			acc[2 * i] += val;
+			acc[2 * i + 1] += val;
+		}
+	}
+}
+
+static void acc_stereo_into_mono(int32_t *acc, int16_t const *pcm, size_t num_frames,
+				 int32_t gain, bool first)
+{
+	/* Half the gain for each channel */
+	gain = (gain + 1) / 2;
+
+	for (size_t i = 0; i < num_frames; i++) {
+		int32_t val = (pcm[2 * i] + pcm[2 * i + 1]) * gain;
+
+		if (first) {
+			acc[i] = val;
+		} else {
+			acc[i] += val;
+		}
+	}
+}
+
+static void bus_process(struct mix_graph *graph, struct mix_graph_bus *bus)
+{
+	size_t num_samples = graph->num_frames * bus->num_ch;
+	bool first = true;
+
+	for (uint8_t s = 0; s < graph->num_src; s++) {
+		struct mix_graph_src const *src = &graph->src[s];
+		int32_t gain = ((uint32_t)src->gain * bus->route_gain[s] +
+				(1 << (MIX_GRAPH_GAIN_BITS - 1))) >> MIX_GRAPH_GAIN_BITS;
+
+		if ((src->pcm == NULL) || (gain == 0)) {
+			continue;
+		}
+
+		gain = MIN(gain, MIX_GRAPH_GAIN_MAX);
+
+		if (src->num_ch == bus->num_ch) {
+			acc_same(graph->acc, src->pcm, num_samples, gain, first);
+		} else if (src->num_ch == 1) {
+			acc_mono_into_stereo(graph->acc, src->pcm, graph->num_frames, gain, first);
+		} else {
+			acc_stereo_into_mono(graph->acc, src->pcm, graph->num_frames, gain, first);
+		}
+
+		first = false;
+	}
+
+	if (first) {
+		/* No sources */
+		memset(bus->pcm, 0, num_samples * sizeof(int16_t));
+		return;
+	}
+
+	for (size_t i = 0; i < num_samples; i++) {
+		bus->pcm[i] = acc_to_pcm(graph->acc[i]);
+	}
+}
+
+int mix_graph_init(struct mix_graph *graph, uint16_t num_frames)
+{
+	if (num_frames == 0 || num_frames > MIX_GRAPH_FRAMES_MAX) {
+		return -EINVAL;
+	}
+
+	graph->num_frames = num_frames;
+	graph->num_src = 0;
+	graph->num_bus = 0;
+
+	return 0;
+}
+
+int mix_graph_src_add(struct mix_graph *graph, uint8_t num_ch, uint8_t *src_id)
+{
+	struct mix_graph_src *src;
+
+	if (num_ch == 0 || num_ch > MIX_GRAPH_CH_MAX) {
+		return -EINVAL;
+	}
+
+	if (graph->num_src == MIX_GRAPH_SRC_MAX) {
+		return -ENOMEM;
+	}
+
+	src = &graph->src[graph->num_src];
+	src->num_ch = num_ch;
+	src->gain = MIX_GRAPH_GAIN_UNITY;
+	src->pcm = NULL;
+
+	for (uint8_t b = 0; b < graph->num_bus; b++) {
+		graph->bus[b].route_gain[graph->num_src] = 0;
+	}
+
+	*src_id = graph->num_src++;
+
+	return 0;
+}
+
+int mix_graph_bus_add(struct mix_graph *graph, uint8_t num_ch, uint8_t *bus_id)
+{
+	struct mix_graph_bus *bus;
+
+	if (num_ch == 0 || num_ch > MIX_GRAPH_CH_MAX) {
+		return -EINVAL;
+	}
+
+	if (graph->num_bus == MIX_GRAPH_BUS_MAX) {
+		return -ENOMEM;
+	}
+
+	bus = &graph->bus[graph->num_bus];
+	bus->num_ch = num_ch;
+	memset(bus->route_gain, 0, sizeof(bus->route_gain));
+	memset(bus->pcm, 0, sizeof(bus->pcm));
+
+	*bus_id = graph->num_bus++;
+
+	return 0;
+}
+
+int mix_graph_src_gain_set(struct mix_graph *graph, uint8_t src_id, uint16_t gain)
+{
+	if (src_id >= graph->num_src || gain > MIX_GRAPH_GAIN_MAX) {
+		return -EINVAL;
+	}
+
+	graph->src[src_id].gain = gain;
+
+	return 0;
+}
+
+int mix_graph_route_set(struct mix_graph *graph, uint8_t src_id, uint8_t bus_id, uint16_t gain)
+{
+	if (src_id >= graph->num_src || bus_id >= graph->num_bus || gain > MIX_GRAPH_GAIN_MAX) {
+		return -EINVAL;
+	}
+
+	graph->bus[bus_id].route_gain[src_id] = gain;
+
+	return 0;
+}
+
+int mix_graph_src_data_set(struct mix_graph *graph, uint8_t src_id, int16_t const *pcm)
+{
+	if (src_id >= graph->num_src) {
+		return -EINVAL;
+	}
+
+	graph->src[src_id].pcm = pcm;
+
+	return 0;
+}
+
+void mix_graph_process(struct mix_graph *graph)
+{
+	for (uint8_t b = 0; b < graph->num_bus; b++) {
+		bus_process(graph, &graph->bus[b]);
+	}
+
+	for (uint8_t s = 0; s < graph->num_src; s++) {
+		graph->src[s].pcm = NULL;
+	}
+}
+
+int mix_graph_bus_data_get(struct mix_graph const *graph, uint8_t bus_id, int16_t const **pcm,
+			   size_t *size)
+{
+	if (bus_id >= graph->num_bus) {
+		return -EINVAL;
+	}
+
+	*pcm = graph->bus[bus_id].pcm;
+	*size = graph->num_frames * graph->bus[bus_id].num_ch * sizeof(int16_t);
+
+	return 0;
+}
@@ -0,0 +1,164 @@
+/*
+ * Copyright (c) 2022 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#ifndef _MIX_GRAPH_H_
+#define _MIX_GRAPH_H_
+
+#include <zephyr/kernel.h>
+
+#define MIX_GRAPH_SRC_MAX 8
+#define MIX_GRAPH_BUS_MAX 8
+#define MIX_GRAPH_CH_MAX 2
+/* Largest block, 10 ms at 48 kHz */
+#define MIX_GRAPH_FRAMES_MAX 480
+
+/* Gains are unsigned Q4.12 values */
+#define MIX_GRAPH_GAIN_BITS 12
+#define MIX_GRAPH_GAIN_UNITY (1 << MIX_GRAPH_GAIN_BITS)
+/* Largest gain from a source to a bus. Limits the mix of all sources to the
+ * range of the accumulator.
+ */
+#define MIX_GRAPH_GAIN_MAX (2 * MIX_GRAPH_GAIN_UNITY)
+
+/* A source is a stream of signed 16-bit PCM data, for example a decoded
+ * CIS or BIS stream.
+ */
+struct mix_graph_src {
+	uint8_t num_ch;
+	uint16_t gain;
+	/* Data of the current block, NULL if the source is silent */
+	int16_t const *pcm;
+};
+
+/* A bus mixes the sources routed to it, for example for one encoder. */
+struct mix_graph_bus {
+	uint8_t num_ch;
+	/* Gain of the route from every source, 0 if the source is not routed */
+	uint16_t route_gain[MIX_GRAPH_SRC_MAX];
+	int16_t __aligned(sizeof(uint32_t)) pcm[MIX_GRAPH_FRAMES_MAX * MIX_GRAPH_CH_MAX];
+};
+
+/* Routing and mixing of sources into buses, in blocks of a fixed number of
+ * frames. All buffers are part of the graph, so no memory is allocated while
+ * processing.
+ */
+struct mix_graph {
+	uint16_t num_frames;
+	uint8_t num_src;
+	uint8_t num_bus;
+	struct mix_graph_src src[MIX_GRAPH_SRC_MAX];
+	struct mix_graph_bus bus[MIX_GRAPH_BUS_MAX];
+	int32_t acc[MIX_GRAPH_FRAMES_MAX * MIX_GRAPH_CH_MAX];
+};
+
+/**
+ * @brief Initialize an empty mixing graph.
+ *
+ * @param graph		[out]	Mixing graph
+ * @param num_frames	[in]	Number of frames in every block
+ *
+ * @return 0		Success
+ * @return -EINVAL	num_frames is 0 or larger than MIX_GRAPH_FRAMES_MAX
+ */
+int mix_graph_init(struct mix_graph *graph, uint16_t num_frames);
+
+/**
+ * @brief Add a source with unity gain, not routed to any bus.
+ *
+ * @param graph		[in/out]	Mixing graph
+ * @param num_ch	[in]		Number of interleaved channels, 1 or 2
+ * @param src_id	[out]		Identifier of the new source
+ *
+ * @return 0		Success
+ * @return -EINVAL	Unsupported number of channels
+ * @return -ENOMEM	MIX_GRAPH_SRC_MAX sources already added
+ */
+int mix_graph_src_add(struct mix_graph *graph, uint8_t num_ch, uint8_t *src_id);
+
+/**
+ * @brief Add a bus, with no sources routed to it.
+ *
+ * @param graph		[in/out]	Mixing graph
+ * @param num_ch	[in]		Number of interleaved channels, 1 or 2
+ * @param bus_id	[out]		Identifier of the new bus
+ *
+ * @return 0		Success
+ * @return -EINVAL	Unsupported number of channels
+ * @return -ENOMEM	MIX_GRAPH_BUS_MAX buses already added
+ */
+int mix_graph_bus_add(struct mix_graph *graph, uint8_t num_ch, uint8_t *bus_id);
+
+/**
+ * @brief Set the gain of a source, applied to all its routes.
+ *
+ * @param graph		[in/out]	Mixing graph
+ * @param src_id	[in]		Source identifier
+ * @param gain		[in]		Gain, up to MIX_GRAPH_GAIN_MAX
+ *
+ * @return 0		Success
+ * @return -EINVAL	Invalid source or gain
+ */
+int mix_graph_src_gain_set(struct mix_graph *graph, uint8_t src_id, uint16_t gain);
+
+/**
+ * @brief Route a source to a bus, or remove the route.
+ *
+ * @note A mono source is mixed into both channels of a stereo bus, and both
+ * channels of a stereo source are mixed into a mono bus at half the gain.
+ * The gain of the route is multiplied with the gain of the source, and the
+ * product is limited to MIX_GRAPH_GAIN_MAX.
+ *
+ * @param graph		[in/out]	Mixing graph
+ * @param src_id	[in]		Source identifier
+ * @param bus_id	[in]		Bus identifier
+ * @param gain		[in]		Gain of the route, up to MIX_GRAPH_GAIN_MAX.
+ *					0 removes the route
+ *
+ * @return 0		Success
+ * @return -EINVAL	Invalid source, bus or gain
+ */
+int mix_graph_route_set(struct mix_graph *graph, uint8_t src_id, uint8_t bus_id, uint16_t gain);
+
+/**
+ * @brief Set the data of a source for the next block.
+ *
+ * @param graph		[in/out]	Mixing graph
+ * @param src_id	[in]		Source identifier
+ * @param pcm		[in]		Interleaved PCM data of the block, or NULL
+ *					if there is no data, for example when a
+ *					frame is lost. Must be valid until the
+ *					block is processed
+ *
+ * @return 0		Success
+ * @return -EINVAL	Invalid source
+ */
+int mix_graph_src_data_set(struct mix_graph *graph, uint8_t src_id, int16_t const *pcm);
+
+/**
+ * @brief Mix one block of all sources into all buses.
+ *
+ * @note The mix is saturated to 16 bits. A bus without any sources with data
+ * is silent. The data of the sources must be set again for the next block.
+ *
+ * @param graph		[in/out]	Mixing graph
+ */
+void mix_graph_process(struct mix_graph *graph);
+
+/**
+ * @brief Get the mix of a bus, from the last processed block.
+ *
+ * @param graph		[in]	Mixing graph
+ * @param bus_id	[in]	Bus identifier
+ * @param pcm		[out]	Interleaved PCM data of the bus
+ * @param size		[out]	Size of the PCM data, in bytes
+ *
+ * @return 0		Success
+ * @return -EINVAL	Invalid bus
+ */
+int mix_graph_bus_data_get(struct mix_graph const *graph, uint8_t bus_id, int16_t const **pcm,
+			   size_t *size);
+
+#endif /* _MIX_GRAPH_H_ */
@@ -11,30 +11,62 @@
 #include <zephyr/logging/log.h>
 LOG_MODULE_REGISTER(pcm_mix, LOG_LEVEL_WRN);
 
+#if defined(__ARM_FEATURE_SAT) || defined(__ARM_FEATURE_SIMD32)
+#include <arm_acle.h>
+#endif
+
+/* Samples are mixed two at a time in packed 32-bit words when the target
+ * has the SIMD instructions of the DSP extension, e.g. Cortex-M33 and M4.
+ * The per-sample loops are the reference, which the packed code must match
+ * bit by bit. They are used for the remaining samples and on other targets.
+ */
+#if defined(__ARM_FEATURE_SIMD32)
+BUILD_ASSERT(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "Packed samples must be little-endian");
+
+/* Buffers are only guaranteed to be aligned to the size of one sample */
+static inline int16x2_t pair_get(int16_t const *const pcm)
+{
+	return UNALIGNED_GET((int16x2_t const *)pcm);
+}
+
+static inline void pair_put(int16_t *const pcm, int16x2_t pair)
+{
+	UNALIGNED_PUT(pair, (int16x2_t *)pcm);
+}
+#endif /* defined(__ARM_FEATURE_SIMD32) */
+
 /* Clip signal if amplitude is outside legal range */
-static void hard_limiter(int32_t *const pcm)
+static inline int16_t hard_limiter(int32_t pcm)
 {
-	if (*pcm < INT16_MIN) {
-		LOG_DBG("Clip");
-		*pcm = INT16_MIN;
-	} else if (*pcm > INT16_MAX) {
-		LOG_DBG("Clip");
-		*pcm = INT16_MAX;
+#if defined(__ARM_FEATURE_SAT)
+	return __ssat(pcm, 16);
+#else
+	if (pcm < INT16_MIN) {
+		return INT16_MIN;
+	} else if (pcm > INT16_MAX) {
+		return INT16_MAX;
 	}
+
+	return pcm;
+#endif
 }
 
 /* Mix stereo-stereo or mono-mono. I.e. buffers are of equal size */
 static void pcm_mix_identical(void *const pcm_a, size_t size_a, void const *const pcm_b,
 			      size_t size_b)
 {
-	int32_t res;
-
-	for (uint32_t i = 0; i < size_b / 2; i++) {
-		res = ((int16_t *)pcm_a)[i] + ((int16_t *)pcm_b)[i];
+	int16_t *a = pcm_a;
+	int16_t const *b = pcm_b;
+	uint32_t i = 0;
 
-		hard_limiter(&res);
+#if defined(__ARM_FEATURE_SIMD32)
+	for (; i + 1 < size_b / 2; i += 2) {
+		pair_put(&a[i], __qadd16(pair_get(&a[i]), pair_get(&b[i])));
+	}
+#endif
 
-		((int16_t *)pcm_a)[i] = (int16_t)res;
+	for (; i < size_b / 2; i++) {
+		a[i] = hard_limiter(a[i] + b[i]);
 	}
 }
 
@@ -42,18 +74,27 @@ static void pcm_mix_identical(void *const pcm_a, size_t size_a, void const *cons
 static void pcm_mix_b_mono_into_a_stereo_lr(void *const pcm_a, size_t size_a,
 					    void const *const pcm_b, size_t size_b)
 {
-	int32_t res;
+	int16_t *a = pcm_a;
+	int16_t const *b = pcm_b;
+	uint32_t i = 0;
+
+#if defined(__ARM_FEATURE_SIMD32)
+	/* Each mono sample is duplicated into both halves of a word */
+	for (; i + 3 < size_b; i += 4) {
+		uint32_t mono = pair_get(&b[i / 2]);
+
+		pair_put(&a[i], __qadd16(pair_get(&a[i]), (mono & 0xFFFF) | (mono << 16)));
+		pair_put(&a[i + 2],
+			 __qadd16(pair_get(&a[i + 2]), (mono >> 16) | (mono & 0xFFFF0000)));
+	}
+#endif
 
 	/* Use size_b as this is the length of the mono sample.
 	 * This must be *2 to traverse the stereo sample and /2 since
 	 * the sample is two bytes in size.
 	 */
-	for (uint32_t i = 0; i < size_b; i++) {
-		res = ((int16_t *)pcm_a)[i] + ((int16_t *)pcm_b)[i / 2];
-
-		hard_limiter(&res);
-
-		((int16_t *)pcm_a)[i] = (int16_t)res;
+	for (; i < size_b; i++) {
+		a[i] = hard_limiter(a[i] + b[i / 2]);
 	}
 }
 
@@ -61,14 +102,22 @@ static void pcm_mix_b_mono_into_a_stereo_lr(void *const pcm_a, size_t size_a,
 static void pcm_mix_b_mono_into_a_stereo_l(void *const pcm_a, size_t size_a,
 					   void const *const pcm_b, size_t size_b)
 {
-	int32_t res;
+	int16_t *a = pcm_a;
+	int16_t const *b = pcm_b;
+	uint32_t i = 0;
 
-	for (uint32_t i = 0; i < size_b / 2; i++) {
-		res = ((int16_t *)pcm_a)[i * 2] + ((int16_t *)pcm_b)[i];
+#if defined(__ARM_FEATURE_SIMD32)
+	/* Adding zero in the upper half word leaves the right channel as is */
+	for (; i + 1 < size_b / 2; i += 2) {
+		uint32_t mono = pair_get(&b[i]);
 
-		hard_limiter(&res);
+		pair_put(&a[i * 2], __qadd16(pair_get(&a[i * 2]), mono & 0xFFFF));
+		pair_put(&a[i * 2 + 2], __qadd16(pair_get(&a[i * 2 + 2]), mono >> 16));
+	}
+#endif
 
-		((int16_t *)pcm_a)[i * 2] = (int16_t)res;
+	for (; i < size_b / 2; i++) {
+		a[i * 2] = hard_limiter(a[i * 2] + b[i]);
 	}
 }
 
@@ -76,14 +125,22 @@ static void pcm_mix_b_mono_into_a_stereo_l(void *const pcm_a, size_t size_a,
 static void pcm_mix_b_mono_into_a_stereo_r(void *const pcm_a, size_t size_a,
 					   void const *const pcm_b, size_t size_b)
 {
-	int32_t res;
+	int16_t *a = pcm_a;
+	int16_t const *b = pcm_b;
+	uint32_t i = 0;
 
-	for (uint32_t i = 0; i < size_b / 2; i++) {
-		res = ((int16_t *)pcm_a)[i * 2 + 1] + ((int16_t *)pcm_b)[i];
+#if defined(__ARM_FEATURE_SIMD32)
+	/* Adding zero in the lower half word leaves the left channel as is */
+	for (; i + 1 < size_b / 2; i += 2) {
+		uint32_t mono = pair_get(&b[i]);
 
-		hard_limiter(&res);
+		pair_put(&a[i * 2], __qadd16(pair_get(&a[i * 2]), mono << 16));
+		pair_put(&a[i * 2 + 2], __qadd16(pair_get(&a[i * 2 + 2]), mono & 0xFFFF0000));
+	}
+#endif
 
-		((int16_t *)pcm_a)[i * 2 + 1] = (int16_t)res;
+	for (; i < size_b / 2; i++) {
+		a[i * 2 + 1] = hard_limiter(a[i * 2 + 1] + b[i]);
 	}
 }
 
@@ -115,17 +172,17 @@ int pcm_mix(void *const pcm_a, size_t size_a, void const *const pcm_b, size_t si
 		pcm_mix_b_mono_into_a_stereo_lr(pcm_a, size_a, pcm_b, size_b);
 		break;
 	case B_MONO_INTO_A_STEREO_L:
-		pcm_mix_b_mono_into_a_stereo_l(pcm_a, size_a, pcm_b, size_b);
 		if (size_b > (size_a / 2)) {
 			LOG_ERR("size a %d size b %d", size_a, size_b);
 			return -EPERM;
 		}
+		pcm_mix_b_mono_into_a_stereo_l(pcm_a, size_a, pcm_b, size_b);
 		break;
 	case B_MONO_INTO_A_STEREO_R:
-		pcm_mix_b_mono_into_a_stereo_r(pcm_a, size_a, pcm_b, size_b);
 		if (size_b > (size_a / 2)) {
 			return -EPERM;
 		}
+		pcm_mix_b_mono_into_a_stereo_r(pcm_a, size_a, pcm_b, size_b);
 		break;
 	default:
 		return -ESRCH;
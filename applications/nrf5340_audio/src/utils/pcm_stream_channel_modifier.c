@@ -51,6 +51,105 @@ static bool is_valid_size(size_t size, uint8_t bytes_per_sample, uint8_t no_chan
 	return true;
 }
 
+/* 16-bit samples are moved two at a time in 32-bit words, with the first
+ * sample, or the left channel of a stereo frame, in the lower half word.
+ * The byte loops are the reference for these kernels, and are used for the
+ * other bit depths. The buffers may be unaligned.
+ */
+BUILD_ASSERT(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "Packed samples must be little-endian");
+
+static inline uint32_t word_get(void const *const pointer)
+{
+	return UNALIGNED_GET((uint32_t const *)pointer);
+}
+
+static inline void word_put(void *const pointer, uint32_t word)
+{
+	UNALIGNED_PUT(word, (uint32_t *)pointer);
+}
+
+static void zero_pad_16(uint16_t const *input, size_t samples, enum audio_channel channel,
+			uint32_t *output)
+{
+	uint8_t shift = (channel == AUDIO_CH_L) ? 0 : 16;
+	size_t i = 0;
+
+	for (; i + 1 < samples; i += 2) {
+		uint32_t pair = word_get(&input[i]);
+
+		word_put(&output[i], (pair & 0xFFFF) << shift);
+		word_put(&output[i + 1], (pair >> 16) << shift);
+	}
+
+	if (i < samples) {
+		word_put(&output[i], (uint32_t)UNALIGNED_GET(&input[i]) << shift);
+	}
+}
+
+static void copy_pad_16(uint16_t const *input, size_t samples, uint32_t *output)
+{
+	size_t i = 0;
+
+	for (; i + 1 < samples; i += 2) {
+		uint32_t pair = word_get(&input[i]);
+
+		word_put(&output[i], (pair & 0xFFFF) | (pair << 16));
+		word_put(&output[i + 1], (pair >> 16) | (pair & 0xFFFF0000));
+	}
+
+	if (i < samples) {
+		word_put(&output[i], (uint32_t)UNALIGNED_GET(&input[i]) * 0x10001);
+	}
+}
+
+static void combine_16(uint16_t const *input_left, uint16_t const *input_right, size_t samples,
+		       uint32_t *output)
+{
+	size_t i = 0;
+
+	for (; i + 1 < samples; i += 2) {
+		uint32_t left = word_get(&input_left[i]);
+		uint32_t right = word_get(&input_right[i]);
+
+		word_put(&output[i], (left & 0xFFFF) | (right << 16));
+		word_put(&output[i + 1], (left >> 16) | (right & 0xFFFF0000));
+	}
+
+	if (i < samples) {
+		word_put(&output[i], UNALIGNED_GET(&input_left[i]) |
+					     ((uint32_t)UNALIGNED_GET(&input_right[i]) << 16));
+	}
+}
+
+static void split_16(uint32_t const *input, size_t frames, uint16_t *output_left,
+		     uint16_t *output_right)
+{
+	size_t i = 0;
+
+	for (; i + 1 < frames; i += 2) {
+		uint32_t first = word_get(&input[i]);
+		uint32_t second = word_get(&input[i + 1]);
+
+		if (output_left != NULL) {
+			word_put(&output_left[i], (first & 0xFFFF) | (second << 16));
+		}
+		if (output_right != NULL) {
+			word_put(&output_right[i], (first >> 16) | (second & 0xFFFF0000));
+		}
+	}
+
+	if (i < frames) {
+		uint32_t frame = word_get(&input[i]);
+
+		if (output_left != NULL) {
+			UNALIGNED_PUT((uint16_t)frame, &output_left[i]);
+		}
+		if (output_right != NULL) {
+			UNALIGNED_PUT((uint16_t)(frame >> 16), &output_right[i]);
+		}
+	}
+}
+
 int pscm_zero_pad(void const *const input, size_t input_size, enum audio_channel channel,
 		  uint8_t pcm_bit_depth, void *output, size_t *output_size)
 {
@@ -60,6 +159,17 @@ int pscm_zero_pad(void const *const input, size_t input_size, enum audio_channel
 		return -EINVAL;
 	}
 
+	if (channel != AUDIO_CH_L && channel != AUDIO_CH_R) {
+		LOG_ERR("Invalid channel selection");
+		return -EINVAL;
+	}
+
+	if (pcm_bit_depth == 16) {
+		zero_pad_16(input, input_size / bytes_per_sample, channel, output);
+		*output_size = input_size * 2;
+		return 0;
+	}
+
 	char *pointer_input = (char *)input;
 	char *pointer_output = (char *)output;
 
@@ -72,7 +182,7 @@ int pscm_zero_pad(void const *const input, size_t input_size, enum audio_channel
 			for (uint8_t j = 0; j < bytes_per_sample; j++) {
 				*pointer_output++ = 0;
 			}
-		} else if (channel == AUDIO_CH_R) {
+		} else {
 			for (uint8_t j = 0; j < bytes_per_sample; j++) {
 				*pointer_output++ = 0;
 			}
@@ -80,9 +190,6 @@ int pscm_zero_pad(void const *const input, size_t input_size, enum audio_channel
 			for (uint8_t j = 0; j < bytes_per_sample; j++) {
 				*pointer_output++ = *pointer_input++;
 			}
-		} else {
-			LOG_ERR("Invalid channel selection");
-			return -EINVAL;
 		}
 	}
 
@@ -99,6 +206,12 @@ int pscm_copy_pad(void const *const input, size_t input_size, uint8_t pcm_bit_de
 		return -EINVAL;
 	}
 
+	if (pcm_bit_depth == 16) {
+		copy_pad_16(input, input_size / bytes_per_sample, output);
+		*output_size = input_size * 2;
+		return 0;
+	}
+
 	char *pointer_input = (char *)input;
 	char *pointer_output = (char *)output;
 
@@ -127,6 +240,12 @@ int pscm_combine(void const *const input_left, void const *const input_right, si
 		return -EINVAL;
 	}
 
+	if (pcm_bit_depth == 16) {
+		combine_16(input_left, input_right, input_size / bytes_per_sample, output);
+		*output_size = input_size * 2;
+		return 0;
+	}
+
 	char *pointer_input_left = (char *)input_left;
 	char *pointer_input_right = (char *)input_right;
 	char *pointer_output = (char *)output;
@@ -154,6 +273,19 @@ int pscm_one_channel_split(void const *const input, size_t input_size,
 		return -EINVAL;
 	}
 
+	if (channel != AUDIO_CH_L && channel != AUDIO_CH_R) {
+		LOG_ERR("Invalid channel selection");
+		return -EINVAL;
+	}
+
+	if (pcm_bit_depth == 16) {
+		split_16(input, input_size / (bytes_per_sample * 2),
+			 (channel == AUDIO_CH_L) ? output : NULL,
+			 (channel == AUDIO_CH_R) ? output : NULL);
+		*output_size = input_size / 2;
+		return 0;
+	}
+
 	char *pointer_input = (char *)input;
 	char *pointer_output = (char *)output;
 
@@ -164,15 +296,12 @@ int pscm_one_channel_split(void const *const input, size_t input_size,
 			}
 			pointer_input += bytes_per_sample;
 
-		} else if (channel == AUDIO_CH_R) {
+		} else {
 			pointer_input += bytes_per_sample;
 
 			for (uint8_t j = 0; j < bytes_per_sample; j++) {
 				*pointer_output++ = *pointer_input++;
 			}
-		} else {
-			LOG_ERR("Invalid channel selection");
-			return -EINVAL;
 		}
 	}
 
@@ -189,6 +318,12 @@ int pscm_two_channel_split(void const *const input, size_t input_size, uint8_t p
 		return -EINVAL;
 	}
 
+	if (pcm_bit_depth == 16) {
+		split_16(input, input_size / (bytes_per_sample * 2), output_left, output_right);
+		*output_size = input_size / 2;
+		return 0;
+	}
+
 	char *pointer_input = (char *)input;
 	char *pointer_output_left = (char *)output_left;
 	char *pointer_output_right = (char *)output_right;
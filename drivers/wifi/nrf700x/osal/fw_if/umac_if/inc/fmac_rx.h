@@ -34,6 +34,8 @@ enum wifi_nrf_status wifi_nrf_fmac_rx_cmd_send(struct wifi_nrf_fmac_dev_ctx *fma
 					       enum wifi_nrf_fmac_rx_cmd_type cmd_type,
 					       unsigned int desc_id);
 
+enum wifi_nrf_status wifi_nrf_fmac_rx_refill(struct wifi_nrf_fmac_dev_ctx *fmac_dev_ctx);
+
 enum wifi_nrf_status wifi_nrf_fmac_rx_event_process(struct wifi_nrf_fmac_dev_ctx *fmac_dev_ctx,
 						    struct img_rx_buff *config);
 
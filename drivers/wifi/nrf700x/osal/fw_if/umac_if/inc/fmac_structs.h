@@ -15,6 +15,7 @@
 #include <stdbool.h>
 
 #include "osal_api.h"
+#include "queue.h"
 #include "host_rpu_umac_if.h"
 
 #define MAX_PEERS 5
@@ -189,6 +190,22 @@ struct wifi_nrf_fmac_init_dev_params {
  * @total_tx_pkts: Total number of frames transmitted.
  * @total_tx_done_pkts: Total number of TX dones received.
  * @total_rx_pkts: Total number of frames received.
+ * @total_rx_buf_allocs: Total number of RX buffers allocated.
+ * @total_rx_buf_recycled: Total number of RX buffers handed back to the RPU
+ *                         without being reallocated.
+ * @total_rx_buf_refill_deferred: Total number of times refilling the RX
+ *                                buffers had to be deferred.
+ * @total_tx_cmds: Total number of TX commands sent to the RPU per access
+ *                 category.
+ * @total_tx_cmd_pkts: Total number of frames carried by the TX commands per
+ *                     access category. Divided by @total_tx_cmds this gives
+ *                     the achieved aggregation factor.
+ * @total_tx_coalesce_timeouts: Total number of TX coalescing windows per
+ *                              access category which were flushed because
+ *                              their latency budget expired.
+ * @total_tx_coalesce_stale_timeouts: Total number of TX coalescing timer
+ *                                    runs per access category which found a
+ *                                    newer window open and left it open.
  * @tx_coalesce_frames: Total number of transmit frames coalesced.
  * @tx_done_coalesce_frames: Total number of TX dones received for coalesced
  *                           frames.
@@ -203,6 +220,13 @@ struct rpu_host_stats {
 	unsigned long long total_tx_pkts;
 	unsigned long long total_tx_done_pkts;
 	unsigned long long total_rx_pkts;
+	unsigned long long total_rx_buf_allocs;
+	unsigned long long total_rx_buf_recycled;
+	unsigned long long total_rx_buf_refill_deferred;
+	unsigned long long total_tx_cmds[WIFI_NRF_FMAC_AC_MAX];
+	unsigned long long total_tx_cmd_pkts[WIFI_NRF_FMAC_AC_MAX];
+	unsigned long long total_tx_coalesce_timeouts[WIFI_NRF_FMAC_AC_MAX];
+	unsigned long long total_tx_coalesce_stale_timeouts[WIFI_NRF_FMAC_AC_MAX];
 };
 
 
@@ -248,12 +272,47 @@ struct peers_info {
 };
 
 
+/**
+ * struct tx_coalesce_info - Structure to hold the TX coalescing window of an
+ *                           access category.
+ * @fmac_dev_ctx: Pointer to the device context at the UMAC IF layer.
+ * @ac: Access category to which the window belongs.
+ * @timer: Timer which flushes the window when the latency budget expires.
+ * @max_frames: Maximum number of frames to hold in the window.
+ * @max_bytes: Maximum number of bytes to hold in the window.
+ * @max_us: Latency budget of the window in microseconds, 0 disables
+ *          coalescing for the access category.
+ * @start_us: Time at which the first frame entered the window.
+ * @frames: Number of frames which entered the window.
+ * @bytes: Number of bytes which entered the window.
+ * @armed: Flag indicating whether the window is open.
+ *
+ * Frames of an access category are held in the pending queues until one
+ * of the limits of the window is reached, so that they can be aggregated
+ * into a single TX command.
+ */
+struct tx_coalesce_info {
+	struct wifi_nrf_fmac_dev_ctx *fmac_dev_ctx;
+	unsigned int ac;
+	void *timer;
+	unsigned int max_frames;
+	unsigned int max_bytes;
+	unsigned int max_us;
+	unsigned long start_us;
+	unsigned int frames;
+	unsigned int bytes;
+	bool armed;
+};
+
+
 /**
  * struct tx_config - Structure to hold transmit path context information.
  * @tx_lock: Lock used to make code portions in the TX path atomic.
  * @peers: Context information about peers that the RPU is connected to.
  * @send_pkt_coalesce_count_p: Colasece count of TX frames.
  * @data_pending_txq: Queue for frames waiting to be passed to the RPU for TX.
+ * @pend_peer_bmp: Bitmap per access category of the peers which have frames
+ *                 in @data_pending_txq.
  * @wakeup_client_q: Queue for peers which have woken up from 802.11
  *                   power save.
  * @buf_pool_bmp_p: Bitmap of the TX buffer pool.
@@ -263,6 +322,7 @@ struct peers_info {
  *                      descriptor.
  * @pkt_info_p: Frame context information.
  * @spare_desc_queue_map: Map for the spare descriptor queues.
+ * @coalesce: TX coalescing window per access category.
  *
  * This structure holds context information for the transmit path.
  */
@@ -271,7 +331,8 @@ struct tx_config {
 
 	struct peers_info peers[MAX_SW_PEERS];
 	unsigned int *send_pkt_coalesce_count_p;
-	void *data_pending_txq[MAX_SW_PEERS][WIFI_NRF_FMAC_AC_MAX];
+	struct wifi_nrf_utils_nbuf_q data_pending_txq[MAX_SW_PEERS][WIFI_NRF_FMAC_AC_MAX];
+	unsigned int pend_peer_bmp[WIFI_NRF_FMAC_AC_MAX];
 	void *wakeup_client_q;
 
 	/* Used to store tx descs(buff pool ids) */
@@ -286,6 +347,7 @@ struct tx_config {
 	 * Second four bits Spare desc2 queue number
 	 */
 	unsigned int spare_desc_queue_map;
+	struct tx_coalesce_info coalesce[WIFI_NRF_FMAC_AC_MAX];
 };
 
 
@@ -332,6 +394,10 @@ struct wifi_nrf_fmac_priv {
  * @vif_ctx: Array of pointers to virtual interfaces created on this device.
  * @tx_buf_info: Context information for a TX buffer.
  * @rx_buf_info: Context information for a RX buffer.
+ * @rx_refill_q: Ring of RX descriptors waiting for a buffer to be handed
+ *               back to the RPU.
+ * @rx_refill_head: Index of the oldest entry in @rx_refill_q.
+ * @rx_refill_cnt: Number of entries in @rx_refill_q.
  * @mgmt_buf_info: Context information for a management buffer.
  * @tx_config: Context information related to TX path.
  * @stats_req: Flag indicating whether a request for statistics has been sent
@@ -359,6 +425,9 @@ struct wifi_nrf_fmac_dev_ctx {
 	struct wifi_nrf_fmac_vif_ctx *vif_ctx[MAX_NUM_VIFS];
 	struct wifi_nrf_fmac_buf_map_info *tx_buf_info;
 	struct wifi_nrf_fmac_buf_map_info *rx_buf_info;
+	unsigned int *rx_refill_q;
+	unsigned int rx_refill_head;
+	unsigned int rx_refill_cnt;
 	struct tx_config tx_config;
 	bool stats_req;
 	struct rpu_host_stats host_stats;
@@ -20,7 +20,7 @@
 
 
 struct tx_pkt_info {
-	void *pkt;
+	struct wifi_nrf_utils_nbuf_q pkt;
 	unsigned int peer_id;
 };
 
@@ -435,6 +435,11 @@ wifi_nrf_fmac_data_event_process(struct wifi_nrf_fmac_dev_ctx *fmac_dev_ctx,
 	case IMG_CMD_TX_BUFF_DONE:
 		status = wifi_nrf_fmac_tx_done_event_process(fmac_dev_ctx,
 							     umac_head);
+
+		/* Retry RX buffer refills deferred due to lack of memory */
+		if (fmac_dev_ctx->rx_refill_cnt) {
+			wifi_nrf_fmac_rx_refill(fmac_dev_ctx);
+		}
 		break;
 	case IMG_CMD_CARRIER_ON:
 		status = wifi_nrf_fmac_if_state_chg_event_process(fmac_dev_ctx,
@@ -98,6 +98,21 @@ static enum wifi_nrf_status wifi_nrf_fmac_init_rx(struct wifi_nrf_fmac_dev_ctx *
 		goto out;
 	}
 
+	size = (fpriv->num_rx_bufs * sizeof(*fmac_dev_ctx->rx_refill_q));
+
+	fmac_dev_ctx->rx_refill_q = wifi_nrf_osal_mem_zalloc(fmac_dev_ctx->fpriv->opriv,
+							     size);
+
+	if (!fmac_dev_ctx->rx_refill_q) {
+		wifi_nrf_osal_log_err(fmac_dev_ctx->fpriv->opriv,
+				      "%s: No space for RX refill queue\n",
+				      __func__);
+		goto out;
+	}
+
+	fmac_dev_ctx->rx_refill_head = 0;
+	fmac_dev_ctx->rx_refill_cnt = 0;
+
 	for (desc_id = 0; desc_id < fmac_dev_ctx->fpriv->num_rx_bufs; desc_id++) {
 		status = wifi_nrf_fmac_rx_cmd_send(fmac_dev_ctx,
 						   WIFI_NRF_FMAC_RX_CMD_TYPE_INIT,
@@ -138,6 +153,12 @@ static enum wifi_nrf_status wifi_nrf_fmac_deinit_rx(struct wifi_nrf_fmac_dev_ctx
 		}
 	}
 
+	wifi_nrf_osal_mem_free(fmac_dev_ctx->fpriv->opriv,
+			       fmac_dev_ctx->rx_refill_q);
+
+	fmac_dev_ctx->rx_refill_q = NULL;
+	fmac_dev_ctx->rx_refill_cnt = 0;
+
 	wifi_nrf_osal_mem_free(fmac_dev_ctx->fpriv->opriv,
 			       fmac_dev_ctx->rx_buf_info);
 
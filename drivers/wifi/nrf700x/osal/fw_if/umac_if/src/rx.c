@@ -37,17 +37,75 @@ out:
 }
 
 
+static enum wifi_nrf_status
+wifi_nrf_fmac_rx_buf_map(struct wifi_nrf_fmac_dev_ctx *fmac_dev_ctx,
+			 unsigned int desc_id,
+			 struct wifi_nrf_fmac_rx_pool_map_info *pool_info,
+			 unsigned int buf_len)
+{
+	enum wifi_nrf_status status = WIFI_NRF_STATUS_FAIL;
+	struct wifi_nrf_fmac_buf_map_info *rx_buf_info = NULL;
+	struct host_rpu_rx_buf_info rx_cmd;
+	unsigned long nwb_data = 0;
+	unsigned long phy_addr = 0;
+
+	rx_buf_info = &fmac_dev_ctx->rx_buf_info[desc_id];
+
+	nwb_data = (unsigned long)wifi_nrf_osal_nbuf_data_get(fmac_dev_ctx->fpriv->opriv,
+							      (void *)rx_buf_info->nwb);
+
+	*(unsigned int *)(nwb_data) = desc_id;
+
+	phy_addr = wifi_nrf_hal_buf_map_rx(fmac_dev_ctx->hal_dev_ctx,
+					   nwb_data,
+					   buf_len,
+					   pool_info->pool_id,
+					   pool_info->buf_id);
+
+	if (!phy_addr) {
+		wifi_nrf_osal_log_err(fmac_dev_ctx->fpriv->opriv,
+				      "%s: wifi_nrf_hal_buf_map_rx failed\n",
+				      __func__);
+		goto out;
+	}
+
+	wifi_nrf_osal_mem_set(fmac_dev_ctx->fpriv->opriv,
+			      &rx_cmd,
+			      0x0,
+			      sizeof(rx_cmd));
+
+	rx_cmd.addr = (unsigned int)phy_addr;
+
+	status = wifi_nrf_hal_data_cmd_send(fmac_dev_ctx->hal_dev_ctx,
+					    WIFI_NRF_HAL_MSG_TYPE_CMD_DATA_RX,
+					    &rx_cmd,
+					    sizeof(rx_cmd),
+					    desc_id,
+					    pool_info->pool_id);
+
+	if (status != WIFI_NRF_STATUS_SUCCESS) {
+		/* Keep the buffer for the next refill attempt */
+		wifi_nrf_hal_buf_unmap_rx(fmac_dev_ctx->hal_dev_ctx,
+					  0,
+					  pool_info->pool_id,
+					  pool_info->buf_id);
+		goto out;
+	}
+
+	rx_buf_info->mapped = true;
+out:
+	return status;
+}
+
+
 enum wifi_nrf_status wifi_nrf_fmac_rx_cmd_send(struct wifi_nrf_fmac_dev_ctx *fmac_dev_ctx,
 					       enum wifi_nrf_fmac_rx_cmd_type cmd_type,
 					       unsigned int desc_id)
 {
 	enum wifi_nrf_status status = WIFI_NRF_STATUS_FAIL;
 	struct wifi_nrf_fmac_buf_map_info *rx_buf_info = NULL;
-	struct host_rpu_rx_buf_info rx_cmd;
 	struct wifi_nrf_fmac_rx_pool_map_info pool_info;
-	unsigned long nwb = 0;
 	unsigned long nwb_data = 0;
-	unsigned long phy_addr = 0;
 	unsigned int buf_len = 0;
 
 	status = wifi_nrf_fmac_map_desc_to_pool(fmac_dev_ctx,
@@ -75,62 +133,42 @@ enum wifi_nrf_status wifi_nrf_fmac_rx_cmd_send(struct wifi_nrf_fmac_dev_ctx *fma
 			goto out;
 		}
 
-		nwb = (unsigned long)wifi_nrf_osal_nbuf_alloc(fmac_dev_ctx->fpriv->opriv,
-							      buf_len);
-
-		if (!nwb) {
-			wifi_nrf_osal_log_err(fmac_dev_ctx->fpriv->opriv,
-					      "%s: No space for allocating RX buffer\n",
-					      __func__);
-			status = WIFI_NRF_STATUS_FAIL;
-			goto out;
-		}
-
-		nwb_data = (unsigned long)wifi_nrf_osal_nbuf_data_get(fmac_dev_ctx->fpriv->opriv,
-								      (void *)nwb);
-
-		*(unsigned int *)(nwb_data) = desc_id;
-
-		phy_addr = wifi_nrf_hal_buf_map_rx(fmac_dev_ctx->hal_dev_ctx,
-						   nwb_data,
-						   buf_len,
-						   pool_info.pool_id,
-						   pool_info.buf_id);
+		/* A buffer whose frame was not passed up is reused as is */
+		if (rx_buf_info->nwb) {
+			fmac_dev_ctx->host_stats.total_rx_buf_recycled++;
+		} else {
+			rx_buf_info->nwb =
+				(unsigned long)wifi_nrf_osal_nbuf_alloc(fmac_dev_ctx->fpriv->opriv,
+									buf_len);
+
+			if (!rx_buf_info->nwb) {
+				wifi_nrf_osal_log_dbg(fmac_dev_ctx->fpriv->opriv,
+						      "%s: No space for allocating RX buffer\n",
+						      __func__);
+				status = WIFI_NRF_STATUS_FAIL;
+				goto out;
+			}
 
-		if (!phy_addr) {
-			wifi_nrf_osal_log_err(fmac_dev_ctx->fpriv->opriv,
-					      "%s: wifi_nrf_hal_buf_map_rx failed\n",
-					      __func__);
-			status = WIFI_NRF_STATUS_FAIL;
-			goto out;
+			fmac_dev_ctx->host_stats.total_rx_buf_allocs++;
 		}
 
-		rx_buf_info->nwb = nwb;
-		rx_buf_info->mapped = true;
-
-		wifi_nrf_osal_mem_set(fmac_dev_ctx->fpriv->opriv,
-				      &rx_cmd,
-				      0x0,
-				      sizeof(rx_cmd));
-
-		rx_cmd.addr = (unsigned int)phy_addr;
-
-		status = wifi_nrf_hal_data_cmd_send(fmac_dev_ctx->hal_dev_ctx,
-						    WIFI_NRF_HAL_MSG_TYPE_CMD_DATA_RX,
-						    &rx_cmd,
-						    sizeof(rx_cmd),
-						    desc_id,
-						    pool_info.pool_id);
+		status = wifi_nrf_fmac_rx_buf_map(fmac_dev_ctx,
+						  desc_id,
+						  &pool_info,
+						  buf_len);
 	} else if (cmd_type == WIFI_NRF_FMAC_RX_CMD_TYPE_DEINIT) {
 		/* TODO: Need to initialize a command and send it to LMAC
 		 * when LMAC is capable of handling deinit command
 		 */
 		if (!rx_buf_info->mapped) {
-			wifi_nrf_osal_log_err(fmac_dev_ctx->fpriv->opriv,
-					      "%s: Deinit RX command called for unmapped RX buffer(%d)\n",
-					      __func__,
-					      desc_id);
-			status = WIFI_NRF_STATUS_FAIL;
+			/* Buffer still waiting to be refilled */
+			if (rx_buf_info->nwb) {
+				wifi_nrf_osal_nbuf_free(fmac_dev_ctx->fpriv->opriv,
+							(void *)rx_buf_info->nwb);
+				rx_buf_info->nwb = 0;
+			}
+
+			status = WIFI_NRF_STATUS_SUCCESS;
 			goto out;
 		}
 
@@ -163,6 +201,54 @@ out:
 }
 
 
+static void wifi_nrf_fmac_rx_refill_enqueue(struct wifi_nrf_fmac_dev_ctx *fmac_dev_ctx,
+					    unsigned int desc_id)
+{
+	unsigned int idx = 0;
+
+	/* Each descriptor is queued at most once, so the ring cannot overflow */
+	idx = (fmac_dev_ctx->rx_refill_head + fmac_dev_ctx->rx_refill_cnt) %
+		fmac_dev_ctx->fpriv->num_rx_bufs;
+
+	fmac_dev_ctx->rx_refill_q[idx] = desc_id;
+	fmac_dev_ctx->rx_refill_cnt++;
+}
+
+
+enum wifi_nrf_status wifi_nrf_fmac_rx_refill(struct wifi_nrf_fmac_dev_ctx *fmac_dev_ctx)
+{
+	enum wifi_nrf_status status = WIFI_NRF_STATUS_SUCCESS;
+	unsigned int desc_id = 0;
+
+	while (fmac_dev_ctx->rx_refill_cnt) {
+		desc_id = fmac_dev_ctx->rx_refill_q[fmac_dev_ctx->rx_refill_head];
+
+		status = wifi_nrf_fmac_rx_cmd_send(fmac_dev_ctx,
+						   WIFI_NRF_FMAC_RX_CMD_TYPE_INIT,
+						   desc_id);
+
+		if (status != WIFI_NRF_STATUS_SUCCESS) {
+			/* Retried on the next RX or TX done event, the RPU
+			 * keeps working with the buffers it still has.
+			 */
+			fmac_dev_ctx->host_stats.total_rx_buf_refill_deferred++;
+
+			wifi_nrf_osal_log_dbg(fmac_dev_ctx->fpriv->opriv,
+					      "%s: Deferring refill of %d RX buffers\n",
+					      __func__,
+					      fmac_dev_ctx->rx_refill_cnt);
+			break;
+		}
+
+		fmac_dev_ctx->rx_refill_head = (fmac_dev_ctx->rx_refill_head + 1) %
+			fmac_dev_ctx->fpriv->num_rx_bufs;
+		fmac_dev_ctx->rx_refill_cnt--;
+	}
+
+	return status;
+}
+
+
 enum wifi_nrf_status wifi_nrf_fmac_rx_event_process(struct wifi_nrf_fmac_dev_ctx *fmac_dev_ctx,
 						    struct img_rx_buff *config)
 {
@@ -179,6 +265,7 @@ enum wifi_nrf_status wifi_nrf_fmac_rx_event_process(struct wifi_nrf_fmac_dev_ctx
 	struct wifi_nrf_fmac_ieee80211_hdr hdr;
 	unsigned short eth_type = 0;
 	unsigned int size = 0;
+	bool recycle = false;
 
 	vif_ctx = fmac_dev_ctx->vif_ctx[config->wdev_id];
 
@@ -186,6 +273,11 @@ enum wifi_nrf_status wifi_nrf_fmac_rx_event_process(struct wifi_nrf_fmac_dev_ctx
 
 	fmac_dev_ctx->host_stats.total_rx_pkts += num_pkts;
 
+	/* Beacons and probe responses are dropped here, so their buffers are
+	 * handed back to the RPU without reading out the frame.
+	 */
+	recycle = (config->rx_pkt_type == IMG_RX_PKT_BCN_PRB_RSP);
+
 	for (i = 0; i < num_pkts; i++) {
 		desc_id = config->rx_buff_info[i].descriptor_id;
 		pkt_len = config->rx_buff_info[i].rx_pkt_len;
@@ -211,7 +303,7 @@ enum wifi_nrf_status wifi_nrf_fmac_rx_event_process(struct wifi_nrf_fmac_dev_ctx
 		}
 
 		nwb_data = (void *)wifi_nrf_hal_buf_unmap_rx(fmac_dev_ctx->hal_dev_ctx,
-							     pkt_len,
+							     recycle ? 0 : pkt_len,
 							     pool_info.pool_id,
 							     pool_info.buf_id);
 
@@ -219,11 +311,36 @@ enum wifi_nrf_status wifi_nrf_fmac_rx_event_process(struct wifi_nrf_fmac_dev_ctx
 			wifi_nrf_osal_log_err(fmac_dev_ctx->fpriv->opriv,
 					      "%s: wifi_nrf_hal_buf_unmap_rx failed\n",
 					      __func__);
+			status = WIFI_NRF_STATUS_FAIL;
 			goto out;
 		}
 
 		rx_buf_info = &fmac_dev_ctx->rx_buf_info[desc_id];
+		rx_buf_info->mapped = false;
+
+		/* Buffers are handed back to the RPU in one go after all the
+		 * frames in this event have been passed up.
+		 */
+		wifi_nrf_fmac_rx_refill_enqueue(fmac_dev_ctx,
+						desc_id);
+
+		if (recycle) {
+			continue;
+		}
+
 		nwb = (void *)rx_buf_info->nwb;
+		rx_buf_info->nwb = 0;
+
+		if (config->rx_pkt_type != IMG_RX_PKT_DATA) {
+			wifi_nrf_osal_log_err(fmac_dev_ctx->fpriv->opriv,
+					      "%s: Invalid frame type recd %d\n",
+					      __func__,
+					      config->rx_pkt_type);
+			wifi_nrf_osal_nbuf_free(fmac_dev_ctx->fpriv->opriv,
+						nwb);
+			status = WIFI_NRF_STATUS_FAIL;
+			goto out;
+		}
 
 		wifi_nrf_osal_nbuf_data_put(fmac_dev_ctx->fpriv->opriv,
 					    nwb,
@@ -234,80 +351,59 @@ enum wifi_nrf_status wifi_nrf_fmac_rx_event_process(struct wifi_nrf_fmac_dev_ctx
 		nwb_data = wifi_nrf_osal_nbuf_data_get(fmac_dev_ctx->fpriv->opriv,
 						       nwb);
 
-		rx_buf_info->nwb = 0;
-		rx_buf_info->mapped = false;
-
-		if (config->rx_pkt_type == IMG_RX_PKT_DATA) {
-			switch (config->rx_buff_info[i].pkt_type) {
-			case PKT_TYPE_MPDU:
-				wifi_nrf_osal_mem_cpy(fmac_dev_ctx->fpriv->opriv,
-						      &hdr,
-						      nwb_data,
-						      sizeof(struct wifi_nrf_fmac_ieee80211_hdr));
-
-				eth_type = wifi_nrf_util_rx_get_eth_type(fmac_dev_ctx,
-									 ((char *)nwb_data +
-									  config->mac_header_len));
-
-				size = config->mac_header_len +
-					wifi_nrf_util_get_skip_header_bytes(eth_type);
-
-				/* Remove hdr len and llc header/length */
-				wifi_nrf_osal_nbuf_data_pull(fmac_dev_ctx->fpriv->opriv,
-							     nwb,
-							     size);
-
-				wifi_nrf_util_convert_to_eth(fmac_dev_ctx,
-							     nwb,
-							     &hdr,
-							     eth_type);
-				break;
-			case PKT_TYPE_MSDU_WITH_MAC:
-				wifi_nrf_osal_nbuf_data_pull(fmac_dev_ctx->fpriv->opriv,
-							     nwb,
-							     config->mac_header_len);
-
-				wifi_nrf_util_rx_convert_amsdu_to_eth(fmac_dev_ctx,
-								      nwb);
-				break;
-			case PKT_TYPE_MSDU:
-				wifi_nrf_util_rx_convert_amsdu_to_eth(fmac_dev_ctx,
-								      nwb);
-				break;
-			default:
-				wifi_nrf_osal_log_err(fmac_dev_ctx->fpriv->opriv,
-						      "%s: Invalid pkt_type=%d\n",
-						      __func__,
-						      (config->rx_buff_info[i].pkt_type));
-				status = WIFI_NRF_STATUS_FAIL;
-				goto out;
-			}
-
-			fmac_dev_ctx->fpriv->callbk_fns.rx_frm_callbk_fn(vif_ctx->os_vif_ctx,
-									 nwb);
-		} else if (config->rx_pkt_type == IMG_RX_PKT_BCN_PRB_RSP) {
-			wifi_nrf_osal_nbuf_free(fmac_dev_ctx->fpriv->opriv,
-						nwb);
-		} else {
+		switch (config->rx_buff_info[i].pkt_type) {
+		case PKT_TYPE_MPDU:
+			wifi_nrf_osal_mem_cpy(fmac_dev_ctx->fpriv->opriv,
+					      &hdr,
+					      nwb_data,
+					      sizeof(struct wifi_nrf_fmac_ieee80211_hdr));
+
+			eth_type = wifi_nrf_util_rx_get_eth_type(fmac_dev_ctx,
+								 ((char *)nwb_data +
+								  config->mac_header_len));
+
+			size = config->mac_header_len +
+				wifi_nrf_util_get_skip_header_bytes(eth_type);
+
+			/* Remove hdr len and llc header/length */
+			wifi_nrf_osal_nbuf_data_pull(fmac_dev_ctx->fpriv->opriv,
+						     nwb,
+						     size);
+
+			wifi_nrf_util_convert_to_eth(fmac_dev_ctx,
+						     nwb,
+						     &hdr,
+						     eth_type);
+			break;
+		case PKT_TYPE_MSDU_WITH_MAC:
+			wifi_nrf_osal_nbuf_data_pull(fmac_dev_ctx->fpriv->opriv,
+						     nwb,
+						     config->mac_header_len);
+
+			wifi_nrf_util_rx_convert_amsdu_to_eth(fmac_dev_ctx,
+							      nwb);
+			break;
+		case PKT_TYPE_MSDU:
+			wifi_nrf_util_rx_convert_amsdu_to_eth(fmac_dev_ctx,
+							      nwb);
+			break;
+		default:
 			wifi_nrf_osal_log_err(fmac_dev_ctx->fpriv->opriv,
-					      "%s: Invalid frame type recd %d\n",
+					      "%s: Invalid pkt_type=%d\n",
 					      __func__,
-					      config->rx_pkt_type);
+					      (config->rx_buff_info[i].pkt_type));
+			wifi_nrf_osal_nbuf_free(fmac_dev_ctx->fpriv->opriv,
+						nwb);
 			status = WIFI_NRF_STATUS_FAIL;
 			goto out;
 		}
 
-		status = wifi_nrf_fmac_rx_cmd_send(fmac_dev_ctx,
-						   WIFI_NRF_FMAC_RX_CMD_TYPE_INIT,
-						   desc_id);
-
-		if (status != WIFI_NRF_STATUS_SUCCESS) {
-			wifi_nrf_osal_log_err(fmac_dev_ctx->fpriv->opriv,
-					      "%s: wifi_nrf_fmac_rx_cmd_send failed\n",
-					      __func__);
-			goto out;
-		}
+		fmac_dev_ctx->fpriv->callbk_fns.rx_frm_callbk_fn(vif_ctx->os_vif_ctx,
+								 nwb);
 	}
 out:
+	/* Allocation failures only defer the refill, they do not fail the event */
+	wifi_nrf_fmac_rx_refill(fmac_dev_ctx);
+
 	return status;
 }
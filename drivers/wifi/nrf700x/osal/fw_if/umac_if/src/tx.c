@@ -23,11 +23,9 @@ int pending_frames_count(struct wifi_nrf_fmac_dev_ctx *fmac_dev_ctx,
 {
 	int count = 0;
 	int ac = 0;
-	void *queue = NULL;
 
 	for (ac = WIFI_NRF_FMAC_AC_VO; ac >= 0; --ac) {
-		queue = fmac_dev_ctx->tx_config.data_pending_txq[peer_id][ac];
-		count += wifi_nrf_utils_q_len(fmac_dev_ctx->fpriv->opriv, queue);
+		count += wifi_nrf_utils_nbuf_q_len(&fmac_dev_ctx->tx_config.data_pending_txq[peer_id][ac]);
 	}
 
 	return count;
@@ -40,7 +38,7 @@ enum wifi_nrf_status update_pend_q_bmp(struct wifi_nrf_fmac_dev_ctx *fmac_dev_ct
 {
 	enum wifi_nrf_status status = WIFI_NRF_STATUS_FAIL;
 	struct wifi_nrf_fmac_vif_ctx *vif_ctx = NULL;
-	void *pend_pkt_q = NULL;
+	struct wifi_nrf_utils_nbuf_q *pend_pkt_q = NULL;
 	int len = 0;
 	unsigned char vif_id = 0;
 	unsigned char *bmp = NULL;
@@ -49,15 +47,23 @@ enum wifi_nrf_status update_pend_q_bmp(struct wifi_nrf_fmac_dev_ctx *fmac_dev_ct
 		goto out;
 	}
 
+	pend_pkt_q = &fmac_dev_ctx->tx_config.data_pending_txq[peer_id][ac];
+
+	len = wifi_nrf_utils_nbuf_q_len(pend_pkt_q);
+
+	/* Keep track of the peers with pending frames for the TX scheduler */
+	if (len == 0) {
+		fmac_dev_ctx->tx_config.pend_peer_bmp[ac] &= ~(1 << peer_id);
+	} else {
+		fmac_dev_ctx->tx_config.pend_peer_bmp[ac] |= (1 << peer_id);
+	}
+
 	vif_id = fmac_dev_ctx->tx_config.peers[peer_id].if_idx;
 	vif_ctx = fmac_dev_ctx->vif_ctx[vif_id];
 
 	if (vif_ctx->if_type == IMG_IFTYPE_AP &&
 	    peer_id < MAX_PEERS) {
 		bmp = &fmac_dev_ctx->tx_config.peers[peer_id].pend_q_bmp;
-		pend_pkt_q = fmac_dev_ctx->tx_config.data_pending_txq[peer_id][ac];
-
-		len = wifi_nrf_utils_q_len(fmac_dev_ctx->fpriv->opriv, pend_pkt_q);
 
 		if (len == 0) {
 			*bmp = *bmp & ~(1 << ac);
@@ -211,22 +217,20 @@ int tx_aggr_check(struct wifi_nrf_fmac_dev_ctx *fmac_dev_ctx,
 		  int peer)
 {
 	void *nwb = NULL;
-	void *pending_pkt_queue = NULL;
+	struct wifi_nrf_utils_nbuf_q *pending_pkt_queue = NULL;
 	bool aggr = true;
 
 	if (fmac_dev_ctx->tx_config.peers[peer].is_legacy) {
 		return false;
 	}
 
-	pending_pkt_queue = fmac_dev_ctx->tx_config.data_pending_txq[peer][ac];
+	pending_pkt_queue = &fmac_dev_ctx->tx_config.data_pending_txq[peer][ac];
 
-	if (wifi_nrf_utils_q_len(fmac_dev_ctx->fpriv->opriv,
-				 pending_pkt_queue) == 0) {
+	if (wifi_nrf_utils_nbuf_q_len(pending_pkt_queue) == 0) {
 		return false;
 	}
 
-	nwb = wifi_nrf_utils_q_peek(fmac_dev_ctx->fpriv->opriv,
-				    pending_pkt_queue);
+	nwb = wifi_nrf_utils_nbuf_q_peek(pending_pkt_queue);
 
 	if (nwb) {
 		if (!wifi_nrf_util_ether_addr_equal(wifi_nrf_util_get_dest(fmac_dev_ctx,
@@ -254,7 +258,6 @@ int get_peer_from_wakeup_q(struct wifi_nrf_fmac_dev_ctx *fmac_dev_ctx,
 {
 	int peer_id = -1;
 	struct peers_info *peer = NULL;
-	void *pend_q = NULL;
 	unsigned int pend_q_len;
 	void *client_q = NULL;
 	void *list_node = NULL;
@@ -270,8 +273,8 @@ int get_peer_from_wakeup_q(struct wifi_nrf_fmac_dev_ctx *fmac_dev_ctx,
 
 		if (peer != NULL && peer->ps_token_count) {
 
-			pend_q = fmac_dev_ctx->tx_config.data_pending_txq[peer->peer_id][ac];
-			pend_q_len = wifi_nrf_utils_q_len(fmac_dev_ctx->fpriv->opriv, pend_q);
+			pend_q_len =
+				wifi_nrf_utils_nbuf_q_len(&fmac_dev_ctx->tx_config.data_pending_txq[peer->peer_id][ac]);
 
 			if (pend_q_len) {
 				peer->ps_token_count--;
@@ -295,8 +298,7 @@ int tx_curr_peer_opp_get(struct wifi_nrf_fmac_dev_ctx *fmac_dev_ctx,
 	unsigned int i = 0;
 	unsigned int curr_peer_opp = 0;
 	unsigned int init_peer_opp = 0;
-	unsigned int pend_q_len;
-	void *pend_q = NULL;
+	unsigned int pend_peer_bmp = 0;
 	int peer_id = -1;
 	unsigned char ps_state = 0;
 
@@ -310,26 +312,31 @@ int tx_curr_peer_opp_get(struct wifi_nrf_fmac_dev_ctx *fmac_dev_ctx,
 		return peer_id;
 	}
 
+	pend_peer_bmp = fmac_dev_ctx->tx_config.pend_peer_bmp[ac];
+
+	/* No peer has pending frames in this AC */
+	if (!pend_peer_bmp) {
+		return -1;
+	}
+
 	init_peer_opp = fmac_dev_ctx->tx_config.curr_peer_opp[ac];
 
 	for (i = 0; i < MAX_PEERS; i++) {
 		curr_peer_opp = (init_peer_opp + i) % MAX_PEERS;
 
+		if (!(pend_peer_bmp & (1 << curr_peer_opp))) {
+			continue;
+		}
+
 		ps_state = fmac_dev_ctx->tx_config.peers[curr_peer_opp].ps_state;
 
 		if (ps_state == IMG_CLIENT_PS_MODE) {
 			continue;
 		}
 
-		pend_q = fmac_dev_ctx->tx_config.data_pending_txq[curr_peer_opp][ac];
-		pend_q_len = wifi_nrf_utils_q_len(fmac_dev_ctx->fpriv->opriv,
-						  pend_q);
-
-		if (pend_q_len) {
-			fmac_dev_ctx->tx_config.curr_peer_opp[ac] =
-				(curr_peer_opp + 1) % MAX_PEERS;
-			break;
-		}
+		fmac_dev_ctx->tx_config.curr_peer_opp[ac] =
+			(curr_peer_opp + 1) % MAX_PEERS;
+		break;
 	}
 
 	if (i != MAX_PEERS) {
@@ -344,8 +351,8 @@ int _tx_pending_process(struct wifi_nrf_fmac_dev_ctx *fmac_dev_ctx,
 			unsigned int ac)
 {
 	int len = 0;
-	void *pend_pkt_q = NULL;
-	void *txq = NULL;
+	struct wifi_nrf_utils_nbuf_q *pend_pkt_q = NULL;
+	struct wifi_nrf_utils_nbuf_q *txq = NULL;
 	struct tx_pkt_info *pkt_info = NULL;
 	int peer_id = -1;
 	void *nwb = NULL;
@@ -359,61 +366,50 @@ int _tx_pending_process(struct wifi_nrf_fmac_dev_ctx *fmac_dev_ctx,
 		return 0;
 	}
 
-	pend_pkt_q = fmac_dev_ctx->tx_config.data_pending_txq[peer_id][ac];
+	pend_pkt_q = &fmac_dev_ctx->tx_config.data_pending_txq[peer_id][ac];
 
-	if (wifi_nrf_utils_q_len(fmac_dev_ctx->fpriv->opriv,
-				 pend_pkt_q) == 0) {
+	if (wifi_nrf_utils_nbuf_q_len(pend_pkt_q) == 0) {
 		return 0;
 	}
 
 	pkt_info = &fmac_dev_ctx->tx_config.pkt_info_p[desc];
-	txq = pkt_info->pkt;
+	txq = &pkt_info->pkt;
 
 	/* Aggregate Only MPDU's with same RA, same Rate,
 	 * same Rate flags, same Tx Info flags
 	 */
-	if (wifi_nrf_utils_q_len(fmac_dev_ctx->fpriv->opriv,
-				 pend_pkt_q)) {
-		first_nwb = wifi_nrf_utils_q_peek(fmac_dev_ctx->fpriv->opriv,
-						  pend_pkt_q);
-	}
-
-	while (wifi_nrf_utils_q_len(fmac_dev_ctx->fpriv->opriv,
-				    pend_pkt_q)) {
-		nwb = wifi_nrf_utils_q_peek(fmac_dev_ctx->fpriv->opriv,
-					    pend_pkt_q);
+	first_nwb = wifi_nrf_utils_nbuf_q_peek(pend_pkt_q);
 
+	while (wifi_nrf_utils_nbuf_q_len(pend_pkt_q)) {
 		if ((!tx_aggr_check(fmac_dev_ctx,
 				    first_nwb,
 				    ac,
 				    peer_id) ||
-		     (wifi_nrf_utils_q_len(fmac_dev_ctx->fpriv->opriv,
-					   txq)) >= max_txq_len)) {
+		     (wifi_nrf_utils_nbuf_q_len(txq)) >= max_txq_len)) {
 			break;
 		}
 
-		nwb = wifi_nrf_utils_q_dequeue(fmac_dev_ctx->fpriv->opriv,
-					       pend_pkt_q);
+		nwb = wifi_nrf_utils_nbuf_q_dequeue(fmac_dev_ctx->fpriv->opriv,
+						    pend_pkt_q);
 
-		wifi_nrf_utils_list_add_tail(fmac_dev_ctx->fpriv->opriv,
-					     txq,
-					     nwb);
+		wifi_nrf_utils_nbuf_q_enqueue(fmac_dev_ctx->fpriv->opriv,
+					      txq,
+					      nwb);
 	}
 
 	/* If our criterion rejects all pending frames, or
 	 * pend_q is empty, send only 1
 	 */
-	if (!wifi_nrf_utils_q_len(fmac_dev_ctx->fpriv->opriv,
-				  txq)) {
-		nwb = wifi_nrf_utils_q_dequeue(fmac_dev_ctx->fpriv->opriv,
-					       pend_pkt_q);
+	if (!wifi_nrf_utils_nbuf_q_len(txq)) {
+		nwb = wifi_nrf_utils_nbuf_q_dequeue(fmac_dev_ctx->fpriv->opriv,
+						    pend_pkt_q);
 
-		wifi_nrf_utils_list_add_tail(fmac_dev_ctx->fpriv->opriv,
-					     txq,
-					     nwb);
+		wifi_nrf_utils_nbuf_q_enqueue(fmac_dev_ctx->fpriv->opriv,
+					      txq,
+					      nwb);
 	}
 
-	len = wifi_nrf_utils_q_len(fmac_dev_ctx->fpriv->opriv, txq);
+	len = wifi_nrf_utils_nbuf_q_len(txq);
 
 	if (len > 0) {
 		fmac_dev_ctx->tx_config.pkt_info_p[desc].peer_id = peer_id;
@@ -498,12 +494,13 @@ out:
 int tx_cmd_prepare(struct wifi_nrf_fmac_dev_ctx *fmac_dev_ctx,
 		   struct host_rpu_msg *umac_cmd,
 		   int desc,
-		   void *txq,
+		   struct wifi_nrf_utils_nbuf_q *txq,
 		   int peer_id)
 {
 	struct img_tx_buff *config = NULL;
 	int len = 0;
 	void *nwb = NULL;
+	void *frm = NULL;
 	void *nwb_data = NULL;
 	unsigned int txq_len = 0;
 	unsigned int max_txq_len = 0;
@@ -513,8 +510,7 @@ int tx_cmd_prepare(struct wifi_nrf_fmac_dev_ctx *fmac_dev_ctx,
 	unsigned char vif_id = fmac_dev_ctx->tx_config.peers[peer_id].if_idx;
 	struct wifi_nrf_fmac_vif_ctx *vif_ctx = fmac_dev_ctx->vif_ctx[vif_id];
 
-	txq_len = wifi_nrf_utils_list_len(fmac_dev_ctx->fpriv->opriv,
-					  txq);
+	txq_len = wifi_nrf_utils_nbuf_q_len(txq);
 
 	max_txq_len = fmac_dev_ctx->fpriv->data_config.max_tx_aggregation;
 
@@ -526,8 +522,7 @@ int tx_cmd_prepare(struct wifi_nrf_fmac_dev_ctx *fmac_dev_ctx,
 		return -1;
 	}
 
-	nwb = wifi_nrf_utils_list_peek(fmac_dev_ctx->fpriv->opriv,
-				       txq);
+	nwb = wifi_nrf_utils_nbuf_q_peek(txq);
 
 	fmac_dev_ctx->tx_config.send_pkt_coalesce_count_p[desc] = txq_len;
 
@@ -573,10 +568,19 @@ int tx_cmd_prepare(struct wifi_nrf_fmac_dev_ctx *fmac_dev_ctx,
 	info.fmac_dev_ctx = fmac_dev_ctx;
 	info.config = config;
 
-	status = wifi_nrf_utils_list_traverse(fmac_dev_ctx->fpriv->opriv,
-					      txq,
-					      &info,
-					      tx_cmd_prep_callbk_fn);
+	frm = nwb;
+
+	while (frm) {
+		status = tx_cmd_prep_callbk_fn(&info,
+					       frm);
+
+		if (status != WIFI_NRF_STATUS_SUCCESS) {
+			break;
+		}
+
+		frm = wifi_nrf_utils_nbuf_q_next(fmac_dev_ctx->fpriv->opriv,
+						 frm);
+	}
 
 	if (status != WIFI_NRF_STATUS_SUCCESS) {
 		wifi_nrf_osal_log_err(fmac_dev_ctx->fpriv->opriv,
@@ -613,16 +617,17 @@ int tx_cmd_prepare(struct wifi_nrf_fmac_dev_ctx *fmac_dev_ctx,
 
 
 enum wifi_nrf_status tx_cmd_init(struct wifi_nrf_fmac_dev_ctx *fmac_dev_ctx,
-				 void *txq,
+				 struct wifi_nrf_utils_nbuf_q *txq,
 				 int desc,
-				 int peer_id)
+				 int peer_id,
+				 unsigned int ac)
 {
 	enum wifi_nrf_status status = WIFI_NRF_STATUS_FAIL;
 	struct host_rpu_msg *umac_cmd = NULL;
 	unsigned int len = 0;
 
 	len += sizeof(struct img_tx_buff_info);
-	len *= wifi_nrf_utils_list_len(fmac_dev_ctx->fpriv->opriv, txq);
+	len *= wifi_nrf_utils_nbuf_q_len(txq);
 
 	len += sizeof(struct img_tx_buff);
 
@@ -651,6 +656,12 @@ enum wifi_nrf_status tx_cmd_init(struct wifi_nrf_fmac_dev_ctx *fmac_dev_ctx,
 					    desc,
 					    0);
 
+	if (status == WIFI_NRF_STATUS_SUCCESS) {
+		fmac_dev_ctx->host_stats.total_tx_cmds[ac]++;
+		fmac_dev_ctx->host_stats.total_tx_cmd_pkts[ac] +=
+			fmac_dev_ctx->tx_config.send_pkt_coalesce_count_p[desc];
+	}
+
 	wifi_nrf_osal_mem_free(fmac_dev_ctx->fpriv->opriv,
 			       umac_cmd);
 out:
@@ -673,9 +684,10 @@ enum wifi_nrf_status tx_pending_process(struct wifi_nrf_fmac_dev_ctx *fmac_dev_c
 
 	if (_tx_pending_process(fmac_dev_ctx, desc, ac) > 0) {
 		status = tx_cmd_init(fmac_dev_ctx,
-				     fmac_dev_ctx->tx_config.pkt_info_p[desc].pkt,
+				     &fmac_dev_ctx->tx_config.pkt_info_p[desc].pkt,
 				     desc,
-				     fmac_dev_ctx->tx_config.pkt_info_p[desc].peer_id);
+				     fmac_dev_ctx->tx_config.pkt_info_p[desc].peer_id,
+				     ac);
 	} else {
 		tx_desc_free(fmac_dev_ctx,
 			     desc,
@@ -695,7 +707,7 @@ enum wifi_nrf_status tx_enqueue(struct wifi_nrf_fmac_dev_ctx *fmac_dev_ctx,
 				unsigned int peer_id)
 {
 	enum wifi_nrf_status status = WIFI_NRF_STATUS_FAIL;
-	void *queue = NULL;
+	struct wifi_nrf_utils_nbuf_q *queue = NULL;
 	int qlen = 0;
 
 	if (!fmac_dev_ctx || !nwb) {
@@ -705,9 +717,9 @@ enum wifi_nrf_status tx_enqueue(struct wifi_nrf_fmac_dev_ctx *fmac_dev_ctx,
 		goto out;
 	}
 
-	queue = fmac_dev_ctx->tx_config.data_pending_txq[peer_id][ac];
+	queue = &fmac_dev_ctx->tx_config.data_pending_txq[peer_id][ac];
 
-	qlen = wifi_nrf_utils_q_len(fmac_dev_ctx->fpriv->opriv, queue);
+	qlen = wifi_nrf_utils_nbuf_q_len(queue);
 
 	if (qlen >= CONFIG_NRF700x_MAX_TX_PENDING_QLEN) {
 		wifi_nrf_osal_nbuf_free(fmac_dev_ctx->fpriv->opriv,
@@ -715,9 +727,9 @@ enum wifi_nrf_status tx_enqueue(struct wifi_nrf_fmac_dev_ctx *fmac_dev_ctx,
 		goto out;
 	}
 
-	wifi_nrf_utils_q_enqueue(fmac_dev_ctx->fpriv->opriv,
-				 queue,
-				 nwb);
+	wifi_nrf_utils_nbuf_q_enqueue(fmac_dev_ctx->fpriv->opriv,
+				      queue,
+				      nwb);
 
 	status = update_pend_q_bmp(fmac_dev_ctx, ac, peer_id);
 
@@ -735,7 +747,7 @@ enum wifi_nrf_status tx_process(struct wifi_nrf_fmac_dev_ctx *fmac_dev_ctx,
 {
 	enum wifi_nrf_status status = WIFI_NRF_STATUS_FAIL;
 	struct wifi_nrf_fmac_priv *fpriv = NULL;
-	void *pend_pkt_q = NULL;
+	struct wifi_nrf_utils_nbuf_q *pend_pkt_q = NULL;
 	void *first_nwb = NULL;
 	unsigned char ps_state = 0;
 	bool aggr_status = false;
@@ -762,7 +774,7 @@ enum wifi_nrf_status tx_process(struct wifi_nrf_fmac_dev_ctx *fmac_dev_ctx,
 		goto out;
 	}
 
-	pend_pkt_q = fmac_dev_ctx->tx_config.data_pending_txq[peer_id][ac];
+	pend_pkt_q = &fmac_dev_ctx->tx_config.data_pending_txq[peer_id][ac];
 
 	/* If outstanding_descs for a particular
 	 * access category >= NUM_TX_DESCS_PER_AC means there are already
@@ -772,10 +784,8 @@ enum wifi_nrf_status tx_process(struct wifi_nrf_fmac_dev_ctx *fmac_dev_ctx,
 	 */
 
 	if ((fmac_dev_ctx->tx_config.outstanding_descs[ac]) >= fpriv->num_tx_tokens_per_ac) {
-		if (wifi_nrf_utils_q_len(fmac_dev_ctx->fpriv->opriv,
-					 pend_pkt_q)) {
-			first_nwb = wifi_nrf_utils_q_peek(fmac_dev_ctx->fpriv->opriv,
-							  pend_pkt_q);
+		if (wifi_nrf_utils_nbuf_q_len(pend_pkt_q)) {
+			first_nwb = wifi_nrf_utils_nbuf_q_peek(pend_pkt_q);
 
 			aggr_status = true;
 
@@ -797,8 +807,7 @@ enum wifi_nrf_status tx_process(struct wifi_nrf_fmac_dev_ctx *fmac_dev_ctx,
 		if (aggr_status) {
 			max_cmds = fmac_dev_ctx->fpriv->data_config.max_tx_aggregation;
 
-			if (wifi_nrf_utils_q_len(fmac_dev_ctx->fpriv->opriv,
-						 pend_pkt_q) < max_cmds) {
+			if (wifi_nrf_utils_nbuf_q_len(pend_pkt_q) < max_cmds) {
 				goto out;
 			}
 
@@ -899,7 +908,7 @@ enum wifi_nrf_status tx_done_process(struct wifi_nrf_fmac_dev_ctx *fmac_dev_ctx,
 	enum wifi_nrf_status status = WIFI_NRF_STATUS_FAIL;
 	struct wifi_nrf_fmac_priv *fpriv = NULL;
 	void *nwb = NULL;
-	void *nwb_list = NULL;
+	struct wifi_nrf_utils_nbuf_q *nwb_list = NULL;
 	unsigned int desc = 0;
 	unsigned int frame = 0;
 	unsigned int desc_id = 0;
@@ -909,7 +918,7 @@ enum wifi_nrf_status tx_done_process(struct wifi_nrf_fmac_dev_ctx *fmac_dev_ctx,
 	unsigned int pkt = 0;
 	unsigned int pkts_pending = 0;
 	unsigned char queue = 0;
-	void *txq = NULL;
+	struct wifi_nrf_utils_nbuf_q *txq = NULL;
 
 	fpriv = fmac_dev_ctx->fpriv;
 
@@ -922,7 +931,7 @@ enum wifi_nrf_status tx_done_process(struct wifi_nrf_fmac_dev_ctx *fmac_dev_ctx,
 	}
 
 	pkt_info = &fmac_dev_ctx->tx_config.pkt_info_p[desc];
-	nwb_list = pkt_info->pkt;
+	nwb_list = &pkt_info->pkt;
 
 	for (frame = 0;
 	     frame < fmac_dev_ctx->tx_config.send_pkt_coalesce_count_p[desc];
@@ -960,10 +969,9 @@ enum wifi_nrf_status tx_done_process(struct wifi_nrf_fmac_dev_ctx *fmac_dev_ctx,
 
 	pkt = 0;
 
-	while (wifi_nrf_utils_q_len(fpriv->opriv,
-				    nwb_list)) {
-		nwb = wifi_nrf_utils_q_dequeue(fpriv->opriv,
-					       nwb_list);
+	while (wifi_nrf_utils_nbuf_q_len(nwb_list)) {
+		nwb = wifi_nrf_utils_nbuf_q_dequeue(fpriv->opriv,
+						    nwb_list);
 
 		if (!nwb) {
 			continue;
@@ -982,12 +990,13 @@ enum wifi_nrf_status tx_done_process(struct wifi_nrf_fmac_dev_ctx *fmac_dev_ctx,
 	if (pkts_pending) {
 		pkt_info = &fmac_dev_ctx->tx_config.pkt_info_p[desc];
 
-		txq = pkt_info->pkt;
+		txq = &pkt_info->pkt;
 
 		status = tx_cmd_init(fmac_dev_ctx,
 				     txq,
 				     desc,
-				     pkt_info->peer_id);
+				     pkt_info->peer_id,
+				     queue);
 	} else {
 		status = WIFI_NRF_STATUS_SUCCESS;
 	}
@@ -1033,6 +1042,139 @@ out:
 }
 
 
+static void tx_coalesce_flush(struct wifi_nrf_fmac_dev_ctx *fmac_dev_ctx,
+			      unsigned int ac)
+{
+	struct wifi_nrf_fmac_priv *fpriv = NULL;
+	struct tx_pkt_info *pkt_info = NULL;
+	unsigned int desc = 0;
+
+	fpriv = fmac_dev_ctx->fpriv;
+
+	/* The window can span more than one peer, keep handing out
+	 * descriptors till the pending frames of the AC are drained.
+	 */
+	while (fmac_dev_ctx->tx_config.pend_peer_bmp[ac]) {
+		desc = tx_desc_get(fmac_dev_ctx, ac);
+
+		if (desc == fpriv->num_tx_tokens) {
+			break;
+		}
+
+		if (_tx_pending_process(fmac_dev_ctx, desc, ac) <= 0) {
+			/* Only peers in power save are left */
+			tx_desc_free(fmac_dev_ctx,
+				     desc,
+				     ac);
+			break;
+		}
+
+		pkt_info = &fmac_dev_ctx->tx_config.pkt_info_p[desc];
+
+		if (tx_cmd_init(fmac_dev_ctx,
+				&pkt_info->pkt,
+				desc,
+				pkt_info->peer_id,
+				ac) != WIFI_NRF_STATUS_SUCCESS) {
+			break;
+		}
+	}
+}
+
+
+static void tx_coalesce_timeout(unsigned long data)
+{
+	struct tx_coalesce_info *coalesce = NULL;
+	struct wifi_nrf_fmac_dev_ctx *fmac_dev_ctx = NULL;
+	unsigned long elapsed_us = 0;
+
+	coalesce = (struct tx_coalesce_info *)data;
+	fmac_dev_ctx = coalesce->fmac_dev_ctx;
+
+	wifi_nrf_osal_spinlock_take(fmac_dev_ctx->fpriv->opriv,
+				    fmac_dev_ctx->tx_config.tx_lock);
+
+	/* The window might have been closed by a frame while we were waiting
+	 * for the lock.
+	 */
+	if (!coalesce->armed) {
+		goto out;
+	}
+
+	elapsed_us = wifi_nrf_osal_time_elapsed_us(fmac_dev_ctx->fpriv->opriv,
+						   coalesce->start_us);
+
+	/* Killing the timer does not stop a run that is already waiting for
+	 * the lock, which then finds the next window open. That window keeps
+	 * its frames until its own budget expires.
+	 */
+	if (elapsed_us < coalesce->max_us) {
+		fmac_dev_ctx->host_stats.total_tx_coalesce_stale_timeouts[coalesce->ac]++;
+
+		wifi_nrf_osal_timer_schedule(fmac_dev_ctx->fpriv->opriv,
+					     coalesce->timer,
+					     (coalesce->max_us - elapsed_us + 999) / 1000);
+		goto out;
+	}
+
+	coalesce->armed = false;
+	fmac_dev_ctx->host_stats.total_tx_coalesce_timeouts[coalesce->ac]++;
+
+	tx_coalesce_flush(fmac_dev_ctx, coalesce->ac);
+out:
+
+	wifi_nrf_osal_spinlock_rel(fmac_dev_ctx->fpriv->opriv,
+				   fmac_dev_ctx->tx_config.tx_lock);
+}
+
+
+static bool tx_coalesce_hold(struct wifi_nrf_fmac_dev_ctx *fmac_dev_ctx,
+			     unsigned int ac,
+			     unsigned int len)
+{
+	struct wifi_nrf_osal_priv *opriv = NULL;
+	struct tx_coalesce_info *coalesce = NULL;
+
+	opriv = fmac_dev_ctx->fpriv->opriv;
+	coalesce = &fmac_dev_ctx->tx_config.coalesce[ac];
+
+	if (!coalesce->max_us) {
+		return false;
+	}
+
+	if (!coalesce->armed) {
+		coalesce->armed = true;
+		coalesce->start_us = wifi_nrf_osal_time_get_curr_us(opriv);
+		coalesce->frames = 0;
+		coalesce->bytes = 0;
+
+		/* Timer granularity is milliseconds, round up so that the
+		 * timer never fires before the budget is used up.
+		 */
+		wifi_nrf_osal_timer_schedule(opriv,
+					     coalesce->timer,
+					     (coalesce->max_us + 999) / 1000);
+	}
+
+	coalesce->frames++;
+	coalesce->bytes += len;
+
+	if ((coalesce->frames < coalesce->max_frames) &&
+	    (coalesce->bytes < coalesce->max_bytes) &&
+	    (wifi_nrf_osal_time_elapsed_us(opriv,
+					   coalesce->start_us) < coalesce->max_us)) {
+		return true;
+	}
+
+	coalesce->armed = false;
+
+	wifi_nrf_osal_timer_kill(opriv,
+				 coalesce->timer);
+
+	return false;
+}
+
+
 enum wifi_nrf_status wifi_nrf_fmac_tx(struct wifi_nrf_fmac_dev_ctx *fmac_dev_ctx,
 				      int if_id,
 				      void *nbuf,
@@ -1041,6 +1183,7 @@ enum wifi_nrf_status wifi_nrf_fmac_tx(struct wifi_nrf_fmac_dev_ctx *fmac_dev_ctx
 {
 	enum wifi_nrf_status status = WIFI_NRF_STATUS_FAIL;
 	unsigned int desc = 0;
+	unsigned int len = 0;
 	struct wifi_nrf_fmac_priv *fpriv = NULL;
 
 	fpriv = fmac_dev_ctx->fpriv;
@@ -1052,6 +1195,9 @@ enum wifi_nrf_status wifi_nrf_fmac_tx(struct wifi_nrf_fmac_dev_ctx *fmac_dev_ctx
 		goto out;
 	}
 
+	len = wifi_nrf_osal_nbuf_data_size(fmac_dev_ctx->fpriv->opriv,
+					   nbuf);
+
 	status = tx_process(fmac_dev_ctx,
 			    if_id,
 			    nbuf,
@@ -1062,6 +1208,14 @@ enum wifi_nrf_status wifi_nrf_fmac_tx(struct wifi_nrf_fmac_dev_ctx *fmac_dev_ctx
 		goto out;
 	}
 
+	if (fmac_dev_ctx->tx_config.coalesce[ac].max_us) {
+		if (!tx_coalesce_hold(fmac_dev_ctx, ac, len)) {
+			tx_coalesce_flush(fmac_dev_ctx, ac);
+		}
+
+		goto out;
+	}
+
 	desc = tx_desc_get(fmac_dev_ctx, ac);
 
 	if (desc == fpriv->num_tx_tokens) {
@@ -1085,12 +1239,97 @@ out:
 }
 
 
+static void tx_coalesce_deinit(struct wifi_nrf_fmac_dev_ctx *fmac_dev_ctx)
+{
+	struct tx_coalesce_info *coalesce = NULL;
+	unsigned int ac = 0;
+
+	for (ac = 0; ac < WIFI_NRF_FMAC_AC_MAX; ac++) {
+		coalesce = &fmac_dev_ctx->tx_config.coalesce[ac];
+
+		if (!coalesce->timer) {
+			continue;
+		}
+
+		wifi_nrf_osal_timer_kill(fmac_dev_ctx->fpriv->opriv,
+					 coalesce->timer);
+
+		wifi_nrf_osal_timer_free(fmac_dev_ctx->fpriv->opriv,
+					 coalesce->timer);
+
+		coalesce->timer = NULL;
+	}
+}
+
+
+static enum wifi_nrf_status tx_coalesce_init(struct wifi_nrf_fmac_dev_ctx *fmac_dev_ctx)
+{
+	struct tx_coalesce_info *coalesce = NULL;
+	unsigned int ac = 0;
+#ifdef CONFIG_NRF700X_TX_COALESCE
+	unsigned int max_us[WIFI_NRF_FMAC_AC_MAX] = {
+		[WIFI_NRF_FMAC_AC_BK] = CONFIG_NRF700X_TX_COALESCE_BK_US,
+		[WIFI_NRF_FMAC_AC_BE] = CONFIG_NRF700X_TX_COALESCE_BE_US,
+		[WIFI_NRF_FMAC_AC_VI] = CONFIG_NRF700X_TX_COALESCE_VI_US,
+		[WIFI_NRF_FMAC_AC_VO] = CONFIG_NRF700X_TX_COALESCE_VO_US,
+	};
+	unsigned int max_frames[WIFI_NRF_FMAC_AC_MAX] = {
+		[WIFI_NRF_FMAC_AC_BK] = CONFIG_NRF700X_TX_COALESCE_BK_MAX_FRAMES,
+		[WIFI_NRF_FMAC_AC_BE] = CONFIG_NRF700X_TX_COALESCE_BE_MAX_FRAMES,
+		[WIFI_NRF_FMAC_AC_VI] = CONFIG_NRF700X_TX_COALESCE_VI_MAX_FRAMES,
+		[WIFI_NRF_FMAC_AC_VO] = CONFIG_NRF700X_TX_COALESCE_VO_MAX_FRAMES,
+	};
+	unsigned int max_bytes[WIFI_NRF_FMAC_AC_MAX] = {
+		[WIFI_NRF_FMAC_AC_BK] = CONFIG_NRF700X_TX_COALESCE_BK_MAX_BYTES,
+		[WIFI_NRF_FMAC_AC_BE] = CONFIG_NRF700X_TX_COALESCE_BE_MAX_BYTES,
+		[WIFI_NRF_FMAC_AC_VI] = CONFIG_NRF700X_TX_COALESCE_VI_MAX_BYTES,
+		[WIFI_NRF_FMAC_AC_VO] = CONFIG_NRF700X_TX_COALESCE_VO_MAX_BYTES,
+	};
+#endif /* CONFIG_NRF700X_TX_COALESCE */
+
+	for (ac = 0; ac < WIFI_NRF_FMAC_AC_MAX; ac++) {
+		coalesce = &fmac_dev_ctx->tx_config.coalesce[ac];
+
+		coalesce->fmac_dev_ctx = fmac_dev_ctx;
+		coalesce->ac = ac;
+		coalesce->armed = false;
+#ifdef CONFIG_NRF700X_TX_COALESCE
+		/* A window can never hold more than a single TX command */
+		coalesce->max_frames = max_frames[ac];
+
+		if (coalesce->max_frames > fmac_dev_ctx->fpriv->data_config.max_tx_aggregation) {
+			coalesce->max_frames = fmac_dev_ctx->fpriv->data_config.max_tx_aggregation;
+		}
+
+		coalesce->max_bytes = max_bytes[ac];
+		coalesce->max_us = max_us[ac];
+#endif /* CONFIG_NRF700X_TX_COALESCE */
+
+		if (!coalesce->max_us) {
+			continue;
+		}
+
+		coalesce->timer = wifi_nrf_osal_timer_alloc(fmac_dev_ctx->fpriv->opriv);
+
+		if (!coalesce->timer) {
+			tx_coalesce_deinit(fmac_dev_ctx);
+			return WIFI_NRF_STATUS_FAIL;
+		}
+
+		wifi_nrf_osal_timer_init(fmac_dev_ctx->fpriv->opriv,
+					 coalesce->timer,
+					 tx_coalesce_timeout,
+					 (unsigned long)coalesce);
+	}
+
+	return WIFI_NRF_STATUS_SUCCESS;
+}
+
+
 enum wifi_nrf_status tx_init(struct wifi_nrf_fmac_dev_ctx *fmac_dev_ctx)
 {
 	enum wifi_nrf_status status = WIFI_NRF_STATUS_FAIL;
 	struct wifi_nrf_fmac_priv *fpriv = NULL;
-	void *mem_ptr = NULL;
-	void *q_ptr = NULL;
 	unsigned int i = 0;
 	unsigned int j = 0;
 
@@ -1114,23 +1353,10 @@ enum wifi_nrf_status tx_init(struct wifi_nrf_fmac_dev_ctx *fmac_dev_ctx)
 
 	for (i = 0; i < WIFI_NRF_FMAC_AC_MAX; i++) {
 		for (j = 0; j < MAX_SW_PEERS; j++) {
-			fmac_dev_ctx->tx_config.data_pending_txq[j][i] =
-				wifi_nrf_utils_q_alloc(fpriv->opriv);
-
-			if (!fmac_dev_ctx->tx_config.data_pending_txq[j][i]) {
-				wifi_nrf_osal_log_err(fmac_dev_ctx->fpriv->opriv,
-						      "%s: Unable to allocate data_pending_txq\n",
-						      __func__);
-
-				mem_ptr = fmac_dev_ctx->tx_config.send_pkt_coalesce_count_p;
-
-				wifi_nrf_osal_mem_free(fmac_dev_ctx->fpriv->opriv,
-						       mem_ptr);
-
-				goto out;
-			}
+			wifi_nrf_utils_nbuf_q_init(&fmac_dev_ctx->tx_config.data_pending_txq[j][i]);
 		}
 
+		fmac_dev_ctx->tx_config.pend_peer_bmp[i] = 0;
 		fmac_dev_ctx->tx_config.outstanding_descs[i] = 0;
 	}
 
@@ -1146,15 +1372,6 @@ enum wifi_nrf_status tx_init(struct wifi_nrf_fmac_dev_ctx *fmac_dev_ctx)
 				      "%s: Unable to allocate pkt_info_p\n",
 				      __func__);
 
-		for (i = 0; i < WIFI_NRF_FMAC_AC_MAX; i++) {
-			for (j = 0; j < MAX_SW_PEERS; j++) {
-				q_ptr = fmac_dev_ctx->tx_config.data_pending_txq[j][i];
-
-				wifi_nrf_utils_q_free(fpriv->opriv,
-						      q_ptr);
-			}
-		}
-
 		wifi_nrf_osal_mem_free(fmac_dev_ctx->fpriv->opriv,
 				       fmac_dev_ctx->tx_config.send_pkt_coalesce_count_p);
 
@@ -1162,30 +1379,7 @@ enum wifi_nrf_status tx_init(struct wifi_nrf_fmac_dev_ctx *fmac_dev_ctx)
 	}
 
 	for (i = 0; i < fpriv->num_tx_tokens; i++) {
-		fmac_dev_ctx->tx_config.pkt_info_p[i].pkt = wifi_nrf_utils_list_alloc(fpriv->opriv);
-
-		if (!fmac_dev_ctx->tx_config.pkt_info_p[i].pkt) {
-			wifi_nrf_osal_log_err(fmac_dev_ctx->fpriv->opriv,
-					      "%s: Unable to allocate pkt list\n",
-					      __func__);
-
-			wifi_nrf_osal_mem_free(fmac_dev_ctx->fpriv->opriv,
-					       fmac_dev_ctx->tx_config.pkt_info_p);
-
-			for (i = 0; i < WIFI_NRF_FMAC_AC_MAX; i++) {
-				for (j = 0; j < MAX_SW_PEERS; j++) {
-					q_ptr = fmac_dev_ctx->tx_config.data_pending_txq[j][i];
-
-					wifi_nrf_utils_q_free(fpriv->opriv,
-							      q_ptr);
-				}
-			}
-
-			wifi_nrf_osal_mem_free(fmac_dev_ctx->fpriv->opriv,
-					       fmac_dev_ctx->tx_config.send_pkt_coalesce_count_p);
-
-			goto out;
-		}
+		wifi_nrf_utils_nbuf_q_init(&fmac_dev_ctx->tx_config.pkt_info_p[i].pkt);
 	}
 
 	for (j = 0; j < WIFI_NRF_FMAC_AC_MAX; j++) {
@@ -1195,30 +1389,16 @@ enum wifi_nrf_status tx_init(struct wifi_nrf_fmac_dev_ctx *fmac_dev_ctx)
 	fmac_dev_ctx->tx_config.buf_pool_bmp_p =
 		wifi_nrf_osal_mem_zalloc(fmac_dev_ctx->fpriv->opriv,
 					 (sizeof(unsigned long) *
-					  (fpriv->num_tx_tokens/TX_DESC_BUCKET_BOUND) + 1));
+					  ((fpriv->num_tx_tokens/TX_DESC_BUCKET_BOUND) + 1)));
 
 	if (!fmac_dev_ctx->tx_config.buf_pool_bmp_p) {
 		wifi_nrf_osal_log_err(fmac_dev_ctx->fpriv->opriv,
 				      "%s: Unable to allocate buf_pool_bmp_p\n",
 				      __func__);
 
-		for (i = 0; i < fpriv->num_tx_tokens; i++) {
-			wifi_nrf_utils_list_free(fpriv->opriv,
-						 fmac_dev_ctx->tx_config.pkt_info_p[i].pkt);
-		}
-
 		wifi_nrf_osal_mem_free(fmac_dev_ctx->fpriv->opriv,
 				       fmac_dev_ctx->tx_config.pkt_info_p);
 
-		for (i = 0; i < WIFI_NRF_FMAC_AC_MAX; i++) {
-			for (j = 0; j < MAX_SW_PEERS; j++) {
-				q_ptr = fmac_dev_ctx->tx_config.data_pending_txq[j][i];
-
-				wifi_nrf_utils_q_free(fpriv->opriv,
-						      q_ptr);
-			}
-		}
-
 		wifi_nrf_osal_mem_free(fmac_dev_ctx->fpriv->opriv,
 				       fmac_dev_ctx->tx_config.send_pkt_coalesce_count_p);
 
@@ -1245,23 +1425,9 @@ enum wifi_nrf_status tx_init(struct wifi_nrf_fmac_dev_ctx *fmac_dev_ctx)
 		wifi_nrf_osal_mem_free(fmac_dev_ctx->fpriv->opriv,
 				       fmac_dev_ctx->tx_config.buf_pool_bmp_p);
 
-		for (i = 0; i < fpriv->num_tx_tokens; i++) {
-			wifi_nrf_utils_list_free(fpriv->opriv,
-						 fmac_dev_ctx->tx_config.pkt_info_p[i].pkt);
-		}
-
 		wifi_nrf_osal_mem_free(fmac_dev_ctx->fpriv->opriv,
 				       fmac_dev_ctx->tx_config.pkt_info_p);
 
-		for (i = 0; i < WIFI_NRF_FMAC_AC_MAX; i++) {
-			for (j = 0; j < MAX_SW_PEERS; j++) {
-				q_ptr = fmac_dev_ctx->tx_config.data_pending_txq[j][i];
-
-				wifi_nrf_utils_q_free(fpriv->opriv,
-						      q_ptr);
-			}
-		}
-
 		wifi_nrf_osal_mem_free(fmac_dev_ctx->fpriv->opriv,
 				       fmac_dev_ctx->tx_config.send_pkt_coalesce_count_p);
 
@@ -1284,44 +1450,98 @@ enum wifi_nrf_status tx_init(struct wifi_nrf_fmac_dev_ctx *fmac_dev_ctx)
 		wifi_nrf_osal_mem_free(fmac_dev_ctx->fpriv->opriv,
 				       fmac_dev_ctx->tx_config.buf_pool_bmp_p);
 
-		for (i = 0; i < fpriv->num_tx_tokens; i++) {
-			wifi_nrf_utils_list_free(fpriv->opriv,
-						 fmac_dev_ctx->tx_config.pkt_info_p[i].pkt);
-		}
-
 		wifi_nrf_osal_mem_free(fmac_dev_ctx->fpriv->opriv,
 				       fmac_dev_ctx->tx_config.pkt_info_p);
 
-		for (i = 0; i < WIFI_NRF_FMAC_AC_MAX; i++) {
-			for (j = 0; j < MAX_SW_PEERS; j++) {
-				q_ptr = fmac_dev_ctx->tx_config.data_pending_txq[j][i];
+		wifi_nrf_osal_mem_free(fmac_dev_ctx->fpriv->opriv,
+				       fmac_dev_ctx->tx_config.send_pkt_coalesce_count_p);
 
-				wifi_nrf_utils_q_free(fpriv->opriv,
-						      q_ptr);
-			}
-		}
+		goto out;
+	}
+
+	status = tx_coalesce_init(fmac_dev_ctx);
+
+	if (status != WIFI_NRF_STATUS_SUCCESS) {
+		wifi_nrf_osal_log_err(fmac_dev_ctx->fpriv->opriv,
+				      "%s: Unable to initialize TX coalescing\n",
+				      __func__);
+
+		wifi_nrf_utils_q_free(fpriv->opriv,
+				      fmac_dev_ctx->tx_config.wakeup_client_q);
+
+		wifi_nrf_osal_spinlock_free(fmac_dev_ctx->fpriv->opriv,
+					    fmac_dev_ctx->tx_config.tx_lock);
+
+		wifi_nrf_osal_mem_free(fmac_dev_ctx->fpriv->opriv,
+				       fmac_dev_ctx->tx_config.buf_pool_bmp_p);
+
+		wifi_nrf_osal_mem_free(fmac_dev_ctx->fpriv->opriv,
+				       fmac_dev_ctx->tx_config.pkt_info_p);
 
 		wifi_nrf_osal_mem_free(fmac_dev_ctx->fpriv->opriv,
 				       fmac_dev_ctx->tx_config.send_pkt_coalesce_count_p);
 
 		goto out;
 	}
-
-	status = WIFI_NRF_STATUS_SUCCESS;
 out:
 	return status;
 }
 
 
+/* Free the frames of the TX commands that the RPU did not complete. The
+ * frames are owned by the descriptor until the TX done event, which will not
+ * come anymore.
+ */
+static void tx_descs_free(struct wifi_nrf_fmac_dev_ctx *fmac_dev_ctx)
+{
+	struct wifi_nrf_fmac_priv *fpriv = NULL;
+	struct wifi_nrf_fmac_buf_map_info *tx_buf_info = NULL;
+	struct wifi_nrf_utils_nbuf_q *txq = NULL;
+	void *nwb = NULL;
+	unsigned int desc = 0;
+	unsigned int desc_id = 0;
+
+	fpriv = fmac_dev_ctx->fpriv;
+
+	for (desc = 0; desc < fpriv->num_tx_tokens; desc++) {
+		for (desc_id = desc * fpriv->data_config.max_tx_aggregation;
+		     desc_id < (desc + 1) * fpriv->data_config.max_tx_aggregation;
+		     desc_id++) {
+			tx_buf_info = &fmac_dev_ctx->tx_buf_info[desc_id];
+
+			if (!tx_buf_info->mapped) {
+				continue;
+			}
+
+			wifi_nrf_hal_buf_unmap_tx(fmac_dev_ctx->hal_dev_ctx,
+						  desc_id);
+
+			tx_buf_info->nwb = 0;
+			tx_buf_info->mapped = false;
+		}
+
+		txq = &fmac_dev_ctx->tx_config.pkt_info_p[desc].pkt;
+
+		while ((nwb = wifi_nrf_utils_nbuf_q_dequeue(fpriv->opriv, txq))) {
+			wifi_nrf_osal_nbuf_free(fpriv->opriv,
+						nwb);
+		}
+	}
+}
+
+
 void tx_deinit(struct wifi_nrf_fmac_dev_ctx *fmac_dev_ctx)
 {
 	struct wifi_nrf_fmac_priv *fpriv = NULL;
+	void *nwb = NULL;
 	unsigned int i = 0;
 	unsigned int j = 0;
 
 	fpriv = fmac_dev_ctx->fpriv;
 
-	/* TODO: Need to deinit network buffers? */
+	tx_coalesce_deinit(fmac_dev_ctx);
+
+	tx_descs_free(fmac_dev_ctx);
 
 	wifi_nrf_utils_q_free(fpriv->opriv,
 			      fmac_dev_ctx->tx_config.wakeup_client_q);
@@ -1332,20 +1552,16 @@ void tx_deinit(struct wifi_nrf_fmac_dev_ctx *fmac_dev_ctx)
 	wifi_nrf_osal_mem_free(fmac_dev_ctx->fpriv->opriv,
 			       fmac_dev_ctx->tx_config.buf_pool_bmp_p);
 
-	for (i = 0; i < fpriv->num_tx_tokens; i++) {
-		if (fmac_dev_ctx->tx_config.pkt_info_p) {
-			wifi_nrf_utils_list_free(fpriv->opriv,
-						 fmac_dev_ctx->tx_config.pkt_info_p[i].pkt);
-		}
-	}
-
 	wifi_nrf_osal_mem_free(fmac_dev_ctx->fpriv->opriv,
 			       fmac_dev_ctx->tx_config.pkt_info_p);
 
 	for (i = 0; i < WIFI_NRF_FMAC_AC_MAX; i++) {
 		for (j = 0; j < MAX_SW_PEERS; j++) {
-			wifi_nrf_utils_q_free(fpriv->opriv,
-					      fmac_dev_ctx->tx_config.data_pending_txq[j][i]);
+			while ((nwb = wifi_nrf_utils_nbuf_q_dequeue(fpriv->opriv,
+								    &fmac_dev_ctx->tx_config.data_pending_txq[j][i]))) {
+				wifi_nrf_osal_nbuf_free(fpriv->opriv,
+							nwb);
+			}
 		}
 	}
 
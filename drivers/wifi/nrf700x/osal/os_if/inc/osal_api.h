@@ -679,6 +679,38 @@ void *wifi_nrf_osal_nbuf_data_pull(struct wifi_nrf_osal_priv *opriv,
 				    unsigned int size);
 
 
+/**
+ * wifi_nrf_osal_nbuf_next_get() - Get the next network buffer in a queue.
+ * @opriv: Pointer to the OSAL context returned by the @wifi_nrf_osal_init API.
+ * @nbuf: Pointer to a network buffer.
+ *
+ * Gets the network buffer linked after the network buffer(@nbuf). The link
+ * is stored in the network buffer itself, so queueing network buffers does
+ * not need any memory allocation.
+ *
+ * Return:
+ *		Pass: Pointer to the next network buffer.
+ *		Error: NULL.
+ */
+void *wifi_nrf_osal_nbuf_next_get(struct wifi_nrf_osal_priv *opriv,
+				  void *nbuf);
+
+
+/**
+ * wifi_nrf_osal_nbuf_next_set() - Set the next network buffer in a queue.
+ * @opriv: Pointer to the OSAL context returned by the @wifi_nrf_osal_init API.
+ * @nbuf: Pointer to a network buffer.
+ * @next: Pointer to the network buffer to be linked after @nbuf.
+ *
+ * Links the network buffer(@next) after the network buffer(@nbuf).
+ *
+ * Return: None.
+ */
+void wifi_nrf_osal_nbuf_next_set(struct wifi_nrf_osal_priv *opriv,
+				 void *nbuf,
+				 void *next);
+
+
 /**
  * wifi_nrf_osal_tasklet_alloc() - Allocate a tasklet.
  * @opriv: Pointer to the OSAL context returned by the @wifi_nrf_osal_init API.
@@ -1202,7 +1234,6 @@ void wifi_nrf_osal_qspi_cpy_to(struct wifi_nrf_osal_priv *opriv,
 				const void *src,
 				size_t count);
 
-#ifdef CONFIG_NRF_WIFI_LOW_POWER
 /**
  * wifi_nrf_osal_timer_alloc() - Allocate a timer.
  * @opriv: Pointer to the OSAL context returned by the @wifi_nrf_osal_init API.
@@ -1251,9 +1282,9 @@ void wifi_nrf_osal_timer_init(struct wifi_nrf_osal_priv *opriv,
  * wifi_nrf_osal_timer_schedule() - Schedule a timer.
  * @opriv: Pointer to the OSAL context returned by the @wifi_nrf_osal_init API.
  * @timer: Pointer to a timer instance.
- * @duration: Duration of the timer in seconds.
+ * @duration: Duration of the timer in milliseconds.
  *
- * Schedules a timer with a @duration seconds that has been allocated using
+ * Schedules a timer with a @duration milliseconds that has been allocated using
  * @wifi_nrf_osal_timer_alloc and initialized with @wifi_nrf_osal_timer_init.
  *
  * Return: None.
@@ -1276,7 +1307,7 @@ void wifi_nrf_osal_timer_kill(struct wifi_nrf_osal_priv *opriv,
 			       void *timer);
 
 
-
+#ifdef CONFIG_NRF_WIFI_LOW_POWER
 int wifi_nrf_osal_bus_qspi_ps_sleep(struct wifi_nrf_osal_priv *opriv,
 				    void *os_qspi_priv);
 
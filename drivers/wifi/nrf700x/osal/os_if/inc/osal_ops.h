@@ -99,6 +99,10 @@
  * @nbuf_data_pull: Decrease the data area of a network buffer(@nbuf) by @size
  *                  bytes at the start of the area and return the pointer to the
  *                  beginning of the data area.
+ * @nbuf_next_get: Get the network buffer linked after a network buffer(@nbuf)
+ *                 in a queue.
+ * @nbuf_next_set: Link a network buffer(@next) after a network buffer(@nbuf)
+ *                 in a queue.
  *
  * @tasklet_alloc: Allocate a tasklet structure and return a pointer to it.
  * @tasklet_free: Free a tasklet structure that had been allocated using
@@ -223,6 +227,8 @@ struct wifi_nrf_osal_ops {
 	void *(*nbuf_data_put)(void *nbuf, unsigned int size);
 	void *(*nbuf_data_push)(void *nbuf, unsigned int size);
 	void *(*nbuf_data_pull)(void *nbuf, unsigned int size);
+	void *(*nbuf_next_get)(void *nbuf);
+	void (*nbuf_next_set)(void *nbuf, void *next);
 
 	void *(*tasklet_alloc)(void);
 	void (*tasklet_free)(void *tasklet);
@@ -282,7 +288,6 @@ struct wifi_nrf_osal_ops {
 	void (*bus_qspi_dev_host_map_get)(void *os_qspi_dev_ctx,
 					  struct wifi_nrf_osal_host_map *host_map);
 
-#ifdef CONFIG_NRF_WIFI_LOW_POWER
 	void *(*timer_alloc)(void);
 	void (*timer_free)(void *timer);
 	void (*timer_init)(void *timer,
@@ -290,6 +295,8 @@ struct wifi_nrf_osal_ops {
 			   unsigned long data);
 	void (*timer_schedule)(void *timer, unsigned long duration);
 	void (*timer_kill)(void *timer);
+
+#ifdef CONFIG_NRF_WIFI_LOW_POWER
 	int (*bus_qspi_ps_sleep)(void *os_qspi_priv);
 	int (*bus_qspi_ps_wake)(void *os_qspi_priv);
 	int (*bus_qspi_ps_status)(void *os_qspi_priv);
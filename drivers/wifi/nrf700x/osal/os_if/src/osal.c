@@ -401,6 +401,22 @@ void *wifi_nrf_osal_nbuf_data_pull(struct wifi_nrf_osal_priv *opriv,
 }
 
 
+void *wifi_nrf_osal_nbuf_next_get(struct wifi_nrf_osal_priv *opriv,
+				  void *nbuf)
+{
+	return opriv->ops->nbuf_next_get(nbuf);
+}
+
+
+void wifi_nrf_osal_nbuf_next_set(struct wifi_nrf_osal_priv *opriv,
+				 void *nbuf,
+				 void *next)
+{
+	opriv->ops->nbuf_next_set(nbuf,
+				  next);
+}
+
+
 void *wifi_nrf_osal_tasklet_alloc(struct wifi_nrf_osal_priv *opriv)
 {
 	return opriv->ops->tasklet_alloc();
@@ -688,7 +704,6 @@ void wifi_nrf_osal_qspi_cpy_to(struct wifi_nrf_osal_priv *opriv,
 				count);
 }
 
-#ifdef CONFIG_NRF_WIFI_LOW_POWER
 void *wifi_nrf_osal_timer_alloc(struct wifi_nrf_osal_priv *opriv)
 {
 	return opriv->ops->timer_alloc();
@@ -729,7 +744,7 @@ void wifi_nrf_osal_timer_kill(struct wifi_nrf_osal_priv *opriv,
 }
 
 
-
+#ifdef CONFIG_NRF_WIFI_LOW_POWER
 int wifi_nrf_osal_bus_qspi_ps_sleep(struct wifi_nrf_osal_priv *opriv,
 				    void *os_qspi_priv)
 {
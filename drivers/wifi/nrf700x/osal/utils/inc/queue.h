@@ -15,6 +15,21 @@
 #include <stddef.h>
 #include "osal_ops.h"
 
+/**
+ * struct wifi_nrf_utils_nbuf_q - Queue of network buffers.
+ * @head: First network buffer in the queue.
+ * @tail: Last network buffer in the queue.
+ * @len: Number of network buffers in the queue.
+ *
+ * The network buffers are linked through the network buffers themselves,
+ * so enqueueing and dequeueing do not need any memory allocation.
+ */
+struct wifi_nrf_utils_nbuf_q {
+	void *head;
+	void *tail;
+	unsigned int len;
+};
+
 void *wifi_nrf_utils_q_alloc(struct wifi_nrf_osal_priv *opriv);
 
 void wifi_nrf_utils_q_free(struct wifi_nrf_osal_priv *opriv,
@@ -32,4 +47,20 @@ void *wifi_nrf_utils_q_peek(struct wifi_nrf_osal_priv *opriv,
 
 unsigned int wifi_nrf_utils_q_len(struct wifi_nrf_osal_priv *opriv,
 				  void *q);
+
+void wifi_nrf_utils_nbuf_q_init(struct wifi_nrf_utils_nbuf_q *q);
+
+void wifi_nrf_utils_nbuf_q_enqueue(struct wifi_nrf_osal_priv *opriv,
+				   struct wifi_nrf_utils_nbuf_q *q,
+				   void *nbuf);
+
+void *wifi_nrf_utils_nbuf_q_dequeue(struct wifi_nrf_osal_priv *opriv,
+				    struct wifi_nrf_utils_nbuf_q *q);
+
+void *wifi_nrf_utils_nbuf_q_peek(struct wifi_nrf_utils_nbuf_q *q);
+
+void *wifi_nrf_utils_nbuf_q_next(struct wifi_nrf_osal_priv *opriv,
+				 void *nbuf);
+
+unsigned int wifi_nrf_utils_nbuf_q_len(struct wifi_nrf_utils_nbuf_q *q);
 #endif /* __QUEUE_H__ */
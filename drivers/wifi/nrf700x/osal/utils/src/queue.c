@@ -58,3 +58,77 @@ unsigned int wifi_nrf_utils_q_len(struct wifi_nrf_osal_priv *opriv,
 	return wifi_nrf_utils_list_len(opriv,
 				       q);
 }
+
+
+void wifi_nrf_utils_nbuf_q_init(struct wifi_nrf_utils_nbuf_q *q)
+{
+	q->head = NULL;
+	q->tail = NULL;
+	q->len = 0;
+}
+
+
+void wifi_nrf_utils_nbuf_q_enqueue(struct wifi_nrf_osal_priv *opriv,
+				   struct wifi_nrf_utils_nbuf_q *q,
+				   void *nbuf)
+{
+	wifi_nrf_osal_nbuf_next_set(opriv,
+				    nbuf,
+				    NULL);
+
+	if (q->tail) {
+		wifi_nrf_osal_nbuf_next_set(opriv,
+					    q->tail,
+					    nbuf);
+	} else {
+		q->head = nbuf;
+	}
+
+	q->tail = nbuf;
+	q->len++;
+}
+
+
+void *wifi_nrf_utils_nbuf_q_dequeue(struct wifi_nrf_osal_priv *opriv,
+				    struct wifi_nrf_utils_nbuf_q *q)
+{
+	void *nbuf = q->head;
+
+	if (!nbuf) {
+		goto out;
+	}
+
+	q->head = wifi_nrf_osal_nbuf_next_get(opriv,
+					      nbuf);
+
+	if (!q->head) {
+		q->tail = NULL;
+	}
+
+	wifi_nrf_osal_nbuf_next_set(opriv,
+				    nbuf,
+				    NULL);
+	q->len--;
+out:
+	return nbuf;
+}
+
+
+void *wifi_nrf_utils_nbuf_q_peek(struct wifi_nrf_utils_nbuf_q *q)
+{
+	return q->head;
+}
+
+
+void *wifi_nrf_utils_nbuf_q_next(struct wifi_nrf_osal_priv *opriv,
+				 void *nbuf)
+{
+	return wifi_nrf_osal_nbuf_next_get(opriv,
+					   nbuf);
+}
+
+
+unsigned int wifi_nrf_utils_nbuf_q_len(struct wifi_nrf_utils_nbuf_q *q)
+{
+	return q->len;
+}
@@ -17,6 +17,7 @@
 #include <zephyr/sys/printk.h>
 #include <zephyr/drivers/gpio.h>
 #include <zephyr/logging/log.h>
+#include <zephyr/net/buf.h>
 
 #include "rpu_hw_if.h"
 #include "shim.h"
@@ -197,42 +198,77 @@ struct nwb {
 	int hostbuffer;
 	void *cleanup_ctx;
 	void (*cleanup_cb)();
+	/* net_buf holding both the data and this nwb (in its user data) */
+	struct net_buf *buf;
 };
 
-static void *zep_shim_nbuf_alloc(unsigned int size)
-{
-	struct nwb *nwb;
+/* The RPU is accessed over QSPI/SPI, which needs word aligned host buffers. */
+#define NWB_ALIGN 4
 
-	nwb = (struct nwb *)k_calloc(sizeof(struct nwb), sizeof(char));
+/* RX buffers only. TX frames are copied to the heap in net_pkt_to_nbuf(),
+ * so that a TX burst cannot use up the buffers needed to refill the RX
+ * descriptors.
+ */
+NET_BUF_POOL_HEAP_DEFINE(wifi_nrf_rx_nwb_pool, CONFIG_NRF700X_RX_NET_BUF_COUNT,
+			 sizeof(struct nwb), NULL);
 
-	if (!nwb)
-		return NULL;
+static struct nwb *zep_shim_nbuf_heap_alloc(unsigned int size)
+{
+	struct nwb *nwb;
 
-	nwb->priv = k_calloc(size, sizeof(char));
+	/* Single allocation holding the nwb followed by its data area */
+	nwb = k_malloc(sizeof(*nwb) + size);
 
-	if (!nwb->priv) {
-		k_free(nwb);
+	if (!nwb) {
 		return NULL;
 	}
 
+	memset(nwb, 0, sizeof(*nwb));
+
+	nwb->priv = nwb + 1;
 	nwb->data = (unsigned char *)nwb->priv;
 	nwb->tail = nwb->data;
-	nwb->len = 0;
-	nwb->headroom = 0;
-	nwb->next = NULL;
 
 	return nwb;
 }
 
-static void zep_shim_nbuf_free(void *nbuf)
+/* The FMAC allocates network buffers only for the RX descriptors */
+static void *zep_shim_nbuf_alloc(unsigned int size)
 {
+	struct net_buf *buf;
 	struct nwb *nwb;
+	size_t pad;
+
+	buf = net_buf_alloc_len(&wifi_nrf_rx_nwb_pool, size + NWB_ALIGN - 1, K_NO_WAIT);
+
+	if (!buf) {
+		/* Pool exhausted, the frame will be copied on reception */
+		return zep_shim_nbuf_heap_alloc(size);
+	}
 
-	nwb = nbuf;
+	pad = ROUND_UP(buf->data, NWB_ALIGN) - (uintptr_t)buf->data;
+	net_buf_reserve(buf, pad);
 
-	k_free(((struct nwb *)nbuf)->priv);
+	nwb = net_buf_user_data(buf);
+	memset(nwb, 0, sizeof(*nwb));
 
-	k_free(nbuf);
+	nwb->buf = buf;
+	nwb->data = buf->data;
+	nwb->tail = nwb->data;
+
+	return nwb;
+}
+
+static void zep_shim_nbuf_free(void *nbuf)
+{
+	struct nwb *nwb = nbuf;
+
+	if (nwb->buf) {
+		net_buf_unref(nwb->buf);
+		return;
+	}
+
+	k_free(nwb);
 }
 
 static void zep_shim_nbuf_headroom_res(void *nbuf, unsigned int size)
@@ -292,32 +328,76 @@ static void *zep_shim_nbuf_data_pull(void *nbuf, unsigned int size)
 	return nwb->data;
 }
 
+static void *zep_shim_nbuf_next_get(void *nbuf)
+{
+	return ((struct nwb *)nbuf)->next;
+}
+
+static void zep_shim_nbuf_next_set(void *nbuf, void *next)
+{
+	((struct nwb *)nbuf)->next = next;
+}
+
 #include <net/ethernet.h>
 #include <net/net_core.h>
 
+#define TX_NWB_HEADROOM 100
+
 void *net_pkt_to_nbuf(struct net_pkt *pkt)
 {
 	struct nwb *nwb;
 	unsigned char *data;
 	unsigned int len;
 
+	/* The bus needs one contiguous buffer, and L2 keeps the link layer
+	 * header in its own fragment, so the frame is always linearized.
+	 */
 	len = net_pkt_get_len(pkt);
 
-	nwb = zep_shim_nbuf_alloc(len + 100);
+	nwb = zep_shim_nbuf_heap_alloc(len + TX_NWB_HEADROOM);
 
 	if (!nwb) {
 		return NULL;
 	}
 
-	zep_shim_nbuf_headroom_res(nwb, 100);
+	zep_shim_nbuf_headroom_res(nwb, TX_NWB_HEADROOM);
 
 	data = zep_shim_nbuf_data_put(nwb, len);
 
-	net_pkt_read(pkt, data, len);
+	net_pkt_cursor_init(pkt);
+
+	if (net_pkt_read(pkt, data, len)) {
+		zep_shim_nbuf_free(nwb);
+		return NULL;
+	}
 
 	return nwb;
 }
 
+static struct net_pkt *net_pkt_from_net_buf_nwb(void *iface, struct nwb *nwb)
+{
+	struct net_buf *buf = nwb->buf;
+	struct net_pkt *pkt;
+
+	pkt = net_pkt_rx_alloc_on_iface(iface, K_MSEC(100));
+
+	if (!pkt) {
+		net_buf_unref(buf);
+		return NULL;
+	}
+
+	/* Trim the net_buf to the frame; nwb lives in its user data and is
+	 * not used past this point.
+	 */
+	net_buf_add(buf, nwb->tail - buf->data);
+	net_buf_pull(buf, nwb->data - buf->data);
+
+	net_pkt_append_buffer(pkt, buf);
+	net_pkt_cursor_init(pkt);
+
+	return pkt;
+}
+
 void *net_pkt_from_nbuf(void *iface, void *frm)
 {
 	struct net_pkt *pkt;
@@ -325,6 +405,10 @@ void *net_pkt_from_nbuf(void *iface, void *frm)
 	unsigned int len;
 	struct nwb *nwb = frm;
 
+	if (nwb->buf) {
+		return net_pkt_from_net_buf_nwb(iface, nwb);
+	}
+
 	len = zep_shim_nbuf_data_size(nwb);
 
 	data = zep_shim_nbuf_data_get(nwb);
@@ -332,6 +416,7 @@ void *net_pkt_from_nbuf(void *iface, void *frm)
 	pkt = net_pkt_rx_alloc_with_buffer(iface, len, AF_UNSPEC, 0, K_MSEC(100));
 
 	if (!pkt) {
+		zep_shim_nbuf_free(nwb);
 		return NULL;
 	}
 
@@ -691,7 +776,6 @@ static void zep_shim_bus_qspi_intr_unreg(void *os_qspi_dev_ctx)
 {
 }
 
-#ifdef CONFIG_NRF_WIFI_LOW_POWER
 static void *zep_shim_timer_alloc(void)
 {
 	struct timer_list *timer = NULL;
@@ -726,7 +810,6 @@ static void zep_shim_timer_kill(void *timer)
 {
 	del_timer_sync(timer);
 }
-#endif /* CONFIG_NRF_WIFI_LOW_POWER */
 
 static const struct wifi_nrf_osal_ops wifi_nrf_os_zep_ops = {
 	.mem_alloc = zep_shim_mem_alloc,
@@ -776,6 +859,8 @@ static const struct wifi_nrf_osal_ops wifi_nrf_os_zep_ops = {
 	.nbuf_data_put = zep_shim_nbuf_data_put,
 	.nbuf_data_push = zep_shim_nbuf_data_push,
 	.nbuf_data_pull = zep_shim_nbuf_data_pull,
+	.nbuf_next_get = zep_shim_nbuf_next_get,
+	.nbuf_next_set = zep_shim_nbuf_next_set,
 
 	.tasklet_alloc = zep_shim_work_alloc,
 	.tasklet_free = zep_shim_work_free,
@@ -798,13 +883,13 @@ static const struct wifi_nrf_osal_ops wifi_nrf_os_zep_ops = {
 	.bus_qspi_dev_intr_unreg = zep_shim_bus_qspi_intr_unreg,
 	.bus_qspi_dev_host_map_get = zep_shim_bus_qspi_dev_host_map_get,
 
-#ifdef CONFIG_NRF_WIFI_LOW_POWER
 	.timer_alloc = zep_shim_timer_alloc,
 	.timer_init = zep_shim_timer_init,
 	.timer_free = zep_shim_timer_free,
 	.timer_schedule = zep_shim_timer_schedule,
 	.timer_kill = zep_shim_timer_kill,
 
+#ifdef CONFIG_NRF_WIFI_LOW_POWER
 	.bus_qspi_ps_sleep = zep_shim_bus_qspi_ps_sleep,
 	.bus_qspi_ps_wake = zep_shim_bus_qspi_ps_wake,
 	.bus_qspi_ps_status = zep_shim_bus_qspi_ps_status,
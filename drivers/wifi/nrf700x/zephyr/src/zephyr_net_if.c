@@ -33,6 +33,11 @@ void wifi_nrf_if_rx_frm(void *os_vif_ctx, void *frm)
 
 	pkt = net_pkt_from_nbuf(iface, frm);
 
+	if (!pkt) {
+		LOG_DBG("Failed to allocate net_pkt");
+		return;
+	}
+
 	status = net_recv_data(iface, pkt);
 
 	if (status < 0) {
@@ -85,6 +90,7 @@ int wifi_nrf_if_send(const struct device *dev, struct net_pkt *pkt)
 {
 	struct wifi_nrf_vif_ctx_zep *vif_ctx_zep = NULL;
 	struct wifi_nrf_ctx_zep *rpu_ctx_zep = NULL;
+	void *nbuf = NULL;
 
 	vif_ctx_zep = dev->data;
 	rpu_ctx_zep = vif_ctx_zep->rpu_ctx_zep;
@@ -99,6 +105,12 @@ int wifi_nrf_if_send(const struct device *dev, struct net_pkt *pkt)
 		return 0;
 	}
 
-	return wifi_nrf_fmac_start_xmit(rpu_ctx_zep->rpu_ctx, vif_ctx_zep->vif_idx,
-					net_pkt_to_nbuf(pkt));
+	nbuf = net_pkt_to_nbuf(pkt);
+
+	if (!nbuf) {
+		LOG_DBG("Failed to allocate nbuf");
+		return -ENOMEM;
+	}
+
+	return wifi_nrf_fmac_start_xmit(rpu_ctx_zep->rpu_ctx, vif_ctx_zep->vif_idx, nbuf);
 }
@@ -29,6 +29,7 @@ struct sensor_data_aggregator_event {
 	const char *sensor_descr;
 	uint8_t *buf;
 	enum sensor_state sensor_state;
+	struct sensor_sample_format format;
 	uint8_t sample_cnt;
 };
 
@@ -17,6 +17,7 @@
 #include <app_event_manager.h>
 #include <app_event_manager_profiler_tracer.h>
 #include <zephyr/drivers/sensor.h>
+#include <caf/sensor_sample.h>
 #include <stdlib.h>
 
 #ifdef __cplusplus
@@ -79,6 +80,15 @@ APP_EVENT_TYPE_DECLARE(sensor_state_event);
  * in X, Y and Z axis as three floating-point values. @ref sensor_event_get_data_cnt and @ref
  * sensor_event_get_data_ptr can be used to access the sensor data provided by a given sensor event.
  *
+ * The readouts are represented as struct sensor_value by default. The sensor can also use a compact
+ * fixed-point representation described by the format field. In that case, the data must be accessed
+ * using @ref sensor_event_get_raw_data_ptr and can be converted in bulk using the helpers from
+ * @ref caf_sensor_sample.
+ *
+ * A single event may carry more than one sample of the sensor. In that case the samples are placed
+ * one after another in the dyndata. @ref sensor_event_get_sample_cnt can be used to get the number
+ * of samples in the event.
+ *
  * @note The sensor event related to the given sensor must use the same description as
  *       #sensor_state_event related to the sensor.
  */
@@ -86,23 +96,31 @@ struct sensor_event {
 	struct app_event_header header; /**< Event header. */
 
 	const char *descr; /**< Description of the sensor. */
-	struct event_dyndata dyndata; /**< Sensor data. Provided as floating-point values. */
+	/** Format of the sensor data. The zero-initialized format stands for struct sensor_value.
+	 *  All sensor events of the given sensor must use the same format.
+	 */
+	struct sensor_sample_format format;
+	struct event_dyndata dyndata; /**< Sensor data. Provided in the format. */
 };
 
 /** @brief Get size of sensor data.
  *
  * @param[in] event       Pointer to the sensor_event.
  *
- * @return Size of the sensor data, expressed as a number of struct sensor_value.
+ * @return Size of the sensor data, expressed as a number of values in the event format.
  */
 static inline size_t sensor_event_get_data_cnt(const struct sensor_event *event)
 {
-	__ASSERT_NO_MSG((event->dyndata.size % sizeof(struct sensor_value)) == 0);
+	size_t value_size = sensor_sample_size(&event->format);
 
-	return (event->dyndata.size / sizeof(struct sensor_value));
+	__ASSERT_NO_MSG((event->dyndata.size % value_size) == 0);
+
+	return (event->dyndata.size / value_size);
 }
 
 /** @brief Get pointer to the sensor data.
+ *
+ * The function can be used only if the sensor data is provided as struct sensor_value.
  *
  * @param[in] event       Pointer to the sensor_event.
  *
@@ -110,9 +128,39 @@ static inline size_t sensor_event_get_data_cnt(const struct sensor_event *event)
  */
 static inline struct sensor_value *sensor_event_get_data_ptr(const struct sensor_event *event)
 {
+	__ASSERT_NO_MSG(event->format.type == SENSOR_SAMPLE_TYPE_SENSOR_VALUE);
+
 	return (struct sensor_value *)event->dyndata.data;
 }
 
+/** @brief Get pointer to the sensor data in the event format.
+ *
+ * @param[in] event       Pointer to the sensor_event.
+ *
+ * @return Pointer to the sensor data.
+ */
+static inline void *sensor_event_get_raw_data_ptr(const struct sensor_event *event)
+{
+	return (void *)event->dyndata.data;
+}
+
+/** @brief Get number of samples in the sensor event.
+ *
+ * @param[in] event           Pointer to the sensor_event.
+ * @param[in] sample_data_cnt Size of a single sample, expressed as a number of
+ *                            struct sensor_value.
+ *
+ * @return Number of samples carried by the sensor event.
+ */
+static inline size_t sensor_event_get_sample_cnt(const struct sensor_event *event,
+						 size_t sample_data_cnt)
+{
+	__ASSERT_NO_MSG(sample_data_cnt > 0);
+	__ASSERT_NO_MSG((sensor_event_get_data_cnt(event) % sample_data_cnt) == 0);
+
+	return (sensor_event_get_data_cnt(event) / sample_data_cnt);
+}
+
 /**
  * @brief Helper function for checking if one sensor_value is greater than the other.
  *
@@ -14,6 +14,7 @@ extern "C" {
 #include <zephyr/device.h>
 #include <zephyr/drivers/sensor.h>
 #include <caf/events/sensor_event.h>
+#include <caf/sensor_sample.h>
 
 #define FLOAT_TO_SENSOR_VALUE(float_val)							\
 	{											\
@@ -101,6 +102,33 @@ struct sm_sensor_config {
 	 * @brief Flag to indicate whether sensor should be suspended or not.
 	 */
 	bool suspend;
+	/**
+	 * @brief Number of samples in a single sensor event
+	 *
+	 * Samples are read directly into a preallocated sensor event and the event is
+	 * submitted once the given number of samples is gathered. This reduces the number
+	 * of events for sensors sampled with high frequency. The sensor event carries
+	 * samples one after another. Value of 0 or 1 results in an event per sample.
+	 */
+	uint8_t samples_per_event;
+	/**
+	 * @brief Flag to indicate that the sensor buffers samples in a FIFO
+	 *
+	 * The Zephyr sensor API has no call to read a sensor FIFO. If the flag is set,
+	 * the sensor driver must return the oldest buffered sample on every
+	 * sensor_sample_fetch() call and -ENODATA once the FIFO is empty. The sensor is
+	 * then read once per samples_per_event sampling periods and all of the buffered
+	 * samples are read in that wake-up. The sampling period must match the output
+	 * data rate of the sensor.
+	 */
+	bool fifo;
+	/**
+	 * @brief Format of the sensor data
+	 *
+	 * The sampled values are converted to the format before they are placed in the
+	 * sensor event. If not set, the values are provided as struct sensor_value.
+	 */
+	struct sensor_sample_format format;
 };
 
 #ifdef __cplusplus
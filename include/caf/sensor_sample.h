@@ -0,0 +1,175 @@
+/*
+ * Copyright (c) 2022 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#ifndef _SENSOR_SAMPLE_H_
+#define _SENSOR_SAMPLE_H_
+
+/**
+ * @file
+ * @defgroup caf_sensor_sample CAF Sensor Sample
+ * @{
+ * @brief CAF Sensor Sample format and conversion helpers.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <zephyr/sys/__assert.h>
+#include <zephyr/sys/util.h>
+#include <zephyr/drivers/sensor.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief Sensor sample types. */
+enum sensor_sample_type {
+	/** Sample value stored as struct sensor_value. */
+	SENSOR_SAMPLE_TYPE_SENSOR_VALUE,
+
+	/** Sample value stored as int16_t fixed-point value. */
+	SENSOR_SAMPLE_TYPE_Q15,
+
+	/** Sample value stored as int32_t fixed-point value. */
+	SENSOR_SAMPLE_TYPE_Q31,
+
+	/** Number of sensor sample types. */
+	SENSOR_SAMPLE_TYPE_COUNT
+};
+
+/** @brief Sensor sample format.
+ *
+ * For the fixed-point types, the sample value is equal to the stored integer divided by two
+ * to the power of @ref frac_bits. For example, an accelerometer with a range of +/-16 g can
+ * use @ref SENSOR_SAMPLE_TYPE_Q15 with 10 fractional bits.
+ *
+ * The zero-initialized format describes samples stored as struct sensor_value.
+ */
+struct sensor_sample_format {
+	/** Sample type, see @ref sensor_sample_type. */
+	uint8_t type;
+
+	/** Number of fractional bits of the fixed-point types. */
+	uint8_t frac_bits;
+};
+
+/** Maximum number of fractional bits of @ref SENSOR_SAMPLE_TYPE_Q15. */
+#define SENSOR_SAMPLE_Q15_FRAC_BITS_MAX 15
+
+/** Maximum number of fractional bits of @ref SENSOR_SAMPLE_TYPE_Q31. */
+#define SENSOR_SAMPLE_Q31_FRAC_BITS_MAX 31
+
+/** @brief Initializer of the fixed-point int16_t sample format.
+ *
+ * @param _frac_bits Number of fractional bits, a constant of at most
+ *		     @ref SENSOR_SAMPLE_Q15_FRAC_BITS_MAX.
+ */
+#define SENSOR_SAMPLE_FORMAT_Q15(_frac_bits)					\
+	{									\
+		.type = SENSOR_SAMPLE_TYPE_Q15,					\
+		.frac_bits = (_frac_bits) + ZERO_OR_COMPILE_ERROR(		\
+			(_frac_bits) <= SENSOR_SAMPLE_Q15_FRAC_BITS_MAX),	\
+	}
+
+/** @brief Initializer of the fixed-point int32_t sample format.
+ *
+ * @param _frac_bits Number of fractional bits, a constant of at most
+ *		     @ref SENSOR_SAMPLE_Q31_FRAC_BITS_MAX.
+ */
+#define SENSOR_SAMPLE_FORMAT_Q31(_frac_bits)					\
+	{									\
+		.type = SENSOR_SAMPLE_TYPE_Q31,					\
+		.frac_bits = (_frac_bits) + ZERO_OR_COMPILE_ERROR(		\
+			(_frac_bits) <= SENSOR_SAMPLE_Q31_FRAC_BITS_MAX),	\
+	}
+
+/** @brief Get size of a single value in the given format.
+ *
+ * @param[in] format      Sample format.
+ *
+ * @return Size of the value in bytes.
+ */
+static inline size_t sensor_sample_size(const struct sensor_sample_format *format)
+{
+	switch (format->type) {
+	case SENSOR_SAMPLE_TYPE_Q15:
+		return sizeof(int16_t);
+	case SENSOR_SAMPLE_TYPE_Q31:
+		return sizeof(int32_t);
+	case SENSOR_SAMPLE_TYPE_SENSOR_VALUE:
+		return sizeof(struct sensor_value);
+	default:
+		__ASSERT_NO_MSG(false);
+		return sizeof(struct sensor_value);
+	}
+}
+
+/** @brief Convert sensor values to the given format.
+ *
+ * Values out of range of the format are saturated.
+ *
+ * @param[in]  format     Destination format.
+ * @param[in]  src        Source values.
+ * @param[out] dst        Destination buffer, must hold @p cnt values in the @p format.
+ * @param[in]  cnt        Number of values.
+ */
+void sensor_sample_from_sensor_value(const struct sensor_sample_format *format,
+				     const struct sensor_value *src, void *dst, size_t cnt);
+
+/** @brief Convert values in the given format to floating-point values.
+ *
+ * @param[in]  format     Source format.
+ * @param[in]  src        Source values.
+ * @param[out] dst        Destination buffer.
+ * @param[in]  cnt        Number of values.
+ */
+void sensor_sample_to_float(const struct sensor_sample_format *format,
+			    const void *src, float *dst, size_t cnt);
+
+/** @brief Convert values in the given format to int16_t fixed-point values.
+ *
+ * Values out of range of int16_t are saturated.
+ *
+ * @param[in]  format     Source format.
+ * @param[in]  src        Source values.
+ * @param[out] dst        Destination buffer.
+ * @param[in]  cnt        Number of values.
+ * @param[in]  frac_bits  Number of fractional bits of the destination values, at most
+ *                        @ref SENSOR_SAMPLE_Q15_FRAC_BITS_MAX.
+ */
+void sensor_sample_to_q15(const struct sensor_sample_format *format,
+			  const void *src, int16_t *dst, size_t cnt, uint8_t frac_bits);
+
+/** @brief Delta-encode int16_t values.
+ *
+ * The first value is copied and every following value is replaced with the difference to
+ * the previous one. The differences wrap around, so the encoding is lossless.
+ * The source and destination buffers can be the same.
+ *
+ * @param[in]  src        Source values.
+ * @param[out] dst        Destination buffer.
+ * @param[in]  cnt        Number of values.
+ */
+void sensor_sample_q15_delta_encode(const int16_t *src, int16_t *dst, size_t cnt);
+
+/** @brief Decode int16_t values encoded with @ref sensor_sample_q15_delta_encode.
+ *
+ * The source and destination buffers can be the same.
+ *
+ * @param[in]  src        Source values.
+ * @param[out] dst        Destination buffer.
+ * @param[in]  cnt        Number of values.
+ */
+void sensor_sample_q15_delta_decode(const int16_t *src, int16_t *dst, size_t cnt);
+
+#ifdef __cplusplus
+}
+#endif
+
+/**
+ * @}
+ */
+
+#endif /* _SENSOR_SAMPLE_H_ */
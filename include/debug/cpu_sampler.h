@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2022 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+#ifndef __CPU_SAMPLER_H
+#define __CPU_SAMPLER_H
+
+#include <stddef.h>
+#include <zephyr/types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @defgroup cpu_sampler CPU sampling profiler
+ * @brief Module for finding the code that uses the CPU.
+ *
+ * @{
+ */
+
+/** @brief Highest context value that identifies an interrupt.
+ *
+ * If an interrupt handler was interrupted by the sampling, the context of the
+ * sample is the exception number of the handler, or 0 if the number is not
+ * known. Otherwise, it is the address of the interrupted thread.
+ */
+#define CPU_SAMPLER_CTX_ISR_MAX 0x1FF
+
+/** @brief Histogram entry. */
+struct cpu_sampler_entry {
+	/** Program counter of the interrupted code. */
+	uintptr_t pc;
+
+	/** Context of the interrupted code, see @ref CPU_SAMPLER_CTX_ISR_MAX. */
+	uintptr_t ctx;
+
+	/** Number of samples. */
+	uint32_t count;
+};
+
+/** @brief Start sampling.
+ *
+ * The timer used for sampling is allocated when this function is called for
+ * the first time. Samples are added to the histogram until it is reset.
+ *
+ * @param rate Sampling rate in Hz.
+ *
+ * @retval 0 The sampling is started.
+ * @retval -EINVAL The sampling rate is not supported.
+ * @retval -EALREADY The sampling is already started.
+ * @retval -EBUSY The timer could not be allocated.
+ */
+int cpu_sampler_start(uint32_t rate);
+
+/** @brief Stop sampling.
+ *
+ * The histogram is kept.
+ */
+void cpu_sampler_stop(void);
+
+/** @brief Clear the histogram and the sample counters. */
+void cpu_sampler_reset(void);
+
+/** @brief Get the number of samples taken since the last reset.
+ *
+ * @param[out] lost Number of samples that were not added to the histogram
+ *		    because it was full. Can be NULL.
+ *
+ * @return Number of samples, including the lost ones.
+ */
+uint32_t cpu_sampler_samples_get(uint32_t *lost);
+
+/** @brief Get the histogram entries with the most samples.
+ *
+ * @param[out] entries Entries, sorted by the number of samples, highest first.
+ * @param max_entries Maximum number of entries to get.
+ *
+ * @return Number of entries written to @p entries.
+ */
+size_t cpu_sampler_top_get(struct cpu_sampler_entry *entries, size_t max_entries);
+
+/** @} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __CPU_SAMPLER_H */
@@ -57,6 +57,29 @@ size_t ei_wrapper_get_frame_size(void);
  */
 size_t ei_wrapper_get_window_size(void);
 
+/** Get the size of the input slice.
+ *
+ * In continuous mode, the input window is split into slices and the DSP
+ * features are calculated separately for every slice. Otherwise, the slice
+ * size is equal to the input window size.
+ *
+ * @return Size of the input slice, expressed as a number of floating-point
+ *         values.
+ */
+size_t ei_wrapper_get_slice_size(void);
+
+
+/** Get the maximum number of predictions that can be started at a time.
+ *
+ * In pipeline mode, the DSP stage of a prediction can run while the previous
+ * prediction is classified. Otherwise, only one prediction can be started at
+ * a time.
+ *
+ * @return Maximum number of predictions that can be started before the result
+ *         of the first of them is provided.
+ */
+size_t ei_wrapper_get_pipeline_depth(void);
+
 
 /** Get input data sampling frequency of the classifier.
  *
@@ -87,6 +110,9 @@ const char *ei_wrapper_get_classifier_label(size_t idx);
  *
  * Size of the added data must be divisible by input frame size.
  *
+ * The function does not use locks and can be called from an interrupt
+ * context. The data must be added from a single context at a time.
+ *
  * @param[in] data       Pointer to the buffer with input data.
  * @param[in] data_size  Size of the data (number of floating-point values).
  *
@@ -104,6 +130,15 @@ int ei_wrapper_add_data(const float *data, size_t data_size);
  *
  * If the wrapper is waiting for data, the prediction is cancelled.
  *
+ * The function must not be called concurrently with
+ * @ref ei_wrapper_start_prediction.
+ *
+ * In pipeline mode, the data can be cleared only if none of the started
+ * predictions reached the DSP stage. The started predictions are then
+ * cancelled. If a result is being provided by the callback and there are
+ * predictions to cancel, the function fails unless it is called from the
+ * callback.
+ *
  * @param[out] cancelled  Pointer to the variable that is used to store information
  *                        if prediction was cancelled.
  *
@@ -118,6 +153,18 @@ int ei_wrapper_clear_data(bool *cancelled);
  * If there is not enough data in the input buffer, the prediction start is
  * delayed until the missing data is added.
  *
+ * The function must not be called concurrently with
+ * @ref ei_wrapper_clear_data or with itself.
+ *
+ * In continuous mode, only the slices of data that were added to the input
+ * window by the shift are processed. The shift smaller than the input window
+ * must be a multiple of the slice size (see @ref ei_wrapper_get_slice_size).
+ *
+ * In pipeline mode, the function can be called again before the result of the
+ * previous prediction is provided (see @ref ei_wrapper_get_pipeline_depth).
+ * The window shift is then relative to the input window of the previous
+ * prediction. The results are provided in order.
+ *
  * @param[in] window_shift  Number of windows the input window is shifted before
  *                          prediction.
  * @param[in] frame_shift   Number of frames the input window is shifted before
@@ -175,6 +222,9 @@ int ei_wrapper_get_anomaly(float *anomaly);
  * If calculating the anomaly value is not supported, anomaly_time is set to
  * the value of -1.
  *
+ * In continuous mode, the DSP time covers all of the slices processed for the
+ * prediction.
+ *
  * @param[out] dsp_time            Pointer to the variable that is used to store
  *                                 the dsp time.
  * @param[out] classification_time Pointer to the variable that is used to store
@@ -189,6 +239,24 @@ int ei_wrapper_get_timing(int *dsp_time, int *classification_time,
 			  int *anomaly_time);
 
 
+/** Get the time at which the input window of the result was complete.
+ *
+ * The timestamp is taken when the input window is complete and the prediction
+ * is requested. The difference between the current time and the timestamp is
+ * the latency of the result.
+ *
+ * This function can be executed only from the wrapper's callback context.
+ * Otherwise, it returns a (negative) error code.
+ *
+ * @param[out] timestamp  Pointer to the variable that is used to store
+ *                        the uptime in milliseconds.
+ *
+ * @retval 0       On success.
+ * @retval -EACCES If function is executed from other context that the wrapper's callback.
+ */
+int ei_wrapper_get_window_timestamp(int64_t *timestamp);
+
+
 /** Initialize the Edge Impulse wrapper.
  *
  * @param[in] cb Callback used to receive results.
@@ -43,6 +43,12 @@ enum location_req_mode {
 	LOCATION_REQ_MODE_FALLBACK = 0,
 	/** All requested methods are used sequentially. */
 	LOCATION_REQ_MODE_ALL,
+	/**
+	 * All requested methods are started at the same time. The first location that meets
+	 * the accuracy given in location_config.race_accuracy is reported and the other methods
+	 * are cancelled. Requires CONFIG_LOCATION_REQ_MODE_RACE.
+	 */
+	LOCATION_REQ_MODE_RACE,
 };
 
 /** Event IDs. */
@@ -258,6 +264,15 @@ struct location_config {
 	 * @brief Location acquisition mode.
 	 */
 	enum location_req_mode mode;
+
+	/**
+	 * @brief Required accuracy (in meters) in LOCATION_REQ_MODE_RACE.
+	 *
+	 * @details The first location with this accuracy or better ends the request. If none of
+	 * the locations meets the accuracy, the most accurate one is reported once all methods
+	 * have finished. Set to 0 to accept the first location regardless of its accuracy.
+	 */
+	float race_accuracy;
 };
 
 /**
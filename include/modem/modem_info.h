@@ -257,6 +257,16 @@ int modem_info_json_object_encode(struct modem_param_info *modem,
  */
 int modem_info_params_get(struct modem_param_info *modem_param);
 
+/** @brief Invalidate the snapshot of modem responses.
+ *
+ * The following requests read the data from the modem again. Call this
+ * after changing the modem state in a way that is not reported by a
+ * notification, for example after changing the functional mode.
+ *
+ * Does nothing if CONFIG_MODEM_INFO_SNAPSHOT is disabled.
+ */
+void modem_info_snapshot_invalidate(void);
+
 /** @} */
 
 #ifdef __cplusplus
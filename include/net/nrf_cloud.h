@@ -111,6 +111,20 @@ enum nrf_cloud_evt_type {
 	NRF_CLOUD_EVT_FOTA_DONE,
 	/** An error occurred during the FOTA update. */
 	NRF_CLOUD_EVT_FOTA_ERROR,
+	/** The device started receiving data that does not fit in the payload
+	 *  buffer. The status is the total length of the data.
+	 *  Only sent when @kconfig{CONFIG_NRF_CLOUD_MQTT_RX_STREAM} is enabled.
+	 */
+	NRF_CLOUD_EVT_RX_DATA_BEGIN,
+	/** A chunk of the data announced by @ref NRF_CLOUD_EVT_RX_DATA_BEGIN
+	 *  was received. The status is the offset of the chunk in the data.
+	 */
+	NRF_CLOUD_EVT_RX_DATA_CHUNK,
+	/** Reception of the data announced by @ref NRF_CLOUD_EVT_RX_DATA_BEGIN
+	 *  ended. The status is 0 if all the data was received, otherwise
+	 *  a positive error code.
+	 */
+	NRF_CLOUD_EVT_RX_DATA_END,
 	/** There was an error communicating with the cloud. */
 	NRF_CLOUD_EVT_ERROR = 0xFF
 };
@@ -585,6 +599,8 @@ int nrf_cloud_connect(const struct nrf_cloud_connect_param *param);
  *
  * @retval 0       If successful.
  * @retval -EACCES Cloud connection is not established; wait for @ref NRF_CLOUD_EVT_READY.
+ * @retval -ENOBUFS @kconfig{CONFIG_NRF_CLOUD_MQTT_OUTBOX_WINDOW} messages are waiting for
+ *                  acknowledgment; try again when one has been acknowledged.
  *                 Otherwise, a (negative) error code is returned.
  */
 int nrf_cloud_sensor_data_send(const struct nrf_cloud_sensor_data *param);
@@ -636,6 +652,9 @@ int nrf_cloud_sensor_data_stream(const struct nrf_cloud_sensor_data *param);
  *
  * @retval 0       If successful.
  * @retval -EACCES Cloud connection is not established; wait for @ref NRF_CLOUD_EVT_READY.
+ * @retval -ENOBUFS The message uses QoS 1 and @kconfig{CONFIG_NRF_CLOUD_MQTT_OUTBOX_WINDOW}
+ *                  messages are waiting for acknowledgment; try again when one has been
+ *                  acknowledged.
  *                 Otherwise, a (negative) error code is returned.
  */
 int nrf_cloud_send(const struct nrf_cloud_tx_data *msg);
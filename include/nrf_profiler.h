@@ -48,7 +48,7 @@ extern struct nrf_profiler_event_enabled_bm _nrf_profiler_event_enabled_bm;
 
 /** @brief Number of event types registered in the Profiler.
  */
-extern uint8_t nrf_profiler_num_events;
+extern uint16_t nrf_profiler_num_events;
 
 
 /** @brief Data types for profiling.
@@ -61,7 +61,9 @@ enum nrf_profiler_arg {
 	NRF_PROFILER_ARG_U32,
 	NRF_PROFILER_ARG_S32,
 	NRF_PROFILER_ARG_STRING,
-	NRF_PROFILER_ARG_TIMESTAMP
+	NRF_PROFILER_ARG_TIMESTAMP,
+	/** Memory address, added with @ref nrf_profiler_log_add_mem_address. */
+	NRF_PROFILER_ARG_MEM_ADDRESS
 };
 
 
@@ -273,7 +275,8 @@ static inline void nrf_profiler_log_encode_string(struct log_event_buf *buf,
 
 /** @brief Encode and add the event's address in memory to the buffer.
  *
- * This information is used for event identification.
+ * This information is used for event identification. The value must be
+ * registered as @ref NRF_PROFILER_ARG_MEM_ADDRESS.
  *
  * @note The buffer must be initialized with @ref nrf_profiler_log_start
  *       before calling this function.
@@ -24,6 +24,24 @@ BUILD_ASSERT(CONFIG_EI_WRAPPER_THREAD_STACK_SIZE > 0);
 #define THREAD_STACK_SIZE	CONFIG_EI_WRAPPER_THREAD_STACK_SIZE
 #define THREAD_PRIORITY 	CONFIG_EI_WRAPPER_THREAD_PRIORITY
 #define DEBUG_MODE		IS_ENABLED(CONFIG_EI_WRAPPER_DEBUG_MODE)
+#define CONTINUOUS_MODE		IS_ENABLED(CONFIG_EI_WRAPPER_CONTINUOUS)
+#define MAF_ENABLED		IS_ENABLED(CONFIG_EI_WRAPPER_CONTINUOUS_MAF)
+
+#ifdef CONFIG_EI_WRAPPER_PIPELINE
+#define PIPELINE_DEPTH		CONFIG_EI_WRAPPER_PIPELINE_DEPTH
+#define CLASSIFIER_STACK_SIZE	CONFIG_EI_WRAPPER_CLASSIFIER_THREAD_STACK_SIZE
+#define CLASSIFIER_PRIORITY	CONFIG_EI_WRAPPER_CLASSIFIER_THREAD_PRIORITY
+#else
+#define PIPELINE_DEPTH		1
+#endif /* CONFIG_EI_WRAPPER_PIPELINE */
+
+/* In continuous mode, the DSP features are calculated per slice of the input window. */
+#define INPUT_SLICE_SIZE	(CONTINUOUS_MODE ? \
+				 (EI_CLASSIFIER_SLICE_SIZE * INPUT_FRAME_SIZE) : \
+				 INPUT_WINDOW_SIZE)
+
+/* Positions in the input buffer wrap around at a multiple of the buffer size. */
+#define POS_WRAP		((UINT32_MAX / DATA_BUFFER_SIZE) * DATA_BUFFER_SIZE)
 
 enum state {
 	STATE_DISABLED,
@@ -32,14 +50,41 @@ enum state {
 	STATE_READY,
 };
 
+/* Single-producer, single-consumer ring buffer. The producer owns append_pos
+ * and the consumer owns process_pos. The data written to the beginning of the
+ * buffer is mirrored after its end, so the input window is always contiguous.
+ */
 struct data_buffer {
-	float buf[DATA_BUFFER_SIZE];
+	float buf[DATA_BUFFER_SIZE + INPUT_WINDOW_SIZE];
+	atomic_t append_pos;
+	atomic_t process_pos;
 	size_t process_idx;
-	size_t append_idx;
-	size_t wait_data_size;
+	size_t new_data_size;
+	bool features_cached;
+	atomic_t state;
+};
+
+#ifdef CONFIG_EI_WRAPPER_PIPELINE
+/* DSP features of an input window that waits for the classification. */
+struct features_buffer {
+	float buf[EI_CLASSIFIER_NN_INPUT_FRAME_SIZE];
+	int64_t window_time;
+	int dsp_time;
+	EI_IMPULSE_ERROR err;
+};
+
+/* Predictions that were started, but whose results were not yet provided.
+ * The window shifts of predictions that wait for the input buffer are queued.
+ */
+struct pipeline {
 	struct k_spinlock lock;
-	enum state state;
+	size_t started_cnt;
+	size_t shift_queue[PIPELINE_DEPTH];
+	size_t shift_head;
+	size_t shift_cnt;
+	bool in_callback;
 };
+#endif /* CONFIG_EI_WRAPPER_PIPELINE */
 
 static K_THREAD_STACK_DEFINE(thread_stack, THREAD_STACK_SIZE);
 static struct k_thread thread;
@@ -47,114 +92,149 @@ static k_tid_t ei_thread_id;
 
 static K_SEM_DEFINE(ei_sem, 0, 1);
 
+#ifdef CONFIG_EI_WRAPPER_PIPELINE
+static K_THREAD_STACK_DEFINE(classifier_thread_stack, CLASSIFIER_STACK_SIZE);
+static struct k_thread classifier_thread;
+
+static K_SEM_DEFINE(features_sem, 0, PIPELINE_DEPTH);
+
+static struct features_buffer features[PIPELINE_DEPTH];
+static struct pipeline pipeline;
+#endif /* CONFIG_EI_WRAPPER_PIPELINE */
+
 static struct data_buffer ei_input;
 static ei_impulse_result_t ei_result;
 static int cur_res_idx;
+static size_t signal_offset;
 static ei_wrapper_result_ready_cb user_cb;
+static int64_t window_ready_time;
+static int64_t result_window_time;
 
 
 BUILD_ASSERT(DATA_BUFFER_SIZE > INPUT_WINDOW_SIZE);
 BUILD_ASSERT(INPUT_WINDOW_SIZE % INPUT_FRAME_SIZE == 0);
+BUILD_ASSERT(INPUT_WINDOW_SIZE % INPUT_SLICE_SIZE == 0);
 
 
-static size_t buf_get_collected_data_count(const struct data_buffer *b)
+static uint32_t pos_add(uint32_t pos, size_t len)
 {
-	if (b->append_idx >= b->process_idx) {
-		return b->append_idx - b->process_idx;
+	uint64_t res = (uint64_t)pos + len;
+
+	while (res >= POS_WRAP) {
+		res -= POS_WRAP;
 	}
 
-	return (ARRAY_SIZE(b->buf) - b->process_idx) + b->append_idx;
+	return res;
 }
 
-static size_t buf_calc_free_space(const struct data_buffer *b)
+static int32_t pos_diff(uint32_t pos, uint32_t ref)
 {
-	if (b->wait_data_size > 0) {
-		return b->wait_data_size + ARRAY_SIZE(b->buf) -
-		       INPUT_WINDOW_SIZE - 1;
+	int64_t diff = (int64_t)pos - ref;
+
+	if (diff > (int64_t)(POS_WRAP / 2)) {
+		diff -= POS_WRAP;
+	} else if (diff < -(int64_t)(POS_WRAP / 2)) {
+		diff += POS_WRAP;
 	}
 
-	return ARRAY_SIZE(b->buf) - buf_get_collected_data_count(b) - 1;
+	return diff;
 }
 
-static void buf_processing_end(struct data_buffer *b)
+static bool buf_window_ready(const struct data_buffer *b)
 {
-	k_spinlock_key_t key = k_spin_lock(&b->lock);
+	return pos_diff(atomic_get(&b->append_pos), atomic_get(&b->process_pos)) >=
+	       (int32_t)INPUT_WINDOW_SIZE;
+}
 
-	__ASSERT_NO_MSG(b->state == STATE_PROCESSING);
-	b->state = STATE_READY;
+static bool buf_try_start_processing(struct data_buffer *b)
+{
+	/* Both producer and consumer may try, only one of them succeeds. */
+	return (atomic_get(&b->state) == STATE_WAITING_FOR_DATA) &&
+	       buf_window_ready(b) &&
+	       atomic_cas(&b->state, STATE_WAITING_FOR_DATA, STATE_PROCESSING);
+}
 
-	k_spin_unlock(&b->lock, key);
+static size_t buf_calc_free_space(const struct data_buffer *b)
+{
+	int32_t used = pos_diff(atomic_get(&b->append_pos), atomic_get(&b->process_pos));
+
+	/* Data appended before the window start is skipped, but it is still stored. */
+	return DATA_BUFFER_SIZE - 1 - MAX(used, 0);
 }
 
-static int buf_cleanup(struct data_buffer *b, bool *cancelled)
+static void buf_write(struct data_buffer *b, size_t idx, const float *data, size_t len)
 {
-	int err = 0;
+	while (len > 0) {
+		size_t copy_cnt = MIN(len, DATA_BUFFER_SIZE - idx);
 
-	*cancelled = false;
+		memcpy(&b->buf[idx], data, copy_cnt * sizeof(b->buf[0]));
 
-	k_spinlock_key_t key = k_spin_lock(&b->lock);
+		if (idx < INPUT_WINDOW_SIZE) {
+			size_t mirror_cnt = MIN(copy_cnt, INPUT_WINDOW_SIZE - idx);
 
-	if (b->state == STATE_PROCESSING) {
-		err = -EBUSY;
-	} else {
-		if (b->state == STATE_WAITING_FOR_DATA) {
-			*cancelled = true;
+			memcpy(&b->buf[DATA_BUFFER_SIZE + idx], data,
+			       mirror_cnt * sizeof(b->buf[0]));
 		}
-		b->process_idx = 0;
-		b->append_idx = 0;
-		b->wait_data_size = 0;
-		b->state = STATE_READY;
+
+		data += copy_cnt;
+		len -= copy_cnt;
+		idx = 0;
 	}
+}
 
-	k_spin_unlock(&b->lock, key);
+static void buf_processing_end(struct data_buffer *b, bool features_cached)
+{
+	__ASSERT_NO_MSG(atomic_get(&b->state) == STATE_PROCESSING);
 
-	return err;
+	b->features_cached = features_cached;
+	atomic_set(&b->state, STATE_READY);
 }
 
-static int buf_append(struct data_buffer *b, const float *data, size_t len,
-		      bool *process_buf)
+static int buf_cleanup(struct data_buffer *b, bool *cancelled)
 {
-	*process_buf = false;
+	*cancelled = false;
 
-	k_spinlock_key_t key = k_spin_lock(&b->lock);
+	atomic_val_t state = atomic_get(&b->state);
 
-	if (buf_calc_free_space(b) < len) {
-		k_spin_unlock(&b->lock, key);
-		return -ENOMEM;
+	if (state == STATE_PROCESSING) {
+		return -EBUSY;
 	}
 
-	size_t cur_idx = b->append_idx;
-	size_t new_idx = b->append_idx + len;
-	bool looped = false;
-
-	if (b->wait_data_size > 0) {
-		if (b->wait_data_size > len) {
-			b->wait_data_size -= len;
-		} else {
-			b->wait_data_size = 0;
-			b->state = STATE_PROCESSING;
-			*process_buf = true;
+	if (state == STATE_WAITING_FOR_DATA) {
+		if (!atomic_cas(&b->state, STATE_WAITING_FOR_DATA, STATE_READY)) {
+			/* Producer has just completed the input window. */
+			return -EBUSY;
 		}
+		*cancelled = true;
 	}
 
-	if (new_idx >= ARRAY_SIZE(b->buf)) {
-		new_idx -= ARRAY_SIZE(b->buf);
-		looped = true;
+	/* Drop the buffered data. */
+	uint32_t pos = atomic_get(&b->append_pos);
+
+	atomic_set(&b->process_pos, pos);
+	b->process_idx = pos % DATA_BUFFER_SIZE;
+	b->features_cached = false;
+	atomic_set(&b->state, STATE_READY);
+
+	return 0;
+}
+
+static int buf_append(struct data_buffer *b, const float *data, size_t len,
+		      bool *process_buf)
+{
+	if (buf_calc_free_space(b) < len) {
+		*process_buf = false;
+		return -ENOMEM;
 	}
 
-	b->append_idx = new_idx;
+	uint32_t pos = atomic_get(&b->append_pos);
 
-	k_spin_unlock(&b->lock, key);
+	buf_write(b, pos % DATA_BUFFER_SIZE, data, len);
 
-	if (looped) {
-		size_t copy_cnt = ARRAY_SIZE(b->buf) - cur_idx;
+	/* Publish the data to the consumer. */
+	atomic_set(&b->append_pos, pos_add(pos, len));
 
-		memcpy(&b->buf[cur_idx], data, copy_cnt * sizeof(b->buf[0]));
-		memcpy(&b->buf[0], data + copy_cnt,
-		      (len - copy_cnt) * sizeof(b->buf[0]));
-	} else {
-		memcpy(&b->buf[cur_idx], data, len * sizeof(b->buf[0]));
-	}
+	*process_buf = buf_try_start_processing(b);
 
 	return 0;
 }
@@ -165,24 +245,17 @@ static void buf_get(const struct data_buffer *b, float *b_res, size_t offset,
 	__ASSERT_NO_MSG((offset + len) <= INPUT_WINDOW_SIZE);
 
 	/* Processing index cannot change while processing is done. */
-	__ASSERT_NO_MSG(b->state == STATE_PROCESSING);
+	__ASSERT_NO_MSG(atomic_get(&b->state) == STATE_PROCESSING);
 
-	size_t read_start = b->process_idx + offset;
-	size_t read_end = read_start + len;
+	memcpy(b_res, &b->buf[b->process_idx + offset], len * sizeof(b->buf[0]));
+}
 
-	if ((read_end > ARRAY_SIZE(b->buf)) && (read_start < ARRAY_SIZE(b->buf))) {
-		size_t copy_cnt = ARRAY_SIZE(b->buf) - read_start;
+static size_t buf_get_new_data_size(const struct data_buffer *b)
+{
+	/* New data size cannot change while processing is done. */
+	__ASSERT_NO_MSG(atomic_get(&b->state) == STATE_PROCESSING);
 
-		memcpy(b_res, &b->buf[read_start],
-		       copy_cnt * sizeof(b->buf[0]));
-		memcpy(b_res + copy_cnt, &b->buf[0],
-		       (len - copy_cnt) * sizeof(b->buf[0]));
-	} else {
-		if (read_start >= ARRAY_SIZE(b->buf)) {
-			read_start -= ARRAY_SIZE(b->buf);
-		}
-		memcpy(b_res, &b->buf[read_start], len * sizeof(b->buf[0]));
-	}
+	return b->new_data_size;
 }
 
 static int buf_processing_move(struct data_buffer *b, size_t move,
@@ -190,36 +263,126 @@ static int buf_processing_move(struct data_buffer *b, size_t move,
 {
 	*process_buf = false;
 
-	k_spinlock_key_t key = k_spin_lock(&b->lock);
+	if (atomic_get(&b->state) != STATE_READY) {
+		__ASSERT_NO_MSG(atomic_get(&b->state) != STATE_DISABLED);
+		return -EBUSY;
+	}
 
-	if (b->state == STATE_READY) {
-		b->state = STATE_WAITING_FOR_DATA;
+	/* The window start must be updated before the producer may complete the window. */
+	uint32_t pos = pos_add(atomic_get(&b->process_pos), move);
+
+	atomic_set(&b->process_pos, pos);
+	b->process_idx = pos % DATA_BUFFER_SIZE;
+
+	/* Features of the data that stays in the window can be reused. */
+	if (b->features_cached && (move < INPUT_WINDOW_SIZE)) {
+		b->new_data_size = move;
 	} else {
-		__ASSERT_NO_MSG(b->state != STATE_DISABLED);
-		k_spin_unlock(&b->lock, key);
-		return -EBUSY;
+		b->new_data_size = INPUT_WINDOW_SIZE;
+	}
+
+	atomic_set(&b->state, STATE_WAITING_FOR_DATA);
+
+	*process_buf = buf_try_start_processing(b);
+
+	return 0;
+}
+
+static void processing_start(void)
+{
+	/* Only one prediction can be started at a time. */
+	window_ready_time = k_uptime_get();
+	k_sem_give(&ei_sem);
+}
+
+#ifdef CONFIG_EI_WRAPPER_PIPELINE
+static int pipeline_start(size_t sample_shift, bool *process_buf)
+{
+	int err = 0;
+	k_spinlock_key_t key = k_spin_lock(&pipeline.lock);
+
+	*process_buf = false;
+
+	if (pipeline.started_cnt >= PIPELINE_DEPTH) {
+		err = -EBUSY;
+	} else if ((pipeline.shift_cnt == 0) && (atomic_get(&ei_input.state) == STATE_READY)) {
+		err = buf_processing_move(&ei_input, sample_shift, process_buf);
+	} else {
+		/* The window is moved once the DSP stage releases the input buffer. */
+		size_t idx = (pipeline.shift_head + pipeline.shift_cnt) % PIPELINE_DEPTH;
+
+		pipeline.shift_queue[idx] = sample_shift;
+		pipeline.shift_cnt++;
+	}
+
+	if (!err) {
+		pipeline.started_cnt++;
+	}
+
+	k_spin_unlock(&pipeline.lock, key);
+
+	return err;
+}
+
+static void pipeline_dsp_finished(void)
+{
+	bool process_buf = false;
+	k_spinlock_key_t key = k_spin_lock(&pipeline.lock);
+
+	buf_processing_end(&ei_input, false);
+
+	if (pipeline.shift_cnt > 0) {
+		size_t shift = pipeline.shift_queue[pipeline.shift_head];
+
+		pipeline.shift_head = (pipeline.shift_head + 1) % PIPELINE_DEPTH;
+		pipeline.shift_cnt--;
+
+		int err = buf_processing_move(&ei_input, shift, &process_buf);
+
+		__ASSERT_NO_MSG(!err);
+		ARG_UNUSED(err);
 	}
 
-	size_t max_move = buf_get_collected_data_count(b);
+	k_spin_unlock(&pipeline.lock, key);
 
-	b->process_idx += move;
-	if (b->process_idx >= ARRAY_SIZE(b->buf)) {
-		b->process_idx -= ARRAY_SIZE(b->buf);
+	if (process_buf) {
+		processing_start();
 	}
+}
 
-	size_t processing_end_move = move + INPUT_WINDOW_SIZE;
+static int pipeline_cleanup(bool *cancelled)
+{
+	int err;
+	k_spinlock_key_t key = k_spin_lock(&pipeline.lock);
+	bool window_waiting = (atomic_get(&ei_input.state) == STATE_WAITING_FOR_DATA);
+	size_t waiting_cnt = pipeline.shift_cnt + (window_waiting ? 1 : 0);
+
+	*cancelled = false;
 
-	if (processing_end_move > max_move) {
-		b->wait_data_size = processing_end_move - max_move;
+	/* Predictions that reached the DSP stage cannot be cancelled. If the data
+	 * is cleared while a result is provided, it is up to the user to drop
+	 * the result, the same as without the pipeline. The predictions that
+	 * wait for data are then not cancelled, so that the user can tell if
+	 * the result is still provided.
+	 */
+	if ((pipeline.started_cnt > waiting_cnt) ||
+	    ((waiting_cnt > 0) && pipeline.in_callback && (k_current_get() != ei_thread_id))) {
+		err = -EBUSY;
 	} else {
-		b->state = STATE_PROCESSING;
-		*process_buf = true;
+		err = buf_cleanup(&ei_input, cancelled);
 	}
 
-	k_spin_unlock(&b->lock, key);
+	if (!err) {
+		*cancelled = *cancelled || (pipeline.shift_cnt > 0);
+		pipeline.started_cnt = 0;
+		pipeline.shift_cnt = 0;
+	}
 
-	return 0;
+	k_spin_unlock(&pipeline.lock, key);
+
+	return err;
 }
+#endif /* CONFIG_EI_WRAPPER_PIPELINE */
 
 bool ei_wrapper_classifier_has_anomaly(void)
 {
@@ -236,6 +399,16 @@ size_t ei_wrapper_get_window_size(void)
 	return INPUT_WINDOW_SIZE;
 }
 
+size_t ei_wrapper_get_slice_size(void)
+{
+	return INPUT_SLICE_SIZE;
+}
+
+size_t ei_wrapper_get_pipeline_depth(void)
+{
+	return PIPELINE_DEPTH;
+}
+
 size_t ei_wrapper_get_classifier_frequency(void)
 {
 	return INPUT_FREQUENCY;
@@ -267,7 +440,7 @@ int ei_wrapper_add_data(const float *data, size_t data_size)
 	int err = buf_append(&ei_input, data, data_size, &process_buf);
 
 	if (!err && process_buf) {
-		k_sem_give(&ei_sem);
+		processing_start();
 	}
 
 	return err;
@@ -275,7 +448,17 @@ int ei_wrapper_add_data(const float *data, size_t data_size)
 
 int ei_wrapper_clear_data(bool *cancelled)
 {
-	return buf_cleanup(&ei_input, cancelled);
+#ifdef CONFIG_EI_WRAPPER_PIPELINE
+	int err = pipeline_cleanup(cancelled);
+#else
+	int err = buf_cleanup(&ei_input, cancelled);
+#endif /* CONFIG_EI_WRAPPER_PIPELINE */
+
+	if (!err) {
+		signal_offset = 0;
+	}
+
+	return err;
 }
 
 int ei_wrapper_start_prediction(size_t window_shift, size_t frame_shift)
@@ -283,11 +466,21 @@ int ei_wrapper_start_prediction(size_t window_shift, size_t frame_shift)
 	size_t sample_shift = window_shift * ei_wrapper_get_window_size() +
 			      frame_shift * ei_wrapper_get_frame_size();
 
+	if (CONTINUOUS_MODE && (sample_shift < INPUT_WINDOW_SIZE) &&
+	    (sample_shift % INPUT_SLICE_SIZE)) {
+		return -EINVAL;
+	}
+
 	bool process_buf;
+
+#ifdef CONFIG_EI_WRAPPER_PIPELINE
+	int err = pipeline_start(sample_shift, &process_buf);
+#else
 	int err = buf_processing_move(&ei_input, sample_shift, &process_buf);
+#endif /* CONFIG_EI_WRAPPER_PIPELINE */
 
 	if (!err && process_buf) {
-		k_sem_give(&ei_sem);
+		processing_start();
 	}
 
 	return err;
@@ -295,7 +488,7 @@ int ei_wrapper_start_prediction(size_t window_shift, size_t frame_shift)
 
 static int raw_feature_get_data(size_t offset, size_t length, float *out_ptr)
 {
-	buf_get(&ei_input, out_ptr, offset, length);
+	buf_get(&ei_input, out_ptr, signal_offset + offset, length);
 
 	return 0;
 }
@@ -304,11 +497,116 @@ static void processing_finished(int err)
 {
 	__ASSERT_NO_MSG(user_cb);
 
-	buf_processing_end(&ei_input);
+	buf_processing_end(&ei_input, CONTINUOUS_MODE && !err);
 	cur_res_idx = -1;
+	result_window_time = window_ready_time;
 	user_cb(err);
 }
 
+static EI_IMPULSE_ERROR run_impulse(signal_t *signal)
+{
+	if (CONTINUOUS_MODE) {
+		return run_classifier_continuous(signal, &ei_result, DEBUG_MODE, MAF_ENABLED);
+	}
+
+	return run_classifier(signal, &ei_result, DEBUG_MODE);
+}
+
+#ifdef CONFIG_EI_WRAPPER_PIPELINE
+static EI_IMPULSE_ERROR run_dsp(signal_t *signal, float *features_buf)
+{
+	size_t out_idx = 0;
+
+	/* DSP part of run_classifier(). The signal is passed to the blocks as is,
+	 * so the blocks must use all of the input axes.
+	 */
+	for (size_t i = 0; i < ei_dsp_blocks_size; i++) {
+		ei_model_dsp_t block = ei_dsp_blocks[i];
+
+		if ((out_idx + block.n_output_features > EI_CLASSIFIER_NN_INPUT_FRAME_SIZE) ||
+		    (block.axes_size != INPUT_FRAME_SIZE)) {
+			return EI_IMPULSE_DSP_ERROR;
+		}
+
+		ei::matrix_t fm(1, block.n_output_features, &features_buf[out_idx]);
+
+		if (block.extract_fn(signal, &fm, block.config, INPUT_FREQUENCY) != EIDSP_OK) {
+			return EI_IMPULSE_DSP_ERROR;
+		}
+
+		out_idx += block.n_output_features;
+	}
+
+	return EI_IMPULSE_OK;
+}
+
+static void dsp_stage_run(signal_t *signal)
+{
+	static size_t buf_idx;
+	struct features_buffer *fb = &features[buf_idx];
+	int64_t start_time = k_uptime_get();
+
+	/* A buffer is used by at most one of the started predictions. */
+	buf_idx = (buf_idx + 1) % PIPELINE_DEPTH;
+
+	fb->window_time = window_ready_time;
+	fb->err = run_dsp(signal, fb->buf);
+	fb->dsp_time = k_uptime_delta(&start_time);
+
+	/* The next input window can be processed while the features are classified. */
+	pipeline_dsp_finished();
+	k_sem_give(&features_sem);
+}
+
+static void classifier_thread_fn(void)
+{
+	size_t buf_idx = 0;
+
+	while (true) {
+		k_sem_take(&features_sem, K_FOREVER);
+
+		struct features_buffer *fb = &features[buf_idx];
+		EI_IMPULSE_ERROR err = fb->err;
+
+		buf_idx = (buf_idx + 1) % PIPELINE_DEPTH;
+
+		if (!err) {
+			ei::matrix_t fm(1, EI_CLASSIFIER_NN_INPUT_FRAME_SIZE, fb->buf);
+
+			err = run_inference(&fm, &ei_result, DEBUG_MODE);
+			ei_result.timing.dsp = fb->dsp_time;
+		}
+
+		if (IS_ENABLED(CONFIG_EI_WRAPPER_PROFILING)) {
+			LOG_INF("dsp: %dms classification: %dms anomaly: %dms",
+				ei_result.timing.dsp,
+				ei_result.timing.classification,
+				ei_result.timing.anomaly);
+		}
+
+		if (err) {
+			LOG_ERR("run_inference err=%d", err);
+		}
+
+		k_spinlock_key_t key = k_spin_lock(&pipeline.lock);
+
+		pipeline.started_cnt--;
+		pipeline.in_callback = true;
+		k_spin_unlock(&pipeline.lock, key);
+
+		__ASSERT_NO_MSG(user_cb);
+
+		cur_res_idx = -1;
+		result_window_time = fb->window_time;
+		user_cb(err);
+
+		key = k_spin_lock(&pipeline.lock);
+		pipeline.in_callback = false;
+		k_spin_unlock(&pipeline.lock, key);
+	}
+}
+#endif /* CONFIG_EI_WRAPPER_PIPELINE */
+
 static void edge_impulse_thread_fn(void)
 {
 	signal_t features_signal;
@@ -317,20 +615,39 @@ static void edge_impulse_thread_fn(void)
 	while (true) {
 		k_sem_take(&ei_sem, K_FOREVER);
 
+		size_t new_data_size = buf_get_new_data_size(&ei_input);
+
+		/* Only the new data is passed to the library. In continuous mode, the
+		 * library calculates the DSP features for all of the new slices and runs
+		 * the classification once, for the input window that ends with the last
+		 * slice.
+		 */
+		signal_offset = INPUT_WINDOW_SIZE - new_data_size;
 		features_signal.get_data = &raw_feature_get_data;
-		features_signal.total_length = INPUT_WINDOW_SIZE;
+		features_signal.total_length = new_data_size;
 
 		if (IS_ENABLED(CONFIG_EI_WRAPPER_PROFILING)) {
 			start_time = k_uptime_get();
 		}
 
-		/* Invoke the impulse. */
-		EI_IMPULSE_ERROR err = run_classifier(&features_signal,
-						      &ei_result, DEBUG_MODE);
+		if (CONTINUOUS_MODE && (new_data_size == INPUT_WINDOW_SIZE)) {
+			/* Drop the features cached for the previous window. */
+			run_classifier_init();
+		}
+
+#ifdef CONFIG_EI_WRAPPER_PIPELINE
+		dsp_stage_run(&features_signal);
+		continue;
+#endif /* CONFIG_EI_WRAPPER_PIPELINE */
+
+		EI_IMPULSE_ERROR err = run_impulse(&features_signal);
+
 		if (IS_ENABLED(CONFIG_EI_WRAPPER_PROFILING)) {
 			int64_t delta = k_uptime_delta(&start_time);
 
-			LOG_INF("run_classifier execution time: %dms", (int32_t)delta);
+			LOG_INF("run_classifier execution time: %dms (%zu of %zu slices)",
+				(int32_t)delta, new_data_size / INPUT_SLICE_SIZE,
+				(size_t)(INPUT_WINDOW_SIZE / INPUT_SLICE_SIZE));
 			LOG_INF("sampling: %dms dsp: %dms classification: %dms anomaly: %dms",
 				ei_result.timing.sampling,
 				ei_result.timing.dsp,
@@ -456,6 +773,20 @@ int ei_wrapper_get_timing(int *dsp_time, int *classification_time, int *anomaly_
 	return 0;
 }
 
+int ei_wrapper_get_window_timestamp(int64_t *timestamp)
+{
+	if (!can_read_result()) {
+		LOG_WRN("Result can be read only from callback context");
+		return -EACCES;
+	}
+
+	if (timestamp) {
+		*timestamp = result_window_time;
+	}
+
+	return 0;
+}
+
 int ei_wrapper_init(ei_wrapper_result_ready_cb cb)
 {
 	if (!cb) {
@@ -481,5 +812,15 @@ int ei_wrapper_init(ei_wrapper_result_ready_cb cb)
 				       THREAD_PRIORITY, 0, K_NO_WAIT);
 	k_thread_name_set(&thread, "edge_impulse_thread");
 
+#ifdef CONFIG_EI_WRAPPER_PIPELINE
+	/* Results are provided by the classifier thread. */
+	ei_thread_id = k_thread_create(&classifier_thread, classifier_thread_stack,
+				       CLASSIFIER_STACK_SIZE,
+				       (k_thread_entry_t)classifier_thread_fn,
+				       NULL, NULL, NULL,
+				       CLASSIFIER_PRIORITY, 0, K_NO_WAIT);
+	k_thread_name_set(&classifier_thread, "edge_impulse_classifier_thread");
+#endif /* CONFIG_EI_WRAPPER_PIPELINE */
+
 	return 0;
 }
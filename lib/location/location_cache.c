@@ -0,0 +1,335 @@
+/*
+ * Copyright (c) 2022 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/crc.h>
+#include <modem/location.h>
+#if defined(CONFIG_LOCATION_CACHE_SETTINGS)
+#include <zephyr/settings/settings.h>
+#include <date_time.h>
+#endif
+
+#include "location_cache.h"
+
+LOG_MODULE_DECLARE(location, CONFIG_LOCATION_LOG_LEVEL);
+
+#define SETTINGS_NAME "location"
+#define SETTINGS_KEY_CACHE "cache"
+#define SETTINGS_FULL_CACHE SETTINGS_NAME "/" SETTINGS_KEY_CACHE
+
+struct location_cache_entry {
+	/** Radio environment the location was resolved from. */
+	struct location_cache_fingerprint fingerprint;
+
+	/** Time (in milliseconds) when the location was resolved. */
+	int64_t timestamp;
+
+	/** Geodetic latitude (deg) in WGS-84. */
+	double latitude;
+
+	/** Geodetic longitude (deg) in WGS-84. */
+	double longitude;
+
+	/** Location accuracy in meters (1-sigma). */
+	float accuracy;
+
+	/** Value of use_counter when the entry was last used. */
+	uint32_t last_used;
+
+	/** Location method, zero for an unused entry. */
+	uint8_t method;
+};
+
+static struct location_cache_entry entries[CONFIG_LOCATION_CACHE_SIZE];
+static uint32_t use_counter;
+static struct location_cache_stats stats;
+
+/* Protects the cache. Methods may run concurrently in their own work queues. */
+static K_MUTEX_DEFINE(cache_mutex);
+
+#if defined(CONFIG_LOCATION_CACHE_SETTINGS)
+static int location_cache_settings_set(const char *key, size_t len_rd,
+				       settings_read_cb read_cb, void *cb_arg)
+{
+	ssize_t len;
+
+	if (!key || strcmp(key, SETTINGS_KEY_CACHE)) {
+		return 0;
+	}
+
+	if (len_rd != sizeof(entries)) {
+		/* Stored with a different cache configuration, start from scratch */
+		LOG_WRN("Ignoring stored location cache of wrong size");
+		return 0;
+	}
+
+	len = read_cb(cb_arg, entries, sizeof(entries));
+	if (len != sizeof(entries)) {
+		LOG_ERR("Failed to read location cache: %d", (int)len);
+		memset(entries, 0, sizeof(entries));
+		return 0;
+	}
+
+	for (int i = 0; i < ARRAY_SIZE(entries); i++) {
+		use_counter = MAX(use_counter, entries[i].last_used);
+	}
+
+	return 0;
+}
+
+SETTINGS_STATIC_HANDLER_DEFINE(location_cache, SETTINGS_NAME, NULL,
+			       location_cache_settings_set, NULL, NULL);
+
+static void location_cache_save(void)
+{
+	int err = settings_save_one(SETTINGS_FULL_CACHE, entries, sizeof(entries));
+
+	if (err) {
+		LOG_ERR("Failed to store location cache: %d", err);
+	}
+}
+
+static int location_cache_time_get(int64_t *time)
+{
+	/* Uptime cannot be compared across reboots. */
+	return date_time_now(time);
+}
+#else
+static void location_cache_save(void)
+{
+}
+
+static int location_cache_time_get(int64_t *time)
+{
+	*time = k_uptime_get();
+
+	return 0;
+}
+#endif /* CONFIG_LOCATION_CACHE_SETTINGS */
+
+int location_cache_init(void)
+{
+#if defined(CONFIG_LOCATION_CACHE_SETTINGS)
+	int err;
+
+	err = settings_subsys_init();
+	if (err) {
+		LOG_ERR("Settings init failed: %d", err);
+		return err;
+	}
+
+	err = settings_load_subtree(settings_handler_location_cache.name);
+	if (err) {
+		LOG_ERR("Cannot load location cache: %d", err);
+		return err;
+	}
+#endif
+	return 0;
+}
+
+void location_cache_fingerprint_init(struct location_cache_fingerprint *fingerprint,
+				     uint32_t key)
+{
+	memset(fingerprint, 0, sizeof(*fingerprint));
+	fingerprint->key = key;
+}
+
+void location_cache_fingerprint_add(struct location_cache_fingerprint *fingerprint,
+				    const void *id, size_t len)
+{
+	uint32_t hash = crc32_ieee(id, len);
+	int pos = 0;
+
+	while ((pos < fingerprint->id_count) && (fingerprint->ids[pos] < hash)) {
+		pos++;
+	}
+
+	if ((pos < fingerprint->id_count) && (fingerprint->ids[pos] == hash)) {
+		/* Already added */
+		return;
+	}
+
+	if (pos == ARRAY_SIZE(fingerprint->ids)) {
+		/* Larger than all the kept hashes */
+		return;
+	}
+
+	if (fingerprint->id_count < ARRAY_SIZE(fingerprint->ids)) {
+		fingerprint->id_count++;
+	}
+
+	memmove(&fingerprint->ids[pos + 1], &fingerprint->ids[pos],
+		(fingerprint->id_count - pos - 1) * sizeof(fingerprint->ids[0]));
+	fingerprint->ids[pos] = hash;
+}
+
+/* Returns the Jaccard similarity of the fingerprints in percent. */
+static uint8_t location_cache_similarity(const struct location_cache_fingerprint *a,
+					 const struct location_cache_fingerprint *b)
+{
+	int i = 0;
+	int j = 0;
+	int common = 0;
+
+	if (a->key != b->key) {
+		return 0;
+	}
+
+	if ((a->id_count == 0) && (b->id_count == 0)) {
+		return 100;
+	}
+
+	/* Both arrays are sorted */
+	while ((i < a->id_count) && (j < b->id_count)) {
+		if (a->ids[i] == b->ids[j]) {
+			common++;
+			i++;
+			j++;
+		} else if (a->ids[i] < b->ids[j]) {
+			i++;
+		} else {
+			j++;
+		}
+	}
+
+	return (common * 100) / (a->id_count + b->id_count - common);
+}
+
+static bool location_cache_entry_is_stale(const struct location_cache_entry *entry,
+					  int64_t now)
+{
+	return (now - entry->timestamp) > (CONFIG_LOCATION_CACHE_MAX_AGE * MSEC_PER_SEC);
+}
+
+int location_cache_get(enum location_method method,
+		       const struct location_cache_fingerprint *fingerprint,
+		       struct location_data *location)
+{
+	struct location_cache_entry *best = NULL;
+	uint8_t best_similarity = 0;
+	uint8_t similarity;
+	int64_t now;
+
+	k_mutex_lock(&cache_mutex, K_FOREVER);
+
+	if (location_cache_time_get(&now) == 0) {
+		for (int i = 0; i < ARRAY_SIZE(entries); i++) {
+			if (entries[i].method != method) {
+				continue;
+			}
+
+			if (location_cache_entry_is_stale(&entries[i], now)) {
+				entries[i].method = 0;
+				continue;
+			}
+
+			similarity = location_cache_similarity(&entries[i].fingerprint,
+							       fingerprint);
+			if ((similarity >= CONFIG_LOCATION_CACHE_MIN_SIMILARITY) &&
+			    ((best == NULL) || (similarity > best_similarity) ||
+			     ((similarity == best_similarity) &&
+			      (entries[i].timestamp > best->timestamp)))) {
+				best = &entries[i];
+				best_similarity = similarity;
+			}
+		}
+	}
+
+	if (best == NULL) {
+		stats.misses++;
+		k_mutex_unlock(&cache_mutex);
+		return -ENOENT;
+	}
+
+	LOG_DBG("Location cache hit with %d%% similarity", best_similarity);
+
+	best->last_used = ++use_counter;
+	stats.hits++;
+
+	location->method = method;
+	location->latitude = best->latitude;
+	location->longitude = best->longitude;
+	location->accuracy = best->accuracy;
+
+	k_mutex_unlock(&cache_mutex);
+
+	return 0;
+}
+
+void location_cache_put(enum location_method method,
+			const struct location_cache_fingerprint *fingerprint,
+			const struct location_data *location)
+{
+	struct location_cache_entry *entry = NULL;
+	int64_t now;
+
+	k_mutex_lock(&cache_mutex, K_FOREVER);
+
+	if (location_cache_time_get(&now) != 0) {
+		LOG_DBG("Time not known, location not cached");
+		k_mutex_unlock(&cache_mutex);
+		return;
+	}
+
+	/* Replace a similar entry, use a free entry, or evict the least recently used one */
+	for (int i = 0; i < ARRAY_SIZE(entries); i++) {
+		if ((entries[i].method == method) &&
+		    (location_cache_similarity(&entries[i].fingerprint, fingerprint) >=
+		     CONFIG_LOCATION_CACHE_MIN_SIMILARITY)) {
+			entry = &entries[i];
+			break;
+		}
+	}
+
+	for (int i = 0; (entry == NULL) && (i < ARRAY_SIZE(entries)); i++) {
+		if ((entries[i].method == 0) || location_cache_entry_is_stale(&entries[i], now)) {
+			entry = &entries[i];
+		}
+	}
+
+	if (entry == NULL) {
+		entry = &entries[0];
+		for (int i = 1; i < ARRAY_SIZE(entries); i++) {
+			if (entries[i].last_used < entry->last_used) {
+				entry = &entries[i];
+			}
+		}
+	}
+
+	entry->fingerprint = *fingerprint;
+	entry->timestamp = now;
+	entry->latitude = location->latitude;
+	entry->longitude = location->longitude;
+	entry->accuracy = location->accuracy;
+	entry->last_used = ++use_counter;
+	entry->method = method;
+
+	location_cache_save();
+
+	k_mutex_unlock(&cache_mutex);
+}
+
+void location_cache_clear(void)
+{
+	k_mutex_lock(&cache_mutex, K_FOREVER);
+
+	memset(entries, 0, sizeof(entries));
+	memset(&stats, 0, sizeof(stats));
+	use_counter = 0;
+
+	location_cache_save();
+
+	k_mutex_unlock(&cache_mutex);
+}
+
+void location_cache_stats_get(struct location_cache_stats *stats_out)
+{
+	k_mutex_lock(&cache_mutex, K_FOREVER);
+	*stats_out = stats;
+	k_mutex_unlock(&cache_mutex);
+}
@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2022 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#ifndef LOCATION_CACHE_H
+#define LOCATION_CACHE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <modem/location.h>
+
+/** Radio environment seen by the device when the location was resolved. */
+struct location_cache_fingerprint {
+	/** Identifier that must match exactly, for example the serving cell. Zero if not used. */
+	uint32_t key;
+
+	/** Number of identifiers in ids. */
+	uint8_t id_count;
+
+	/**
+	 * Hashes of the identifiers that are compared by similarity, for example neighbor cells
+	 * or Wi-Fi access points. Sorted in ascending order. If more identifiers are added than
+	 * fit in the array, the smallest hashes are kept, so that the same identifiers are
+	 * kept from similar environments.
+	 */
+	uint32_t ids[CONFIG_LOCATION_CACHE_FINGERPRINT_SIZE];
+};
+
+/** Location cache statistics. */
+struct location_cache_stats {
+	/** Number of lookups that returned a location. */
+	uint32_t hits;
+
+	/** Number of lookups that did not return a location. */
+	uint32_t misses;
+};
+
+/**
+ * @brief Initialize the location cache.
+ *
+ * @details Loads the cache from the settings if CONFIG_LOCATION_CACHE_SETTINGS is enabled.
+ *
+ * @return 0 on success, or negative error code on failure.
+ */
+int location_cache_init(void);
+
+/**
+ * @brief Initialize a fingerprint.
+ *
+ * @param[out] fingerprint Fingerprint.
+ * @param[in] key Identifier that must match exactly, or zero if not used.
+ */
+void location_cache_fingerprint_init(struct location_cache_fingerprint *fingerprint,
+				     uint32_t key);
+
+/**
+ * @brief Add an identifier to a fingerprint.
+ *
+ * @param[in,out] fingerprint Fingerprint.
+ * @param[in] id Identifier, for example a MAC address.
+ * @param[in] len Length of the identifier.
+ */
+void location_cache_fingerprint_add(struct location_cache_fingerprint *fingerprint,
+				    const void *id, size_t len);
+
+/**
+ * @brief Look up a location resolved earlier in a similar radio environment.
+ *
+ * @param[in] method Location method.
+ * @param[in] fingerprint Current fingerprint.
+ * @param[out] location Cached location. Only the method, coordinates and accuracy are filled.
+ *
+ * @retval 0 Location was found.
+ * @retval -ENOENT No location that is recent and similar enough.
+ */
+int location_cache_get(enum location_method method,
+		       const struct location_cache_fingerprint *fingerprint,
+		       struct location_data *location);
+
+/**
+ * @brief Store a location resolved by a location service.
+ *
+ * @details Replaces a similar entry, or the least recently used entry if the cache is full.
+ *
+ * @param[in] method Location method.
+ * @param[in] fingerprint Fingerprint the location was resolved from.
+ * @param[in] location Location.
+ */
+void location_cache_put(enum location_method method,
+			const struct location_cache_fingerprint *fingerprint,
+			const struct location_data *location);
+
+/** @brief Remove all entries and reset the statistics. */
+void location_cache_clear(void);
+
+/**
+ * @brief Get the cache statistics.
+ *
+ * @param[out] stats Statistics.
+ */
+void location_cache_stats_get(struct location_cache_stats *stats);
+
+#endif /* LOCATION_CACHE_H */
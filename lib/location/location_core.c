@@ -10,6 +10,9 @@
 #include <modem/location.h>
 
 #include "location_core.h"
+#if defined(CONFIG_LOCATION_CACHE)
+#include "location_cache.h"
+#endif
 #if defined(CONFIG_LOCATION_METHOD_GNSS)
 #include "method_gnss.h"
 #endif
@@ -36,14 +39,52 @@ static struct location_config current_config;
 /** Index to the current_config.methods for the currently used method. */
 static int current_method_index;
 
+#if defined(CONFIG_LOCATION_REQ_MODE_RACE)
+/***** Variables for LOCATION_REQ_MODE_RACE *****/
+
+BUILD_ASSERT(CONFIG_LOCATION_METHODS_LIST_SIZE <= 32, "Too many methods for the race bitmask");
+
+/** Mutex protecting the race state. Methods report their results from their own work queues. */
+static K_MUTEX_DEFINE(race_mutex);
+
+/** Bitmask of indexes to current_config.methods for the methods that are still running. */
+static uint32_t race_running;
+
+/** Most accurate location received so far. */
+static struct location_data race_location;
+
+/** Whether race_location holds a location. */
+static bool race_location_valid;
+
+/** Event ID of the last failed method, reported if none of the methods got a location. */
+static enum location_event_id race_failure_id;
+#endif
+
 /***** Work queue and work item definitions *****/
 
+/** Number of location methods enabled in the library configuration. */
+#define LOCATION_METHODS_SUPPORTED_COUNT \
+	(IS_ENABLED(CONFIG_LOCATION_METHOD_GNSS) + \
+	 IS_ENABLED(CONFIG_LOCATION_METHOD_CELLULAR) + \
+	 IS_ENABLED(CONFIG_LOCATION_METHOD_WIFI))
+
 #define LOCATION_CORE_STACK_SIZE 4096
 #define LOCATION_CORE_PRIORITY  5
-K_THREAD_STACK_DEFINE(location_core_stack, LOCATION_CORE_STACK_SIZE);
 
-/** Work queue for location library. Location methods can run their tasks in it. */
-static struct k_work_q location_core_work_q;
+#if defined(CONFIG_LOCATION_REQ_MODE_RACE)
+/* Each method has a work queue of its own, so that the blocking parts of one method, such as
+ * waiting for neighbor cell measurements, do not stall the other methods.
+ */
+#define LOCATION_CORE_WORK_Q_COUNT LOCATION_METHODS_SUPPORTED_COUNT
+#else
+#define LOCATION_CORE_WORK_Q_COUNT 1
+#endif
+
+K_THREAD_STACK_ARRAY_DEFINE(location_core_stack, LOCATION_CORE_WORK_Q_COUNT,
+			    LOCATION_CORE_STACK_SIZE);
+
+/** Work queues for location library. Location methods can run their tasks in them. */
+static struct k_work_q location_core_work_q[LOCATION_CORE_WORK_Q_COUNT];
 
 /** Handler for periodic location requests. */
 static void location_core_periodic_work_fn(struct k_work *work);
@@ -54,8 +95,8 @@ K_WORK_DELAYABLE_DEFINE(location_periodic_work, location_core_periodic_work_fn);
 /** Handler for timeout. */
 static void location_core_timeout_work_fn(struct k_work *work);
 
-/** Work item for timeout handler. */
-K_WORK_DELAYABLE_DEFINE(location_timeout_work, location_core_timeout_work_fn);
+/** Work items for timeouts of the methods, in the same order as in methods_supported. */
+static struct k_work_delayable location_timeout_work[LOCATION_METHODS_SUPPORTED_COUNT];
 
 /** Semaphore protecting the use of location requests. */
 K_SEM_DEFINE(location_core_sem, 1, 1);
@@ -107,6 +148,8 @@ static const struct location_method_api *methods_supported[] = {
 	NULL
 };
 
+BUILD_ASSERT(ARRAY_SIZE(methods_supported) == LOCATION_METHODS_SUPPORTED_COUNT + 1);
+
 static void location_core_current_event_data_init(enum location_method method)
 {
 	memset(&current_event_data, 0, sizeof(current_event_data));
@@ -119,18 +162,22 @@ static void location_core_current_config_clear(void)
 	memset(&current_config, 0, sizeof(current_config));
 }
 
-static const struct location_method_api *location_method_api_get(enum location_method method)
+static int location_method_index_get(enum location_method method)
 {
-	const struct location_method_api *method_api = NULL;
-
 	for (int i = 0; methods_supported[i] != NULL; i++) {
 		if (method == methods_supported[i]->method) {
-			method_api = methods_supported[i];
-			break;
+			return i;
 		}
 	}
 
-	return method_api;
+	return -1;
+}
+
+static const struct location_method_api *location_method_api_get(enum location_method method)
+{
+	int index = location_method_index_get(method);
+
+	return (index < 0) ? NULL : methods_supported[index];
 }
 
 static const char LOCATION_ACCURACY_LOW_STR[] = "low";
@@ -202,6 +249,18 @@ int location_core_init(void)
 		.name = "location_api_workq",
 	};
 
+	for (int i = 0; i < ARRAY_SIZE(location_timeout_work); i++) {
+		k_work_init_delayable(&location_timeout_work[i], location_core_timeout_work_fn);
+	}
+
+#if defined(CONFIG_LOCATION_CACHE)
+	err = location_cache_init();
+	if (err) {
+		/* Not fatal, the cache just starts empty */
+		LOG_WRN("Failed to initialize location cache, error: %d", err);
+	}
+#endif
+
 	/* location_core_work_q shall not be used in method init functions.
 	 * It's initialized after methods because a second initialization after
 	 * a failing one would result in two calls to k_work_queue_start,
@@ -218,12 +277,14 @@ int location_core_init(void)
 			methods_supported[i]->method_string);
 	}
 
-	k_work_queue_start(
-		&location_core_work_q,
-		location_core_stack,
-		K_THREAD_STACK_SIZEOF(location_core_stack),
-		LOCATION_CORE_PRIORITY,
-		&cfg);
+	for (int i = 0; i < LOCATION_CORE_WORK_Q_COUNT; i++) {
+		k_work_queue_start(
+			&location_core_work_q[i],
+			location_core_stack[i],
+			K_THREAD_STACK_SIZEOF(location_core_stack[i]),
+			LOCATION_CORE_PRIORITY,
+			&cfg);
+	}
 
 	return 0;
 }
@@ -253,6 +314,24 @@ int location_core_validate_params(const struct location_config *config)
 			return -EINVAL;
 		}
 	}
+
+	if (config->mode == LOCATION_REQ_MODE_RACE) {
+		if (!IS_ENABLED(CONFIG_LOCATION_REQ_MODE_RACE)) {
+			LOG_ERR("LOCATION_REQ_MODE_RACE requires CONFIG_LOCATION_REQ_MODE_RACE");
+			return -EINVAL;
+		}
+
+		/* Methods cannot race against themselves */
+		for (int i = 0; i < config->methods_count; i++) {
+			for (int j = i + 1; j < config->methods_count; j++) {
+				if (config->methods[i].method == config->methods[j].method) {
+					LOG_ERR("Location method (%d) given twice in race mode",
+						config->methods[i].method);
+					return -EINVAL;
+				}
+			}
+		}
+	}
 	return 0;
 }
 
@@ -260,12 +339,17 @@ void location_core_config_log(const struct location_config *config)
 {
 	enum location_method type;
 	const struct location_method_api *method_api;
+	char accuracy_str[12];
 
 	LOG_DBG("Location configuration:");
 
 	LOG_DBG("  Methods count: %d", config->methods_count);
 	LOG_DBG("  Interval: %d", config->interval);
 	LOG_DBG("  Mode: %d", config->mode);
+	if (config->mode == LOCATION_REQ_MODE_RACE) {
+		sprintf(accuracy_str, "%.01f", config->race_accuracy);
+		LOG_DBG("  Race accuracy: %s m", accuracy_str);
+	}
 	LOG_DBG("  List of methods:");
 
 	for (uint8_t i = 0; i < config->methods_count; i++) {
@@ -315,12 +399,190 @@ static void location_core_current_config_set(const struct location_config *confi
 	memcpy(&current_config, config, sizeof(struct location_config));
 }
 
+static void location_core_location_log(const struct location_data *location)
+{
+	char latitude_str[12];
+	char longitude_str[12];
+	char accuracy_str[12];
+
+	LOG_DBG("Location acquired successfully:");
+	LOG_DBG("  method: %s (%d)", (char *)location_method_api_get(
+		location->method)->method_string,
+		location->method);
+	/* Logging v1 doesn't support double and float logging. Logging v2 would support
+	 * but that's up to application to configure.
+	 */
+	sprintf(latitude_str, "%.06f", location->latitude);
+	LOG_DBG("  latitude: %s", latitude_str);
+	sprintf(longitude_str, "%.06f", location->longitude);
+	LOG_DBG("  longitude: %s", longitude_str);
+	sprintf(accuracy_str, "%.01f", location->accuracy);
+	LOG_DBG("  accuracy: %s m", accuracy_str);
+	if (location->datetime.valid) {
+		LOG_DBG("  date: %04d-%02d-%02d",
+			location->datetime.year,
+			location->datetime.month,
+			location->datetime.day);
+		LOG_DBG("  time: %02d:%02d:%02d.%03d UTC",
+			location->datetime.hour,
+			location->datetime.minute,
+			location->datetime.second,
+			location->datetime.ms);
+	}
+	LOG_DBG("  Google maps URL: https://maps.google.com/?q=%s,%s",
+		latitude_str, longitude_str);
+}
+
+static void location_core_request_done(void)
+{
+	event_handler(&current_event_data);
+
+	if (current_config.interval > 0) {
+		k_work_schedule_for_queue(
+			&location_core_work_q[0],
+			&location_periodic_work,
+			K_SECONDS(current_config.interval));
+	} else {
+		location_core_current_config_clear();
+
+		k_sem_give(&location_core_sem);
+	}
+}
+
+#if defined(CONFIG_LOCATION_REQ_MODE_RACE)
+static int location_core_race_start(void)
+{
+	const struct location_method_api *method_api;
+	int err = 0;
+
+	k_mutex_lock(&race_mutex, K_FOREVER);
+
+	race_running = 0;
+	race_location_valid = false;
+	race_failure_id = LOCATION_EVT_ERROR;
+	location_core_current_event_data_init(current_config.methods[0].method);
+
+	/* All methods are started at once. Results of the methods that are started first are
+	 * handled only after all the methods have been started, because of the mutex.
+	 */
+	for (int i = 0; i < current_config.methods_count; i++) {
+		method_api = location_method_api_get(current_config.methods[i].method);
+
+		LOG_DBG("Requesting location with '%s' method", (char *)method_api->method_string);
+		err = method_api->location_get(&current_config.methods[i]);
+		if (err) {
+			LOG_WRN("Failed to start '%s' method, error: %d",
+				(char *)method_api->method_string, err);
+			continue;
+		}
+
+		race_running |= BIT(i);
+	}
+
+	k_mutex_unlock(&race_mutex);
+
+	return (race_running != 0) ? 0 : err;
+}
+
+/* Cancels the methods that are still running. Called with race_mutex locked. */
+static void location_core_race_cancel(void)
+{
+	enum location_method method;
+
+	for (int i = 0; i < current_config.methods_count; i++) {
+		if (!(race_running & BIT(i))) {
+			continue;
+		}
+
+		method = current_config.methods[i].method;
+		LOG_DBG("Cancelling location method for '%s' method",
+			(char *)location_method_api_get(method)->method_string);
+
+		location_core_timer_stop(method);
+		(void)location_method_api_get(method)->cancel();
+	}
+
+	race_running = 0;
+}
+
+static void location_core_race_event(
+	enum location_method method,
+	enum location_event_id id,
+	const struct location_data *location)
+{
+	int index = -1;
+	bool done;
+
+	k_mutex_lock(&race_mutex, K_FOREVER);
+
+	for (int i = 0; i < current_config.methods_count; i++) {
+		if (current_config.methods[i].method == method) {
+			index = i;
+			break;
+		}
+	}
+
+	if ((index < 0) || !(race_running & BIT(index))) {
+		/* Late result of a method that has been cancelled */
+		LOG_DBG("Ignoring event from '%s' method", location_method_str(method));
+		k_mutex_unlock(&race_mutex);
+		return;
+	}
+
+	race_running &= ~BIT(index);
+	location_core_timer_stop(method);
+
+	if (location != NULL) {
+		if (!race_location_valid || (location->accuracy < race_location.accuracy)) {
+			race_location = *location;
+			race_location_valid = true;
+		}
+
+		if ((current_config.race_accuracy <= 0.0f) ||
+		    (location->accuracy <= current_config.race_accuracy)) {
+			LOG_INF("LOCATION_REQ_MODE_RACE: '%s' acquired the location first",
+				(char *)location_method_api_get(method)->method_string);
+			location_core_race_cancel();
+		}
+	} else {
+		LOG_WRN("Failed to acquire location using '%s'",
+			(char *)location_method_api_get(method)->method_string);
+		race_failure_id = id;
+	}
+
+	done = (race_running == 0);
+	if (done) {
+		if (race_location_valid) {
+			current_event_data.id = LOCATION_EVT_LOCATION;
+			current_event_data.location = race_location;
+			location_core_location_log(&current_event_data.location);
+		} else {
+			LOG_ERR("Location acquisition failed with all methods");
+			current_event_data.id = race_failure_id;
+			current_event_data.location.method = method;
+		}
+	}
+
+	k_mutex_unlock(&race_mutex);
+
+	if (done) {
+		location_core_request_done();
+	}
+}
+#endif /* CONFIG_LOCATION_REQ_MODE_RACE */
+
 static int location_core_location_get_pos(const struct location_config *config)
 {
 	int err;
 	enum location_method requested_method;
 
 	location_core_current_config_set(config);
+
+#if defined(CONFIG_LOCATION_REQ_MODE_RACE)
+	if (config->mode == LOCATION_REQ_MODE_RACE) {
+		return location_core_race_start();
+	}
+#endif
 	/* Location request starts from the first method */
 	current_method_index = 0;
 	requested_method = config->methods[current_method_index].method;
@@ -347,15 +609,49 @@ int location_core_location_get(const struct location_config *config)
 	return location_core_location_get_pos(config);
 }
 
-void location_core_event_cb_error(void)
+/* Checks that the event comes from the method that is currently used in the sequential modes.
+ * Late results of a cancelled method are ignored.
+ */
+static bool location_core_method_is_current(enum location_method method)
+{
+	if ((current_config.methods_count == 0) ||
+	    (current_config.methods[current_method_index].method != method)) {
+		LOG_DBG("Ignoring event from '%s' method", location_method_str(method));
+		return false;
+	}
+
+	return true;
+}
+
+void location_core_event_cb_error(enum location_method method)
 {
+#if defined(CONFIG_LOCATION_REQ_MODE_RACE)
+	if (current_config.mode == LOCATION_REQ_MODE_RACE) {
+		location_core_race_event(method, LOCATION_EVT_ERROR, NULL);
+		return;
+	}
+#endif
+	if (!location_core_method_is_current(method)) {
+		return;
+	}
+
 	current_event_data.id = LOCATION_EVT_ERROR;
 
 	location_core_event_cb(NULL);
 }
 
-void location_core_event_cb_timeout(void)
+void location_core_event_cb_timeout(enum location_method method)
 {
+#if defined(CONFIG_LOCATION_REQ_MODE_RACE)
+	if (current_config.mode == LOCATION_REQ_MODE_RACE) {
+		location_core_race_event(method, LOCATION_EVT_TIMEOUT, NULL);
+		return;
+	}
+#endif
+	if (!location_core_method_is_current(method)) {
+		return;
+	}
+
 	current_event_data.id = LOCATION_EVT_TIMEOUT;
 
 	location_core_event_cb(NULL);
@@ -385,46 +681,29 @@ void location_core_event_cb_pgps_request(const struct gps_pgps_request *request)
 
 void location_core_event_cb(const struct location_data *location)
 {
-	char latitude_str[12];
-	char longitude_str[12];
-	char accuracy_str[12];
 	enum location_method requested_method;
 	enum location_method previous_method;
 	int err;
 
-	k_work_cancel_delayable(&location_timeout_work);
+#if defined(CONFIG_LOCATION_REQ_MODE_RACE)
+	if (current_config.mode == LOCATION_REQ_MODE_RACE) {
+		location_core_race_event(location->method, LOCATION_EVT_LOCATION, location);
+		return;
+	}
+#endif
+	if ((location != NULL) && !location_core_method_is_current(location->method)) {
+		return;
+	}
+
+	location_core_timer_stop(current_config.methods[current_method_index].method);
 
 	if (location != NULL) {
 		/* Location was acquired properly */
 		current_event_data.id = LOCATION_EVT_LOCATION;
 		current_event_data.location = *location;
 
-		LOG_DBG("Location acquired successfully:");
-		LOG_DBG("  method: %s (%d)", (char *)location_method_api_get(
-			current_event_data.location.method)->method_string,
-			current_event_data.location.method);
-		/* Logging v1 doesn't support double and float logging. Logging v2 would support
-		 * but that's up to application to configure.
-		 */
-		sprintf(latitude_str, "%.06f", current_event_data.location.latitude);
-		LOG_DBG("  latitude: %s", latitude_str);
-		sprintf(longitude_str, "%.06f", current_event_data.location.longitude);
-		LOG_DBG("  longitude: %s", longitude_str);
-		sprintf(accuracy_str, "%.01f", current_event_data.location.accuracy);
-		LOG_DBG("  accuracy: %s m", accuracy_str);
-		if (current_event_data.location.datetime.valid) {
-			LOG_DBG("  date: %04d-%02d-%02d",
-				current_event_data.location.datetime.year,
-				current_event_data.location.datetime.month,
-				current_event_data.location.datetime.day);
-			LOG_DBG("  time: %02d:%02d:%02d.%03d UTC",
-				current_event_data.location.datetime.hour,
-				current_event_data.location.datetime.minute,
-				current_event_data.location.datetime.second,
-				current_event_data.location.datetime.ms);
-		}
-		LOG_DBG("  Google maps URL: https://maps.google.com/?q=%s,%s",
-			latitude_str, longitude_str);
+		location_core_location_log(&current_event_data.location);
+
 		if (current_config.mode == LOCATION_REQ_MODE_ALL) {
 			/* Get possible next method */
 			previous_method = current_event_data.location.method;
@@ -481,23 +760,22 @@ void location_core_event_cb(const struct location_data *location)
 		LOG_ERR("Location acquisition failed and fallbacks are also done");
 	}
 
-	event_handler(&current_event_data);
-
-	if (current_config.interval > 0) {
-		k_work_schedule_for_queue(
-			location_core_work_queue_get(),
-			&location_periodic_work,
-			K_SECONDS(current_config.interval));
-	} else {
-		location_core_current_config_clear();
-
-		k_sem_give(&location_core_sem);
-	}
+	location_core_request_done();
 }
 
-struct k_work_q *location_core_work_queue_get(void)
+struct k_work_q *location_core_work_queue_get(enum location_method method)
 {
-	return &location_core_work_q;
+#if defined(CONFIG_LOCATION_REQ_MODE_RACE)
+	int index = location_method_index_get(method);
+
+	__ASSERT_NO_MSG(index >= 0);
+
+	return &location_core_work_q[index];
+#else
+	ARG_UNUSED(method);
+
+	return &location_core_work_q[0];
+#endif
 }
 
 static void location_core_periodic_work_fn(struct k_work *work)
@@ -508,19 +786,22 @@ static void location_core_periodic_work_fn(struct k_work *work)
 
 static void location_core_timeout_work_fn(struct k_work *work)
 {
-	enum location_method current_method =
-		current_config.methods[current_method_index].method;
-
-	ARG_UNUSED(work);
+	struct k_work_delayable *timeout_work = k_work_delayable_from_work(work);
+	const struct location_method_api *method_api =
+		methods_supported[timeout_work - location_timeout_work];
 
-	LOG_WRN("Timeout occurred");
+	LOG_WRN("Timeout occurred for '%s' method", (char *)method_api->method_string);
 
-	location_method_api_get(current_method)->cancel();
-	location_core_event_cb_timeout();
+	method_api->cancel();
+	location_core_event_cb_timeout(method_api->method);
 }
 
-void location_core_timer_start(int32_t timeout)
+void location_core_timer_start(enum location_method method, int32_t timeout)
 {
+	int index = location_method_index_get(method);
+
+	__ASSERT_NO_MSG(index >= 0);
+
 	if (timeout != SYS_FOREVER_MS && timeout > 0) {
 		LOG_DBG("Starting timer with timeout=%d", timeout);
 
@@ -530,13 +811,17 @@ void location_core_timer_start(int32_t timeout)
 		 * their operation, blocking waiting of semaphores will block the timeout from
 		 * expiring and canceling methods.
 		 */
-		k_work_schedule(&location_timeout_work, K_MSEC(timeout));
+		k_work_schedule(&location_timeout_work[index], K_MSEC(timeout));
 	}
 }
 
-void location_core_timer_stop(void)
+void location_core_timer_stop(enum location_method method)
 {
-	k_work_cancel_delayable(&location_timeout_work);
+	int index = location_method_index_get(method);
+
+	if (index >= 0) {
+		k_work_cancel_delayable(&location_timeout_work[index]);
+	}
 }
 
 int location_core_cancel(void)
@@ -545,11 +830,24 @@ int location_core_cancel(void)
 	enum location_method current_method =
 		current_config.methods[current_method_index].method;
 
-	k_work_cancel_delayable(&location_timeout_work);
 	k_work_cancel_delayable(&location_periodic_work);
 
+#if defined(CONFIG_LOCATION_REQ_MODE_RACE)
+	if (current_config.mode == LOCATION_REQ_MODE_RACE) {
+		k_mutex_lock(&race_mutex, K_FOREVER);
+		location_core_race_cancel();
+		location_core_current_config_clear();
+		k_mutex_unlock(&race_mutex);
+
+		k_sem_give(&location_core_sem);
+
+		return 0;
+	}
+#endif
 	/* Check if location has been requested using one of the methods */
 	if (current_method != 0) {
+		location_core_timer_stop(current_method);
+
 		LOG_DBG("Cancelling location method for '%s' method",
 			(char *)location_method_api_get(current_method)->method_string);
 		err = location_method_api_get(current_method)->cancel();
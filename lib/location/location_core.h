@@ -23,8 +23,8 @@ int location_core_location_get(const struct location_config *config);
 int location_core_cancel(void);
 
 void location_core_event_cb(const struct location_data *location);
-void location_core_event_cb_error(void);
-void location_core_event_cb_timeout(void);
+void location_core_event_cb_error(enum location_method method);
+void location_core_event_cb_timeout(enum location_method method);
 #if defined(CONFIG_LOCATION_METHOD_GNSS_AGPS_EXTERNAL)
 void location_core_event_cb_agps_request(const struct nrf_modem_gnss_agps_data_frame *request);
 #endif
@@ -33,8 +33,8 @@ void location_core_event_cb_pgps_request(const struct gps_pgps_request *request)
 #endif
 
 void location_core_config_log(const struct location_config *config);
-void location_core_timer_start(int32_t timeout);
-void location_core_timer_stop(void);
-struct k_work_q *location_core_work_queue_get(void);
+void location_core_timer_start(enum location_method method, int32_t timeout);
+void location_core_timer_stop(enum location_method method);
+struct k_work_q *location_core_work_queue_get(enum location_method method);
 
 #endif /* LOCATION_CORE_H */
@@ -10,9 +10,15 @@
 #include <modem/location.h>
 #include <modem/lte_lc.h>
 #include <net/multicell_location.h>
+#if defined(CONFIG_LOCATION_CACHE)
+#include <zephyr/sys/crc.h>
+#endif
 
 #include "location_core.h"
 #include "location_utils.h"
+#if defined(CONFIG_LOCATION_CACHE)
+#include "location_cache.h"
+#endif
 
 LOG_MODULE_DECLARE(location, CONFIG_LOCATION_LOG_LEVEL);
 
@@ -66,6 +72,31 @@ void method_cellular_lte_ind_handler(const struct lte_lc_evt *const evt)
 	}
 }
 
+#if defined(CONFIG_LOCATION_CACHE)
+static void method_cellular_fingerprint_get(struct location_cache_fingerprint *fingerprint)
+{
+	/* Serving cell must match exactly */
+	const uint32_t serving_cell[] = {
+		cell_data.current_cell.mcc,
+		cell_data.current_cell.mnc,
+		cell_data.current_cell.tac,
+		cell_data.current_cell.id,
+	};
+
+	location_cache_fingerprint_init(fingerprint, crc32_ieee((const uint8_t *)serving_cell,
+								  sizeof(serving_cell)));
+
+	for (int i = 0; i < cell_data.ncells_count; i++) {
+		const uint32_t ncell[] = {
+			cell_data.neighbor_cells[i].earfcn,
+			cell_data.neighbor_cells[i].phys_cell_id,
+		};
+
+		location_cache_fingerprint_add(fingerprint, ncell, sizeof(ncell));
+	}
+}
+#endif
+
 static int method_cellular_ncellmeas_start(void)
 {
 	struct location_utils_modem_params_info modem_params = { 0 };
@@ -105,6 +136,9 @@ static void method_cellular_positioning_work_fn(struct k_work *work)
 	struct multicell_location_params params = { 0 };
 	struct multicell_location location;
 	struct location_data location_result = { 0 };
+#if defined(CONFIG_LOCATION_CACHE)
+	struct location_cache_fingerprint fingerprint;
+#endif
 	int64_t ncellmeas_start_time;
 	int64_t ncellmeas_time;
 	int ret;
@@ -112,7 +146,7 @@ static void method_cellular_positioning_work_fn(struct k_work *work)
 		CONTAINER_OF(work, struct method_cellular_positioning_work_args, work_item);
 	const struct location_cellular_config cellular_config = work_data->cellular_config;
 
-	location_core_timer_start(cellular_config.timeout);
+	location_core_timer_start(LOCATION_METHOD_CELLULAR, cellular_config.timeout);
 
 	ncellmeas_start_time = k_uptime_get();
 
@@ -120,7 +154,7 @@ static void method_cellular_positioning_work_fn(struct k_work *work)
 	ret = method_cellular_ncellmeas_start();
 	if (ret) {
 		LOG_WRN("Cannot start neighbor cell measurements");
-		location_core_event_cb_error();
+		location_core_event_cb_error(LOCATION_METHOD_CELLULAR);
 		running = false;
 		return;
 	}
@@ -131,11 +165,11 @@ static void method_cellular_positioning_work_fn(struct k_work *work)
 	}
 
 	/* Stop the timer and let rest_client timer handle the request */
-	location_core_timer_stop();
+	location_core_timer_stop(LOCATION_METHOD_CELLULAR);
 
 	if (cell_data.current_cell.id == LTE_LC_CELL_EUTRAN_ID_INVALID) {
 		LOG_WRN("Current cell ID not valid");
-		location_core_event_cb_error();
+		location_core_event_cb_error(LOCATION_METHOD_CELLULAR);
 		running = false;
 		return;
 	}
@@ -143,6 +177,18 @@ static void method_cellular_positioning_work_fn(struct k_work *work)
 	/* NCELLMEAS done at this point of time. Store current time to response. */
 	location_utils_systime_to_location_datetime(&location_result.datetime);
 
+#if defined(CONFIG_LOCATION_CACHE)
+	method_cellular_fingerprint_get(&fingerprint);
+	if (location_cache_get(LOCATION_METHOD_CELLULAR, &fingerprint, &location_result) == 0) {
+		LOG_DBG("Location found in cache, location service not used");
+		if (running) {
+			running = false;
+			location_core_event_cb(&location_result);
+		}
+		return;
+	}
+#endif
+
 	/* Check if timeout is given */
 	params.timeout = cellular_config.timeout;
 	if (cellular_config.timeout != SYS_FOREVER_MS) {
@@ -152,7 +198,7 @@ static void method_cellular_positioning_work_fn(struct k_work *work)
 		/* Check if timeout has already elapsed */
 		if (ncellmeas_time >= cellular_config.timeout) {
 			LOG_WRN("Timeout occurred during neighbour cell measurement");
-			location_core_event_cb_timeout();
+			location_core_event_cb_timeout(LOCATION_METHOD_CELLULAR);
 			running = false;
 			return;
 		}
@@ -167,15 +213,18 @@ static void method_cellular_positioning_work_fn(struct k_work *work)
 	if (ret) {
 		LOG_ERR("Failed to acquire location from multicell_location lib, error: %d", ret);
 		if (ret == -ETIMEDOUT) {
-			location_core_event_cb_timeout();
+			location_core_event_cb_timeout(LOCATION_METHOD_CELLULAR);
 		} else {
-			location_core_event_cb_error();
+			location_core_event_cb_error(LOCATION_METHOD_CELLULAR);
 		}
 	} else {
 		location_result.method = LOCATION_METHOD_CELLULAR;
 		location_result.latitude = location.latitude;
 		location_result.longitude = location.longitude;
 		location_result.accuracy = location.accuracy;
+#if defined(CONFIG_LOCATION_CACHE)
+		location_cache_put(LOCATION_METHOD_CELLULAR, &fingerprint, &location_result);
+#endif
 		if (running) {
 			running = false;
 			location_core_event_cb(&location_result);
@@ -188,7 +237,7 @@ int method_cellular_location_get(const struct location_method_config *config)
 	/* Note: LTE status not checked, let it fail in NCELLMEAS if no connection */
 
 	method_cellular_positioning_work.cellular_config = config->cellular;
-	k_work_submit_to_queue(location_core_work_queue_get(),
+	k_work_submit_to_queue(location_core_work_queue_get(LOCATION_METHOD_CELLULAR),
 			       &method_cellular_positioning_work.work_item);
 
 	running = true;
@@ -134,19 +134,20 @@ void method_gnss_pgps_handler(struct nrf_cloud_pgps_event *event)
 
 	if (event->type == PGPS_EVT_READY) {
 		/* P-GPS has finished downloading predictions; request the current prediction. */
-		k_work_submit_to_queue(location_core_work_queue_get(),
+		k_work_submit_to_queue(location_core_work_queue_get(LOCATION_METHOD_GNSS),
 				       &method_gnss_notify_pgps_work);
 	} else if (event->type == PGPS_EVT_AVAILABLE) {
 		/* Inject the specified prediction into the modem. */
 		prediction = event->prediction;
-		k_work_submit_to_queue(location_core_work_queue_get(),
+		k_work_submit_to_queue(location_core_work_queue_get(LOCATION_METHOD_GNSS),
 				       &method_gnss_manage_pgps_work);
 	} else if (event->type == PGPS_EVT_REQUEST) {
 		memcpy(&pgps_request, event->request, sizeof(pgps_request));
 #if defined(CONFIG_LOCATION_METHOD_GNSS_PGPS_EXTERNAL)
-		k_work_submit_to_queue(location_core_work_queue_get(), &method_gnss_pgps_ext_work);
+		k_work_submit_to_queue(location_core_work_queue_get(LOCATION_METHOD_GNSS),
+				       &method_gnss_pgps_ext_work);
 #else
-		k_work_submit_to_queue(location_core_work_queue_get(),
+		k_work_submit_to_queue(location_core_work_queue_get(LOCATION_METHOD_GNSS),
 				       &method_gnss_pgps_request_work);
 #endif
 	}
@@ -288,7 +289,7 @@ static void method_gnss_agps_request_work_fn(struct k_work *item)
 
 #if defined(CONFIG_NRF_CLOUD_PGPS)
 	k_work_submit_to_queue(
-		location_core_work_queue_get(),
+		location_core_work_queue_get(LOCATION_METHOD_GNSS),
 		&method_gnss_notify_pgps_work);
 #endif
 }
@@ -415,7 +416,8 @@ static void method_gnss_request_assistance(void)
 		agps_request.sv_mask_alm,
 		agps_request.data_flags);
 #if defined(CONFIG_LOCATION_METHOD_GNSS_AGPS_EXTERNAL)
-	k_work_submit_to_queue(location_core_work_queue_get(), &method_gnss_agps_ext_work);
+	k_work_submit_to_queue(location_core_work_queue_get(LOCATION_METHOD_GNSS),
+			       &method_gnss_agps_ext_work);
 #else
 #if defined(CONFIG_NRF_CLOUD_AGPS)
 	/* Check the request. If no A-GPS data types except ephemeris or almanac are requested,
@@ -423,14 +425,14 @@ static void method_gnss_request_assistance(void)
 	 */
 	if (method_gnss_agps_required(&agps_request)) {
 		k_work_submit_to_queue(
-			location_core_work_queue_get(),
+			location_core_work_queue_get(LOCATION_METHOD_GNSS),
 			&method_gnss_agps_request_work);
 	} else
 #endif
 	{
 #if defined(CONFIG_NRF_CLOUD_PGPS)
 		k_work_submit_to_queue(
-			location_core_work_queue_get(),
+			location_core_work_queue_get(LOCATION_METHOD_GNSS),
 			&method_gnss_notify_pgps_work);
 #endif
 	}
@@ -442,7 +444,8 @@ void method_gnss_event_handler(int event)
 {
 	switch (event) {
 	case NRF_MODEM_GNSS_EVT_PVT:
-		k_work_submit_to_queue(location_core_work_queue_get(), &method_gnss_pvt_work);
+		k_work_submit_to_queue(location_core_work_queue_get(LOCATION_METHOD_GNSS),
+				       &method_gnss_pvt_work);
 		break;
 
 	case NRF_MODEM_GNSS_EVT_AGPS_REQ:
@@ -632,7 +635,7 @@ static void method_gnss_pvt_work_fn(struct k_work *item)
 
 	if (nrf_modem_gnss_read(&pvt_data, sizeof(pvt_data), NRF_MODEM_GNSS_DATA_PVT) != 0) {
 		LOG_ERR("Failed to read PVT data from GNSS");
-		location_core_event_cb_error();
+		location_core_event_cb_error(LOCATION_METHOD_GNSS);
 		return;
 	}
 
@@ -668,7 +671,7 @@ static void method_gnss_pvt_work_fn(struct k_work *item)
 		    method_gnss_tracked_satellites(&pvt_data) < VISIBILITY_DETECTION_SAT_LIMIT) {
 			LOG_DBG("GNSS visibility obstructed, canceling");
 			method_gnss_cancel();
-			location_core_event_cb_error();
+			location_core_event_cb_error(LOCATION_METHOD_GNSS);
 		}
 	}
 }
@@ -725,7 +728,7 @@ static void method_gnss_positioning_work_fn(struct k_work *work)
 
 	if (err) {
 		LOG_ERR("Failed to configure GNSS");
-		location_core_event_cb_error();
+		location_core_event_cb_error(LOCATION_METHOD_GNSS);
 		running = false;
 		return;
 	}
@@ -733,12 +736,12 @@ static void method_gnss_positioning_work_fn(struct k_work *work)
 	err = nrf_modem_gnss_start();
 	if (err) {
 		LOG_ERR("Failed to start GNSS");
-		location_core_event_cb_error();
+		location_core_event_cb_error(LOCATION_METHOD_GNSS);
 		running = false;
 		return;
 	}
 
-	location_core_timer_start(gnss_config.timeout);
+	location_core_timer_start(LOCATION_METHOD_GNSS, gnss_config.timeout);
 }
 
 int method_gnss_location_get(const struct location_method_config *config)
@@ -786,7 +789,8 @@ int method_gnss_location_get(const struct location_method_config *config)
 	nrf_modem_gnss_stop();
 #endif
 
-	k_work_submit_to_queue(location_core_work_queue_get(), &method_gnss_start_work);
+	k_work_submit_to_queue(location_core_work_queue_get(LOCATION_METHOD_GNSS),
+			       &method_gnss_start_work);
 
 	running = true;
 
@@ -15,6 +15,9 @@
 
 #include "location_core.h"
 #include "location_utils.h"
+#if defined(CONFIG_LOCATION_CACHE)
+#include "location_cache.h"
+#endif
 #include "wifi/wifi_service.h"
 
 LOG_MODULE_DECLARE(location, CONFIG_LOCATION_LOG_LEVEL);
@@ -151,11 +154,14 @@ static void method_wifi_positioning_work_fn(struct k_work *work)
 		CONTAINER_OF(work, struct method_wifi_start_work_args, work_item);
 	struct rest_wifi_pos_request request;
 	struct location_data result;
+#if defined(CONFIG_LOCATION_CACHE)
+	struct location_cache_fingerprint fingerprint;
+#endif
 	const struct location_wifi_config wifi_config = work_data->wifi_config;
 	int64_t starting_uptime_ms = work_data->starting_uptime_ms;
 	int err;
 
-	location_core_timer_start(wifi_config.timeout);
+	location_core_timer_start(LOCATION_METHOD_WIFI, wifi_config.timeout);
 
 	err = method_wifi_scanning_start();
 	if (err) {
@@ -168,11 +174,29 @@ static void method_wifi_positioning_work_fn(struct k_work *work)
 		goto end;
 	}
 	/* Stop the timer and let rest_client timer handle the request */
-	location_core_timer_stop();
+	location_core_timer_stop(LOCATION_METHOD_WIFI);
 
 	/* Scanning done at this point of time. Store current time to response. */
 	location_utils_systime_to_location_datetime(&location_result.datetime);
 
+#if defined(CONFIG_LOCATION_CACHE)
+	location_cache_fingerprint_init(&fingerprint, 0);
+	for (int i = 0; i < latest_scan_result_count; i++) {
+		location_cache_fingerprint_add(&fingerprint, latest_scan_results[i].mac_addr_str,
+					       strlen(latest_scan_results[i].mac_addr_str));
+	}
+
+	if ((latest_scan_result_count > 1) &&
+	    (location_cache_get(LOCATION_METHOD_WIFI, &fingerprint, &location_result) == 0)) {
+		LOG_DBG("Location found in cache, location service not used");
+		if (running) {
+			running = false;
+			location_core_event_cb(&location_result);
+		}
+		return;
+	}
+#endif
+
 	if (!location_utils_is_default_pdn_active()) {
 		/* Not worth to start trying to fetch with the REST api over cellular.
 		 * Thus, fail faster in this case and save the trying "costs".
@@ -219,6 +243,9 @@ static void method_wifi_positioning_work_fn(struct k_work *work)
 			location_result.latitude = result.latitude;
 			location_result.longitude = result.longitude;
 			location_result.accuracy = result.accuracy;
+#if defined(CONFIG_LOCATION_CACHE)
+			location_cache_put(LOCATION_METHOD_WIFI, &fingerprint, &location_result);
+#endif
 			if (running) {
 				running = false;
 				location_core_event_cb(&location_result);
@@ -239,10 +266,10 @@ static void method_wifi_positioning_work_fn(struct k_work *work)
 	}
 end:
 	if (err == -ETIMEDOUT) {
-		location_core_event_cb_timeout();
+		location_core_event_cb_timeout(LOCATION_METHOD_WIFI);
 		running = false;
 	} else if (err) {
-		location_core_event_cb_error();
+		location_core_event_cb_error(LOCATION_METHOD_WIFI);
 		running = false;
 	}
 }
@@ -263,7 +290,8 @@ int method_wifi_location_get(const struct location_method_config *config)
 	k_work_init(&method_wifi_start_work.work_item, method_wifi_positioning_work_fn);
 	method_wifi_start_work.wifi_config = config->wifi;
 	method_wifi_start_work.starting_uptime_ms = k_uptime_get();
-	k_work_submit_to_queue(location_core_work_queue_get(), &method_wifi_start_work.work_item);
+	k_work_submit_to_queue(location_core_work_queue_get(LOCATION_METHOD_WIFI),
+			       &method_wifi_start_work.work_item);
 
 	running = true;
 
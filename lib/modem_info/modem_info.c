@@ -7,6 +7,9 @@
 #include <nrf_modem_at.h>
 #include <modem/at_monitor.h>
 #include <modem/at_cmd_parser.h>
+#if defined(CONFIG_NRF_MODEM_LIB)
+#include <modem/nrf_modem_lib.h>
+#endif
 #include <ctype.h>
 #include <zephyr/device.h>
 #include <errno.h>
@@ -44,6 +47,48 @@ LOG_MODULE_REGISTER(modem_info);
 #define AT_CMD_DATE_TIME	"AT+CCLK?"
 #define AT_CMD_SUCCESS_SIZE	5
 
+/* AT commands used to read the data. Several data types are read from the same command. */
+enum modem_info_cmd {
+	MODEM_INFO_CMD_CESQ,
+	MODEM_INFO_CMD_CURRENT_BAND,
+	MODEM_INFO_CMD_SUPPORTED_BAND,
+	MODEM_INFO_CMD_CURRENT_MODE,
+	MODEM_INFO_CMD_CURRENT_OP,
+	MODEM_INFO_CMD_NETWORK_STATUS,
+	MODEM_INFO_CMD_PDP_CONTEXT,
+	MODEM_INFO_CMD_UICC_STATE,
+	MODEM_INFO_CMD_VBAT,
+	MODEM_INFO_CMD_TEMP,
+	MODEM_INFO_CMD_FW_VERSION,
+	MODEM_INFO_CMD_ICCID,
+	MODEM_INFO_CMD_SYSTEMMODE,
+	MODEM_INFO_CMD_IMSI,
+	MODEM_INFO_CMD_IMEI,
+	MODEM_INFO_CMD_DATE_TIME,
+	MODEM_INFO_CMD_COUNT,
+};
+
+static const char *const modem_info_cmds[] = {
+	[MODEM_INFO_CMD_CESQ]		= AT_CMD_CESQ,
+	[MODEM_INFO_CMD_CURRENT_BAND]	= AT_CMD_CURRENT_BAND,
+	[MODEM_INFO_CMD_SUPPORTED_BAND]	= AT_CMD_SUPPORTED_BAND,
+	[MODEM_INFO_CMD_CURRENT_MODE]	= AT_CMD_CURRENT_MODE,
+	[MODEM_INFO_CMD_CURRENT_OP]	= AT_CMD_CURRENT_OP,
+	[MODEM_INFO_CMD_NETWORK_STATUS]	= AT_CMD_NETWORK_STATUS,
+	[MODEM_INFO_CMD_PDP_CONTEXT]	= AT_CMD_PDP_CONTEXT,
+	[MODEM_INFO_CMD_UICC_STATE]	= AT_CMD_UICC_STATE,
+	[MODEM_INFO_CMD_VBAT]		= AT_CMD_VBAT,
+	[MODEM_INFO_CMD_TEMP]		= AT_CMD_TEMP,
+	[MODEM_INFO_CMD_FW_VERSION]	= AT_CMD_FW_VERSION,
+	[MODEM_INFO_CMD_ICCID]		= AT_CMD_ICCID,
+	[MODEM_INFO_CMD_SYSTEMMODE]	= AT_CMD_SYSTEMMODE,
+	[MODEM_INFO_CMD_IMSI]		= AT_CMD_IMSI,
+	[MODEM_INFO_CMD_IMEI]		= AT_CMD_IMEI,
+	[MODEM_INFO_CMD_DATE_TIME]	= AT_CMD_DATE_TIME,
+};
+
+BUILD_ASSERT(ARRAY_SIZE(modem_info_cmds) == MODEM_INFO_CMD_COUNT);
+
 #define RSRP_DATA_NAME		"rsrp"
 #define CUR_BAND_DATA_NAME	"currentBand"
 #define SUP_BAND_DATA_NAME	"supportedBands"
@@ -130,7 +175,7 @@ LOG_MODULE_REGISTER(modem_info);
 #define APN_PARAM_COUNT		7
 
 struct modem_info_data {
-	const char *cmd;
+	enum modem_info_cmd cmd;
 	const char *data_name;
 	uint8_t param_index;
 	uint8_t param_count;
@@ -138,7 +183,7 @@ struct modem_info_data {
 };
 
 static const struct modem_info_data rsrp_data = {
-	.cmd		= AT_CMD_CESQ,
+	.cmd		= MODEM_INFO_CMD_CESQ,
 	.data_name	= RSRP_DATA_NAME,
 	.param_index	= RSRP_PARAM_INDEX,
 	.param_count	= RSRP_PARAM_COUNT,
@@ -146,7 +191,7 @@ static const struct modem_info_data rsrp_data = {
 };
 
 static const struct modem_info_data band_data = {
-	.cmd		= AT_CMD_CURRENT_BAND,
+	.cmd		= MODEM_INFO_CMD_CURRENT_BAND,
 	.data_name	= CUR_BAND_DATA_NAME,
 	.param_index	= BAND_PARAM_INDEX,
 	.param_count	= BAND_PARAM_COUNT,
@@ -154,7 +199,7 @@ static const struct modem_info_data band_data = {
 };
 
 static const struct modem_info_data band_sup_data = {
-	.cmd		= AT_CMD_SUPPORTED_BAND,
+	.cmd		= MODEM_INFO_CMD_SUPPORTED_BAND,
 	.data_name	= SUP_BAND_DATA_NAME,
 	.param_index	= BAND_PARAM_INDEX,
 	.param_count	= BAND_PARAM_COUNT,
@@ -162,7 +207,7 @@ static const struct modem_info_data band_sup_data = {
 };
 
 static const struct modem_info_data mode_data = {
-	.cmd		= AT_CMD_CURRENT_MODE,
+	.cmd		= MODEM_INFO_CMD_CURRENT_MODE,
 	.data_name	= UE_MODE_DATA_NAME,
 	.param_index	= MODE_PARAM_INDEX,
 	.param_count	= MODE_PARAM_COUNT,
@@ -170,7 +215,7 @@ static const struct modem_info_data mode_data = {
 };
 
 static const struct modem_info_data operator_data = {
-	.cmd		= AT_CMD_CURRENT_OP,
+	.cmd		= MODEM_INFO_CMD_CURRENT_OP,
 	.data_name	= OPERATOR_DATA_NAME,
 	.param_index	= OPERATOR_PARAM_INDEX,
 	.param_count	= OPERATOR_PARAM_COUNT,
@@ -178,7 +223,7 @@ static const struct modem_info_data operator_data = {
 };
 
 static const struct modem_info_data mcc_data = {
-	.cmd		= AT_CMD_CURRENT_OP,
+	.cmd		= MODEM_INFO_CMD_CURRENT_OP,
 	.data_name	= MCC_DATA_NAME,
 	.param_index	= OPERATOR_PARAM_INDEX,
 	.param_count	= OPERATOR_PARAM_COUNT,
@@ -186,7 +231,7 @@ static const struct modem_info_data mcc_data = {
 };
 
 static const struct modem_info_data mnc_data = {
-	.cmd		= AT_CMD_CURRENT_OP,
+	.cmd		= MODEM_INFO_CMD_CURRENT_OP,
 	.data_name	= MNC_DATA_NAME,
 	.param_index	= OPERATOR_PARAM_INDEX,
 	.param_count	= OPERATOR_PARAM_COUNT,
@@ -194,7 +239,7 @@ static const struct modem_info_data mnc_data = {
 };
 
 static const struct modem_info_data cellid_data = {
-	.cmd		= AT_CMD_NETWORK_STATUS,
+	.cmd		= MODEM_INFO_CMD_NETWORK_STATUS,
 	.data_name	= CELLID_DATA_NAME,
 	.param_index	= CELLID_PARAM_INDEX,
 	.param_count	= CELLID_PARAM_COUNT,
@@ -202,7 +247,7 @@ static const struct modem_info_data cellid_data = {
 };
 
 static const struct modem_info_data area_data = {
-	.cmd		= AT_CMD_NETWORK_STATUS,
+	.cmd		= MODEM_INFO_CMD_NETWORK_STATUS,
 	.data_name	= AREA_CODE_DATA_NAME,
 	.param_index	= AREA_CODE_PARAM_INDEX,
 	.param_count	= AREA_CODE_PARAM_COUNT,
@@ -210,7 +255,7 @@ static const struct modem_info_data area_data = {
 };
 
 static const struct modem_info_data ip_data = {
-	.cmd		= AT_CMD_PDP_CONTEXT,
+	.cmd		= MODEM_INFO_CMD_PDP_CONTEXT,
 	.data_name	= IP_ADDRESS_DATA_NAME,
 	.param_index	= IP_ADDRESS_PARAM_INDEX,
 	.param_count	= IP_ADDRESS_PARAM_COUNT,
@@ -218,7 +263,7 @@ static const struct modem_info_data ip_data = {
 };
 
 static const struct modem_info_data uicc_data = {
-	.cmd		= AT_CMD_UICC_STATE,
+	.cmd		= MODEM_INFO_CMD_UICC_STATE,
 	.data_name	= UICC_DATA_NAME,
 	.param_index	= UICC_PARAM_INDEX,
 	.param_count	= UICC_PARAM_COUNT,
@@ -226,7 +271,7 @@ static const struct modem_info_data uicc_data = {
 };
 
 static const struct modem_info_data battery_data = {
-	.cmd		= AT_CMD_VBAT,
+	.cmd		= MODEM_INFO_CMD_VBAT,
 	.data_name	= BATTERY_DATA_NAME,
 	.param_index	= VBAT_PARAM_INDEX,
 	.param_count	= VBAT_PARAM_COUNT,
@@ -234,7 +279,7 @@ static const struct modem_info_data battery_data = {
 };
 
 static const struct modem_info_data temp_data = {
-	.cmd		= AT_CMD_TEMP,
+	.cmd		= MODEM_INFO_CMD_TEMP,
 	.data_name	= TEMPERATURE_DATA_NAME,
 	.param_index	= TEMP_PARAM_INDEX,
 	.param_count	= TEMP_PARAM_COUNT,
@@ -242,7 +287,7 @@ static const struct modem_info_data temp_data = {
 };
 
 static const struct modem_info_data fw_data = {
-	.cmd		= AT_CMD_FW_VERSION,
+	.cmd		= MODEM_INFO_CMD_FW_VERSION,
 	.data_name	= MODEM_FW_DATA_NAME,
 	.param_index	= MODEM_FW_PARAM_INDEX,
 	.param_count	= MODEM_FW_PARAM_COUNT,
@@ -250,7 +295,7 @@ static const struct modem_info_data fw_data = {
 };
 
 static const struct modem_info_data iccid_data = {
-	.cmd		= AT_CMD_ICCID,
+	.cmd		= MODEM_INFO_CMD_ICCID,
 	.data_name	= ICCID_DATA_NAME,
 	.param_index	= ICCID_PARAM_INDEX,
 	.param_count	= ICCID_PARAM_COUNT,
@@ -258,7 +303,7 @@ static const struct modem_info_data iccid_data = {
 };
 
 static const struct modem_info_data lte_mode_data = {
-	.cmd		= AT_CMD_SYSTEMMODE,
+	.cmd		= MODEM_INFO_CMD_SYSTEMMODE,
 	.data_name	= LTE_MODE_DATA_NAME,
 	.param_index	= LTE_MODE_PARAM_INDEX,
 	.param_count	= SYSTEMMODE_PARAM_COUNT,
@@ -266,7 +311,7 @@ static const struct modem_info_data lte_mode_data = {
 };
 
 static const struct modem_info_data nbiot_mode_data = {
-	.cmd		= AT_CMD_SYSTEMMODE,
+	.cmd		= MODEM_INFO_CMD_SYSTEMMODE,
 	.data_name	= NBIOT_MODE_DATA_NAME,
 	.param_index	= NBIOT_MODE_PARAM_INDEX,
 	.param_count	= SYSTEMMODE_PARAM_COUNT,
@@ -274,7 +319,7 @@ static const struct modem_info_data nbiot_mode_data = {
 };
 
 static const struct modem_info_data gps_mode_data = {
-	.cmd		= AT_CMD_SYSTEMMODE,
+	.cmd		= MODEM_INFO_CMD_SYSTEMMODE,
 	.data_name	= GPS_MODE_DATA_NAME,
 	.param_index	= GPS_MODE_PARAM_INDEX,
 	.param_count	= SYSTEMMODE_PARAM_COUNT,
@@ -282,7 +327,7 @@ static const struct modem_info_data gps_mode_data = {
 };
 
 static const struct modem_info_data imsi_data = {
-	.cmd		= AT_CMD_IMSI,
+	.cmd		= MODEM_INFO_CMD_IMSI,
 	.data_name	= IMSI_DATA_NAME,
 	.param_index	= IMSI_PARAM_INDEX,
 	.param_count	= IMSI_PARAM_COUNT,
@@ -290,7 +335,7 @@ static const struct modem_info_data imsi_data = {
 };
 
 static const struct modem_info_data imei_data = {
-	.cmd		= AT_CMD_IMEI,
+	.cmd		= MODEM_INFO_CMD_IMEI,
 	.data_name	= MODEM_IMEI_DATA_NAME,
 	.param_index	= MODEM_IMEI_PARAM_INDEX,
 	.param_count	= MODEM_IMEI_PARAM_COUNT,
@@ -298,7 +343,7 @@ static const struct modem_info_data imei_data = {
 };
 
 static const struct modem_info_data date_time_data = {
-	.cmd		= AT_CMD_DATE_TIME,
+	.cmd		= MODEM_INFO_CMD_DATE_TIME,
 	.data_name	= DATE_TIME_DATA_NAME,
 	.param_index	= DATE_TIME_PARAM_INDEX,
 	.param_count	= DATE_TIME_PARAM_COUNT,
@@ -306,7 +351,7 @@ static const struct modem_info_data date_time_data = {
 };
 
 static const struct modem_info_data apn_data = {
-	.cmd		= AT_CMD_PDP_CONTEXT,
+	.cmd		= MODEM_INFO_CMD_PDP_CONTEXT,
 	.data_name	= APN_DATA_NAME,
 	.param_index	= APN_PARAM_INDEX,
 	.param_count	= APN_PARAM_COUNT,
@@ -343,6 +388,163 @@ AT_MONITOR(modem_info_cesq_mon, "%CESQ", modem_info_rsrp_subscribe_handler, PAUS
 static rsrp_cb_t modem_info_rsrp_cb;
 static struct at_param_list m_param_list;
 
+#if defined(CONFIG_MODEM_INFO_SNAPSHOT)
+/* Commands whose response does not change while the modem is running. */
+#define SNAPSHOT_NO_EXPIRY (BIT(MODEM_INFO_CMD_SUPPORTED_BAND) | \
+			    BIT(MODEM_INFO_CMD_FW_VERSION) | \
+			    BIT(MODEM_INFO_CMD_IMEI))
+
+/* Commands whose response changes all the time. They are never stored. */
+#define SNAPSHOT_VOLATILE (BIT(MODEM_INFO_CMD_VBAT) | \
+			   BIT(MODEM_INFO_CMD_TEMP) | \
+			   BIT(MODEM_INFO_CMD_DATE_TIME))
+
+/* Commands whose response changes when the network registration changes. */
+#define SNAPSHOT_CEREG_CMDS (BIT(MODEM_INFO_CMD_CESQ) | \
+			     BIT(MODEM_INFO_CMD_CURRENT_BAND) | \
+			     BIT(MODEM_INFO_CMD_CURRENT_OP) | \
+			     BIT(MODEM_INFO_CMD_NETWORK_STATUS) | \
+			     BIT(MODEM_INFO_CMD_PDP_CONTEXT))
+
+/* Commands whose response changes when a PDN connection is activated or deactivated. */
+#define SNAPSHOT_CGEV_CMDS BIT(MODEM_INFO_CMD_PDP_CONTEXT)
+
+/* Commands whose response changes when the SIM card changes. */
+#define SNAPSHOT_XSIM_CMDS (BIT(MODEM_INFO_CMD_UICC_STATE) | \
+			    BIT(MODEM_INFO_CMD_ICCID) | \
+			    BIT(MODEM_INFO_CMD_IMSI))
+
+struct modem_info_snapshot {
+	/* Uptime when the response was read from the modem. */
+	int64_t timestamp;
+	char rsp[CONFIG_MODEM_INFO_BUFFER_SIZE];
+};
+
+static struct modem_info_snapshot snapshot[MODEM_INFO_CMD_COUNT];
+
+/* Set bit means that the response of the command in the snapshot is valid. Bits are cleared
+ * without taking the mutex so that notifications never wait for an ongoing AT command.
+ */
+static ATOMIC_DEFINE(snapshot_valid, MODEM_INFO_CMD_COUNT);
+
+static K_MUTEX_DEFINE(snapshot_mutex);
+
+AT_MONITOR(modem_info_cereg_mon, "+CEREG", modem_info_cereg_handler);
+AT_MONITOR(modem_info_cgev_mon, "+CGEV", modem_info_cgev_handler);
+AT_MONITOR(modem_info_xsim_mon, "%XSIM", modem_info_xsim_handler);
+
+static void snapshot_invalidate(uint32_t cmds)
+{
+	for (int i = 0; i < MODEM_INFO_CMD_COUNT; i++) {
+		if (cmds & BIT(i)) {
+			atomic_clear_bit(snapshot_valid, i);
+		}
+	}
+}
+
+static void modem_info_cereg_handler(const char *notif)
+{
+	ARG_UNUSED(notif);
+
+	snapshot_invalidate(SNAPSHOT_CEREG_CMDS);
+}
+
+static void modem_info_cgev_handler(const char *notif)
+{
+	ARG_UNUSED(notif);
+
+	snapshot_invalidate(SNAPSHOT_CGEV_CMDS);
+}
+
+static void modem_info_xsim_handler(const char *notif)
+{
+	ARG_UNUSED(notif);
+
+	snapshot_invalidate(SNAPSHOT_XSIM_CMDS);
+}
+
+#if defined(CONFIG_NRF_MODEM_LIB)
+NRF_MODEM_LIB_ON_INIT(modem_info_init_hook, on_modem_lib_init, NULL);
+
+static void on_modem_lib_init(int ret, void *ctx)
+{
+	ARG_UNUSED(ret);
+	ARG_UNUSED(ctx);
+
+	/* The modem may have been updated */
+	modem_info_snapshot_invalidate();
+}
+#endif /* CONFIG_NRF_MODEM_LIB */
+
+static bool snapshot_is_fresh(enum modem_info_cmd cmd)
+{
+	if (!atomic_test_bit(snapshot_valid, cmd)) {
+		return false;
+	}
+
+	if (SNAPSHOT_NO_EXPIRY & BIT(cmd)) {
+		return true;
+	}
+
+	return (k_uptime_get() - snapshot[cmd].timestamp) < CONFIG_MODEM_INFO_SNAPSHOT_TTL;
+}
+
+void modem_info_snapshot_invalidate(void)
+{
+	snapshot_invalidate(BIT_MASK(MODEM_INFO_CMD_COUNT));
+}
+
+/* Reads the response of the command from the snapshot, or from the modem if the snapshot
+ * does not have a fresh response.
+ */
+static int modem_info_cmd_send(enum modem_info_cmd cmd, char *buf, size_t buf_size)
+{
+	int err = 0;
+
+	if (SNAPSHOT_VOLATILE & BIT(cmd)) {
+		return nrf_modem_at_cmd(buf, buf_size, modem_info_cmds[cmd]);
+	}
+
+	k_mutex_lock(&snapshot_mutex, K_FOREVER);
+
+	if (!snapshot_is_fresh(cmd)) {
+		/* Set before the command so that a notification received
+		 * meanwhile invalidates the response.
+		 */
+		atomic_set_bit(snapshot_valid, cmd);
+
+		err = nrf_modem_at_cmd(snapshot[cmd].rsp, sizeof(snapshot[cmd].rsp),
+				       modem_info_cmds[cmd]);
+		if (err) {
+			atomic_clear_bit(snapshot_valid, cmd);
+			snapshot[cmd].rsp[0] = '\0';
+		} else {
+			snapshot[cmd].timestamp = k_uptime_get();
+		}
+	} else {
+		LOG_DBG("Using snapshot for %s", modem_info_cmds[cmd]);
+	}
+
+	if (!err) {
+		strncpy(buf, snapshot[cmd].rsp, buf_size - 1);
+		buf[buf_size - 1] = '\0';
+	}
+
+	k_mutex_unlock(&snapshot_mutex);
+
+	return err;
+}
+#else
+void modem_info_snapshot_invalidate(void)
+{
+}
+
+static int modem_info_cmd_send(enum modem_info_cmd cmd, char *buf, size_t buf_size)
+{
+	return nrf_modem_at_cmd(buf, buf_size, modem_info_cmds[cmd]);
+}
+#endif /* CONFIG_MODEM_INFO_SNAPSHOT */
+
 static void flip_iccid_string(char *buf)
 {
 	uint8_t current_char;
@@ -425,7 +627,7 @@ int modem_info_short_get(enum modem_info info, uint16_t *buf)
 		return -EINVAL;
 	}
 
-	err = nrf_modem_at_cmd(recv_buf, CONFIG_MODEM_INFO_BUFFER_SIZE, modem_data[info]->cmd);
+	err = modem_info_cmd_send(modem_data[info]->cmd, recv_buf, sizeof(recv_buf));
 	if (err != 0) {
 		return -EIO;
 	}
@@ -589,7 +791,7 @@ int modem_info_string_get(enum modem_info info, char *buf, const size_t buf_size
 
 	buf[0] = '\0';
 
-	err = nrf_modem_at_cmd(recv_buf, CONFIG_MODEM_INFO_BUFFER_SIZE, modem_data[info]->cmd);
+	err = modem_info_cmd_send(modem_data[info]->cmd, recv_buf, sizeof(recv_buf));
 	if (err != 0) {
 		return -EIO;
 	}
@@ -680,13 +882,17 @@ static void modem_info_rsrp_subscribe_handler(const char *notif)
 	uint16_t param_value;
 
 	const struct modem_info_data rsrp_notify_data = {
-		.cmd		= AT_CMD_CESQ,
+		.cmd		= MODEM_INFO_CMD_CESQ,
 		.data_name	= RSRP_DATA_NAME,
 		.param_index	= RSRP_NOTIFY_PARAM_INDEX,
 		.param_count	= RSRP_NOTIFY_PARAM_COUNT,
 		.data_type	= AT_PARAM_TYPE_NUM_INT,
 	};
 
+#if defined(CONFIG_MODEM_INFO_SNAPSHOT)
+	atomic_clear_bit(snapshot_valid, MODEM_INFO_CMD_CESQ);
+#endif
+
 	err = modem_info_parse(&rsrp_notify_data, notif);
 	if (err != 0) {
 		LOG_ERR("modem_info_parse failed to parse "
@@ -34,6 +34,7 @@ def main():
 
     sn = StatsNordic(args.dataset_name + ".csv", args.dataset_name + ".json",
                      log_lvl_number)
+    sn.check_dropped_events(args.start_time, args.end_time)
     sn.calculate_stats_preset1(args.start_time, args.end_time)
 
 if __name__ == "__main__":
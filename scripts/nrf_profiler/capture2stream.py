@@ -0,0 +1,112 @@
+#
+# Copyright (c) 2022 Nordic Semiconductor ASA
+#
+# SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+
+import sys
+import logging
+from stream import Stream, StreamError
+
+CAPTURE_MAGIC = b'NPRF'
+CAPTURE_VERSION = 1
+CAPTURE_HDR_LEN = len(CAPTURE_MAGIC) + 1 + 4
+FRAME_INFO = ord('I')
+FRAME_DATA = ord('D')
+FRAME_HDR_LEN = 3
+# Padding between frames, also the value of erased flash
+PADDING = 0xFF
+
+class CaptureError(Exception):
+    pass
+
+def read_capture_header(data):
+    """Return the timestamp frequency in Hz from the header of a capture."""
+    if len(data) < CAPTURE_HDR_LEN or data[:len(CAPTURE_MAGIC)] != CAPTURE_MAGIC:
+        raise CaptureError("Not a Nordic nrf_profiler capture")
+
+    version = data[len(CAPTURE_MAGIC)]
+    if version != CAPTURE_VERSION:
+        raise CaptureError("Unsupported capture version: {}".format(version))
+
+    return int.from_bytes(data[len(CAPTURE_MAGIC) + 1:CAPTURE_HDR_LEN], byteorder='little')
+
+def parse_capture(data):
+    """Split a capture into event descriptions and event data.
+
+    Returns the descriptions in the format sent over the RTT info channel and
+    the event data as sent over the RTT data channel.
+    """
+    read_capture_header(data)
+
+    descriptions = {}
+    format_line = None
+    events = bytearray()
+    pos = CAPTURE_HDR_LEN
+
+    while pos < len(data):
+        frame_type = data[pos]
+        if frame_type == PADDING:
+            pos += 1
+            continue
+
+        if pos + FRAME_HDR_LEN > len(data):
+            raise CaptureError("Truncated frame header at offset {}".format(pos))
+
+        frame_len = int.from_bytes(data[pos + 1:pos + FRAME_HDR_LEN], byteorder='little')
+        pos += FRAME_HDR_LEN
+        if pos + frame_len > len(data):
+            raise CaptureError("Truncated frame at offset {}".format(pos))
+
+        frame = data[pos:pos + frame_len]
+        pos += frame_len
+
+        if frame_type == FRAME_DATA:
+            events.extend(frame)
+        elif frame_type == FRAME_INFO:
+            # Descriptions are sent again on request, keep one per event type.
+            for line in frame.decode().splitlines():
+                if line.startswith('#'):
+                    format_line = line
+                elif line:
+                    descriptions[int(line.split(',')[1])] = line
+        else:
+            raise CaptureError("Unknown frame type {} at offset {}".format(frame_type, pos))
+
+    lines = [format_line] if format_line is not None else []
+    lines.extend(descriptions[id] for id in sorted(descriptions))
+    desc_buf = ''.join(line + '\n' for line in lines) + '\n'
+
+    return desc_buf.encode(), bytes(events)
+
+class Capture2Stream:
+    def __init__(self, out_stream, event_close, filename, log_lvl=logging.INFO):
+        self.out_stream = out_stream
+        self.event_close = event_close
+        self.filename = filename
+
+        self.logger = logging.getLogger('Profiler capture to stream')
+        self.logger_console = logging.StreamHandler()
+        self.logger.setLevel(log_lvl)
+        self.log_format = logging.Formatter('[%(levelname)s] %(name)s: %(message)s')
+        self.logger_console.setFormatter(self.log_format)
+        self.logger.addHandler(self.logger_console)
+
+    def read_and_transmit_data(self):
+        try:
+            with open(self.filename, 'rb') as f:
+                desc_buf, events = parse_capture(f.read())
+        except (IOError, CaptureError) as err:
+            self.logger.error("Cannot read capture: {}".format(err))
+            sys.exit()
+
+        try:
+            self.out_stream.send_desc(desc_buf)
+            for pos in range(0, len(events), Stream.RECV_BUF_SIZE):
+                if self.event_close.is_set():
+                    break
+                self.out_stream.send_ev(events[pos:pos + Stream.RECV_BUF_SIZE])
+        except StreamError as err:
+            self.logger.error("Error: {}. Unable to send data".format(err))
+            sys.exit()
+
+        self.logger.info("Sent {} bytes of events from {}".format(len(events), self.filename))
@@ -0,0 +1,161 @@
+#
+# Copyright (c) 2022 Nordic Semiconductor ASA
+#
+# SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+
+from processed_events import ProcessedEvents
+from elftools.elf.elffile import ELFFile
+from elftools.elf.sections import SymbolTableSection
+from collections import defaultdict
+import argparse
+import bisect
+import re
+import sys
+
+CPU_SAMPLE_EVENT_NAME = "cpu_sample"
+# Contexts up to this value identify interrupts, see CPU_SAMPLER_CTX_ISR_MAX
+CTX_ISR_MAX = 0x1FF
+# First exception number of external interrupts on Cortex-M
+EXC_NUM_IRQ_FIRST = 16
+# Prefix of the names of threads defined with K_THREAD_DEFINE
+THREAD_OBJ_PREFIX = "_k_thread_obj_"
+# Histogram entry printed by the "cpu_sampler show" shell command
+SHELL_ENTRY_RE = re.compile(r'^\s*(\d+)\s+\d+,\d%\s+(0x[0-9a-fA-F]+)\s+(0x[0-9a-fA-F]+)\s*$')
+
+
+class SymbolTable():
+    def __init__(self, elf_filename):
+        self.functions = []
+        self.objects = []
+
+        with open(elf_filename, 'rb') as f:
+            elf = ELFFile(f)
+            for section in elf.iter_sections():
+                if not isinstance(section, SymbolTableSection):
+                    continue
+                for sym in section.iter_symbols():
+                    sym_type = sym['st_info']['type']
+                    if sym['st_size'] == 0 or not sym.name:
+                        continue
+                    if sym_type == 'STT_FUNC':
+                        # Clear the Thumb bit
+                        self.functions.append((sym['st_value'] & ~1, sym['st_size'], sym.name))
+                    elif sym_type == 'STT_OBJECT':
+                        self.objects.append((sym['st_value'], sym['st_size'], sym.name))
+
+        self.functions.sort()
+        self.objects.sort()
+        self.function_addrs = [f[0] for f in self.functions]
+        self.object_addrs = [o[0] for o in self.objects]
+
+    @staticmethod
+    def _lookup(symbols, addrs, addr):
+        idx = bisect.bisect_right(addrs, addr) - 1
+        if idx >= 0:
+            start, size, name = symbols[idx]
+            if addr < start + size:
+                return name, addr - start
+        return None, None
+
+    def function_get(self, pc):
+        name, offset = self._lookup(self.functions, self.function_addrs, pc)
+        if name is None:
+            return "0x{:08x}".format(pc), None
+        return name, offset
+
+    def context_get(self, ctx):
+        if ctx <= CTX_ISR_MAX:
+            if ctx == 0:
+                return "ISR"
+            if ctx >= EXC_NUM_IRQ_FIRST:
+                return "ISR {}".format(ctx - EXC_NUM_IRQ_FIRST)
+            return "exception {}".format(ctx)
+
+        name, offset = self._lookup(self.objects, self.object_addrs, ctx)
+        if name is None or offset != 0:
+            return "thread 0x{:08x}".format(ctx)
+        if name.startswith(THREAD_OBJ_PREFIX):
+            name = name[len(THREAD_OBJ_PREFIX):]
+        return "thread {}".format(name)
+
+
+def read_samples_from_dataset(dataset_name):
+    """Sum the counts of the cpu_sample events of a nrf_profiler dataset."""
+    processed_data = ProcessedEvents()
+    processed_data.read_data_from_files(dataset_name + ".csv", dataset_name + ".json")
+
+    type_id = processed_data.get_event_type_id(CPU_SAMPLE_EVENT_NAME)
+    if type_id is None:
+        return {}
+
+    samples = defaultdict(int)
+    for ev in processed_data.tracked_events:
+        if ev.submit.type_id == type_id:
+            pc, ctx, count = ev.submit.data
+            samples[(pc, ctx)] += count
+    return samples
+
+
+def read_samples_from_shell_log(filename):
+    """Read the histogram entries printed by the "cpu_sampler show" command."""
+    samples = defaultdict(int)
+    with open(filename, 'r') as f:
+        for line in f:
+            match = SHELL_ENTRY_RE.match(line)
+            if match:
+                samples[(int(match.group(2), 16), int(match.group(3), 16))] += \
+                    int(match.group(1))
+    return samples
+
+
+def print_report(samples, symbols, by_context, by_pc, top):
+    total = sum(samples.values())
+    if total == 0:
+        print("No samples")
+        return
+
+    rows = defaultdict(int)
+    for (pc, ctx), count in samples.items():
+        function, offset = symbols.function_get(pc)
+        key = [function]
+        if by_pc:
+            key[0] = function if offset is None else "{}+0x{:x}".format(function, offset)
+        if by_context:
+            key.append(symbols.context_get(ctx))
+        rows[tuple(key)] += count
+
+    print("Samples: {}".format(total))
+    print("{:>8} {:>7}  {}".format("samples", "%", "location"))
+    for key, count in sorted(rows.items(), key=lambda r: r[1], reverse=True)[:top]:
+        print("{:8} {:6.2f}%  {}".format(count, 100 * count / total, "  ".join(key)))
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='Symbolizing CPU sampling profiler results.')
+    parser.add_argument('elf_file', help='ELF file of the profiled firmware')
+    source = parser.add_mutually_exclusive_group(required=True)
+    source.add_argument('--dataset', help='Name of nrf_profiler dataset with cpu_sample events')
+    source.add_argument('--shell-log', help='File with the output of "cpu_sampler show"')
+    parser.add_argument('--by-context', action='store_true',
+                        help='Show the thread or interrupt of every location')
+    parser.add_argument('--by-pc', action='store_true',
+                        help='Show every sampled address instead of the functions')
+    parser.add_argument('--top', type=int, default=20, help='Number of locations to show')
+    args = parser.parse_args()
+
+    try:
+        symbols = SymbolTable(args.elf_file)
+    except IOError as err:
+        print("Cannot read ELF file: {}".format(err))
+        sys.exit(1)
+
+    if args.dataset is not None:
+        samples = read_samples_from_dataset(args.dataset)
+    else:
+        samples = read_samples_from_shell_log(args.shell_log)
+
+    print_report(samples, symbols, args.by_context, args.by_pc, args.top)
+
+if __name__ == "__main__":
+    main()
@@ -9,8 +9,9 @@ import time
 import logging
 import signal
 from stream import Stream
-from rtt2stream import Rtt2Stream
+from capture2stream import Capture2Stream, CaptureError, read_capture_header
 from model_creator import ModelCreator
+from rtt_nordic_config import RttNordicConfig
 
 is_waiting = True
 def signal_handler(sig, frame):
@@ -19,6 +20,8 @@ def signal_handler(sig, frame):
 
 def rtt2stream(stream, event, event_close, log_lvl_number):
     signal.signal(signal.SIGINT, signal.SIG_IGN)
+    # Imported here, as reading captures does not require pynrfjprog.
+    from rtt2stream import Rtt2Stream
     try:
         rtt2s = Rtt2Stream(stream, event_close, log_lvl=log_lvl_number)
         event.wait()
@@ -26,12 +29,22 @@ def rtt2stream(stream, event, event_close, log_lvl_number):
     except Exception as e:
         print("[ERROR] Unhandled exception in Profiler Rtt to stream module: {}".format(e))
 
-def model_creator(stream, event, event_close, dataset_name, log_lvl_number):
+def capture2stream(stream, event, event_close, filename, log_lvl_number):
+    signal.signal(signal.SIGINT, signal.SIG_IGN)
+    try:
+        c2s = Capture2Stream(stream, event_close, filename, log_lvl=log_lvl_number)
+        event.wait()
+        c2s.read_and_transmit_data()
+    except Exception as e:
+        print("[ERROR] Unhandled exception in Profiler capture to stream module: {}".format(e))
+
+def model_creator(stream, event, event_close, dataset_name, config, log_lvl_number):
     signal.signal(signal.SIGINT, signal.SIG_IGN)
     try:
         mc = ModelCreator(stream,
                           event_close,
                           sending_events=False,
+                          config=config,
                           event_filename=dataset_name + ".csv",
                           event_types_filename=dataset_name + ".json",
                           log_lvl=log_lvl_number)
@@ -49,6 +62,9 @@ def main():
     parser.add_argument('time', type=int, help='Time of collecting data [s]')
     parser.add_argument('dataset_name', help='Name of dataset')
     parser.add_argument('--log', help='Log level')
+    parser.add_argument('--capture',
+                        help='Read data from a capture written by the UART, flash or file backend '
+                             'instead of from the device over RTT')
     args = parser.parse_args()
 
     if args.log is not None:
@@ -64,14 +80,32 @@ def main():
 
     streams = Stream.create_stream(2)
 
+    config = RttNordicConfig
+    if args.capture is not None:
+        try:
+            with open(args.capture, 'rb') as f:
+                timestamp_freq = read_capture_header(f.read())
+        except (IOError, CaptureError) as err:
+            print("[ERROR] Cannot read capture: {}".format(err))
+            return
+        config = dict(RttNordicConfig, ms_per_timestamp_tick=1000 / timestamp_freq)
+
     processes = []
-    processes.append((Process(target=rtt2stream,
-                                args=(streams[0], event, event_close_rtt2stream, log_lvl_number),
-                                daemon=True),
-                        event_close_rtt2stream))
+    if args.capture is not None:
+        processes.append((Process(target=capture2stream,
+                                    args=(streams[0], event, event_close_rtt2stream,
+                                        args.capture, log_lvl_number),
+                                    daemon=True),
+                            event_close_rtt2stream))
+    else:
+        processes.append((Process(target=rtt2stream,
+                                    args=(streams[0], event, event_close_rtt2stream,
+                                        log_lvl_number),
+                                    daemon=True),
+                            event_close_rtt2stream))
     processes.append((Process(target=model_creator,
                                 args=(streams[1], event, event_close_model_creator,
-                                    args.dataset_name, log_lvl_number),
+                                    args.dataset_name, config, log_lvl_number),
                                 daemon=True),
                         event_close_model_creator))
 
@@ -9,7 +9,7 @@ import logging
 import json
 from rtt_nordic_config import RttNordicConfig
 from events import Event, EventType, TrackedEvent, EventsData
-from processed_events import ProcessedEvents
+from processed_events import ProcessedEvents, NRF_PROFILER_DROPPED_EVENTS_EVENT_NAME
 from stream import StreamError
 from io import StringIO
 import csv
@@ -19,7 +19,12 @@ class Command(Enum):
     STOP = 2
     INFO = 3
 
-NRF_PROFILER_FATAL_ERROR_EVENT_NAME = "_nrf_profiler_fatal_error_event_"
+# First field of the description line that announces the data format
+NRF_PROFILER_FORMAT_LINE_NAME = "#nrf_profiler"
+# Data format used by devices that do not announce it
+NRF_PROFILER_LEGACY_FORMAT_VERSION = 1
+# Event type ID value marking a timestamp synchronization record
+NRF_PROFILER_SYNC_RECORD_ID = 0
 
 class ModelCreator:
 
@@ -49,6 +54,12 @@ class ModelCreator:
         self.timestamp_overflows = 0
         self.after_half = False
 
+        self.format_version = NRF_PROFILER_LEGACY_FORMAT_VERSION
+        self.timestamp_freq = None
+        self.last_timestamp_raw = None
+        self.bytes_received = 0
+        self.events_received = 0
+
         self.processed_events = ProcessedEvents()
         self.temp_events = []
         self.submitted_event_type = None
@@ -86,6 +97,7 @@ class ModelCreator:
                 buf.extend(tbuf[0:size])
                 self.bufs[0] = tbuf[size:]
         self.bcnt -= num_bytes
+        self.bytes_received += num_bytes
         return buf
 
     def _read_bytes(self, num_bytes):
@@ -113,6 +125,20 @@ class ModelCreator:
         ts_s = ts_ticks_aggregated * self.config['ms_per_timestamp_tick'] / 1000
         return ts_s
 
+    def _read_varint(self):
+        value = 0
+        shift = 0
+        while True:
+            byte = self._read_bytes(1)[0]
+            value |= (byte & 0x7f) << shift
+            if byte < 0x80:
+                return value
+            shift += 7
+
+    def _read_zigzag(self):
+        value = self._read_varint()
+        return (value >> 1) ^ -(value & 1)
+
     def transmit_all_events_descriptions(self):
         while True:
             try:
@@ -133,6 +159,10 @@ class ModelCreator:
             # Empty field is sent after last event description
             if len(row) == 0:
                 break
+            if row[0] == NRF_PROFILER_FORMAT_LINE_NAME:
+                self.format_version = int(row[1])
+                self.timestamp_freq = int(row[2])
+                continue
             name = row[0]
             id = int(row[1])
             data_type = row[2:len(row) // 2 + 1]
@@ -157,6 +187,54 @@ class ModelCreator:
                 sys.exit()
 
     def _read_single_event(self):
+        if self.format_version == NRF_PROFILER_LEGACY_FORMAT_VERSION:
+            event = self._read_single_event_legacy()
+        else:
+            event = self._read_single_event_v2()
+        self.events_received += 1
+        return event
+
+    def _read_single_event_v2(self):
+        id = self._read_varint()
+        while id == NRF_PROFILER_SYNC_RECORD_ID:
+            self.last_timestamp_raw = int.from_bytes(self._read_bytes(8),
+                                                     byteorder=self.config['byteorder'],
+                                                     signed=False)
+            id = self._read_varint()
+        # Event type IDs are sent increased by one
+        id -= 1
+        et = self.raw_data.registered_events_types[id]
+
+        delta = self._read_zigzag()
+        if self.last_timestamp_raw is None:
+            self.logger.error("Event received before timestamp synchronization")
+            self.close()
+        self.last_timestamp_raw += delta
+        timestamp = self.last_timestamp_raw / self.timestamp_freq
+
+        def read_fixed(self, size, signed):
+            buf = self._read_bytes(size)
+            return int.from_bytes(buf, byteorder=self.config['byteorder'], signed=signed)
+
+        def process_string(self):
+            buf = self._read_bytes(self._read_varint())
+            return buf.decode()
+
+        READ_FIELD = {
+            "u8": lambda self: read_fixed(self, 1, False),
+            "s8": lambda self: read_fixed(self, 1, True),
+            "u16": lambda self: self._read_varint(),
+            "s16": lambda self: self._read_zigzag(),
+            "u32": lambda self: self._read_varint(),
+            "s32": lambda self: self._read_zigzag(),
+            "s": process_string,
+            "t": lambda self: self._read_varint(),
+            "a": lambda self: read_fixed(self, 4, False)
+        }
+        data = [READ_FIELD[event_data_type](self) for event_data_type in et.data_types]
+        return Event(id, timestamp, data)
+
+    def _read_single_event_legacy(self):
         id = int.from_bytes(
             self._read_bytes(1),
             byteorder=self.config['byteorder'],
@@ -224,7 +302,8 @@ class ModelCreator:
             "u32": process_uint32,
             "s32": process_int32,
             "s": process_string,
-            "t": process_uint32
+            "t": process_uint32,
+            "a": process_uint32
         }
         data=[]
         for event_data_type in et.data_types:
@@ -253,9 +332,10 @@ class ModelCreator:
                 self.event_types_filename)
         while True:
             event = self._read_single_event()
-            if self.raw_data.registered_events_types[event.type_id].name == NRF_PROFILER_FATAL_ERROR_EVENT_NAME:
-                self.logger.error("Fatal error of Profiler on device! Event has been dropped. "
-                                  "Data buffer has overflown. No more events will be received.")
+            if self.raw_data.registered_events_types[event.type_id].name == \
+               NRF_PROFILER_DROPPED_EVENTS_EVENT_NAME:
+                self.logger.warning("Profiler on device dropped {} events. "
+                                    "Data buffer has overflown.".format(event.data[0]))
 
             if event.type_id == self.event_processing_start_id:
                 self.start_event = event
@@ -299,6 +379,9 @@ class ModelCreator:
 
     def close(self):
         self.logger.info("Real time transmission closed")
+        if self.events_received > 0:
+            self.logger.info("Received {} events, {:.2f} bytes per event".format(
+                self.events_received, self.bytes_received / self.events_received))
         self.shutdown()
         self.logger.info("Events data saved to files")
         sys.exit()
@@ -11,6 +11,7 @@ import hashlib
 import sys
 
 EM_MEM_ADDRESS_DATA_DESC = "_em_mem_address_"
+NRF_PROFILER_DROPPED_EVENTS_EVENT_NAME = "_nrf_profiler_dropped_events_"
 
 class ProcessedEvents():
     def __init__(self):
@@ -3,7 +3,7 @@
 #
 # SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
 
-from processed_events import ProcessedEvents
+from processed_events import ProcessedEvents, NRF_PROFILER_DROPPED_EVENTS_EVENT_NAME
 from enum import Enum
 import matplotlib.pyplot as plt
 import numpy as np
@@ -34,6 +34,20 @@ class StatsNordic():
         self.logger_console.setFormatter(self.log_format)
         self.logger.addHandler(self.logger_console)
 
+    def check_dropped_events(self, start_meas, end_meas):
+        event_type_id = self.processed_data.get_event_type_id(
+            NRF_PROFILER_DROPPED_EVENTS_EVENT_NAME)
+        if event_type_id is None:
+            return 0
+
+        dropped = sum(ev.submit.data[0] for ev in self.processed_data.tracked_events
+                      if ev.submit.type_id == event_type_id and
+                      start_meas <= ev.submit.timestamp <= end_meas)
+        if dropped > 0:
+            self.logger.warning("Profiler on device dropped {} events during the measurement. "
+                                "Calculated stats may be inaccurate".format(dropped))
+        return dropped
+
     def calculate_stats_preset1(self, start_meas, end_meas):
         self.time_between_events("hid_mouse_event_dongle", EventState.SUBMIT,
                                  "hid_report_sent_event_device", EventState.SUBMIT,
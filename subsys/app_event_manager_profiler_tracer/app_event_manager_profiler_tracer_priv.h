@@ -19,7 +19,7 @@ extern "C" {
 /* Wrappers used for defining event infos */
 #ifdef CONFIG_APP_EVENT_MANAGER_PROFILER_TRACER_TRACE_EVENT_EXECUTION
 #define EM_MEM_ADDRESS_LABEL "_em_mem_address_",
-#define MEM_ADDRESS_TYPE NRF_PROFILER_ARG_U32,
+#define MEM_ADDRESS_TYPE NRF_PROFILER_ARG_MEM_ADDRESS,
 
 #else
 #define EM_MEM_ADDRESS_LABEL
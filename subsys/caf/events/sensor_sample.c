@@ -0,0 +1,245 @@
+/*
+ * Copyright (c) 2022 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include <string.h>
+#include <zephyr/sys/util.h>
+
+#include <caf/sensor_sample.h>
+
+#ifdef CONFIG_CMSIS_DSP
+#include <arm_math.h>
+#endif /* CONFIG_CMSIS_DSP */
+
+/* This value has to be equal to fractional part of the sensor_value. */
+#define SENSOR_VALUE_FRAC_SCALE 1000000
+
+static bool is_format_valid(const struct sensor_sample_format *format)
+{
+	switch (format->type) {
+	case SENSOR_SAMPLE_TYPE_Q15:
+		return format->frac_bits <= SENSOR_SAMPLE_Q15_FRAC_BITS_MAX;
+	case SENSOR_SAMPLE_TYPE_Q31:
+		return format->frac_bits <= SENSOR_SAMPLE_Q31_FRAC_BITS_MAX;
+	default:
+		return true;
+	}
+}
+
+static int64_t saturate(int64_t val, int64_t min, int64_t max)
+{
+	return CLAMP(val, min, max);
+}
+
+static int64_t sensor_value_to_fixed(const struct sensor_value *val, uint8_t frac_bits)
+{
+	int64_t micro = ((int64_t)val->val1 * SENSOR_VALUE_FRAC_SCALE) + val->val2;
+	int64_t limit = INT64_MAX >> frac_bits;
+
+	/* Values this big are saturated by the caller anyway. */
+	if (micro > limit) {
+		return INT64_MAX / SENSOR_VALUE_FRAC_SCALE;
+	} else if (micro < -limit) {
+		return INT64_MIN / SENSOR_VALUE_FRAC_SCALE;
+	}
+
+	int64_t scaled = micro * ((int64_t)1 << frac_bits);
+
+	/* Round to nearest. */
+	if (scaled >= 0) {
+		scaled += SENSOR_VALUE_FRAC_SCALE / 2;
+	} else {
+		scaled -= SENSOR_VALUE_FRAC_SCALE / 2;
+	}
+
+	return scaled / SENSOR_VALUE_FRAC_SCALE;
+}
+
+static int64_t rescale(int64_t val, uint8_t from_frac_bits, uint8_t to_frac_bits)
+{
+	if (from_frac_bits > to_frac_bits) {
+		return val >> (from_frac_bits - to_frac_bits);
+	}
+
+	return val * ((int64_t)1 << (to_frac_bits - from_frac_bits));
+}
+
+void sensor_sample_from_sensor_value(const struct sensor_sample_format *format,
+				     const struct sensor_value *src, void *dst, size_t cnt)
+{
+	__ASSERT(is_format_valid(format), "Invalid number of fractional bits: %u",
+		 format->frac_bits);
+
+	switch (format->type) {
+	case SENSOR_SAMPLE_TYPE_Q15:
+	{
+		int16_t *out = dst;
+
+		for (size_t i = 0; i < cnt; i++) {
+			out[i] = saturate(sensor_value_to_fixed(&src[i], format->frac_bits),
+					  INT16_MIN, INT16_MAX);
+		}
+		break;
+	}
+
+	case SENSOR_SAMPLE_TYPE_Q31:
+	{
+		int32_t *out = dst;
+
+		for (size_t i = 0; i < cnt; i++) {
+			out[i] = saturate(sensor_value_to_fixed(&src[i], format->frac_bits),
+					  INT32_MIN, INT32_MAX);
+		}
+		break;
+	}
+
+	case SENSOR_SAMPLE_TYPE_SENSOR_VALUE:
+		memcpy(dst, src, cnt * sizeof(struct sensor_value));
+		break;
+
+	default:
+		__ASSERT_NO_MSG(false);
+		break;
+	}
+}
+
+void sensor_sample_to_float(const struct sensor_sample_format *format,
+			    const void *src, float *dst, size_t cnt)
+{
+	__ASSERT(is_format_valid(format), "Invalid number of fractional bits: %u",
+		 format->frac_bits);
+
+	switch (format->type) {
+	case SENSOR_SAMPLE_TYPE_Q15:
+	{
+#ifdef CONFIG_CMSIS_DSP
+		/* CMSIS-DSP treats the values as Q1.15, adjust the scale afterwards. */
+		arm_q15_to_float(src, dst, cnt);
+		if (format->frac_bits != 15) {
+			arm_scale_f32(dst, (float)(1ULL << 15) / (float)(1ULL << format->frac_bits),
+				      dst, cnt);
+		}
+#else
+		const int16_t *in = src;
+		float scale = 1.0f / (float)(1ULL << format->frac_bits);
+
+		for (size_t i = 0; i < cnt; i++) {
+			dst[i] = in[i] * scale;
+		}
+#endif /* CONFIG_CMSIS_DSP */
+		break;
+	}
+
+	case SENSOR_SAMPLE_TYPE_Q31:
+	{
+#ifdef CONFIG_CMSIS_DSP
+		/* CMSIS-DSP treats the values as Q1.31, adjust the scale afterwards. */
+		arm_q31_to_float(src, dst, cnt);
+		if (format->frac_bits != 31) {
+			arm_scale_f32(dst, (float)(1ULL << 31) / (float)(1ULL << format->frac_bits),
+				      dst, cnt);
+		}
+#else
+		const int32_t *in = src;
+		float scale = 1.0f / (float)(1ULL << format->frac_bits);
+
+		for (size_t i = 0; i < cnt; i++) {
+			dst[i] = in[i] * scale;
+		}
+#endif /* CONFIG_CMSIS_DSP */
+		break;
+	}
+
+	case SENSOR_SAMPLE_TYPE_SENSOR_VALUE:
+	{
+		const struct sensor_value *in = src;
+
+		for (size_t i = 0; i < cnt; i++) {
+			dst[i] = in[i].val1 + (float)in[i].val2 / SENSOR_VALUE_FRAC_SCALE;
+		}
+		break;
+	}
+
+	default:
+		__ASSERT_NO_MSG(false);
+		break;
+	}
+}
+
+void sensor_sample_to_q15(const struct sensor_sample_format *format,
+			  const void *src, int16_t *dst, size_t cnt, uint8_t frac_bits)
+{
+	__ASSERT(is_format_valid(format), "Invalid number of fractional bits: %u",
+		 format->frac_bits);
+	__ASSERT(frac_bits <= SENSOR_SAMPLE_Q15_FRAC_BITS_MAX,
+		 "Invalid number of fractional bits: %u", frac_bits);
+
+	switch (format->type) {
+	case SENSOR_SAMPLE_TYPE_Q15:
+	{
+		const int16_t *in = src;
+
+		if (format->frac_bits == frac_bits) {
+			memmove(dst, src, cnt * sizeof(int16_t));
+			break;
+		}
+
+		for (size_t i = 0; i < cnt; i++) {
+			dst[i] = saturate(rescale(in[i], format->frac_bits, frac_bits),
+					  INT16_MIN, INT16_MAX);
+		}
+		break;
+	}
+
+	case SENSOR_SAMPLE_TYPE_Q31:
+	{
+		const int32_t *in = src;
+
+		for (size_t i = 0; i < cnt; i++) {
+			dst[i] = saturate(rescale(in[i], format->frac_bits, frac_bits),
+					  INT16_MIN, INT16_MAX);
+		}
+		break;
+	}
+
+	case SENSOR_SAMPLE_TYPE_SENSOR_VALUE:
+	{
+		/* Not a constant, range is checked above. */
+		const struct sensor_sample_format q15 = {
+			.type = SENSOR_SAMPLE_TYPE_Q15,
+			.frac_bits = frac_bits,
+		};
+
+		sensor_sample_from_sensor_value(&q15, src, dst, cnt);
+		break;
+	}
+
+	default:
+		__ASSERT_NO_MSG(false);
+		break;
+	}
+}
+
+void sensor_sample_q15_delta_encode(const int16_t *src, int16_t *dst, size_t cnt)
+{
+	int16_t prev = 0;
+
+	for (size_t i = 0; i < cnt; i++) {
+		int16_t cur = src[i];
+
+		dst[i] = (int16_t)((uint16_t)cur - (uint16_t)prev);
+		prev = cur;
+	}
+}
+
+void sensor_sample_q15_delta_decode(const int16_t *src, int16_t *dst, size_t cnt)
+{
+	int16_t prev = 0;
+
+	for (size_t i = 0; i < cnt; i++) {
+		prev = (int16_t)((uint16_t)prev + (uint16_t)src[i]);
+		dst[i] = prev;
+	}
+}
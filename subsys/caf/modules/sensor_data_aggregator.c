@@ -81,6 +81,8 @@ struct aggregator {
 	struct aggregator_buffer *agg_buffers;	/* Buffers. */
 	struct aggregator_buffer *active_buf;	/* Active buffer to which data will be placed. */
 	enum sensor_state sensor_state;		/* Sensors state. */
+	struct sensor_sample_format format;	/* Format of the sensor data. */
+	bool format_set;			/* Format taken from the first sensor event. */
 	const uint8_t sensor_data_size;		/* Size of sensor data in bytes. */
 	const uint8_t buf_count;		/* Number of buffers. */
 	const uint8_t buf_len;			/* Size of buffor data in bytes. */
@@ -133,33 +135,56 @@ static void send_buffer(struct aggregator *agg, struct aggregator_buffer *ab)
 	event->sample_cnt = ab->sample_cnt;
 	event->sensor_state = agg->sensor_state;
 	event->sensor_descr = agg->sensor_descr;
+	event->format = agg->format;
 	APP_EVENT_SUBMIT(event);
 }
 
-static int enqueue_sample(struct aggregator *agg, struct sensor_event *event)
+static int enqueue_samples(struct aggregator *agg, struct sensor_event *event)
 {
-	if (event->dyndata.size != agg->sensor_data_size) {
+	if ((event->dyndata.size == 0) ||
+	    ((event->dyndata.size % agg->sensor_data_size) != 0)) {
 		return -EBADMSG;
 	}
-	if (!agg->active_buf) {
-		return -ENOMEM;
+
+	if (!agg->format_set) {
+		agg->format = event->format;
+		agg->format_set = true;
+	} else if ((event->format.type != agg->format.type) ||
+		   (event->format.frac_bits != agg->format.frac_bits)) {
+		/* Buffers carry a single format, sensor must not change it. */
+		return -EINVAL;
 	}
-	struct aggregator_buffer *ab = agg->active_buf;
 
-	size_t pos = ab->sample_cnt * agg->sensor_data_size;
-	size_t avail = agg->buf_len - pos;
+	const uint8_t *data = event->dyndata.data;
+	size_t left = event->dyndata.size;
 
-	if (avail < agg->sensor_data_size) {
-		__ASSERT_NO_MSG(false);
-		return -ENOMEM;
-	}
-	memcpy(&ab->data[pos], event->dyndata.data, event->dyndata.size);
-	ab->sample_cnt++;
-	avail -= event->dyndata.size;
+	/* Event may carry multiple samples, copy as many as fit in the buffer at once. */
+	while (left > 0) {
+		if (!agg->active_buf) {
+			return -ENOMEM;
+		}
+		struct aggregator_buffer *ab = agg->active_buf;
+
+		size_t pos = ab->sample_cnt * agg->sensor_data_size;
+		size_t avail = agg->buf_len - pos;
+
+		if (avail < agg->sensor_data_size) {
+			__ASSERT_NO_MSG(false);
+			return -ENOMEM;
+		}
 
-	if (avail < agg->sensor_data_size) {
-		send_buffer(agg, ab);
-		agg->active_buf = get_free_buffer(agg);
+		size_t len = MIN(left, avail - (avail % agg->sensor_data_size));
+
+		memcpy(&ab->data[pos], data, len);
+		ab->sample_cnt += len / agg->sensor_data_size;
+		data += len;
+		left -= len;
+		avail -= len;
+
+		if (avail < agg->sensor_data_size) {
+			send_buffer(agg, ab);
+			agg->active_buf = get_free_buffer(agg);
+		}
 	}
 
 	return 0;
@@ -172,7 +197,7 @@ static bool event_handler(const struct app_event_header *aeh)
 		struct aggregator *agg = get_aggregator(event->descr);
 
 		if (agg) {
-			int err = enqueue_sample(agg, event);
+			int err = enqueue_samples(agg, event);
 
 			if (err) {
 				LOG_ERR("Error code: %d", err);
@@ -23,6 +23,20 @@ LOG_MODULE_REGISTER(MODULE, CONFIG_CAF_SENSOR_MANAGER_LOG_LEVEL);
 
 #define SAMPLE_THREAD_STACK_SIZE	CONFIG_CAF_SENSOR_MANAGER_THREAD_STACK_SIZE
 #define SAMPLE_THREAD_PRIORITY		CONFIG_CAF_SENSOR_MANAGER_THREAD_PRIORITY
+#define COALESCE_WINDOW_MS		CONFIG_CAF_SENSOR_MANAGER_COALESCE_WINDOW_MS
+
+#ifdef CONFIG_CAF_SENSOR_MANAGER_SAMPLING_STATS
+#define STATS_INTERVAL_MS		CONFIG_CAF_SENSOR_MANAGER_SAMPLING_STATS_INTERVAL_MS
+#else
+#define STATS_INTERVAL_MS		0
+#endif
+
+struct sampling_stats {
+	uint32_t sample_cnt;
+	uint32_t drop_cnt;
+	int32_t jitter_min;
+	int32_t jitter_max;
+};
 
 struct sensor_data {
 	int sampling_period;
@@ -31,6 +45,9 @@ struct sensor_data {
 	atomic_t state;
 	unsigned int sleep_cntd;
 	atomic_t event_cnt;
+	struct sensor_event *batch_event;
+	uint8_t batch_sample_cnt;
+	struct sampling_stats stats;
 };
 
 static struct sensor_data sensor_data[ARRAY_SIZE(sensor_configs)];
@@ -52,21 +69,99 @@ static void update_sensor_state(const struct sm_sensor_config *sc, struct sensor
 	APP_EVENT_SUBMIT(event);
 }
 
-static void send_sensor_event(const char *descr, const struct sensor_value *data, const size_t data_cnt,
-			      atomic_t *event_cnt)
+static bool is_compact_format(const struct sm_sensor_config *sc)
+{
+	return sc->format.type != SENSOR_SAMPLE_TYPE_SENSOR_VALUE;
+}
+
+static void store_sample(const struct sm_sensor_config *sc, const struct sensor_value *data,
+			 void *dst, const size_t data_cnt)
 {
-	struct sensor_event *event = new_sensor_event(sizeof(struct sensor_value) * data_cnt);
-	struct sensor_value *data_ptr = sensor_event_get_data_ptr(event);
+	if (is_compact_format(sc)) {
+		sensor_sample_from_sensor_value(&sc->format, data, dst, data_cnt);
+	} else {
+		memcpy(dst, data, sizeof(struct sensor_value) * data_cnt);
+	}
+}
 
-	event->descr = descr;
+static void send_sensor_event(const struct sm_sensor_config *sc, const struct sensor_value *data,
+			      const size_t data_cnt, atomic_t *event_cnt)
+{
+	struct sensor_event *event =
+		new_sensor_event(sensor_sample_size(&sc->format) * data_cnt);
+
+	event->descr = sc->event_descr;
+	event->format = sc->format;
 
 	__ASSERT_NO_MSG(sensor_event_get_data_cnt(event) == data_cnt);
-	memcpy(data_ptr, data, sizeof(struct sensor_value) * data_cnt);
+	store_sample(sc, data, sensor_event_get_raw_data_ptr(event), data_cnt);
 
 	atomic_inc(event_cnt);
 	APP_EVENT_SUBMIT(event);
 }
 
+static size_t get_sensor_data_cnt(const struct sm_sensor_config *sc)
+{
+	size_t data_cnt = 0;
+
+	for (size_t i = 0; i < sc->chan_cnt; i++) {
+		data_cnt += sc->chans[i].data_cnt;
+	}
+
+	return data_cnt;
+}
+
+static uint8_t get_samples_per_event(const struct sm_sensor_config *sc)
+{
+	return (sc->samples_per_event > 1) ? sc->samples_per_event : 1;
+}
+
+static void submit_batch_event(const struct sm_sensor_config *sc, struct sensor_data *sd)
+{
+	struct sensor_event *event = sd->batch_event;
+
+	if (!event) {
+		return;
+	}
+
+	sd->batch_event = NULL;
+
+	if (sd->batch_sample_cnt == 0) {
+		app_event_manager_free(event);
+		atomic_dec(&sd->event_cnt);
+		return;
+	}
+
+	/* Partially filled batches carry only the gathered samples. */
+	event->dyndata.size = sensor_sample_size(&sc->format) * get_sensor_data_cnt(sc) *
+			      sd->batch_sample_cnt;
+	sd->batch_sample_cnt = 0;
+
+	APP_EVENT_SUBMIT(event);
+}
+
+static void *get_batch_sample_ptr(const struct sm_sensor_config *sc,
+				  struct sensor_data *sd,
+				  const size_t data_cnt)
+{
+	size_t sample_size = sensor_sample_size(&sc->format) * data_cnt;
+
+	if (!sd->batch_event) {
+		if (atomic_get(&sd->event_cnt) >= sc->active_events_limit) {
+			return NULL;
+		}
+
+		sd->batch_event = new_sensor_event(sample_size * get_samples_per_event(sc));
+		sd->batch_event->descr = sc->event_descr;
+		sd->batch_event->format = sc->format;
+		sd->batch_sample_cnt = 0;
+		atomic_inc(&sd->event_cnt);
+	}
+
+	return (uint8_t *)sensor_event_get_raw_data_ptr(sd->batch_event) +
+	       (sample_size * sd->batch_sample_cnt);
+}
+
 static struct sensor_data *get_sensor_data(const struct device *dev)
 {
 	for (size_t i = 0; i < ARRAY_SIZE(sensor_configs); i++) {
@@ -94,17 +189,6 @@ static const struct sm_sensor_config *get_sensor_config(const struct device *dev
 	return NULL;
 }
 
-static size_t get_sensor_data_cnt(const struct sm_sensor_config *sc)
-{
-	size_t data_cnt = 0;
-
-	for (size_t i = 0; i < sc->chan_cnt; i++) {
-		data_cnt += sc->chans[i].data_cnt;
-	}
-
-	return data_cnt;
-}
-
 static void reset_sensor_sleep_cnt(const struct sm_sensor_config *sc,
 				   struct sensor_data *sd)
 {
@@ -215,12 +299,9 @@ static void enter_sleep(const struct sm_sensor_config *sc,
 	k_sched_unlock();
 }
 
-static void sample_sensor(struct sensor_data *sd, const struct sm_sensor_config *sc)
+static int read_sample(const struct sm_sensor_config *sc, struct sensor_value *data)
 {
 	size_t data_idx = 0;
-	size_t data_cnt = get_sensor_data_cnt(sc);
-	struct sensor_value data[data_cnt];
-
 	int err = sensor_sample_fetch(sc->dev);
 
 	for (size_t i = 0; !err && (i < sc->chan_cnt); i++) {
@@ -230,25 +311,109 @@ static void sample_sensor(struct sensor_data *sd, const struct sm_sensor_config
 		data_idx += sampled_chan->data_cnt;
 	}
 
-	if (err) {
-		LOG_ERR("Sensor sampling error (err %d)", err);
-		update_sensor_state(sc, sd, SENSOR_STATE_ERROR);
+	return err;
+}
+
+static void process_sample(struct sensor_data *sd, const struct sm_sensor_config *sc,
+			   const struct sensor_value *data, size_t data_cnt)
+{
+	bool batched = (get_samples_per_event(sc) > 1);
+	void *batch_ptr = batched ? get_batch_sample_ptr(sc, sd, data_cnt) : NULL;
+
+	if (batch_ptr) {
+		store_sample(sc, data, batch_ptr, data_cnt);
+		sd->batch_sample_cnt++;
+	} else if (!batched && (atomic_get(&sd->event_cnt) < sc->active_events_limit)) {
+		send_sensor_event(sc, data, data_cnt, &sd->event_cnt);
 	} else {
-		if (atomic_get(&sd->event_cnt) < sc->active_events_limit) {
-			send_sensor_event(sc->event_descr, data, ARRAY_SIZE(data),
-					  &sd->event_cnt);
-		} else {
-			LOG_WRN("Did not send event due to too many active events on sensor: %s",
-				sc->dev->name);
+		LOG_WRN("Did not send event due to too many active events on sensor: %s",
+			sc->dev->name);
+	}
+
+	if (sc->trigger && IS_ENABLED(CONFIG_CAF_SENSOR_MANAGER_PM)) {
+		process_sensor_activity(sc, sd, data);
+		if (!is_sensor_active(sd)) {
+			submit_batch_event(sc, sd);
+			enter_sleep(sc, sd);
 		}
 
-		if (sc->trigger && IS_ENABLED(CONFIG_CAF_SENSOR_MANAGER_PM)) {
-			process_sensor_activity(sc, sd, data);
-			if (!is_sensor_active(sd)) {
-				enter_sleep(sc, sd);
-			}
+	}
 
+	if (sd->batch_sample_cnt == get_samples_per_event(sc)) {
+		submit_batch_event(sc, sd);
+	}
+}
+
+static size_t sample_sensor(struct sensor_data *sd, const struct sm_sensor_config *sc)
+{
+	size_t data_cnt = get_sensor_data_cnt(sc);
+	struct sensor_value data[data_cnt];
+	/* Twice the batch size lets the reader catch up with the sensor clock,
+	 * while a driver that never reports an empty FIFO cannot stall the thread.
+	 */
+	size_t max_samples = sc->fifo ? (2 * get_samples_per_event(sc)) : 1;
+	size_t sample_cnt = 0;
+
+	while ((sample_cnt < max_samples) &&
+	       (atomic_get(&sd->state) == SENSOR_STATE_ACTIVE)) {
+		int err = read_sample(sc, data);
+
+		if (sc->fifo && (err == -ENODATA)) {
+			break;
+		}
+
+		/* Locking the scheduler to prevent concurrent access to the batch event,
+		 * it can be submitted on power down. Sensor is read before, as reading
+		 * may block.
+		 */
+		k_sched_lock();
+
+		if (err) {
+			LOG_ERR("Sensor sampling error (err %d)", err);
+			submit_batch_event(sc, sd);
+			update_sensor_state(sc, sd, SENSOR_STATE_ERROR);
+		} else {
+			process_sample(sd, sc, data, data_cnt);
+			sample_cnt++;
 		}
+
+		k_sched_unlock();
+	}
+
+	return sample_cnt;
+}
+
+static void update_sampling_stats(struct sensor_data *sd, int64_t cur_uptime,
+				  size_t samples, int64_t drops)
+{
+	struct sampling_stats *stats = &sd->stats;
+	int32_t jitter = cur_uptime - sd->sample_timeout;
+
+	if ((stats->sample_cnt == 0) && (stats->drop_cnt == 0)) {
+		stats->jitter_min = jitter;
+		stats->jitter_max = jitter;
+	} else {
+		stats->jitter_min = MIN(stats->jitter_min, jitter);
+		stats->jitter_max = MAX(stats->jitter_max, jitter);
+	}
+
+	stats->sample_cnt += samples;
+	stats->drop_cnt += drops;
+}
+
+static void report_sampling_stats(uint32_t wakeup_cnt)
+{
+	LOG_INF("Sampling thread wake-ups: %u", (unsigned int)wakeup_cnt);
+
+	for (size_t i = 0; i < ARRAY_SIZE(sensor_data); i++) {
+		struct sampling_stats *stats = &sensor_data[i].stats;
+
+		LOG_INF("%s: samples: %u dropped: %u jitter: %d..%d ms",
+			sensor_configs[i].dev->name, (unsigned int)stats->sample_cnt,
+			(unsigned int)stats->drop_cnt, (int)stats->jitter_min,
+			(int)stats->jitter_max);
+
+		memset(stats, 0, sizeof(*stats));
 	}
 }
 
@@ -256,6 +421,10 @@ static size_t sample_sensors(int64_t *next_timeout)
 {
 	size_t alive_sensors = 0;
 	int64_t cur_uptime = k_uptime_get();
+	/* Sensors that are due within the coalescing window are sampled now
+	 * to avoid separate wake-ups for sensors with close deadlines.
+	 */
+	int64_t sample_limit = cur_uptime + COALESCE_WINDOW_MS;
 
 	*next_timeout = INT64_MAX;
 
@@ -264,19 +433,35 @@ static size_t sample_sensors(int64_t *next_timeout)
 		const struct sm_sensor_config *sc = &sensor_configs[i];
 
 		if (atomic_get(&sd->state) == SENSOR_STATE_ACTIVE) {
-			if (sd->sample_timeout <= cur_uptime) {
-				sample_sensor(sd, sc);
-			}
+			if (sd->sample_timeout <= sample_limit) {
+				size_t samples = sample_sensor(sd, sc);
+
+				/* Deadlines stay on the sampling period grid. A single
+				 * sample is taken for all of the deadlines up to the
+				 * sample limit. Apart from the first one, they are
+				 * dropped: either they already passed or they fall within
+				 * the coalescing window. Samples of a sensor with FIFO are
+				 * buffered and read in this wake-up.
+				 */
+				int64_t missed = (sample_limit - sd->sample_timeout) /
+						 sd->sampling_period;
+				int64_t drops = sc->fifo ? 0 : missed;
 
-			int drops = -1;
-			while (sd->sample_timeout <= cur_uptime) {
-				sd->sample_timeout += sd->sampling_period;
-				drops++;
-			}
+				if (STATS_INTERVAL_MS > 0) {
+					update_sampling_stats(sd, cur_uptime, samples, drops);
+				}
 
-			if (drops > 0) {
-				LOG_WRN("%d sample dropped", drops);
+				sd->sample_timeout += (missed + 1) * sd->sampling_period;
+
+				if (drops > 0) {
+					LOG_WRN("%d sample dropped", (int)drops);
+				}
 			}
+		} else if (sd->batch_event) {
+			/* Sensor was suspended, do not hold the gathered samples. */
+			k_sched_lock();
+			submit_batch_event(sc, sd);
+			k_sched_unlock();
 		}
 
 		if (atomic_get(&sd->state) != SENSOR_STATE_ERROR) {
@@ -387,8 +572,14 @@ static size_t sensor_init(void)
 			LOG_ERR("%s sensor not ready", sc->dev->name);
 			continue;
 		}
-		sd->sampling_period = sc->sampling_period_ms;
-		sd->sample_timeout = cur_uptime + sc->sampling_period_ms;
+		__ASSERT(COALESCE_WINDOW_MS < sc->sampling_period_ms,
+			 "Coalescing window must be shorter than the sampling period of %s",
+			 sc->dev->name);
+
+		/* Sensor with FIFO is read once per batch. */
+		sd->sampling_period = sc->sampling_period_ms *
+				      (sc->fifo ? get_samples_per_event(sc) : 1);
+		sd->sample_timeout = cur_uptime + sd->sampling_period;
 
 		if (sc->trigger && IS_ENABLED(CONFIG_CAF_SENSOR_MANAGER_PM)) {
 			int err = sensor_trigger_init(sc, sd);
@@ -411,6 +602,8 @@ static void sample_thread_fn(void)
 {
 	size_t alive_sensors = 0;
 	int64_t next_timeout = 0;
+	int64_t next_stats_report = STATS_INTERVAL_MS;
+	uint32_t wakeup_cnt = 0;
 
 	k_sem_init(&can_sample, 0, 1);
 
@@ -424,6 +617,16 @@ static void sample_thread_fn(void)
 
 			alive_sensors = sample_sensors(&next_timeout);
 			configure_max_power_state();
+
+			if (STATS_INTERVAL_MS > 0) {
+				wakeup_cnt++;
+
+				if (k_uptime_get() >= next_stats_report) {
+					report_sampling_stats(wakeup_cnt);
+					wakeup_cnt = 0;
+					next_stats_report += STATS_INTERVAL_MS;
+				}
+			}
 		}
 	}
 
@@ -446,6 +649,8 @@ static bool handle_power_down_event(const struct app_event_header *aeh)
 
 		/* Locking the scheduler to prevent concurrent access to sensor state. */
 		k_sched_lock();
+		/* Samples gathered before power down are not held until wake up. */
+		submit_batch_event(sc, sd);
 		if (atomic_get(&sd->state) != SENSOR_STATE_ERROR) {
 			if (sc->trigger) {
 				enter_sleep(sc, sd);
@@ -0,0 +1,322 @@
+/*
+ * Copyright (c) 2022 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/shell/shell.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/util.h>
+#include <zephyr/logging/log.h>
+#include <nrf_profiler.h>
+#include "cpu_sampler_priv.h"
+
+LOG_MODULE_REGISTER(cpu_sampler, CONFIG_CPU_SAMPLER_LOG_LEVEL);
+
+#define HISTOGRAM_SIZE CONFIG_CPU_SAMPLER_HISTOGRAM_SIZE
+BUILD_ASSERT(IS_POWER_OF_TWO(HISTOGRAM_SIZE), "Histogram size must be a power of two");
+
+/* Number of entries checked for a sampled location before the sample is lost */
+#define MAX_PROBES 8
+
+/* Highest supported sampling rate */
+#define RATE_MAX 10000
+
+/* Maximum number of entries printed by the shell */
+#define SHOW_MAX 32
+
+/* Entries are only added by the sampling context, which runs to completion
+ * over the code reading them. An entry is free as long as its count is zero,
+ * and its location does not change once the count is set.
+ */
+struct histogram_entry {
+	uintptr_t pc;
+	uintptr_t ctx;
+	atomic_t count;
+#ifdef CONFIG_CPU_SAMPLER_NRF_PROFILER
+	/* Count reported with the nRF Profiler, only used by the work item */
+	uint32_t reported;
+#endif
+};
+
+static struct histogram_entry histogram[HISTOGRAM_SIZE];
+static atomic_t samples;
+static atomic_t lost;
+/* Set while the histogram is cleared, samples taken meanwhile are dropped */
+static atomic_t resetting;
+static bool running;
+
+#ifdef CONFIG_CPU_SAMPLER_NRF_PROFILER
+static struct k_work_delayable report_work;
+static uint16_t report_event_id;
+static bool report_initialized;
+static size_t report_pos;
+#endif
+
+static size_t slot_get(uintptr_t pc, uintptr_t ctx)
+{
+	uint32_t hash = ((uint32_t)pc ^ ((uint32_t)ctx << 7)) * 2654435761U;
+
+	return (hash ^ (hash >> 16)) & (HISTOGRAM_SIZE - 1);
+}
+
+void cpu_sampler_sample(uintptr_t pc, uintptr_t ctx)
+{
+	size_t slot = slot_get(pc, ctx);
+
+	atomic_inc(&samples);
+
+	if (atomic_get(&resetting)) {
+		return;
+	}
+
+	for (size_t i = 0; i < MAX_PROBES; i++) {
+		struct histogram_entry *e = &histogram[(slot + i) & (HISTOGRAM_SIZE - 1)];
+
+		if (atomic_get(&e->count) == 0) {
+			e->pc = pc;
+			e->ctx = ctx;
+			atomic_set(&e->count, 1);
+			return;
+		}
+
+		if ((e->pc == pc) && (e->ctx == ctx)) {
+			atomic_inc(&e->count);
+			return;
+		}
+	}
+
+	atomic_inc(&lost);
+}
+
+#ifdef CONFIG_CPU_SAMPLER_NRF_PROFILER
+static void report_fn(struct k_work *work)
+{
+	size_t reported = 0;
+
+	/* Entries are reported in turns, so that every entry is reported even
+	 * if more of them change than fit in a batch.
+	 */
+	for (size_t i = 0; i < HISTOGRAM_SIZE; i++) {
+		struct histogram_entry *e = &histogram[report_pos];
+		uint32_t count = atomic_get(&e->count);
+
+		if (reported == CONFIG_CPU_SAMPLER_NRF_PROFILER_BATCH) {
+			break;
+		}
+
+		report_pos = (report_pos + 1) & (HISTOGRAM_SIZE - 1);
+
+		if (count < e->reported) {
+			/* The histogram was reset in the meantime. */
+			e->reported = 0;
+		}
+
+		if (count == e->reported) {
+			continue;
+		}
+
+		if (is_profiling_enabled(report_event_id)) {
+			struct log_event_buf buf;
+
+			nrf_profiler_log_start(&buf);
+			nrf_profiler_log_encode_uint32(&buf, (uint32_t)e->pc);
+			nrf_profiler_log_encode_uint32(&buf, (uint32_t)e->ctx);
+			nrf_profiler_log_encode_uint32(&buf, count - e->reported);
+			nrf_profiler_log_send(&buf, report_event_id);
+			reported++;
+		}
+
+		e->reported = count;
+	}
+
+	if (running) {
+		k_work_schedule(&report_work, K_MSEC(CONFIG_CPU_SAMPLER_NRF_PROFILER_INTERVAL));
+	}
+}
+
+static void report_init(void)
+{
+	static const char * const labels[] = {"pc", "ctx", "count"};
+	static const enum nrf_profiler_arg types[] = {NRF_PROFILER_ARG_U32,
+						      NRF_PROFILER_ARG_U32,
+						      NRF_PROFILER_ARG_U32};
+
+	if (!report_initialized) {
+		report_event_id = nrf_profiler_register_event_type("cpu_sample", labels, types,
+								   ARRAY_SIZE(labels));
+		k_work_init_delayable(&report_work, report_fn);
+		report_initialized = true;
+	}
+}
+#endif /* CONFIG_CPU_SAMPLER_NRF_PROFILER */
+
+int cpu_sampler_start(uint32_t rate)
+{
+	int err;
+
+	if ((rate == 0) || (rate > RATE_MAX)) {
+		return -EINVAL;
+	}
+
+	if (running) {
+		return -EALREADY;
+	}
+
+#ifdef CONFIG_CPU_SAMPLER_NRF_PROFILER
+	report_init();
+#endif
+
+	err = cpu_sampler_timer_start(rate);
+	if (err) {
+		return err;
+	}
+
+	running = true;
+
+#ifdef CONFIG_CPU_SAMPLER_NRF_PROFILER
+	k_work_schedule(&report_work, K_MSEC(CONFIG_CPU_SAMPLER_NRF_PROFILER_INTERVAL));
+#endif
+
+	return 0;
+}
+
+void cpu_sampler_stop(void)
+{
+	if (!running) {
+		return;
+	}
+
+	cpu_sampler_timer_stop();
+	running = false;
+
+#ifdef CONFIG_CPU_SAMPLER_NRF_PROFILER
+	/* Report the remaining samples. */
+	k_work_reschedule(&report_work, K_NO_WAIT);
+#endif
+}
+
+void cpu_sampler_reset(void)
+{
+	atomic_set(&resetting, true);
+	memset(histogram, 0, sizeof(histogram));
+	atomic_clear(&samples);
+	atomic_clear(&lost);
+	atomic_set(&resetting, false);
+}
+
+uint32_t cpu_sampler_samples_get(uint32_t *lost_samples)
+{
+	if (lost_samples) {
+		*lost_samples = atomic_get(&lost);
+	}
+
+	return atomic_get(&samples);
+}
+
+size_t cpu_sampler_top_get(struct cpu_sampler_entry *entries, size_t max_entries)
+{
+	size_t cnt = 0;
+
+	for (size_t i = 0; i < HISTOGRAM_SIZE; i++) {
+		const struct histogram_entry *e = &histogram[i];
+		uint32_t count = atomic_get(&e->count);
+		size_t pos;
+
+		if (count == 0) {
+			continue;
+		}
+
+		/* Insert the entry into the sorted output. */
+		for (pos = cnt; (pos > 0) && (entries[pos - 1].count < count); pos--) {
+			if (pos < max_entries) {
+				entries[pos] = entries[pos - 1];
+			}
+		}
+
+		if (pos < max_entries) {
+			entries[pos].pc = e->pc;
+			entries[pos].ctx = e->ctx;
+			entries[pos].count = count;
+			cnt = MIN(cnt + 1, max_entries);
+		}
+	}
+
+	return cnt;
+}
+
+static int cmd_cpu_sampler_start(const struct shell *shell, size_t argc, char **argv)
+{
+	uint32_t rate = CONFIG_CPU_SAMPLER_RATE;
+	int err;
+
+	if (argc > 1) {
+		rate = strtoul(argv[1], NULL, 10);
+	}
+
+	err = cpu_sampler_start(rate);
+	if (err) {
+		shell_error(shell, "Start failed (err:%d)", err);
+	}
+
+	return 0;
+}
+
+static int cmd_cpu_sampler_stop(const struct shell *shell, size_t argc, char **argv)
+{
+	cpu_sampler_stop();
+
+	return 0;
+}
+
+static int cmd_cpu_sampler_reset(const struct shell *shell, size_t argc, char **argv)
+{
+	cpu_sampler_reset();
+
+	return 0;
+}
+
+static int cmd_cpu_sampler_show(const struct shell *shell, size_t argc, char **argv)
+{
+	struct cpu_sampler_entry top[SHOW_MAX];
+	size_t max_entries = 10;
+	uint32_t total;
+	uint32_t lost_samples;
+	size_t cnt;
+
+	if (argc > 1) {
+		max_entries = MIN(strtoul(argv[1], NULL, 10), ARRAY_SIZE(top));
+	}
+
+	total = cpu_sampler_samples_get(&lost_samples);
+	cnt = cpu_sampler_top_get(top, max_entries);
+
+	shell_print(shell, "Samples:%u lost:%u", total, lost_samples);
+	shell_print(shell, "   count       %%          pc         ctx");
+
+	for (size_t i = 0; i < cnt; i++) {
+		uint32_t permille = total ? (uint32_t)((uint64_t)top[i].count * 1000 / total) : 0;
+
+		shell_print(shell, "%8u %5u,%u%% 0x%08lx 0x%08lx", top[i].count,
+			    permille / 10, permille % 10, (unsigned long)top[i].pc,
+			    (unsigned long)top[i].ctx);
+	}
+
+	return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub_cmd_cpu_sampler,
+	SHELL_CMD_ARG(start, NULL, "Start sampling [rate in Hz]",
+			cmd_cpu_sampler_start, 1, 1),
+	SHELL_CMD_ARG(stop, NULL, "Stop sampling", cmd_cpu_sampler_stop, 1, 0),
+	SHELL_CMD_ARG(reset, NULL, "Clear the histogram",
+			cmd_cpu_sampler_reset, 1, 0),
+	SHELL_CMD_ARG(show, NULL, "Show the most sampled locations [count]",
+			cmd_cpu_sampler_show, 1, 1),
+	SHELL_SUBCMD_SET_END
+);
+
+SHELL_COND_CMD_ARG_REGISTER(CONFIG_CPU_SAMPLER_CMDS, cpu_sampler, &sub_cmd_cpu_sampler,
+			"CPU sampling profiler", cmd_cpu_sampler_show, 1, 1);
@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) 2022 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+#include <zephyr/kernel.h>
+#include <zephyr/irq.h>
+#include <nrfx_timer.h>
+#include <zephyr/logging/log.h>
+#include "cpu_sampler_priv.h"
+
+LOG_MODULE_DECLARE(cpu_sampler, CONFIG_CPU_SAMPLER_LOG_LEVEL);
+
+#define TIMER_IRQN NRFX_CONCAT_3(TIMER, CONFIG_CPU_SAMPLER_TIMER_INSTANCE, _IRQn)
+
+/* EXC_RETURN bits */
+#define EXC_RETURN_SPSEL	BIT(2)
+#define EXC_RETURN_MODE_THREAD	BIT(3)
+#define EXC_RETURN_SECURE_STACK	BIT(6)
+
+/* Words of the exception stack frame */
+#define FRAME_PC		6
+#define FRAME_XPSR		7
+
+#define XPSR_EXC_NUM_MSK	0x1FF
+
+static nrfx_timer_t timer = NRFX_TIMER_INSTANCE(CONFIG_CPU_SAMPLER_TIMER_INSTANCE);
+static bool initialized;
+
+static void timer_handler(nrf_timer_event_t event_type, void *context)
+{
+	/* Not used, the interrupt is handled by sampler_isr(). */
+}
+
+static __used void sampler_isr_handler(uint32_t exc_return, const uint32_t *frame)
+{
+	uintptr_t pc;
+	uintptr_t ctx;
+
+	nrf_timer_event_clear(timer.p_reg, NRF_TIMER_EVENT_COMPARE0);
+
+	if (IS_ENABLED(CONFIG_ARM_NONSECURE_FIRMWARE) &&
+	    (exc_return & EXC_RETURN_SECURE_STACK)) {
+		/* The frame of the interrupted secure code cannot be read. */
+		pc = 0;
+	} else {
+		pc = frame[FRAME_PC];
+	}
+
+	if (exc_return & EXC_RETURN_MODE_THREAD) {
+		ctx = (uintptr_t)k_current_get();
+	} else {
+		ctx = frame[FRAME_XPSR] & XPSR_EXC_NUM_MSK;
+	}
+
+	cpu_sampler_sample(pc, ctx);
+
+	ISR_DIRECT_PM();
+}
+
+/* The interrupted code is found in the exception stack frame, which is on
+ * the stack selected by EXC_RETURN. The stack pointer is read before anything
+ * is pushed to it, and the handler returns with EXC_RETURN still in LR.
+ */
+__attribute__((naked))
+static void sampler_isr(void)
+{
+	__asm volatile (
+		"mov r0, lr\n"
+		"tst lr, %0\n"
+		"ite eq\n"
+		"mrseq r1, msp\n"
+		"mrsne r1, psp\n"
+		"b sampler_isr_handler\n"
+		:
+		: "i" (EXC_RETURN_SPSEL)
+	);
+}
+
+static int timer_init(void)
+{
+	nrfx_timer_config_t config = NRFX_TIMER_DEFAULT_CONFIG;
+	nrfx_err_t err;
+
+	config.frequency = NRF_TIMER_FREQ_1MHz;
+	config.bit_width = NRF_TIMER_BIT_WIDTH_32;
+	config.interrupt_priority = CONFIG_CPU_SAMPLER_IRQ_PRIORITY;
+
+	IRQ_DIRECT_CONNECT(TIMER_IRQN, CONFIG_CPU_SAMPLER_IRQ_PRIORITY, sampler_isr, 0);
+
+	err = nrfx_timer_init(&timer, &config, timer_handler);
+	if (err != NRFX_SUCCESS) {
+		LOG_ERR("Timer init failed (err:%d)", err);
+		return -EBUSY;
+	}
+
+	return 0;
+}
+
+int cpu_sampler_timer_start(uint32_t rate)
+{
+	if (!initialized) {
+		int err = timer_init();
+
+		if (err) {
+			return err;
+		}
+		initialized = true;
+	}
+
+	nrfx_timer_extended_compare(&timer, NRF_TIMER_CC_CHANNEL0,
+				    nrfx_timer_us_to_ticks(&timer, USEC_PER_SEC / rate),
+				    NRF_TIMER_SHORT_COMPARE0_CLEAR_MASK, true);
+	nrfx_timer_clear(&timer);
+	nrfx_timer_enable(&timer);
+
+	return 0;
+}
+
+void cpu_sampler_timer_stop(void)
+{
+	nrfx_timer_disable(&timer);
+	nrfx_timer_compare_int_disable(&timer, NRF_TIMER_CC_CHANNEL0);
+}
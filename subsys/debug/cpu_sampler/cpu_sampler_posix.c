@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2022 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+/* Needed for the register indexes of the host ucontext */
+#define _GNU_SOURCE
+
+#include <signal.h>
+#include <string.h>
+#include <sys/time.h>
+#include <ucontext.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include "cpu_sampler_priv.h"
+
+LOG_MODULE_DECLARE(cpu_sampler, CONFIG_CPU_SAMPLER_LOG_LEVEL);
+
+static bool initialized;
+
+static uintptr_t pc_get(const ucontext_t *uc)
+{
+#if defined(__x86_64__)
+	return uc->uc_mcontext.gregs[REG_RIP];
+#elif defined(__i386__)
+	return uc->uc_mcontext.gregs[REG_EIP];
+#elif defined(__aarch64__)
+	return uc->uc_mcontext.pc;
+#else
+#error "Host architecture not supported"
+#endif
+}
+
+/* The Zephyr threads of a POSIX build are host threads that run one at a
+ * time, so the signal interrupts the running Zephyr thread or the emulated
+ * interrupt handler.
+ */
+static void signal_handler(int sig, siginfo_t *info, void *context)
+{
+	uintptr_t ctx = k_is_in_isr() ? CPU_SAMPLER_CTX_ISR_UNKNOWN :
+					(uintptr_t)k_current_get();
+
+	cpu_sampler_sample(pc_get(context), ctx);
+}
+
+static int signal_init(void)
+{
+	struct sigaction sa;
+
+	memset(&sa, 0, sizeof(sa));
+	sa.sa_sigaction = signal_handler;
+	sa.sa_flags = SA_SIGINFO | SA_RESTART;
+	sigemptyset(&sa.sa_mask);
+
+	if (sigaction(SIGPROF, &sa, NULL)) {
+		LOG_ERR("Cannot set the signal handler");
+		return -EBUSY;
+	}
+
+	return 0;
+}
+
+static int timer_set(uint32_t interval_us)
+{
+	struct itimerval timer = {
+		.it_interval = {
+			.tv_sec = interval_us / USEC_PER_SEC,
+			.tv_usec = interval_us % USEC_PER_SEC,
+		},
+	};
+
+	timer.it_value = timer.it_interval;
+
+	/* The profiling timer counts the CPU time of the process, so samples
+	 * are not taken while the process waits for the emulated time.
+	 */
+	return setitimer(ITIMER_PROF, &timer, NULL) ? -EBUSY : 0;
+}
+
+int cpu_sampler_timer_start(uint32_t rate)
+{
+	if (!initialized) {
+		int err = signal_init();
+
+		if (err) {
+			return err;
+		}
+		initialized = true;
+	}
+
+	return timer_set(USEC_PER_SEC / rate);
+}
+
+void cpu_sampler_timer_stop(void)
+{
+	(void)timer_set(0);
+}
@@ -0,0 +1,43 @@
+/*
+ * Copyright (c) 2022 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+#ifndef __CPU_SAMPLER_PRIV_H
+#define __CPU_SAMPLER_PRIV_H
+
+#include <debug/cpu_sampler.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Context of samples taken in an interrupt handler of unknown number */
+#define CPU_SAMPLER_CTX_ISR_UNKNOWN 0
+
+/** @brief Start the platform timer that takes the samples.
+ *
+ * @param rate Sampling rate in Hz.
+ *
+ * @return 0 on success, negative error code otherwise.
+ */
+int cpu_sampler_timer_start(uint32_t rate);
+
+/** @brief Stop the platform timer. */
+void cpu_sampler_timer_stop(void);
+
+/** @brief Add a sample to the histogram.
+ *
+ * Called by the platform timer with the sampling interrupt or signal as the
+ * only context that adds samples.
+ *
+ * @param pc Program counter of the interrupted code.
+ * @param ctx Context of the interrupted code.
+ */
+void cpu_sampler_sample(uintptr_t pc, uintptr_t ctx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __CPU_SAMPLER_PRIV_H */
@@ -130,6 +130,9 @@ int nrf_cloud_codec_init(void);
 int nrf_cloud_encode_sensor_data(const struct nrf_cloud_sensor_data *input,
 				 struct nrf_cloud_data *output);
 
+/**@brief Get the appId value used for the indicated sensor type, or NULL if unknown. */
+const char *nrf_cloud_sensor_app_id_get(const enum nrf_cloud_sensor type);
+
 /**@brief Encode the sensor data to be sent to the device shadow. */
 int nrf_cloud_encode_shadow_data(const struct nrf_cloud_sensor_data *sensor,
 				 struct nrf_cloud_data *output);
@@ -242,6 +245,40 @@ int nrf_cloud_modem_pvt_data_encode(const struct nrf_modem_gnss_pvt_data_frame	*
 				    cJSON * const pvt_data_obj);
 #endif
 
+#if defined(CONFIG_NRF_CLOUD_CBOR)
+/** @brief Encodes sensor data as a CBOR device message directly into the provided buffer.
+ * The message has the same content as the one built by @ref nrf_cloud_encode_sensor_data.
+ * On success, out_len is set to the length of the encoded message.
+ * Returns -ENOMEM if the buffer is too small.
+ */
+int nrf_cloud_sensor_data_cbor_encode(const struct nrf_cloud_sensor_data *const sensor,
+				      uint8_t *const buf, size_t buf_len, size_t *const out_len);
+
+/** @brief Encodes GNSS data as a CBOR device message directly into the provided buffer.
+ * The message has the same content as the one built by @ref nrf_cloud_gnss_msg_json_encode.
+ * On success, out_len is set to the length of the encoded message.
+ * Returns -ENOMEM if the buffer is too small.
+ */
+int nrf_cloud_gnss_msg_cbor_encode(const struct nrf_cloud_gnss_data *const gnss,
+				   uint8_t *const buf, size_t buf_len, size_t *const out_len);
+
+/** @brief Encodes a CBOR cellular positioning request directly into the provided buffer.
+ * The request has the same content as the one built by @ref nrf_cloud_format_cell_pos_req.
+ * On success, out_len is set to the length of the encoded request.
+ * Returns -ENOMEM if the buffer is too small.
+ */
+int nrf_cloud_cell_pos_req_cbor_encode(const struct lte_lc_cells_info *const inf,
+				       size_t inf_cnt, uint8_t *const buf, size_t buf_len,
+				       size_t *const out_len);
+
+/** @brief Decodes a CBOR cellular positioning response (REST and MQTT) in a single pass,
+ * without allocating memory. Return values are the same as for
+ * @ref nrf_cloud_parse_cell_pos_response.
+ */
+int nrf_cloud_cell_pos_response_cbor_decode(const uint8_t *const buf, size_t buf_len,
+					    struct nrf_cloud_cell_pos_result *const result);
+#endif /* CONFIG_NRF_CLOUD_CBOR */
+
 #ifdef CONFIG_NRF_CLOUD_GATEWAY
 typedef int (*gateway_state_handler_t)(void *root_obj);
 
@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2022 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#ifndef NRF_CLOUD_OUTBOX_H_
+#define NRF_CLOUD_OUTBOX_H_
+
+#include <zephyr/kernel.h>
+#include <zephyr/net/mqtt.h>
+#include <zephyr/settings/settings.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Settings key, below the nrf_cloud settings tree, of stored publications. */
+#define NRF_CLOUD_OUTBOX_SETTINGS_KEY "ob"
+
+/**@brief Publish a QoS 1 message and keep a copy of it until it is acknowledged.
+ *
+ * @param[in] client MQTT client to publish with.
+ * @param[in] param Publication, with a message ID that is not already in the outbox.
+ *
+ * @retval 0 on success.
+ * @retval -ENOBUFS if CONFIG_NRF_CLOUD_MQTT_OUTBOX_WINDOW publications are already
+ *		    waiting for acknowledgment.
+ * @retval -EBUSY if a publication with the same message ID is waiting for acknowledgment.
+ * @retval -ENOMEM if the copy could not be allocated.
+ * @return Otherwise the error returned by mqtt_publish(), in which case the
+ *	   publication is not kept.
+ */
+int nrf_cloud_outbox_publish(struct mqtt_client *const client,
+			     const struct mqtt_publish_param *const param);
+
+/**@brief Remove an acknowledged publication from the outbox.
+ *
+ * @retval 0 on success.
+ * @retval -ENOENT if no publication with the message ID is in the outbox.
+ */
+int nrf_cloud_outbox_ack(uint16_t message_id);
+
+/**@brief Publish all publications in the outbox again, in the order they were
+ *	  first published, with the DUP flag set. Call from the MQTT event handler
+ *	  when the connection has been re-established, as the outbox is locked
+ *	  while publishing.
+ *
+ * @return Number of publications sent on success, otherwise the negative error
+ *	   returned by mqtt_publish(). Publications are kept in either case.
+ */
+int nrf_cloud_outbox_retransmit(struct mqtt_client *const client);
+
+/**@brief Store the publications that are not in settings yet. Used with
+ *	  CONFIG_NRF_CLOUD_MQTT_OUTBOX_PERSIST_ON_DISCONNECT when the connection
+ *	  is lost.
+ *
+ * @return Number of publications stored.
+ */
+int nrf_cloud_outbox_persist(void);
+
+/**@brief Check whether a publication with the message ID is in the outbox. */
+bool nrf_cloud_outbox_contains(uint16_t message_id);
+
+/**@brief Get the number of publications that can be added before the outbox is full. */
+size_t nrf_cloud_outbox_free_get(void);
+
+/**@brief Free the outbox copies in RAM. Stored publications are kept, and are
+ *	  loaded again with the nrf_cloud settings.
+ */
+void nrf_cloud_outbox_reset(void);
+
+/**@brief Settings handler for a stored publication.
+ *
+ * @param[in] key Key of the publication, below @ref NRF_CLOUD_OUTBOX_SETTINGS_KEY.
+ * @param[in] len_rd Length of the stored publication.
+ * @param[in] read_cb Settings read callback.
+ * @param[in] cb_arg Settings read callback argument.
+ *
+ * @retval 0 on success, otherwise a negative error code.
+ */
+int nrf_cloud_outbox_settings_set(const char *key, size_t len_rd,
+				  settings_read_cb read_cb, void *cb_arg);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* NRF_CLOUD_OUTBOX_H_ */
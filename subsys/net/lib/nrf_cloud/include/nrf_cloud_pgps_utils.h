@@ -42,6 +42,20 @@ struct gps_location {
 	int64_t gps_sec;
 };
 
+/* Compact index of the stored predictions. It is saved in settings so that
+ * the predictions do not need to be read from flash and validated at boot.
+ */
+struct npgps_saved_index {
+	/* GPS time of the first prediction */
+	int64_t start_sec;
+	/* number of consecutive valid predictions, starting from the first */
+	uint16_t count;
+	/* storage block of each prediction, in time order */
+	uint8_t block[NUM_PREDICTIONS];
+	/* CRC-32 of each stored prediction, including the padding */
+	uint32_t crc[NUM_PREDICTIONS];
+};
+
 struct nrf_cloud_pgps_header;
 
 typedef int (*npgps_buffer_handler_t)(uint8_t *buf, size_t len);
@@ -56,6 +70,8 @@ void npgps_unlock(void);
 int npgps_save_header(struct nrf_cloud_pgps_header *header);
 const struct nrf_cloud_pgps_header *npgps_get_saved_header(void);
 const struct gps_location *npgps_get_saved_location(void);
+int npgps_save_index(const struct npgps_saved_index *saved_index);
+const struct npgps_saved_index *npgps_get_saved_index(void);
 int npgps_settings_init(void);
 
 /* time functions */
@@ -66,7 +82,7 @@ int npgps_get_shifted_time(int64_t *gps_sec, uint16_t *gps_day, uint32_t *gps_ti
 int npgps_get_time(int64_t *gps_sec, uint16_t *gps_day, uint32_t *gps_time_of_day);
 
 /* flash block allocation functions */
-int ngps_block_pool_init(uint32_t base_address, int num);
+int ngps_block_pool_init(uint8_t *base, int num);
 int npgps_alloc_block(void);
 void npgps_free_block(int block);
 int npgps_get_block_extent(int block);
@@ -22,6 +22,9 @@ enum nct_evt_type {
 	NCT_EVT_CC_TX_DATA_ACK,
 	NCT_EVT_PINGRESP,
 	NCT_EVT_DC_RX_DATA,
+	NCT_EVT_DC_RX_DATA_BEGIN,
+	NCT_EVT_DC_RX_DATA_CHUNK,
+	NCT_EVT_DC_RX_DATA_END,
 	NCT_EVT_DC_TX_DATA_ACK,
 	NCT_EVT_CC_DISCONNECTED,
 	NCT_EVT_DC_DISCONNECTED,
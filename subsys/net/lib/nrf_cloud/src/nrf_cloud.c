@@ -298,6 +298,48 @@ int nrf_cloud_shadow_device_status_update(const struct nrf_cloud_device_status *
 	return err;
 }
 
+#if defined(CONFIG_NRF_CLOUD_MQTT_SENSOR_DATA_CBOR)
+static uint8_t sensor_data_buf[CONFIG_NRF_CLOUD_MQTT_SENSOR_DATA_CBOR_BUF_SIZE];
+static K_MUTEX_DEFINE(sensor_data_buf_mutex);
+#endif
+
+/* The CBOR message is encoded into sensor_data_buf, which stays locked
+ * until the message is freed after publishing.
+ */
+static int sensor_data_encode(const struct nrf_cloud_sensor_data *param,
+			      struct nrf_cloud_data *output)
+{
+#if defined(CONFIG_NRF_CLOUD_MQTT_SENSOR_DATA_CBOR)
+	size_t len;
+	int err;
+
+	k_mutex_lock(&sensor_data_buf_mutex, K_FOREVER);
+
+	err = nrf_cloud_sensor_data_cbor_encode(param, sensor_data_buf,
+						sizeof(sensor_data_buf), &len);
+	if (err) {
+		k_mutex_unlock(&sensor_data_buf_mutex);
+		return err;
+	}
+
+	output->ptr = sensor_data_buf;
+	output->len = len;
+	return 0;
+#else
+	return nrf_cloud_encode_sensor_data(param, output);
+#endif
+}
+
+static void sensor_data_free(struct nrf_cloud_data *output)
+{
+#if defined(CONFIG_NRF_CLOUD_MQTT_SENSOR_DATA_CBOR)
+	k_mutex_unlock(&sensor_data_buf_mutex);
+#else
+	nrf_cloud_free((void *)output->ptr);
+#endif
+	output->ptr = NULL;
+}
+
 int nrf_cloud_sensor_data_send(const struct nrf_cloud_sensor_data *param)
 {
 	int err;
@@ -311,7 +353,7 @@ int nrf_cloud_sensor_data_send(const struct nrf_cloud_sensor_data *param)
 		return -EINVAL;
 	}
 
-	err = nrf_cloud_encode_sensor_data(param, &sensor_data.data);
+	err = sensor_data_encode(param, &sensor_data.data);
 	if (err) {
 		return err;
 	}
@@ -323,7 +365,7 @@ int nrf_cloud_sensor_data_send(const struct nrf_cloud_sensor_data *param)
 	}
 
 	err = nct_dc_send(&sensor_data);
-	nrf_cloud_free((void *)sensor_data.data.ptr);
+	sensor_data_free(&sensor_data.data);
 
 	return err;
 }
@@ -341,13 +383,13 @@ int nrf_cloud_sensor_data_stream(const struct nrf_cloud_sensor_data *param)
 		return -EINVAL;
 	}
 
-	err = nrf_cloud_encode_sensor_data(param, &sensor_data.data);
+	err = sensor_data_encode(param, &sensor_data.data);
 	if (err) {
 		return err;
 	}
 
 	err = nct_dc_stream(&sensor_data);
-	nrf_cloud_free((void *)sensor_data.data.ptr);
+	sensor_data_free(&sensor_data.data);
 
 	return err;
 }
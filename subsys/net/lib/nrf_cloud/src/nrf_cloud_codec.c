@@ -282,6 +282,15 @@ static void nrf_cloud_decode_desired_obj(cJSON *const root_obj,
 	}
 }
 
+const char *nrf_cloud_sensor_app_id_get(const enum nrf_cloud_sensor type)
+{
+	if (type >= SENSOR_TYPE_ARRAY_SIZE) {
+		return NULL;
+	}
+
+	return sensor_type_str[type];
+}
+
 int nrf_cloud_encode_shadow_data(const struct nrf_cloud_sensor_data *sensor,
 				 struct nrf_cloud_data *output)
 {
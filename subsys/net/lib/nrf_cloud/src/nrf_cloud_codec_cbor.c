@@ -0,0 +1,519 @@
+/*
+ * Copyright (c) 2022 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include "nrf_cloud_codec.h"
+#include <stdbool.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zcbor_common.h>
+#include <zcbor_decode.h>
+#include <zcbor_encode.h>
+
+LOG_MODULE_REGISTER(nrf_cloud_codec_cbor, CONFIG_NRF_CLOUD_LOG_LEVEL);
+
+/* Messages use the same text keys as the JSON messages, so that a CBOR message
+ * carries exactly the content of the corresponding JSON message.
+ */
+
+/* Deepest nesting of maps and arrays, plus one, in the supported messages */
+#define CBOR_MAX_DEPTH		5
+
+/* Maximum number of entries in the maps of the supported messages */
+#define SENSOR_MSG_MAX_ENTRIES	3
+#define GNSS_MSG_MAX_ENTRIES	4
+#define PVT_MAX_ENTRIES		6
+#define CELL_POS_REQ_MAX_ENTRIES 1
+#define LTE_MAX_ENTRIES		9
+#define NCELL_MAX_ENTRIES	4
+
+/* CBOR "break" stop code that ends an indefinite length map */
+#define CBOR_BREAK		0xFF
+
+#define CELL_POS_FIELD_LAT	BIT(0)
+#define CELL_POS_FIELD_LON	BIT(1)
+#define CELL_POS_FIELD_UNC	BIT(2)
+#define CELL_POS_FIELDS_REQUIRED (CELL_POS_FIELD_LAT | CELL_POS_FIELD_LON | CELL_POS_FIELD_UNC)
+
+struct cell_pos_fields {
+	uint8_t found;
+	double lat;
+	double lon;
+	double unc;
+	enum nrf_cloud_cell_pos_type type;
+};
+
+static bool tstr_put(zcbor_state_t *zse, const char *const str)
+{
+	struct zcbor_string zstr = {
+		.value = (const uint8_t *)str,
+		.len = strlen(str)
+	};
+
+	return zcbor_tstr_encode(zse, &zstr);
+}
+
+static bool key_is(const struct zcbor_string *const key, const char *const str)
+{
+	return (key->len == strlen(str)) && (memcmp(key->value, str, key->len) == 0);
+}
+
+/* Works for both definite and indefinite length maps */
+static bool map_has_entry(const zcbor_state_t *zsd)
+{
+	return (zsd->elem_count > 0) && (zsd->payload < zsd->payload_end) &&
+	       (*zsd->payload != CBOR_BREAK);
+}
+
+/* JSON numbers may be converted to any of the CBOR number types */
+static bool number_decode(zcbor_state_t *zsd, double *value)
+{
+	float value32;
+	int64_t value_int;
+
+	if (zcbor_float64_decode(zsd, value)) {
+		return true;
+	}
+	if (zcbor_float32_decode(zsd, &value32)) {
+		*value = value32;
+		return true;
+	}
+	if (zcbor_int64_decode(zsd, &value_int)) {
+		*value = value_int;
+		return true;
+	}
+	return false;
+}
+
+static int encode_result(zcbor_state_t *zse, bool ok, const uint8_t *const buf,
+			 size_t *const out_len)
+{
+	if (!ok) {
+		int err = zcbor_pop_error(zse);
+
+		LOG_DBG("CBOR encoding failed: %d", err);
+		return (err == ZCBOR_ERR_NO_PAYLOAD) ? -ENOMEM : -EINVAL;
+	}
+
+	*out_len = zse->payload - buf;
+	return 0;
+}
+
+int nrf_cloud_sensor_data_cbor_encode(const struct nrf_cloud_sensor_data *const sensor,
+				      uint8_t *const buf, size_t buf_len, size_t *const out_len)
+{
+	const char *app_id;
+	struct zcbor_string data;
+	bool ok;
+
+	if (!sensor || !sensor->data.ptr || !buf || !out_len) {
+		return -EINVAL;
+	}
+
+	app_id = nrf_cloud_sensor_app_id_get(sensor->type);
+	if (!app_id) {
+		return -EINVAL;
+	}
+
+	ZCBOR_STATE_E(zse, CBOR_MAX_DEPTH, buf, buf_len, 1);
+
+	data.value = sensor->data.ptr;
+	data.len = sensor->data.len;
+
+	ok = zcbor_map_start_encode(zse, SENSOR_MSG_MAX_ENTRIES) &&
+	     tstr_put(zse, NRF_CLOUD_JSON_APPID_KEY) &&
+	     tstr_put(zse, app_id) &&
+	     tstr_put(zse, NRF_CLOUD_JSON_DATA_KEY) &&
+	     zcbor_tstr_encode(zse, &data) &&
+	     tstr_put(zse, NRF_CLOUD_JSON_MSG_TYPE_KEY) &&
+	     tstr_put(zse, NRF_CLOUD_JSON_MSG_TYPE_VAL_DATA) &&
+	     zcbor_map_end_encode(zse, SENSOR_MSG_MAX_ENTRIES);
+
+	return encode_result(zse, ok, buf, out_len);
+}
+
+static bool pvt_encode(zcbor_state_t *zse, const struct nrf_cloud_gnss_pvt *const pvt)
+{
+	return zcbor_map_start_encode(zse, PVT_MAX_ENTRIES) &&
+	       tstr_put(zse, NRF_CLOUD_JSON_GNSS_PVT_KEY_LON) &&
+	       zcbor_float64_put(zse, pvt->lon) &&
+	       tstr_put(zse, NRF_CLOUD_JSON_GNSS_PVT_KEY_LAT) &&
+	       zcbor_float64_put(zse, pvt->lat) &&
+	       tstr_put(zse, NRF_CLOUD_JSON_GNSS_PVT_KEY_ACCURACY) &&
+	       zcbor_float32_put(zse, pvt->accuracy) &&
+	       (!pvt->has_alt ||
+		(tstr_put(zse, NRF_CLOUD_JSON_GNSS_PVT_KEY_ALTITUDE) &&
+		 zcbor_float32_put(zse, pvt->alt))) &&
+	       (!pvt->has_speed ||
+		(tstr_put(zse, NRF_CLOUD_JSON_GNSS_PVT_KEY_SPEED) &&
+		 zcbor_float32_put(zse, pvt->speed))) &&
+	       (!pvt->has_heading ||
+		(tstr_put(zse, NRF_CLOUD_JSON_GNSS_PVT_KEY_HEADING) &&
+		 zcbor_float32_put(zse, pvt->heading))) &&
+	       zcbor_map_end_encode(zse, PVT_MAX_ENTRIES);
+}
+
+int nrf_cloud_gnss_msg_cbor_encode(const struct nrf_cloud_gnss_data *const gnss,
+				   uint8_t *const buf, size_t buf_len, size_t *const out_len)
+{
+	struct nrf_cloud_gnss_pvt pvt = {0};
+	const char *nmea = NULL;
+	bool ok;
+
+	if (!gnss || !buf || !out_len) {
+		return -EINVAL;
+	}
+
+	switch (gnss->type) {
+	case NRF_CLOUD_GNSS_TYPE_PVT:
+		pvt = gnss->pvt;
+		break;
+	case NRF_CLOUD_GNSS_TYPE_MODEM_PVT:
+#if defined(CONFIG_NRF_MODEM)
+		if (!gnss->mdm_pvt) {
+			return -EINVAL;
+		}
+		pvt = (struct nrf_cloud_gnss_pvt) {
+			.lon =		gnss->mdm_pvt->longitude,
+			.lat =		gnss->mdm_pvt->latitude,
+			.accuracy =	gnss->mdm_pvt->accuracy,
+			.alt =		gnss->mdm_pvt->altitude,
+			.has_alt =	1,
+			.speed =	gnss->mdm_pvt->speed,
+			.has_speed =	1,
+			.heading =	gnss->mdm_pvt->heading,
+			.has_heading =	1
+		};
+		break;
+#else
+		return -ENOSYS;
+#endif
+	case NRF_CLOUD_GNSS_TYPE_MODEM_NMEA:
+#if defined(CONFIG_NRF_MODEM)
+		if (gnss->mdm_nmea) {
+			nmea = gnss->mdm_nmea->nmea_str;
+		}
+#endif
+		break;
+	case NRF_CLOUD_GNSS_TYPE_NMEA:
+		nmea = gnss->nmea.sentence;
+		break;
+	default:
+		return -EFTYPE;
+	}
+
+	if ((gnss->type == NRF_CLOUD_GNSS_TYPE_MODEM_NMEA) ||
+	    (gnss->type == NRF_CLOUD_GNSS_TYPE_NMEA)) {
+		if (nmea == NULL) {
+			return -EINVAL;
+		}
+		if (memchr(nmea, '\0', NRF_MODEM_GNSS_NMEA_MAX_LEN) == NULL) {
+			return -EFBIG;
+		}
+	}
+
+	ZCBOR_STATE_E(zse, CBOR_MAX_DEPTH, buf, buf_len, 1);
+
+	ok = zcbor_map_start_encode(zse, GNSS_MSG_MAX_ENTRIES) &&
+	     tstr_put(zse, NRF_CLOUD_JSON_APPID_KEY) &&
+	     tstr_put(zse, NRF_CLOUD_JSON_APPID_VAL_GNSS) &&
+	     tstr_put(zse, NRF_CLOUD_JSON_MSG_TYPE_KEY) &&
+	     tstr_put(zse, NRF_CLOUD_JSON_MSG_TYPE_VAL_DATA) &&
+	     ((gnss->ts_ms <= NRF_CLOUD_NO_TIMESTAMP) ||
+	      (tstr_put(zse, NRF_CLOUD_MSG_TIMESTAMP_KEY) &&
+	       zcbor_int64_put(zse, gnss->ts_ms))) &&
+	     tstr_put(zse, NRF_CLOUD_JSON_DATA_KEY) &&
+	     (nmea ? tstr_put(zse, nmea) : pvt_encode(zse, &pvt)) &&
+	     zcbor_map_end_encode(zse, GNSS_MSG_MAX_ENTRIES);
+
+	return encode_result(zse, ok, buf, out_len);
+}
+
+static bool ncell_encode(zcbor_state_t *zse, const struct lte_lc_ncell *const ncell)
+{
+	return zcbor_map_start_encode(zse, NCELL_MAX_ENTRIES) &&
+	       tstr_put(zse, NRF_CLOUD_CELL_POS_JSON_KEY_EARFCN) &&
+	       zcbor_uint32_put(zse, ncell->earfcn) &&
+	       tstr_put(zse, NRF_CLOUD_CELL_POS_JSON_KEY_PCI) &&
+	       zcbor_uint32_put(zse, ncell->phys_cell_id) &&
+	       ((ncell->rsrp == NRF_CLOUD_CELL_POS_OMIT_RSRP) ||
+		(tstr_put(zse, NRF_CLOUD_CELL_POS_JSON_KEY_RSRP) &&
+		 zcbor_int32_put(zse, RSRP_IDX_TO_DBM(ncell->rsrp)))) &&
+	       ((ncell->rsrq == NRF_CLOUD_CELL_POS_OMIT_RSRQ) ||
+		(tstr_put(zse, NRF_CLOUD_CELL_POS_JSON_KEY_RSRQ) &&
+		 zcbor_float32_put(zse, RSRQ_IDX_TO_DB(ncell->rsrq)))) &&
+	       zcbor_map_end_encode(zse, NCELL_MAX_ENTRIES);
+}
+
+static bool lte_encode(zcbor_state_t *zse, const struct lte_lc_cells_info *const lte)
+{
+	const struct lte_lc_cell *const cur = &lte->current_cell;
+	uint8_t ncells_count = lte->ncells_count;
+	bool ok;
+
+	if (ncells_count && (lte->neighbor_cells == NULL)) {
+		LOG_WRN("Neighbor cell count is %u, but buffer is NULL", ncells_count);
+		ncells_count = 0;
+	}
+
+	/* required items */
+	ok = zcbor_map_start_encode(zse, LTE_MAX_ENTRIES) &&
+	     tstr_put(zse, NRF_CLOUD_CELL_POS_JSON_KEY_ECI) &&
+	     zcbor_uint32_put(zse, cur->id) &&
+	     tstr_put(zse, NRF_CLOUD_CELL_POS_JSON_KEY_MCC) &&
+	     zcbor_int32_put(zse, cur->mcc) &&
+	     tstr_put(zse, NRF_CLOUD_CELL_POS_JSON_KEY_MNC) &&
+	     zcbor_int32_put(zse, cur->mnc) &&
+	     tstr_put(zse, NRF_CLOUD_CELL_POS_JSON_KEY_TAC) &&
+	     zcbor_uint32_put(zse, cur->tac);
+
+	/* optional */
+	ok = ok &&
+	     ((cur->earfcn == NRF_CLOUD_CELL_POS_OMIT_EARFCN) ||
+	      (tstr_put(zse, NRF_CLOUD_CELL_POS_JSON_KEY_EARFCN) &&
+	       zcbor_uint32_put(zse, cur->earfcn))) &&
+	     ((cur->rsrp == NRF_CLOUD_CELL_POS_OMIT_RSRP) ||
+	      (tstr_put(zse, NRF_CLOUD_CELL_POS_JSON_KEY_RSRP) &&
+	       zcbor_int32_put(zse, RSRP_IDX_TO_DBM(cur->rsrp)))) &&
+	     ((cur->rsrq == NRF_CLOUD_CELL_POS_OMIT_RSRQ) ||
+	      (tstr_put(zse, NRF_CLOUD_CELL_POS_JSON_KEY_RSRQ) &&
+	       zcbor_float32_put(zse, RSRQ_IDX_TO_DB(cur->rsrq)))) &&
+	     ((cur->timing_advance == NRF_CLOUD_CELL_POS_OMIT_TIME_ADV) ||
+	      (tstr_put(zse, NRF_CLOUD_CELL_POS_JSON_KEY_T_ADV) &&
+	       zcbor_uint32_put(zse, MIN(cur->timing_advance,
+					 NRF_CLOUD_CELL_POS_TIME_ADV_MAX))));
+
+	if (ok && ncells_count) {
+		ok = tstr_put(zse, NRF_CLOUD_CELL_POS_JSON_KEY_NBORS) &&
+		     zcbor_list_start_encode(zse, ncells_count);
+
+		for (uint8_t i = 0; ok && (i < ncells_count); i++) {
+			ok = ncell_encode(zse, &lte->neighbor_cells[i]);
+		}
+
+		ok = ok && zcbor_list_end_encode(zse, ncells_count);
+	}
+
+	return ok && zcbor_map_end_encode(zse, LTE_MAX_ENTRIES);
+}
+
+int nrf_cloud_cell_pos_req_cbor_encode(const struct lte_lc_cells_info *const inf,
+				       size_t inf_cnt, uint8_t *const buf, size_t buf_len,
+				       size_t *const out_len)
+{
+	bool ok;
+
+	if (!inf || !inf_cnt || !buf || !out_len) {
+		return -EINVAL;
+	}
+
+	ZCBOR_STATE_E(zse, CBOR_MAX_DEPTH, buf, buf_len, 1);
+
+	ok = zcbor_map_start_encode(zse, CELL_POS_REQ_MAX_ENTRIES) &&
+	     tstr_put(zse, NRF_CLOUD_CELL_POS_JSON_KEY_LTE) &&
+	     zcbor_list_start_encode(zse, inf_cnt);
+
+	for (size_t i = 0; ok && (i < inf_cnt); i++) {
+		ok = lte_encode(zse, &inf[i]);
+	}
+
+	ok = ok &&
+	     zcbor_list_end_encode(zse, inf_cnt) &&
+	     zcbor_map_end_encode(zse, CELL_POS_REQ_MAX_ENTRIES);
+
+	return encode_result(zse, ok, buf, out_len);
+}
+
+/* Decodes the value of a cellular positioning result key.
+ * Returns 1 if the key was handled, 0 if it is not a result key,
+ * and a negative error code if the value is invalid.
+ */
+static int cell_pos_field_decode(zcbor_state_t *zsd, const struct zcbor_string *const key,
+				 struct cell_pos_fields *const fields)
+{
+	struct zcbor_string type;
+	double *value;
+	uint8_t field;
+
+	if (key_is(key, NRF_CLOUD_CELL_POS_JSON_KEY_LAT)) {
+		value = &fields->lat;
+		field = CELL_POS_FIELD_LAT;
+	} else if (key_is(key, NRF_CLOUD_CELL_POS_JSON_KEY_LON)) {
+		value = &fields->lon;
+		field = CELL_POS_FIELD_LON;
+	} else if (key_is(key, NRF_CLOUD_CELL_POS_JSON_KEY_UNCERT)) {
+		value = &fields->unc;
+		field = CELL_POS_FIELD_UNC;
+	} else if (key_is(key, NRF_CLOUD_JSON_FULFILL_KEY)) {
+		if (!zcbor_tstr_decode(zsd, &type)) {
+			return -EBADMSG;
+		}
+		if (key_is(&type, NRF_CLOUD_CELL_POS_TYPE_VAL_MCELL)) {
+			fields->type = CELL_POS_TYPE_MULTI;
+		} else if (key_is(&type, NRF_CLOUD_CELL_POS_TYPE_VAL_SCELL)) {
+			fields->type = CELL_POS_TYPE_SINGLE;
+		} else {
+			LOG_WRN("Unhandled cellular positioning type: %.*s",
+				(int)type.len, type.value);
+		}
+		return 1;
+	} else {
+		return 0;
+	}
+
+	if (!number_decode(zsd, value)) {
+		return -EBADMSG;
+	}
+
+	fields->found |= field;
+	return 1;
+}
+
+static int cell_pos_data_decode(zcbor_state_t *zsd, struct cell_pos_fields *const fields)
+{
+	struct zcbor_string key;
+	int ret;
+
+	if (!zcbor_map_start_decode(zsd)) {
+		return -EBADMSG;
+	}
+
+	while (map_has_entry(zsd)) {
+		if (!zcbor_tstr_decode(zsd, &key)) {
+			return -EBADMSG;
+		}
+
+		ret = cell_pos_field_decode(zsd, &key, fields);
+		if (ret < 0) {
+			return ret;
+		} else if ((ret == 0) && !zcbor_any_skip(zsd, NULL)) {
+			return -EBADMSG;
+		}
+	}
+
+	return zcbor_map_end_decode(zsd) ? 0 : -EBADMSG;
+}
+
+static void cell_pos_result_set(const struct cell_pos_fields *const fields,
+				struct nrf_cloud_cell_pos_result *const result)
+{
+	result->lat = fields->lat;
+	result->lon = fields->lon;
+	result->unc = (uint32_t)fields->unc;
+	result->type = fields->type;
+}
+
+int nrf_cloud_cell_pos_response_cbor_decode(const uint8_t *const buf, size_t buf_len,
+					    struct nrf_cloud_cell_pos_result *const result)
+{
+	struct cell_pos_fields rest = { .type = CELL_POS_TYPE__INVALID };
+	struct cell_pos_fields data = { .type = CELL_POS_TYPE__INVALID };
+	struct zcbor_string key;
+	struct zcbor_string str;
+	bool app_id_match = false;
+	bool msg_type_match = false;
+	bool has_data = false;
+	bool has_err = false;
+	int32_t err_code;
+	int ret = 0;
+
+	if ((buf == NULL) || (result == NULL)) {
+		return -EINVAL;
+	}
+
+	ZCBOR_STATE_D(zsd, CBOR_MAX_DEPTH, buf, buf_len, 1);
+
+	result->err = NRF_CLOUD_ERROR_NONE;
+
+	if (!zcbor_map_start_decode(zsd)) {
+		LOG_DBG("No CBOR map found for cellular positioning");
+		return 1;
+	}
+
+	/* Single pass over the message; the REST response contains the result
+	 * directly, the MQTT message has it in the data map.
+	 */
+	while ((ret == 0) && map_has_entry(zsd)) {
+		if (!zcbor_tstr_decode(zsd, &key)) {
+			ret = -EBADMSG;
+			break;
+		}
+
+		ret = cell_pos_field_decode(zsd, &key, &rest);
+		if (ret) {
+			ret = MIN(ret, 0);
+			continue;
+		}
+
+		if (key_is(&key, NRF_CLOUD_JSON_APPID_KEY)) {
+			if (zcbor_tstr_decode(zsd, &str)) {
+				app_id_match = key_is(&str, NRF_CLOUD_JSON_APPID_VAL_CELL_POS);
+			} else {
+				ret = -EBADMSG;
+			}
+		} else if (key_is(&key, NRF_CLOUD_JSON_MSG_TYPE_KEY)) {
+			if (zcbor_tstr_decode(zsd, &str)) {
+				msg_type_match = key_is(&str, NRF_CLOUD_JSON_MSG_TYPE_VAL_DATA);
+			} else {
+				ret = -EBADMSG;
+			}
+		} else if (key_is(&key, NRF_CLOUD_JSON_DATA_KEY)) {
+			ret = cell_pos_data_decode(zsd, &data);
+			has_data = true;
+		} else if (key_is(&key, NRF_CLOUD_JSON_ERR_KEY)) {
+			if (!zcbor_int32_decode(zsd, &err_code)) {
+				LOG_WRN("Invalid CBOR data type for error value");
+				ret = -EBADMSG;
+			}
+			has_err = true;
+		} else if (!zcbor_any_skip(zsd, NULL)) {
+			ret = -EBADMSG;
+		}
+	}
+
+	if ((ret == 0) && !zcbor_map_end_decode(zsd)) {
+		ret = -EBADMSG;
+	}
+
+	if (ret) {
+		LOG_ERR("Failed to decode cellular positioning message");
+	} else if ((rest.found & CELL_POS_FIELDS_REQUIRED) == CELL_POS_FIELDS_REQUIRED) {
+		/* REST payload, which is not wrapped in an nRF Cloud MQTT message */
+		cell_pos_result_set(&rest, result);
+	} else if (!app_id_match || !msg_type_match) {
+		/* Not a cellular positioning data message */
+		ret = 1;
+	} else if (has_data) {
+		if ((data.found & CELL_POS_FIELDS_REQUIRED) == CELL_POS_FIELDS_REQUIRED) {
+			cell_pos_result_set(&data, result);
+		} else {
+			LOG_ERR("Failed to parse cellular positioning data");
+			ret = -EBADMSG;
+		}
+	} else if (has_err) {
+		/* Indicate that an nRF Cloud error code was found */
+		result->err = (enum nrf_cloud_error)err_code;
+		ret = -EFAULT;
+	} else {
+		LOG_ERR("Expected data not found in cellular positioning message");
+		ret = -EBADMSG;
+	}
+
+	if (ret < 0) {
+		/* Clear data on error */
+		result->lat = 0.0;
+		result->lon = 0.0;
+		result->unc = 0;
+		result->type = CELL_POS_TYPE__INVALID;
+
+		/* Set to unknown error if an error code was not found */
+		if (result->err == NRF_CLOUD_ERROR_NONE) {
+			result->err = NRF_CLOUD_ERROR_UNKNOWN;
+		}
+	}
+
+	return ret;
+}
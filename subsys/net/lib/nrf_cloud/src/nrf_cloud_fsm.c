@@ -24,6 +24,7 @@ static int cc_tx_ack_in_state_requested_handler(const struct nct_evt *nct_evt);
 static int cc_disconnection_handler(const struct nct_evt *nct_evt);
 static int dc_connection_handler(const struct nct_evt *nct_evt);
 static int dc_rx_data_handler(const struct nct_evt *nct_evt);
+static int dc_rx_stream_handler(const struct nct_evt *nct_evt);
 static int dc_tx_ack_handler(const struct nct_evt *nct_evt);
 static int dc_disconnection_handler(const struct nct_evt *nct_evt);
 static int cc_rx_data_handler(const struct nct_evt *nct_evt);
@@ -81,6 +82,9 @@ static const fsm_transition dc_connected_fsm_transition[NCT_EVT_TOTAL] = {
 	[NCT_EVT_CC_TX_DATA_ACK] = cc_tx_ack_handler,
 	[NCT_EVT_PINGRESP] = cc_tx_ack_handler,
 	[NCT_EVT_DC_RX_DATA] = dc_rx_data_handler,
+	[NCT_EVT_DC_RX_DATA_BEGIN] = dc_rx_stream_handler,
+	[NCT_EVT_DC_RX_DATA_CHUNK] = dc_rx_stream_handler,
+	[NCT_EVT_DC_RX_DATA_END] = dc_rx_stream_handler,
 	[NCT_EVT_DC_TX_DATA_ACK] = dc_tx_ack_handler,
 	[NCT_EVT_CC_DISCONNECTED] = cc_disconnection_handler,
 	[NCT_EVT_DC_DISCONNECTED] = dc_disconnection_handler,
@@ -559,6 +563,39 @@ static int dc_rx_data_handler(const struct nct_evt *nct_evt)
 	return 0;
 }
 
+static int dc_rx_stream_handler(const struct nct_evt *nct_evt)
+{
+	struct nrf_cloud_evt cloud_evt = {
+		.data = nct_evt->param.dc->data,
+		.topic = nct_evt->param.dc->topic,
+	};
+
+	switch (nct_evt->type) {
+	case NCT_EVT_DC_RX_DATA_BEGIN:
+		cloud_evt.type = NRF_CLOUD_EVT_RX_DATA_BEGIN;
+		cloud_evt.status = nct_evt->status;
+		break;
+	case NCT_EVT_DC_RX_DATA_CHUNK:
+		cloud_evt.type = NRF_CLOUD_EVT_RX_DATA_CHUNK;
+		cloud_evt.status = nct_evt->status;
+		break;
+	case NCT_EVT_DC_RX_DATA_END:
+		/* The status is unsigned, report errors as positive values */
+		cloud_evt.type = NRF_CLOUD_EVT_RX_DATA_END;
+		cloud_evt.status = (nct_evt->status < 0) ? -nct_evt->status : 0;
+		break;
+	default:
+		return -EINVAL;
+	}
+
+	/* Streamed data is not checked for cell-pos responses or disconnection
+	 * requests, as those always fit in the payload buffer.
+	 */
+	nfsm_set_current_state_and_notify(nfsm_get_current_state(), &cloud_evt);
+
+	return 0;
+}
+
 static int dc_tx_ack_handler(const struct nct_evt *nct_evt)
 {
 	return 0; /* Nothing to do */
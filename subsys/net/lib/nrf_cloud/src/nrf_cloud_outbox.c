@@ -0,0 +1,378 @@
+/*
+ * Copyright (c) 2022 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include <zephyr/kernel.h>
+#include <string.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/net/mqtt.h>
+#include <zephyr/settings/settings.h>
+#include "nrf_cloud_mem.h"
+#include "nrf_cloud_outbox.h"
+
+LOG_MODULE_REGISTER(nrf_cloud_outbox, CONFIG_NRF_CLOUD_LOG_LEVEL);
+
+#define OUTBOX_SETTINGS_PREFIX "nrf_cloud/" NRF_CLOUD_OUTBOX_SETTINGS_KEY
+/* Prefix, separator and a message ID of up to 5 digits */
+#define OUTBOX_SETTINGS_KEY_LEN (sizeof(OUTBOX_SETTINGS_PREFIX) + 6)
+
+/* A publication, as kept in RAM and in settings. The header is followed by
+ * the topic and the payload.
+ */
+struct outbox_record {
+	/* Order in which the publications were first sent */
+	uint32_t seq;
+	uint16_t message_id;
+	uint16_t topic_len;
+	uint8_t data[];
+};
+
+struct outbox_entry {
+	struct outbox_record *rec;
+	size_t len;
+	/* The publication is in settings */
+	bool stored;
+};
+
+static struct outbox_entry entries[CONFIG_NRF_CLOUD_MQTT_OUTBOX_WINDOW];
+static uint32_t next_seq = 1;
+static K_MUTEX_DEFINE(outbox_lock);
+
+static struct outbox_entry *entry_find(uint16_t message_id)
+{
+	for (size_t i = 0; i < ARRAY_SIZE(entries); i++) {
+		if (entries[i].rec && (entries[i].rec->message_id == message_id)) {
+			return &entries[i];
+		}
+	}
+
+	return NULL;
+}
+
+static struct outbox_entry *entry_find_free(void)
+{
+	for (size_t i = 0; i < ARRAY_SIZE(entries); i++) {
+		if (!entries[i].rec) {
+			return &entries[i];
+		}
+	}
+
+	return NULL;
+}
+
+static void entry_store(struct outbox_entry *entry)
+{
+#if defined(CONFIG_NRF_CLOUD_MQTT_OUTBOX_PERSIST)
+	char key[OUTBOX_SETTINGS_KEY_LEN];
+	int err;
+
+	snprintk(key, sizeof(key), OUTBOX_SETTINGS_PREFIX "/%u", entry->rec->message_id);
+
+	err = settings_save_one(key, entry->rec, entry->len);
+	if (err) {
+		/* The publication is still retransmitted after a reconnect */
+		LOG_WRN("Failed to store message %u: %d", entry->rec->message_id, err);
+		return;
+	}
+
+	entry->stored = true;
+#endif
+}
+
+static void entry_delete(struct outbox_entry *entry)
+{
+#if defined(CONFIG_NRF_CLOUD_MQTT_OUTBOX_PERSIST)
+	char key[OUTBOX_SETTINGS_KEY_LEN];
+	int err;
+
+	if (!entry->stored) {
+		return;
+	}
+
+	snprintk(key, sizeof(key), OUTBOX_SETTINGS_PREFIX "/%u", entry->rec->message_id);
+
+	err = settings_delete(key);
+	if (err) {
+		LOG_WRN("Failed to delete stored message %u: %d", entry->rec->message_id, err);
+	}
+
+	entry->stored = false;
+#endif
+}
+
+static void entry_free(struct outbox_entry *entry)
+{
+	nrf_cloud_free(entry->rec);
+	entry->rec = NULL;
+	entry->len = 0;
+	entry->stored = false;
+}
+
+static void publish_param_get(const struct outbox_entry *entry,
+			      struct mqtt_publish_param *param)
+{
+	const struct outbox_record *rec = entry->rec;
+
+	*param = (struct mqtt_publish_param) {
+		.message.topic.qos = MQTT_QOS_1_AT_LEAST_ONCE,
+		.message.topic.topic.utf8 = rec->data,
+		.message.topic.topic.size = rec->topic_len,
+		.message.payload.data = (uint8_t *)&rec->data[rec->topic_len],
+		.message.payload.len = entry->len - sizeof(*rec) - rec->topic_len,
+		.message_id = rec->message_id,
+		.dup_flag = 1,
+	};
+}
+
+int nrf_cloud_outbox_publish(struct mqtt_client *const client,
+			     const struct mqtt_publish_param *const param)
+{
+	const uint16_t message_id = param->message_id;
+	struct outbox_entry *entry;
+	struct outbox_record *rec;
+	size_t len;
+	int err;
+
+	if (param->message.topic.qos != MQTT_QOS_1_AT_LEAST_ONCE) {
+		return -EINVAL;
+	}
+
+	len = sizeof(*rec) + param->message.topic.topic.size + param->message.payload.len;
+
+	k_mutex_lock(&outbox_lock, K_FOREVER);
+
+	if (entry_find(message_id)) {
+		LOG_WRN("Message %u is already waiting for acknowledgment", message_id);
+		err = -EBUSY;
+		goto unlock;
+	}
+
+	entry = entry_find_free();
+	if (!entry) {
+		LOG_DBG("Outbox full, message %u not sent", message_id);
+		err = -ENOBUFS;
+		goto unlock;
+	}
+
+	rec = nrf_cloud_malloc(len);
+	if (!rec) {
+		err = -ENOMEM;
+		goto unlock;
+	}
+
+	rec->seq = next_seq++;
+	rec->message_id = message_id;
+	rec->topic_len = param->message.topic.topic.size;
+	memcpy(rec->data, param->message.topic.topic.utf8, rec->topic_len);
+	if (param->message.payload.len) {
+		memcpy(&rec->data[rec->topic_len], param->message.payload.data,
+		       param->message.payload.len);
+	}
+
+	entry->rec = rec;
+	entry->len = len;
+
+	if (!IS_ENABLED(CONFIG_NRF_CLOUD_MQTT_OUTBOX_PERSIST_ON_DISCONNECT)) {
+		entry_store(entry);
+	}
+
+	k_mutex_unlock(&outbox_lock);
+
+	/* The outbox is not locked while publishing, as the MQTT event handler
+	 * takes the outbox lock with the MQTT client locked.
+	 */
+	err = mqtt_publish(client, param);
+	if (err == 0) {
+		return 0;
+	}
+
+	k_mutex_lock(&outbox_lock, K_FOREVER);
+
+	entry = entry_find(message_id);
+	if (entry) {
+		entry_delete(entry);
+		entry_free(entry);
+	}
+
+unlock:
+	k_mutex_unlock(&outbox_lock);
+
+	return err;
+}
+
+int nrf_cloud_outbox_ack(uint16_t message_id)
+{
+	struct outbox_entry *entry;
+	int err = 0;
+
+	k_mutex_lock(&outbox_lock, K_FOREVER);
+
+	entry = entry_find(message_id);
+	if (entry) {
+		entry_delete(entry);
+		entry_free(entry);
+	} else {
+		err = -ENOENT;
+	}
+
+	k_mutex_unlock(&outbox_lock);
+
+	return err;
+}
+
+int nrf_cloud_outbox_retransmit(struct mqtt_client *const client)
+{
+	struct mqtt_publish_param param;
+	uint32_t last_seq = 0;
+	int count = 0;
+	int err = 0;
+
+	k_mutex_lock(&outbox_lock, K_FOREVER);
+
+	while (true) {
+		struct outbox_entry *next = NULL;
+
+		/* Find the oldest publication not retransmitted yet */
+		for (size_t i = 0; i < ARRAY_SIZE(entries); i++) {
+			if (entries[i].rec && (entries[i].rec->seq > last_seq) &&
+			    (!next || (entries[i].rec->seq < next->rec->seq))) {
+				next = &entries[i];
+			}
+		}
+
+		if (!next) {
+			break;
+		}
+
+		publish_param_get(next, &param);
+
+		err = mqtt_publish(client, &param);
+		if (err) {
+			LOG_ERR("Failed to retransmit message %u: %d", param.message_id, err);
+			break;
+		}
+
+		last_seq = next->rec->seq;
+		count++;
+	}
+
+	k_mutex_unlock(&outbox_lock);
+
+	return err ? err : count;
+}
+
+int nrf_cloud_outbox_persist(void)
+{
+	int count = 0;
+
+	k_mutex_lock(&outbox_lock, K_FOREVER);
+
+	for (size_t i = 0; i < ARRAY_SIZE(entries); i++) {
+		if (entries[i].rec && !entries[i].stored) {
+			entry_store(&entries[i]);
+			count += entries[i].stored ? 1 : 0;
+		}
+	}
+
+	k_mutex_unlock(&outbox_lock);
+
+	return count;
+}
+
+bool nrf_cloud_outbox_contains(uint16_t message_id)
+{
+	bool found;
+
+	k_mutex_lock(&outbox_lock, K_FOREVER);
+	found = (entry_find(message_id) != NULL);
+	k_mutex_unlock(&outbox_lock);
+
+	return found;
+}
+
+size_t nrf_cloud_outbox_free_get(void)
+{
+	size_t count = 0;
+
+	k_mutex_lock(&outbox_lock, K_FOREVER);
+
+	for (size_t i = 0; i < ARRAY_SIZE(entries); i++) {
+		if (!entries[i].rec) {
+			count++;
+		}
+	}
+
+	k_mutex_unlock(&outbox_lock);
+
+	return count;
+}
+
+void nrf_cloud_outbox_reset(void)
+{
+	k_mutex_lock(&outbox_lock, K_FOREVER);
+
+	for (size_t i = 0; i < ARRAY_SIZE(entries); i++) {
+		if (entries[i].rec) {
+			entry_free(&entries[i]);
+		}
+	}
+
+	next_seq = 1;
+
+	k_mutex_unlock(&outbox_lock);
+}
+
+int nrf_cloud_outbox_settings_set(const char *key, size_t len_rd,
+				  settings_read_cb read_cb, void *cb_arg)
+{
+	struct outbox_entry *entry;
+	struct outbox_record *rec;
+	int err = 0;
+
+	if (len_rd < sizeof(*rec)) {
+		LOG_WRN("Invalid stored message: %s", key);
+		return -EINVAL;
+	}
+
+	rec = nrf_cloud_malloc(len_rd);
+	if (!rec) {
+		return -ENOMEM;
+	}
+
+	if ((read_cb(cb_arg, rec, len_rd) != len_rd) ||
+	    (rec->topic_len > (len_rd - sizeof(*rec)))) {
+		LOG_WRN("Invalid stored message: %s", key);
+		nrf_cloud_free(rec);
+		return -EINVAL;
+	}
+
+	k_mutex_lock(&outbox_lock, K_FOREVER);
+
+	if (entry_find(rec->message_id)) {
+		/* Already loaded */
+		nrf_cloud_free(rec);
+		goto unlock;
+	}
+
+	entry = entry_find_free();
+	if (!entry) {
+		LOG_WRN("Outbox full, stored message %u not loaded", rec->message_id);
+		nrf_cloud_free(rec);
+		err = -ENOBUFS;
+		goto unlock;
+	}
+
+	entry->rec = rec;
+	entry->len = len_rd;
+	entry->stored = true;
+	next_seq = MAX(next_seq, rec->seq + 1);
+
+	LOG_DBG("Loaded stored message %u", rec->message_id);
+
+unlock:
+	k_mutex_unlock(&outbox_lock);
+
+	return err;
+}
@@ -5,9 +5,13 @@
  */
 
 #include <zephyr/kernel.h>
-#include <nrfx_nvmc.h>
 #include <zephyr/device.h>
+#include <zephyr/drivers/flash.h>
 #include <zephyr/storage/stream_flash.h>
+#include <zephyr/sys/crc.h>
+#if defined(CONFIG_FLASH_SIMULATOR)
+#include <zephyr/drivers/flash/flash_simulator.h>
+#endif
 
 #include <cJSON.h>
 #include <cJSON_os.h>
@@ -18,7 +22,10 @@
 #include <zephyr/settings/settings.h>
 #include <zephyr/sys/reboot.h>
 #include <zephyr/logging/log_ctrl.h>
+#if defined(CONFIG_NRF_CLOUD_PGPS_STORAGE_PARTITION) || \
+	defined(CONFIG_NRF_CLOUD_PGPS_STORAGE_MCUBOOT_SECONDARY)
 #include <pm_config.h>
+#endif
 
 #include <zephyr/logging/log.h>
 
@@ -38,10 +45,17 @@ LOG_MODULE_REGISTER(nrf_cloud_pgps, CONFIG_NRF_CLOUD_GPS_LOG_LEVEL);
 #define SEC_TAG				CONFIG_NRF_CLOUD_SEC_TAG
 #define FRAGMENT_SIZE			CONFIG_NRF_CLOUD_PGPS_DOWNLOAD_FRAGMENT_SIZE
 #define PREDICTION_MIDPOINT_SHIFT_SEC	(120 * SEC_PER_MIN)
+#define PREFETCH_SEC			CONFIG_NRF_CLOUD_PGPS_PREFETCH_SEC
 #define LOCATION_UNC_SEMIMAJOR_K	89U
 #define LOCATION_UNC_SEMIMINOR_K	89U
 #define LOCATION_CONFIDENCE_PERCENT	68U
 
+#if DT_HAS_CHOSEN(zephyr_flash_controller)
+#define FLASH_NODE			DT_CHOSEN(zephyr_flash_controller)
+#else
+#define FLASH_NODE			DT_NODELABEL(flash_controller)
+#endif
+
 BUILD_ASSERT(((NUM_PREDICTIONS & 1) == 0),
 	 "NUM_PREDICTIONS must be even");
 BUILD_ASSERT(((REPLACEMENT_THRESHOLD & 1) == 0),
@@ -79,6 +93,10 @@ struct pgps_index {
 
 	/* array of pointers to predictions, in sorted time order */
 	struct nrf_cloud_pgps_prediction *predictions[NUM_PREDICTIONS];
+	/* CRC-32 of each stored prediction */
+	uint32_t crc[NUM_PREDICTIONS];
+	/* true once the stored prediction has been checked after boot or download */
+	bool verified[NUM_PREDICTIONS];
 };
 
 static struct pgps_index index;
@@ -87,15 +105,20 @@ static pgps_event_handler_t evt_handler;
 /* array of potentially out-of-time-order predictions */
 static uint8_t *storage;
 static uint32_t storage_size;
+/* offset of the storage in the flash device */
+static uint32_t storage_offset;
+static const struct device *const flash_dev = DEVICE_DT_GET(FLASH_NODE);
 static struct stream_flash_ctx stream;
 static uint8_t *write_buf;
 static uint32_t flash_page_size;
 
+/* large enough to build the stored form of a downloaded prediction in place */
 static uint8_t prediction_buf[PGPS_PREDICTION_STORAGE_SIZE];
 static atomic_t accept_packets;
 static atomic_t pgps_need_assistance;
 
 static int validate_stored_predictions(uint16_t *bad_day, uint32_t *bad_time);
+static int find_prediction(struct nrf_cloud_pgps_prediction **prediction, uint32_t ahead_sec);
 static void log_pgps_header(const char *msg, const struct nrf_cloud_pgps_header *header);
 static int consume_pgps_header(const char *buf, size_t buf_len);
 static void cache_pgps_header(const struct nrf_cloud_pgps_header *header);
@@ -249,6 +272,7 @@ static int validate_stored_predictions(uint16_t *first_bad_day,
 	/* reset catalog of predictions */
 	for (pnum = 0; pnum < count; pnum++) {
 		index.predictions[pnum] = NULL;
+		index.verified[pnum] = false;
 	}
 
 	npgps_reset_block_pool();
@@ -303,6 +327,9 @@ static int validate_stored_predictions(uint16_t *first_bad_day,
 		LOG_DBG("Prediction num:%u, loc:%p, blk:%d", pnum, pred, i);
 		__ASSERT(i != -1, "unexpected pointer value %p", pred);
 		npgps_mark_block_used(i, true);
+
+		index.crc[pnum] = crc32_ieee((const uint8_t *)pred, PGPS_PREDICTION_STORAGE_SIZE);
+		index.verified[pnum] = true;
 	}
 
 	/* find first free block in flash, if any, after chronologicaly
@@ -336,6 +363,115 @@ static void get_prediction_day_time(int pnum, int64_t *gps_sec, uint16_t *gps_da
 	}
 }
 
+/* Check a stored prediction the first time it is used after boot or download,
+ * so that later lookups do not need to read it from flash.
+ */
+static int verify_prediction(int pnum)
+{
+	const struct nrf_cloud_pgps_prediction *p = index.predictions[pnum];
+	uint16_t gps_day;
+	uint32_t gps_time_of_day;
+	int err;
+
+	if (index.verified[pnum]) {
+		return 0;
+	}
+
+	if (crc32_ieee((const uint8_t *)p, PGPS_PREDICTION_STORAGE_SIZE) != index.crc[pnum]) {
+		LOG_ERR("Prediction num:%d at:%p has bad CRC", pnum, p);
+		return -EINVAL;
+	}
+
+	get_prediction_day_time(pnum, NULL, &gps_day, &gps_time_of_day);
+	err = validate_prediction(p, gps_day, gps_time_of_day,
+				  index.header.prediction_period_min, true, false);
+	if (!err) {
+		index.verified[pnum] = true;
+	}
+	return err;
+}
+
+static int count_valid_predictions(void)
+{
+	int pnum;
+
+	for (pnum = 0; pnum < index.header.prediction_count; pnum++) {
+		if (index.predictions[pnum] == NULL) {
+			break;
+		}
+	}
+	return pnum;
+}
+
+static void save_index(void)
+{
+	static struct npgps_saved_index saved;
+	int err;
+
+	memset(&saved, 0, sizeof(saved));
+	saved.start_sec = index.start_sec;
+	saved.count = count_valid_predictions();
+	for (int pnum = 0; pnum < saved.count; pnum++) {
+		saved.block[pnum] = npgps_pointer_to_block((uint8_t *)index.predictions[pnum]);
+		saved.crc[pnum] = index.crc[pnum];
+	}
+
+	err = npgps_save_index(&saved);
+	if (err) {
+		LOG_ERR("Error saving P-GPS index:%d", err);
+	}
+}
+
+static void invalidate_saved_index(void)
+{
+	static const struct npgps_saved_index empty;
+	int err;
+
+	if (npgps_get_saved_index()->count == 0) {
+		return;
+	}
+
+	err = npgps_save_index(&empty);
+	if (err) {
+		LOG_ERR("Error invalidating P-GPS index:%d", err);
+	}
+}
+
+/* Build the catalog of predictions from the saved index instead of reading
+ * every stored prediction. Each prediction is checked when it is first used.
+ */
+static int load_saved_index(void)
+{
+	const struct npgps_saved_index *saved = npgps_get_saved_index();
+	int block = NO_BLOCK;
+	int pnum;
+
+	if ((saved->count == 0) || (saved->start_sec != index.start_sec) ||
+	    (saved->count > index.header.prediction_count)) {
+		LOG_INF("Saved P-GPS index does not match stored predictions");
+		return -ENODATA;
+	}
+
+	memset(index.predictions, 0, sizeof(index.predictions));
+	memset(index.verified, 0, sizeof(index.verified));
+	npgps_reset_block_pool();
+
+	for (pnum = 0; pnum < saved->count; pnum++) {
+		block = saved->block[pnum];
+		index.predictions[pnum] = npgps_block_to_pointer(block);
+		if (index.predictions[pnum] == NULL) {
+			LOG_ERR("Saved P-GPS index is corrupted");
+			return -EINVAL;
+		}
+		index.crc[pnum] = saved->crc[pnum];
+		npgps_mark_block_used(block, true);
+	}
+
+	(void)npgps_find_first_free(block);
+	npgps_print_blocks();
+	return saved->count;
+}
+
 static void discard_oldest_predictions(int num)
 {
 	int i;
@@ -360,6 +496,8 @@ static void discard_oldest_predictions(int num)
 	for (i = last; i < index.header.prediction_count; i++) {
 		pnum = i - last;
 		index.predictions[pnum] = index.predictions[i];
+		index.crc[pnum] = index.crc[i];
+		index.verified[pnum] = index.verified[i];
 	}
 
 	/* set prediction pointers for 'last' in the newly empty
@@ -388,6 +526,8 @@ static void discard_oldest_predictions(int num)
 	LOG_DBG("updated index to gps_sec:%d, day:%u, time:%u",
 		(int32_t)index.start_sec, index.header.gps_day,
 		index.header.gps_time_of_day);
+
+	save_index();
 }
 
 int nrf_cloud_pgps_notify_prediction(void)
@@ -447,7 +587,7 @@ static void prediction_work_handler(struct k_work *work)
 	int ret;
 
 	LOG_DBG("Prediction is expiring; finding next");
-	ret = nrf_cloud_pgps_find_prediction(&p);
+	ret = find_prediction(&p, PREFETCH_SEC);
 	if (ret >= 0) {
 		LOG_DBG("found prediction %d; injecting to modem", ret);
 		ret = nrf_cloud_pgps_inject(p, NULL);
@@ -475,7 +615,8 @@ static void start_expiration_timer(int pnum, int64_t cur_gps_sec)
 	}
 	get_prediction_day_time(pnum, &start_sec, NULL, NULL);
 	end_sec = index.header.prediction_period_min * SEC_PER_MIN + start_sec;
-	delta = (end_sec - cur_gps_sec) + 1;
+	/* inject the next prediction PREFETCH_SEC before this one expires */
+	delta = MAX(end_sec - cur_gps_sec - PREFETCH_SEC, 0) + 1;
 	/* add 1 second to ensure we don't time out just slightly before
 	 * the data actually expires (e.g. < 1 second)
 	 */
@@ -500,6 +641,15 @@ static void print_time_details(const char *info,
 }
 
 int nrf_cloud_pgps_find_prediction(struct nrf_cloud_pgps_prediction **prediction)
+{
+	return find_prediction(prediction, 0);
+}
+
+/* Find the prediction for the time ahead_sec seconds from now. The lookup uses
+ * only the index in RAM; the prediction itself is read from flash only the
+ * first time it is used.
+ */
+static int find_prediction(struct nrf_cloud_pgps_prediction **prediction, uint32_t ahead_sec)
 {
 	int64_t cur_gps_sec;
 	int64_t offset_sec;
@@ -513,7 +663,6 @@ int nrf_cloud_pgps_find_prediction(struct nrf_cloud_pgps_prediction **prediction
 	uint16_t count = index.header.prediction_count;
 	int err;
 	int pnum;
-	bool margin = false;
 
 	if (state == PGPS_NONE) {
 		LOG_ERR("P-GPS subsystem is not initialized.");
@@ -533,7 +682,8 @@ int nrf_cloud_pgps_find_prediction(struct nrf_cloud_pgps_prediction **prediction
 	}
 
 	err = npgps_get_shifted_time(&cur_gps_sec, &cur_gps_day,
-				     &cur_gps_time_of_day, PREDICTION_MIDPOINT_SHIFT_SEC);
+				     &cur_gps_time_of_day,
+				     PREDICTION_MIDPOINT_SHIFT_SEC + ahead_sec);
 	if (err < 0) {
 		LOG_INF("Unknown current time");
 		cur_gps_sec = 0;
@@ -571,7 +721,6 @@ int nrf_cloud_pgps_find_prediction(struct nrf_cloud_pgps_prediction **prediction
 			LOG_WRN("data expired!");
 			return -ETIMEDOUT;
 		}
-		margin = true;
 		/* data is expired; use most recent entry */
 		pnum = count - 1;
 	} else {
@@ -586,11 +735,9 @@ int nrf_cloud_pgps_find_prediction(struct nrf_cloud_pgps_prediction **prediction
 	index.cur_pnum = pnum;
 	*prediction = index.predictions[pnum];
 	if (*prediction) {
-		err = validate_prediction(*prediction,
-					  cur_gps_day, cur_gps_time_of_day,
-					  period_min, false, margin);
+		err = verify_prediction(pnum);
 		if (!err) {
-			start_expiration_timer(pnum, cur_gps_sec);
+			start_expiration_timer(pnum, cur_gps_sec - ahead_sec);
 			return pnum;
 		}
 		return err;
@@ -1066,7 +1213,6 @@ void *flash_callback;
 static int open_storage(uint32_t offset, bool preserve)
 {
 	int err;
-	const struct device *flash_dev = DEVICE_DT_GET(DT_NODELABEL(flash_controller));
 	uint32_t block_offset = 0;
 
 	LOG_DBG("storage name: %s", flash_dev->name);
@@ -1084,7 +1230,7 @@ static int open_storage(uint32_t offset, bool preserve)
 
 	err = stream_flash_init(&stream, flash_dev,
 				write_buf, flash_page_size,
-				((uint32_t)storage) + offset,
+				storage_offset + offset,
 				storage_size - offset, flash_callback);
 	if (err) {
 		LOG_ERR("Failed to init flash stream for offset %u: %d",
@@ -1108,44 +1254,30 @@ static int open_storage(uint32_t offset, bool preserve)
 	return err;
 }
 
-static int store_prediction(uint8_t *p, size_t len, uint32_t sentinel, bool last)
+/* Build the stored form of the downloaded prediction in place and write it with
+ * a single buffered write: the schema version is inserted after the time, and
+ * the sentinel and padding are appended. The buffer must be
+ * PGPS_PREDICTION_STORAGE_SIZE bytes long.
+ */
+static int store_prediction(uint8_t *p, size_t len, uint32_t sentinel, bool last,
+			    uint32_t *crc)
 {
-	static bool first = true;
-	static uint8_t pad[PGPS_PREDICTION_PAD];
+	size_t schema_offset = offsetof(struct nrf_cloud_pgps_prediction, schema_version);
+	size_t sentinel_offset = offsetof(struct nrf_cloud_pgps_prediction, sentinel);
 	int err;
-	uint8_t schema = NRF_CLOUD_AGPS_BIN_SCHEMA_VERSION;
-	size_t schema_offset = ((size_t) &((struct nrf_cloud_pgps_prediction *)0)->schema_version);
 
-	if (first) {
-		memset(pad, 0xff, PGPS_PREDICTION_PAD);
-		first = false;
-	}
+	__ASSERT(len == PGPS_PREDICTION_DL_SIZE, "unexpected prediction size %zd", len);
 
-	err = stream_flash_buffered_write(&stream, p, schema_offset, false);
-	if (err) {
-		LOG_ERR("Error writing pgps prediction:%d", err);
-		return err;
-	}
-	p += schema_offset;
-	len -= schema_offset;
-	err = stream_flash_buffered_write(&stream, &schema, sizeof(schema), false);
-	if (err) {
-		LOG_ERR("Error writing schema:%d", err);
-		return err;
-	}
-	err = stream_flash_buffered_write(&stream, p, len, false);
+	memmove(&p[schema_offset + PGPS_SCHEMA_SIZE], &p[schema_offset], len - schema_offset);
+	p[schema_offset] = NRF_CLOUD_AGPS_BIN_SCHEMA_VERSION;
+	memcpy(&p[sentinel_offset], &sentinel, PGPS_SENTINEL_SIZE);
+	memset(&p[sizeof(struct nrf_cloud_pgps_prediction)], 0xff, PGPS_PREDICTION_PAD);
+
+	*crc = crc32_ieee(p, PGPS_PREDICTION_STORAGE_SIZE);
+
+	err = stream_flash_buffered_write(&stream, p, PGPS_PREDICTION_STORAGE_SIZE, last);
 	if (err) {
 		LOG_ERR("Error writing pgps prediction:%d", err);
-		return err;
-	}
-	err = stream_flash_buffered_write(&stream, (uint8_t *)&sentinel,
-					  sizeof(sentinel), false);
-	if (err) {
-		LOG_ERR("Error writing sentinel:%d", err);
-	}
-	err = stream_flash_buffered_write(&stream, pad, PGPS_PREDICTION_PAD, last);
-	if (err) {
-		LOG_ERR("Error writing sentinel:%d", err);
 	}
 	return err;
 }
@@ -1388,9 +1520,14 @@ static int consume_pgps_data(uint8_t pnum, const char *buf, size_t buf_len)
 
 			index.loading_count++;
 			finished = (index.loading_count == index.expected_count);
-			store_prediction(prediction_ptr, buf_len, (uint32_t)gps_sec,
-					 finished || (index.storage_extent == 1));
+			err = store_prediction(prediction_ptr, buf_len, (uint32_t)gps_sec,
+					       finished || (index.storage_extent == 1),
+					       &index.crc[pnum]);
+			if (err) {
+				return err;
+			}
 			index.predictions[pnum] = npgps_block_to_pointer(index.store_block);
+			index.verified[pnum] = false;
 
 			if (pgps_need_assistance &&
 			    (finished || (index.loading_count > 1))) {
@@ -1407,6 +1544,7 @@ static int consume_pgps_data(uint8_t pnum, const char *buf, size_t buf_len)
 				}
 			} else {
 				LOG_INF("All P-GPS data received. Done.");
+				save_index();
 				state = PGPS_READY;
 				if (evt_handler) {
 					struct nrf_cloud_pgps_event evt = {
@@ -1476,10 +1614,14 @@ int nrf_cloud_pgps_begin_update(void)
 		index.period_sec =
 			index.header.prediction_period_min * SEC_PER_MIN;
 		memset(index.predictions, 0, sizeof(index.predictions));
+		memset(index.verified, 0, sizeof(index.verified));
+		/* all blocks may be overwritten; find what is valid on next boot */
+		invalidate_saved_index();
 	} else {
 		for (uint8_t pnum = index.pnum_offset;
 		     pnum < index.expected_count + index.pnum_offset; pnum++) {
 			index.predictions[pnum] = NULL;
+			index.verified[pnum] = false;
 		}
 	}
 	index.loading_count = 0;
@@ -1565,8 +1707,11 @@ int nrf_cloud_pgps_init(struct nrf_cloud_pgps_init_param *param)
 		evt_handler(&evt);
 	}
 
-	flash_page_size = nrfx_nvmc_flash_page_size_get();
-	if (!flash_page_size) {
+	struct flash_pages_info page_info;
+
+	if (flash_get_page_info_by_offs(flash_dev, param->storage_base, &page_info) == 0) {
+		flash_page_size = page_info.size;
+	} else {
 		flash_page_size = 4096;
 	}
 
@@ -1593,9 +1738,15 @@ int nrf_cloud_pgps_init(struct nrf_cloud_pgps_init_param *param)
 #endif
 	}
 
-	storage = (uint8_t *)param->storage_base;
+	storage_offset = param->storage_base;
 	storage_size = param->storage_size;
-	(void)ngps_block_pool_init(param->storage_base, NUM_PREDICTIONS);
+#if defined(CONFIG_FLASH_SIMULATOR)
+	/* the simulated flash is not memory mapped; storage_base is an offset in it */
+	storage = (uint8_t *)flash_simulator_get_memory(flash_dev, NULL) + storage_offset;
+#else
+	storage = (uint8_t *)storage_offset;
+#endif
+	(void)ngps_block_pool_init(storage, NUM_PREDICTIONS);
 
 	memset(&index, 0, sizeof(index));
 	(void)npgps_settings_init();
@@ -1631,7 +1782,32 @@ int nrf_cloud_pgps_init(struct nrf_cloud_pgps_init_param *param)
 		 */
 		LOG_INF("Checking stored P-GPS data; count:%u, period_min:%u",
 			count, period_min);
-		num_valid = validate_stored_predictions(&gps_day, &gps_time_of_day);
+		int64_t start_ms = k_uptime_get();
+
+		err = load_saved_index();
+		if (err > 0) {
+			struct nrf_cloud_pgps_prediction *p;
+
+			/* a prediction that does not match its saved CRC means the
+			 * saved index does not describe the flash contents
+			 */
+			if (find_prediction(&p, 0) == -EINVAL) {
+				LOG_WRN("Saved P-GPS index does not match stored predictions");
+				err = -EINVAL;
+			}
+		}
+		if (err < 0) {
+			/* walk through the stored predictions instead */
+			num_valid = validate_stored_predictions(&gps_day, &gps_time_of_day);
+			if (num_valid) {
+				save_index();
+			}
+		} else {
+			num_valid = err;
+		}
+		err = 0;
+		LOG_INF("Found %u valid predictions in %d ms", num_valid,
+			(int32_t)(k_uptime_get() - start_ms));
 	}
 
 	struct nrf_cloud_pgps_prediction *found_prediction = NULL;
@@ -5,12 +5,13 @@
  */
 
 #include <zephyr/kernel.h>
-#include <pm_config.h>
 #include <stdlib.h>
 
 #include <net/nrf_cloud_pgps.h>
 #include <zephyr/settings/settings.h>
+#if defined(CONFIG_NRF_CLOUD_PGPS_DOWNLOAD_TRANSPORT_HTTP)
 #include <net/download_client.h>
+#endif
 #include <date_time.h>
 
 #include "nrf_cloud_transport.h"
@@ -29,6 +30,8 @@ LOG_MODULE_DECLARE(nrf_cloud_pgps, CONFIG_NRF_CLOUD_GPS_LOG_LEVEL);
 #define SETTINGS_FULL_LOCATION			SETTINGS_NAME "/" SETTINGS_KEY_LOCATION
 #define SETTINGS_KEY_LEAP_SEC			"g2u_leap_sec"
 #define SETTINGS_FULL_LEAP_SEC			SETTINGS_NAME "/" SETTINGS_KEY_LEAP_SEC
+#define SETTINGS_KEY_PGPS_INDEX			"pgps_index"
+#define SETTINGS_FULL_PGPS_INDEX		SETTINGS_NAME "/" SETTINGS_KEY_PGPS_INDEX
 
 struct block_pool {
 	int first_free;
@@ -44,14 +47,17 @@ static int num_blocks;
 static int gps_leap_seconds = GPS_TO_UTC_LEAP_SECONDS;
 static struct gps_location saved_location;
 static struct nrf_cloud_pgps_header saved_header;
+static struct npgps_saved_index saved_index;
 
 static K_SEM_DEFINE(pgps_active, 1, 1);
+#if defined(CONFIG_NRF_CLOUD_PGPS_DOWNLOAD_TRANSPORT_HTTP)
 static struct download_client dlc;
 static int socket_retries_left;
 static npgps_buffer_handler_t buffer_handler;
 static npgps_eot_handler_t eot_handler;
 
 static int download_client_callback(const struct download_client_evt *event);
+#endif
 static int settings_set(const char *key, size_t len_rd,
 			settings_read_cb read_cb, void *cb_arg);
 
@@ -67,6 +73,15 @@ static int settings_set(const char *key, size_t len_rd,
 
 	LOG_DBG("Settings key:%s, size:%d", key, len_rd);
 
+	if (!strncmp(key, SETTINGS_KEY_PGPS_INDEX,
+		     strlen(SETTINGS_KEY_PGPS_INDEX)) &&
+	    (len_rd == sizeof(saved_index))) {
+		if (read_cb(cb_arg, (void *)&saved_index, len_rd) == len_rd) {
+			LOG_DBG("Read pgps_index: count:%u, start sec:%d",
+				saved_index.count, (int32_t)saved_index.start_sec);
+			return 0;
+		}
+	}
 	if (!strncmp(key, SETTINGS_KEY_PGPS_HEADER,
 		     strlen(SETTINGS_KEY_PGPS_HEADER)) &&
 		(len_rd == sizeof(saved_header))) {
@@ -133,6 +148,23 @@ const struct nrf_cloud_pgps_header *npgps_get_saved_header(void)
 	return &saved_header;
 }
 
+int npgps_save_index(const struct npgps_saved_index *new_index)
+{
+	int ret;
+
+	LOG_DBG("Saving pgps index; count:%u", new_index->count);
+	ret = settings_save_one(SETTINGS_FULL_PGPS_INDEX, new_index, sizeof(*new_index));
+	if (!ret) {
+		memcpy(&saved_index, new_index, sizeof(saved_index));
+	}
+	return ret;
+}
+
+const struct npgps_saved_index *npgps_get_saved_index(void)
+{
+	return &saved_index;
+}
+
 /* @TODO: consider rate-limiting these updates to reduce Flash wear */
 static int save_location(void)
 {
@@ -293,9 +325,9 @@ int npgps_get_time(int64_t *gps_sec, uint16_t *gps_day, uint32_t *gps_time_of_da
 	return npgps_get_shifted_time(gps_sec, gps_day, gps_time_of_day, 0);
 }
 
-int ngps_block_pool_init(uint32_t base_address, int num)
+int ngps_block_pool_init(uint8_t *base, int num)
 {
-	block_pool_base = (uint8_t *)base_address;
+	block_pool_base = base;
 	num_blocks = num;
 	return 0;
 }
@@ -450,6 +482,7 @@ void *npgps_block_to_pointer(int block)
 	return ret;
 }
 
+#if defined(CONFIG_NRF_CLOUD_PGPS_DOWNLOAD_TRANSPORT_HTTP)
 int npgps_download_init(npgps_buffer_handler_t buf_handler, npgps_eot_handler_t end_handler)
 {
 	__ASSERT(buf_handler != NULL, "Must specify buffer handler");
@@ -540,3 +573,4 @@ static int download_client_callback(const struct download_client_evt *event)
 	eot_handler(err);
 	return err;
 }
+#endif /* CONFIG_NRF_CLOUD_PGPS_DOWNLOAD_TRANSPORT_HTTP */
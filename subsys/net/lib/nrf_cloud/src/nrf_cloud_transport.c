@@ -7,6 +7,7 @@
 #include "nrf_cloud_transport.h"
 #include "nrf_cloud_mem.h"
 #include "nrf_cloud_client_id.h"
+#include "nrf_cloud_outbox.h"
 #if defined(CONFIG_NRF_CLOUD_FOTA)
 #include "nrf_cloud_fota.h"
 #endif
@@ -29,6 +30,13 @@
 
 LOG_MODULE_REGISTER(nrf_cloud_transport, CONFIG_NRF_CLOUD_LOG_LEVEL);
 
+/* Define a custom NCT_STATIC macro that exposes internal functions when unit testing. */
+#if defined(CONFIG_UNITY)
+#define NCT_STATIC
+#else
+#define NCT_STATIC static
+#endif
+
 #if defined(CONFIG_NRF_CLOUD_PROVISION_CERTIFICATES)
 #include CONFIG_NRF_CLOUD_CERTIFICATES_FILE
 #if defined(CONFIG_MODEM_KEY_MGMT)
@@ -108,8 +116,8 @@ SETTINGS_STATIC_HANDLER_DEFINE(nrf_cloud, SETTINGS_NAME, NULL, nct_settings_set,
 			       NULL, NULL);
 
 /* Forward declaration of the event handler registered with MQTT. */
-static void nct_mqtt_evt_handler(struct mqtt_client *client,
-				 const struct mqtt_evt *evt);
+NCT_STATIC void nct_mqtt_evt_handler(struct mqtt_client *client,
+				     const struct mqtt_evt *evt);
 
 /* nrf_cloud transport instance. */
 static struct nct {
@@ -156,12 +164,16 @@ static void dc_endpoint_reset(void)
 /* Get the next unused message id. */
 static uint16_t get_next_message_id(void)
 {
-	if (nct.message_id < NCT_MSG_ID_INCREMENT_BEGIN ||
-	    nct.message_id == NCT_MSG_ID_INCREMENT_END) {
-		nct.message_id = NCT_MSG_ID_INCREMENT_BEGIN;
-	} else {
-		++nct.message_id;
-	}
+	/* Skip IDs of publications still waiting for acknowledgment. */
+	do {
+		if (nct.message_id < NCT_MSG_ID_INCREMENT_BEGIN ||
+		    nct.message_id == NCT_MSG_ID_INCREMENT_END) {
+			nct.message_id = NCT_MSG_ID_INCREMENT_BEGIN;
+		} else {
+			++nct.message_id;
+		}
+	} while (IS_ENABLED(CONFIG_NRF_CLOUD_MQTT_OUTBOX) &&
+		 nrf_cloud_outbox_contains(nct.message_id));
 
 	return nct.message_id;
 }
@@ -203,6 +215,19 @@ static void dc_endpoint_free(void)
 #endif
 }
 
+/* Publish on a data channel topic. QoS 1 publications are kept in the outbox
+ * until acknowledged, if enabled.
+ */
+static int dc_publish(const struct mqtt_publish_param *const publish)
+{
+	if (IS_ENABLED(CONFIG_NRF_CLOUD_MQTT_OUTBOX) &&
+	    (publish->message.topic.qos == MQTT_QOS_1_AT_LEAST_ONCE)) {
+		return nrf_cloud_outbox_publish(&nct.client, publish);
+	}
+
+	return mqtt_publish(&nct.client, publish);
+}
+
 static uint32_t dc_send(const struct nct_dc_data *dc_data, uint8_t qos)
 {
 	if (dc_data == NULL) {
@@ -226,7 +251,7 @@ static uint32_t dc_send(const struct nct_dc_data *dc_data, uint8_t qos)
 		publish.message_id = get_message_id(dc_data->message_id);
 	}
 
-	return mqtt_publish(&nct.client, &publish);
+	return dc_publish(&publish);
 }
 
 static int bulk_send(const struct nct_dc_data *dc_data, enum mqtt_qos qos)
@@ -259,7 +284,7 @@ static int bulk_send(const struct nct_dc_data *dc_data, enum mqtt_qos qos)
 		publish.message_id = get_message_id(dc_data->message_id);
 	}
 
-	return mqtt_publish(&nct.client, &publish);
+	return dc_publish(&publish);
 }
 
 static bool strings_compare(const char *s1, const char *s2, uint32_t s1_len,
@@ -287,6 +312,11 @@ static bool control_channel_topic_match(uint32_t list_id,
 	}
 
 	for (uint32_t index = 0; index < list_size; index++) {
+		/* Topics that are not set yet must not match */
+		if (topic_list[index].topic.size == 0) {
+			continue;
+		}
+
 		if (strings_compare(
 			    topic->topic.utf8, topic_list[index].topic.utf8,
 			    topic->topic.size, topic_list[index].topic.size)) {
@@ -650,6 +680,14 @@ static int nct_settings_set(const char *key, size_t len_rd,
 
 	LOG_DBG("Settings key: %s, size: %d", key, len_rd);
 
+#if defined(CONFIG_NRF_CLOUD_MQTT_OUTBOX_PERSIST)
+	const char *next;
+
+	if (settings_name_steq(key, NRF_CLOUD_OUTBOX_SETTINGS_KEY, &next) && next) {
+		return nrf_cloud_outbox_settings_set(next, len_rd, read_cb, cb_arg);
+	}
+#endif
+
 	if (!strncmp(key, SETTINGS_KEY_PERSISTENT_SESSION,
 		     strlen(SETTINGS_KEY_PERSISTENT_SESSION)) &&
 	    (len_rd == sizeof(read_val))) {
@@ -686,13 +724,14 @@ static int nct_settings_init(void)
 {
 	int ret = 0;
 
-#if !defined(CONFIG_MQTT_CLEAN_SESSION) || defined(CONFIG_NRF_CLOUD_FOTA)
+#if !defined(CONFIG_MQTT_CLEAN_SESSION) || defined(CONFIG_NRF_CLOUD_FOTA) || \
+	defined(CONFIG_NRF_CLOUD_MQTT_OUTBOX_PERSIST)
 	ret = settings_subsys_init();
 	if (ret) {
 		LOG_ERR("Settings init failed: %d", ret);
 		return ret;
 	}
-#if !defined(CONFIG_MQTT_CLEAN_SESSION)
+#if !defined(CONFIG_MQTT_CLEAN_SESSION) || defined(CONFIG_NRF_CLOUD_MQTT_OUTBOX_PERSIST)
 	ret = settings_load_subtree(settings_handler_nrf_cloud.name);
 	if (ret) {
 		LOG_ERR("Cannot load settings: %d", ret);
@@ -853,9 +892,66 @@ static int publish_get_payload(struct mqtt_client *client, size_t length)
 	return ret;
 }
 
+static bool publish_stream_required(size_t length)
+{
+	return IS_ENABLED(CONFIG_NRF_CLOUD_MQTT_RX_STREAM) &&
+	       (length > (sizeof(nct.payload_buf) - 1));
+}
+
+/* Deliver a data channel payload that does not fit in the payload buffer in
+ * chunks of up to the buffer size, as they are read from the socket.
+ */
+static int publish_stream_payload(struct mqtt_client *client,
+				  const struct mqtt_publish_param *p)
+{
+	struct nct_dc_data dc = {
+		.message_id = p->message_id,
+		.topic.len = p->message.topic.topic.size,
+		.topic.ptr = p->message.topic.topic.utf8,
+	};
+	struct nct_evt evt = {
+		.status = p->message.payload.len,
+		.param.dc = &dc,
+		.type = NCT_EVT_DC_RX_DATA_BEGIN,
+	};
+	size_t offset = 0;
+	int ret = 0;
+
+	(void)nct_input(&evt);
+
+	while (offset < p->message.payload.len) {
+		ret = mqtt_read_publish_payload_blocking(client, nct.payload_buf,
+			MIN(p->message.payload.len - offset, sizeof(nct.payload_buf) - 1));
+		if (ret <= 0) {
+			ret = (ret == 0) ? -EIO : ret;
+			break;
+		}
+
+		/* Ensure buffer is always NULL-terminated */
+		nct.payload_buf[ret] = 0;
+
+		dc.data.ptr = nct.payload_buf;
+		dc.data.len = ret;
+		evt.status = offset;
+		evt.type = NCT_EVT_DC_RX_DATA_CHUNK;
+		(void)nct_input(&evt);
+
+		offset += ret;
+		ret = 0;
+	}
+
+	dc.data.ptr = NULL;
+	dc.data.len = 0;
+	evt.status = ret;
+	evt.type = NCT_EVT_DC_RX_DATA_END;
+	(void)nct_input(&evt);
+
+	return ret;
+}
+
 /* Handle MQTT events. */
-static void nct_mqtt_evt_handler(struct mqtt_client *const mqtt_client,
-				 const struct mqtt_evt *_mqtt_evt)
+NCT_STATIC void nct_mqtt_evt_handler(struct mqtt_client *const mqtt_client,
+				     const struct mqtt_evt *_mqtt_evt)
 {
 	int err;
 	struct nct_evt evt = { .status = _mqtt_evt->result };
@@ -887,6 +983,18 @@ static void nct_mqtt_evt_handler(struct mqtt_client *const mqtt_client,
 			nct_save_session_state(0);
 		}
 
+		if (IS_ENABLED(CONFIG_NRF_CLOUD_MQTT_OUTBOX) && (_mqtt_evt->result == 0)) {
+			/* Resend publications that were not acknowledged before
+			 * the previous connection was lost.
+			 */
+			err = nrf_cloud_outbox_retransmit(mqtt_client);
+			if (err < 0) {
+				LOG_ERR("nrf_cloud_outbox_retransmit: failed %d", err);
+			} else if (err > 0) {
+				LOG_DBG("Retransmitted %d messages", err);
+			}
+		}
+
 		evt.type = NCT_EVT_CONNECTED;
 		event_notify = true;
 		break;
@@ -898,11 +1006,20 @@ static void nct_mqtt_evt_handler(struct mqtt_client *const mqtt_client,
 			p->message_id,
 			p->message.payload.len);
 
-		int err = publish_get_payload(mqtt_client,
-					      p->message.payload.len);
+		bool cc_rx = control_channel_topic_match(NCT_RX_LIST, &p->message.topic,
+							 &cc.opcode);
+		bool stream = !cc_rx && publish_stream_required(p->message.payload.len);
+		int err;
+
+		if (stream) {
+			err = publish_stream_payload(mqtt_client, p);
+		} else {
+			err = publish_get_payload(mqtt_client, p->message.payload.len);
+		}
 
 		if (err < 0) {
-			LOG_ERR("publish_get_payload: failed %d", err);
+			LOG_ERR("%s: failed %d",
+				stream ? "publish_stream_payload" : "publish_get_payload", err);
 			nrf_cloud_disconnect();
 			event_notify = false;
 			break;
@@ -911,8 +1028,7 @@ static void nct_mqtt_evt_handler(struct mqtt_client *const mqtt_client,
 		/* If the data arrives on one of the subscribed control channel
 		 * topic. Then we notify the same.
 		 */
-		if (control_channel_topic_match(NCT_RX_LIST, &p->message.topic,
-						&cc.opcode)) {
+		if (cc_rx) {
 			cc.message_id = p->message_id;
 			cc.data.ptr = nct.payload_buf;
 			cc.data.len = p->message.payload.len;
@@ -922,8 +1038,10 @@ static void nct_mqtt_evt_handler(struct mqtt_client *const mqtt_client,
 			evt.type = NCT_EVT_CC_RX_DATA;
 			evt.param.cc = &cc;
 			event_notify = true;
-		} else {
-			/* Try to match it with one of the data topics. */
+		} else if (!stream) {
+			/* Streamed data was already delivered in chunks, otherwise
+			 * try to match it with one of the data topics.
+			 */
 			dc.message_id = p->message_id;
 			dc.data.ptr = nct.payload_buf;
 			dc.data.len = p->message.payload.len;
@@ -985,6 +1103,11 @@ static void nct_mqtt_evt_handler(struct mqtt_client *const mqtt_client,
 		LOG_DBG("MQTT_EVT_PUBACK: id = %d result = %d",
 			_mqtt_evt->param.puback.message_id, _mqtt_evt->result);
 
+		if (IS_ENABLED(CONFIG_NRF_CLOUD_MQTT_OUTBOX)) {
+			/* Control channel messages are not in the outbox */
+			(void)nrf_cloud_outbox_ack(_mqtt_evt->param.puback.message_id);
+		}
+
 		evt.type = NCT_EVT_CC_TX_DATA_ACK;
 		evt.param.message_id = _mqtt_evt->param.puback.message_id;
 		event_notify = true;
@@ -1000,6 +1123,10 @@ static void nct_mqtt_evt_handler(struct mqtt_client *const mqtt_client,
 	case MQTT_EVT_DISCONNECT: {
 		LOG_DBG("MQTT_EVT_DISCONNECT: result = %d", _mqtt_evt->result);
 
+		if (IS_ENABLED(CONFIG_NRF_CLOUD_MQTT_OUTBOX_PERSIST_ON_DISCONNECT)) {
+			(void)nrf_cloud_outbox_persist();
+		}
+
 		evt.type = NCT_EVT_DISCONNECTED;
 		event_notify = true;
 		break;
@@ -1059,6 +1186,14 @@ void nct_uninit(void)
 	dc_endpoint_free();
 	nct_reset_topics();
 
+	if (IS_ENABLED(CONFIG_NRF_CLOUD_MQTT_OUTBOX)) {
+		if (IS_ENABLED(CONFIG_NRF_CLOUD_MQTT_OUTBOX_PERSIST_ON_DISCONNECT)) {
+			(void)nrf_cloud_outbox_persist();
+		}
+
+		nrf_cloud_outbox_reset();
+	}
+
 	if (client_id_buf) {
 		nrf_cloud_free(client_id_buf);
 		client_id_buf = NULL;
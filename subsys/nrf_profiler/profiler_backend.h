@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2022 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#ifndef _PROFILER_BACKEND_H_
+#define _PROFILER_BACKEND_H_
+
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/__assert.h>
+#include <zephyr/sys/byteorder.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Backends that do not rely on a host tool to fetch the data write a capture
+ * stream: the header, followed by frames holding either event descriptions or
+ * event data. The header holds the magic, the version and the frequency of the
+ * event timestamps in Hz as a 32-bit little-endian value. A frame starts with
+ * its type and the length of its content as a 16-bit little-endian value.
+ * Bytes of value 0xFF between frames are padding.
+ */
+#define NRF_PROFILER_CAPTURE_MAGIC	"NPRF"
+#define NRF_PROFILER_CAPTURE_MAGIC_LEN	(sizeof(NRF_PROFILER_CAPTURE_MAGIC) - 1)
+#define NRF_PROFILER_CAPTURE_VERSION	1
+#define NRF_PROFILER_CAPTURE_HDR_LEN	(NRF_PROFILER_CAPTURE_MAGIC_LEN + 1 + sizeof(uint32_t))
+#define NRF_PROFILER_CAPTURE_FRAME_INFO	'I'
+#define NRF_PROFILER_CAPTURE_FRAME_DATA	'D'
+#define NRF_PROFILER_CAPTURE_FRAME_HDR_LEN 3
+
+/** @brief Nordic nrf_profiler backend.
+ *
+ * All functions are called from the nrf_profiler thread.
+ */
+struct nrf_profiler_backend {
+	/** Initialize the backend. Called before any other function. Events
+	 *  logged in the meantime are kept in the nrf_profiler buffers.
+	 */
+	int (*init)(void);
+
+	/** Write event data. Either all or none of the data must be written.
+	 *  Returns false if the data was not written, in which case the data
+	 *  is written again later. Data must never be dropped after returning
+	 *  true, as the timestamp of the next event is sent as a difference
+	 *  from the timestamp of this one.
+	 */
+	bool (*data_write)(const uint8_t *data, size_t len);
+
+	/** Write event descriptions. Returns 0 or a negative error code. */
+	int (*info_write)(const char *data, size_t len);
+
+	/** Read a command from the host. Optional. Returns true if a command
+	 *  was read.
+	 */
+	bool (*command_read)(uint8_t *command);
+
+	/** Write out data buffered by the backend. Optional. */
+	void (*flush)(void);
+
+	/** Write the description of every event type once it is registered,
+	 *  instead of on request of the host.
+	 */
+	bool announce_descriptions;
+};
+
+/** Backend selected in the configuration. */
+extern const struct nrf_profiler_backend nrf_profiler_backend;
+
+/** @brief Fill in the capture stream header.
+ *
+ * @param hdr Buffer of NRF_PROFILER_CAPTURE_HDR_LEN bytes.
+ */
+static inline void nrf_profiler_capture_hdr_set(uint8_t *hdr)
+{
+	memcpy(hdr, NRF_PROFILER_CAPTURE_MAGIC, NRF_PROFILER_CAPTURE_MAGIC_LEN);
+	hdr[NRF_PROFILER_CAPTURE_MAGIC_LEN] = NRF_PROFILER_CAPTURE_VERSION;
+	sys_put_le32(sys_clock_hw_cycles_per_sec(), &hdr[NRF_PROFILER_CAPTURE_MAGIC_LEN + 1]);
+}
+
+/** @brief Fill in the header of a capture frame.
+ *
+ * @param hdr Buffer of NRF_PROFILER_CAPTURE_FRAME_HDR_LEN bytes.
+ * @param type Frame type.
+ * @param len Length of the frame content.
+ */
+static inline void nrf_profiler_capture_frame_hdr_set(uint8_t *hdr, uint8_t type, size_t len)
+{
+	__ASSERT_NO_MSG(len <= UINT16_MAX);
+
+	hdr[0] = type;
+	sys_put_le16(len, &hdr[1]);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _PROFILER_BACKEND_H_ */
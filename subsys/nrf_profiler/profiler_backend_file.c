@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2022 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include <stdio.h>
+#include <zephyr/kernel.h>
+#include "profiler_backend.h"
+
+static FILE *file;
+
+static int file_bytes_write(const uint8_t *data, size_t len)
+{
+	return (fwrite(data, 1, len, file) == len) ? 0 : -EIO;
+}
+
+static int file_frame_write(uint8_t type, const uint8_t *data, size_t len)
+{
+	uint8_t hdr[NRF_PROFILER_CAPTURE_FRAME_HDR_LEN];
+	long start = ftell(file);
+	int err;
+
+	if (start < 0) {
+		return -EIO;
+	}
+
+	nrf_profiler_capture_frame_hdr_set(hdr, type, len);
+
+	err = file_bytes_write(hdr, sizeof(hdr));
+	if (!err) {
+		err = file_bytes_write(data, len);
+	}
+
+	if (err) {
+		/* Overwrite the partly written frame with padding, so that
+		 * the next frame starts where the host expects it.
+		 */
+		long end = ftell(file);
+
+		clearerr(file);
+		(void)fseek(file, start, SEEK_SET);
+		for (long i = start; i < end; i++) {
+			(void)fputc(0xFF, file);
+		}
+		(void)fseek(file, start, SEEK_SET);
+	}
+
+	return err;
+}
+
+static int file_init(void)
+{
+	uint8_t hdr[NRF_PROFILER_CAPTURE_HDR_LEN];
+
+	file = fopen(CONFIG_NRF_PROFILER_NORDIC_BACKEND_FILE_PATH, "wb");
+	if (!file) {
+		return -EIO;
+	}
+
+	/* Without buffering, a frame that cannot be written is detected
+	 * before the next frame is written.
+	 */
+	setvbuf(file, NULL, _IONBF, 0);
+
+	nrf_profiler_capture_hdr_set(hdr);
+
+	return file_bytes_write(hdr, sizeof(hdr));
+}
+
+static bool file_data_write(const uint8_t *data, size_t len)
+{
+	/* Data that cannot be written is kept in the nrf_profiler buffers
+	 * and written again later. If the file does not accept data anymore,
+	 * newly logged events are dropped and reported as dropped events.
+	 */
+	return !file_frame_write(NRF_PROFILER_CAPTURE_FRAME_DATA, data, len);
+}
+
+static int file_info_write(const char *data, size_t len)
+{
+	return file_frame_write(NRF_PROFILER_CAPTURE_FRAME_INFO, (const uint8_t *)data, len);
+}
+
+static void file_flush(void)
+{
+	(void)fflush(file);
+}
+
+const struct nrf_profiler_backend nrf_profiler_backend = {
+	.init = file_init,
+	.data_write = file_data_write,
+	.info_write = file_info_write,
+	.flush = file_flush,
+	.announce_descriptions = true,
+};
@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) 2022 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/storage/flash_map.h>
+#include "profiler_backend.h"
+
+#define PROFILER_AREA_ID FLASH_AREA_ID(nrf_profiler)
+
+static const struct flash_area *fa;
+static uint8_t write_block_size;
+
+/* Data is collected in the buffer and written to flash in whole write blocks. */
+static uint8_t stage_buf[CONFIG_NRF_PROFILER_NORDIC_BACKEND_FLASH_BUFFER_SIZE] __aligned(4);
+static size_t stage_len;
+
+/* Offset in the partition at which the buffered data is written */
+static off_t write_offset;
+
+/* Set when the partition is full or cannot be written, which ends the capture. */
+static bool capture_ended;
+
+static int stage_write(void)
+{
+	size_t len = ROUND_UP(stage_len, write_block_size);
+	int err;
+
+	/* Padding is skipped by the host tool */
+	memset(&stage_buf[stage_len], 0xFF, len - stage_len);
+
+	err = flash_area_write(fa, write_offset, stage_buf, len);
+	if (err) {
+		capture_ended = true;
+		return err;
+	}
+
+	write_offset += len;
+	stage_len = 0;
+
+	return 0;
+}
+
+static int stage_append(const uint8_t *data, size_t len)
+{
+	while (len > 0) {
+		size_t chunk = MIN(len, sizeof(stage_buf) - stage_len);
+
+		memcpy(&stage_buf[stage_len], data, chunk);
+		stage_len += chunk;
+		data += chunk;
+		len -= chunk;
+
+		if (stage_len == sizeof(stage_buf)) {
+			int err = stage_write();
+
+			if (err) {
+				return err;
+			}
+		}
+	}
+
+	return 0;
+}
+
+static bool frame_write(uint8_t type, const uint8_t *data, size_t len)
+{
+	uint8_t hdr[NRF_PROFILER_CAPTURE_FRAME_HDR_LEN];
+	size_t end = write_offset + ROUND_UP(stage_len + sizeof(hdr) + len, write_block_size);
+
+	if (capture_ended || (end > fa->fa_size)) {
+		capture_ended = true;
+		return false;
+	}
+
+	nrf_profiler_capture_frame_hdr_set(hdr, type, len);
+
+	return !stage_append(hdr, sizeof(hdr)) && !stage_append(data, len);
+}
+
+static int flash_init(void)
+{
+	uint8_t hdr[NRF_PROFILER_CAPTURE_HDR_LEN];
+	int err;
+
+	err = flash_area_open(PROFILER_AREA_ID, &fa);
+	if (err) {
+		return err;
+	}
+
+	write_block_size = flash_area_align(fa);
+	if ((write_block_size == 0) || (sizeof(stage_buf) % write_block_size)) {
+		return -EINVAL;
+	}
+
+	err = flash_area_erase(fa, 0, fa->fa_size);
+	if (err) {
+		return err;
+	}
+
+	nrf_profiler_capture_hdr_set(hdr);
+
+	return stage_append(hdr, sizeof(hdr));
+}
+
+static bool flash_data_write(const uint8_t *data, size_t len)
+{
+	return frame_write(NRF_PROFILER_CAPTURE_FRAME_DATA, data, len);
+}
+
+static int flash_info_write(const char *data, size_t len)
+{
+	return frame_write(NRF_PROFILER_CAPTURE_FRAME_INFO, (const uint8_t *)data, len) ?
+	       0 : -ENOSPC;
+}
+
+static void flash_flush(void)
+{
+	if (!capture_ended && (stage_len > 0)) {
+		(void)stage_write();
+	}
+}
+
+const struct nrf_profiler_backend nrf_profiler_backend = {
+	.init = flash_init,
+	.data_write = flash_data_write,
+	.info_write = flash_info_write,
+	.flush = flash_flush,
+	.announce_descriptions = true,
+};
@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2022 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
+#include <zephyr/drivers/uart.h>
+#include "profiler_backend.h"
+
+static const struct device *const uart_dev = DEVICE_DT_GET(DT_CHOSEN(ncs_profiler_uart));
+
+static void uart_bytes_write(const uint8_t *data, size_t len)
+{
+	for (size_t i = 0; i < len; i++) {
+		uart_poll_out(uart_dev, data[i]);
+	}
+}
+
+static void uart_frame_write(uint8_t type, const uint8_t *data, size_t len)
+{
+	uint8_t hdr[NRF_PROFILER_CAPTURE_FRAME_HDR_LEN];
+
+	nrf_profiler_capture_frame_hdr_set(hdr, type, len);
+	uart_bytes_write(hdr, sizeof(hdr));
+	uart_bytes_write(data, len);
+}
+
+static int uart_init(void)
+{
+	uint8_t hdr[NRF_PROFILER_CAPTURE_HDR_LEN];
+
+	if (!device_is_ready(uart_dev)) {
+		return -ENODEV;
+	}
+
+	nrf_profiler_capture_hdr_set(hdr);
+	uart_bytes_write(hdr, sizeof(hdr));
+
+	return 0;
+}
+
+static bool uart_data_write(const uint8_t *data, size_t len)
+{
+	/* Polling waits until the UART accepts each byte, no data is dropped. */
+	uart_frame_write(NRF_PROFILER_CAPTURE_FRAME_DATA, data, len);
+
+	return true;
+}
+
+static int uart_info_write(const char *data, size_t len)
+{
+	uart_frame_write(NRF_PROFILER_CAPTURE_FRAME_INFO, (const uint8_t *)data, len);
+
+	return 0;
+}
+
+static bool uart_command_read(uint8_t *command)
+{
+	return (uart_poll_in(uart_dev, command) == 0);
+}
+
+const struct nrf_profiler_backend nrf_profiler_backend = {
+	.init = uart_init,
+	.data_write = uart_data_write,
+	.info_write = uart_info_write,
+	.command_read = uart_command_read,
+	.announce_descriptions = true,
+};
@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2022 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include <string.h>
+#include <zephyr/sys/util.h>
+#include "profiler_buf.h"
+
+/* The header word of a record holds its state and the length of the event
+ * data. Space that is reserved but not written yet is zeroed, so it is in the
+ * writing state.
+ */
+#define HDR_LEN_MASK		BIT_MASK(16)
+#define HDR_STATE_SHIFT		16
+#define HDR_STATE_WRITING	0
+#define HDR_STATE_COMMITTED	1
+/* Unused space at the end of the buffer, skipped by the consumer */
+#define HDR_STATE_PAD		2
+
+#define HDR(_len, _state)	(((_state) << HDR_STATE_SHIFT) | (_len))
+#define HDR_LEN(_hdr)		((_hdr) & HDR_LEN_MASK)
+#define HDR_STATE(_hdr)		((_hdr) >> HDR_STATE_SHIFT)
+
+static inline size_t record_len(size_t len)
+{
+	return ROUND_UP(sizeof(atomic_t) + len, sizeof(atomic_t));
+}
+
+static inline atomic_t *hdr_get(const struct nrf_profiler_buf *buf, uintptr_t pos)
+{
+	return (atomic_t *)&buf->data[pos & (buf->size - 1)];
+}
+
+bool nrf_profiler_buf_put(struct nrf_profiler_buf *buf, const uint8_t *data, size_t len)
+{
+	__ASSERT_NO_MSG(IS_POWER_OF_TWO(buf->size) && (buf->size <= HDR_LEN_MASK));
+	__ASSERT_NO_MSG(len <= HDR_LEN_MASK);
+
+	size_t rec_len = record_len(len);
+	uintptr_t head;
+	uintptr_t tail;
+	size_t pad;
+
+	/* Reserve the space. If the record does not fit before the end of the
+	 * buffer, the space until the end is reserved as padding in the same
+	 * step, so that every record is contiguous.
+	 */
+	do {
+		head = (uintptr_t)atomic_get(&buf->head);
+		tail = (uintptr_t)atomic_get(&buf->tail);
+
+		size_t offset = head & (buf->size - 1);
+
+		pad = (offset + rec_len > buf->size) ? (buf->size - offset) : 0;
+
+		if ((head - tail) + pad + rec_len > buf->size) {
+			atomic_inc(&buf->dropped);
+			return false;
+		}
+	} while (!atomic_cas(&buf->head, (atomic_val_t)head,
+			     (atomic_val_t)(head + pad + rec_len)));
+
+	if (pad) {
+		atomic_set(hdr_get(buf, head), HDR(pad, HDR_STATE_PAD));
+		head += pad;
+	}
+
+	memcpy((uint8_t *)hdr_get(buf, head) + sizeof(atomic_t), data, len);
+
+	/* Setting the header is a full barrier, the consumer sees the data
+	 * once it sees the record committed.
+	 */
+	atomic_set(hdr_get(buf, head), HDR(len, HDR_STATE_COMMITTED));
+
+	return true;
+}
+
+static void region_consume(struct nrf_profiler_buf *buf, uintptr_t tail, size_t len)
+{
+	/* Producers rely on free space being zeroed */
+	memset(hdr_get(buf, tail), 0, len);
+	atomic_set(&buf->tail, (atomic_val_t)(tail + len));
+}
+
+const uint8_t *nrf_profiler_buf_peek(struct nrf_profiler_buf *buf, size_t *len)
+{
+	while (true) {
+		uintptr_t tail = (uintptr_t)atomic_get(&buf->tail);
+
+		if (tail == (uintptr_t)atomic_get(&buf->head)) {
+			return NULL;
+		}
+
+		atomic_val_t hdr = atomic_get(hdr_get(buf, tail));
+
+		switch (HDR_STATE(hdr)) {
+		case HDR_STATE_COMMITTED:
+			*len = HDR_LEN(hdr);
+			return (const uint8_t *)hdr_get(buf, tail) + sizeof(atomic_t);
+
+		case HDR_STATE_PAD:
+			region_consume(buf, tail, HDR_LEN(hdr));
+			break;
+
+		default:
+			/* The oldest record is still being written. */
+			return NULL;
+		}
+	}
+}
+
+void nrf_profiler_buf_consume(struct nrf_profiler_buf *buf)
+{
+	uintptr_t tail = (uintptr_t)atomic_get(&buf->tail);
+	atomic_val_t hdr = atomic_get(hdr_get(buf, tail));
+
+	__ASSERT_NO_MSG(HDR_STATE(hdr) == HDR_STATE_COMMITTED);
+
+	region_consume(buf, tail, record_len(HDR_LEN(hdr)));
+}
+
+uint32_t nrf_profiler_buf_dropped_get(struct nrf_profiler_buf *buf)
+{
+	return (uint32_t)atomic_clear(&buf->dropped);
+}
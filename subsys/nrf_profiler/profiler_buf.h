@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2022 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#ifndef _PROFILER_BUF_H_
+#define _PROFILER_BUF_H_
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief Lock-free ring buffer for events.
+ *
+ * Any number of contexts can add events to the buffer, but only one context
+ * can read them. Every event is stored contiguously, after a header word that
+ * tells if the event is still being written.
+ */
+struct nrf_profiler_buf {
+	/** Buffer memory, aligned to the size of atomic_t. */
+	uint8_t *data;
+	/** Size of the buffer, a power of two. */
+	size_t size;
+	/** Position up to which space is reserved by producers. */
+	atomic_t head;
+	/** Position up to which events are consumed. */
+	atomic_t tail;
+	/** Number of events dropped because the buffer was full. */
+	atomic_t dropped;
+};
+
+/** @brief Static initializer of a buffer.
+ *
+ * @param _data Array used as buffer memory. The size of the array must be a
+ *		power of two, and the array must be aligned to the size of
+ *		atomic_t.
+ */
+#define NRF_PROFILER_BUF_INITIALIZER(_data) \
+	{					\
+		.data = _data,			\
+		.size = sizeof(_data),		\
+	}
+
+/** @brief Add an event to the buffer.
+ *
+ * Safe to call from any context, including interrupts that preempt another
+ * call to this function.
+ *
+ * @param buf Buffer.
+ * @param data Event data.
+ * @param len Length of the event data.
+ *
+ * @retval true If the event was added.
+ * @retval false If the buffer was full. The event is counted as dropped.
+ */
+bool nrf_profiler_buf_put(struct nrf_profiler_buf *buf, const uint8_t *data, size_t len);
+
+/** @brief Get the oldest event in the buffer, without removing it.
+ *
+ * @param buf Buffer.
+ * @param len Length of the event data.
+ *
+ * @return Pointer to the event data, or NULL if the buffer is empty or the
+ *	   oldest event is still being written.
+ */
+const uint8_t *nrf_profiler_buf_peek(struct nrf_profiler_buf *buf, size_t *len);
+
+/** @brief Remove the event returned by @ref nrf_profiler_buf_peek from the buffer.
+ *
+ * @param buf Buffer.
+ */
+void nrf_profiler_buf_consume(struct nrf_profiler_buf *buf);
+
+/** @brief Get and reset the number of dropped events.
+ *
+ * @param buf Buffer.
+ *
+ * @return Number of events dropped since the previous call.
+ */
+uint32_t nrf_profiler_buf_dropped_get(struct nrf_profiler_buf *buf);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _PROFILER_BUF_H_ */
@@ -9,10 +9,18 @@
 #include <zephyr/sys/util.h>
 #include <zephyr/sys/byteorder.h>
 #include <zephyr/kernel.h>
-#include <SEGGER_RTT.h>
 #include <nrf_profiler.h>
 #include <string.h>
+#include "profiler_buf.h"
+#include "profiler_backend.h"
+
+#if defined(CONFIG_ARCH_POSIX)
+/* The host file backend runs on native_posix, which has no nrfx */
+#define MEMORY_BARRIER() __sync_synchronize()
+#else
 #include <nrfx.h>
+#define MEMORY_BARRIER() __DMB()
+#endif
 
 
 enum state {
@@ -25,10 +33,45 @@ enum state {
 /* By default, when there is no shell, all events are profiled. */
 struct nrf_profiler_event_enabled_bm _nrf_profiler_event_enabled_bm;
 
+/* Events are buffered per context, so that the event being logged by an
+ * interrupt does not wait for the event being logged by the code it preempted.
+ */
+enum context {
+	CONTEXT_THREAD,
+	CONTEXT_ISR,
+	CONTEXT_COUNT
+};
+
+/* Version of the format of the data sent to the host. It is announced in the
+ * first line of the event descriptions.
+ */
+#define FORMAT_VERSION 2
+
+/* Events are stored in the buffers with the event type ID and the timestamp
+ * at fixed width, followed by the encoded data.
+ */
+#define EVENT_ID_LEN		sizeof(uint16_t)
+#define EVENT_TIMESTAMP_LEN	sizeof(uint32_t)
+#define EVENT_HDR_LEN		(EVENT_ID_LEN + EVENT_TIMESTAMP_LEN)
+
+/* Maximum length of a 32-bit and a 64-bit LEB128 value */
+#define VARINT32_MAX_LEN	5
+#define VARINT64_MAX_LEN	10
+
+/* Events are sent to the host as the event type ID plus one and the zigzag
+ * encoded difference from the timestamp of the previous event, as LEB128
+ * values, followed by the encoded data. A synchronization record, made of
+ * a zero byte and the full 64-bit timestamp, precedes an event from time to
+ * time, so that timestamps can be recovered without decoding all events.
+ */
+#define WIRE_SYNC		0
+#define WIRE_SYNC_LEN		(1 + sizeof(uint64_t))
+#define WIRE_RECORD_MAX_LEN	(WIRE_SYNC_LEN + VARINT32_MAX_LEN + VARINT64_MAX_LEN + \
+				 CONFIG_NRF_PROFILER_CUSTOM_EVENT_BUF_LEN - EVENT_HDR_LEN)
+
 static K_SEM_DEFINE(nrf_profiler_sem, 0, 1);
 static atomic_t nrf_profiler_state;
-static uint16_t fatal_error_event_id;
-static struct k_spinlock lock;
+static uint16_t dropped_events_event_id;
 
 enum nordic_command {
 	NORDIC_COMMAND_START	= 1,
@@ -46,14 +89,43 @@ static char *arg_types_encodings[] = {
 					"u32", /* uint32_t */
 					"s32", /* int32_t */
 					"s",   /* string */
-					"t"    /* time */
+					"t",   /* time */
+					"a"    /* memory address */
 				     };
 
-uint8_t nrf_profiler_num_events;
+uint16_t nrf_profiler_num_events;
 
-static uint8_t buffer_data[CONFIG_NRF_PROFILER_NORDIC_DATA_BUFFER_SIZE];
-static uint8_t buffer_info[CONFIG_NRF_PROFILER_NORDIC_INFO_BUFFER_SIZE];
-static uint8_t buffer_commands[CONFIG_NRF_PROFILER_NORDIC_COMMAND_BUFFER_SIZE];
+BUILD_ASSERT(IS_POWER_OF_TWO(CONFIG_NRF_PROFILER_NORDIC_THREAD_BUFFER_SIZE),
+	     "Thread buffer size must be a power of two");
+BUILD_ASSERT(IS_POWER_OF_TWO(CONFIG_NRF_PROFILER_NORDIC_ISR_BUFFER_SIZE),
+	     "ISR buffer size must be a power of two");
+
+static uint8_t thread_buf_data[CONFIG_NRF_PROFILER_NORDIC_THREAD_BUFFER_SIZE]
+	__aligned(sizeof(atomic_t));
+static uint8_t isr_buf_data[CONFIG_NRF_PROFILER_NORDIC_ISR_BUFFER_SIZE]
+	__aligned(sizeof(atomic_t));
+
+static struct nrf_profiler_buf bufs[CONTEXT_COUNT] = {
+	[CONTEXT_THREAD] = NRF_PROFILER_BUF_INITIALIZER(thread_buf_data),
+	[CONTEXT_ISR] = NRF_PROFILER_BUF_INITIALIZER(isr_buf_data),
+};
+
+static const struct nrf_profiler_backend *const backend = &nrf_profiler_backend;
+
+/* Number of event descriptions announced by the backend */
+static uint16_t announced_num_events;
+static bool format_announced;
+
+/* The 32-bit event timestamps are extended to 64 bits by the nrf_profiler
+ * thread, which reads the cycle counter more often than it wraps.
+ */
+static uint64_t clock64;
+static uint32_t clock32;
+
+/* Timestamps of the last event and of the last synchronization record sent */
+static uint64_t last_timestamp;
+static uint64_t last_sync_timestamp;
+static bool sync_needed = true;
 
 static k_tid_t protocol_thread_id;
 
@@ -61,35 +133,40 @@ static K_THREAD_STACK_DEFINE(nrf_profiler_nordic_stack,
 			     CONFIG_NRF_PROFILER_NORDIC_STACK_SIZE);
 static struct k_thread nrf_profiler_nordic_thread;
 
-static int send_info_data(const char *data, size_t data_len)
+static size_t varint_put(uint8_t *dst, uint64_t value)
 {
-	uint8_t retry_cnt = 0;
-	static const uint8_t retry_cnt_max = 100;
-
-	size_t num_bytes_send;
-
-	num_bytes_send = SEGGER_RTT_WriteNoLock(
-				  CONFIG_NRF_PROFILER_NORDIC_RTT_CHANNEL_INFO,
-				  data, data_len);
-
-	while (num_bytes_send != data_len) {
-		/* Give host time to read the data and free some space
-		 * in the buffer. */
-		k_sleep(K_MSEC(100));
-		num_bytes_send = SEGGER_RTT_WriteNoLock(
-				  CONFIG_NRF_PROFILER_NORDIC_RTT_CHANNEL_INFO,
-				  data, data_len);
-
-		/* Avoid being blocked in while loop if host does not read
-		 * the RTT data.
-		 */
-		retry_cnt++;
-		if (retry_cnt > retry_cnt_max) {
-			return -ENOBUFS;
-		}
+	size_t len = 0;
+
+	while (value >= 0x80) {
+		dst[len++] = (uint8_t)value | 0x80;
+		value >>= 7;
 	}
+	dst[len++] = (uint8_t)value;
 
-	return 0;
+	return len;
+}
+
+static size_t varint_len(uint64_t value)
+{
+	size_t len = 1;
+
+	while (value >= 0x80) {
+		len++;
+		value >>= 7;
+	}
+
+	return len;
+}
+
+static inline uint64_t zigzag_encode(int64_t value)
+{
+	return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+}
+
+static int format_description_get(char *str, size_t size)
+{
+	return snprintf(str, size, "#nrf_profiler,%d,%d\n", FORMAT_VERSION,
+			sys_clock_hw_cycles_per_sec());
 }
 
 static void send_system_description(void)
@@ -97,49 +174,228 @@ static void send_system_description(void)
 	/* Memory barrier to make sure that data is visible
 	 * before being accessed
 	 */
-	uint8_t ne = nrf_profiler_num_events;
+	uint16_t ne = nrf_profiler_num_events;
 
-	__DMB();
+	MEMORY_BARRIER();
 	char end_line = '\n';
-	int err = 0;
+	char format[32];
+	int err;
+
+	err = backend->info_write(format, format_description_get(format, sizeof(format)));
 
 	for (size_t t = 0; ((t < ne) && !err); t++) {
-		err = send_info_data(descr[t], strlen(descr[t]));
+		err = backend->info_write(descr[t], strlen(descr[t]));
 		if (!err) {
-			err = send_info_data(&end_line, 1);
+			err = backend->info_write(&end_line, 1);
 		}
 	}
 	if (!err) {
-		(void)send_info_data(&end_line, 1);
+		(void)backend->info_write(&end_line, 1);
+	}
+}
+
+static void send_new_descriptions(void)
+{
+	uint16_t ne = nrf_profiler_num_events;
+
+	MEMORY_BARRIER();
+
+	if (!format_announced) {
+		char format[32];
+
+		if (backend->info_write(format, format_description_get(format, sizeof(format)))) {
+			return;
+		}
+		format_announced = true;
+	}
+
+	while (announced_num_events < ne) {
+		const char *d = descr[announced_num_events];
+		char line[CONFIG_NRF_PROFILER_MAX_LENGTH_OF_CUSTOM_EVENTS_DESCRIPTIONS + 1];
+		size_t len = strlen(d);
+
+		memcpy(line, d, len);
+		line[len++] = '\n';
+
+		if (backend->info_write(line, len)) {
+			break;
+		}
+		announced_num_events++;
+	}
+}
+
+static bool timestamp_before(const uint8_t *ev1, const uint8_t *ev2)
+{
+	uint32_t t1 = sys_get_le32(&ev1[EVENT_ID_LEN]);
+	uint32_t t2 = sys_get_le32(&ev2[EVENT_ID_LEN]);
+
+	return ((int32_t)(t1 - t2) < 0);
+}
+
+static void clock_update(void)
+{
+	uint32_t now = k_cycle_get_32();
+
+	clock64 += (uint32_t)(now - clock32);
+	clock32 = now;
+}
+
+static uint64_t timestamp_extend(uint32_t timestamp)
+{
+	/* Events may be logged after the clock was updated, so the difference
+	 * is signed.
+	 */
+	return clock64 + (int32_t)(timestamp - clock32);
+}
+
+/* Encode a buffered event and pass it to the backend. */
+static bool event_write(const uint8_t *ev, size_t len)
+{
+	static uint8_t out[WIRE_RECORD_MAX_LEN];
+	const uint64_t sync_interval =
+		(uint64_t)sys_clock_hw_cycles_per_sec() *
+		CONFIG_NRF_PROFILER_NORDIC_SYNC_INTERVAL / MSEC_PER_SEC;
+	uint64_t timestamp = timestamp_extend(sys_get_le32(&ev[EVENT_ID_LEN]));
+	uint64_t prev_timestamp = last_timestamp;
+	bool sync = sync_needed || (timestamp - last_sync_timestamp >= sync_interval);
+	size_t pos = 0;
+
+	__ASSERT_NO_MSG(len >= EVENT_HDR_LEN);
+
+	if (sync) {
+		out[pos++] = WIRE_SYNC;
+		sys_put_le64(timestamp, &out[pos]);
+		pos += sizeof(uint64_t);
+		prev_timestamp = timestamp;
+	}
+
+	pos += varint_put(&out[pos], (uint32_t)sys_get_le16(ev) + 1);
+	pos += varint_put(&out[pos], zigzag_encode((int64_t)(timestamp - prev_timestamp)));
+	memcpy(&out[pos], &ev[EVENT_HDR_LEN], len - EVENT_HDR_LEN);
+	pos += len - EVENT_HDR_LEN;
+
+	if (!backend->data_write(out, pos)) {
+		return false;
+	}
+
+	last_timestamp = timestamp;
+	if (sync) {
+		last_sync_timestamp = timestamp;
+		sync_needed = false;
+	}
+
+	return true;
+}
+
+static void report_dropped_events(void)
+{
+	struct log_event_buf buf;
+	uint32_t dropped = 0;
+
+	for (size_t i = 0; i < ARRAY_SIZE(bufs); i++) {
+		dropped += nrf_profiler_buf_dropped_get(&bufs[i]);
+	}
+
+	if (dropped == 0) {
+		return;
+	}
+
+	nrf_profiler_log_start(&buf);
+	nrf_profiler_log_encode_uint32(&buf, dropped);
+	sys_put_le16(dropped_events_event_id, buf.payload_start);
+
+	if (!event_write(buf.payload_start, buf.payload - buf.payload_start)) {
+		/* Report the events with the next drops. */
+		atomic_add(&bufs[CONTEXT_THREAD].dropped, dropped);
+	}
+}
+
+/* Pass the buffered events to the backend, in the order they were logged. */
+static void drain_events(void)
+{
+	bool written = false;
+
+	clock_update();
+
+	while (true) {
+		struct nrf_profiler_buf *next_buf = NULL;
+		const uint8_t *next_ev = NULL;
+		size_t next_len = 0;
+
+		for (size_t i = 0; i < ARRAY_SIZE(bufs); i++) {
+			size_t len;
+			const uint8_t *ev = nrf_profiler_buf_peek(&bufs[i], &len);
+
+			if (ev && (!next_ev || timestamp_before(ev, next_ev))) {
+				next_buf = &bufs[i];
+				next_ev = ev;
+				next_len = len;
+			}
+		}
+
+		if (!next_ev || !event_write(next_ev, next_len)) {
+			/* Events that do not fit in the backend are kept */
+			break;
+		}
+
+		nrf_profiler_buf_consume(next_buf);
+		written = true;
+	}
+
+	report_dropped_events();
+
+	if (written && backend->flush) {
+		backend->flush();
+	}
+}
+
+static void handle_command(uint8_t command)
+{
+	switch ((enum nordic_command)command) {
+	case NORDIC_COMMAND_START:
+		if (atomic_cas(&nrf_profiler_state, STATE_INACTIVE, STATE_ACTIVE)) {
+			sync_needed = true;
+		}
+		break;
+	case NORDIC_COMMAND_STOP:
+		atomic_cas(&nrf_profiler_state, STATE_ACTIVE, STATE_INACTIVE);
+		break;
+	case NORDIC_COMMAND_INFO:
+		send_system_description();
+		break;
+	default:
+		__ASSERT_NO_MSG(false);
+		break;
 	}
 }
 
 static void nrf_profiler_nordic_thread_fn(void)
 {
+	int err = backend->init();
+
+	if (err) {
+		__ASSERT(false, "Profiler backend initialization failed (err %d)", err);
+		atomic_set(&nrf_profiler_state, STATE_TERMINATED);
+	}
+
 	while (atomic_get(&nrf_profiler_state) != STATE_TERMINATED) {
-		uint8_t read_data;
-		enum nordic_command command;
-
-		if (SEGGER_RTT_Read(
-		     CONFIG_NRF_PROFILER_NORDIC_RTT_CHANNEL_COMMANDS,
-		     &read_data, sizeof(read_data))) {
-			command = (enum nordic_command)read_data;
-			switch (command) {
-			case NORDIC_COMMAND_START:
-				atomic_cas(&nrf_profiler_state, STATE_INACTIVE, STATE_ACTIVE);
-				break;
-			case NORDIC_COMMAND_STOP:
-				atomic_cas(&nrf_profiler_state, STATE_ACTIVE, STATE_INACTIVE);
-				break;
-			case NORDIC_COMMAND_INFO:
-				send_system_description();
-				break;
-			default:
-				__ASSERT_NO_MSG(false);
-				break;
-			}
+		uint8_t command;
+
+		if (backend->command_read && backend->command_read(&command)) {
+			handle_command(command);
+		}
+		if (backend->announce_descriptions) {
+			send_new_descriptions();
 		}
-		k_sleep(K_MSEC(500));
+		drain_events();
+		k_sleep(K_MSEC(CONFIG_NRF_PROFILER_NORDIC_DRAIN_INTERVAL));
+	}
+
+	if (!err) {
+		if (backend->announce_descriptions) {
+			send_new_descriptions();
+		}
+		drain_events();
 	}
 	k_sem_give(&nrf_profiler_sem);
 }
@@ -160,36 +416,13 @@ int nrf_profiler_init(void)
 		}
 	}
 
+	clock32 = k_cycle_get_32();
+	clock64 = clock32;
+
 	if (IS_ENABLED(CONFIG_NRF_PROFILER_NORDIC_START_LOGGING_ON_SYSTEM_START)) {
 		atomic_cas(&nrf_profiler_state, STATE_INACTIVE, STATE_ACTIVE);
 	}
 
-	int ret;
-
-	ret = SEGGER_RTT_ConfigUpBuffer(
-		CONFIG_NRF_PROFILER_NORDIC_RTT_CHANNEL_DATA,
-		"Nordic nrf_profiler data",
-		buffer_data,
-		CONFIG_NRF_PROFILER_NORDIC_DATA_BUFFER_SIZE,
-		SEGGER_RTT_MODE_NO_BLOCK_SKIP);
-	__ASSERT_NO_MSG(ret >= 0);
-
-	ret = SEGGER_RTT_ConfigUpBuffer(
-		CONFIG_NRF_PROFILER_NORDIC_RTT_CHANNEL_INFO,
-		"Nordic nrf_profiler info",
-		buffer_info,
-		CONFIG_NRF_PROFILER_NORDIC_INFO_BUFFER_SIZE,
-		SEGGER_RTT_MODE_NO_BLOCK_SKIP);
-	__ASSERT_NO_MSG(ret >= 0);
-
-	ret = SEGGER_RTT_ConfigDownBuffer(
-		CONFIG_NRF_PROFILER_NORDIC_RTT_CHANNEL_COMMANDS,
-		"Nordic nrf_profiler command",
-		buffer_commands,
-		CONFIG_NRF_PROFILER_NORDIC_COMMAND_BUFFER_SIZE,
-		SEGGER_RTT_MODE_NO_BLOCK_SKIP);
-	__ASSERT_NO_MSG(ret >= 0);
-
 	protocol_thread_id =  k_thread_create(&nrf_profiler_nordic_thread,
 			nrf_profiler_nordic_stack,
 			K_THREAD_STACK_SIZEOF(nrf_profiler_nordic_stack),
@@ -197,9 +430,13 @@ int nrf_profiler_init(void)
 			NULL, NULL, NULL,
 			CONFIG_NRF_PROFILER_NORDIC_THREAD_PRIORITY, 0, K_NO_WAIT);
 
-	/* Registering fatal error event */
-	fatal_error_event_id = nrf_profiler_register_event_type("_nrf_profiler_fatal_error_event_",
-							    NULL, NULL, 0);
+	/* Registering the event that reports the number of dropped events */
+	static const char * const dropped_names[] = {"count"};
+	static const enum nrf_profiler_arg dropped_types[] = {NRF_PROFILER_ARG_U32};
+
+	dropped_events_event_id = nrf_profiler_register_event_type("_nrf_profiler_dropped_events_",
+								   dropped_names, dropped_types,
+								   ARRAY_SIZE(dropped_types));
 
 	k_sched_unlock();
 	return 0;
@@ -229,7 +466,7 @@ uint16_t nrf_profiler_register_event_type(const char *name, const char * const *
 	 * from multiple threads
 	 */
 	k_sched_lock();
-	uint8_t ne = nrf_profiler_num_events;
+	uint16_t ne = nrf_profiler_num_events;
 
 	__ASSERT_NO_MSG(ne + 1 <= NRF_PROFILER_MAX_NUMBER_OF_APPLICATION_AND_INTERNAL_EVENTS);
 	size_t temp = snprintf(descr[ne],
@@ -262,7 +499,7 @@ uint16_t nrf_profiler_register_event_type(const char *name, const char * const *
 	/* Memory barrier to make sure that data is visible
 	 * before being accessed
 	 */
-	__DMB();
+	MEMORY_BARRIER();
 	nrf_profiler_num_events++;
 	k_sched_unlock();
 
@@ -271,35 +508,37 @@ uint16_t nrf_profiler_register_event_type(const char *name, const char * const *
 
 void nrf_profiler_log_start(struct log_event_buf *buf)
 {
-	/* Adding one to pointer to make space for event type ID */
-	buf->payload = buf->payload_start + sizeof(uint8_t);
-	nrf_profiler_log_encode_uint32(buf, k_cycle_get_32());
+	/* Leaving space for the event type ID, followed by the timestamp */
+	buf->payload = buf->payload_start + EVENT_ID_LEN;
+	sys_put_le32(k_cycle_get_32(), buf->payload);
+	buf->payload += EVENT_TIMESTAMP_LEN;
 }
 
-void nrf_profiler_log_encode_uint32(struct log_event_buf *buf, uint32_t data)
+static void log_encode_varint(struct log_event_buf *buf, uint32_t data)
 {
-	__ASSERT_NO_MSG(buf->payload - buf->payload_start + sizeof(data)
+	__ASSERT_NO_MSG(buf->payload - buf->payload_start + varint_len(data)
 			 <= CONFIG_NRF_PROFILER_CUSTOM_EVENT_BUF_LEN);
-	sys_put_le32(data, buf->payload);
-	buf->payload += sizeof(data);
+	buf->payload += varint_put(buf->payload, data);
+}
+
+void nrf_profiler_log_encode_uint32(struct log_event_buf *buf, uint32_t data)
+{
+	log_encode_varint(buf, data);
 }
 
 void nrf_profiler_log_encode_int32(struct log_event_buf *buf, int32_t data)
 {
-	nrf_profiler_log_encode_uint32(buf, (uint32_t)data);
+	log_encode_varint(buf, (uint32_t)zigzag_encode(data));
 }
 
 void nrf_profiler_log_encode_uint16(struct log_event_buf *buf, uint16_t data)
 {
-	__ASSERT_NO_MSG(buf->payload - buf->payload_start + sizeof(data)
-			 <= CONFIG_NRF_PROFILER_CUSTOM_EVENT_BUF_LEN);
-	sys_put_le16(data, buf->payload);
-	buf->payload += sizeof(data);
+	log_encode_varint(buf, data);
 }
 
 void nrf_profiler_log_encode_int16(struct log_event_buf *buf, int16_t data)
 {
-	nrf_profiler_log_encode_uint16(buf, (uint16_t)data);
+	log_encode_varint(buf, (uint32_t)zigzag_encode(data));
 }
 
 void nrf_profiler_log_encode_uint8(struct log_event_buf *buf, uint8_t data)
@@ -322,13 +561,12 @@ void nrf_profiler_log_encode_string(struct log_event_buf *buf, const char *strin
 	if (string_len > UINT8_MAX) {
 		string_len = UINT8_MAX;
 	}
-	/* First byte that is send denotes string length.
+	/* String length is sent first.
 	 * Null character is not being sent.
 	 */
-	__ASSERT_NO_MSG(buf->payload - buf->payload_start + sizeof(uint8_t) + string_len
+	log_encode_varint(buf, string_len);
+	__ASSERT_NO_MSG(buf->payload - buf->payload_start + string_len
 			 <= CONFIG_NRF_PROFILER_CUSTOM_EVENT_BUF_LEN);
-	*(buf->payload) = (uint8_t) string_len;
-	buf->payload++;
 
 	memcpy(buf->payload, string, string_len);
 	buf->payload += string_len;
@@ -337,46 +575,24 @@ void nrf_profiler_log_encode_string(struct log_event_buf *buf, const char *strin
 void nrf_profiler_log_add_mem_address(struct log_event_buf *buf,
 				  const void *mem_address)
 {
-	nrf_profiler_log_encode_uint32(buf, (uint32_t)mem_address);
-}
-
-static bool nrf_profiler_RTT_send(struct log_event_buf *buf, uint8_t type_id)
-{
-	buf->payload_start[0] = type_id;
-	size_t data_len = buf->payload - buf->payload_start;
-
-	size_t num_bytes_send = SEGGER_RTT_WriteNoLock(
-			CONFIG_NRF_PROFILER_NORDIC_RTT_CHANNEL_DATA,
-			buf->payload_start, data_len);
-	return (num_bytes_send == data_len);
-}
-
-static void nrf_profiler_fatal_error(void)
-{
-	struct log_event_buf buf;
-
-	nrf_profiler_log_start(&buf);
-	while (true) {
-		/* Sending Fatal Error event */
-		if (nrf_profiler_RTT_send(&buf, (uint8_t)fatal_error_event_id)) {
-			break;
-		}
-	}
-	k_oops();
+	/* Addresses do not benefit from variable length encoding. */
+	__ASSERT_NO_MSG(buf->payload - buf->payload_start + sizeof(uint32_t)
+			 <= CONFIG_NRF_PROFILER_CUSTOM_EVENT_BUF_LEN);
+	sys_put_le32((uint32_t)mem_address, buf->payload);
+	buf->payload += sizeof(uint32_t);
 }
 
 void nrf_profiler_log_send(struct log_event_buf *buf, uint16_t event_type_id)
 {
-	__ASSERT_NO_MSG(event_type_id <= UINT8_MAX);
+	__ASSERT_NO_MSG(event_type_id < NRF_PROFILER_MAX_NUMBER_OF_APPLICATION_AND_INTERNAL_EVENTS);
 
 	if (atomic_get(&nrf_profiler_state) == STATE_ACTIVE) {
-		uint8_t type_id = event_type_id & UINT8_MAX;
+		enum context ctx = k_is_in_isr() ? CONTEXT_ISR : CONTEXT_THREAD;
 
-		k_spinlock_key_t key = k_spin_lock(&lock);
+		sys_put_le16(event_type_id, buf->payload_start);
 
-		if (!nrf_profiler_RTT_send(buf, type_id)) {
-			nrf_profiler_fatal_error();
-		}
-		k_spin_unlock(&lock, key);
+		/* Dropped events are counted and reported by the nrf_profiler thread. */
+		(void)nrf_profiler_buf_put(&bufs[ctx], buf->payload_start,
+					   buf->payload - buf->payload_start);
 	}
 }
@@ -0,0 +1,494 @@
+/*
+ * Copyright (c) 2022 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include <ztest.h>
+#include <string.h>
+
+#include "osal_ops.h"
+#include "hal_api.h"
+#include "fmac_rx.h"
+#include "fmac_util.h"
+
+#define RX_NUM_BUFS 8
+#define RX_BUF_SIZE 256
+
+/* RX buffers mapped to the RPU and buffers held by the network stack */
+#define NBUF_COUNT (2 * RX_NUM_BUFS)
+#define NBUF_DATA_SIZE (RX_BUF_SIZE + RX_BUF_HEADROOM)
+
+#define FRAME_LEN 100
+#define MAC_HDR_LEN 24
+
+struct test_nbuf {
+	bool used;
+	unsigned int offset;
+	unsigned int len;
+	unsigned char data[NBUF_DATA_SIZE];
+};
+
+static const unsigned char ap_addr[IMG_ETH_ADDR_LEN] = {0x02, 0x00, 0x00, 0x00, 0x00, 0x01};
+static const unsigned char sta_addr[IMG_ETH_ADDR_LEN] = {0x02, 0x00, 0x00, 0x00, 0x00, 0x02};
+static const unsigned char llc_snap_ip[] = {0xaa, 0xaa, 0x03, 0x00, 0x00, 0x00, 0x08, 0x00};
+
+static struct wifi_nrf_fmac_priv fpriv;
+static struct wifi_nrf_fmac_dev_ctx fmac_dev_ctx;
+static struct wifi_nrf_fmac_vif_ctx vif_ctx;
+static struct wifi_nrf_fmac_buf_map_info rx_buf_info[RX_NUM_BUFS];
+static unsigned int rx_refill_q[RX_NUM_BUFS];
+static unsigned long rx_buf_mapped[RX_NUM_BUFS];
+
+static struct test_nbuf nbufs[NBUF_COUNT];
+static bool nbuf_alloc_fail;
+/* Number of RX commands the bus fails to send */
+static unsigned int cmd_send_fail;
+/* RX commands sent before the frames of the current event are passed up */
+static unsigned int event_cmds;
+static unsigned int refill_desc[2 * RX_NUM_BUFS];
+
+static struct {
+	unsigned int allocs;
+	unsigned int frees;
+	unsigned int nbuf_allocs;
+	unsigned int nbuf_frees;
+	unsigned int buf_maps;
+	unsigned int bytes_read;
+	unsigned int cmds;
+	unsigned int frames;
+} count;
+
+/* Fake OS */
+
+static void *test_mem_alloc(size_t size)
+{
+	count.allocs++;
+
+	return k_malloc(size);
+}
+
+static void *test_mem_zalloc(size_t size)
+{
+	count.allocs++;
+
+	return k_calloc(size, sizeof(char));
+}
+
+static void test_mem_free(void *buf)
+{
+	if (buf) {
+		count.frees++;
+	}
+
+	k_free(buf);
+}
+
+static void *test_mem_cpy(void *dest, const void *src, size_t size)
+{
+	return memcpy(dest, src, size);
+}
+
+static void *test_mem_set(void *start, int val, size_t size)
+{
+	return memset(start, val, size);
+}
+
+static int test_log(const char *fmt, va_list args)
+{
+	vprintk(fmt, args);
+
+	return 0;
+}
+
+static void *test_nbuf_alloc(unsigned int size)
+{
+	zassert_true(size <= NBUF_DATA_SIZE, "RX buffer too large");
+
+	if (nbuf_alloc_fail) {
+		return NULL;
+	}
+
+	for (size_t i = 0; i < ARRAY_SIZE(nbufs); i++) {
+		if (!nbufs[i].used) {
+			memset(&nbufs[i], 0, sizeof(nbufs[i]));
+			nbufs[i].used = true;
+			count.nbuf_allocs++;
+
+			return &nbufs[i];
+		}
+	}
+
+	return NULL;
+}
+
+static void test_nbuf_free(void *nbuf)
+{
+	struct test_nbuf *nwb = nbuf;
+
+	zassert_true(nwb->used, "Frame freed twice");
+	nwb->used = false;
+	count.nbuf_frees++;
+}
+
+static unsigned int test_nbuf_data_size(void *nbuf)
+{
+	return ((struct test_nbuf *)nbuf)->len;
+}
+
+static void *test_nbuf_data_get(void *nbuf)
+{
+	struct test_nbuf *nwb = nbuf;
+
+	return &nwb->data[nwb->offset];
+}
+
+static void *test_nbuf_data_put(void *nbuf, unsigned int size)
+{
+	struct test_nbuf *nwb = nbuf;
+	void *tail = &nwb->data[nwb->offset + nwb->len];
+
+	zassert_true(nwb->offset + nwb->len + size <= NBUF_DATA_SIZE, "Put past the end");
+	nwb->len += size;
+
+	return tail;
+}
+
+static void *test_nbuf_data_push(void *nbuf, unsigned int size)
+{
+	struct test_nbuf *nwb = nbuf;
+
+	zassert_true(size <= nwb->offset, "Push past the start");
+	nwb->offset -= size;
+	nwb->len += size;
+
+	return &nwb->data[nwb->offset];
+}
+
+static void *test_nbuf_data_pull(void *nbuf, unsigned int size)
+{
+	struct test_nbuf *nwb = nbuf;
+
+	zassert_true(size <= nwb->len, "Pull past the end");
+	nwb->offset += size;
+	nwb->len -= size;
+
+	return &nwb->data[nwb->offset];
+}
+
+static const struct wifi_nrf_osal_ops test_os_ops = {
+	.mem_alloc = test_mem_alloc,
+	.mem_zalloc = test_mem_zalloc,
+	.mem_free = test_mem_free,
+	.mem_cpy = test_mem_cpy,
+	.mem_set = test_mem_set,
+
+	.log_dbg = test_log,
+	.log_info = test_log,
+	.log_err = test_log,
+
+	.nbuf_alloc = test_nbuf_alloc,
+	.nbuf_free = test_nbuf_free,
+	.nbuf_data_size = test_nbuf_data_size,
+	.nbuf_data_get = test_nbuf_data_get,
+	.nbuf_data_put = test_nbuf_data_put,
+	.nbuf_data_push = test_nbuf_data_push,
+	.nbuf_data_pull = test_nbuf_data_pull,
+};
+
+const struct wifi_nrf_osal_ops *get_os_ops(void)
+{
+	return &test_os_ops;
+}
+
+/* Fake HAL with a single RX pool. Every RX command and every frame read out
+ * of the RPU is a bus transaction.
+ */
+
+enum wifi_nrf_status wifi_nrf_hal_data_cmd_send(struct wifi_nrf_hal_dev_ctx *hal_ctx,
+						enum WIFI_NRF_HAL_MSG_TYPE cmd_type,
+						void *data_cmd,
+						unsigned int data_cmd_size,
+						unsigned int desc_id,
+						unsigned int pool_id)
+{
+	zassert_equal(cmd_type, WIFI_NRF_HAL_MSG_TYPE_CMD_DATA_RX, "Not an RX command");
+	zassert_equal(pool_id, 0, "Wrong RX pool");
+	zassert_true(count.cmds < ARRAY_SIZE(refill_desc), "Too many RX commands");
+
+	if (cmd_send_fail) {
+		cmd_send_fail--;
+		return WIFI_NRF_STATUS_FAIL;
+	}
+
+	refill_desc[count.cmds++] = desc_id;
+
+	return WIFI_NRF_STATUS_SUCCESS;
+}
+
+unsigned long wifi_nrf_hal_buf_map_rx(struct wifi_nrf_hal_dev_ctx *hal_ctx,
+				      unsigned long buf,
+				      unsigned int buf_len,
+				      unsigned int pool_id,
+				      unsigned int buf_id)
+{
+	zassert_equal(rx_buf_mapped[buf_id], 0, "RX buffer mapped twice");
+	zassert_equal(buf_len, NBUF_DATA_SIZE, "Wrong RX buffer size");
+
+	rx_buf_mapped[buf_id] = buf;
+	count.buf_maps++;
+
+	return buf;
+}
+
+unsigned long wifi_nrf_hal_buf_unmap_rx(struct wifi_nrf_hal_dev_ctx *hal_ctx,
+					unsigned int data_len,
+					unsigned int pool_id,
+					unsigned int buf_id)
+{
+	unsigned long buf = rx_buf_mapped[buf_id];
+
+	rx_buf_mapped[buf_id] = 0;
+	count.bytes_read += data_len;
+
+	return buf;
+}
+
+static void rx_frm(void *os_vif_ctx, void *frm)
+{
+	struct wifi_nrf_fmac_eth_hdr *ehdr = test_nbuf_data_get(frm);
+
+	zassert_equal(count.cmds, event_cmds, "RX buffer refilled before the frames are passed up");
+	zassert_equal(test_nbuf_data_size(frm), sizeof(*ehdr) + FRAME_LEN, "Wrong frame length");
+	zassert_mem_equal(ehdr->dst, sta_addr, IMG_ETH_ADDR_LEN, "Wrong destination");
+	zassert_mem_equal(ehdr->src, ap_addr, IMG_ETH_ADDR_LEN, "Wrong source");
+
+	count.frames++;
+
+	/* Consumed by the network stack */
+	test_nbuf_free(frm);
+}
+
+/* Helpers */
+
+/* RX event for the frames received in the given descriptors */
+static void rx_event(int rx_pkt_type, const unsigned int *desc, unsigned int num)
+{
+	unsigned char buf[sizeof(struct img_rx_buff) +
+			  RX_NUM_BUFS * sizeof(struct img_rx_buff_info)] = {0};
+	struct img_rx_buff *config = (struct img_rx_buff *)buf;
+	unsigned int pkt_len = MAC_HDR_LEN + sizeof(llc_snap_ip) + FRAME_LEN;
+
+	config->rx_pkt_type = rx_pkt_type;
+	config->wdev_id = 0;
+	config->rx_pkt_cnt = num;
+	config->mac_header_len = MAC_HDR_LEN;
+
+	for (unsigned int i = 0; i < num; i++) {
+		struct wifi_nrf_fmac_ieee80211_hdr hdr = {0};
+		unsigned char *frame = (unsigned char *)rx_buf_mapped[desc[i]] + RX_BUF_HEADROOM;
+
+		zassert_not_equal(rx_buf_mapped[desc[i]], 0, "RX buffer not mapped");
+
+		/* The RPU writes the frame after the headroom */
+		hdr.fc = WIFI_NRF_FCTL_FROMDS;
+		memcpy(hdr.addr_1, sta_addr, IMG_ETH_ADDR_LEN);
+		memcpy(hdr.addr_2, ap_addr, IMG_ETH_ADDR_LEN);
+		memcpy(hdr.addr_3, ap_addr, IMG_ETH_ADDR_LEN);
+		memcpy(frame, &hdr, MAC_HDR_LEN);
+		memcpy(&frame[MAC_HDR_LEN], llc_snap_ip, sizeof(llc_snap_ip));
+
+		config->rx_buff_info[i].descriptor_id = desc[i];
+		config->rx_buff_info[i].rx_pkt_len = pkt_len;
+		config->rx_buff_info[i].pkt_type = PKT_TYPE_MPDU;
+	}
+
+	event_cmds = count.cmds;
+
+	zassert_equal(wifi_nrf_fmac_rx_event_process(&fmac_dev_ctx, config),
+		      WIFI_NRF_STATUS_SUCCESS, "RX event failed");
+}
+
+static unsigned int frames_used(void)
+{
+	unsigned int used = 0;
+
+	for (size_t i = 0; i < ARRAY_SIZE(nbufs); i++) {
+		used += nbufs[i].used;
+	}
+
+	return used;
+}
+
+static void setup(void)
+{
+	memset(&count, 0, sizeof(count));
+	memset(nbufs, 0, sizeof(nbufs));
+	memset(rx_buf_info, 0, sizeof(rx_buf_info));
+	memset(rx_buf_mapped, 0, sizeof(rx_buf_mapped));
+	nbuf_alloc_fail = false;
+	cmd_send_fail = 0;
+
+	memset(&fpriv, 0, sizeof(fpriv));
+	fpriv.opriv = wifi_nrf_osal_init();
+	zassert_not_null(fpriv.opriv, "OSAL init failed");
+	fpriv.num_rx_bufs = RX_NUM_BUFS;
+	fpriv.rx_buf_pools[0].buf_sz = RX_BUF_SIZE;
+	fpriv.rx_buf_pools[0].num_bufs = RX_NUM_BUFS;
+	fpriv.rx_desc[1] = RX_NUM_BUFS;
+	fpriv.rx_desc[2] = RX_NUM_BUFS;
+	fpriv.callbk_fns.rx_frm_callbk_fn = rx_frm;
+
+	memset(&vif_ctx, 0, sizeof(vif_ctx));
+	vif_ctx.fmac_dev_ctx = &fmac_dev_ctx;
+	vif_ctx.if_type = IMG_IFTYPE_STATION;
+
+	memset(&fmac_dev_ctx, 0, sizeof(fmac_dev_ctx));
+	fmac_dev_ctx.fpriv = &fpriv;
+	fmac_dev_ctx.vif_ctx[0] = &vif_ctx;
+	fmac_dev_ctx.rx_buf_info = rx_buf_info;
+	fmac_dev_ctx.rx_refill_q = rx_refill_q;
+
+	/* Same as the FMAC at init, all RX buffers are mapped to the RPU */
+	for (unsigned int desc = 0; desc < RX_NUM_BUFS; desc++) {
+		zassert_equal(wifi_nrf_fmac_rx_cmd_send(&fmac_dev_ctx,
+							WIFI_NRF_FMAC_RX_CMD_TYPE_INIT,
+							desc),
+			      WIFI_NRF_STATUS_SUCCESS, "RX buffer init failed");
+	}
+
+	zassert_equal(count.nbuf_allocs, RX_NUM_BUFS, "RX buffers not allocated");
+	zassert_equal(count.cmds, RX_NUM_BUFS, "RX buffers not handed to the RPU");
+
+	count.nbuf_allocs = 0;
+	count.buf_maps = 0;
+	count.cmds = 0;
+	memset(&fmac_dev_ctx.host_stats, 0, sizeof(fmac_dev_ctx.host_stats));
+}
+
+static void teardown(void)
+{
+	for (unsigned int desc = 0; desc < RX_NUM_BUFS; desc++) {
+		zassert_equal(wifi_nrf_fmac_rx_cmd_send(&fmac_dev_ctx,
+							WIFI_NRF_FMAC_RX_CMD_TYPE_DEINIT,
+							desc),
+			      WIFI_NRF_STATUS_SUCCESS, "RX buffer deinit failed");
+	}
+
+	wifi_nrf_osal_deinit(fpriv.opriv);
+
+	zassert_equal(frames_used(), 0, "RX buffers not freed");
+	zassert_equal(count.allocs, count.frees, "Memory leak");
+}
+
+/* Tests */
+
+static void test_data_frames(void)
+{
+	const unsigned int desc[] = {0, 1, 2, 3};
+	unsigned int allocs = count.allocs;
+
+	rx_event(IMG_RX_PKT_DATA, desc, ARRAY_SIZE(desc));
+
+	zassert_equal(count.frames, ARRAY_SIZE(desc), "Frames not passed up");
+	/* One new buffer per frame passed up, refilled after the event */
+	zassert_equal(count.nbuf_allocs, ARRAY_SIZE(desc), "Allocations per frame");
+	zassert_equal(count.cmds, ARRAY_SIZE(desc), "RX buffers not refilled");
+	zassert_mem_equal(refill_desc, desc, sizeof(desc), "Wrong refill order");
+	zassert_equal(count.allocs, allocs, "Memory allocated on RX");
+	zassert_equal(fmac_dev_ctx.host_stats.total_rx_buf_allocs, ARRAY_SIZE(desc),
+		      "Wrong allocation count");
+}
+
+static void test_beacons_recycled(void)
+{
+	const unsigned int desc[] = {4, 5, 6};
+	unsigned long buf[ARRAY_SIZE(desc)];
+
+	for (size_t i = 0; i < ARRAY_SIZE(desc); i++) {
+		buf[i] = rx_buf_mapped[desc[i]];
+	}
+
+	rx_event(IMG_RX_PKT_BCN_PRB_RSP, desc, ARRAY_SIZE(desc));
+
+	/* Neither read out of the RPU nor reallocated */
+	zassert_equal(count.frames, 0, "Beacon passed up");
+	zassert_equal(count.bytes_read, 0, "Beacon read out of the RPU");
+	zassert_equal(count.nbuf_allocs, 0, "RX buffer allocated for a beacon");
+	zassert_equal(count.cmds, ARRAY_SIZE(desc), "RX buffers not refilled");
+	zassert_equal(fmac_dev_ctx.host_stats.total_rx_buf_recycled, ARRAY_SIZE(desc),
+		      "Wrong recycle count");
+
+	for (size_t i = 0; i < ARRAY_SIZE(desc); i++) {
+		zassert_equal(rx_buf_mapped[desc[i]], buf[i], "RX buffer not reused");
+	}
+}
+
+static void test_refill_deferred(void)
+{
+	const unsigned int desc[] = {0, 1, 2};
+	const unsigned int next_desc[] = {3};
+	const unsigned int refilled[] = {0, 1, 2, 3};
+
+	/* Out of memory, the frames are still passed up */
+	nbuf_alloc_fail = true;
+	rx_event(IMG_RX_PKT_DATA, desc, ARRAY_SIZE(desc));
+
+	zassert_equal(count.frames, ARRAY_SIZE(desc), "Frames not passed up");
+	zassert_equal(count.cmds, 0, "RX buffer refilled without memory");
+	zassert_equal(fmac_dev_ctx.rx_refill_cnt, ARRAY_SIZE(desc), "Refill not deferred");
+	zassert_equal(fmac_dev_ctx.host_stats.total_rx_buf_refill_deferred, 1,
+		      "Wrong deferral count");
+
+	/* Retried on the next event, oldest descriptors first */
+	nbuf_alloc_fail = false;
+	rx_event(IMG_RX_PKT_DATA, next_desc, ARRAY_SIZE(next_desc));
+
+	zassert_equal(count.frames, ARRAY_SIZE(desc) + ARRAY_SIZE(next_desc),
+		      "Frames not passed up");
+	zassert_equal(count.cmds, ARRAY_SIZE(refilled), "RX buffers not refilled");
+	zassert_mem_equal(refill_desc, refilled, sizeof(refilled), "Wrong refill order");
+	zassert_equal(fmac_dev_ctx.rx_refill_cnt, 0, "Refill still pending");
+}
+
+static void test_refill_cmd_send_failed(void)
+{
+	const unsigned int desc[] = {0, 1, 2};
+	const unsigned int next_desc[] = {3};
+	const unsigned int refilled[] = {0, 1, 2, 3};
+
+	/* The RX command for the first buffer is lost on the bus */
+	cmd_send_fail = 1;
+	rx_event(IMG_RX_PKT_DATA, desc, ARRAY_SIZE(desc));
+
+	zassert_equal(count.frames, ARRAY_SIZE(desc), "Frames not passed up");
+	zassert_equal(count.cmds, 0, "RX buffer refilled after a failed command");
+	zassert_equal(fmac_dev_ctx.rx_refill_cnt, ARRAY_SIZE(desc), "Refill not deferred");
+	zassert_false(rx_buf_info[desc[0]].mapped, "RX buffer left mapped");
+	zassert_equal(rx_buf_mapped[desc[0]], 0, "RX buffer not unmapped");
+
+	/* The same buffer is mapped again on the next event */
+	rx_event(IMG_RX_PKT_DATA, next_desc, ARRAY_SIZE(next_desc));
+
+	zassert_equal(count.cmds, ARRAY_SIZE(refilled), "RX buffers not refilled");
+	zassert_mem_equal(refill_desc, refilled, sizeof(refilled), "Wrong refill order");
+	zassert_equal(fmac_dev_ctx.rx_refill_cnt, 0, "Refill still pending");
+	zassert_equal(count.nbuf_allocs, ARRAY_SIZE(refilled), "RX buffer allocated twice");
+
+	for (size_t i = 0; i < ARRAY_SIZE(refilled); i++) {
+		zassert_true(rx_buf_info[refilled[i]].mapped, "RX buffer not mapped");
+	}
+}
+
+void test_main(void)
+{
+	ztest_test_suite(nrf700x_rx_test,
+			 ztest_unit_test_setup_teardown(test_data_frames, setup, teardown),
+			 ztest_unit_test_setup_teardown(test_beacons_recycled, setup, teardown),
+			 ztest_unit_test_setup_teardown(test_refill_deferred, setup, teardown),
+			 ztest_unit_test_setup_teardown(test_refill_cmd_send_failed, setup,
+							teardown)
+			 );
+
+	ztest_run_test_suite(nrf700x_rx_test);
+}
@@ -0,0 +1,791 @@
+/*
+ * Copyright (c) 2022 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include <ztest.h>
+#include <string.h>
+
+#include "osal_ops.h"
+#include "hal_api.h"
+#include "hal_mem.h"
+#include "fmac_api.h"
+#include "fmac_tx.h"
+#include "fmac_peer.h"
+#include "fmac_util.h"
+
+/* Same as the Zephyr driver */
+#define TX_AGGREGATION 4
+#define TX_TOKENS_PER_AC (MAX_TX_TOKENS / WIFI_NRF_FMAC_AC_MAX)
+#define TX_TOKENS_SPARE (MAX_TX_TOKENS % WIFI_NRF_FMAC_AC_MAX)
+/* Descriptors of the only busy AC, its own and the spare ones */
+#define TX_DESCS_AC (TX_TOKENS_PER_AC + TX_TOKENS_SPARE)
+
+#define NBUF_COUNT 32
+#define NBUF_DATA_SIZE 1024
+#define CMD_LOG_LEN 64
+
+#define FRAME_LEN 100
+/* IPv4 type of service of the access categories, from the user priority */
+#define TOS_BK 0x20
+#define TOS_BE 0x00
+#define TOS_VO 0xc0
+
+struct test_nbuf {
+	void *next;
+	bool used;
+	unsigned int len;
+	unsigned char data[NBUF_DATA_SIZE];
+};
+
+struct test_timer {
+	void (*callback)(unsigned long data);
+	unsigned long data;
+	bool armed;
+	unsigned long expiry_us;
+};
+
+struct test_cmd {
+	unsigned int desc;
+	unsigned int num_frames;
+	bool done;
+};
+
+static const unsigned char ap_addr[IMG_ETH_ADDR_LEN] = {0x02, 0x00, 0x00, 0x00, 0x00, 0x01};
+static const unsigned char sta_addr[IMG_ETH_ADDR_LEN] = {0x02, 0x00, 0x00, 0x00, 0x00, 0x02};
+
+static struct wifi_nrf_fmac_priv fpriv;
+static struct wifi_nrf_fmac_dev_ctx fmac_dev_ctx;
+static struct wifi_nrf_fmac_vif_ctx vif_ctx;
+static struct wifi_nrf_fmac_buf_map_info tx_buf_info[MAX_TX_TOKENS * TX_AGGREGATION];
+static unsigned long tx_buf_mapped[MAX_TX_TOKENS * TX_AGGREGATION];
+
+static struct test_nbuf nbufs[NBUF_COUNT];
+static struct test_cmd cmd_log[CMD_LOG_LEN];
+static unsigned int cmd_log_len;
+
+static struct {
+	unsigned int allocs;
+	unsigned int frees;
+	unsigned int nbuf_frees;
+	unsigned int buf_maps;
+	unsigned int cmds;
+} count;
+
+static int lock;
+static bool lock_held;
+
+static struct test_timer timers[WIFI_NRF_FMAC_AC_MAX];
+static unsigned int num_timers;
+static unsigned long now_us;
+
+/* Fake OS */
+
+static void *test_mem_alloc(size_t size)
+{
+	count.allocs++;
+
+	return k_malloc(size);
+}
+
+static void *test_mem_zalloc(size_t size)
+{
+	count.allocs++;
+
+	return k_calloc(size, sizeof(char));
+}
+
+static void test_mem_free(void *buf)
+{
+	if (buf) {
+		count.frees++;
+	}
+
+	k_free(buf);
+}
+
+static void *test_mem_cpy(void *dest, const void *src, size_t size)
+{
+	return memcpy(dest, src, size);
+}
+
+static void *test_mem_set(void *start, int val, size_t size)
+{
+	return memset(start, val, size);
+}
+
+static void *test_spinlock_alloc(void)
+{
+	return &lock;
+}
+
+static void test_spinlock_free(void *lock)
+{
+}
+
+static void test_spinlock_init(void *lock)
+{
+}
+
+static void test_spinlock_take(void *lock)
+{
+	zassert_false(lock_held, "TX lock taken twice");
+	lock_held = true;
+}
+
+static void test_spinlock_rel(void *lock)
+{
+	zassert_true(lock_held, "TX lock released but not taken");
+	lock_held = false;
+}
+
+static int test_log(const char *fmt, va_list args)
+{
+	vprintk(fmt, args);
+
+	return 0;
+}
+
+/* The wakeup client list is only used for peers in power save, which the
+ * test does not cover, so it is always empty.
+ */
+static void *test_llist_alloc(void)
+{
+	return test_mem_zalloc(sizeof(int));
+}
+
+static void test_llist_free(void *llist)
+{
+	test_mem_free(llist);
+}
+
+static void test_llist_init(void *llist)
+{
+}
+
+static void *test_llist_get_node_head(void *llist)
+{
+	return NULL;
+}
+
+static unsigned int test_llist_len(void *llist)
+{
+	return 0;
+}
+
+static void *test_timer_alloc(void)
+{
+	zassert_true(num_timers < ARRAY_SIZE(timers), "Too many timers");
+
+	return &timers[num_timers++];
+}
+
+static void test_timer_free(void *timer)
+{
+}
+
+static void test_timer_init(void *timer, void (*callback)(unsigned long), unsigned long data)
+{
+	struct test_timer *t = timer;
+
+	t->callback = callback;
+	t->data = data;
+	t->armed = false;
+}
+
+static void test_timer_schedule(void *timer, unsigned long duration)
+{
+	struct test_timer *t = timer;
+
+	/* Same as a delayed work item, a pending timer is not moved */
+	if (t->armed) {
+		return;
+	}
+
+	t->armed = true;
+	t->expiry_us = now_us + (duration * 1000);
+}
+
+static void test_timer_kill(void *timer)
+{
+	((struct test_timer *)timer)->armed = false;
+}
+
+static unsigned long test_time_get_curr_us(void)
+{
+	return now_us;
+}
+
+static unsigned int test_time_elapsed_us(unsigned long start_time_us)
+{
+	return now_us - start_time_us;
+}
+
+static void test_nbuf_free(void *nbuf)
+{
+	struct test_nbuf *nwb = nbuf;
+
+	zassert_true(nwb->used, "Frame freed twice");
+	nwb->used = false;
+	count.nbuf_frees++;
+}
+
+static unsigned int test_nbuf_data_size(void *nbuf)
+{
+	return ((struct test_nbuf *)nbuf)->len;
+}
+
+static void *test_nbuf_data_get(void *nbuf)
+{
+	return ((struct test_nbuf *)nbuf)->data;
+}
+
+static void *test_nbuf_next_get(void *nbuf)
+{
+	return ((struct test_nbuf *)nbuf)->next;
+}
+
+static void test_nbuf_next_set(void *nbuf, void *next)
+{
+	((struct test_nbuf *)nbuf)->next = next;
+}
+
+static const struct wifi_nrf_osal_ops test_os_ops = {
+	.mem_alloc = test_mem_alloc,
+	.mem_zalloc = test_mem_zalloc,
+	.mem_free = test_mem_free,
+	.mem_cpy = test_mem_cpy,
+	.mem_set = test_mem_set,
+
+	.spinlock_alloc = test_spinlock_alloc,
+	.spinlock_free = test_spinlock_free,
+	.spinlock_init = test_spinlock_init,
+	.spinlock_take = test_spinlock_take,
+	.spinlock_rel = test_spinlock_rel,
+
+	.log_dbg = test_log,
+	.log_info = test_log,
+	.log_err = test_log,
+
+	.llist_alloc = test_llist_alloc,
+	.llist_free = test_llist_free,
+	.llist_init = test_llist_init,
+	.llist_get_node_head = test_llist_get_node_head,
+	.llist_len = test_llist_len,
+
+	.nbuf_free = test_nbuf_free,
+	.nbuf_data_size = test_nbuf_data_size,
+	.nbuf_data_get = test_nbuf_data_get,
+	.nbuf_next_get = test_nbuf_next_get,
+	.nbuf_next_set = test_nbuf_next_set,
+
+	.time_get_curr_us = test_time_get_curr_us,
+	.time_elapsed_us = test_time_elapsed_us,
+
+	.timer_alloc = test_timer_alloc,
+	.timer_free = test_timer_free,
+	.timer_init = test_timer_init,
+	.timer_schedule = test_timer_schedule,
+	.timer_kill = test_timer_kill,
+};
+
+const struct wifi_nrf_osal_ops *get_os_ops(void)
+{
+	return &test_os_ops;
+}
+
+/* Fake HAL, every TX command and every mapped frame is a bus transaction */
+
+enum wifi_nrf_status wifi_nrf_hal_ctrl_cmd_send(struct wifi_nrf_hal_dev_ctx *hal_ctx,
+						void *cmd,
+						unsigned int cmd_size)
+{
+	return WIFI_NRF_STATUS_FAIL;
+}
+
+enum wifi_nrf_status wifi_nrf_hal_data_cmd_send(struct wifi_nrf_hal_dev_ctx *hal_ctx,
+						enum WIFI_NRF_HAL_MSG_TYPE cmd_type,
+						void *data_cmd,
+						unsigned int data_cmd_size,
+						unsigned int desc_id,
+						unsigned int pool_id)
+{
+	struct host_rpu_msg *umac_cmd = data_cmd;
+	struct img_tx_buff *config = (struct img_tx_buff *)umac_cmd->msg;
+
+	zassert_equal(cmd_type, WIFI_NRF_HAL_MSG_TYPE_CMD_DATA_TX, "Not a TX command");
+	zassert_true(cmd_log_len < CMD_LOG_LEN, "Too many TX commands");
+
+	cmd_log[cmd_log_len].desc = desc_id;
+	cmd_log[cmd_log_len].num_frames = config->num_tx_pkts;
+	cmd_log[cmd_log_len].done = false;
+	cmd_log_len++;
+	count.cmds++;
+
+	return WIFI_NRF_STATUS_SUCCESS;
+}
+
+unsigned long wifi_nrf_hal_buf_map_tx(struct wifi_nrf_hal_dev_ctx *hal_ctx,
+				      unsigned long buf,
+				      unsigned int buf_len,
+				      unsigned int desc_id)
+{
+	zassert_equal(tx_buf_mapped[desc_id], 0, "TX buffer mapped twice");
+
+	tx_buf_mapped[desc_id] = buf;
+	count.buf_maps++;
+
+	return buf;
+}
+
+unsigned long wifi_nrf_hal_buf_unmap_tx(struct wifi_nrf_hal_dev_ctx *hal_ctx,
+					unsigned int desc_id)
+{
+	unsigned long buf = tx_buf_mapped[desc_id];
+
+	tx_buf_mapped[desc_id] = 0;
+
+	return buf;
+}
+
+enum wifi_nrf_status hal_rpu_mem_write(struct wifi_nrf_hal_dev_ctx *hal_ctx,
+				       unsigned int rpu_mem_addr,
+				       void *host_addr,
+				       unsigned int len)
+{
+	return WIFI_NRF_STATUS_SUCCESS;
+}
+
+/* Connected to a single AP */
+int wifi_nrf_fmac_peer_get_id(struct wifi_nrf_fmac_dev_ctx *fmac_ctx,
+			      const unsigned char *mac_addr)
+{
+	if (wifi_nrf_util_is_multicast_addr(mac_addr)) {
+		return MAX_PEERS;
+	}
+
+	return 0;
+}
+
+/* Helpers */
+
+static void frame_send(unsigned char tos, unsigned int len)
+{
+	struct test_nbuf *nwb = NULL;
+	enum wifi_nrf_status status;
+
+	for (size_t i = 0; i < ARRAY_SIZE(nbufs); i++) {
+		if (!nbufs[i].used) {
+			nwb = &nbufs[i];
+			break;
+		}
+	}
+
+	zassert_not_null(nwb, "Out of frames");
+	zassert_true(len <= NBUF_DATA_SIZE, "Frame too long");
+
+	memset(nwb, 0, sizeof(*nwb));
+	nwb->used = true;
+	nwb->len = len;
+
+	/* Ethernet header and the type of service of an IPv4 header */
+	memcpy(&nwb->data[0], ap_addr, IMG_ETH_ADDR_LEN);
+	memcpy(&nwb->data[IMG_ETH_ADDR_LEN], sta_addr, IMG_ETH_ADDR_LEN);
+	nwb->data[12] = 0x08;
+	nwb->data[13] = 0x00;
+	nwb->data[14] = 0x45;
+	nwb->data[15] = tos;
+
+	status = wifi_nrf_fmac_start_xmit(&fmac_dev_ctx, 0, nwb);
+	zassert_equal(status, WIFI_NRF_STATUS_SUCCESS, "TX failed");
+}
+
+static void tx_done(unsigned int cmd)
+{
+	struct img_tx_buff_done config = {0};
+	enum wifi_nrf_status status;
+
+	zassert_true(cmd < cmd_log_len, "No such TX command");
+	zassert_false(cmd_log[cmd].done, "TX command already done");
+
+	cmd_log[cmd].done = true;
+	config.tx_desc_num = cmd_log[cmd].desc;
+
+	status = wifi_nrf_fmac_tx_done_event_process(&fmac_dev_ctx, &config);
+	zassert_equal(status, WIFI_NRF_STATUS_SUCCESS, "TX done failed");
+}
+
+/* Complete all commands, including the ones sent for pending frames */
+static void tx_done_all(void)
+{
+	for (unsigned int i = 0; i < cmd_log_len; i++) {
+		if (!cmd_log[i].done) {
+			tx_done(i);
+		}
+	}
+}
+
+/* Move time forward, running the timers that expire on the way */
+static void time_advance(unsigned int us)
+{
+	unsigned long end_us = now_us + us;
+
+	while (now_us < end_us) {
+		now_us++;
+
+		for (unsigned int i = 0; i < num_timers; i++) {
+			if (timers[i].armed && (timers[i].expiry_us <= now_us)) {
+				timers[i].armed = false;
+				timers[i].callback(timers[i].data);
+			}
+		}
+	}
+}
+
+static unsigned int frames_used(void)
+{
+	unsigned int used = 0;
+
+	for (size_t i = 0; i < ARRAY_SIZE(nbufs); i++) {
+		used += nbufs[i].used;
+	}
+
+	return used;
+}
+
+static void setup(void)
+{
+	memset(&count, 0, sizeof(count));
+	memset(nbufs, 0, sizeof(nbufs));
+	memset(tx_buf_info, 0, sizeof(tx_buf_info));
+	memset(tx_buf_mapped, 0, sizeof(tx_buf_mapped));
+	cmd_log_len = 0;
+	lock_held = false;
+	memset(timers, 0, sizeof(timers));
+	num_timers = 0;
+	now_us = 0;
+
+	memset(&fpriv, 0, sizeof(fpriv));
+	fpriv.opriv = wifi_nrf_osal_init();
+	zassert_not_null(fpriv.opriv, "OSAL init failed");
+	fpriv.num_tx_tokens = MAX_TX_TOKENS;
+	fpriv.num_tx_tokens_per_ac = TX_TOKENS_PER_AC;
+	fpriv.num_tx_tokens_spare = TX_TOKENS_SPARE;
+	fpriv.data_config.max_tx_aggregation = TX_AGGREGATION;
+
+	memset(&vif_ctx, 0, sizeof(vif_ctx));
+	vif_ctx.fmac_dev_ctx = &fmac_dev_ctx;
+	vif_ctx.if_type = IMG_IFTYPE_STATION;
+	memcpy(vif_ctx.mac_addr, sta_addr, IMG_ETH_ADDR_LEN);
+	memcpy(vif_ctx.bssid, ap_addr, IMG_ETH_ADDR_LEN);
+
+	memset(&fmac_dev_ctx, 0, sizeof(fmac_dev_ctx));
+	fmac_dev_ctx.fpriv = &fpriv;
+	fmac_dev_ctx.vif_ctx[0] = &vif_ctx;
+	fmac_dev_ctx.tx_buf_info = tx_buf_info;
+
+	zassert_equal(tx_init(&fmac_dev_ctx), WIFI_NRF_STATUS_SUCCESS, "TX init failed");
+
+	fmac_dev_ctx.tx_config.peers[0].peer_id = 0;
+	fmac_dev_ctx.tx_config.peers[0].if_idx = 0;
+	fmac_dev_ctx.tx_config.peers[0].qos_supported = 1;
+	memcpy(fmac_dev_ctx.tx_config.peers[0].ra_addr, ap_addr, IMG_ETH_ADDR_LEN);
+}
+
+static void teardown(void)
+{
+	tx_done_all();
+
+	zassert_equal(frames_used(), 0, "Frames not freed after TX done");
+
+	tx_deinit(&fmac_dev_ctx);
+	wifi_nrf_osal_deinit(fpriv.opriv);
+
+	zassert_equal(count.allocs, count.frees, "Memory leak");
+}
+
+/* The RPU is stopped with TX commands and pending frames outstanding */
+static void teardown_outstanding(void)
+{
+	tx_deinit(&fmac_dev_ctx);
+	wifi_nrf_osal_deinit(fpriv.opriv);
+
+	zassert_equal(frames_used(), 0, "Outstanding frames not freed");
+	zassert_equal(count.allocs, count.frees, "Memory leak");
+
+	for (size_t i = 0; i < ARRAY_SIZE(tx_buf_mapped); i++) {
+		zassert_equal(tx_buf_mapped[i], 0, "TX buffer left mapped");
+	}
+}
+
+/* Tests */
+
+static void test_alloc_per_frame(void)
+{
+	unsigned int allocs = count.allocs;
+
+	/* One frame per command while descriptors are free */
+	for (int i = 0; i < TX_DESCS_AC; i++) {
+		frame_send(TOS_VO, FRAME_LEN);
+	}
+
+	zassert_equal(count.cmds, TX_DESCS_AC, "Frames not sent");
+	zassert_equal(count.buf_maps, TX_DESCS_AC, "Frames not mapped");
+	/* The command buffer, freed once the command is handed to the HAL */
+	zassert_equal(count.allocs - allocs, count.cmds, "Allocation per frame");
+
+	/* Frames waiting for a descriptor are queued without allocating */
+	allocs = count.allocs;
+
+	for (int i = 0; i < TX_AGGREGATION; i++) {
+		frame_send(TOS_VO, FRAME_LEN);
+	}
+
+	zassert_equal(count.cmds, TX_DESCS_AC, "Frame sent without a descriptor");
+	zassert_equal(count.allocs, allocs, "Allocation for a pending frame");
+}
+
+static void test_pending_aggregated(void)
+{
+	unsigned int allocs;
+
+	for (int i = 0; i < TX_DESCS_AC + TX_AGGREGATION; i++) {
+		frame_send(TOS_VO, FRAME_LEN);
+	}
+
+	/* The freed descriptor carries all pending frames in one command */
+	allocs = count.allocs;
+	tx_done(0);
+
+	zassert_equal(cmd_log_len, TX_DESCS_AC + 1, "Pending frames not sent");
+	zassert_equal(cmd_log[TX_DESCS_AC].num_frames, TX_AGGREGATION,
+		      "Pending frames not aggregated");
+	zassert_equal(count.buf_maps, TX_DESCS_AC + TX_AGGREGATION, "Frames not mapped");
+	zassert_equal(count.allocs - allocs, 1, "Allocation per frame");
+	zassert_equal(fmac_dev_ctx.host_stats.total_tx_cmd_pkts[WIFI_NRF_FMAC_AC_VO],
+		      TX_DESCS_AC + TX_AGGREGATION, "Wrong frame count");
+}
+
+static void test_pending_limit(void)
+{
+	unsigned int allocs;
+
+	for (int i = 0; i < TX_DESCS_AC + CONFIG_NRF700x_MAX_TX_PENDING_QLEN; i++) {
+		frame_send(TOS_VO, FRAME_LEN);
+	}
+
+	zassert_equal(count.nbuf_frees, 0, "Frame dropped");
+
+	/* A full pending queue drops the frame, without allocating */
+	allocs = count.allocs;
+	frame_send(TOS_VO, FRAME_LEN);
+
+	zassert_equal(count.nbuf_frees, 1, "Frame not dropped");
+	zassert_equal(count.allocs, allocs, "Allocation for a dropped frame");
+}
+
+static void test_coalesce_frame_limit(void)
+{
+	unsigned int allocs = count.allocs;
+
+	for (int i = 0; i < CONFIG_NRF700X_TX_COALESCE_BE_MAX_FRAMES - 1; i++) {
+		frame_send(TOS_BE, FRAME_LEN);
+	}
+
+	zassert_equal(count.cmds, 0, "Window flushed early");
+	zassert_equal(count.allocs, allocs, "Allocation for a held frame");
+
+	/* The last frame closes the window, all frames go in one command */
+	frame_send(TOS_BE, FRAME_LEN);
+
+	zassert_equal(count.cmds, 1, "Window not flushed");
+	zassert_equal(cmd_log[0].num_frames, CONFIG_NRF700X_TX_COALESCE_BE_MAX_FRAMES,
+		      "Frames not coalesced");
+	zassert_equal(count.allocs - allocs, 1, "Allocation per frame");
+	zassert_false(timers[WIFI_NRF_FMAC_AC_BE].armed, "Timer not stopped");
+}
+
+static void test_coalesce_byte_limit(void)
+{
+	unsigned int len = CONFIG_NRF700X_TX_COALESCE_BE_MAX_BYTES / 2;
+
+	frame_send(TOS_BE, len - 1);
+	zassert_equal(count.cmds, 0, "Window flushed early");
+
+	frame_send(TOS_BE, len + 1);
+	zassert_equal(count.cmds, 1, "Window not flushed");
+	zassert_equal(cmd_log[0].num_frames, 2, "Frames not coalesced");
+}
+
+static void test_coalesce_budget(void)
+{
+	/* The timer flushes a window no frame closes */
+	frame_send(TOS_BE, FRAME_LEN);
+	time_advance(CONFIG_NRF700X_TX_COALESCE_BE_US / 2);
+	frame_send(TOS_BE, FRAME_LEN);
+	time_advance(CONFIG_NRF700X_TX_COALESCE_BE_US / 2 - 1);
+
+	zassert_equal(count.cmds, 0, "Window flushed before the budget expired");
+
+	time_advance(1);
+
+	zassert_equal(count.cmds, 1, "Window not flushed when the budget expired");
+	zassert_equal(cmd_log[0].num_frames, 2, "Frames not coalesced");
+	zassert_equal(fmac_dev_ctx.host_stats.total_tx_coalesce_timeouts[WIFI_NRF_FMAC_AC_BE], 1,
+		      "Timeout not counted");
+
+	/* A frame arriving after the budget expired closes the window, even
+	 * when the timer has not run yet.
+	 */
+	frame_send(TOS_BE, FRAME_LEN);
+	now_us += CONFIG_NRF700X_TX_COALESCE_BE_US;
+	frame_send(TOS_BE, FRAME_LEN);
+
+	zassert_equal(count.cmds, 2, "Window not flushed when the budget expired");
+	zassert_equal(cmd_log[1].num_frames, 2, "Frames not coalesced");
+	zassert_false(timers[WIFI_NRF_FMAC_AC_BE].armed, "Timer not stopped");
+	zassert_equal(fmac_dev_ctx.host_stats.total_tx_coalesce_timeouts[WIFI_NRF_FMAC_AC_BE], 1,
+		      "Timeout counted for a frame");
+}
+
+static void test_coalesce_latency(void)
+{
+	/* A single frame waits for the budget of its AC and no longer */
+	frame_send(TOS_BK, FRAME_LEN);
+
+	while (!count.cmds && (now_us < 2 * CONFIG_NRF700X_TX_COALESCE_BK_US)) {
+		time_advance(1);
+	}
+
+	zassert_equal(count.cmds, 1, "Frame not sent");
+	zassert_equal(now_us, CONFIG_NRF700X_TX_COALESCE_BK_US, "Latency budget not kept");
+}
+
+static void test_coalesce_mixed(void)
+{
+	/* Coalescing is disabled for VO, its frames go out right away and
+	 * leave the window of BE open.
+	 */
+	frame_send(TOS_BE, FRAME_LEN);
+	frame_send(TOS_VO, FRAME_LEN);
+	frame_send(TOS_VO, FRAME_LEN);
+
+	zassert_equal(count.cmds, 2, "VO frames held");
+	zassert_equal(cmd_log[0].num_frames, 1, "VO frames coalesced");
+	zassert_true(timers[WIFI_NRF_FMAC_AC_BE].armed, "BE window closed");
+
+	for (int i = 0; i < CONFIG_NRF700X_TX_COALESCE_BE_MAX_FRAMES - 1; i++) {
+		frame_send(TOS_BE, FRAME_LEN);
+	}
+
+	zassert_equal(count.cmds, 3, "BE window not flushed");
+	zassert_equal(cmd_log[2].num_frames, CONFIG_NRF700X_TX_COALESCE_BE_MAX_FRAMES,
+		      "BE frames not coalesced");
+	zassert_equal(fmac_dev_ctx.host_stats.total_tx_cmds[WIFI_NRF_FMAC_AC_VO], 2,
+		      "Wrong VO command count");
+	zassert_equal(fmac_dev_ctx.host_stats.total_tx_cmds[WIFI_NRF_FMAC_AC_BE], 1,
+		      "Wrong BE command count");
+}
+
+static void test_coalesce_stale_timeout(void)
+{
+	struct test_timer *timer = &timers[WIFI_NRF_FMAC_AC_BE];
+
+	/* The frame limit closes the first window, while the run of its timer
+	 * is already waiting for the TX lock.
+	 */
+	for (int i = 0; i < CONFIG_NRF700X_TX_COALESCE_BE_MAX_FRAMES; i++) {
+		frame_send(TOS_BE, FRAME_LEN);
+	}
+
+	zassert_equal(count.cmds, 1, "Window not flushed");
+
+	time_advance(CONFIG_NRF700X_TX_COALESCE_BE_US / 2);
+	frame_send(TOS_BE, FRAME_LEN);
+	zassert_true(timer->armed, "Timer of the next window not scheduled");
+
+	/* The late run leaves the next window open */
+	timer->callback(timer->data);
+
+	zassert_equal(count.cmds, 1, "Next window flushed by a stale timeout");
+	zassert_equal(fmac_dev_ctx.host_stats.total_tx_coalesce_stale_timeouts[WIFI_NRF_FMAC_AC_BE],
+		      1, "Stale timeout not counted");
+	zassert_equal(fmac_dev_ctx.host_stats.total_tx_coalesce_timeouts[WIFI_NRF_FMAC_AC_BE], 0,
+		      "Stale timeout counted as a timeout");
+
+	/* The next window keeps its own budget */
+	time_advance(CONFIG_NRF700X_TX_COALESCE_BE_US - 1);
+	zassert_equal(count.cmds, 1, "Window flushed before the budget expired");
+
+	time_advance(1);
+	zassert_equal(count.cmds, 2, "Window not flushed when the budget expired");
+	zassert_equal(cmd_log[1].num_frames, 1, "Wrong frame count");
+}
+
+static void test_coalesce_per_ac_limits(void)
+{
+	/* BK has lower limits than BE, both windows are open at once */
+	for (int i = 0; i < CONFIG_NRF700X_TX_COALESCE_BK_MAX_FRAMES - 1; i++) {
+		frame_send(TOS_BK, FRAME_LEN);
+		frame_send(TOS_BE, FRAME_LEN);
+	}
+
+	zassert_equal(count.cmds, 0, "Window flushed early");
+
+	frame_send(TOS_BK, FRAME_LEN);
+
+	zassert_equal(count.cmds, 1, "BK window not flushed at its frame limit");
+	zassert_equal(cmd_log[0].num_frames, CONFIG_NRF700X_TX_COALESCE_BK_MAX_FRAMES,
+		      "BK frames not coalesced");
+	zassert_equal(fmac_dev_ctx.host_stats.total_tx_cmds[WIFI_NRF_FMAC_AC_BE], 0,
+		      "BE window flushed at the BK limit");
+
+	/* A single frame reaching the BK byte limit closes the window */
+	frame_send(TOS_BK, CONFIG_NRF700X_TX_COALESCE_BK_MAX_BYTES);
+
+	zassert_equal(count.cmds, 2, "BK window not flushed at its byte limit");
+	zassert_equal(cmd_log[1].num_frames, 1, "Wrong frame count");
+	zassert_equal(fmac_dev_ctx.host_stats.total_tx_cmds[WIFI_NRF_FMAC_AC_BE], 0,
+		      "BE window flushed at the BK limit");
+
+	time_advance(CONFIG_NRF700X_TX_COALESCE_BE_US);
+
+	zassert_equal(fmac_dev_ctx.host_stats.total_tx_cmds[WIFI_NRF_FMAC_AC_BE], 1,
+		      "BE window not flushed");
+	zassert_equal(cmd_log[2].num_frames, CONFIG_NRF700X_TX_COALESCE_BK_MAX_FRAMES - 1,
+		      "BE frames not coalesced");
+}
+
+static void test_deinit_outstanding(void)
+{
+	/* Frames in TX commands without TX done and frames still pending */
+	for (int i = 0; i < TX_DESCS_AC + TX_AGGREGATION; i++) {
+		frame_send(TOS_VO, FRAME_LEN);
+	}
+
+	zassert_equal(count.cmds, TX_DESCS_AC, "Frames not sent");
+	zassert_equal(frames_used(), TX_DESCS_AC + TX_AGGREGATION, "Frames freed early");
+}
+
+void test_main(void)
+{
+	ztest_test_suite(nrf700x_tx_test,
+			 ztest_unit_test_setup_teardown(test_alloc_per_frame, setup, teardown),
+			 ztest_unit_test_setup_teardown(test_pending_aggregated, setup, teardown),
+			 ztest_unit_test_setup_teardown(test_pending_limit, setup, teardown),
+			 ztest_unit_test_setup_teardown(test_coalesce_frame_limit, setup, teardown),
+			 ztest_unit_test_setup_teardown(test_coalesce_byte_limit, setup, teardown),
+			 ztest_unit_test_setup_teardown(test_coalesce_budget, setup, teardown),
+			 ztest_unit_test_setup_teardown(test_coalesce_latency, setup, teardown),
+			 ztest_unit_test_setup_teardown(test_coalesce_mixed, setup, teardown),
+			 ztest_unit_test_setup_teardown(test_coalesce_stale_timeout, setup,
+							teardown),
+			 ztest_unit_test_setup_teardown(test_coalesce_per_ac_limits, setup,
+							teardown),
+			 ztest_unit_test_setup_teardown(test_deinit_outstanding, setup,
+							teardown_outstanding)
+			 );
+
+	ztest_run_test_suite(nrf700x_tx_test);
+}
@@ -43,9 +43,48 @@ typedef enum {
 	EI_IMPULSE_UNSUPPORTED_INFERENCING_ENGINE = -10
 } EI_IMPULSE_ERROR;
 
+#define EIDSP_OK	0
+
+namespace ei {
+	struct matrix_t {
+		float *buffer;
+		uint32_t rows;
+		uint32_t cols;
+
+		matrix_t(uint32_t n_rows, uint32_t n_cols, float *a_buffer) :
+			buffer(a_buffer), rows(n_rows), cols(n_cols)
+		{
+		}
+	};
+}
+
+typedef struct {
+	size_t n_output_features;
+	int (*extract_fn)(signal_t *signal, ei::matrix_t *output_matrix, void *config,
+			  const float frequency);
+	void *config;
+	uint8_t *axes;
+	size_t axes_size;
+} ei_model_dsp_t;
+
+/* DSP blocks of the mocked impulse. */
+extern const size_t ei_dsp_blocks_size;
+extern ei_model_dsp_t ei_dsp_blocks[];
+
 /* Mock function used by ei_wrapper. */
 extern "C" EI_IMPULSE_ERROR run_classifier(signal_t *signal,
 					   ei_impulse_result_t *result,
 					   bool debug);
 
+extern "C" EI_IMPULSE_ERROR run_classifier_continuous(signal_t *signal,
+						      ei_impulse_result_t *result,
+						      bool debug,
+						      bool enable_maf);
+
+extern "C" void run_classifier_init(void);
+
+extern "C" EI_IMPULSE_ERROR run_inference(ei::matrix_t *fmatrix,
+					  ei_impulse_result_t *result,
+					  bool debug);
+
 #endif /* _EI_RUN_CLASSIFIER_H_ */
@@ -8,11 +8,46 @@
 #include <ei_run_classifier.h>
 
 
+static size_t processed_data_cnt;
+static size_t classification_cnt;
+static size_t slice_cnt;
+static size_t dsp_overlap_cnt;
+static atomic_t inference_running;
+static void (*inference_hook)(void);
+static float next_slice_first_input;
+static uint32_t data_read_cycles;
+
+
+size_t ei_mock_get_processed_data_cnt(void)
+{
+	return processed_data_cnt;
+}
+
+size_t ei_mock_get_classification_cnt(void)
+{
+	return classification_cnt;
+}
+
+size_t ei_mock_get_dsp_overlap_cnt(void)
+{
+	return dsp_overlap_cnt;
+}
+
+void ei_mock_set_inference_hook(void (*hook)(void))
+{
+	inference_hook = hook;
+}
+
+uint32_t ei_mock_get_data_read_cycles(void)
+{
+	return data_read_cycles;
+}
+
 /* Input data must be ascending sequence of floats. Difference between
  * subsequent elements of input sequence equals 1. The first element
  * has value defined by ei_test_params.h (depends on current prediction idx).
  */
-static void verify_data_read(signal_t *signal, const size_t prediction_idx,
+static void verify_data_read(signal_t *signal, const float first_input,
 			     const size_t chunk_size)
 {
 	size_t data_size = signal->total_length;
@@ -26,12 +61,14 @@ static void verify_data_read(signal_t *signal, const size_t prediction_idx,
 	memset(data_buf, 0, sizeof(data_buf));
 
 	for (size_t off = 0; off < data_size; off += chunk_size) {
+		uint32_t start = k_cycle_get_32();
 		int err = signal->get_data(off, chunk_size, data_ptr + off);
 
+		data_read_cycles += k_cycle_get_32() - start;
 		zassert_ok(err, "get_data returned an error");
 	}
 
-	float value = EI_MOCK_GEN_FIRST_INPUT(prediction_idx);;
+	float value = first_input;
 
 	for (size_t off = 0; off < data_size; off++) {
 		zassert_within(data_buf[off], value, FLOAT_CMP_EPSILON,
@@ -40,23 +77,8 @@ static void verify_data_read(signal_t *signal, const size_t prediction_idx,
 	}
 }
 
-EI_IMPULSE_ERROR run_classifier(signal_t *signal,
-				ei_impulse_result_t *result,
-				bool debug)
+static void fill_result(ei_impulse_result_t *result, const size_t prediction_idx)
 {
-	static size_t prediction_idx = 0;
-	ARG_UNUSED(debug);
-
-	/* Test getting data. */
-	verify_data_read(signal, prediction_idx, 1);
-	verify_data_read(signal, prediction_idx,
-			 EI_CLASSIFIER_RAW_SAMPLES_PER_FRAME);
-	verify_data_read(signal, prediction_idx,
-			 EI_CLASSIFIER_DSP_INPUT_FRAME_SIZE);
-
-	/* Busy wait for predefined amount of time to simulate calculations. */
-	k_busy_wait(EI_MOCK_BUSY_WAIT_TIME);
-
 	/* Timing results. */
 	result->timing.dsp = EI_MOCK_GEN_DSP_TIME(prediction_idx);
 	result->timing.classification = EI_MOCK_GEN_CLASSIFICATION_TIME(prediction_idx);
@@ -81,8 +103,171 @@ EI_IMPULSE_ERROR run_classifier(signal_t *signal,
 	zassert_false(strcmp(EI_MOCK_GEN_LABEL(prediction_idx),
 		      ei_classifier_inferencing_categories[res_idx]),
 		      "Wrong label");
+}
+
+EI_IMPULSE_ERROR run_classifier(signal_t *signal,
+				ei_impulse_result_t *result,
+				bool debug)
+{
+	static size_t prediction_idx = 0;
+	ARG_UNUSED(debug);
+
+	float first_input = EI_MOCK_GEN_FIRST_INPUT(prediction_idx);
 
+	/* Test getting data. */
+	verify_data_read(signal, first_input, 1);
+	verify_data_read(signal, first_input,
+			 EI_CLASSIFIER_RAW_SAMPLES_PER_FRAME);
+	verify_data_read(signal, first_input,
+			 EI_CLASSIFIER_DSP_INPUT_FRAME_SIZE);
+
+	processed_data_cnt += signal->total_length;
+	classification_cnt++;
+
+	/* Busy wait for predefined amount of time to simulate calculations. */
+	k_busy_wait(EI_MOCK_BUSY_WAIT_TIME);
+
+	fill_result(result, prediction_idx);
 	prediction_idx++;
 
 	return EI_IMPULSE_OK;
 }
+
+void run_classifier_init(void)
+{
+	slice_cnt = 0;
+}
+
+/* In continuous mode the library gets subsequent slices of the input data.
+ * The signal may contain more than one slice. The result is calculated once,
+ * for the input window that ends with the last slice.
+ */
+EI_IMPULSE_ERROR run_classifier_continuous(signal_t *signal,
+					   ei_impulse_result_t *result,
+					   bool debug,
+					   bool enable_maf)
+{
+	static const size_t slice_size = EI_CLASSIFIER_SLICE_SIZE *
+					 EI_CLASSIFIER_RAW_SAMPLES_PER_FRAME;
+	size_t data_size = signal->total_length;
+	size_t new_slice_cnt = data_size / slice_size;
+
+	ARG_UNUSED(debug);
+	ARG_UNUSED(enable_maf);
+
+	zassert_true((data_size > 0) && (data_size % slice_size == 0), "Wrong slice size");
+	zassert_true(data_size <= EI_CLASSIFIER_DSP_INPUT_FRAME_SIZE, "Too much data");
+
+	float first_input;
+	int err = signal->get_data(0, 1, &first_input);
+
+	zassert_ok(err, "get_data returned an error");
+
+	if (slice_cnt > 0) {
+		zassert_within(first_input, next_slice_first_input, FLOAT_CMP_EPSILON,
+			       "Slices are not contiguous");
+	}
+
+	/* Test getting data. */
+	verify_data_read(signal, first_input, 1);
+	verify_data_read(signal, first_input,
+			 EI_CLASSIFIER_RAW_SAMPLES_PER_FRAME);
+	verify_data_read(signal, first_input, slice_size);
+
+	processed_data_cnt += data_size;
+	next_slice_first_input = first_input + data_size;
+	slice_cnt += new_slice_cnt;
+
+	/* Simulated calculations take time proportional to the processed data. */
+	k_busy_wait(EI_MOCK_BUSY_WAIT_TIME * new_slice_cnt / EI_CLASSIFIER_SLICES_PER_MODEL_WINDOW);
+
+	if (slice_cnt >= EI_CLASSIFIER_SLICES_PER_MODEL_WINDOW) {
+		float window_first_input = next_slice_first_input -
+					   EI_CLASSIFIER_DSP_INPUT_FRAME_SIZE;
+
+		fill_result(result, window_first_input / EI_CLASSIFIER_RAW_SAMPLES_PER_FRAME);
+		classification_cnt++;
+	}
+
+	return EI_IMPULSE_OK;
+}
+
+/* The DSP block of the mocked impulse stores the first input value as the first
+ * feature. The classification derives the prediction index from the feature.
+ */
+static int extract_mock_features(signal_t *signal, ei::matrix_t *output_matrix, void *config,
+				 const float frequency)
+{
+	ARG_UNUSED(config);
+
+	zassert_equal(signal->total_length, EI_CLASSIFIER_DSP_INPUT_FRAME_SIZE,
+		      "Wrong input window size");
+	zassert_equal(output_matrix->cols, EI_CLASSIFIER_NN_INPUT_FRAME_SIZE,
+		      "Wrong number of features");
+	zassert_within(frequency, EI_CLASSIFIER_FREQUENCY, FLOAT_CMP_EPSILON,
+		       "Wrong frequency");
+
+	if (atomic_get(&inference_running)) {
+		dsp_overlap_cnt++;
+	}
+
+	float first_input;
+	int err = signal->get_data(0, 1, &first_input);
+
+	zassert_ok(err, "get_data returned an error");
+
+	/* Test getting data. */
+	verify_data_read(signal, first_input, 1);
+	verify_data_read(signal, first_input,
+			 EI_CLASSIFIER_RAW_SAMPLES_PER_FRAME);
+	verify_data_read(signal, first_input,
+			 EI_CLASSIFIER_DSP_INPUT_FRAME_SIZE);
+
+	processed_data_cnt += signal->total_length;
+
+	memset(output_matrix->buffer, 0, output_matrix->cols * sizeof(output_matrix->buffer[0]));
+	output_matrix->buffer[0] = first_input;
+
+	k_busy_wait(EI_MOCK_BUSY_WAIT_TIME / 2);
+
+	return EIDSP_OK;
+}
+
+const size_t ei_dsp_blocks_size = 1;
+ei_model_dsp_t ei_dsp_blocks[] = {
+	{
+		EI_CLASSIFIER_NN_INPUT_FRAME_SIZE,	/* n_output_features */
+		extract_mock_features,			/* extract_fn */
+		NULL,					/* config */
+		NULL,					/* axes */
+		EI_CLASSIFIER_RAW_SAMPLES_PER_FRAME,	/* axes_size */
+	},
+};
+
+EI_IMPULSE_ERROR run_inference(ei::matrix_t *fmatrix,
+			       ei_impulse_result_t *result,
+			       bool debug)
+{
+	ARG_UNUSED(debug);
+
+	zassert_equal(fmatrix->cols, EI_CLASSIFIER_NN_INPUT_FRAME_SIZE,
+		      "Wrong number of features");
+
+	atomic_set(&inference_running, true);
+
+	if (inference_hook) {
+		void (*hook)(void) = inference_hook;
+
+		inference_hook = NULL;
+		hook();
+	}
+
+	k_busy_wait(EI_MOCK_BUSY_WAIT_TIME / 2);
+
+	fill_result(result, fmatrix->buffer[0] / EI_CLASSIFIER_RAW_SAMPLES_PER_FRAME);
+	classification_cnt++;
+
+	atomic_set(&inference_running, false);
+
+	return EI_IMPULSE_OK;
+}
@@ -18,6 +18,14 @@
 #define EI_CLASSIFIER_DSP_INPUT_FRAME_SIZE	300
 #define EI_CLASSIFIER_HAS_ANOMALY		1
 #define EI_CLASSIFIER_FREQUENCY			60
+#define EI_CLASSIFIER_NN_INPUT_FRAME_SIZE	33
+#define EI_CLASSIFIER_RAW_SAMPLE_COUNT		(EI_CLASSIFIER_DSP_INPUT_FRAME_SIZE / \
+						 EI_CLASSIFIER_RAW_SAMPLES_PER_FRAME)
+#ifndef EI_CLASSIFIER_SLICES_PER_MODEL_WINDOW
+#define EI_CLASSIFIER_SLICES_PER_MODEL_WINDOW	4
+#endif
+#define EI_CLASSIFIER_SLICE_SIZE		(EI_CLASSIFIER_RAW_SAMPLE_COUNT / \
+						 EI_CLASSIFIER_SLICES_PER_MODEL_WINDOW)
 
 /* Mocked results. */
 static const char * const ei_classifier_inferencing_categories[] = {
@@ -44,4 +52,21 @@ static const char * const ei_classifier_inferencing_categories[] = {
 /* Data processing is simulated as busy wait. */
 #define EI_MOCK_BUSY_WAIT_TIME				(100U)
 
+/* Number of input values processed by the mocked library. */
+size_t ei_mock_get_processed_data_cnt(void);
+
+/* Number of classifications run by the mocked library. */
+size_t ei_mock_get_classification_cnt(void);
+
+/* Number of DSP feature calculations that preempted a classification. */
+size_t ei_mock_get_dsp_overlap_cnt(void);
+
+/* Function called by the mocked library when the classification of DSP
+ * features starts. The function is called once.
+ */
+void ei_mock_set_inference_hook(void (*hook)(void));
+
+/* Number of cycles spent by the mocked library on reading the input data. */
+uint32_t ei_mock_get_data_read_cycles(void);
+
 #endif /* _EI_TEST_PARAMS_H_ */
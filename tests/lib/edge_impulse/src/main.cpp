@@ -14,11 +14,17 @@
 #define EI_TEST_THREAD_WINDOW_SHIFT		2
 #define EI_TEST_WINDOW_SHIFT_CB			1
 
+#ifdef CONFIG_EI_WRAPPER_PIPELINE
+#define EI_TEST_PIPELINE_DEPTH			CONFIG_EI_WRAPPER_PIPELINE_DEPTH
+#else
+#define EI_TEST_PIPELINE_DEPTH			1
+#endif
+
 static atomic_t rerun_in_cb;
 
 static size_t prediction_idx;
 /* Semaphore is used to wait until ei_wrapper returns prediction results. */
-static K_SEM_DEFINE(test_sem, 0, 1)
+static K_SEM_DEFINE(test_sem, 0, EI_TEST_PIPELINE_DEPTH)
 
 
 static int add_input_data(const size_t pred_idx, const size_t frame_surplus)
@@ -99,10 +105,21 @@ static void verify_result(const size_t pred_idx)
 	err = ei_wrapper_get_timing(&dsp_time, &classification_time, &anomaly_time);
 	zassert_ok(err, "ei_wrapper_get_timing returned an error");
 
-	zassert_equal(dsp_time, EI_MOCK_GEN_DSP_TIME(pred_idx), "Wrong DSP time");
+	/* In pipeline mode, the DSP time is measured by the wrapper. */
+	if (IS_ENABLED(CONFIG_EI_WRAPPER_PIPELINE)) {
+		zassert_true(dsp_time >= 0, "Wrong DSP time");
+	} else {
+		zassert_equal(dsp_time, EI_MOCK_GEN_DSP_TIME(pred_idx), "Wrong DSP time");
+	}
 	zassert_equal(classification_time, EI_MOCK_GEN_CLASSIFICATION_TIME(pred_idx),
 		      "Wrong classification time");
 	zassert_equal(anomaly_time, EI_MOCK_GEN_ANOMALY_TIME(pred_idx), "Wrong anomaly time");
+
+	int64_t timestamp;
+
+	err = ei_wrapper_get_window_timestamp(&timestamp);
+	zassert_ok(err, "ei_wrapper_get_window_timestamp returned an error");
+	zassert_true(timestamp <= k_uptime_get(), "Wrong window timestamp");
 }
 
 static void run_basic_setup(const size_t pred_idx,
@@ -147,11 +164,15 @@ static void test_init(void)
 		      "Wrong window size");
 	zassert_true(ei_wrapper_get_window_size() % ei_wrapper_get_frame_size() == 0,
 		     "Wrong window and frame size combination");
+	zassert_true(ei_wrapper_get_window_size() % ei_wrapper_get_slice_size() == 0,
+		     "Wrong window and slice size combination");
 	zassert_true(ei_wrapper_classifier_has_anomaly(), "Mocked library supports anomaly");
 	zassert_equal(ei_wrapper_get_classifier_frequency(), EI_CLASSIFIER_FREQUENCY,
 		      "Wrong classifier frequency");
 	zassert_equal(ei_wrapper_get_classifier_label_count(), EI_CLASSIFIER_LABEL_COUNT,
 		      "Wrong classifier label count");
+	zassert_equal(ei_wrapper_get_pipeline_depth(), EI_TEST_PIPELINE_DEPTH,
+		      "Wrong pipeline depth");
 
 	for (size_t i = 0; i < ei_wrapper_get_classifier_label_count(); i++) {
 		zassert_equal(ei_wrapper_get_classifier_label(i),
@@ -206,6 +227,7 @@ static void test_result_read_fail(void)
 	int dsp_time;
 	int classification_time;
 	int anomaly_time;
+	int64_t timestamp;
 
 	/* Results cannot be read outside of ei_wrapper callback context. */
 	err = ei_wrapper_get_next_classification_result(&label, &value, NULL);
@@ -214,6 +236,8 @@ static void test_result_read_fail(void)
 	zassert_true(err, "No error for ei_wrapper_get_anomaly");
 	err = ei_wrapper_get_timing(&dsp_time, &classification_time, &anomaly_time);
 	zassert_true(err, "No error for ei_wrapper_get_timing");
+	err = ei_wrapper_get_window_timestamp(&timestamp);
+	zassert_true(err, "No error for ei_wrapper_get_window_timestamp");
 }
 
 static void test_data_add_fail(void)
@@ -232,20 +256,26 @@ static void test_double_start(void)
 {
 	int err;
 
-	err = add_input_data(prediction_idx, 0);
+	/* Every subsequent prediction shifts the window by a frame. */
+	err = add_input_data(prediction_idx, EI_TEST_PIPELINE_DEPTH - 1);
 	zassert_ok(err, "Cannot add input data");
 
 	int key = irq_lock();
 
-	err = ei_wrapper_start_prediction(0, 0);
-	zassert_ok(err, "Cannot start prediction");
-	err = ei_wrapper_start_prediction(0, 0);
-	zassert_true(err, "Prediction started twice");
+	for (size_t i = 0; i < EI_TEST_PIPELINE_DEPTH; i++) {
+		err = ei_wrapper_start_prediction(0, (i == 0) ? (0) : (1));
+		zassert_ok(err, "Cannot start prediction");
+	}
+
+	err = ei_wrapper_start_prediction(0, 1);
+	zassert_true(err, "Too many predictions started");
 
 	irq_unlock(key);
 
-	err = k_sem_take(&test_sem, EI_TEST_SEM_TIMEOUT);
-	zassert_ok(err, "Cannot take semaphore");
+	for (size_t i = 0; i < EI_TEST_PIPELINE_DEPTH; i++) {
+		err = k_sem_take(&test_sem, EI_TEST_SEM_TIMEOUT);
+		zassert_ok(err, "Cannot take semaphore");
+	}
 }
 
 
@@ -289,6 +319,8 @@ static void test_cancel(void)
 static void test_loop(void)
 {
 	const static size_t loop_cnt = 100;
+	size_t classification_cnt = ei_mock_get_classification_cnt();
+	size_t first_pred_idx = prediction_idx;
 
 	for (size_t i = 0; i < loop_cnt; i++) {
 		size_t window_shift = (i == 0) ? (0) : (1);
@@ -308,12 +340,20 @@ static void test_loop(void)
 
 		run_basic_setup(prediction_idx, 2, window_shift, frame_shift);
 	}
+
+	/* The whole window is processed, but the classification is run only once. */
+	zassert_equal(ei_mock_get_classification_cnt() - classification_cnt,
+		      prediction_idx - first_pred_idx, "Wrong number of classifications");
 }
 
 static void test_sliding_window(void)
 {
 	const static size_t frame_surplus = 100;
 	const static size_t loop_cnt = frame_surplus + 1;
+	size_t processed_data_cnt = ei_mock_get_processed_data_cnt();
+	size_t classification_cnt = ei_mock_get_classification_cnt();
+	uint32_t data_read_cycles = ei_mock_get_data_read_cycles();
+	int64_t start_time = k_uptime_get();
 	int err;
 
 	err = add_input_data(prediction_idx, frame_surplus);
@@ -333,6 +373,49 @@ static void test_sliding_window(void)
 		err = k_sem_take(&test_sem, EI_TEST_SEM_TIMEOUT);
 		zassert_ok(err, "Cannot take semaphore");
 	}
+
+	int64_t delta = k_uptime_delta(&start_time);
+
+	processed_data_cnt = ei_mock_get_processed_data_cnt() - processed_data_cnt;
+	data_read_cycles = ei_mock_get_data_read_cycles() - data_read_cycles;
+	TC_PRINT("Processed %zu input values in %d ms\n", processed_data_cnt, (int)delta);
+	TC_PRINT("Reading input data took %u cycles\n", data_read_cycles);
+
+	/* In continuous mode, only the data added to the window by the shift is processed. */
+	size_t expected_cnt;
+
+	if (IS_ENABLED(CONFIG_EI_WRAPPER_CONTINUOUS)) {
+		expected_cnt = EI_CLASSIFIER_DSP_INPUT_FRAME_SIZE +
+			       (loop_cnt - 1) * EI_CLASSIFIER_RAW_SAMPLES_PER_FRAME;
+	} else {
+		expected_cnt = loop_cnt * EI_CLASSIFIER_DSP_INPUT_FRAME_SIZE;
+	}
+
+	zassert_equal(processed_data_cnt, expected_cnt, "Wrong amount of processed data");
+	zassert_equal(ei_mock_get_classification_cnt() - classification_cnt, loop_cnt,
+		      "Wrong number of classifications");
+}
+
+static void test_append_throughput(void)
+{
+	static const size_t loop_cnt = 100;
+	static float data_buf[EI_CLASSIFIER_RAW_SAMPLES_PER_FRAME];
+	uint32_t cycles = 0;
+	int err;
+
+	zassert_true(loop_cnt * ARRAY_SIZE(data_buf) < CONFIG_EI_WRAPPER_DATA_BUF_SIZE,
+		     "Input buffer is too small");
+
+	for (size_t i = 0; i < loop_cnt; i++) {
+		uint32_t start = k_cycle_get_32();
+
+		err = ei_wrapper_add_data(data_buf, ARRAY_SIZE(data_buf));
+		cycles += k_cycle_get_32() - start;
+		zassert_ok(err, "Cannot add input data");
+	}
+
+	TC_PRINT("Adding a frame of input data took %u cycles on average\n",
+		 cycles / loop_cnt);
 }
 
 static void test_data_after_start(void)
@@ -430,6 +513,55 @@ static void test_data_isr(void)
 	zassert_ok(err, "Cannot take semaphore");
 }
 
+static void add_next_frame(void)
+{
+	static float data_buf[EI_CLASSIFIER_RAW_SAMPLES_PER_FRAME];
+
+	/* The frame completes the input window of the next prediction. */
+	float value = EI_MOCK_GEN_FIRST_INPUT(prediction_idx) + EI_CLASSIFIER_DSP_INPUT_FRAME_SIZE;
+
+	for (size_t i = 0; i < ARRAY_SIZE(data_buf); i++) {
+		data_buf[i] = value;
+		value++;
+	}
+
+	int err = ei_wrapper_add_data(data_buf, ARRAY_SIZE(data_buf));
+
+	zassert_ok(err, "Cannot add input data");
+}
+
+static void test_pipeline(void)
+{
+	size_t overlap_cnt = ei_mock_get_dsp_overlap_cnt();
+	int err;
+
+	if (EI_TEST_PIPELINE_DEPTH == 1) {
+		ztest_test_skip();
+	}
+
+	/* Input window of the second prediction is completed while the first one
+	 * is classified. The DSP stage of the second prediction preempts the
+	 * classification.
+	 */
+	ei_mock_set_inference_hook(add_next_frame);
+
+	err = add_input_data(prediction_idx, 0);
+	zassert_ok(err, "Cannot add input data");
+
+	err = ei_wrapper_start_prediction(0, 0);
+	zassert_ok(err, "Cannot start prediction");
+	err = ei_wrapper_start_prediction(0, 1);
+	zassert_ok(err, "Cannot start prediction");
+
+	for (size_t i = 0; i < 2; i++) {
+		err = k_sem_take(&test_sem, EI_TEST_SEM_TIMEOUT);
+		zassert_ok(err, "Cannot take semaphore");
+	}
+
+	zassert_equal(ei_mock_get_dsp_overlap_cnt() - overlap_cnt, 1,
+		      "DSP stage did not overlap the classification");
+}
+
 static void setup_fn(void)
 {
 	bool cancelled;
@@ -457,9 +589,11 @@ void test_main(void)
 		ztest_unit_test_setup_teardown(test_cancel, setup_fn, teardown_fn),
 		ztest_unit_test_setup_teardown(test_loop, setup_fn, teardown_fn),
 		ztest_unit_test_setup_teardown(test_sliding_window, setup_fn, teardown_fn),
+		ztest_unit_test_setup_teardown(test_append_throughput, setup_fn, teardown_fn),
 		ztest_unit_test_setup_teardown(test_data_after_start, setup_fn, teardown_fn),
 		ztest_unit_test_setup_teardown(test_data_thread, setup_fn, teardown_fn),
-		ztest_unit_test_setup_teardown(test_data_isr, setup_fn, teardown_fn)
+		ztest_unit_test_setup_teardown(test_data_isr, setup_fn, teardown_fn),
+		ztest_unit_test_setup_teardown(test_pipeline, setup_fn, teardown_fn)
 	);
 
 	ztest_run_test_suite(test_ei_wrapper);
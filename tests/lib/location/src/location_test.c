@@ -15,6 +15,9 @@
 #include <mock_nrf_modem_gnss.h>
 #include <mock_modem_key_mgmt.h>
 #include <mock_rest_client.h>
+#if defined(CONFIG_LOCATION_CACHE)
+#include <location_cache.h>
+#endif
 
 /* NOTE: Sleep, e.g. k_sleep(K_MSEC(1)), is used after many location library API
  *       function calls because otherwise some of the threaded work in location library
@@ -27,6 +30,7 @@ static struct rest_client_req_context rest_req_ctx = { 0 };
 static struct rest_client_resp_context rest_resp_ctx = { 0 };
 static bool location_callback_called_occurred;
 static bool location_callback_called_expected;
+static int64_t location_callback_uptime;
 
 K_SEM_DEFINE(event_handler_called_sem, 0, 1);
 
@@ -41,6 +45,11 @@ static const char ncellmeas_resp[] =
 	"%NCELLMEAS:0,\"00011B07\",\"26295\",\"00B7\",2300,7,63,31,"
 	"150344527,2300,8,60,29,0,2400,11,55,26,184\r\n";
 
+/* Same as ncellmeas_resp but with a different serving cell */
+static const char ncellmeas_resp_other_cell[] =
+	"%NCELLMEAS:0,\"00011B08\",\"26295\",\"00B7\",2300,7,63,31,"
+	"150344527,2300,8,60,29,0,2400,11,55,26,184\r\n";
+
 char http_resp[512];
 
 static const char http_resp_header_ok[] =
@@ -113,6 +122,11 @@ void setUp(void)
 	mock_nrf_modem_gnss_Init();
 	mock_rest_client_Init();
 	mock_modem_key_mgmt_Init();
+
+#if defined(CONFIG_LOCATION_CACHE)
+	/* Every test expects the location service to be used */
+	location_cache_clear();
+#endif
 }
 
 void tearDown(void)
@@ -134,6 +148,7 @@ void tearDown(void)
 static void location_event_handler(const struct location_event_data *event_data)
 {
 	location_callback_called_occurred = true;
+	location_callback_uptime = k_uptime_get();
 
 	TEST_ASSERT_EQUAL(test_location_event_data.id, event_data->id);
 	TEST_ASSERT_EQUAL(test_location_event_data.location.latitude,
@@ -379,6 +394,118 @@ void test_location_cellular(void)
 	at_monitor_dispatch(ncellmeas_resp);
 }
 
+#if defined(CONFIG_LOCATION_CACHE)
+#define LOCATION_SERVICE_LATENCY_MS 300
+
+static int location_service_request_count;
+
+/* Local stand-in for the cellular positioning service. Responds to every request with
+ * the location in test_location_event_data after a fixed delay.
+ */
+static int location_service_stand_in(struct rest_client_req_context *req_ctx,
+				     struct rest_client_resp_context *resp_ctx,
+				     int cmock_num_calls)
+{
+	location_service_request_count++;
+
+	k_sleep(K_MSEC(LOCATION_SERVICE_LATENCY_MS));
+
+	sprintf(http_resp_body, http_resp_body_fmt,
+		test_location_event_data.location.latitude,
+		test_location_event_data.location.longitude,
+		test_location_event_data.location.accuracy);
+	sprintf(http_resp, "%s%s", http_resp_header_ok, http_resp_body);
+
+	resp_ctx->total_response_len = strlen(http_resp);
+	resp_ctx->response_len = strlen(http_resp + strlen(http_resp_header_ok));
+	resp_ctx->response = http_resp + strlen(http_resp_header_ok);
+	resp_ctx->http_status_code = REST_CLIENT_HTTP_STATUS_OK;
+
+	return 0;
+}
+
+static int64_t helper_location_cellular_request(const char *ncellmeas)
+{
+	int err;
+	int64_t start_uptime;
+	struct location_config config = { 0 };
+	enum location_method methods[] = {LOCATION_METHOD_CELLULAR};
+
+	location_config_defaults_set(&config, 1, methods);
+
+	location_callback_called_occurred = false;
+	k_sem_reset(&event_handler_called_sem);
+
+	__wrap_nrf_modem_at_printf_ExpectAndReturn("AT%%NCELLMEAS", 0);
+
+	start_uptime = k_uptime_get();
+
+	err = location_request(&config);
+	TEST_ASSERT_EQUAL(0, err);
+	k_sleep(K_MSEC(1));
+
+	at_monitor_dispatch(ncellmeas);
+
+	k_sem_take(&event_handler_called_sem, K_SECONDS(3));
+	TEST_ASSERT_EQUAL(location_callback_called_expected, location_callback_called_occurred);
+	k_sleep(K_MSEC(1));
+
+	return location_callback_uptime - start_uptime;
+}
+#endif
+
+/* Test that repeated cellular location requests in the same cell are served from
+ * the location cache, and measure the hit rate and the latency saved.
+ */
+void test_location_cellular_cache(void)
+{
+#if defined(CONFIG_LOCATION_CACHE)
+	const int request_count = 4;
+	struct location_cache_stats stats;
+	int64_t latency[4];
+	int64_t latency_saved;
+
+	test_location_event_data.id = LOCATION_EVT_LOCATION;
+	test_location_event_data.location.latitude = 61.50375;
+	test_location_event_data.location.longitude = 23.896979;
+	test_location_event_data.location.accuracy = 750.0;
+	test_location_event_data.location.datetime.valid = false;
+
+	location_callback_called_expected = true;
+	location_service_request_count = 0;
+
+	__wrap_rest_client_request_defaults_set_Ignore();
+	__wrap_rest_client_request_Stub(location_service_stand_in);
+
+	/* First request in the cell goes to the service, the following ones hit the cache */
+	for (int i = 0; i < request_count - 1; i++) {
+		latency[i] = helper_location_cellular_request(ncellmeas_resp);
+	}
+
+	/* Moving to another cell misses the cache */
+	latency[request_count - 1] = helper_location_cellular_request(ncellmeas_resp_other_cell);
+
+	TEST_ASSERT_EQUAL(2, location_service_request_count);
+
+	location_cache_stats_get(&stats);
+	TEST_ASSERT_EQUAL(2, stats.hits);
+	TEST_ASSERT_EQUAL(2, stats.misses);
+
+	TEST_ASSERT_GREATER_OR_EQUAL(LOCATION_SERVICE_LATENCY_MS, latency[0]);
+	TEST_ASSERT_LESS_THAN(LOCATION_SERVICE_LATENCY_MS, latency[1]);
+	TEST_ASSERT_LESS_THAN(LOCATION_SERVICE_LATENCY_MS, latency[2]);
+	TEST_ASSERT_GREATER_OR_EQUAL(LOCATION_SERVICE_LATENCY_MS, latency[3]);
+
+	latency_saved = (latency[0] - latency[1]) + (latency[0] - latency[2]);
+	printk("Location cache hit rate %d%%, latency saved %lld ms\n",
+	       (stats.hits * 100) / (stats.hits + stats.misses), latency_saved);
+
+	/* The last event was already handled */
+	location_callback_called_expected = false;
+	location_callback_called_occurred = false;
+#endif
+}
+
 /* Test cancelling cellular location request. */
 void test_location_cellular_cancel_during_ncellmeas(void)
 {
@@ -694,6 +821,120 @@ void test_location_request_timeout_cellular_gnss_mode_all(void)
 	__wrap_nrf_modem_gnss_stop_ExpectAndReturn(0);
 }
 
+/* Request location with GNSS and cellular positioning while GNSS doesn't get a fix and
+ * cellular positioning service responds right away. Measure time to first fix.
+ */
+static int64_t helper_location_request_ttff(enum location_req_mode mode, int32_t gnss_timeout)
+{
+	int err;
+	int64_t start_uptime;
+	struct location_config config = { 0 };
+	enum location_method methods[] = {LOCATION_METHOD_GNSS, LOCATION_METHOD_CELLULAR};
+
+	location_config_defaults_set(&config, 2, methods);
+	config.mode = mode;
+	config.methods[0].gnss.timeout = gnss_timeout;
+
+	test_location_event_data.id = LOCATION_EVT_LOCATION;
+	test_location_event_data.location.latitude = 61.50375;
+	test_location_event_data.location.longitude = 23.896979;
+	test_location_event_data.location.accuracy = 750.0;
+	test_location_event_data.location.datetime.valid = false;
+
+	location_callback_called_expected = true;
+	location_callback_called_occurred = false;
+	k_sem_reset(&event_handler_called_sem);
+
+	__wrap_nrf_modem_gnss_event_handler_set_ExpectAndReturn(&method_gnss_event_handler, 0);
+	__wrap_nrf_modem_gnss_fix_interval_set_ExpectAndReturn(1, 0);
+	__wrap_nrf_modem_gnss_use_case_set_ExpectAndReturn(
+		NRF_MODEM_GNSS_USE_CASE_MULTIPLE_HOT_START, 0);
+	__wrap_nrf_modem_gnss_start_ExpectAndReturn(0);
+	/* GNSS is stopped because of the timeout or because cellular positioning was faster */
+	__wrap_nrf_modem_gnss_stop_ExpectAndReturn(0);
+
+	/* TODO: Cannot determine the used system mode but it's set as zero by default in lte_lc */
+	__wrap_nrf_modem_at_scanf_ExpectAndReturn(
+		"AT%XSYSTEMMODE?", "%%XSYSTEMMODE: %d,%d,%d,%d", 4);
+	__wrap_nrf_modem_at_cmd_ExpectAndReturn(NULL, 0, "AT%%XMONITOR", 0);
+	__wrap_nrf_modem_at_cmd_IgnoreArg_buf();
+	__wrap_nrf_modem_at_cmd_IgnoreArg_len();
+	__wrap_nrf_modem_at_cmd_ReturnArrayThruPtr_buf(
+		(char *)xmonitor_resp, sizeof(xmonitor_resp));
+
+	__wrap_nrf_modem_at_printf_ExpectAndReturn("AT%%NCELLMEAS", 0);
+
+	/* Local stand-in for the cellular positioning service */
+	cellular_rest_req_resp_handle();
+	rest_req_ctx.url = "here.api"; /* Needs a fix once rest_req_ctx is verified */
+	rest_req_ctx.sec_tag = CONFIG_MULTICELL_LOCATION_HERE_TLS_SEC_TAG;
+	rest_req_ctx.port = CONFIG_MULTICELL_LOCATION_HERE_HTTPS_PORT;
+	rest_req_ctx.host = CONFIG_MULTICELL_LOCATION_HERE_HOSTNAME;
+
+	start_uptime = k_uptime_get();
+
+	err = location_request(&config);
+	TEST_ASSERT_EQUAL(0, err);
+	at_monitor_dispatch("+CSCON: 0");
+
+	/* Neighbor cell measurements take 100 ms. In fallback mode, they are started only after
+	 * GNSS has timed out.
+	 */
+	if (mode == LOCATION_REQ_MODE_FALLBACK) {
+		k_sleep(K_MSEC(gnss_timeout));
+	}
+	k_sleep(K_MSEC(100));
+	at_monitor_dispatch(ncellmeas_resp);
+
+	k_sem_take(&event_handler_called_sem, K_SECONDS(3));
+	TEST_ASSERT_EQUAL(location_callback_called_expected, location_callback_called_occurred);
+	k_sleep(K_MSEC(1));
+
+	/* Verify mocks here as the helper is called twice within one test */
+	mock_nrf_modem_at_Verify();
+	mock_nrf_modem_gnss_Verify();
+	mock_rest_client_Verify();
+
+	return location_callback_uptime - start_uptime;
+}
+
+/* Test that LOCATION_REQ_MODE_RACE gets the first location faster than
+ * LOCATION_REQ_MODE_FALLBACK when GNSS cannot get a fix.
+ */
+void test_location_request_mode_race_ttff(void)
+{
+#if defined(CONFIG_LOCATION_REQ_MODE_RACE)
+	const int32_t gnss_timeout = 500;
+	int64_t ttff_fallback;
+	int64_t ttff_race;
+
+	ttff_fallback = helper_location_request_ttff(LOCATION_REQ_MODE_FALLBACK, gnss_timeout);
+	ttff_race = helper_location_request_ttff(LOCATION_REQ_MODE_RACE, gnss_timeout);
+
+	printk("Time to first fix: fallback %lld ms, race %lld ms\n", ttff_fallback, ttff_race);
+
+	TEST_ASSERT_GREATER_OR_EQUAL(gnss_timeout, ttff_fallback);
+	TEST_ASSERT_LESS_THAN(gnss_timeout, ttff_race);
+#else
+	/* Run in the unity.location_test.race variant. */
+	TEST_IGNORE();
+#endif
+}
+
+/* Test that race mode is rejected when the same method is given twice. */
+void test_error_mode_race_duplicate_method(void)
+{
+	int err;
+	struct location_config config = { 0 };
+	enum location_method methods[] = {LOCATION_METHOD_CELLULAR, LOCATION_METHOD_CELLULAR};
+
+	location_config_defaults_set(&config, 2, methods);
+	config.mode = LOCATION_REQ_MODE_RACE;
+
+	err = location_request(&config);
+	TEST_ASSERT_EQUAL(-EINVAL, err);
+}
+
 /********* TESTS PERIODIC POSITIONING REQUESTS ***********************/
 /* Use this to disable periodic tests temporarily to save time while developing other tests */
 #define LOCATION_TEST_SKIP_PERIODIC 0
@@ -818,7 +1059,8 @@ void test_location_gnss_periodic(void)
 /* Test periodic location request and cancel it once some iterations are done. */
 void test_location_cellular_periodic(void)
 {
-#if !LOCATION_TEST_SKIP_PERIODIC
+	/* The second iteration would be served from the location cache */
+#if !LOCATION_TEST_SKIP_PERIODIC && !defined(CONFIG_LOCATION_CACHE)
 	int err;
 	struct location_config config = { 0 };
 	enum location_method methods[] = {LOCATION_METHOD_CELLULAR};
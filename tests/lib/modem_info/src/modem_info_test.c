@@ -0,0 +1,234 @@
+/*
+ * Copyright (c) 2022 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+#include <unity.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <modem/modem_info.h>
+#include <modem/at_monitor.h>
+#include <mock_nrf_modem_at.h>
+
+/* Same as CONFIG_MODEM_INFO_SNAPSHOT_TTL in CMakeLists.txt */
+#define TEST_SNAPSHOT_TTL_MS 500
+
+/* Different AT commands needed to read all modem parameters */
+#define TEST_PARAMS_CMD_COUNT 13
+
+/* AT commands whose response does not expire */
+#define TEST_PARAMS_CMD_NO_EXPIRY_COUNT 3
+
+/* AT commands whose response changes with +CEREG and are part of the modem parameters */
+#define TEST_PARAMS_CMD_CEREG_COUNT 4
+
+/* AT commands whose response is never stored (battery voltage, date and time) */
+#define TEST_PARAMS_CMD_VOLATILE_COUNT 2
+
+struct test_at_rsp {
+	const char *cmd;
+	const char *rsp;
+};
+
+static const struct test_at_rsp test_at_rsps[] = {
+	{ "AT%%XCBAND=?", "%XCBAND: (1,2,3,4,5,8,12,13,20,25,26,28,66)\r\nOK\r\n" },
+	{ "AT%%XCBAND", "%XCBAND: 20\r\nOK\r\n" },
+	{ "AT+CGDCONT?", "+CGDCONT: 0,\"IP\",\"telenor.smart\",\"10.81.183.99\",0,0\r\nOK\r\n" },
+	{ "AT+CEMODE?", "+CEMODE: 2\r\nOK\r\n" },
+	{ "AT+COPS?", "+COPS: 0,2,\"24201\",7\r\nOK\r\n" },
+	{ "AT+CEREG?", "+CEREG: 5,1,\"0A0B\",\"01234567\",7,,,\"00000110\",\"00000111\"\r\nOK\r\n" },
+	{ "AT%%XSYSTEMMODE?", "%XSYSTEMMODE: 1,0,1,0\r\nOK\r\n" },
+	{ "AT+CRSM=176,12258,0,0,10", "+CRSM: 144,0,\"985400101232547610F8\"\r\nOK\r\n" },
+	{ "AT+CIMI", "242016000000000\r\nOK\r\n" },
+	{ "AT+CGMR", "mfw_nrf9160_1.3.2\r\nOK\r\n" },
+	{ "AT%%XVBAT", "%XVBAT: 3600\r\nOK\r\n" },
+	{ "AT+CGSN", "352656100367872\r\nOK\r\n" },
+	{ "AT+CCLK?", "+CCLK: \"22/10/19,12:00:00+08\"\r\nOK\r\n" },
+};
+
+static struct modem_param_info modem_param;
+static int at_cmd_count;
+
+/* at_monitor_dispatch() is implemented in at_monitor library and
+ * we'll call it directly to fake received notifications
+ */
+extern void at_monitor_dispatch(const char *at_notif);
+
+static int nrf_modem_at_cmd_stub(void *buf, size_t len, const char *fmt, int cmock_num_calls)
+{
+	ARG_UNUSED(cmock_num_calls);
+
+	at_cmd_count++;
+
+	for (size_t i = 0; i < ARRAY_SIZE(test_at_rsps); i++) {
+		if (strcmp(fmt, test_at_rsps[i].cmd) == 0) {
+			TEST_ASSERT_TRUE(strlen(test_at_rsps[i].rsp) < len);
+			strcpy(buf, test_at_rsps[i].rsp);
+			return 0;
+		}
+	}
+
+	TEST_FAIL_MESSAGE("Unexpected AT command");
+	return -EINVAL;
+}
+
+/* Refreshes all the modem parameters and returns the number of AT commands sent */
+static int helper_modem_info_refresh(void)
+{
+	int64_t start = k_uptime_get();
+	int err;
+
+	at_cmd_count = 0;
+
+	err = modem_info_params_get(&modem_param);
+	TEST_ASSERT_EQUAL(0, err);
+
+	printk("Refresh: %d AT commands, %lld ms\n", at_cmd_count, k_uptime_get() - start);
+
+	return at_cmd_count;
+}
+
+void setUp(void)
+{
+	mock_nrf_modem_at_Init();
+
+	__wrap_nrf_modem_at_cmd_Stub(nrf_modem_at_cmd_stub);
+
+	modem_info_snapshot_invalidate();
+	memset(&modem_param, 0, sizeof(modem_param));
+	TEST_ASSERT_EQUAL(0, modem_info_params_init(&modem_param));
+}
+
+void tearDown(void)
+{
+	mock_nrf_modem_at_Verify();
+}
+
+void test_modem_info_params_get(void)
+{
+	TEST_ASSERT_EQUAL(TEST_PARAMS_CMD_COUNT, helper_modem_info_refresh());
+
+	TEST_ASSERT_EQUAL(20, modem_param.network.current_band.value);
+	TEST_ASSERT_EQUAL_STRING("(1,2,3,4,5,8,12,13,20,25,26,28,66)",
+				 modem_param.network.sup_band.value_string);
+	TEST_ASSERT_EQUAL_STRING("10.81.183.99", modem_param.network.ip_address.value_string);
+	TEST_ASSERT_EQUAL_STRING("telenor.smart", modem_param.network.apn.value_string);
+	TEST_ASSERT_EQUAL_STRING("24201", modem_param.network.current_operator.value_string);
+	TEST_ASSERT_EQUAL(242, modem_param.network.mcc.value);
+	TEST_ASSERT_EQUAL(1, modem_param.network.mnc.value);
+	TEST_ASSERT_EQUAL_STRING("01234567", modem_param.network.cellid_hex.value_string);
+	TEST_ASSERT_EQUAL(0x01234567, (uint32_t)modem_param.network.cellid_dec);
+	TEST_ASSERT_EQUAL(0x0A0B, modem_param.network.area_code.value);
+	TEST_ASSERT_EQUAL(1, modem_param.network.lte_mode.value);
+	TEST_ASSERT_EQUAL(0, modem_param.network.nbiot_mode.value);
+	TEST_ASSERT_EQUAL(1, modem_param.network.gps_mode.value);
+	TEST_ASSERT_EQUAL_STRING("8945000121234567018", modem_param.sim.iccid.value_string);
+	TEST_ASSERT_EQUAL_STRING("242016000000000", modem_param.sim.imsi.value_string);
+	TEST_ASSERT_EQUAL_STRING("mfw_nrf9160_1.3.2", modem_param.device.modem_fw.value_string);
+	TEST_ASSERT_EQUAL(3600, modem_param.device.battery.value);
+	TEST_ASSERT_EQUAL_STRING("352656100367872", modem_param.device.imei.value_string);
+}
+
+void test_modem_info_snapshot(void)
+{
+	uint16_t band;
+
+	TEST_ASSERT_EQUAL(TEST_PARAMS_CMD_COUNT, helper_modem_info_refresh());
+
+	/* Served from the snapshot */
+	TEST_ASSERT_EQUAL(TEST_PARAMS_CMD_VOLATILE_COUNT, helper_modem_info_refresh());
+	TEST_ASSERT_EQUAL_STRING("01234567", modem_param.network.cellid_hex.value_string);
+
+	/* Single data types use the same snapshot */
+	at_cmd_count = 0;
+	TEST_ASSERT_EQUAL(sizeof(uint16_t), modem_info_short_get(MODEM_INFO_CUR_BAND, &band));
+	TEST_ASSERT_EQUAL(20, band);
+	TEST_ASSERT_EQUAL(0, at_cmd_count);
+}
+
+void test_modem_info_snapshot_cereg(void)
+{
+	TEST_ASSERT_EQUAL(TEST_PARAMS_CMD_COUNT, helper_modem_info_refresh());
+
+	at_monitor_dispatch("+CEREG: 5,\"0A0C\",\"01234568\",7,,,\"00000110\",\"00000111\"\r\n");
+	k_sleep(K_MSEC(1));
+
+	TEST_ASSERT_EQUAL(TEST_PARAMS_CMD_CEREG_COUNT + TEST_PARAMS_CMD_VOLATILE_COUNT,
+			  helper_modem_info_refresh());
+	TEST_ASSERT_EQUAL(TEST_PARAMS_CMD_VOLATILE_COUNT, helper_modem_info_refresh());
+}
+
+void test_modem_info_snapshot_ttl(void)
+{
+	TEST_ASSERT_EQUAL(TEST_PARAMS_CMD_COUNT, helper_modem_info_refresh());
+
+	k_sleep(K_MSEC(TEST_SNAPSHOT_TTL_MS));
+
+	TEST_ASSERT_EQUAL(TEST_PARAMS_CMD_COUNT - TEST_PARAMS_CMD_NO_EXPIRY_COUNT,
+			  helper_modem_info_refresh());
+}
+
+void test_modem_info_snapshot_invalidate(void)
+{
+	TEST_ASSERT_EQUAL(TEST_PARAMS_CMD_COUNT, helper_modem_info_refresh());
+
+	modem_info_snapshot_invalidate();
+
+	TEST_ASSERT_EQUAL(TEST_PARAMS_CMD_COUNT, helper_modem_info_refresh());
+}
+
+void test_modem_info_snapshot_volatile(void)
+{
+	char buf[MODEM_INFO_MAX_RESPONSE_SIZE];
+
+	at_cmd_count = 0;
+
+	/* Battery voltage is read from the modem every time */
+	TEST_ASSERT_EQUAL(4, modem_info_string_get(MODEM_INFO_BATTERY, buf, sizeof(buf)));
+	TEST_ASSERT_EQUAL(4, modem_info_string_get(MODEM_INFO_BATTERY, buf, sizeof(buf)));
+	TEST_ASSERT_EQUAL_STRING("3600", buf);
+	TEST_ASSERT_EQUAL(2, at_cmd_count);
+}
+
+void test_modem_info_snapshot_error(void)
+{
+	char buf[MODEM_INFO_MAX_RESPONSE_SIZE];
+
+	__wrap_nrf_modem_at_cmd_Stub(NULL);
+	__wrap_nrf_modem_at_cmd_ExpectAndReturn(NULL, 0, "AT+CIMI", -EIO);
+	__wrap_nrf_modem_at_cmd_IgnoreArg_buf();
+	__wrap_nrf_modem_at_cmd_IgnoreArg_len();
+
+	TEST_ASSERT_EQUAL(-EIO, modem_info_string_get(MODEM_INFO_IMSI, buf, sizeof(buf)));
+
+	/* Failed responses are not stored */
+	__wrap_nrf_modem_at_cmd_Stub(nrf_modem_at_cmd_stub);
+	at_cmd_count = 0;
+	TEST_ASSERT_EQUAL(15, modem_info_string_get(MODEM_INFO_IMSI, buf, sizeof(buf)));
+	TEST_ASSERT_EQUAL_STRING("242016000000000", buf);
+	TEST_ASSERT_EQUAL(1, at_cmd_count);
+}
+
+static int modem_info_test_sys_init(const struct device *unused)
+{
+	ARG_UNUSED(unused);
+
+	__wrap_nrf_modem_at_notif_handler_set_ExpectAnyArgsAndReturn(0);
+
+	return modem_info_init();
+}
+
+/* It is required to be added to each test. That is because unity is using
+ * different main signature (returns int) and zephyr expects main which does
+ * not return value.
+ */
+extern int unity_main(void);
+
+void main(void)
+{
+	(void)unity_main();
+}
+
+SYS_INIT(modem_info_test_sys_init, POST_KERNEL, 0);
@@ -0,0 +1,435 @@
+/*
+ * Copyright (c) 2022 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include <ztest.h>
+#include <errno.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "asrc.h"
+
+#define ZEQ(a, b) zassert_equal(a, b, "fail")
+
+#define SAMPLE_RATE_HZ 48000
+/* Frames in one 10 ms audio frame, and in one 1 ms I2S block */
+#define FRAME_FRAMES 480
+#define BLK_FRAMES 48
+/* -6 dBFS */
+#define AMPLITUDE 16384.0
+#define TONE_LOW_HZ 1000
+#define TONE_HIGH_HZ 10000
+/* Integer number of periods of both tones */
+#define MEAS_WINDOW_FRAMES 960
+#define MEAS_FRAMES (MEAS_WINDOW_FRAMES * 25)
+#define THD_N_MAX_DB (-80.0)
+#define THD_N_HIGH_MAX_DB (-78.0)
+#define DELAY_ERR_MAX_FRAMES 0.01
+
+/* Closed loop simulation */
+#define SIM_DURATION_S 12
+#define SIM_SETTLE_S 8
+#define SIM_FIFO_BLKS 30
+#define SIM_TARGET_DELAY_US 10000
+#define SIM_INITIAL_ERR_US 2000
+#define SIM_ERR_MAX_US 5
+
+static struct asrc_ctx ctx;
+static int16_t in_buf[FRAME_FRAMES * ASRC_CHANNELS_MAX];
+static int16_t out_buf[ASRC_OUT_FRAMES_MAX(FRAME_FRAMES) * ASRC_CHANNELS_MAX];
+
+/* Sine and cosine of a tone, one sample at a time */
+struct osc {
+	double re;
+	double im;
+	double rot_re;
+	double rot_im;
+};
+
+static void osc_init(struct osc *osc, double freq_hz, double sample_rate_hz)
+{
+	double omega = 2 * M_PI * freq_hz / sample_rate_hz;
+
+	osc->re = 1.0;
+	osc->im = 0.0;
+	osc->rot_re = cos(omega);
+	osc->rot_im = sin(omega);
+}
+
+static void osc_next(struct osc *osc)
+{
+	double re = osc->re * osc->rot_re - osc->im * osc->rot_im;
+	double im = osc->re * osc->rot_im + osc->im * osc->rot_re;
+	/* Keep the magnitude at one */
+	double corr = 1.5 - 0.5 * (re * re + im * im);
+
+	osc->re = re * corr;
+	osc->im = im * corr;
+}
+
+/* Fit of a sine of known frequency to the output, in windows short enough
+ * that the slow variation of the delay in the closed loop is not counted as
+ * noise. The residual is the noise and distortion, and the phase gives the
+ * delay.
+ */
+struct tone_meas {
+	struct osc osc;
+	double omega;
+	size_t count;
+	double sum;
+	double sum_sq;
+	double sum_sin;
+	double sum_cos;
+	double signal;
+	double residual;
+	double delay;
+};
+
+static void meas_init(struct tone_meas *meas, double freq_hz)
+{
+	memset(meas, 0, sizeof(*meas));
+	osc_init(&meas->osc, freq_hz, SAMPLE_RATE_HZ);
+	meas->omega = 2 * M_PI * freq_hz / SAMPLE_RATE_HZ;
+}
+
+static void meas_window_end(struct tone_meas *meas)
+{
+	double n = MEAS_WINDOW_FRAMES;
+	double a = 2 * meas->sum_sin / n;
+	double b = 2 * meas->sum_cos / n;
+	double dc = meas->sum / n;
+	double signal = n / 2 * (a * a + b * b);
+
+	meas->signal += signal;
+	meas->residual += meas->sum_sq - n * dc * dc - signal;
+	/* A sin(w(n - d)) = A cos(wd) sin(wn) - A sin(wd) cos(wn) */
+	meas->delay = atan2(-b, a) / meas->omega;
+
+	meas->sum = 0;
+	meas->sum_sq = 0;
+	meas->sum_sin = 0;
+	meas->sum_cos = 0;
+}
+
+/* Add the next output sample, which is only measured if measure is true */
+static void meas_add(struct tone_meas *meas, int16_t sample, bool measure)
+{
+	if (measure && meas->count < MEAS_FRAMES) {
+		meas->sum += sample;
+		meas->sum_sq += (double)sample * sample;
+		meas->sum_sin += sample * meas->osc.im;
+		meas->sum_cos += sample * meas->osc.re;
+		meas->count++;
+
+		if ((meas->count % MEAS_WINDOW_FRAMES) == 0) {
+			meas_window_end(meas);
+		}
+	}
+
+	osc_next(&meas->osc);
+}
+
+static bool meas_done(struct tone_meas *meas)
+{
+	return meas->count == MEAS_FRAMES;
+}
+
+/* THD+N in dB */
+static double meas_thd_n_db(struct tone_meas *meas)
+{
+	return 10 * log10(MAX(meas->residual, 1e-9) / meas->signal);
+}
+
+/* Prints a value with one decimal, as printk does not support floats */
+static void print_value(const char *name, double value, const char *unit)
+{
+	int32_t tenths = (int32_t)lround(value * 10);
+
+	TC_PRINT(" %s %s%d.%d %s", name, (tenths < 0) ? "-" : "", abs(tenths) / 10,
+		 abs(tenths) % 10, unit);
+}
+
+void test_asrc_illegal_arguments(void)
+{
+	size_t out_frames;
+	int ret;
+
+	ret = asrc_init(&ctx, 0);
+	ZEQ(ret, -EINVAL);
+	ret = asrc_init(&ctx, ASRC_CHANNELS_MAX + 1);
+	ZEQ(ret, -EINVAL);
+
+	ret = asrc_init(&ctx, 2);
+	ZEQ(ret, 0);
+
+	ret = asrc_drift_set(&ctx, ASRC_DRIFT_PPM_MAX * 1000 + 1);
+	ZEQ(ret, -EINVAL);
+	ret = asrc_drift_set(&ctx, -ASRC_DRIFT_PPM_MAX * 1000 - 1);
+	ZEQ(ret, -EINVAL);
+
+	ret = asrc_process(&ctx, in_buf, ASRC_FRAMES_MAX + 1, out_buf, ARRAY_SIZE(out_buf) / 2,
+			   &out_frames);
+	ZEQ(ret, -EINVAL);
+	ret = asrc_process(&ctx, in_buf, FRAME_FRAMES, out_buf, FRAME_FRAMES, &out_frames);
+	ZEQ(ret, -ENOMEM);
+}
+
+void test_asrc_dc_gain(void)
+{
+	size_t out_frames;
+	int ret;
+
+	/* The gain is exactly one for all phases */
+	ret = asrc_init(&ctx, 1);
+	ZEQ(ret, 0);
+	ret = asrc_drift_set(&ctx, 1234567);
+	ZEQ(ret, 0);
+
+	for (size_t i = 0; i < FRAME_FRAMES; i++) {
+		in_buf[i] = -12345;
+	}
+
+	for (int frame = 0; frame < 10; frame++) {
+		ret = asrc_process(&ctx, in_buf, FRAME_FRAMES, out_buf, ARRAY_SIZE(out_buf),
+				   &out_frames);
+		ZEQ(ret, 0);
+
+		for (size_t i = (frame == 0) ? ASRC_TAPS : 0; i < out_frames; i++) {
+			zassert_equal(out_buf[i], -12345, "Wrong sample %d in frame %d",
+				      out_buf[i], frame);
+		}
+	}
+}
+
+void test_asrc_frame_count(void)
+{
+	static const int32_t drifts_ppm[] = { -ASRC_DRIFT_PPM_MAX, -1000, 0, 1000,
+					      ASRC_DRIFT_PPM_MAX };
+	const int frames = 1000;
+
+	for (size_t d = 0; d < ARRAY_SIZE(drifts_ppm); d++) {
+		size_t total = 0;
+		size_t out_frames;
+		double expected = (double)frames * FRAME_FRAMES / (1 + drifts_ppm[d] * 1e-6);
+		int ret;
+
+		ret = asrc_init(&ctx, 2);
+		ZEQ(ret, 0);
+		ret = asrc_drift_set(&ctx, drifts_ppm[d] * 1000);
+		ZEQ(ret, 0);
+
+		for (int frame = 0; frame < frames; frame++) {
+			ret = asrc_process(&ctx, in_buf, FRAME_FRAMES, out_buf,
+					   ARRAY_SIZE(out_buf) / 2, &out_frames);
+			ZEQ(ret, 0);
+			zassert_true(out_frames >= FRAME_FRAMES - 1 &&
+				     out_frames <= FRAME_FRAMES + 1,
+				     "Unexpected output frames: %zu", out_frames);
+			total += out_frames;
+		}
+
+		zassert_true(fabs((double)total - expected) <= 1.0, "Drift %d ppm: %zu frames",
+			     drifts_ppm[d], total);
+	}
+}
+
+/* Converts streams with a tone in every channel, sampled with a drifting
+ * clock, and checks the THD+N and the delay of the output.
+ */
+void test_asrc_drift_thd_n(void)
+{
+	static const int32_t drifts_ppm[] = { -1000, -100, 0, 100, 1000 };
+
+	for (size_t d = 0; d < ARRAY_SIZE(drifts_ppm); d++) {
+		double in_rate_hz = SAMPLE_RATE_HZ * (1 + drifts_ppm[d] * 1e-6);
+		struct osc in_osc[2];
+		struct tone_meas meas[2];
+		size_t out_idx = 0;
+		int ret;
+
+		ret = asrc_init(&ctx, 2);
+		ZEQ(ret, 0);
+		ret = asrc_drift_set(&ctx, drifts_ppm[d] * 1000);
+		ZEQ(ret, 0);
+
+		osc_init(&in_osc[0], TONE_LOW_HZ, in_rate_hz);
+		osc_init(&in_osc[1], TONE_HIGH_HZ, in_rate_hz);
+		meas_init(&meas[0], TONE_LOW_HZ);
+		meas_init(&meas[1], TONE_HIGH_HZ);
+
+		while (!meas_done(&meas[0]) || !meas_done(&meas[1])) {
+			size_t out_frames;
+
+			for (size_t i = 0; i < FRAME_FRAMES; i++) {
+				for (size_t ch = 0; ch < 2; ch++) {
+					in_buf[i * 2 + ch] = lround(AMPLITUDE * in_osc[ch].im);
+					osc_next(&in_osc[ch]);
+				}
+			}
+
+			ret = asrc_process(&ctx, in_buf, FRAME_FRAMES, out_buf,
+					   ARRAY_SIZE(out_buf) / 2, &out_frames);
+			ZEQ(ret, 0);
+
+			for (size_t i = 0; i < out_frames; i++, out_idx++) {
+				/* Skip the start, where the history is not filled */
+				for (size_t ch = 0; ch < 2; ch++) {
+					meas_add(&meas[ch], out_buf[i * 2 + ch],
+						 out_idx >= ASRC_TAPS);
+				}
+			}
+		}
+
+		double expected_delay = ASRC_DELAY_FRAMES / (1 + drifts_ppm[d] * 1e-6);
+		double thd_n_low_db = meas_thd_n_db(&meas[0]);
+		double thd_n_high_db = meas_thd_n_db(&meas[1]);
+
+		TC_PRINT("Drift %5d ppm:", drifts_ppm[d]);
+		print_value("THD+N", thd_n_low_db, "dB at 1 kHz,");
+		print_value("", thd_n_high_db, "dB at 10 kHz,");
+		print_value("latency", meas[0].delay * 1000000 / SAMPLE_RATE_HZ, "us\n");
+
+		zassert_true(thd_n_low_db < THD_N_MAX_DB, "THD+N too high");
+		zassert_true(thd_n_high_db < THD_N_HIGH_MAX_DB, "THD+N too high");
+		zassert_true(fabs(meas[0].delay - expected_delay) < DELAY_ERR_MAX_FRAMES,
+			     "Unexpected delay");
+	}
+}
+
+/* Simulates the output datapath of a headset, where frames are received with
+ * the clock of the gateway and played with the local I2S clock. The blocks
+ * in the FIFO are time stamped as in the datapath, and the drift is
+ * controlled by the measured presentation delay.
+ */
+static void closed_loop_run(int32_t drift_ppm)
+{
+	static int16_t fifo[SIM_FIFO_BLKS][BLK_FRAMES];
+	static uint32_t fifo_ts_us[SIM_FIFO_BLKS];
+	static int16_t staging[ASRC_OUT_FRAMES_MAX(FRAME_FRAMES) + BLK_FRAMES];
+	double frame_period_us = 1000000.0 * FRAME_FRAMES /
+				 (SAMPLE_RATE_HZ * (1 + drift_ppm * 1e-6));
+	struct asrc_ctrl ctrl;
+	struct osc in_osc;
+	struct tone_meas meas;
+	size_t prod = 0;
+	size_t cons = 0;
+	size_t staged = 0;
+	uint32_t next_frame = 0;
+	int32_t pres_dly_us = SIM_TARGET_DELAY_US;
+	int32_t err_max_us = 0;
+	uint32_t underruns = 0;
+	uint32_t overruns = 0;
+	int32_t drift_ppb = 0;
+	int ret;
+
+	ret = asrc_init(&ctx, 1);
+	ZEQ(ret, 0);
+	asrc_ctrl_reset(&ctrl);
+	osc_init(&in_osc, TONE_LOW_HZ, SAMPLE_RATE_HZ * (1 + drift_ppm * 1e-6));
+	meas_init(&meas, TONE_LOW_HZ);
+
+	for (uint32_t blk = 0; blk < SIM_DURATION_S * 1000; blk++) {
+		/* Playback starts with a presentation delay that is too long */
+		uint32_t now_us = blk * 1000 + SIM_TARGET_DELAY_US + SIM_INITIAL_ERR_US;
+
+		/*** Received frames ***/
+		while (next_frame * frame_period_us <= now_us) {
+			uint32_t recv_us = lround(next_frame * frame_period_us);
+			int32_t offset = asrc_offset_get(&ctx);
+			size_t out_frames;
+			size_t num_blks;
+
+			next_frame++;
+
+			int32_t err_us = pres_dly_us - SIM_TARGET_DELAY_US;
+
+			drift_ppb = asrc_ctrl_update(&ctrl, err_us);
+			ret = asrc_drift_set(&ctx, drift_ppb);
+			ZEQ(ret, 0);
+
+			if (blk >= SIM_SETTLE_S * 1000) {
+				err_max_us = MAX(err_max_us, abs(err_us));
+			}
+
+			for (size_t i = 0; i < FRAME_FRAMES; i++) {
+				in_buf[i] = lround(AMPLITUDE * in_osc.im);
+				osc_next(&in_osc);
+			}
+
+			ret = asrc_process(&ctx, in_buf, FRAME_FRAMES, &staging[staged],
+					   ARRAY_SIZE(staging) - staged, &out_frames);
+			ZEQ(ret, 0);
+
+			num_blks = (staged + out_frames) / BLK_FRAMES;
+
+			if (prod - cons + num_blks > SIM_FIFO_BLKS) {
+				overruns++;
+				staged = 0;
+				continue;
+			}
+
+			for (size_t i = 0; i < num_blks; i++) {
+				/* Time of the block in the input, in 1/65536 frames */
+				int64_t blk_pos = offset + ((int64_t)i * BLK_FRAMES - staged) * 65536;
+
+				memcpy(fifo[prod % SIM_FIFO_BLKS], &staging[i * BLK_FRAMES],
+				       sizeof(fifo[0]));
+				fifo_ts_us[prod % SIM_FIFO_BLKS] =
+					recv_us + (blk_pos * 1000000) / (SAMPLE_RATE_HZ * 65536LL);
+				prod++;
+			}
+
+			staged = staged + out_frames - num_blks * BLK_FRAMES;
+			memmove(staging, &staging[num_blks * BLK_FRAMES],
+				staged * sizeof(int16_t));
+		}
+
+		/*** I2S block ***/
+		if (cons == prod) {
+			underruns++;
+			continue;
+		}
+
+		pres_dly_us = now_us - fifo_ts_us[cons % SIM_FIFO_BLKS];
+
+		for (size_t i = 0; i < BLK_FRAMES; i++) {
+			meas_add(&meas, fifo[cons % SIM_FIFO_BLKS][i],
+				 blk >= SIM_SETTLE_S * 1000);
+		}
+		cons++;
+	}
+
+	double thd_n_db = meas_thd_n_db(&meas);
+
+	TC_PRINT("Drift %5d ppm: estimated %d ppb, max error %d us,", drift_ppm, drift_ppb,
+		 err_max_us);
+	print_value("THD+N", thd_n_db, "dB\n");
+
+	ZEQ(underruns, 0);
+	ZEQ(overruns, 0);
+	zassert_true(err_max_us <= SIM_ERR_MAX_US, "Presentation delay not locked");
+	zassert_true(meas_done(&meas), "Not enough samples");
+	zassert_true(thd_n_db < THD_N_MAX_DB, "THD+N too high");
+}
+
+void test_asrc_closed_loop(void)
+{
+	closed_loop_run(1000);
+	closed_loop_run(-1000);
+	closed_loop_run(0);
+}
+
+void test_main(void)
+{
+	ztest_test_suite(test_suite_asrc,
+		ztest_unit_test(test_asrc_illegal_arguments),
+		ztest_unit_test(test_asrc_dc_gain),
+		ztest_unit_test(test_asrc_frame_count),
+		ztest_unit_test(test_asrc_drift_thd_n),
+		ztest_unit_test(test_asrc_closed_loop)
+	);
+
+	ztest_run_test_suite(test_suite_asrc);
+}
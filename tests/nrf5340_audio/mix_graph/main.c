@@ -0,0 +1,588 @@
+/*
+ * Copyright (c) 2022 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include <ztest.h>
+#include <errno.h>
+#include <string.h>
+#include <zephyr/timing/timing.h>
+#include "mix_graph.h"
+#if defined(CONFIG_SW_CODEC_LC3_T2_SOFTWARE)
+#include "sw_codec_lc3.h"
+#endif
+
+#define ZEQ(a, b) zassert_equal(a, b, "fail")
+
+/* Frames in one 10 ms block at 48 kHz */
+#define FRAME_FRAMES 480
+#define FRAME_DURATION_NS 10000000
+/* Frames in the bit-exactness tests */
+#define TEST_FRAMES 67
+#define BIT_EXACT_ITERATIONS 200
+#define BENCHMARK_ITERATIONS 20
+#define FRAME_DURATION_US 10000
+/* Mono LC3 streams, as sent by the headsets of a conference */
+#define LC3_STREAMS_MAX 8
+#define LC3_SAMPLE_RATE 48000
+#define LC3_BIT_DEPTH 16
+#define LC3_BITRATE 48000
+#define LC3_ENC_BUF_SIZE 120
+
+static struct mix_graph graph;
+static int16_t src_buf[MIX_GRAPH_SRC_MAX][FRAME_FRAMES * MIX_GRAPH_CH_MAX];
+static int16_t ref_buf[FRAME_FRAMES * MIX_GRAPH_CH_MAX];
+
+static uint32_t prng_state = 1;
+
+static uint32_t prng(void)
+{
+	/* xorshift32 */
+	prng_state ^= prng_state << 13;
+	prng_state ^= prng_state >> 17;
+	prng_state ^= prng_state << 5;
+
+	return prng_state;
+}
+
+/* Random samples, with many of them at full scale to test the saturation */
+static void random_fill(int16_t *buf, size_t samples)
+{
+	for (size_t i = 0; i < samples; i++) {
+		uint32_t r = prng();
+
+		switch (r & 0x7) {
+		case 0:
+			buf[i] = INT16_MAX;
+			break;
+		case 1:
+			buf[i] = INT16_MIN;
+			break;
+		default:
+			buf[i] = (int16_t)(r >> 16);
+			break;
+		}
+	}
+}
+
+static int16_t ref_clip(int32_t pcm)
+{
+	if (pcm > INT16_MAX) {
+		return INT16_MAX;
+	} else if (pcm < INT16_MIN) {
+		return INT16_MIN;
+	}
+
+	return pcm;
+}
+
+/* Straightforward mix of one bus, sample by sample */
+static void ref_bus_mix(struct mix_graph const *g, uint8_t bus_id, int16_t *const *pcm,
+			int16_t *out)
+{
+	struct mix_graph_bus const *bus = &g->bus[bus_id];
+
+	for (size_t i = 0; i < g->num_frames; i++) {
+		for (uint8_t ch = 0; ch < bus->num_ch; ch++) {
+			int32_t acc = 0;
+
+			for (uint8_t s = 0; s < g->num_src; s++) {
+				struct mix_graph_src const *src = &g->src[s];
+				int32_t gain = (src->gain * bus->route_gain[s] + 2048) >> 12;
+
+				if (pcm[s] == NULL) {
+					continue;
+				}
+
+				gain = MIN(gain, MIX_GRAPH_GAIN_MAX);
+
+				if (src->num_ch == bus->num_ch) {
+					acc += pcm[s][i * bus->num_ch + ch] * gain;
+				} else if (src->num_ch == 1) {
+					acc += pcm[s][i] * gain;
+				} else {
+					acc += (pcm[s][2 * i] + pcm[s][2 * i + 1]) *
+					       ((gain + 1) / 2);
+				}
+			}
+
+			out[i * bus->num_ch + ch] = ref_clip((acc + 2048) >> 12);
+		}
+	}
+}
+
+static void bus_verify(uint8_t bus_id, int16_t const *expected, size_t num_samples)
+{
+	int16_t const *pcm;
+	size_t size;
+	int ret;
+
+	ret = mix_graph_bus_data_get(&graph, bus_id, &pcm, &size);
+	ZEQ(ret, 0);
+	ZEQ(size, num_samples * sizeof(int16_t));
+	zassert_mem_equal(pcm, expected, size, "Bus %d differs", bus_id);
+}
+
+void test_mix_graph_illegal_arguments(void)
+{
+	uint8_t id;
+	int16_t const *pcm;
+	size_t size;
+	int ret;
+
+	ret = mix_graph_init(&graph, 0);
+	ZEQ(ret, -EINVAL);
+	ret = mix_graph_init(&graph, MIX_GRAPH_FRAMES_MAX + 1);
+	ZEQ(ret, -EINVAL);
+
+	ret = mix_graph_init(&graph, FRAME_FRAMES);
+	ZEQ(ret, 0);
+
+	ret = mix_graph_src_add(&graph, 0, &id);
+	ZEQ(ret, -EINVAL);
+	ret = mix_graph_src_add(&graph, MIX_GRAPH_CH_MAX + 1, &id);
+	ZEQ(ret, -EINVAL);
+	ret = mix_graph_bus_add(&graph, 0, &id);
+	ZEQ(ret, -EINVAL);
+	ret = mix_graph_bus_add(&graph, MIX_GRAPH_CH_MAX + 1, &id);
+	ZEQ(ret, -EINVAL);
+
+	/* No sources or buses yet */
+	ret = mix_graph_src_gain_set(&graph, 0, MIX_GRAPH_GAIN_UNITY);
+	ZEQ(ret, -EINVAL);
+	ret = mix_graph_route_set(&graph, 0, 0, MIX_GRAPH_GAIN_UNITY);
+	ZEQ(ret, -EINVAL);
+	ret = mix_graph_src_data_set(&graph, 0, src_buf[0]);
+	ZEQ(ret, -EINVAL);
+	ret = mix_graph_bus_data_get(&graph, 0, &pcm, &size);
+	ZEQ(ret, -EINVAL);
+
+	ret = mix_graph_src_add(&graph, 1, &id);
+	ZEQ(ret, 0);
+	ZEQ(id, 0);
+	ret = mix_graph_bus_add(&graph, 2, &id);
+	ZEQ(ret, 0);
+	ZEQ(id, 0);
+
+	ret = mix_graph_src_gain_set(&graph, 0, MIX_GRAPH_GAIN_MAX + 1);
+	ZEQ(ret, -EINVAL);
+	ret = mix_graph_route_set(&graph, 0, 0, MIX_GRAPH_GAIN_MAX + 1);
+	ZEQ(ret, -EINVAL);
+	ret = mix_graph_route_set(&graph, 1, 0, MIX_GRAPH_GAIN_UNITY);
+	ZEQ(ret, -EINVAL);
+	ret = mix_graph_route_set(&graph, 0, 1, MIX_GRAPH_GAIN_UNITY);
+	ZEQ(ret, -EINVAL);
+	ret = mix_graph_src_data_set(&graph, 1, src_buf[0]);
+	ZEQ(ret, -EINVAL);
+	ret = mix_graph_bus_data_get(&graph, 1, &pcm, &size);
+	ZEQ(ret, -EINVAL);
+}
+
+void test_mix_graph_capacity(void)
+{
+	uint8_t id;
+	int ret;
+
+	ret = mix_graph_init(&graph, FRAME_FRAMES);
+	ZEQ(ret, 0);
+
+	for (uint8_t i = 0; i < MIX_GRAPH_SRC_MAX; i++) {
+		ret = mix_graph_src_add(&graph, 2, &id);
+		ZEQ(ret, 0);
+		ZEQ(id, i);
+	}
+
+	ret = mix_graph_src_add(&graph, 2, &id);
+	ZEQ(ret, -ENOMEM);
+
+	for (uint8_t i = 0; i < MIX_GRAPH_BUS_MAX; i++) {
+		ret = mix_graph_bus_add(&graph, 2, &id);
+		ZEQ(ret, 0);
+		ZEQ(id, i);
+	}
+
+	ret = mix_graph_bus_add(&graph, 2, &id);
+	ZEQ(ret, -ENOMEM);
+}
+
+void test_mix_graph_silence(void)
+{
+	static const int16_t zeros[TEST_FRAMES * 2];
+	uint8_t src_id;
+	uint8_t bus_id[2];
+	int ret;
+
+	ret = mix_graph_init(&graph, TEST_FRAMES);
+	ZEQ(ret, 0);
+	ret = mix_graph_src_add(&graph, 2, &src_id);
+	ZEQ(ret, 0);
+	ret = mix_graph_bus_add(&graph, 2, &bus_id[0]);
+	ZEQ(ret, 0);
+	ret = mix_graph_bus_add(&graph, 2, &bus_id[1]);
+	ZEQ(ret, 0);
+	ret = mix_graph_route_set(&graph, src_id, bus_id[0], MIX_GRAPH_GAIN_UNITY);
+	ZEQ(ret, 0);
+
+	random_fill(src_buf[0], TEST_FRAMES * 2);
+
+	/* Bus 1 has no routes */
+	ret = mix_graph_src_data_set(&graph, src_id, src_buf[0]);
+	ZEQ(ret, 0);
+	mix_graph_process(&graph);
+	bus_verify(bus_id[0], src_buf[0], TEST_FRAMES * 2);
+	bus_verify(bus_id[1], zeros, TEST_FRAMES * 2);
+
+	/* The data must be set for every block */
+	mix_graph_process(&graph);
+	bus_verify(bus_id[0], zeros, TEST_FRAMES * 2);
+
+	/* Removed route */
+	ret = mix_graph_route_set(&graph, src_id, bus_id[0], 0);
+	ZEQ(ret, 0);
+	ret = mix_graph_src_data_set(&graph, src_id, src_buf[0]);
+	ZEQ(ret, 0);
+	mix_graph_process(&graph);
+	bus_verify(bus_id[0], zeros, TEST_FRAMES * 2);
+
+	/* Muted source */
+	ret = mix_graph_route_set(&graph, src_id, bus_id[0], MIX_GRAPH_GAIN_UNITY);
+	ZEQ(ret, 0);
+	ret = mix_graph_src_gain_set(&graph, src_id, 0);
+	ZEQ(ret, 0);
+	ret = mix_graph_src_data_set(&graph, src_id, src_buf[0]);
+	ZEQ(ret, 0);
+	mix_graph_process(&graph);
+	bus_verify(bus_id[0], zeros, TEST_FRAMES * 2);
+}
+
+void test_mix_graph_channels(void)
+{
+	const int16_t mono[] = { 1000, -2000, 3 };
+	const int16_t stereo[] = { 100, 200, -300, -400, 5, 6 };
+	const int16_t stereo_bus[] = { 1100, 1200, -2300, -2400, 8, 9 };
+	const int16_t mono_bus[] = { 1150, -2350, 9 };
+	uint8_t src_mono;
+	uint8_t src_stereo;
+	uint8_t bus_mono;
+	uint8_t bus_stereo;
+	int ret;
+
+	ret = mix_graph_init(&graph, ARRAY_SIZE(mono));
+	ZEQ(ret, 0);
+	ret = mix_graph_src_add(&graph, 1, &src_mono);
+	ZEQ(ret, 0);
+	ret = mix_graph_src_add(&graph, 2, &src_stereo);
+	ZEQ(ret, 0);
+	ret = mix_graph_bus_add(&graph, 1, &bus_mono);
+	ZEQ(ret, 0);
+	ret = mix_graph_bus_add(&graph, 2, &bus_stereo);
+	ZEQ(ret, 0);
+
+	for (uint8_t bus = 0; bus < 2; bus++) {
+		ret = mix_graph_route_set(&graph, src_mono, bus, MIX_GRAPH_GAIN_UNITY);
+		ZEQ(ret, 0);
+		ret = mix_graph_route_set(&graph, src_stereo, bus, MIX_GRAPH_GAIN_UNITY);
+		ZEQ(ret, 0);
+	}
+
+	ret = mix_graph_src_data_set(&graph, src_mono, mono);
+	ZEQ(ret, 0);
+	ret = mix_graph_src_data_set(&graph, src_stereo, stereo);
+	ZEQ(ret, 0);
+	mix_graph_process(&graph);
+
+	bus_verify(bus_mono, mono_bus, ARRAY_SIZE(mono_bus));
+	bus_verify(bus_stereo, stereo_bus, ARRAY_SIZE(stereo_bus));
+}
+
+void test_mix_graph_gain(void)
+{
+	const int16_t in[] = { 1000, -1000, 20000, -20000, 3, -3 };
+	/* Source gain 0.5 and route gain 1.5 */
+	const int16_t scaled[] = { 750, -750, 15000, -15000, 2, -2 };
+	/* Largest gain, saturated */
+	const int16_t doubled[] = { 2000, -2000, INT16_MAX, INT16_MIN, 6, -6 };
+	uint8_t src_id;
+	uint8_t bus_id;
+	int ret;
+
+	ret = mix_graph_init(&graph, ARRAY_SIZE(in));
+	ZEQ(ret, 0);
+	ret = mix_graph_src_add(&graph, 1, &src_id);
+	ZEQ(ret, 0);
+	ret = mix_graph_bus_add(&graph, 1, &bus_id);
+	ZEQ(ret, 0);
+
+	ret = mix_graph_src_gain_set(&graph, src_id, MIX_GRAPH_GAIN_UNITY / 2);
+	ZEQ(ret, 0);
+	ret = mix_graph_route_set(&graph, src_id, bus_id, MIX_GRAPH_GAIN_UNITY * 3 / 2);
+	ZEQ(ret, 0);
+	ret = mix_graph_src_data_set(&graph, src_id, in);
+	ZEQ(ret, 0);
+	mix_graph_process(&graph);
+	bus_verify(bus_id, scaled, ARRAY_SIZE(scaled));
+
+	/* The product of the gains is limited */
+	ret = mix_graph_src_gain_set(&graph, src_id, MIX_GRAPH_GAIN_MAX);
+	ZEQ(ret, 0);
+	ret = mix_graph_route_set(&graph, src_id, bus_id, MIX_GRAPH_GAIN_MAX);
+	ZEQ(ret, 0);
+	ret = mix_graph_src_data_set(&graph, src_id, in);
+	ZEQ(ret, 0);
+	mix_graph_process(&graph);
+	bus_verify(bus_id, doubled, ARRAY_SIZE(doubled));
+}
+
+/* Random graphs compared with a sample by sample reference */
+void test_mix_graph_bit_exact(void)
+{
+	for (size_t it = 0; it < BIT_EXACT_ITERATIONS; it++) {
+		uint8_t num_src = 1 + prng() % MIX_GRAPH_SRC_MAX;
+		uint8_t num_bus = 1 + prng() % MIX_GRAPH_BUS_MAX;
+		int16_t *pcm[MIX_GRAPH_SRC_MAX];
+		uint8_t id;
+		int ret;
+
+		ret = mix_graph_init(&graph, TEST_FRAMES);
+		ZEQ(ret, 0);
+
+		for (uint8_t s = 0; s < num_src; s++) {
+			ret = mix_graph_src_add(&graph, 1 + prng() % 2, &id);
+			ZEQ(ret, 0);
+			ret = mix_graph_src_gain_set(&graph, id, prng() % (MIX_GRAPH_GAIN_MAX + 1));
+			ZEQ(ret, 0);
+
+			/* Some sources without data */
+			pcm[s] = (prng() % 4) ? src_buf[s] : NULL;
+			random_fill(src_buf[s], TEST_FRAMES * MIX_GRAPH_CH_MAX);
+			ret = mix_graph_src_data_set(&graph, id, pcm[s]);
+			ZEQ(ret, 0);
+		}
+
+		for (uint8_t b = 0; b < num_bus; b++) {
+			ret = mix_graph_bus_add(&graph, 1 + prng() % 2, &id);
+			ZEQ(ret, 0);
+
+			for (uint8_t s = 0; s < num_src; s++) {
+				uint16_t gain = (prng() % 2) ? prng() % (MIX_GRAPH_GAIN_MAX + 1) :
+							       MIX_GRAPH_GAIN_UNITY;
+
+				ret = mix_graph_route_set(&graph, s, id, (prng() % 3) ? gain : 0);
+				ZEQ(ret, 0);
+			}
+		}
+
+		mix_graph_process(&graph);
+
+		for (uint8_t b = 0; b < num_bus; b++) {
+			ref_bus_mix(&graph, b, pcm, ref_buf);
+			bus_verify(b, ref_buf, TEST_FRAMES * graph.bus[b].num_ch);
+		}
+	}
+}
+
+/* Prints the time to mix one 10 ms frame of 2, 4 and 8 stereo streams, where
+ * every stream gets the mix of all the other streams, as in a conference.
+ */
+void test_mix_graph_benchmark(void)
+{
+#if defined(CONFIG_TIMING_FUNCTIONS)
+	static const uint8_t num_streams[] = { 2, 4, 8 };
+
+	timing_init();
+	timing_start();
+
+	for (size_t n = 0; n < ARRAY_SIZE(num_streams); n++) {
+		uint8_t id;
+		int ret;
+
+		ret = mix_graph_init(&graph, FRAME_FRAMES);
+		ZEQ(ret, 0);
+
+		for (uint8_t i = 0; i < num_streams[n]; i++) {
+			ret = mix_graph_src_add(&graph, 2, &id);
+			ZEQ(ret, 0);
+			ret = mix_graph_bus_add(&graph, 2, &id);
+			ZEQ(ret, 0);
+			random_fill(src_buf[i], FRAME_FRAMES * 2);
+		}
+
+		for (uint8_t bus = 0; bus < num_streams[n]; bus++) {
+			for (uint8_t src = 0; src < num_streams[n]; src++) {
+				ret = mix_graph_route_set(&graph, src, bus,
+							  (src == bus) ? 0 : MIX_GRAPH_GAIN_UNITY);
+				ZEQ(ret, 0);
+			}
+		}
+
+		timing_t start = timing_counter_get();
+
+		for (size_t i = 0; i < BENCHMARK_ITERATIONS; i++) {
+			for (uint8_t src = 0; src < num_streams[n]; src++) {
+				(void)mix_graph_src_data_set(&graph, src, src_buf[src]);
+			}
+
+			mix_graph_process(&graph);
+		}
+
+		timing_t end = timing_counter_get();
+
+		uint64_t cycles = timing_cycles_get(&start, &end) / BENCHMARK_ITERATIONS;
+		uint32_t ns = timing_cycles_to_ns(cycles);
+		uint32_t permille = (uint64_t)ns * 1000 / FRAME_DURATION_NS;
+
+		TC_PRINT("%u streams: %7u cycles (%6u ns) per 10 ms frame, %u.%u %% CPU\n",
+			 num_streams[n], (uint32_t)cycles, ns, permille / 10, permille % 10);
+	}
+
+	timing_stop();
+#else
+	ztest_test_skip();
+#endif
+}
+
+/* Prints the time to decode 2, 4 and 8 mono LC3 streams, mix them so that
+ * every stream gets the mix of all the other streams, and encode the mix of
+ * every stream, for one 10 ms frame. The streams are random noise, which is
+ * the worst case for the codec.
+ */
+void test_mix_graph_lc3_benchmark(void)
+{
+#if defined(CONFIG_SW_CODEC_LC3_T2_SOFTWARE) && defined(CONFIG_TIMING_FUNCTIONS)
+	BUILD_ASSERT(CONFIG_LC3_ENC_CHAN_MAX >= LC3_STREAMS_MAX, "Too few LC3 encoder channels");
+	BUILD_ASSERT(CONFIG_LC3_DEC_CHAN_MAX >= LC3_STREAMS_MAX, "Too few LC3 decoder channels");
+
+	static const uint8_t num_streams[] = { 2, 4, 8 };
+	static uint8_t encoded[LC3_STREAMS_MAX][LC3_ENC_BUF_SIZE];
+	static uint16_t encoded_size[LC3_STREAMS_MAX];
+	static uint8_t bus_encoded[LC3_ENC_BUF_SIZE];
+	uint16_t pcm_bytes_req;
+	int ret;
+
+	ret = sw_codec_lc3_init(NULL, NULL, FRAME_DURATION_US);
+	ZEQ(ret, 0);
+
+	ret = sw_codec_lc3_enc_init(LC3_SAMPLE_RATE, LC3_BIT_DEPTH, FRAME_DURATION_US, LC3_BITRATE,
+				    LC3_STREAMS_MAX, &pcm_bytes_req);
+	ZEQ(ret, 0);
+	ZEQ(pcm_bytes_req, FRAME_FRAMES * sizeof(int16_t));
+
+	ret = sw_codec_lc3_dec_init(LC3_SAMPLE_RATE, LC3_BIT_DEPTH, FRAME_DURATION_US,
+				    LC3_STREAMS_MAX);
+	ZEQ(ret, 0);
+
+	/* Frame received from every headset */
+	for (uint8_t i = 0; i < LC3_STREAMS_MAX; i++) {
+		random_fill(src_buf[i], FRAME_FRAMES);
+
+		ret = sw_codec_lc3_enc_run(src_buf[i], FRAME_FRAMES * sizeof(int16_t),
+					   LC3_USE_BITRATE_FROM_INIT, i, sizeof(encoded[i]),
+					   encoded[i], &encoded_size[i]);
+		ZEQ(ret, 0);
+	}
+
+	timing_init();
+	timing_start();
+
+	for (size_t n = 0; n < ARRAY_SIZE(num_streams); n++) {
+		uint64_t dec_cycles = 0;
+		uint64_t mix_cycles = 0;
+		uint64_t enc_cycles = 0;
+		uint8_t id;
+
+		ret = mix_graph_init(&graph, FRAME_FRAMES);
+		ZEQ(ret, 0);
+
+		for (uint8_t i = 0; i < num_streams[n]; i++) {
+			ret = mix_graph_src_add(&graph, 1, &id);
+			ZEQ(ret, 0);
+			ret = mix_graph_bus_add(&graph, 1, &id);
+			ZEQ(ret, 0);
+		}
+
+		for (uint8_t bus = 0; bus < num_streams[n]; bus++) {
+			for (uint8_t src = 0; src < num_streams[n]; src++) {
+				ret = mix_graph_route_set(&graph, src, bus,
+							  (src == bus) ? 0 : MIX_GRAPH_GAIN_UNITY);
+				ZEQ(ret, 0);
+			}
+		}
+
+		for (size_t i = 0; i < BENCHMARK_ITERATIONS; i++) {
+			timing_t start = timing_counter_get();
+
+			for (uint8_t src = 0; src < num_streams[n]; src++) {
+				uint16_t pcm_size;
+
+				ret = sw_codec_lc3_dec_run(encoded[src], encoded_size[src],
+							   FRAME_FRAMES * sizeof(int16_t), src,
+							   src_buf[src], &pcm_size, false);
+				ZEQ(ret, 0);
+				ZEQ(pcm_size, FRAME_FRAMES * sizeof(int16_t));
+
+				(void)mix_graph_src_data_set(&graph, src, src_buf[src]);
+			}
+
+			timing_t decoded = timing_counter_get();
+
+			mix_graph_process(&graph);
+
+			timing_t mixed = timing_counter_get();
+
+			for (uint8_t bus = 0; bus < num_streams[n]; bus++) {
+				int16_t const *pcm;
+				size_t pcm_size;
+				uint16_t bus_encoded_size;
+
+				ret = mix_graph_bus_data_get(&graph, bus, &pcm, &pcm_size);
+				ZEQ(ret, 0);
+
+				ret = sw_codec_lc3_enc_run(pcm, pcm_size, LC3_USE_BITRATE_FROM_INIT,
+							   bus, sizeof(bus_encoded), bus_encoded,
+							   &bus_encoded_size);
+				ZEQ(ret, 0);
+			}
+
+			timing_t end = timing_counter_get();
+
+			dec_cycles += timing_cycles_get(&start, &decoded);
+			mix_cycles += timing_cycles_get(&decoded, &mixed);
+			enc_cycles += timing_cycles_get(&mixed, &end);
+		}
+
+		uint32_t dec_ns = timing_cycles_to_ns(dec_cycles / BENCHMARK_ITERATIONS);
+		uint32_t mix_ns = timing_cycles_to_ns(mix_cycles / BENCHMARK_ITERATIONS);
+		uint32_t enc_ns = timing_cycles_to_ns(enc_cycles / BENCHMARK_ITERATIONS);
+		uint32_t permille =
+			(uint64_t)(dec_ns + mix_ns + enc_ns) * 1000 / FRAME_DURATION_NS;
+
+		TC_PRINT("%u streams: decode %8u ns, mix %7u ns, encode %8u ns per 10 ms frame, "
+			 "%u.%u %% CPU\n",
+			 num_streams[n], dec_ns, mix_ns, enc_ns, permille / 10, permille % 10);
+	}
+
+	timing_stop();
+
+	sw_codec_lc3_enc_uninit_all();
+	sw_codec_lc3_dec_uninit_all();
+#else
+	ztest_test_skip();
+#endif
+}
+
+void test_main(void)
+{
+	ztest_test_suite(test_suite_mix_graph,
+		ztest_unit_test(test_mix_graph_illegal_arguments),
+		ztest_unit_test(test_mix_graph_capacity),
+		ztest_unit_test(test_mix_graph_silence),
+		ztest_unit_test(test_mix_graph_channels),
+		ztest_unit_test(test_mix_graph_gain),
+		ztest_unit_test(test_mix_graph_bit_exact),
+		ztest_unit_test(test_mix_graph_benchmark),
+		ztest_unit_test(test_mix_graph_lc3_benchmark)
+	);
+
+	ztest_run_test_suite(test_suite_mix_graph);
+}
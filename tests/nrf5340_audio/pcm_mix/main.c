@@ -6,10 +6,108 @@
 
 #include <ztest.h>
 #include <errno.h>
+#include <string.h>
+#include <zephyr/timing/timing.h>
 #include "pcm_mix.h"
 
 #define ZEQ(a, b) zassert_equal(a, b, "fail")
 
+/* Mono samples in one 10 ms frame at 48 kHz */
+#define FRAME_SAMPLES 480
+/* Longest mono buffer in the bit-exactness tests */
+#define MAX_SAMPLES 67
+#define BENCHMARK_ITERATIONS 100
+
+static int16_t buf_a[FRAME_SAMPLES * 2 + 1] __aligned(4);
+static int16_t buf_b[FRAME_SAMPLES + 1] __aligned(4);
+static int16_t buf_r[FRAME_SAMPLES * 2 + 1] __aligned(4);
+
+static uint32_t prng_state = 1;
+
+static uint32_t prng(void)
+{
+	/* xorshift32 */
+	prng_state ^= prng_state << 13;
+	prng_state ^= prng_state >> 17;
+	prng_state ^= prng_state << 5;
+
+	return prng_state;
+}
+
+/* Random samples, with many of them at full scale to test the clipping */
+static void random_fill(int16_t *buf, size_t samples)
+{
+	for (size_t i = 0; i < samples; i++) {
+		uint32_t rnd = prng();
+
+		switch (rnd & 0x3) {
+		case 0:
+			buf[i] = INT16_MAX - (int16_t)((rnd >> 8) & 0xF);
+			break;
+		case 1:
+			buf[i] = INT16_MIN + (int16_t)((rnd >> 8) & 0xF);
+			break;
+		default:
+			buf[i] = (int16_t)(rnd >> 16);
+			break;
+		}
+	}
+}
+
+static int16_t ref_clip(int32_t pcm)
+{
+	if (pcm > INT16_MAX) {
+		return INT16_MAX;
+	} else if (pcm < INT16_MIN) {
+		return INT16_MIN;
+	}
+
+	return pcm;
+}
+
+/* Scalar reference of pcm_mix(), mixing samples_b samples of pcm_b into pcm_a */
+static void ref_pcm_mix(int16_t *pcm_a, int16_t const *pcm_b, size_t samples_b,
+			enum pcm_mix_mode mix_mode)
+{
+	for (size_t i = 0; i < samples_b; i++) {
+		switch (mix_mode) {
+		case B_STEREO_INTO_A_STEREO:
+		case B_MONO_INTO_A_MONO:
+			pcm_a[i] = ref_clip(pcm_a[i] + pcm_b[i]);
+			break;
+		case B_MONO_INTO_A_STEREO_LR:
+			pcm_a[i * 2] = ref_clip(pcm_a[i * 2] + pcm_b[i]);
+			pcm_a[i * 2 + 1] = ref_clip(pcm_a[i * 2 + 1] + pcm_b[i]);
+			break;
+		case B_MONO_INTO_A_STEREO_L:
+			pcm_a[i * 2] = ref_clip(pcm_a[i * 2] + pcm_b[i]);
+			break;
+		case B_MONO_INTO_A_STEREO_R:
+			pcm_a[i * 2 + 1] = ref_clip(pcm_a[i * 2 + 1] + pcm_b[i]);
+			break;
+		}
+	}
+}
+
+static size_t samples_a_get(size_t samples_b, enum pcm_mix_mode mix_mode)
+{
+	if (mix_mode == B_STEREO_INTO_A_STEREO || mix_mode == B_MONO_INTO_A_MONO) {
+		return samples_b;
+	}
+
+	return samples_b * 2;
+}
+
+static const enum pcm_mix_mode mix_modes[] = {
+	B_STEREO_INTO_A_STEREO, B_MONO_INTO_A_MONO, B_MONO_INTO_A_STEREO_LR,
+	B_MONO_INTO_A_STEREO_L, B_MONO_INTO_A_STEREO_R,
+};
+
+static const char *const mix_mode_names[] = {
+	"stereo into stereo", "mono into mono", "mono into stereo LR",
+	"mono into stereo L", "mono into stereo R",
+};
+
 void verify_array_eq(int16_t *p1, int16_t *p2, uint32_t elements)
 {
 	while (elements--) {
@@ -127,6 +225,96 @@ void test_mono_into_stereo_r(void)
 	verify_array_eq(sample_a, sample_r, ARRAY_SIZE(sample_r));
 }
 
+void test_bit_exact(void)
+{
+	int ret;
+
+	/* All lengths, and buffers aligned to a word or only to a sample */
+	for (size_t m = 0; m < ARRAY_SIZE(mix_modes); m++) {
+		for (size_t samples_b = 1; samples_b <= MAX_SAMPLES; samples_b++) {
+			for (size_t offset = 0; offset < 2; offset++) {
+				size_t samples_a = samples_a_get(samples_b, mix_modes[m]);
+				int16_t *pcm_a = &buf_a[offset];
+				int16_t *pcm_b = &buf_b[1 - offset];
+
+				random_fill(pcm_a, samples_a);
+				random_fill(pcm_b, samples_b);
+				memcpy(buf_r, pcm_a, samples_a * sizeof(int16_t));
+
+				ref_pcm_mix(buf_r, pcm_b, samples_b, mix_modes[m]);
+				ret = pcm_mix(pcm_a, samples_a * sizeof(int16_t), pcm_b,
+					      samples_b * sizeof(int16_t), mix_modes[m]);
+				ZEQ(ret, 0);
+
+				zassert_mem_equal(pcm_a, buf_r, samples_a * sizeof(int16_t),
+						  "Mismatch in %s, %zu samples, offset %zu",
+						  mix_mode_names[m], samples_b, offset);
+			}
+		}
+	}
+}
+
+void test_size_check_before_mix(void)
+{
+	int ret;
+	int16_t sample_a[] = { 10, 10, 10, 10 };
+	int16_t sample_b[] = { -5, 5, 1 };
+	int16_t sample_r[] = { 10, 10, 10, 10 };
+
+	ret = pcm_mix(sample_a, sizeof(sample_a), sample_b, sizeof(sample_b),
+		      B_MONO_INTO_A_STEREO_L);
+	ZEQ(ret, -EPERM);
+	verify_array_eq(sample_a, sample_r, ARRAY_SIZE(sample_r));
+
+	ret = pcm_mix(sample_a, sizeof(sample_a), sample_b, sizeof(sample_b),
+		      B_MONO_INTO_A_STEREO_R);
+	ZEQ(ret, -EPERM);
+	verify_array_eq(sample_a, sample_r, ARRAY_SIZE(sample_r));
+}
+
+/* Prints the time pcm_mix() and the scalar reference take to mix one frame */
+void test_benchmark(void)
+{
+#if defined(CONFIG_TIMING_FUNCTIONS)
+	timing_init();
+	timing_start();
+
+	for (size_t m = 0; m < ARRAY_SIZE(mix_modes); m++) {
+		size_t samples_a = samples_a_get(FRAME_SAMPLES, mix_modes[m]);
+		uint64_t cycles[2];
+
+		random_fill(buf_a, samples_a);
+		random_fill(buf_b, FRAME_SAMPLES);
+
+		for (size_t impl = 0; impl < ARRAY_SIZE(cycles); impl++) {
+			timing_t start = timing_counter_get();
+
+			for (size_t i = 0; i < BENCHMARK_ITERATIONS; i++) {
+				if (impl == 0) {
+					(void)pcm_mix(buf_a, samples_a * sizeof(int16_t), buf_b,
+						      FRAME_SAMPLES * sizeof(int16_t),
+						      mix_modes[m]);
+				} else {
+					ref_pcm_mix(buf_a, buf_b, FRAME_SAMPLES, mix_modes[m]);
+				}
+			}
+
+			timing_t end = timing_counter_get();
+
+			cycles[impl] = timing_cycles_get(&start, &end) / BENCHMARK_ITERATIONS;
+		}
+
+		TC_PRINT("%-20s %6u cycles (%6u ns) per frame, reference %6u cycles\n",
+			 mix_mode_names[m], (uint32_t)cycles[0],
+			 (uint32_t)timing_cycles_to_ns(cycles[0]), (uint32_t)cycles[1]);
+	}
+
+	timing_stop();
+#else
+	ztest_test_skip();
+#endif
+}
+
 void test_main(void)
 {
 	ztest_test_suite(test_suite_pcm_mix,
@@ -137,7 +325,10 @@ void test_main(void)
 		ztest_unit_test(test_high_values),
 		ztest_unit_test(test_mono_into_stereo_lr),
 		ztest_unit_test(test_mono_into_stereo_l),
-		ztest_unit_test(test_mono_into_stereo_r)
+		ztest_unit_test(test_mono_into_stereo_r),
+		ztest_unit_test(test_bit_exact),
+		ztest_unit_test(test_size_check_before_mix),
+		ztest_unit_test(test_benchmark)
 	);
 
 	ztest_run_test_suite(test_suite_pcm_mix);
@@ -6,6 +6,8 @@
 
 #include <ztest.h>
 #include <errno.h>
+#include <string.h>
+#include <zephyr/timing/timing.h>
 #include "pcm_stream_channel_modifier.h"
 
 #define ZEQ(a, b) zassert_equal(b, a, "fail")
@@ -301,6 +303,268 @@ void test_pscm_two_channel_split_32(void)
 	verify_array_eq(right_test_list, stereo_split_right_32, output_size);
 }
 
+/* Bytes of one channel in one 10 ms frame at 48 kHz and 32 bits */
+#define FRAME_SIZE_MAX (480 * 4)
+/* Longest number of samples per channel in the bit-exactness tests */
+#define MAX_SAMPLES 19
+#define BENCHMARK_ITERATIONS 100
+
+static const uint8_t bit_depths[] = { 16, 24, 32 };
+
+static uint8_t buf_left[FRAME_SIZE_MAX + 1] __aligned(4);
+static uint8_t buf_right[FRAME_SIZE_MAX + 1] __aligned(4);
+static uint8_t buf_stereo[FRAME_SIZE_MAX * 2 + 1] __aligned(4);
+static uint8_t buf_out_left[FRAME_SIZE_MAX * 2 + 1] __aligned(4);
+static uint8_t buf_out_right[FRAME_SIZE_MAX + 1] __aligned(4);
+static uint8_t buf_ref_left[FRAME_SIZE_MAX * 2] __aligned(4);
+static uint8_t buf_ref_right[FRAME_SIZE_MAX] __aligned(4);
+
+static uint32_t prng_state = 1;
+
+static void random_fill(uint8_t *buf, size_t size)
+{
+	for (size_t i = 0; i < size; i++) {
+		/* xorshift32 */
+		prng_state ^= prng_state << 13;
+		prng_state ^= prng_state >> 17;
+		prng_state ^= prng_state << 5;
+		buf[i] = (uint8_t)prng_state;
+	}
+}
+
+/* Byte-wise references of the modifiers. A NULL left or right input or output
+ * is a silent or dropped channel, and a left input used for both channels is
+ * a copy pad.
+ */
+static void ref_interleave(uint8_t const *left, uint8_t const *right, size_t samples,
+			   uint8_t bytes_per_sample, uint8_t *output)
+{
+	for (size_t i = 0; i < samples; i++) {
+		for (uint8_t j = 0; j < bytes_per_sample; j++) {
+			*output++ = left ? left[i * bytes_per_sample + j] : 0;
+		}
+		for (uint8_t j = 0; j < bytes_per_sample; j++) {
+			*output++ = right ? right[i * bytes_per_sample + j] : 0;
+		}
+	}
+}
+
+static void ref_deinterleave(uint8_t const *input, size_t samples, uint8_t bytes_per_sample,
+			     uint8_t *left, uint8_t *right)
+{
+	for (size_t i = 0; i < samples; i++) {
+		for (uint8_t j = 0; j < bytes_per_sample; j++) {
+			if (left) {
+				left[i * bytes_per_sample + j] = *input;
+			}
+			input++;
+		}
+		for (uint8_t j = 0; j < bytes_per_sample; j++) {
+			if (right) {
+				right[i * bytes_per_sample + j] = *input;
+			}
+			input++;
+		}
+	}
+}
+
+/* Runs all modifiers on samples per channel, compared against the references */
+static void bit_exact_check(uint8_t pcm_bit_depth, size_t samples, size_t offset)
+{
+	uint8_t bytes_per_sample = pcm_bit_depth / 8;
+	size_t mono_size = samples * bytes_per_sample;
+	uint8_t *left = &buf_left[offset];
+	uint8_t *right = &buf_right[1 - offset];
+	uint8_t *stereo = &buf_stereo[offset];
+	uint8_t *out_left = &buf_out_left[1 - offset];
+	uint8_t *out_right = &buf_out_right[offset];
+	size_t output_size;
+	int ret;
+
+	random_fill(left, mono_size);
+	random_fill(right, mono_size);
+	random_fill(stereo, mono_size * 2);
+
+	ret = pscm_zero_pad(left, mono_size, AUDIO_CH_L, pcm_bit_depth, out_left, &output_size);
+	ZEQ(ret, 0);
+	ZEQ(output_size, mono_size * 2);
+	ref_interleave(left, NULL, samples, bytes_per_sample, buf_ref_left);
+	zassert_mem_equal(out_left, buf_ref_left, output_size, "Zero pad L, %u bits, %zu samples",
+			  pcm_bit_depth, samples);
+
+	ret = pscm_zero_pad(left, mono_size, AUDIO_CH_R, pcm_bit_depth, out_left, &output_size);
+	ZEQ(ret, 0);
+	ZEQ(output_size, mono_size * 2);
+	ref_interleave(NULL, left, samples, bytes_per_sample, buf_ref_left);
+	zassert_mem_equal(out_left, buf_ref_left, output_size, "Zero pad R, %u bits, %zu samples",
+			  pcm_bit_depth, samples);
+
+	ret = pscm_copy_pad(left, mono_size, pcm_bit_depth, out_left, &output_size);
+	ZEQ(ret, 0);
+	ZEQ(output_size, mono_size * 2);
+	ref_interleave(left, left, samples, bytes_per_sample, buf_ref_left);
+	zassert_mem_equal(out_left, buf_ref_left, output_size, "Copy pad, %u bits, %zu samples",
+			  pcm_bit_depth, samples);
+
+	ret = pscm_combine(left, right, mono_size, pcm_bit_depth, out_left, &output_size);
+	ZEQ(ret, 0);
+	ZEQ(output_size, mono_size * 2);
+	ref_interleave(left, right, samples, bytes_per_sample, buf_ref_left);
+	zassert_mem_equal(out_left, buf_ref_left, output_size, "Combine, %u bits, %zu samples",
+			  pcm_bit_depth, samples);
+
+	ret = pscm_one_channel_split(stereo, mono_size * 2, AUDIO_CH_L, pcm_bit_depth, out_left,
+				     &output_size);
+	ZEQ(ret, 0);
+	ZEQ(output_size, mono_size);
+	ref_deinterleave(stereo, samples, bytes_per_sample, buf_ref_left, NULL);
+	zassert_mem_equal(out_left, buf_ref_left, output_size, "Split L, %u bits, %zu samples",
+			  pcm_bit_depth, samples);
+
+	ret = pscm_one_channel_split(stereo, mono_size * 2, AUDIO_CH_R, pcm_bit_depth, out_left,
+				     &output_size);
+	ZEQ(ret, 0);
+	ZEQ(output_size, mono_size);
+	ref_deinterleave(stereo, samples, bytes_per_sample, NULL, buf_ref_left);
+	zassert_mem_equal(out_left, buf_ref_left, output_size, "Split R, %u bits, %zu samples",
+			  pcm_bit_depth, samples);
+
+	ret = pscm_two_channel_split(stereo, mono_size * 2, pcm_bit_depth, out_left, out_right,
+				     &output_size);
+	ZEQ(ret, 0);
+	ZEQ(output_size, mono_size);
+	ref_deinterleave(stereo, samples, bytes_per_sample, buf_ref_left, buf_ref_right);
+	zassert_mem_equal(out_left, buf_ref_left, output_size, "Split, %u bits, %zu samples",
+			  pcm_bit_depth, samples);
+	zassert_mem_equal(out_right, buf_ref_right, output_size, "Split, %u bits, %zu samples",
+			  pcm_bit_depth, samples);
+}
+
+void test_pscm_bit_exact(void)
+{
+	/* All lengths, and buffers aligned to a word or only to a byte */
+	for (size_t i = 0; i < ARRAY_SIZE(bit_depths); i++) {
+		for (size_t samples = 1; samples <= MAX_SAMPLES; samples++) {
+			bit_exact_check(bit_depths[i], samples, 0);
+			bit_exact_check(bit_depths[i], samples, 1);
+		}
+	}
+}
+
+void test_pscm_invalid_channel(void)
+{
+	size_t output_size;
+	int ret;
+
+	ret = pscm_zero_pad(unpadded_left, sizeof(unpadded_left), AUDIO_CH_NUM, 16, buf_out_left,
+			    &output_size);
+	ZEQ(ret, -EINVAL);
+
+	ret = pscm_one_channel_split(stereo_split, sizeof(stereo_split), AUDIO_CH_NUM, 16,
+				     buf_out_left, &output_size);
+	ZEQ(ret, -EINVAL);
+}
+
+#if defined(CONFIG_TIMING_FUNCTIONS)
+static uint32_t benchmark_op(size_t op, uint8_t pcm_bit_depth, size_t mono_size, bool ref)
+{
+	uint8_t bytes_per_sample = pcm_bit_depth / 8;
+	size_t samples = mono_size / bytes_per_sample;
+	size_t output_size;
+	timing_t start = timing_counter_get();
+
+	for (size_t i = 0; i < BENCHMARK_ITERATIONS; i++) {
+		switch (op) {
+		case 0:
+			if (ref) {
+				ref_interleave(buf_left, NULL, samples, bytes_per_sample,
+					       buf_out_left);
+			} else {
+				(void)pscm_zero_pad(buf_left, mono_size, AUDIO_CH_L,
+						    pcm_bit_depth, buf_out_left, &output_size);
+			}
+			break;
+		case 1:
+			if (ref) {
+				ref_interleave(buf_left, buf_left, samples, bytes_per_sample,
+					       buf_out_left);
+			} else {
+				(void)pscm_copy_pad(buf_left, mono_size, pcm_bit_depth,
+						    buf_out_left, &output_size);
+			}
+			break;
+		case 2:
+			if (ref) {
+				ref_interleave(buf_left, buf_right, samples, bytes_per_sample,
+					       buf_out_left);
+			} else {
+				(void)pscm_combine(buf_left, buf_right, mono_size, pcm_bit_depth,
+						   buf_out_left, &output_size);
+			}
+			break;
+		case 3:
+			if (ref) {
+				ref_deinterleave(buf_stereo, samples, bytes_per_sample,
+						 buf_out_left, NULL);
+			} else {
+				(void)pscm_one_channel_split(buf_stereo, mono_size * 2,
+							     AUDIO_CH_L, pcm_bit_depth,
+							     buf_out_left, &output_size);
+			}
+			break;
+		default:
+			if (ref) {
+				ref_deinterleave(buf_stereo, samples, bytes_per_sample,
+						 buf_out_left, buf_out_right);
+			} else {
+				(void)pscm_two_channel_split(buf_stereo, mono_size * 2,
+							     pcm_bit_depth, buf_out_left,
+							     buf_out_right, &output_size);
+			}
+			break;
+		}
+	}
+
+	timing_t end = timing_counter_get();
+
+	return timing_cycles_get(&start, &end) / BENCHMARK_ITERATIONS;
+}
+#endif /* defined(CONFIG_TIMING_FUNCTIONS) */
+
+/* Prints the time the modifiers and the references take for one 10 ms frame */
+void test_pscm_benchmark(void)
+{
+#if defined(CONFIG_TIMING_FUNCTIONS)
+	static const char *const op_names[] = {
+		"zero pad", "copy pad", "combine", "one channel split", "two channel split",
+	};
+
+	timing_init();
+	timing_start();
+
+	random_fill(buf_left, sizeof(buf_left));
+	random_fill(buf_right, sizeof(buf_right));
+	random_fill(buf_stereo, sizeof(buf_stereo));
+
+	for (size_t i = 0; i < ARRAY_SIZE(bit_depths); i++) {
+		size_t mono_size = 480 * (bit_depths[i] / 8);
+
+		for (size_t op = 0; op < ARRAY_SIZE(op_names); op++) {
+			uint32_t cycles = benchmark_op(op, bit_depths[i], mono_size, false);
+			uint32_t ref_cycles = benchmark_op(op, bit_depths[i], mono_size, true);
+
+			TC_PRINT("%-17s %u bits %6u cycles (%6u ns) per frame, "
+				 "reference %6u cycles\n", op_names[op], bit_depths[i], cycles,
+				 (uint32_t)timing_cycles_to_ns(cycles), ref_cycles);
+		}
+	}
+
+	timing_stop();
+#else
+	ztest_test_skip();
+#endif
+}
+
 void test_main(void)
 {
 	ztest_test_suite(test_suite_pscm,
@@ -318,7 +582,10 @@ void test_main(void)
 		ztest_unit_test(test_pscm_copy_pad_32),
 		ztest_unit_test(test_pscm_combine_32),
 		ztest_unit_test(test_pscm_one_channel_split_32),
-		ztest_unit_test(test_pscm_two_channel_split_32)
+		ztest_unit_test(test_pscm_two_channel_split_32),
+		ztest_unit_test(test_pscm_bit_exact),
+		ztest_unit_test(test_pscm_invalid_channel),
+		ztest_unit_test(test_pscm_benchmark)
 	);
 
 	ztest_run_test_suite(test_suite_pscm);
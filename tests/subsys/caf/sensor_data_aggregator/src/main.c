@@ -58,6 +58,7 @@ static void test_basic(void)
 
 		zassert_not_null(se, "Failed to allocate event");
 		se->descr = BASIC_TEST_AGG_DESCR;
+		se->format = (struct sensor_sample_format){0};
 		se->dyndata.size = sizeof(struct sensor_value) * BASIC_TEST_SENSOR_SAMPLE_SIZE;
 		APP_EVENT_SUBMIT(se);
 		k_yield();
@@ -85,6 +86,7 @@ static void test_order(void)
 
 		zassert_not_null(se, "Failed to allocate event");
 		se->descr = ORDER_TEST_AGG_DESCR;
+		se->format = (struct sensor_sample_format){0};
 		se->dyndata.size = sizeof(struct sensor_value) * ORDER_TEST_SENSOR_SAMPLE_SIZE;
 		se->dyndata.data[0] = i;
 		APP_EVENT_SUBMIT(se);
@@ -100,6 +102,79 @@ static void test_status(void)
 	test_start(TEST_STATUS);
 }
 
+static void test_batch(void)
+{
+	cur_test_id = TEST_BATCH;
+	struct test_start_event *ts = new_test_start_event();
+
+	zassert_not_null(ts, "Failed to allocate event");
+	ts->test_id = cur_test_id;
+	APP_EVENT_SUBMIT(ts);
+
+	const size_t sample_size = sizeof(struct sensor_value) * BATCH_TEST_SENSOR_SAMPLE_SIZE;
+	size_t i = SAMPLES_IN_AGG_BUF * BATCH_TEST_AGG_EVENTS;
+
+	/* Batches are not aligned to the aggregator buffer on purpose. */
+	while (i > 0) {
+		size_t sample_cnt = MIN(i, BATCH_TEST_SAMPLES_PER_EVENT);
+		struct sensor_event *se = new_sensor_event(sample_size * sample_cnt);
+
+		zassert_not_null(se, "Failed to allocate event");
+		se->descr = BATCH_TEST_AGG_DESCR;
+		se->format = (struct sensor_sample_format){0};
+		se->dyndata.size = sample_size * sample_cnt;
+		for (size_t j = 0; j < sample_cnt; j++) {
+			se->dyndata.data[j * sample_size] = i;
+			i--;
+		}
+		zassert_equal(sensor_event_get_sample_cnt(se, BATCH_TEST_SENSOR_SAMPLE_SIZE),
+			      sample_cnt, "Wrong number of samples in event");
+		APP_EVENT_SUBMIT(se);
+	}
+
+	int err = k_sem_take(&test_end_sem, K_SECONDS(30));
+
+	zassert_ok(err, "Test execution hanged");
+}
+
+static void test_format(void)
+{
+	cur_test_id = TEST_FORMAT;
+	struct test_start_event *ts = new_test_start_event();
+
+	zassert_not_null(ts, "Failed to allocate event");
+	ts->test_id = cur_test_id;
+	APP_EVENT_SUBMIT(ts);
+
+	const struct sensor_sample_format q15 = SENSOR_SAMPLE_FORMAT_Q15(FORMAT_TEST_FRAC_BITS);
+	const struct sensor_sample_format other_formats[] = {
+		{0},
+		SENSOR_SAMPLE_FORMAT_Q15(FORMAT_TEST_FRAC_BITS + 1),
+	};
+
+	/* Events in other formats are interleaved and must be rejected. */
+	for (size_t i = SAMPLES_IN_AGG_BUF; i > 0; i--) {
+		struct sensor_event *se = new_sensor_event(sizeof(int16_t));
+
+		zassert_not_null(se, "Failed to allocate event");
+		se->descr = FORMAT_TEST_AGG_DESCR;
+		se->format = q15;
+		*(int16_t *)se->dyndata.data = i;
+		APP_EVENT_SUBMIT(se);
+
+		se = new_sensor_event(sizeof(int16_t));
+		zassert_not_null(se, "Failed to allocate event");
+		se->descr = FORMAT_TEST_AGG_DESCR;
+		se->format = other_formats[i % ARRAY_SIZE(other_formats)];
+		*(int16_t *)se->dyndata.data = INT16_MAX;
+		APP_EVENT_SUBMIT(se);
+	}
+
+	int err = k_sem_take(&test_end_sem, K_SECONDS(30));
+
+	zassert_ok(err, "Test execution hanged");
+}
+
 void test_main(void)
 {
 	ztest_test_suite(caf_sensor_aggregator_tests,
@@ -107,7 +182,9 @@ void test_main(void)
 			 ztest_unit_test(test_event_manager),
 			 ztest_unit_test(test_basic),
 			 ztest_unit_test(test_order),
-			 ztest_unit_test(test_status)
+			 ztest_unit_test(test_status),
+			 ztest_unit_test(test_batch),
+			 ztest_unit_test(test_format)
 
 			 );
 
@@ -40,6 +40,16 @@ static bool app_event_handler(const struct app_event_header *aeh)
 			break;
 		}
 
+		case TEST_BATCH:
+		{
+			break;
+		}
+
+		case TEST_FORMAT:
+		{
+			break;
+		}
+
 		case TEST_STATUS:
 		{
 			for (size_t i = 0; i < STATUS_TEST_SENSOR_EVENTS; i++) {
@@ -49,6 +59,7 @@ static bool app_event_handler(const struct app_event_header *aeh)
 
 				zassert_not_null(se, "Failed to allocate event");
 				se->descr = STATUS_TEST_AGG_DESCR;
+				se->format = (struct sensor_sample_format){0};
 				se->dyndata.size = sizeof(struct sensor_value) *
 					STATUS_TEST_SENSOR_SAMPLE_SIZE;
 				se->dyndata.data[0] = i;
@@ -13,6 +13,12 @@
 #define BASIC_TEST_AGG_EVENTS 80
 #define ORDER_TEST_AGG_EVENTS 2
 #define STATUS_TEST_SENSOR_EVENTS 4
+#define BATCH_TEST_SENSOR_SAMPLE_SIZE 1
+#define BATCH_TEST_SAMPLES_PER_EVENT 3
+#define BATCH_TEST_AGG_EVENTS 2
+#define FORMAT_TEST_FRAC_BITS 10
 #define BASIC_TEST_AGG_DESCR "void_basic_test_sensor"
 #define ORDER_TEST_AGG_DESCR "void_order_test_sensor"
 #define STATUS_TEST_AGG_DESCR "void_status_test_sensor"
+#define BATCH_TEST_AGG_DESCR "void_batch_test_sensor"
+#define FORMAT_TEST_AGG_DESCR "void_format_test_sensor"
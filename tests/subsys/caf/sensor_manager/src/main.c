@@ -0,0 +1,195 @@
+/*
+ * Copyright (c) 2022 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include <ztest.h>
+#include <app_event_manager.h>
+#include <caf/events/sensor_event.h>
+
+#define MODULE main
+#include <caf/events/module_state_event.h>
+
+#include "sim_sensor.h"
+#include "test_config.h"
+
+#define MEASUREMENT_TIME_MS	1000
+#define COALESCE_WINDOW_MS	CONFIG_CAF_SENSOR_MANAGER_COALESCE_WINDOW_MS
+
+struct sensor_result {
+	uint32_t event_cnt;
+	uint32_t sample_cnt;
+	int32_t last_value;
+	bool gap;
+};
+
+struct sim_sensor_test {
+	const struct device *dev;
+	const char *descr;
+	unsigned int period_ms;
+	uint8_t samples_per_event;
+	bool fifo;
+	struct sensor_result result;
+};
+
+#define SIM_SENSOR_TEST(_node, _descr, _period, _samples_per_event, _fifo)	\
+	{									\
+		.dev = DEVICE_DT_GET(DT_NODELABEL(_node)),			\
+		.descr = _descr,						\
+		.period_ms = _period,						\
+		.samples_per_event = _samples_per_event,			\
+		.fifo = _fifo,							\
+		.result.last_value = -1,					\
+	},
+
+static struct sim_sensor_test sensors[] = {
+	SIM_SENSOR_FOREACH(SIM_SENSOR_TEST)
+};
+
+static struct sensor_result results[ARRAY_SIZE(sensors)];
+static struct sim_sensor_stats stats[ARRAY_SIZE(sensors)];
+static uint32_t read_time_cnt;
+
+
+static void test_init(void)
+{
+	zassert_ok(app_event_manager_init(), "Error when initializing");
+}
+
+static void test_sampling(void)
+{
+	for (size_t i = 0; i < ARRAY_SIZE(sensors); i++) {
+		zassert_true(device_is_ready(sensors[i].dev), "Sensor not ready");
+		sim_sensor_start(sensors[i].dev, sensors[i].period_ms, sensors[i].fifo);
+	}
+
+	module_set_state(MODULE_STATE_READY);
+	k_sleep(K_MSEC(MEASUREMENT_TIME_MS));
+
+	/* Sensor manager thread and event processing must not change the results
+	 * while they are copied.
+	 */
+	k_sched_lock();
+	for (size_t i = 0; i < ARRAY_SIZE(sensors); i++) {
+		results[i] = sensors[i].result;
+		sim_sensor_stats_get(sensors[i].dev, &stats[i]);
+	}
+	read_time_cnt = sim_sensor_read_time_cnt();
+	k_sched_unlock();
+
+	printk("%-16s %8s %8s %8s\n", "sensor", "reads/s", "samples/s", "events/s");
+
+	for (size_t i = 0; i < ARRAY_SIZE(sensors); i++) {
+		const struct sim_sensor_test *s = &sensors[i];
+		const struct sensor_result *r = &results[i];
+		uint32_t expected_samples = MEASUREMENT_TIME_MS / s->period_ms;
+		uint32_t expected_reads = expected_samples / (s->fifo ? s->samples_per_event : 1);
+
+		printk("%-16s %8u %8u %8u\n", s->descr, stats[i].read_cnt,
+		       r->sample_cnt, r->event_cnt);
+
+		zassert_within(stats[i].read_cnt, expected_reads, 1,
+			       "%s: wrong number of sensor reads", s->descr);
+		zassert_equal(stats[i].overrun_cnt, 0, "%s: FIFO overrun", s->descr);
+
+		/* Samples of an unfinished batch are not yet submitted. */
+		zassert_true(r->sample_cnt <= expected_samples + 1,
+			     "%s: too many samples", s->descr);
+		zassert_true(r->sample_cnt + s->samples_per_event + 1 >= expected_samples,
+			     "%s: samples missing", s->descr);
+		zassert_equal(r->sample_cnt, r->event_cnt * s->samples_per_event,
+			      "%s: wrong number of samples per event", s->descr);
+
+		if (s->fifo) {
+			zassert_false(r->gap, "%s: samples lost", s->descr);
+		}
+	}
+}
+
+static void test_coalescing(void)
+{
+	uint32_t deadline_cnt = 0;
+
+	if (COALESCE_WINDOW_MS == 0) {
+		ztest_test_skip();
+	}
+
+	for (size_t i = 0; i < ARRAY_SIZE(sensors); i++) {
+		const struct sim_sensor_test *s = &sensors[i];
+
+		printk("%-16s jitter: %d..%d ms\n", s->descr, stats[i].jitter_min,
+		       stats[i].jitter_max);
+
+		/* Sensor is sampled at most the coalescing window too early. */
+		zassert_true(stats[i].jitter_min >= -COALESCE_WINDOW_MS,
+			     "%s: sampled too early", s->descr);
+		zassert_true(stats[i].jitter_max <= 1, "%s: sampled too late", s->descr);
+	}
+
+	/* Number of separate sampling deadlines of all of the sensors. */
+	for (uint32_t t = 1; t <= MEASUREMENT_TIME_MS; t++) {
+		for (size_t i = 0; i < ARRAY_SIZE(sensors); i++) {
+			if ((t % sensors[i].period_ms) == 0) {
+				deadline_cnt++;
+				break;
+			}
+		}
+	}
+
+	printk("sampling deadlines: %u, sensor read times: %u\n", deadline_cnt, read_time_cnt);
+
+	zassert_true(read_time_cnt < deadline_cnt, "Sampling deadlines not coalesced");
+}
+
+void test_main(void)
+{
+	ztest_test_suite(caf_sensor_manager_tests,
+			 ztest_unit_test(test_init),
+			 ztest_unit_test(test_sampling),
+			 ztest_unit_test(test_coalescing)
+			 );
+
+	ztest_run_test_suite(caf_sensor_manager_tests);
+}
+
+static void handle_sensor_event(const struct sensor_event *event)
+{
+	for (size_t i = 0; i < ARRAY_SIZE(sensors); i++) {
+		struct sim_sensor_test *s = &sensors[i];
+
+		if (strcmp(event->descr, s->descr)) {
+			continue;
+		}
+
+		size_t sample_cnt = sensor_event_get_sample_cnt(event, 1);
+		const struct sensor_value *data = sensor_event_get_data_ptr(event);
+
+		for (size_t j = 0; j < sample_cnt; j++) {
+			if (data[j].val1 != s->result.last_value + 1) {
+				s->result.gap = true;
+			}
+			s->result.last_value = data[j].val1;
+		}
+
+		s->result.event_cnt++;
+		s->result.sample_cnt += sample_cnt;
+		return;
+	}
+
+	zassert_unreachable("Unknown sensor");
+}
+
+static bool app_event_handler(const struct app_event_header *aeh)
+{
+	if (is_sensor_event(aeh)) {
+		handle_sensor_event(cast_sensor_event(aeh));
+		return false;
+	}
+
+	zassert_unreachable("Wrong event type received");
+	return false;
+}
+
+APP_EVENT_LISTENER(test_main, app_event_handler);
+APP_EVENT_SUBSCRIBE(test_main, sensor_event);
@@ -0,0 +1,41 @@
+/*
+ * Copyright (c) 2022 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include <caf/sensor_manager.h>
+
+#include "test_config.h"
+
+/* This configuration file is included only once from sensor_manager module and holds
+ * information about the sampled sensors.
+ */
+
+/* This structure enforces the header file is included only once in the build.
+ * Violating this requirement triggers a multiple definition error at link time.
+ */
+const struct {} sensor_manager_def_include_once;
+
+static const struct sm_sampled_channel sim_chan[] = {
+	{
+		.chan = SENSOR_CHAN_AMBIENT_TEMP,
+		.data_cnt = 1,
+	},
+};
+
+#define SIM_SENSOR_CONFIG(_node, _descr, _period, _samples_per_event, _fifo)	\
+	{									\
+		.dev = DEVICE_DT_GET(DT_NODELABEL(_node)),			\
+		.event_descr = _descr,						\
+		.chans = sim_chan,						\
+		.chan_cnt = ARRAY_SIZE(sim_chan),				\
+		.sampling_period_ms = _period,					\
+		.active_events_limit = ACTIVE_EVENTS_LIMIT,			\
+		.samples_per_event = _samples_per_event,			\
+		.fifo = _fifo,							\
+	},
+
+static const struct sm_sensor_config sensor_configs[] = {
+	SIM_SENSOR_FOREACH(SIM_SENSOR_CONFIG)
+};
@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) 2022 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/drivers/sensor.h>
+#include <drivers/sensor_stub.h>
+
+#include "sim_sensor.h"
+
+#define SIM_SENSOR_CNT	DT_NUM_INST_STATUS_OKAY(nordic_sensor_stub)
+
+struct sim_sensor {
+	unsigned int period_ms;
+	bool fifo;
+	int64_t start_time;
+	int64_t last_read_time;
+	uint32_t read_idx;
+	int32_t value;
+	struct sim_sensor_stats stats;
+};
+
+static struct sim_sensor sim_sensors[SIM_SENSOR_CNT];
+static size_t sim_sensor_cnt;
+static int64_t last_read_time = -1;
+static uint32_t read_time_cnt;
+
+
+int sim_sensor_init(const struct device *dev)
+{
+	if (sim_sensor_cnt >= ARRAY_SIZE(sim_sensors)) {
+		return -ENOMEM;
+	}
+
+	sensor_stub_udata_set(dev, &sim_sensors[sim_sensor_cnt]);
+	sim_sensor_cnt++;
+
+	return 0;
+}
+
+int sim_sensor_fetch(const struct device *dev, enum sensor_channel chan)
+{
+	struct sim_sensor *sim = sensor_stub_udata_get(dev);
+	int64_t now = k_uptime_get();
+
+	__ASSERT_NO_MSG(sim->period_ms > 0);
+
+	uint32_t produced = (now - sim->start_time) / sim->period_ms;
+
+	if (now != sim->last_read_time) {
+		/* Offset from the nearest point of the sampling period grid. */
+		int32_t offset = (now - sim->start_time) % sim->period_ms;
+		int32_t jitter = (offset <= sim->period_ms / 2) ? offset :
+				 (offset - (int32_t)sim->period_ms);
+
+		if (sim->stats.read_cnt == 0) {
+			sim->stats.jitter_min = jitter;
+			sim->stats.jitter_max = jitter;
+		} else {
+			sim->stats.jitter_min = MIN(sim->stats.jitter_min, jitter);
+			sim->stats.jitter_max = MAX(sim->stats.jitter_max, jitter);
+		}
+
+		sim->last_read_time = now;
+		sim->stats.read_cnt++;
+	}
+
+	if (now != last_read_time) {
+		last_read_time = now;
+		read_time_cnt++;
+	}
+
+	if (sim->fifo) {
+		if ((produced - sim->read_idx) > SIM_SENSOR_FIFO_SIZE) {
+			uint32_t lost = produced - sim->read_idx - SIM_SENSOR_FIFO_SIZE;
+
+			sim->stats.overrun_cnt += lost;
+			sim->read_idx += lost;
+		}
+
+		if (sim->read_idx == produced) {
+			return -ENODATA;
+		}
+
+		sim->value = sim->read_idx;
+		sim->read_idx++;
+	} else {
+		sim->value = produced;
+	}
+
+	sim->stats.sample_cnt++;
+
+	return 0;
+}
+
+int sim_sensor_get(const struct device *dev, enum sensor_channel chan,
+		   struct sensor_value *val)
+{
+	struct sim_sensor *sim = sensor_stub_udata_get(dev);
+
+	val->val1 = sim->value;
+	val->val2 = 0;
+
+	return 0;
+}
+
+void sim_sensor_start(const struct device *dev, unsigned int period_ms, bool fifo)
+{
+	struct sim_sensor *sim = sensor_stub_udata_get(dev);
+
+	memset(sim, 0, sizeof(*sim));
+	sim->period_ms = period_ms;
+	sim->fifo = fifo;
+	sim->start_time = k_uptime_get();
+	sim->last_read_time = -1;
+}
+
+void sim_sensor_stats_get(const struct device *dev, struct sim_sensor_stats *stats)
+{
+	struct sim_sensor *sim = sensor_stub_udata_get(dev);
+
+	*stats = sim->stats;
+}
+
+uint32_t sim_sensor_read_time_cnt(void)
+{
+	return read_time_cnt;
+}
@@ -0,0 +1,38 @@
+/*
+ * Copyright (c) 2022 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#ifndef _SIM_SENSOR_H_
+#define _SIM_SENSOR_H_
+
+#include <zephyr/device.h>
+
+/* Simulated sensor that produces a sample every sampling period. The value of
+ * a sample is its sequence number. A sensor with FIFO returns the buffered
+ * samples one by one and -ENODATA once the FIFO is empty. A sensor without FIFO
+ * returns the latest sample.
+ */
+
+#define SIM_SENSOR_FIFO_SIZE	32
+
+struct sim_sensor_stats {
+	/* Number of sensor fetches that returned a sample. */
+	uint32_t sample_cnt;
+	/* Number of separate points in time the sensor was accessed at. */
+	uint32_t read_cnt;
+	/* Number of samples lost because the FIFO was full. */
+	uint32_t overrun_cnt;
+	/* Range of the read time offsets from the sampling period grid [ms]. */
+	int32_t jitter_min;
+	int32_t jitter_max;
+};
+
+void sim_sensor_start(const struct device *dev, unsigned int period_ms, bool fifo);
+void sim_sensor_stats_get(const struct device *dev, struct sim_sensor_stats *stats);
+
+/* Number of separate points in time any of the sensors was accessed at. */
+uint32_t sim_sensor_read_time_cnt(void);
+
+#endif /* _SIM_SENSOR_H_ */
@@ -0,0 +1,38 @@
+/*
+ * Copyright (c) 2022 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#ifndef _TEST_CONFIG_H_
+#define _TEST_CONFIG_H_
+
+#define SAMPLES_PER_BATCH	8
+#define ACTIVE_EVENTS_LIMIT	10
+
+/* Parameters: node label, description, sampling period [ms], samples per event, FIFO. */
+#if CONFIG_CAF_SENSOR_MANAGER_COALESCE_WINDOW_MS > 0
+/* Sampling periods are not harmonic, the deadlines of the sensors are close
+ * to each other.
+ */
+#define SIM_SENSOR_FOREACH(fn)						\
+	fn(sim0, "sim_10ms", 10, 1, false)				\
+	fn(sim1, "sim_11ms", 11, 1, false)				\
+	fn(sim2, "sim_13ms", 13, 1, false)
+#else
+/* Every sampling frequency is used for a sensor that submits an event per sample,
+ * a sensor that gathers the samples in batches and a sensor with FIFO.
+ */
+#define SIM_SENSOR_FOREACH(fn)						\
+	fn(sim0, "sim_50hz", 20, 1, false)				\
+	fn(sim1, "sim_50hz_batch", 20, SAMPLES_PER_BATCH, false)	\
+	fn(sim2, "sim_50hz_fifo", 20, SAMPLES_PER_BATCH, true)		\
+	fn(sim3, "sim_100hz", 10, 1, false)				\
+	fn(sim4, "sim_100hz_batch", 10, SAMPLES_PER_BATCH, false)	\
+	fn(sim5, "sim_100hz_fifo", 10, SAMPLES_PER_BATCH, true)		\
+	fn(sim6, "sim_500hz", 2, 1, false)				\
+	fn(sim7, "sim_500hz_batch", 2, SAMPLES_PER_BATCH, false)	\
+	fn(sim8, "sim_500hz_fifo", 2, SAMPLES_PER_BATCH, true)
+#endif
+
+#endif /* _TEST_CONFIG_H_ */
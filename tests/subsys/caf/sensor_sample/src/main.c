@@ -0,0 +1,223 @@
+/*
+ * Copyright (c) 2022 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include <stdlib.h>
+#include <ztest.h>
+#include <caf/sensor_sample.h>
+
+#ifdef CONFIG_TIMING_FUNCTIONS
+#include <zephyr/timing/timing.h>
+#endif /* CONFIG_TIMING_FUNCTIONS */
+
+#define FRAC_BITS 10
+#define FLOAT_EPSILON 0.001f
+
+/* 128 samples of a three axis accelerometer. */
+#define BENCHMARK_VALUE_CNT (128 * 3)
+
+static const struct sensor_value values[] = {
+	{ .val1 = 1, .val2 = 500000 },
+	{ .val1 = -2, .val2 = -250000 },
+	{ .val1 = 100, .val2 = 0 },
+	{ .val1 = -100, .val2 = 0 },
+	{ .val1 = 0, .val2 = 976 },
+};
+
+static void test_from_sensor_value_q15(void)
+{
+	const struct sensor_sample_format format = SENSOR_SAMPLE_FORMAT_Q15(FRAC_BITS);
+	const int16_t expected[] = { 1536, -2304, INT16_MAX, INT16_MIN, 1 };
+	int16_t out[ARRAY_SIZE(values)];
+
+	zassert_equal(sensor_sample_size(&format), sizeof(int16_t), "Wrong sample size");
+
+	sensor_sample_from_sensor_value(&format, values, out, ARRAY_SIZE(values));
+
+	for (size_t i = 0; i < ARRAY_SIZE(values); i++) {
+		zassert_equal(out[i], expected[i], "Wrong value at %zu: %d", i, out[i]);
+	}
+}
+
+static void test_from_sensor_value_q31(void)
+{
+	const struct sensor_sample_format format = SENSOR_SAMPLE_FORMAT_Q31(FRAC_BITS);
+	const int32_t expected[] = { 1536, -2304, 102400, -102400, 1 };
+	int32_t out[ARRAY_SIZE(values)];
+
+	zassert_equal(sensor_sample_size(&format), sizeof(int32_t), "Wrong sample size");
+
+	sensor_sample_from_sensor_value(&format, values, out, ARRAY_SIZE(values));
+
+	for (size_t i = 0; i < ARRAY_SIZE(values); i++) {
+		zassert_equal(out[i], expected[i], "Wrong value at %zu: %d", i, out[i]);
+	}
+}
+
+static void test_to_float(void)
+{
+	const struct sensor_sample_format q15 = SENSOR_SAMPLE_FORMAT_Q15(FRAC_BITS);
+	const struct sensor_sample_format q31 = SENSOR_SAMPLE_FORMAT_Q31(FRAC_BITS);
+	const struct sensor_sample_format sv = {0};
+	const float expected[] = { 1.5f, -2.25f, 100.0f, -100.0f, 0.000976f };
+	int16_t q15_data[ARRAY_SIZE(values)];
+	int32_t q31_data[ARRAY_SIZE(values)];
+	float out[ARRAY_SIZE(values)];
+
+	sensor_sample_to_float(&sv, values, out, ARRAY_SIZE(values));
+	for (size_t i = 0; i < ARRAY_SIZE(values); i++) {
+		zassert_within(out[i], expected[i], FLOAT_EPSILON, "Wrong value at %zu", i);
+	}
+
+	sensor_sample_from_sensor_value(&q31, values, q31_data, ARRAY_SIZE(values));
+	sensor_sample_to_float(&q31, q31_data, out, ARRAY_SIZE(values));
+	for (size_t i = 0; i < ARRAY_SIZE(values); i++) {
+		zassert_within(out[i], expected[i], FLOAT_EPSILON, "Wrong value at %zu", i);
+	}
+
+	/* Skip the values saturated in Q15. */
+	sensor_sample_from_sensor_value(&q15, values, q15_data, ARRAY_SIZE(values));
+	sensor_sample_to_float(&q15, q15_data, out, ARRAY_SIZE(values));
+	zassert_within(out[0], expected[0], FLOAT_EPSILON, "Wrong value");
+	zassert_within(out[1], expected[1], FLOAT_EPSILON, "Wrong value");
+	zassert_within(out[4], expected[4], FLOAT_EPSILON, "Wrong value");
+}
+
+static void test_to_q15(void)
+{
+	const struct sensor_sample_format q31 = SENSOR_SAMPLE_FORMAT_Q31(FRAC_BITS);
+	const int16_t expected[] = { 48, -72, 3200, -3200, 0 };
+	int32_t q31_data[ARRAY_SIZE(values)];
+	int16_t out[ARRAY_SIZE(values)];
+
+	sensor_sample_from_sensor_value(&q31, values, q31_data, ARRAY_SIZE(values));
+	sensor_sample_to_q15(&q31, q31_data, out, ARRAY_SIZE(values), 5);
+
+	for (size_t i = 0; i < ARRAY_SIZE(values); i++) {
+		zassert_equal(out[i], expected[i], "Wrong value at %zu: %d", i, out[i]);
+	}
+}
+
+static void test_delta(void)
+{
+	const int16_t data[] = { 0, 10, 5, INT16_MAX, INT16_MIN, -1, -1, 300 };
+	int16_t encoded[ARRAY_SIZE(data)];
+	int16_t decoded[ARRAY_SIZE(data)];
+
+	sensor_sample_q15_delta_encode(data, encoded, ARRAY_SIZE(data));
+	zassert_equal(encoded[0], data[0], "First value must be copied");
+	zassert_equal(encoded[2], -5, "Wrong delta");
+	zassert_equal(encoded[6], 0, "Wrong delta");
+
+	sensor_sample_q15_delta_decode(encoded, decoded, ARRAY_SIZE(data));
+	zassert_mem_equal(decoded, data, sizeof(data), "Delta encoding is not lossless");
+
+	/* In place. */
+	memcpy(decoded, data, sizeof(data));
+	sensor_sample_q15_delta_encode(decoded, decoded, ARRAY_SIZE(data));
+	zassert_mem_equal(decoded, encoded, sizeof(encoded), "In place encoding differs");
+	sensor_sample_q15_delta_decode(decoded, decoded, ARRAY_SIZE(data));
+	zassert_mem_equal(decoded, data, sizeof(data), "In place decoding differs");
+}
+
+#ifdef CONFIG_TIMING_FUNCTIONS
+static uint64_t benchmark_ns(timing_t start, timing_t end)
+{
+	return timing_cycles_to_ns(timing_cycles_get(&start, &end));
+}
+
+static void benchmark_report(const char *name, size_t value_size, uint64_t ns)
+{
+	printk("%-36s %2zu B/value %8u ns/%u values\n", name, value_size, (unsigned int)ns,
+	       BENCHMARK_VALUE_CNT);
+}
+#endif /* CONFIG_TIMING_FUNCTIONS */
+
+static void test_benchmark(void)
+{
+#ifdef CONFIG_TIMING_FUNCTIONS
+	const struct sensor_sample_format sv = {0};
+	const struct sensor_sample_format q15 = SENSOR_SAMPLE_FORMAT_Q15(FRAC_BITS);
+	const struct sensor_sample_format q31 = SENSOR_SAMPLE_FORMAT_Q31(FRAC_BITS);
+	static struct sensor_value sv_data[BENCHMARK_VALUE_CNT];
+	static int16_t q15_data[BENCHMARK_VALUE_CNT];
+	static int32_t q31_data[BENCHMARK_VALUE_CNT];
+	static float expected[BENCHMARK_VALUE_CNT];
+	static float out[BENCHMARK_VALUE_CNT];
+	timing_t start;
+	timing_t end;
+
+	for (size_t i = 0; i < BENCHMARK_VALUE_CNT; i++) {
+		sv_data[i] = values[i % ARRAY_SIZE(values)];
+		/* Values out of range of Q15 are not used. */
+		if (abs(sv_data[i].val1) > 10) {
+			sv_data[i].val1 /= 100;
+		}
+	}
+	sensor_sample_from_sensor_value(&q15, sv_data, q15_data, BENCHMARK_VALUE_CNT);
+	sensor_sample_from_sensor_value(&q31, sv_data, q31_data, BENCHMARK_VALUE_CNT);
+
+	timing_init();
+	timing_start();
+
+	/* Conversion done element by element by the listeners of sensor_value samples. */
+	start = timing_counter_get();
+	for (size_t i = 0; i < BENCHMARK_VALUE_CNT; i++) {
+		expected[i] = sensor_value_to_double(&sv_data[i]);
+	}
+	end = timing_counter_get();
+	benchmark_report("sensor_value_to_double", sizeof(struct sensor_value),
+			 benchmark_ns(start, end));
+
+	start = timing_counter_get();
+	sensor_sample_to_float(&sv, sv_data, out, BENCHMARK_VALUE_CNT);
+	end = timing_counter_get();
+	benchmark_report("sensor_sample_to_float sv", sensor_sample_size(&sv),
+			 benchmark_ns(start, end));
+	for (size_t i = 0; i < BENCHMARK_VALUE_CNT; i++) {
+		zassert_within(out[i], expected[i], FLOAT_EPSILON, "Wrong value at %zu", i);
+	}
+
+	start = timing_counter_get();
+	sensor_sample_to_float(&q31, q31_data, out, BENCHMARK_VALUE_CNT);
+	end = timing_counter_get();
+	benchmark_report("sensor_sample_to_float q31", sensor_sample_size(&q31),
+			 benchmark_ns(start, end));
+
+	start = timing_counter_get();
+	sensor_sample_to_float(&q15, q15_data, out, BENCHMARK_VALUE_CNT);
+	end = timing_counter_get();
+	benchmark_report("sensor_sample_to_float q15", sensor_sample_size(&q15),
+			 benchmark_ns(start, end));
+
+	for (size_t i = 0; i < BENCHMARK_VALUE_CNT; i++) {
+		zassert_within(out[i], expected[i], FLOAT_EPSILON, "Wrong value at %zu", i);
+	}
+
+	start = timing_counter_get();
+	sensor_sample_from_sensor_value(&q15, sv_data, q15_data, BENCHMARK_VALUE_CNT);
+	end = timing_counter_get();
+	benchmark_report("sensor_sample_from_sensor_value q15", sensor_sample_size(&q15),
+			 benchmark_ns(start, end));
+
+	timing_stop();
+#else
+	ztest_test_skip();
+#endif /* CONFIG_TIMING_FUNCTIONS */
+}
+
+void test_main(void)
+{
+	ztest_test_suite(caf_sensor_sample_tests,
+			 ztest_unit_test(test_from_sensor_value_q15),
+			 ztest_unit_test(test_from_sensor_value_q31),
+			 ztest_unit_test(test_to_float),
+			 ztest_unit_test(test_to_q15),
+			 ztest_unit_test(test_delta),
+			 ztest_unit_test(test_benchmark)
+			 );
+
+	ztest_run_test_suite(caf_sensor_sample_tests);
+}
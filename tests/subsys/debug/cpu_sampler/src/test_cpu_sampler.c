@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) 2022 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+#include <ztest.h>
+#include <zephyr/kernel.h>
+#include <debug/cpu_sampler.h>
+#include <nrf_profiler.h>
+
+#define SAMPLING_RATE 1000
+#define MIN_SAMPLES 100
+#define MAX_LOOPS 100000
+#define TOP_ENTRIES 4
+/* Upper bound of the size of busy_loop() */
+#define BUSY_LOOP_MAX_SIZE 256
+
+/* Uses the CPU until enough samples are taken. The time of the system is not
+ * used, as it does not pass on POSIX architecture while the CPU is busy.
+ */
+static __noinline void busy_loop(void)
+{
+	volatile uint32_t acc = 0;
+
+	for (size_t n = 0; (n < MAX_LOOPS) && (cpu_sampler_samples_get(NULL) < MIN_SAMPLES);
+	     n++) {
+		for (uint32_t i = 0; i < 10000; i++) {
+			acc += i;
+		}
+	}
+}
+
+static void test_init(void)
+{
+	zassert_ok(nrf_profiler_init(), "Error when initializing nrf_profiler");
+}
+
+static void test_sampling(void)
+{
+	struct cpu_sampler_entry top[TOP_ENTRIES];
+	uintptr_t busy_loop_addr = (uintptr_t)busy_loop & ~1UL;
+	uint32_t samples;
+	uint32_t lost;
+	size_t cnt;
+	int err;
+
+	cpu_sampler_reset();
+
+	err = cpu_sampler_start(SAMPLING_RATE);
+	zassert_equal(err, 0, "Unexpected err:%d", err);
+
+	err = cpu_sampler_start(SAMPLING_RATE);
+	zassert_equal(err, -EALREADY, "Unexpected err:%d", err);
+
+	busy_loop();
+	cpu_sampler_stop();
+
+	samples = cpu_sampler_samples_get(&lost);
+	zassert_true(samples >= MIN_SAMPLES, "Unexpected samples:%u", samples);
+	zassert_equal(lost, 0, "Unexpected lost:%u", lost);
+
+	cnt = cpu_sampler_top_get(top, ARRAY_SIZE(top));
+	zassert_true(cnt > 0, "No histogram entries");
+
+	for (size_t i = 1; i < cnt; i++) {
+		zassert_true(top[i].count <= top[i - 1].count, "Entries not sorted");
+	}
+
+	zassert_true((top[0].pc >= busy_loop_addr) &&
+		     (top[0].pc < busy_loop_addr + BUSY_LOOP_MAX_SIZE),
+		     "Unexpected pc:0x%lx", (unsigned long)top[0].pc);
+	zassert_equal(top[0].ctx, (uintptr_t)k_current_get(), "Unexpected ctx:0x%lx",
+		      (unsigned long)top[0].ctx);
+}
+
+static void test_stop(void)
+{
+	uint32_t samples = cpu_sampler_samples_get(NULL);
+	volatile uint32_t acc = 0;
+
+	for (uint32_t i = 0; i < 10000000; i++) {
+		acc += i;
+	}
+
+	zassert_equal(cpu_sampler_samples_get(NULL), samples, "Sampled while stopped");
+}
+
+static void test_reset(void)
+{
+	struct cpu_sampler_entry top[TOP_ENTRIES];
+	uint32_t lost;
+
+	cpu_sampler_reset();
+
+	zassert_equal(cpu_sampler_samples_get(&lost), 0, "Samples not cleared");
+	zassert_equal(lost, 0, "Lost samples not cleared");
+	zassert_equal(cpu_sampler_top_get(top, ARRAY_SIZE(top)), 0, "Histogram not cleared");
+}
+
+static void test_invalid_rate(void)
+{
+	int err = cpu_sampler_start(0);
+
+	zassert_equal(err, -EINVAL, "Unexpected err:%d", err);
+}
+
+void test_main(void)
+{
+	ztest_test_suite(cpu_sampler,
+		ztest_unit_test(test_init),
+		ztest_unit_test(test_sampling),
+		ztest_unit_test(test_stop),
+		ztest_unit_test(test_reset),
+		ztest_unit_test(test_invalid_rate)
+	);
+	ztest_run_test_suite(cpu_sampler);
+}
@@ -7,8 +7,11 @@
 #include <unity.h>
 #include <zephyr.h>
 #include <stdio.h>
+#include <string.h>
 #include <net/nrf_cloud.h>
 #include <mock_nrf_cloud_transport.h>
+#include "mock_mqtt.h"
+#include "nrf_cloud_codec.h"
 #include "nrf_cloud_fsm.h"
 
 /* This is required since unity_main return int and
@@ -177,6 +180,410 @@ void test_init_fota_failed(void)
 #endif
 }
 
+/* Payload and chunk sizes used to verify streamed reception, the payload is
+ * several times larger than a chunk and not a multiple of the chunk size.
+ */
+#define STREAM_PAYLOAD_LEN 4100
+#define STREAM_CHUNK_LEN 64
+#define STREAM_TOPIC "prod/stream-test/a/gps"
+
+static uint8_t stream_payload[STREAM_PAYLOAD_LEN];
+static uint8_t stream_rx[STREAM_PAYLOAD_LEN];
+static size_t stream_rx_len;
+static uint32_t stream_total_len;
+static uint32_t stream_end_status;
+static int stream_begin_count;
+static int stream_chunk_count;
+static size_t stream_chunk_max;
+static int stream_end_count;
+static bool stream_error;
+
+static void stream_event_handler(const struct nrf_cloud_evt *const evt)
+{
+	switch (evt->type) {
+	case NRF_CLOUD_EVT_RX_DATA_BEGIN:
+		stream_begin_count++;
+		stream_total_len = evt->status;
+		stream_rx_len = 0;
+		break;
+	case NRF_CLOUD_EVT_RX_DATA_CHUNK:
+		/* Chunks must arrive in order and fit in the announced length */
+		if ((evt->status != stream_rx_len) ||
+		    (stream_rx_len + evt->data.len > sizeof(stream_rx)) ||
+		    (evt->topic.len != strlen(STREAM_TOPIC))) {
+			stream_error = true;
+			break;
+		}
+
+		memcpy(&stream_rx[stream_rx_len], evt->data.ptr, evt->data.len);
+		stream_rx_len += evt->data.len;
+		stream_chunk_count++;
+		stream_chunk_max = MAX(stream_chunk_max, evt->data.len);
+		break;
+	case NRF_CLOUD_EVT_RX_DATA_END:
+		stream_end_count++;
+		stream_end_status = evt->status;
+		break;
+	default:
+		break;
+	}
+}
+
+static void stream_init(void)
+{
+	struct nrf_cloud_init_param params = {
+		.event_handler = stream_event_handler,
+		.client_id = NULL,
+	};
+
+	stream_rx_len = 0;
+	stream_total_len = 0;
+	stream_end_status = 0;
+	stream_begin_count = 0;
+	stream_chunk_count = 0;
+	stream_chunk_max = 0;
+	stream_end_count = 0;
+	stream_error = false;
+
+	for (size_t i = 0; i < sizeof(stream_payload); i++) {
+		stream_payload[i] = (uint8_t)(i * 7 + 3);
+	}
+
+	__wrap_nct_init_ExpectAndReturn(params.client_id, 0);
+
+	TEST_ASSERT_EQUAL_MESSAGE(0, nrf_cloud_init(&params), "nrf_cloud_init should succeed");
+}
+
+/* Feed the events the transport generates for a streamed payload, stopping
+ * after stop_offset bytes with the given error.
+ */
+static void stream_feed(size_t stop_offset, int32_t err)
+{
+	struct nct_dc_data dc = {
+		.topic.ptr = STREAM_TOPIC,
+		.topic.len = strlen(STREAM_TOPIC),
+	};
+	struct nct_evt evt = {
+		.status = sizeof(stream_payload),
+		.param.dc = &dc,
+		.type = NCT_EVT_DC_RX_DATA_BEGIN,
+	};
+	size_t offset = 0;
+
+	TEST_ASSERT_EQUAL(0, nfsm_handle_incoming_event(&evt, STATE_DC_CONNECTED));
+
+	while (offset < stop_offset) {
+		dc.data.ptr = &stream_payload[offset];
+		dc.data.len = MIN(STREAM_CHUNK_LEN, stop_offset - offset);
+		evt.status = offset;
+		evt.type = NCT_EVT_DC_RX_DATA_CHUNK;
+
+		TEST_ASSERT_EQUAL(0, nfsm_handle_incoming_event(&evt, STATE_DC_CONNECTED));
+
+		offset += dc.data.len;
+	}
+
+	dc.data.ptr = NULL;
+	dc.data.len = 0;
+	evt.status = err;
+	evt.type = NCT_EVT_DC_RX_DATA_END;
+
+	TEST_ASSERT_EQUAL(0, nfsm_handle_incoming_event(&evt, STATE_DC_CONNECTED));
+}
+
+/* Verify that a payload received in chunks is forwarded to the application
+ * in order and can be reassembled
+ */
+void test_rx_stream(void)
+{
+	stream_init();
+	stream_feed(sizeof(stream_payload), 0);
+
+	TEST_ASSERT_FALSE_MESSAGE(stream_error, "chunks should be received in order");
+	TEST_ASSERT_EQUAL(1, stream_begin_count);
+	TEST_ASSERT_EQUAL(1, stream_end_count);
+	TEST_ASSERT_EQUAL(sizeof(stream_payload), stream_total_len);
+	TEST_ASSERT_EQUAL(sizeof(stream_payload), stream_rx_len);
+	TEST_ASSERT_EQUAL(0, stream_end_status);
+	TEST_ASSERT_EQUAL_MEMORY(stream_payload, stream_rx, sizeof(stream_payload));
+}
+
+/* Verify that an interrupted reception is reported to the application
+ * as a positive error code in the end event
+ */
+void test_rx_stream_aborted(void)
+{
+	stream_init();
+	stream_feed(STREAM_CHUNK_LEN * 10, -EIO);
+
+	TEST_ASSERT_FALSE_MESSAGE(stream_error, "chunks should be received in order");
+	TEST_ASSERT_EQUAL(1, stream_end_count);
+	TEST_ASSERT_EQUAL(STREAM_CHUNK_LEN * 10, stream_rx_len);
+	TEST_ASSERT_EQUAL(EIO, stream_end_status);
+}
+
+/* Pull in the MQTT event handler from the nRF Cloud transport */
+extern void nct_mqtt_evt_handler(struct mqtt_client *const mqtt_client,
+				 const struct mqtt_evt *_mqtt_evt);
+
+#define PAYLOAD_BUFFER_LEN CONFIG_NRF_CLOUD_MQTT_PAYLOAD_BUFFER_LEN
+
+/* Reads of the streamed payload from the MQTT socket, reads return at most
+ * read_max bytes and fail with read_err once read_fail_offset is reached.
+ */
+static size_t read_offset;
+static size_t read_max;
+static size_t read_fail_offset;
+static int read_err;
+
+static int mqtt_read_publish_payload_blocking_stub(struct mqtt_client *client, void *buffer,
+						   size_t length, int cmock_num_calls)
+{
+	size_t len;
+
+	ARG_UNUSED(client);
+	ARG_UNUSED(cmock_num_calls);
+
+	/* Reads must fit in the payload buffer and not go past the payload */
+	TEST_ASSERT_TRUE(length > 0);
+	TEST_ASSERT_TRUE(length <= PAYLOAD_BUFFER_LEN);
+	TEST_ASSERT_TRUE(read_offset + length <= sizeof(stream_payload));
+
+	if (read_offset >= read_fail_offset) {
+		return read_err;
+	}
+
+	len = MIN(MIN(length, read_max), read_fail_offset - read_offset);
+	memcpy(buffer, &stream_payload[read_offset], len);
+	read_offset += len;
+
+	return len;
+}
+
+/* Publish the stream payload on a data channel topic through the transport */
+static void stream_publish(size_t max, size_t fail_offset, int err)
+{
+	struct mqtt_client client;
+	struct mqtt_evt evt = {
+		.type = MQTT_EVT_PUBLISH,
+		.param.publish = {
+			.message_id = 1,
+			.message.topic.qos = MQTT_QOS_0_AT_MOST_ONCE,
+			.message.topic.topic.utf8 = (const uint8_t *)STREAM_TOPIC,
+			.message.topic.topic.size = strlen(STREAM_TOPIC),
+			.message.payload.len = sizeof(stream_payload),
+		},
+	};
+
+	read_offset = 0;
+	read_max = max;
+	read_fail_offset = fail_offset;
+	read_err = err;
+
+	__wrap_mqtt_read_publish_payload_blocking_Stub(mqtt_read_publish_payload_blocking_stub);
+
+	/* Failed reception disconnects from the cloud */
+	if (fail_offset < sizeof(stream_payload)) {
+		__wrap_nct_disconnect_ExpectAndReturn(0);
+	}
+
+	nfsm_set_current_state_and_notify(STATE_DC_CONNECTED, NULL);
+	nct_mqtt_evt_handler(&client, &evt);
+
+	/* Leave the connected state so that tearDown() does not disconnect */
+	nfsm_set_current_state_and_notify(STATE_INITIALIZED, NULL);
+
+	TEST_ASSERT_FALSE_MESSAGE(stream_error, "chunks should be received in order");
+	TEST_ASSERT_EQUAL(1, stream_begin_count);
+	TEST_ASSERT_EQUAL(1, stream_end_count);
+	TEST_ASSERT_EQUAL(sizeof(stream_payload), stream_total_len);
+	TEST_ASSERT_EQUAL(read_offset, stream_rx_len);
+	TEST_ASSERT_EQUAL_MEMORY(stream_payload, stream_rx, stream_rx_len);
+}
+
+/* Verify that a payload larger than the payload buffer is read from the
+ * socket in chunks of the buffer size
+ */
+void test_rx_stream_publish(void)
+{
+	stream_init();
+	stream_publish(SIZE_MAX, SIZE_MAX, 0);
+
+	TEST_ASSERT_EQUAL(sizeof(stream_payload), stream_rx_len);
+	TEST_ASSERT_EQUAL(DIV_ROUND_UP(sizeof(stream_payload), PAYLOAD_BUFFER_LEN),
+			  stream_chunk_count);
+	TEST_ASSERT_EQUAL(PAYLOAD_BUFFER_LEN, stream_chunk_max);
+	TEST_ASSERT_EQUAL(0, stream_end_status);
+}
+
+/* Verify that short reads are delivered as they are read, with the offset
+ * of each chunk following the previous one
+ */
+void test_rx_stream_publish_short_reads(void)
+{
+	const size_t max = PAYLOAD_BUFFER_LEN / 3;
+
+	stream_init();
+	stream_publish(max, SIZE_MAX, 0);
+
+	TEST_ASSERT_EQUAL(sizeof(stream_payload), stream_rx_len);
+	TEST_ASSERT_EQUAL(DIV_ROUND_UP(sizeof(stream_payload), max), stream_chunk_count);
+	TEST_ASSERT_EQUAL(max, stream_chunk_max);
+	TEST_ASSERT_EQUAL(0, stream_end_status);
+}
+
+/* Verify that a read returning no data ends the reception with -EIO and
+ * disconnects from the cloud
+ */
+void test_rx_stream_publish_closed(void)
+{
+	const size_t fail_offset = PAYLOAD_BUFFER_LEN * 3 + 10;
+
+	stream_init();
+	stream_publish(SIZE_MAX, fail_offset, 0);
+
+	TEST_ASSERT_EQUAL(fail_offset, stream_rx_len);
+	TEST_ASSERT_EQUAL(4, stream_chunk_count);
+	TEST_ASSERT_EQUAL(EIO, stream_end_status);
+}
+
+/* Verify that a read error ends the reception with the error and disconnects
+ * from the cloud
+ */
+void test_rx_stream_publish_read_error(void)
+{
+	const size_t fail_offset = PAYLOAD_BUFFER_LEN * 2;
+
+	stream_init();
+	stream_publish(SIZE_MAX, fail_offset, -ECONNRESET);
+
+	TEST_ASSERT_EQUAL(fail_offset, stream_rx_len);
+	TEST_ASSERT_EQUAL(2, stream_chunk_count);
+	TEST_ASSERT_EQUAL(ECONNRESET, stream_end_status);
+}
+
+#define SENSOR_DATA "23.5"
+
+/* Heap of k_malloc(), used to compare the memory held by the JSON and CBOR
+ * sensor data messages while they are published.
+ */
+extern struct k_heap _system_heap;
+
+static uint8_t sent_payload[128];
+static size_t sent_payload_len;
+static size_t sent_heap_bytes;
+
+static size_t heap_allocated_get(void)
+{
+	struct sys_memory_stats stats;
+
+	TEST_ASSERT_EQUAL(0, sys_heap_runtime_stats_get(&_system_heap.heap, &stats));
+	return stats.allocated_bytes;
+}
+
+static int nct_dc_publish_stub(const struct nct_dc_data *dc_data, int cmock_num_calls)
+{
+	ARG_UNUSED(cmock_num_calls);
+
+	TEST_ASSERT_TRUE(dc_data->data.len <= sizeof(sent_payload));
+
+	memcpy(sent_payload, dc_data->data.ptr, dc_data->data.len);
+	sent_payload_len = dc_data->data.len;
+	sent_heap_bytes = heap_allocated_get();
+
+	return 0;
+}
+
+/* Send the sensor data in the connected state and check the published
+ * message against the encoder of the selected format.
+ */
+static void sensor_data_send_check(bool stream)
+{
+	const struct nrf_cloud_sensor_data param = {
+		.type = NRF_CLOUD_SENSOR_TEMP,
+		.data.ptr = SENSOR_DATA,
+		.data.len = strlen(SENSOR_DATA),
+		.tag = NCT_MSG_ID_USE_NEXT_INCREMENT,
+	};
+	struct nrf_cloud_init_param params = {
+		.event_handler = event_handler,
+		.client_id = NULL,
+	};
+	uint8_t expected[sizeof(sent_payload)];
+	size_t expected_len;
+	size_t heap_bytes;
+	uint32_t cycles;
+	int err;
+
+	__wrap_nct_init_ExpectAndReturn(params.client_id, 0);
+	TEST_ASSERT_EQUAL(0, nrf_cloud_init(&params));
+	nfsm_set_current_state_and_notify(STATE_DC_CONNECTED, NULL);
+
+	if (stream) {
+		__wrap_nct_dc_stream_Stub(nct_dc_publish_stub);
+	} else {
+		__wrap_nct_dc_send_Stub(nct_dc_publish_stub);
+	}
+
+	sent_payload_len = 0;
+	heap_bytes = heap_allocated_get();
+	cycles = k_cycle_get_32();
+
+	if (stream) {
+		err = nrf_cloud_sensor_data_stream(&param);
+	} else {
+		err = nrf_cloud_sensor_data_send(&param);
+	}
+
+	cycles = k_cycle_get_32() - cycles;
+
+	/* Leave the connected state so that tearDown() does not disconnect */
+	nfsm_set_current_state_and_notify(STATE_INITIALIZED, NULL);
+
+	TEST_ASSERT_EQUAL(0, err);
+	TEST_ASSERT_NOT_EQUAL(0, sent_payload_len);
+	TEST_ASSERT_EQUAL_MESSAGE(heap_bytes, heap_allocated_get(), "message should be freed");
+
+	printk("Sensor data %s, %s: %u cycles, %zu heap bytes, %zu bytes out\n",
+	       stream ? "stream" : "send",
+	       IS_ENABLED(CONFIG_NRF_CLOUD_MQTT_SENSOR_DATA_CBOR) ? "CBOR" : "JSON",
+	       cycles, sent_heap_bytes - heap_bytes, sent_payload_len);
+
+#if defined(CONFIG_NRF_CLOUD_MQTT_SENSOR_DATA_CBOR)
+	TEST_ASSERT_EQUAL(0, nrf_cloud_sensor_data_cbor_encode(&param, expected,
+							       sizeof(expected), &expected_len));
+	TEST_ASSERT_EQUAL_MESSAGE(heap_bytes, sent_heap_bytes,
+				  "CBOR message should not be allocated from the heap");
+#else
+	struct nrf_cloud_data json;
+
+	TEST_ASSERT_EQUAL(0, nrf_cloud_encode_sensor_data(&param, &json));
+	TEST_ASSERT_TRUE(json.len <= sizeof(expected));
+	memcpy(expected, json.ptr, json.len);
+	expected_len = json.len;
+	k_free((void *)json.ptr);
+
+	TEST_ASSERT_TRUE_MESSAGE(sent_heap_bytes > heap_bytes,
+				 "JSON message should be allocated from the heap");
+#endif
+
+	TEST_ASSERT_EQUAL(expected_len, sent_payload_len);
+	TEST_ASSERT_EQUAL_MEMORY(expected, sent_payload, expected_len);
+}
+
+/* Verify that sensor data is published in the configured format, and that
+ * the CBOR message is not allocated from the heap
+ */
+void test_sensor_data_send(void)
+{
+	sensor_data_send_check(false);
+}
+
+void test_sensor_data_stream(void)
+{
+	sensor_data_send_check(true);
+}
+
 void main(void)
 {
 	(void)unity_main();
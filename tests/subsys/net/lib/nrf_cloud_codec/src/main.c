@@ -0,0 +1,414 @@
+/*
+ * Copyright (c) 2022 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+#include <string.h>
+#include <stdbool.h>
+#include <zephyr/types.h>
+#include <ztest.h>
+#include <zcbor_decode.h>
+#include <zcbor_encode.h>
+#include "nrf_cloud_codec.h"
+
+/* Number of iterations in each benchmark */
+#define BENCH_ITERATIONS 200
+
+#define TEST_LAT	63.42115
+#define TEST_LON	10.43712
+#define TEST_UNC	1250
+
+static uint8_t cbor_buf[512];
+
+static struct lte_lc_ncell test_ncells[] = {
+	{ .earfcn = 6400, .phys_cell_id = 101, .rsrp = 40, .rsrq = 20 },
+	{ .earfcn = 6400, .phys_cell_id = 102, .rsrp = 35, .rsrq = 18 },
+	{ .earfcn = 1650, .phys_cell_id = 309, .rsrp = 30, .rsrq = 12 },
+};
+
+static struct lte_lc_cells_info test_cells = {
+	.current_cell = {
+		.mcc = 242,
+		.mnc = 1,
+		.id = 21858829,
+		.tac = 333,
+		.earfcn = 6400,
+		.timing_advance = 80,
+		.phys_cell_id = 100,
+		.rsrp = 50,
+		.rsrq = 25,
+	},
+	.ncells_count = ARRAY_SIZE(test_ncells),
+	.neighbor_cells = test_ncells,
+};
+
+static const struct nrf_cloud_gnss_data test_gnss = {
+	.type = NRF_CLOUD_GNSS_TYPE_PVT,
+	.ts_ms = 1666166400000,
+	.pvt = {
+		.lat = TEST_LAT,
+		.lon = TEST_LON,
+		.accuracy = 12.5f,
+		.alt = 42.0f,
+		.has_alt = 1,
+		.speed = 1.5f,
+		.has_speed = 1,
+		.heading = 270.0f,
+		.has_heading = 1,
+	},
+};
+
+static const char test_cell_pos_rsp_json[] =
+	"{\"appId\":\"CELL_POS\",\"messageType\":\"DATA\",\"data\":"
+	"{\"lat\":63.42115,\"lon\":10.43712,\"uncertainty\":1250,\"fulfilledWith\":\"MCELL\"}}";
+
+/* cJSON allocations are counted to compare the heap use of the two paths */
+static size_t alloc_count;
+static size_t alloc_bytes;
+
+static void *counting_malloc(size_t size)
+{
+	alloc_count++;
+	alloc_bytes += size;
+	return k_malloc(size);
+}
+
+static void counting_free(void *ptr)
+{
+	k_free(ptr);
+}
+
+struct bench_result {
+	uint32_t cycles;
+	size_t allocs;
+	size_t bytes;
+};
+
+static void bench_start(struct bench_result *result)
+{
+	alloc_count = 0;
+	alloc_bytes = 0;
+	result->cycles = k_cycle_get_32();
+}
+
+static void bench_end(struct bench_result *result, const char *name, size_t size)
+{
+	result->cycles = (k_cycle_get_32() - result->cycles) / BENCH_ITERATIONS;
+	result->allocs = alloc_count / BENCH_ITERATIONS;
+	result->bytes = alloc_bytes / BENCH_ITERATIONS;
+
+	/* Cycle counts are only meaningful on hardware, native_posix does not
+	 * advance time while code is running.
+	 */
+	TC_PRINT("%-24s %6u cycles, %3zu allocs, %5zu heap bytes, %4zu bytes out\n",
+		 name, result->cycles, result->allocs, result->bytes, size);
+}
+
+/* Encodes a cellular positioning response in the format of the MQTT message */
+static size_t cell_pos_rsp_cbor_encode(uint8_t *buf, size_t len, bool with_data)
+{
+	ZCBOR_STATE_E(zse, 3, buf, len, 1);
+	bool ok;
+
+	ok = zcbor_map_start_encode(zse, 3) &&
+	     zcbor_tstr_put_lit(zse, "appId") &&
+	     zcbor_tstr_put_lit(zse, "CELL_POS") &&
+	     zcbor_tstr_put_lit(zse, "messageType") &&
+	     zcbor_tstr_put_lit(zse, "DATA");
+
+	if (with_data) {
+		ok = ok &&
+		     zcbor_tstr_put_lit(zse, "data") &&
+		     zcbor_map_start_encode(zse, 4) &&
+		     zcbor_tstr_put_lit(zse, "lat") &&
+		     zcbor_float64_put(zse, TEST_LAT) &&
+		     zcbor_tstr_put_lit(zse, "lon") &&
+		     zcbor_float64_put(zse, TEST_LON) &&
+		     zcbor_tstr_put_lit(zse, "uncertainty") &&
+		     zcbor_uint32_put(zse, TEST_UNC) &&
+		     zcbor_tstr_put_lit(zse, "fulfilledWith") &&
+		     zcbor_tstr_put_lit(zse, "MCELL") &&
+		     zcbor_map_end_encode(zse, 4);
+	} else {
+		ok = ok &&
+		     zcbor_tstr_put_lit(zse, "err") &&
+		     zcbor_int32_put(zse, NRF_CLOUD_ERROR_BAD_REQUEST);
+	}
+
+	ok = ok && zcbor_map_end_encode(zse, 3);
+	zassert_true(ok, "Failed to encode test response");
+
+	return zse->payload - buf;
+}
+
+static void test_gnss_msg_cbor_encode(void)
+{
+	struct zcbor_string str;
+	int64_t ts;
+	double lat;
+	size_t len;
+	int ret;
+
+	ret = nrf_cloud_gnss_msg_cbor_encode(&test_gnss, cbor_buf, sizeof(cbor_buf), &len);
+	zassert_equal(ret, 0, "Encoding failed: %d", ret);
+
+	ZCBOR_STATE_D(zsd, 3, cbor_buf, len, 1);
+
+	zassert_true(zcbor_map_start_decode(zsd), NULL);
+	zassert_true(zcbor_tstr_expect_lit(zsd, "appId"), NULL);
+	zassert_true(zcbor_tstr_expect_lit(zsd, "GNSS"), NULL);
+	zassert_true(zcbor_tstr_expect_lit(zsd, "messageType"), NULL);
+	zassert_true(zcbor_tstr_expect_lit(zsd, "DATA"), NULL);
+	zassert_true(zcbor_tstr_expect_lit(zsd, "ts"), NULL);
+	zassert_true(zcbor_int64_decode(zsd, &ts), NULL);
+	zassert_equal(ts, test_gnss.ts_ms, NULL);
+	zassert_true(zcbor_tstr_expect_lit(zsd, "data"), NULL);
+	zassert_true(zcbor_map_start_decode(zsd), NULL);
+	zassert_true(zcbor_tstr_expect_lit(zsd, "lng"), NULL);
+	zassert_true(zcbor_any_skip(zsd, NULL), NULL);
+	zassert_true(zcbor_tstr_decode(zsd, &str), NULL);
+	zassert_true(zcbor_float64_decode(zsd, &lat), NULL);
+	zassert_equal(lat, TEST_LAT, NULL);
+}
+
+static void test_gnss_msg_cbor_encode_no_space(void)
+{
+	size_t len;
+	int ret;
+
+	ret = nrf_cloud_gnss_msg_cbor_encode(&test_gnss, cbor_buf, 16, &len);
+	zassert_equal(ret, -ENOMEM, "Unexpected result: %d", ret);
+}
+
+static void test_sensor_data_cbor_encode(void)
+{
+	const char temp[] = "23.5";
+	struct nrf_cloud_sensor_data sensor = {
+		.type = NRF_CLOUD_SENSOR_TEMP,
+		.data = { .ptr = temp, .len = strlen(temp) },
+	};
+	struct zcbor_string str;
+	size_t len;
+	int ret;
+
+	ret = nrf_cloud_sensor_data_cbor_encode(&sensor, cbor_buf, sizeof(cbor_buf), &len);
+	zassert_equal(ret, 0, "Encoding failed: %d", ret);
+
+	ZCBOR_STATE_D(zsd, 2, cbor_buf, len, 1);
+
+	zassert_true(zcbor_map_start_decode(zsd), NULL);
+	zassert_true(zcbor_tstr_expect_lit(zsd, "appId"), NULL);
+	zassert_true(zcbor_tstr_expect_lit(zsd, "TEMP"), NULL);
+	zassert_true(zcbor_tstr_expect_lit(zsd, "data"), NULL);
+	zassert_true(zcbor_tstr_decode(zsd, &str), NULL);
+	zassert_equal(str.len, strlen(temp), NULL);
+	zassert_mem_equal(str.value, temp, str.len, NULL);
+}
+
+static void test_cell_pos_req_cbor_encode(void)
+{
+	size_t len;
+	int ret;
+
+	ret = nrf_cloud_cell_pos_req_cbor_encode(&test_cells, 1, cbor_buf, sizeof(cbor_buf), &len);
+	zassert_equal(ret, 0, "Encoding failed: %d", ret);
+
+	ZCBOR_STATE_D(zsd, 5, cbor_buf, len, 1);
+
+	zassert_true(zcbor_map_start_decode(zsd), NULL);
+	zassert_true(zcbor_tstr_expect_lit(zsd, "lte"), NULL);
+	zassert_true(zcbor_list_start_decode(zsd), NULL);
+	zassert_true(zcbor_any_skip(zsd, NULL), NULL);
+	zassert_true(zcbor_list_end_decode(zsd), NULL);
+	zassert_true(zcbor_map_end_decode(zsd), NULL);
+}
+
+static void test_cell_pos_response_cbor_decode(void)
+{
+	struct nrf_cloud_cell_pos_result result;
+	size_t len;
+	int ret;
+
+	len = cell_pos_rsp_cbor_encode(cbor_buf, sizeof(cbor_buf), true);
+
+	ret = nrf_cloud_cell_pos_response_cbor_decode(cbor_buf, len, &result);
+	zassert_equal(ret, 0, "Decoding failed: %d", ret);
+	zassert_equal(result.lat, TEST_LAT, NULL);
+	zassert_equal(result.lon, TEST_LON, NULL);
+	zassert_equal(result.unc, TEST_UNC, NULL);
+	zassert_equal(result.type, CELL_POS_TYPE_MULTI, NULL);
+	zassert_equal(result.err, NRF_CLOUD_ERROR_NONE, NULL);
+}
+
+static void test_cell_pos_response_cbor_decode_error(void)
+{
+	struct nrf_cloud_cell_pos_result result;
+	size_t len;
+	int ret;
+
+	len = cell_pos_rsp_cbor_encode(cbor_buf, sizeof(cbor_buf), false);
+
+	ret = nrf_cloud_cell_pos_response_cbor_decode(cbor_buf, len, &result);
+	zassert_equal(ret, -EFAULT, "Unexpected result: %d", ret);
+	zassert_equal(result.err, NRF_CLOUD_ERROR_BAD_REQUEST, NULL);
+	zassert_equal(result.type, CELL_POS_TYPE__INVALID, NULL);
+}
+
+static void test_cell_pos_response_cbor_decode_other(void)
+{
+	struct nrf_cloud_cell_pos_result result;
+	uint8_t not_a_map[] = { 0x01 };
+	size_t len;
+	int ret;
+
+	/* Not a cellular positioning message */
+	len = cell_pos_rsp_cbor_encode(cbor_buf, sizeof(cbor_buf), true);
+	cbor_buf[8] = 'X';
+	ret = nrf_cloud_cell_pos_response_cbor_decode(cbor_buf, len, &result);
+	zassert_equal(ret, 1, "Unexpected result: %d", ret);
+
+	ret = nrf_cloud_cell_pos_response_cbor_decode(not_a_map, sizeof(not_a_map), &result);
+	zassert_equal(ret, 1, "Unexpected result: %d", ret);
+
+	/* Truncated */
+	len = cell_pos_rsp_cbor_encode(cbor_buf, sizeof(cbor_buf), true);
+	ret = nrf_cloud_cell_pos_response_cbor_decode(cbor_buf, len - 4, &result);
+	zassert_equal(ret, -EBADMSG, "Unexpected result: %d", ret);
+}
+
+static void test_benchmark_gnss_msg(void)
+{
+	struct bench_result json;
+	struct bench_result cbor;
+	size_t json_len = 0;
+	size_t cbor_len = 0;
+
+	bench_start(&json);
+	for (int i = 0; i < BENCH_ITERATIONS; i++) {
+		cJSON *msg_obj = cJSON_CreateObject();
+		char *msg;
+
+		zassert_equal(nrf_cloud_gnss_msg_json_encode(&test_gnss, msg_obj), 0, NULL);
+		msg = cJSON_PrintUnformatted(msg_obj);
+		zassert_not_null(msg, NULL);
+		json_len = strlen(msg);
+		cJSON_free(msg);
+		cJSON_Delete(msg_obj);
+	}
+	bench_end(&json, "GNSS PVT, JSON", json_len);
+
+	bench_start(&cbor);
+	for (int i = 0; i < BENCH_ITERATIONS; i++) {
+		zassert_equal(nrf_cloud_gnss_msg_cbor_encode(&test_gnss, cbor_buf,
+							     sizeof(cbor_buf), &cbor_len), 0, NULL);
+	}
+	bench_end(&cbor, "GNSS PVT, CBOR", cbor_len);
+
+	zassert_equal(cbor.allocs, 0, NULL);
+	zassert_true(json.allocs > 0, NULL);
+	zassert_true(cbor_len < json_len, NULL);
+}
+
+static void test_benchmark_cell_pos_req(void)
+{
+	struct bench_result json;
+	struct bench_result cbor;
+	size_t json_len = 0;
+	size_t cbor_len = 0;
+
+	bench_start(&json);
+	for (int i = 0; i < BENCH_ITERATIONS; i++) {
+		char *req;
+
+		zassert_equal(nrf_cloud_format_cell_pos_req(&test_cells, 1, &req), 0, NULL);
+		json_len = strlen(req);
+		cJSON_free(req);
+	}
+	bench_end(&json, "Cell pos request, JSON", json_len);
+
+	bench_start(&cbor);
+	for (int i = 0; i < BENCH_ITERATIONS; i++) {
+		zassert_equal(nrf_cloud_cell_pos_req_cbor_encode(&test_cells, 1, cbor_buf,
+								 sizeof(cbor_buf), &cbor_len),
+			      0, NULL);
+	}
+	bench_end(&cbor, "Cell pos request, CBOR", cbor_len);
+
+	zassert_equal(cbor.allocs, 0, NULL);
+	zassert_true(cbor_len < json_len, NULL);
+}
+
+static void test_benchmark_cell_pos_response(void)
+{
+	struct nrf_cloud_cell_pos_result json_result;
+	struct nrf_cloud_cell_pos_result cbor_result;
+	struct bench_result json;
+	struct bench_result cbor;
+	size_t cbor_len;
+
+	bench_start(&json);
+	for (int i = 0; i < BENCH_ITERATIONS; i++) {
+		zassert_equal(nrf_cloud_parse_cell_pos_response(test_cell_pos_rsp_json,
+								&json_result), 0, NULL);
+	}
+	bench_end(&json, "Cell pos response, JSON", strlen(test_cell_pos_rsp_json));
+
+	cbor_len = cell_pos_rsp_cbor_encode(cbor_buf, sizeof(cbor_buf), true);
+
+	bench_start(&cbor);
+	for (int i = 0; i < BENCH_ITERATIONS; i++) {
+		zassert_equal(nrf_cloud_cell_pos_response_cbor_decode(cbor_buf, cbor_len,
+								      &cbor_result), 0, NULL);
+	}
+	bench_end(&cbor, "Cell pos response, CBOR", cbor_len);
+
+	zassert_equal(cbor.allocs, 0, NULL);
+	zassert_equal(json_result.lat, cbor_result.lat, NULL);
+	zassert_equal(json_result.lon, cbor_result.lon, NULL);
+	zassert_equal(json_result.unc, cbor_result.unc, NULL);
+	zassert_equal(json_result.type, cbor_result.type, NULL);
+}
+
+/* The codec gets the modem information itself only for single cell requests,
+ * which are not used in this test.
+ */
+int modem_info_init(void)
+{
+	return -ENOTSUP;
+}
+
+int modem_info_params_init(struct modem_param_info *modem_param)
+{
+	return -ENOTSUP;
+}
+
+int modem_info_params_get(struct modem_param_info *modem_param)
+{
+	return -ENOTSUP;
+}
+
+void test_main(void)
+{
+	cJSON_Hooks hooks = {
+		.malloc_fn = counting_malloc,
+		.free_fn = counting_free,
+	};
+
+	nrf_cloud_codec_init();
+	cJSON_InitHooks(&hooks);
+
+	ztest_test_suite(nrf_cloud_codec_test,
+			 ztest_unit_test(test_gnss_msg_cbor_encode),
+			 ztest_unit_test(test_gnss_msg_cbor_encode_no_space),
+			 ztest_unit_test(test_sensor_data_cbor_encode),
+			 ztest_unit_test(test_cell_pos_req_cbor_encode),
+			 ztest_unit_test(test_cell_pos_response_cbor_decode),
+			 ztest_unit_test(test_cell_pos_response_cbor_decode_error),
+			 ztest_unit_test(test_cell_pos_response_cbor_decode_other),
+			 ztest_unit_test(test_benchmark_gnss_msg),
+			 ztest_unit_test(test_benchmark_cell_pos_req),
+			 ztest_unit_test(test_benchmark_cell_pos_response)
+			 );
+
+	ztest_run_test_suite(nrf_cloud_codec_test);
+}
@@ -0,0 +1,418 @@
+/*
+ * Copyright (c) 2022 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+#include <string.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <zephyr/types.h>
+#include <ztest.h>
+#include <zephyr/net/mqtt.h>
+#include <zephyr/settings/settings.h>
+#include "nrf_cloud_outbox.h"
+
+#define WINDOW CONFIG_NRF_CLOUD_MQTT_OUTBOX_WINDOW
+#define TEST_TOPIC "prod/test-tenant/m/d/test-device/d2c"
+#define FIRST_ID 1000
+#define STORED_MAX (WINDOW * 2)
+#define STORED_LEN_MAX 256
+#define STORED_KEY_PREFIX "nrf_cloud/" NRF_CLOUD_OUTBOX_SETTINGS_KEY "/"
+#define PERSIST_ON_DISCONNECT IS_ENABLED(CONFIG_NRF_CLOUD_MQTT_OUTBOX_PERSIST_ON_DISCONNECT)
+
+/* Round trip time of the simulated broker, in ticks */
+#define BROKER_RTT 10
+#define BROKER_MSG_COUNT 40
+
+/* Publications seen by the MQTT stub */
+struct published {
+	uint16_t message_id;
+	bool dup;
+	char payload[32];
+};
+
+static struct published published[WINDOW * 4];
+static size_t published_count;
+static int publish_err;
+
+/* Settings stored through the settings stubs */
+struct stored {
+	char key[32];
+	uint8_t data[STORED_LEN_MAX];
+	size_t len;
+};
+
+static struct stored stored[STORED_MAX];
+static size_t stored_writes;
+static size_t stored_deletes;
+
+/* Simulated broker, acknowledges publications after BROKER_RTT ticks */
+static bool broker_enabled;
+static uint16_t broker_ids[WINDOW];
+static uint32_t broker_due[WINDOW];
+static size_t broker_pending;
+static uint32_t broker_tick;
+
+static struct mqtt_client client;
+
+int mqtt_publish(struct mqtt_client *c, const struct mqtt_publish_param *param)
+{
+	struct published *p;
+
+	zassert_equal_ptr(c, &client, "Wrong client");
+	zassert_equal(param->message.topic.qos, MQTT_QOS_1_AT_LEAST_ONCE, "Wrong QoS");
+	zassert_equal(param->message.topic.topic.size, strlen(TEST_TOPIC), "Wrong topic");
+	zassert_mem_equal(param->message.topic.topic.utf8, TEST_TOPIC, strlen(TEST_TOPIC),
+			  "Wrong topic");
+
+	if (publish_err) {
+		return publish_err;
+	}
+
+	if (broker_enabled) {
+		zassert_true(broker_pending < WINDOW, "More publications in flight than window");
+		broker_ids[broker_pending] = param->message_id;
+		broker_due[broker_pending] = broker_tick + BROKER_RTT;
+		broker_pending++;
+		return 0;
+	}
+
+	zassert_true(published_count < ARRAY_SIZE(published), "Too many publications");
+
+	p = &published[published_count++];
+	p->message_id = param->message_id;
+	p->dup = param->dup_flag;
+	memset(p->payload, 0, sizeof(p->payload));
+	memcpy(p->payload, param->message.payload.data,
+	       MIN(param->message.payload.len, sizeof(p->payload) - 1));
+
+	return 0;
+}
+
+int settings_save_one(const char *name, const void *value, size_t val_len)
+{
+	struct stored *free_slot = NULL;
+
+	zassert_true(val_len <= STORED_LEN_MAX, "Stored value too large");
+
+	for (size_t i = 0; i < ARRAY_SIZE(stored); i++) {
+		if (stored[i].len && !strcmp(stored[i].key, name)) {
+			free_slot = &stored[i];
+			break;
+		} else if (!stored[i].len && !free_slot) {
+			free_slot = &stored[i];
+		}
+	}
+
+	zassert_not_null(free_slot, "Settings storage full");
+
+	stored_writes++;
+
+	strncpy(free_slot->key, name, sizeof(free_slot->key) - 1);
+	memcpy(free_slot->data, value, val_len);
+	free_slot->len = val_len;
+
+	return 0;
+}
+
+int settings_delete(const char *name)
+{
+	for (size_t i = 0; i < ARRAY_SIZE(stored); i++) {
+		if (stored[i].len && !strcmp(stored[i].key, name)) {
+			stored[i].len = 0;
+			stored_deletes++;
+			return 0;
+		}
+	}
+
+	return -ENOENT;
+}
+
+static size_t stored_count(void)
+{
+	size_t count = 0;
+
+	for (size_t i = 0; i < ARRAY_SIZE(stored); i++) {
+		if (stored[i].len) {
+			count++;
+		}
+	}
+
+	return count;
+}
+
+static ssize_t stored_read(void *cb_arg, void *data, size_t len)
+{
+	const struct stored *s = cb_arg;
+
+	len = MIN(len, s->len);
+	memcpy(data, s->data, len);
+
+	return len;
+}
+
+/* Load stored publications, as the settings subsystem does after a reboot */
+static void stored_load(void)
+{
+	for (size_t i = 0; i < ARRAY_SIZE(stored); i++) {
+		if (!stored[i].len) {
+			continue;
+		}
+
+		zassert_equal(strncmp(stored[i].key, STORED_KEY_PREFIX,
+				      strlen(STORED_KEY_PREFIX)), 0, "Wrong key");
+		zassert_equal(nrf_cloud_outbox_settings_set(
+				&stored[i].key[strlen(STORED_KEY_PREFIX)],
+				stored[i].len, stored_read, &stored[i]), 0,
+			      "Failed to load stored publication");
+	}
+}
+
+static int publish(uint16_t message_id, const char *payload)
+{
+	const struct mqtt_publish_param param = {
+		.message.topic.qos = MQTT_QOS_1_AT_LEAST_ONCE,
+		.message.topic.topic.utf8 = TEST_TOPIC,
+		.message.topic.topic.size = strlen(TEST_TOPIC),
+		.message.payload.data = (uint8_t *)payload,
+		.message.payload.len = strlen(payload),
+		.message_id = message_id,
+	};
+
+	return nrf_cloud_outbox_publish(&client, &param);
+}
+
+static void setup(void)
+{
+	nrf_cloud_outbox_reset();
+	memset(stored, 0, sizeof(stored));
+	stored_writes = 0;
+	stored_deletes = 0;
+	memset(published, 0, sizeof(published));
+	published_count = 0;
+	publish_err = 0;
+	broker_enabled = false;
+	broker_pending = 0;
+	broker_tick = 0;
+}
+
+static void teardown(void)
+{
+	nrf_cloud_outbox_reset();
+}
+
+static void test_publish_ack(void)
+{
+	zassert_equal(nrf_cloud_outbox_free_get(), WINDOW, "Outbox not empty");
+
+	zassert_equal(publish(FIRST_ID, "{\"a\":1}"), 0, "Publish failed");
+	zassert_equal(publish(FIRST_ID + 1, "{\"a\":2}"), 0, "Publish failed");
+
+	zassert_equal(published_count, 2, "Publications not sent");
+	zassert_false(published[0].dup, "DUP set on first transmission");
+	zassert_equal(nrf_cloud_outbox_free_get(), WINDOW - 2, "Publications not kept");
+	zassert_true(nrf_cloud_outbox_contains(FIRST_ID), "Publication not kept");
+
+	zassert_equal(nrf_cloud_outbox_ack(FIRST_ID), 0, "Ack failed");
+	zassert_false(nrf_cloud_outbox_contains(FIRST_ID), "Acknowledged publication kept");
+	zassert_true(nrf_cloud_outbox_contains(FIRST_ID + 1), "Publication removed");
+
+	/* Control channel acknowledgments are not in the outbox */
+	zassert_equal(nrf_cloud_outbox_ack(FIRST_ID), -ENOENT, "Ack of unknown ID accepted");
+
+	zassert_equal(nrf_cloud_outbox_ack(FIRST_ID + 1), 0, "Ack failed");
+	zassert_equal(nrf_cloud_outbox_free_get(), WINDOW, "Outbox not empty");
+}
+
+static void test_window_full(void)
+{
+	for (int i = 0; i < WINDOW; i++) {
+		zassert_equal(publish(FIRST_ID + i, "{}"), 0, "Publish failed");
+	}
+
+	zassert_equal(nrf_cloud_outbox_free_get(), 0, "Outbox not full");
+	zassert_equal(publish(FIRST_ID + WINDOW, "{}"), -ENOBUFS, "Window not enforced");
+	zassert_equal(published_count, WINDOW, "Publication sent with full window");
+
+	zassert_equal(nrf_cloud_outbox_ack(FIRST_ID + 1), 0, "Ack failed");
+	zassert_equal(publish(FIRST_ID + WINDOW, "{}"), 0, "Publish failed after ack");
+}
+
+static void test_duplicate_id(void)
+{
+	zassert_equal(publish(FIRST_ID, "{}"), 0, "Publish failed");
+	zassert_equal(publish(FIRST_ID, "{}"), -EBUSY, "Duplicate message ID accepted");
+	zassert_equal(nrf_cloud_outbox_free_get(), WINDOW - 1, "Duplicate kept");
+}
+
+static void test_publish_failure(void)
+{
+	publish_err = -ENOTCONN;
+
+	zassert_equal(publish(FIRST_ID, "{}"), -ENOTCONN, "Error not returned");
+	zassert_false(nrf_cloud_outbox_contains(FIRST_ID), "Failed publication kept");
+	zassert_equal(stored_count(), 0, "Failed publication stored");
+}
+
+static void test_retransmit(void)
+{
+	static const char * const payloads[] = { "{\"n\":0}", "{\"n\":1}", "{\"n\":2}" };
+
+	/* IDs out of order, to verify that the publication order is kept */
+	zassert_equal(publish(FIRST_ID + 5, payloads[0]), 0, "Publish failed");
+	zassert_equal(publish(FIRST_ID + 1, payloads[1]), 0, "Publish failed");
+	zassert_equal(publish(FIRST_ID + 3, payloads[2]), 0, "Publish failed");
+	zassert_equal(nrf_cloud_outbox_ack(FIRST_ID + 1), 0, "Ack failed");
+
+	published_count = 0;
+
+	zassert_equal(nrf_cloud_outbox_retransmit(&client), 2, "Wrong number retransmitted");
+	zassert_equal(published_count, 2, "Publications not sent");
+
+	zassert_equal(published[0].message_id, FIRST_ID + 5, "Wrong order");
+	zassert_true(published[0].dup, "DUP not set");
+	zassert_equal(strcmp(published[0].payload, payloads[0]), 0, "Wrong payload");
+
+	zassert_equal(published[1].message_id, FIRST_ID + 3, "Wrong order");
+	zassert_true(published[1].dup, "DUP not set");
+	zassert_equal(strcmp(published[1].payload, payloads[2]), 0, "Wrong payload");
+
+	/* Publications are kept until acknowledged, also if retransmission fails */
+	publish_err = -ENOTCONN;
+	zassert_equal(nrf_cloud_outbox_retransmit(&client), -ENOTCONN, "Error not returned");
+	zassert_equal(nrf_cloud_outbox_free_get(), WINDOW - 2, "Publications removed");
+}
+
+static void test_persistence(void)
+{
+	zassert_equal(publish(FIRST_ID, "{\"n\":0}"), 0, "Publish failed");
+	zassert_equal(publish(FIRST_ID + 1, "{\"n\":1}"), 0, "Publish failed");
+	zassert_equal(publish(FIRST_ID + 2, "{\"n\":2}"), 0, "Publish failed");
+	zassert_equal(stored_count(), PERSIST_ON_DISCONNECT ? 0 : 3,
+		      "Wrong number of publications stored");
+
+	zassert_equal(nrf_cloud_outbox_ack(FIRST_ID + 1), 0, "Ack failed");
+	zassert_equal(stored_count(), PERSIST_ON_DISCONNECT ? 0 : 2,
+		      "Acknowledged publication not deleted");
+
+	/* Disconnect */
+	zassert_equal(nrf_cloud_outbox_persist(), PERSIST_ON_DISCONNECT ? 2 : 0,
+		      "Wrong number of publications stored on disconnect");
+	zassert_equal(stored_count(), 2, "Publications not stored");
+	zassert_equal(nrf_cloud_outbox_persist(), 0, "Publications stored twice");
+
+	/* Reboot */
+	nrf_cloud_outbox_reset();
+	zassert_equal(nrf_cloud_outbox_free_get(), WINDOW, "Outbox not reset");
+	zassert_equal(stored_count(), 2, "Stored publications deleted by reset");
+
+	stored_load();
+	/* Loading twice, as after nrf_cloud_uninit() and nrf_cloud_init(), is harmless */
+	stored_load();
+
+	zassert_equal(nrf_cloud_outbox_free_get(), WINDOW - 2, "Publications not loaded");
+	zassert_true(nrf_cloud_outbox_contains(FIRST_ID), "Publication not loaded");
+	zassert_true(nrf_cloud_outbox_contains(FIRST_ID + 2), "Publication not loaded");
+
+	/* Publications sent after the reboot are retransmitted after the loaded ones */
+	zassert_equal(publish(FIRST_ID + 3, "{\"n\":3}"), 0, "Publish failed");
+
+	published_count = 0;
+
+	zassert_equal(nrf_cloud_outbox_retransmit(&client), 3, "Wrong number retransmitted");
+	zassert_equal(published[0].message_id, FIRST_ID, "Wrong order");
+	zassert_equal(strcmp(published[0].payload, "{\"n\":0}"), 0, "Wrong payload");
+	zassert_equal(published[1].message_id, FIRST_ID + 2, "Wrong order");
+	zassert_equal(strcmp(published[1].payload, "{\"n\":2}"), 0, "Wrong payload");
+	zassert_equal(published[2].message_id, FIRST_ID + 3, "Wrong order");
+
+	/* Loaded publications are deleted when acknowledged */
+	zassert_equal(nrf_cloud_outbox_ack(FIRST_ID), 0, "Ack failed");
+	zassert_equal(nrf_cloud_outbox_ack(FIRST_ID + 2), 0, "Ack failed");
+	zassert_equal(stored_count(), PERSIST_ON_DISCONNECT ? 0 : 1,
+		      "Acknowledged publication not deleted");
+}
+
+/* Send BROKER_MSG_COUNT publications through the simulated broker, with at
+ * most in_flight_max of them waiting for acknowledgment, and return the
+ * number of ticks it took.
+ */
+static uint32_t broker_deliver(size_t in_flight_max)
+{
+	size_t sent = 0;
+	size_t acked = 0;
+
+	broker_enabled = true;
+	broker_pending = 0;
+	broker_tick = 0;
+
+	while (acked < BROKER_MSG_COUNT) {
+		while ((sent < BROKER_MSG_COUNT) && (broker_pending < in_flight_max)) {
+			int err = publish(FIRST_ID + sent, "{}");
+
+			if (err == -ENOBUFS) {
+				break;
+			}
+
+			zassert_equal(err, 0, "Publish failed");
+			sent++;
+		}
+
+		broker_tick++;
+
+		for (size_t i = 0; i < broker_pending;) {
+			if (broker_due[i] > broker_tick) {
+				i++;
+				continue;
+			}
+
+			zassert_equal(nrf_cloud_outbox_ack(broker_ids[i]), 0, "Ack failed");
+			acked++;
+
+			broker_pending--;
+			broker_ids[i] = broker_ids[broker_pending];
+			broker_due[i] = broker_due[broker_pending];
+		}
+	}
+
+	broker_enabled = false;
+
+	return broker_tick;
+}
+
+static void test_pipelining(void)
+{
+	uint32_t stop_and_wait = broker_deliver(1);
+	uint32_t pipelined = broker_deliver(WINDOW);
+
+	TC_PRINT("%d publications, round trip %d ticks: %u ticks one at a time, "
+		 "%u ticks with a window of %d\n",
+		 BROKER_MSG_COUNT, BROKER_RTT, stop_and_wait, pipelined, WINDOW);
+	TC_PRINT("Settings writes: %zu, deletes: %zu\n", stored_writes, stored_deletes);
+
+	zassert_equal(stop_and_wait, BROKER_MSG_COUNT * BROKER_RTT, "Unexpected duration");
+	zassert_equal(pipelined, DIV_ROUND_UP(BROKER_MSG_COUNT, WINDOW) * BROKER_RTT,
+		      "Publications not pipelined");
+	zassert_equal(nrf_cloud_outbox_free_get(), WINDOW, "Outbox not empty");
+	zassert_equal(stored_count(), 0, "Acknowledged publications not deleted");
+
+	/* Every publication is written and deleted, unless the connection is not lost */
+	zassert_equal(stored_writes, PERSIST_ON_DISCONNECT ? 0 : 2 * BROKER_MSG_COUNT,
+		      "Wrong number of settings writes");
+	zassert_equal(stored_deletes, stored_writes, "Wrong number of settings deletes");
+}
+
+void test_main(void)
+{
+	ztest_test_suite(nrf_cloud_outbox_test,
+			 ztest_unit_test_setup_teardown(test_publish_ack, setup, teardown),
+			 ztest_unit_test_setup_teardown(test_window_full, setup, teardown),
+			 ztest_unit_test_setup_teardown(test_duplicate_id, setup, teardown),
+			 ztest_unit_test_setup_teardown(test_publish_failure, setup, teardown),
+			 ztest_unit_test_setup_teardown(test_retransmit, setup, teardown),
+			 ztest_unit_test_setup_teardown(test_persistence, setup, teardown),
+			 ztest_unit_test_setup_teardown(test_pipelining, setup, teardown)
+			 );
+
+	ztest_run_test_suite(nrf_cloud_outbox_test);
+}
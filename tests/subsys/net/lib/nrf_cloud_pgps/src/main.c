@@ -0,0 +1,380 @@
+/*
+ * Copyright (c) 2022 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+#include <string.h>
+#include <ztest.h>
+#include <zephyr/device.h>
+#include <zephyr/drivers/flash.h>
+#include <zephyr/drivers/flash/flash_simulator.h>
+#include <zephyr/settings/settings.h>
+#include <zephyr/stats/stats.h>
+#include <zephyr/sys/crc.h>
+#include <date_time.h>
+#include <net/nrf_cloud_agps.h>
+#include <net/nrf_cloud_pgps.h>
+
+#include "nrf_cloud_fsm.h"
+#include "nrf_cloud_pgps_schema_v1.h"
+#include "nrf_cloud_pgps_utils.h"
+#include "settings_mock.h"
+
+#define PERIOD_MIN CONFIG_NRF_CLOUD_PGPS_PREDICTION_PERIOD
+#define PERIOD_SEC (PERIOD_MIN * SEC_PER_MIN)
+#define START_DAY 15000
+#define START_SEC ((int64_t)START_DAY * SEC_PER_DAY)
+#define FRAGMENT_SIZE CONFIG_NRF_CLOUD_PGPS_DOWNLOAD_FRAGMENT_SIZE
+#define STORAGE_OFFSET 0x80000
+#define STORAGE_SIZE (NUM_PREDICTIONS * PGPS_PREDICTION_STORAGE_SIZE)
+#define INDEX_KEY "nrf_cloud_pgps/pgps_index"
+
+#define SCHEMA_OFFSET offsetof(struct nrf_cloud_pgps_prediction, schema_version)
+#define SENTINEL_OFFSET offsetof(struct nrf_cloud_pgps_prediction, sentinel)
+
+/* Flash operations counted by the flash simulator */
+struct flash_ops {
+	uint32_t write_calls;
+	uint32_t bytes_written;
+	uint32_t erase_calls;
+};
+
+struct flash_stat {
+	const char *name;
+	uint32_t value;
+};
+
+static const struct device *const flash_dev = DEVICE_DT_GET(DT_CHOSEN(zephyr_flash_controller));
+static uint8_t *storage;
+static size_t page_size;
+
+/* Header followed by the predictions, as downloaded from the cloud */
+static uint8_t dl_data[sizeof(struct nrf_cloud_pgps_header) +
+		       NUM_PREDICTIONS * PGPS_PREDICTION_DL_SIZE];
+static struct nrf_cloud_pgps_prediction prediction;
+
+static size_t evt_cnt[PGPS_EVT_REQUEST + 1];
+static const struct nrf_cloud_pgps_prediction *available;
+static int64_t gps_sec_now;
+
+int date_time_now(int64_t *unix_time_ms)
+{
+	*unix_time_ms = (gps_sec_now - GPS_TO_UTC_LEAP_SECONDS + GPS_TO_UNIX_UTC_OFFSET_SECONDS) *
+			MSEC_PER_SEC;
+	return 0;
+}
+
+int nrf_cloud_agps_process(const char *buf, size_t buf_len)
+{
+	return 0;
+}
+
+void nrf_cloud_agps_processed(struct nrf_modem_gnss_agps_data_frame *received_elements)
+{
+	memset(received_elements, 0, sizeof(*received_elements));
+}
+
+enum nfsm_state nfsm_get_current_state(void)
+{
+	return STATE_IDLE;
+}
+
+static int flash_stat_walk(struct stats_hdr *hdr, void *arg, const char *name, uint16_t off)
+{
+	struct flash_stat *stat = arg;
+
+	if (!strcmp(name, stat->name)) {
+		stat->value = *(uint32_t *)((uint8_t *)hdr + off);
+	}
+
+	return 0;
+}
+
+static uint32_t flash_stat_get(const char *name)
+{
+	struct stats_hdr *hdr = stats_group_find("flash_sim_stats");
+	struct flash_stat stat = {
+		.name = name,
+	};
+
+	zassert_not_null(hdr, "Flash simulator statistics not found");
+	zassert_ok(stats_walk(hdr, flash_stat_walk, &stat), "Cannot read flash statistics");
+
+	return stat.value;
+}
+
+static void flash_ops_get(struct flash_ops *ops)
+{
+	ops->write_calls = flash_stat_get("flash_write_calls");
+	ops->bytes_written = flash_stat_get("bytes_written");
+	ops->erase_calls = flash_stat_get("flash_erase_calls");
+}
+
+static void flash_ops_since(struct flash_ops *ops, const struct flash_ops *start)
+{
+	flash_ops_get(ops);
+	ops->write_calls -= start->write_calls;
+	ops->bytes_written -= start->bytes_written;
+	ops->erase_calls -= start->erase_calls;
+}
+
+/* Set the current time to the middle of the validity period of the given prediction */
+static void set_time(int pnum)
+{
+	gps_sec_now = START_SEC + pnum * PERIOD_SEC;
+}
+
+static const struct nrf_cloud_pgps_prediction *stored_prediction(int pnum)
+{
+	/* The predictions of a full download are stored in time order */
+	return (const struct nrf_cloud_pgps_prediction *)
+	       &storage[pnum * PGPS_PREDICTION_STORAGE_SIZE];
+}
+
+static uint32_t stored_crc(int pnum)
+{
+	return crc32_ieee((const uint8_t *)stored_prediction(pnum),
+			  PGPS_PREDICTION_STORAGE_SIZE);
+}
+
+static void saved_index_get(struct npgps_saved_index *saved)
+{
+	zassert_equal(settings_mock_get(INDEX_KEY, saved, sizeof(*saved)), sizeof(*saved),
+		      "P-GPS index not saved");
+}
+
+static void pgps_event_handler(struct nrf_cloud_pgps_event *event)
+{
+	zassert_true(event->type < ARRAY_SIZE(evt_cnt), "Unknown event");
+	evt_cnt[event->type]++;
+
+	if (event->type == PGPS_EVT_AVAILABLE) {
+		available = event->prediction;
+	}
+}
+
+/* Initialize the library as it is initialized after a reboot */
+static void pgps_boot(void)
+{
+	struct nrf_cloud_pgps_init_param param = {
+		.event_handler = pgps_event_handler,
+		.storage_base = STORAGE_OFFSET,
+		.storage_size = STORAGE_SIZE,
+	};
+
+	memset(evt_cnt, 0, sizeof(evt_cnt));
+	available = NULL;
+
+	zassert_ok(nrf_cloud_pgps_init(&param), "Cannot initialize P-GPS");
+}
+
+static void build_download(void)
+{
+	struct nrf_cloud_pgps_header header = {
+		.schema_version = NRF_CLOUD_PGPS_BIN_SCHEMA_VERSION,
+		.array_type = NRF_CLOUD_PGPS_PREDICTION_HEADER,
+		.num_items = 1,
+		.prediction_count = NUM_PREDICTIONS,
+		.prediction_size = PGPS_PREDICTION_DL_SIZE,
+		.prediction_period_min = PERIOD_MIN,
+		.gps_day = START_DAY,
+		.gps_time_of_day = 0,
+	};
+	uint8_t *p = dl_data;
+
+	memcpy(p, &header, sizeof(header));
+	p += sizeof(header);
+
+	for (int pnum = 0; pnum < NUM_PREDICTIONS; pnum++) {
+		uint16_t gps_day;
+		uint32_t gps_time_of_day;
+
+		npgps_gps_sec_to_day_time(START_SEC + pnum * PERIOD_SEC, &gps_day,
+					  &gps_time_of_day);
+
+		memset(&prediction, 0, sizeof(prediction));
+		prediction.time_type = NRF_CLOUD_AGPS_GPS_SYSTEM_CLOCK;
+		prediction.time_count = 1;
+		prediction.time.date_day = gps_day;
+		prediction.time.time_full_s = gps_time_of_day;
+		prediction.ephemeris_type = NRF_CLOUD_AGPS_EPHEMERIDES;
+		prediction.ephemeris_count = NRF_CLOUD_PGPS_NUM_SV;
+		for (int sv = 0; sv < NRF_CLOUD_PGPS_NUM_SV; sv++) {
+			prediction.ephemerii[sv].sv_id = sv + 1;
+			prediction.ephemerii[sv].toe = pnum + 1;
+		}
+
+		/* The schema version and the sentinel are not downloaded */
+		memcpy(p, &prediction, SCHEMA_OFFSET);
+		p += SCHEMA_OFFSET;
+		memcpy(p, (uint8_t *)&prediction + SCHEMA_OFFSET + PGPS_SCHEMA_SIZE,
+		       SENTINEL_OFFSET - SCHEMA_OFFSET - PGPS_SCHEMA_SIZE);
+		p += SENTINEL_OFFSET - SCHEMA_OFFSET - PGPS_SCHEMA_SIZE;
+	}
+
+	zassert_equal(p - dl_data, sizeof(dl_data), "Wrong download size");
+}
+
+static void download(void)
+{
+	build_download();
+
+	zassert_ok(nrf_cloud_pgps_begin_update(), "Cannot begin update");
+
+	for (size_t ofs = 0; ofs < sizeof(dl_data); ofs += FRAGMENT_SIZE) {
+		size_t len = MIN(FRAGMENT_SIZE, sizeof(dl_data) - ofs);
+
+		zassert_ok(nrf_cloud_pgps_process_update(&dl_data[ofs], len),
+			   "Cannot process fragment at offset %zu", ofs);
+	}
+
+	zassert_ok(nrf_cloud_pgps_finish_update(), "Cannot finish update");
+}
+
+static void test_init(void)
+{
+	struct flash_pages_info info;
+
+	zassert_true(device_is_ready(flash_dev), "Flash simulator not ready");
+	zassert_ok(flash_get_page_info_by_offs(flash_dev, STORAGE_OFFSET, &info),
+		   "Cannot get flash page size");
+	page_size = info.size;
+	zassert_equal(STORAGE_SIZE % page_size, 0, "Storage must be a number of pages");
+
+	storage = (uint8_t *)flash_simulator_get_memory(flash_dev, NULL) + STORAGE_OFFSET;
+
+	/* The simulated flash can keep data of a previous run */
+	zassert_ok(flash_erase(flash_dev, STORAGE_OFFSET, STORAGE_SIZE), "Cannot erase flash");
+	settings_mock_clear();
+}
+
+static void test_store_single_write(void)
+{
+	struct npgps_saved_index saved;
+	struct flash_ops start;
+	struct flash_ops ops;
+
+	set_time(0);
+	pgps_boot();
+	zassert_equal(evt_cnt[PGPS_EVT_UNAVAILABLE], 1, "Predictions in erased flash");
+	zassert_equal(evt_cnt[PGPS_EVT_REQUEST], 1, "Predictions not requested");
+
+	flash_ops_get(&start);
+	download();
+	flash_ops_since(&ops, &start);
+
+	TC_PRINT("%d predictions: %u flash writes, %u bytes, %u page erases\n",
+		 NUM_PREDICTIONS, ops.write_calls, ops.bytes_written, ops.erase_calls);
+
+	zassert_equal(evt_cnt[PGPS_EVT_READY], 1, "Download not finished");
+	zassert_equal(evt_cnt[PGPS_EVT_LOADING], NUM_PREDICTIONS - 1, "Predictions missing");
+
+	/* Every page is erased and written once, in a single flash write */
+	zassert_equal(ops.write_calls, STORAGE_SIZE / page_size, "Wrong number of flash writes");
+	zassert_equal(ops.bytes_written, STORAGE_SIZE, "Wrong number of bytes written");
+	zassert_equal(ops.erase_calls, STORAGE_SIZE / page_size, "Wrong number of page erases");
+
+	zassert_equal(settings_mock_save_cnt(INDEX_KEY), 1, "Index not saved once");
+	saved_index_get(&saved);
+	zassert_equal(saved.start_sec, START_SEC, "Wrong start time in index");
+	zassert_equal(saved.count, NUM_PREDICTIONS, "Wrong prediction count in index");
+
+	for (int pnum = 0; pnum < NUM_PREDICTIONS; pnum++) {
+		const struct nrf_cloud_pgps_prediction *p = stored_prediction(pnum);
+
+		zassert_equal(saved.block[pnum], pnum, "Wrong block in index");
+		zassert_equal(saved.crc[pnum], stored_crc(pnum), "Wrong CRC in index");
+		zassert_equal(p->schema_version, NRF_CLOUD_AGPS_BIN_SCHEMA_VERSION,
+			      "Schema version not inserted");
+		zassert_equal(p->sentinel, (uint32_t)(START_SEC + pnum * PERIOD_SEC),
+			      "Wrong sentinel");
+		zassert_equal(p->ephemerii[NRF_CLOUD_PGPS_NUM_SV - 1].toe, pnum + 1,
+			      "Wrong ephemeris");
+	}
+}
+
+static void test_boot_saved_index(void)
+{
+	const int last = NUM_PREDICTIONS - 1;
+	uint8_t *sentinel = (uint8_t *)stored_prediction(last) + SENTINEL_OFFSET;
+	size_t save_cnt = settings_mock_save_cnt(INDEX_KEY);
+	struct nrf_cloud_pgps_prediction *p;
+	struct flash_ops start;
+	struct flash_ops ops;
+
+	/* Walking through the stored predictions would find that the last one is bad */
+	*sentinel ^= 0xFF;
+
+	set_time(0);
+	flash_ops_get(&start);
+	pgps_boot();
+	flash_ops_since(&ops, &start);
+
+	zassert_equal(evt_cnt[PGPS_EVT_AVAILABLE], 1, "Saved index not used");
+	zassert_equal_ptr(available, stored_prediction(0), "Wrong prediction");
+	zassert_equal(settings_mock_save_cnt(INDEX_KEY), save_cnt, "Index rebuilt at boot");
+	zassert_equal(ops.write_calls + ops.erase_calls, 0, "Flash modified at boot");
+
+	/* The prediction is checked when it is used for the first time */
+	set_time(last);
+	zassert_equal(nrf_cloud_pgps_find_prediction(&p), -EINVAL, "Bad prediction not found");
+
+	*sentinel ^= 0xFF;
+	zassert_equal(nrf_cloud_pgps_find_prediction(&p), last, "Prediction not found");
+	zassert_equal_ptr(p, stored_prediction(last), "Wrong prediction");
+}
+
+static void boot_fallback(void)
+{
+	size_t save_cnt = settings_mock_save_cnt(INDEX_KEY);
+
+	set_time(0);
+	pgps_boot();
+
+	zassert_equal(evt_cnt[PGPS_EVT_AVAILABLE], 1, "Stored predictions not found");
+	zassert_equal_ptr(available, stored_prediction(0), "Wrong prediction");
+	zassert_equal(settings_mock_save_cnt(INDEX_KEY), save_cnt + 1, "Index not rebuilt");
+}
+
+static void test_corrupted_crc(void)
+{
+	struct npgps_saved_index saved;
+
+	saved_index_get(&saved);
+	saved.crc[0] ^= 1;
+	zassert_ok(settings_save_one(INDEX_KEY, &saved, sizeof(saved)), "Cannot save index");
+
+	boot_fallback();
+
+	saved_index_get(&saved);
+	zassert_equal(saved.count, NUM_PREDICTIONS, "Wrong prediction count in index");
+	zassert_equal(saved.crc[0], stored_crc(0), "CRC not fixed");
+}
+
+static void test_corrupted_index(void)
+{
+	struct npgps_saved_index saved;
+
+	saved_index_get(&saved);
+	saved.block[1] = NUM_PREDICTIONS;
+	zassert_ok(settings_save_one(INDEX_KEY, &saved, sizeof(saved)), "Cannot save index");
+
+	boot_fallback();
+
+	saved_index_get(&saved);
+	zassert_equal(saved.count, NUM_PREDICTIONS, "Wrong prediction count in index");
+	zassert_equal(saved.block[1], 1, "Block not fixed");
+}
+
+void test_main(void)
+{
+	ztest_test_suite(nrf_cloud_pgps_test,
+			 ztest_unit_test(test_init),
+			 ztest_unit_test(test_store_single_write),
+			 ztest_unit_test(test_boot_saved_index),
+			 ztest_unit_test(test_corrupted_crc),
+			 ztest_unit_test(test_corrupted_index)
+			 );
+
+	ztest_run_test_suite(nrf_cloud_pgps_test);
+}
@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) 2022 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include <ztest.h>
+#include <string.h>
+#include <zephyr/settings/settings.h>
+
+#include "settings_mock.h"
+
+#define STORED_MAX	8
+#define STORED_LEN_MAX	512
+
+/* Settings kept in RAM, so that they survive a simulated reboot */
+struct stored {
+	char name[48];
+	uint8_t data[STORED_LEN_MAX];
+	size_t len;
+	size_t save_cnt;
+};
+
+static struct stored stored[STORED_MAX];
+
+
+static struct stored *stored_find(const char *name)
+{
+	for (size_t i = 0; i < ARRAY_SIZE(stored); i++) {
+		if (!strcmp(stored[i].name, name)) {
+			return &stored[i];
+		}
+	}
+
+	return NULL;
+}
+
+void settings_mock_clear(void)
+{
+	memset(stored, 0, sizeof(stored));
+}
+
+size_t settings_mock_save_cnt(const char *name)
+{
+	const struct stored *s = stored_find(name);
+
+	return s ? s->save_cnt : 0;
+}
+
+size_t settings_mock_get(const char *name, void *data, size_t len)
+{
+	const struct stored *s = stored_find(name);
+
+	if (!s || !s->len) {
+		return 0;
+	}
+
+	len = MIN(len, s->len);
+	memcpy(data, s->data, len);
+
+	return len;
+}
+
+static ssize_t settings_mock_read_fn(void *cb_arg, void *data, size_t len)
+{
+	const struct stored *s = cb_arg;
+
+	len = MIN(len, s->len);
+	memcpy(data, s->data, len);
+
+	return len;
+}
+
+static int settings_mock_load(struct settings_store *cs, const struct settings_load_arg *arg)
+{
+	int err = 0;
+
+	for (size_t i = 0; (i < ARRAY_SIZE(stored)) && !err; i++) {
+		if (stored[i].len) {
+			err = settings_call_set_handler(stored[i].name, stored[i].len,
+							settings_mock_read_fn, &stored[i], arg);
+		}
+	}
+
+	return err;
+}
+
+static int settings_mock_save(struct settings_store *cs, const char *name, const char *value,
+			      size_t val_len)
+{
+	struct stored *s = stored_find(name);
+
+	zassert_true(strlen(name) < sizeof(s->name), "Too long settings key");
+	zassert_true(val_len <= STORED_LEN_MAX, "Stored value too large");
+
+	if (!s) {
+		s = stored_find("");
+		zassert_not_null(s, "Settings storage full");
+		strcpy(s->name, name);
+	}
+
+	memcpy(s->data, value, val_len);
+	s->len = val_len;
+	s->save_cnt++;
+
+	return 0;
+}
+
+static struct settings_store_itf settings_mock_itf = {
+	.csi_load = settings_mock_load,
+	.csi_save = settings_mock_save,
+};
+
+static struct settings_store settings_mock_store = {
+	.cs_itf = &settings_mock_itf
+};
+
+int settings_backend_init(void)
+{
+	settings_dst_register(&settings_mock_store);
+	settings_src_register(&settings_mock_store);
+
+	return 0;
+}
@@ -0,0 +1,32 @@
+/*
+ * Copyright (c) 2022 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#ifndef _SETTINGS_MOCK_H_
+#define _SETTINGS_MOCK_H_
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Remove all of the settings kept in RAM. */
+void settings_mock_clear(void);
+
+/** Get the number of times the given settings key was saved. */
+size_t settings_mock_save_cnt(const char *name);
+
+/** Read the stored value of the given settings key.
+ *
+ * @return Length of the stored value, or 0 if the key is not stored.
+ */
+size_t settings_mock_get(const char *name, void *data, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _SETTINGS_MOCK_H_ */
@@ -0,0 +1,165 @@
+/*
+ * Copyright (c) 2022 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include <ztest.h>
+#include <profiler_buf.h>
+
+#include "buf.h"
+
+#define BUF_SIZE	64
+/* Events of this length take three records of the buffer size, the third
+ * one does not fit before the end of the buffer.
+ */
+#define RECORD_LEN	24
+#define EVENT_LEN	(RECORD_LEN - sizeof(atomic_t))
+
+static uint8_t buf_data[BUF_SIZE] __aligned(sizeof(atomic_t));
+static struct nrf_profiler_buf buf;
+
+static void buf_setup(void)
+{
+	memset(buf_data, 0, sizeof(buf_data));
+	buf = (struct nrf_profiler_buf)NRF_PROFILER_BUF_INITIALIZER(buf_data);
+}
+
+static void event_fill(uint8_t *event, size_t len, uint8_t seed)
+{
+	for (size_t i = 0; i < len; i++) {
+		event[i] = seed + i;
+	}
+}
+
+static bool event_put(size_t len, uint8_t seed)
+{
+	uint8_t event[EVENT_LEN];
+
+	zassert_true(len <= sizeof(event), "Event too long");
+	event_fill(event, len, seed);
+
+	return nrf_profiler_buf_put(&buf, event, len);
+}
+
+static const uint8_t *event_check(size_t len, uint8_t seed)
+{
+	uint8_t event[EVENT_LEN];
+	const uint8_t *data;
+	size_t data_len;
+
+	event_fill(event, len, seed);
+
+	data = nrf_profiler_buf_peek(&buf, &data_len);
+	zassert_not_null(data, "No event");
+	zassert_equal(data_len, len, "Wrong event length");
+	zassert_mem_equal(data, event, len, "Wrong event data");
+
+	nrf_profiler_buf_consume(&buf);
+
+	return data;
+}
+
+static void test_buf_put_peek_consume(void)
+{
+	size_t len;
+
+	buf_setup();
+
+	zassert_is_null(nrf_profiler_buf_peek(&buf, &len), "Buffer not empty");
+
+	zassert_true(event_put(1, 10), "Event not added");
+	zassert_true(event_put(0, 20), "Event not added");
+	zassert_true(event_put(EVENT_LEN, 30), "Event not added");
+
+	event_check(1, 10);
+	event_check(0, 20);
+	event_check(EVENT_LEN, 30);
+
+	zassert_is_null(nrf_profiler_buf_peek(&buf, &len), "Buffer not empty");
+	zassert_equal(nrf_profiler_buf_dropped_get(&buf), 0, "Events dropped");
+}
+
+static void test_buf_wrap(void)
+{
+	const uint8_t *data;
+
+	buf_setup();
+
+	zassert_true(event_put(EVENT_LEN, 1), "Event not added");
+	zassert_true(event_put(EVENT_LEN, 2), "Event not added");
+	event_check(EVENT_LEN, 1);
+	event_check(EVENT_LEN, 2);
+
+	/* The record does not fit before the end of the buffer, the rest of
+	 * the buffer is padding and the event is stored at its start.
+	 */
+	zassert_true(event_put(EVENT_LEN, 3), "Event not added");
+	zassert_true(event_put(EVENT_LEN, 4), "Event not added");
+
+	data = event_check(EVENT_LEN, 3);
+	zassert_equal_ptr(data, &buf_data[sizeof(atomic_t)], "Event not stored contiguously");
+	event_check(EVENT_LEN, 4);
+
+	zassert_equal(atomic_get(&buf.head), atomic_get(&buf.tail), "Buffer not empty");
+	zassert_equal(nrf_profiler_buf_dropped_get(&buf), 0, "Events dropped");
+}
+
+static void test_buf_full(void)
+{
+	buf_setup();
+
+	zassert_true(event_put(EVENT_LEN, 1), "Event not added");
+	zassert_true(event_put(EVENT_LEN, 2), "Event not added");
+
+	/* The third record and the padding before it do not fit */
+	zassert_false(event_put(EVENT_LEN, 3), "Event added to full buffer");
+	zassert_false(event_put(EVENT_LEN, 4), "Event added to full buffer");
+
+	zassert_equal(nrf_profiler_buf_dropped_get(&buf), 2, "Wrong number of dropped events");
+	zassert_equal(nrf_profiler_buf_dropped_get(&buf), 0, "Dropped events not reset");
+
+	/* Space of a consumed event is reused */
+	event_check(EVENT_LEN, 1);
+	zassert_true(event_put(EVENT_LEN, 5), "Event not added");
+
+	event_check(EVENT_LEN, 2);
+	event_check(EVENT_LEN, 5);
+}
+
+static void test_buf_writing(void)
+{
+	atomic_t *hdr = (atomic_t *)buf_data;
+	atomic_val_t committed;
+	size_t len;
+
+	buf_setup();
+
+	zassert_true(event_put(EVENT_LEN, 1), "Event not added");
+	zassert_true(event_put(EVENT_LEN, 2), "Event not added");
+
+	/* The first record is reserved, but its producer was preempted before
+	 * committing it. Reserved space is zeroed.
+	 */
+	committed = atomic_set(hdr, 0);
+
+	zassert_is_null(nrf_profiler_buf_peek(&buf, &len),
+			"Event returned while an older one is written");
+
+	atomic_set(hdr, committed);
+
+	event_check(EVENT_LEN, 1);
+	event_check(EVENT_LEN, 2);
+}
+
+void test_buf_suite_run(void)
+{
+	ztest_test_suite(nrf_profiler_buf_tests,
+			 ztest_unit_test(test_buf_put_peek_consume),
+			 ztest_unit_test(test_buf_wrap),
+			 ztest_unit_test(test_buf_full),
+			 ztest_unit_test(test_buf_writing)
+			 );
+
+	ztest_run_test_suite(nrf_profiler_buf_tests);
+}
@@ -0,0 +1,13 @@
+/*
+ * Copyright (c) 2022 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#ifndef _BUF_H_
+#define _BUF_H_
+
+/* Run the tests of the nrf_profiler event buffer. */
+void test_buf_suite_run(void);
+
+#endif /* _BUF_H_ */
@@ -4,13 +4,21 @@
  * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
  */
 
+#include <stdio.h>
 #include <ztest.h>
 #include <nrf_profiler.h>
+#include <zephyr/sys/byteorder.h>
+#include <profiler_backend.h>
+
+#include "buf.h"
 
 #define PROFILED_EVENTS_NB 100
 #define U_VALUE_START 0
 #define S_VALUE_START -50
 #define EXAMPLE_STRING "example string"
+/* Number of events logged at once to overflow the event buffer */
+#define DROP_EVENTS_NB 2000
+#define DROPPED_EVENTS_DESCR "_nrf_profiler_dropped_events_"
 
 static uint16_t no_data_event_id;
 static uint16_t data_event_id;
@@ -117,13 +125,141 @@ static void test_performance3(void)
 	       PROFILED_EVENTS_NB, elapsed_time_us);
 }
 
+#ifdef CONFIG_NRF_PROFILER_NORDIC_BACKEND_FILE
+static size_t varint_get(const uint8_t *data, size_t len, size_t *pos)
+{
+	size_t value = 0;
+
+	for (size_t shift = 0; *pos < len; shift += 7) {
+		uint8_t byte = data[(*pos)++];
+
+		value |= (size_t)(byte & 0x7F) << shift;
+		if (!(byte & 0x80)) {
+			break;
+		}
+	}
+
+	return value;
+}
+
+/* Decode the start of an event record of the capture, returns the event type ID.
+ * On return, pos is the position of the event data.
+ */
+static size_t record_id_get(const uint8_t *data, size_t len, size_t *pos)
+{
+	size_t id;
+
+	*pos = 0;
+
+	/* Synchronization record with the full timestamp */
+	if (data[0] == 0) {
+		*pos += 1 + sizeof(uint64_t);
+	}
+
+	id = varint_get(data, len, pos) - 1;
+	/* Timestamp difference */
+	(void)varint_get(data, len, pos);
+
+	return id;
+}
+
+static void test_dropped_events(void)
+{
+	static uint8_t frame[UINT16_MAX];
+	static char descr_text[2048];
+	size_t descr_len = 0;
+	size_t dropped_id = SIZE_MAX;
+	uint32_t dropped = 0;
+	uint32_t events = 0;
+	uint8_t hdr[NRF_PROFILER_CAPTURE_HDR_LEN];
+	FILE *file;
+	int c;
+
+	/* Events are logged faster than they are written, so that the event
+	 * buffer overflows.
+	 */
+	for (size_t i = 0; i < DROP_EVENTS_NB / PROFILED_EVENTS_NB; i++) {
+		(void)test_performance_core(profile_data_event, data_event_id);
+	}
+
+	/* Write out the remaining events and the number of dropped events */
+	nrf_profiler_term();
+
+	file = fopen(CONFIG_NRF_PROFILER_NORDIC_BACKEND_FILE_PATH, "rb");
+	zassert_not_null(file, "Cannot open capture file");
+
+	zassert_equal(fread(hdr, 1, sizeof(hdr), file), sizeof(hdr), "No capture header");
+	zassert_mem_equal(hdr, NRF_PROFILER_CAPTURE_MAGIC, NRF_PROFILER_CAPTURE_MAGIC_LEN,
+			  "Wrong capture magic");
+
+	while ((c = fgetc(file)) != EOF) {
+		uint8_t frame_hdr[NRF_PROFILER_CAPTURE_FRAME_HDR_LEN - 1];
+		size_t len;
+		size_t pos;
+
+		/* Padding */
+		if (c == 0xFF) {
+			continue;
+		}
+
+		zassert_equal(fread(frame_hdr, 1, sizeof(frame_hdr), file), sizeof(frame_hdr),
+			      "Truncated frame");
+		len = sys_get_le16(frame_hdr);
+		zassert_equal(fread(frame, 1, len, file), len, "Truncated frame");
+
+		if (c == NRF_PROFILER_CAPTURE_FRAME_INFO) {
+			zassert_true(descr_len + len < sizeof(descr_text), "Descriptions too long");
+			memcpy(&descr_text[descr_len], frame, len);
+			descr_len += len;
+			continue;
+		}
+
+		zassert_equal(c, NRF_PROFILER_CAPTURE_FRAME_DATA, "Unknown frame");
+
+		/* Event descriptions are written before the events */
+		if (dropped_id == SIZE_MAX) {
+			const char *d;
+
+			descr_text[descr_len] = '\0';
+			d = strstr(descr_text, DROPPED_EVENTS_DESCR ",");
+			zassert_not_null(d, "No description of dropped events");
+			dropped_id = strtoul(d + strlen(DROPPED_EVENTS_DESCR ","), NULL, 10);
+		}
+
+		if (record_id_get(frame, len, &pos) == dropped_id) {
+			dropped += varint_get(frame, len, &pos);
+		} else {
+			events++;
+		}
+	}
+
+	fclose(file);
+
+	printk("Logged %d events, %u written and %u reported as dropped\n",
+	       3 * PROFILED_EVENTS_NB + DROP_EVENTS_NB, events, dropped);
+
+	zassert_true(dropped > 0, "No dropped events reported");
+	zassert_equal(events + dropped, 3 * PROFILED_EVENTS_NB + DROP_EVENTS_NB,
+		      "Events lost without being reported as dropped");
+}
+#else
+static void test_dropped_events(void)
+{
+	/* The capture is only available on the host with the file backend */
+	ztest_test_skip();
+}
+#endif /* CONFIG_NRF_PROFILER_NORDIC_BACKEND_FILE */
+
 void test_main(void)
 {
+	test_buf_suite_run();
+
 	ztest_test_suite(nrf_profiler_tests,
 			 ztest_unit_test(test_init),
 			 ztest_unit_test(test_performance1),
 			 ztest_unit_test(test_performance2),
-			 ztest_unit_test(test_performance3)
+			 ztest_unit_test(test_performance3),
+			 ztest_unit_test(test_dropped_events)
 			 );
 
 	ztest_run_test_suite(nrf_profiler_tests);